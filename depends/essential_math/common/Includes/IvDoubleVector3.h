@@ -1,6 +1,6 @@
 //===============================================================================
 // @ IvDoubleVector3.h
-// 
+//
 // 3D vector class
 // ------------------------------------------------------------------------------
 // Copyright (C) 2008-2015 by James M. Van Verth and Lars M. Bishop.
@@ -17,6 +17,8 @@
 //-- Dependencies ---------------------------------------------------------------
 //-------------------------------------------------------------------------------
 
+#include "IvMath.h"
+#include "IvVector3.h"
 #include "IvWriter.h"
 
 //-------------------------------------------------------------------------------
@@ -29,6 +31,10 @@
 
 class IvMatrix33;
 
+// All of the arithmetic is inline, and constexpr where it needs no libm: the
+// terrain chains many of these per vertex (CaliMath.h's quad_lerp, the sphere
+// mappings), and out of line every operator was a call and a temporary. The
+// copy operations are the implicit ones, so the type is trivially copyable.
 class IvDoubleVector3
 {
     friend class IvLine3;
@@ -39,23 +45,22 @@ class IvDoubleVector3
     friend class IvQuat;
     friend class IvRay3;
 	friend class IvVector3;
-    
+
 public:
     // constructor/destructor
-    inline IvDoubleVector3() {}
-    inline IvDoubleVector3( double _x, double _y, double _z ) :
+    IvDoubleVector3() = default;
+    inline constexpr IvDoubleVector3( double _x, double _y, double _z ) :
         x(_x), y(_y), z(_z)
     {
     }
-    inline ~IvDoubleVector3() {}
 
     // copy operations
-    IvDoubleVector3(const IvDoubleVector3& other);
-    IvDoubleVector3& operator=(const IvDoubleVector3& other);
-	IvDoubleVector3(const IvVector3& other);
-	IvDoubleVector3& operator=(const IvVector3& other);
+    IvDoubleVector3(const IvDoubleVector3& other) = default;
+    IvDoubleVector3& operator=(const IvDoubleVector3& other) = default;
+	inline constexpr IvDoubleVector3(const IvVector3& other);
+	inline IvDoubleVector3& operator=(const IvVector3& other);
 
-	operator IvVector3() const;
+	inline operator IvVector3() const;
 
     // text output (for debugging)
     friend IvWriter& operator<<(IvWriter& out, const IvDoubleVector3& source);
@@ -64,89 +69,515 @@ public:
     inline double& operator[]( unsigned int i )          { return (&x)[i]; }
     inline double operator[]( unsigned int i ) const { return (&x)[i]; }
 
-    double Length() const;
-    double LengthSquared() const;
+    inline double Length() const;
+    inline constexpr double LengthSquared() const;
 
-    friend double Distance( const IvDoubleVector3& p0, const IvDoubleVector3& p1 );
-    friend double DistanceSquared( const IvDoubleVector3& p0, const IvDoubleVector3& p1 );
+    friend inline double Distance( const IvDoubleVector3& p0, const IvDoubleVector3& p1 );
+    friend inline constexpr double DistanceSquared( const IvDoubleVector3& p0, const IvDoubleVector3& p1 );
 
     // comparison
-    bool operator==( const IvDoubleVector3& other ) const;
-    bool operator!=( const IvDoubleVector3& other ) const;
-    bool IsZero() const;
-    bool IsUnit() const;
+    inline bool operator==( const IvDoubleVector3& other ) const;
+    inline bool operator!=( const IvDoubleVector3& other ) const;
+    inline bool IsZero() const;
+    inline bool IsUnit() const;
 
     // manipulators
-    inline void Set( double _x, double _y, double _z );
-    void Clean();       // sets near-zero elements to 0
-    inline void Zero(); // sets all elements to 0
-    void Normalize();   // sets to unit vector
+    inline constexpr void Set( double _x, double _y, double _z );
+    inline void Clean();       // sets near-zero elements to 0
+    inline constexpr void Zero(); // sets all elements to 0
+    inline void Normalize();   // sets to unit vector
 
     // operators
 
     // addition/subtraction
-    IvDoubleVector3 operator+( const IvDoubleVector3& other ) const;
-    friend IvDoubleVector3& operator+=( IvDoubleVector3& vector, const IvDoubleVector3& other );
-    IvDoubleVector3 operator-( const IvDoubleVector3& other ) const;
-    friend IvDoubleVector3& operator-=( IvDoubleVector3& vector, const IvDoubleVector3& other );
+    inline constexpr IvDoubleVector3 operator+( const IvDoubleVector3& other ) const;
+    friend inline constexpr IvDoubleVector3& operator+=( IvDoubleVector3& vector, const IvDoubleVector3& other );
+    inline constexpr IvDoubleVector3 operator-( const IvDoubleVector3& other ) const;
+    friend inline constexpr IvDoubleVector3& operator-=( IvDoubleVector3& vector, const IvDoubleVector3& other );
 
-    IvDoubleVector3 operator-() const;
+    inline constexpr IvDoubleVector3 operator-() const;
 
     // scalar multiplication
-    IvDoubleVector3   operator*( double scalar ) const;
-    friend IvDoubleVector3    operator*( double scalar, const IvDoubleVector3& vector );
-    IvDoubleVector3&          operator*=( double scalar );
-    IvDoubleVector3   operator/( double scalar ) const;
-    IvDoubleVector3&          operator/=( double scalar );
+    inline constexpr IvDoubleVector3   operator*( double scalar ) const;
+    friend inline constexpr IvDoubleVector3    operator*( double scalar, const IvDoubleVector3& vector );
+    inline constexpr IvDoubleVector3&          operator*=( double scalar );
+    inline constexpr IvDoubleVector3   operator/( double scalar ) const;
+    inline constexpr IvDoubleVector3&          operator/=( double scalar );
 
     // dot product/cross product
-    double               Dot( const IvDoubleVector3& vector ) const;
-    friend double        Dot( const IvDoubleVector3& vector1, const IvDoubleVector3& vector2 );
-    IvDoubleVector3           Cross( const IvDoubleVector3& vector ) const;
-    friend IvDoubleVector3    Cross( const IvDoubleVector3& vector1, const IvDoubleVector3& vector2 );
+    inline constexpr double               Dot( const IvDoubleVector3& vector ) const;
+    friend inline constexpr double        Dot( const IvDoubleVector3& vector1, const IvDoubleVector3& vector2 );
+    inline constexpr IvDoubleVector3           Cross( const IvDoubleVector3& vector ) const;
+    friend inline constexpr IvDoubleVector3    Cross( const IvDoubleVector3& vector1, const IvDoubleVector3& vector2 );
+
+    // fused kernels, the same bits as the operator chains they replace
+    friend inline constexpr IvDoubleVector3    Lerp( const IvDoubleVector3& a, const IvDoubleVector3& b, double t );
+    friend inline constexpr IvDoubleVector3    QuadLerp( const IvDoubleVector3& a, const IvDoubleVector3& b,
+                                                         const IvDoubleVector3& c, const IvDoubleVector3& d,
+                                                         double u, double v );
 
     // matrix products
     friend IvDoubleVector3 operator*( const IvDoubleVector3& vector, const IvMatrix33& mat );
- 
+
     // useful defaults
     static IvDoubleVector3    xAxis;
     static IvDoubleVector3    yAxis;
     static IvDoubleVector3    zAxis;
     static IvDoubleVector3    origin;
-    
+
     // member variables
     double x, y, z;
 };
 
-double Distance( const IvDoubleVector3& p0, const IvDoubleVector3& p1 );
-double DistanceSquared( const IvDoubleVector3& p0, const IvDoubleVector3& p1 );
-
 //-------------------------------------------------------------------------------
 //-- Inlines --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
 
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::IvDoubleVector3()
+//-------------------------------------------------------------------------------
+// Conversion from float vector
+//-------------------------------------------------------------------------------
+inline constexpr
+IvDoubleVector3::IvDoubleVector3(const IvVector3& other) :
+    x( other.x ),
+    y( other.y ),
+    z( other.z )
+{
+}   // End of IvDoubleVector3::IvDoubleVector3()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator=()
+//-------------------------------------------------------------------------------
+// Assignment from float vector
+//-------------------------------------------------------------------------------
+inline IvDoubleVector3&
+IvDoubleVector3::operator=(const IvVector3& other)
+{
+    x = other.x;
+    y = other.y;
+    z = other.z;
+
+    return *this;
+
+}   // End of IvDoubleVector3::operator=()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator IvVector3()
+//-------------------------------------------------------------------------------
+// Conversion to float vector
+//-------------------------------------------------------------------------------
+inline
+IvDoubleVector3::operator IvVector3() const
+{
+    return IvVector3((float)x, (float)y, (float)z);
+
+}   // End of IvDoubleVector3::operator IvVector3()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::Length()
+//-------------------------------------------------------------------------------
+// Vector length
+//-------------------------------------------------------------------------------
+inline double
+IvDoubleVector3::Length() const
+{
+    return sqrt( x*x + y*y + z*z );
+
+}   // End of IvDoubleVector3::Length()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::LengthSquared()
+//-------------------------------------------------------------------------------
+// Vector length squared (avoids square root)
+//-------------------------------------------------------------------------------
+inline constexpr double
+IvDoubleVector3::LengthSquared() const
+{
+    return (x*x + y*y + z*z);
+
+}   // End of IvDoubleVector3::LengthSquared()
+
+//-------------------------------------------------------------------------------
+// @ ::Distance()
+//-------------------------------------------------------------------------------
+// Point distance
+//-------------------------------------------------------------------------------
+inline double
+Distance( const IvDoubleVector3& p0, const IvDoubleVector3& p1 )
+{
+    double x = p0.x - p1.x;
+    double y = p0.y - p1.y;
+    double z = p0.z - p1.z;
+
+    return sqrt( x*x + y*y + z*z );
+
+}   // End of ::Distance()
+
+//-------------------------------------------------------------------------------
+// @ ::DistanceSquared()
+//-------------------------------------------------------------------------------
+// Point distance
+//-------------------------------------------------------------------------------
+inline constexpr double
+DistanceSquared( const IvDoubleVector3& p0, const IvDoubleVector3& p1 )
+{
+    double x = p0.x - p1.x;
+    double y = p0.y - p1.y;
+    double z = p0.z - p1.z;
+
+    return ( x*x + y*y + z*z );
+
+}   // End of ::DistanceSquared()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator==()
+//-------------------------------------------------------------------------------
+// Comparison operator
+//-------------------------------------------------------------------------------
+inline bool
+IvDoubleVector3::operator==( const IvDoubleVector3& other ) const
+{
+    if ( IvAreEqual( other.x, x )
+        && IvAreEqual( other.y, y )
+        && IvAreEqual( other.z, z ) )
+        return true;
+
+    return false;
+}   // End of IvDoubleVector3::operator==()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator!=()
+//-------------------------------------------------------------------------------
+// Comparison operator
+//-------------------------------------------------------------------------------
+inline bool
+IvDoubleVector3::operator!=( const IvDoubleVector3& other ) const
+{
+    if ( IvAreEqual( other.x, x )
+        && IvAreEqual( other.y, y )
+        && IvAreEqual( other.z, z ) )
+        return false;
+
+    return true;
+}   // End of IvDoubleVector3::operator!=()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::IsZero()
+//-------------------------------------------------------------------------------
+// Check for zero vector
+//-------------------------------------------------------------------------------
+inline bool
+IvDoubleVector3::IsZero() const
+{
+    return IvIsZero(x*x + y*y + z*z);
+
+}   // End of IvDoubleVector3::IsZero()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::IsUnit()
+//-------------------------------------------------------------------------------
+// Check for unit vector
+//-------------------------------------------------------------------------------
+inline bool
+IvDoubleVector3::IsUnit() const
+{
+    return IvIsZero(1.0f - x*x - y*y - z*z);
+
+}   // End of IvDoubleVector3::IsUnit()
+
 //-------------------------------------------------------------------------------
 // @ IvDoubleVector3::Set()
 //-------------------------------------------------------------------------------
 // Set vector elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvDoubleVector3::Set( double _x, double _y, double _z )
 {
     x = _x; y = _y; z = _z;
 }   // End of IvDoubleVector3::Set()
 
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::Clean()
+//-------------------------------------------------------------------------------
+// Set elements close to zero equal to zero
+//-------------------------------------------------------------------------------
+inline void
+IvDoubleVector3::Clean()
+{
+    if (IvIsZero(x))
+    {
+        x = 0.0f;
+    }
+    if (IvIsZero(y))
+    {
+        y = 0.0f;
+    }
+    if (IvIsZero(z))
+    {
+        z = 0.0f;
+    }
+
+}   // End of IvDoubleVector3::Clean()
+
 //-------------------------------------------------------------------------------
 // @ IvDoubleVector3::Zero()
 //-------------------------------------------------------------------------------
 // Zero all elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvDoubleVector3::Zero()
 {
     x = y = z = 0.0f;
 }   // End of IvDoubleVector3::Zero()
 
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::Normalize()
+//-------------------------------------------------------------------------------
+// Set to unit vector
+//-------------------------------------------------------------------------------
+inline void
+IvDoubleVector3::Normalize()
+{
+    double lengthsq = x*x + y*y + z*z;
+
+    if ( IvIsZero( lengthsq ) )
+    {
+        Zero();
+    }
+    else
+    {
+        double factor = IvRecipSqrt( lengthsq );
+        x *= factor;
+        y *= factor;
+        z *= factor;
+    }
+
+}   // End of IvDoubleVector3::Normalize()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator+()
+//-------------------------------------------------------------------------------
+// Add vector to self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+IvDoubleVector3::operator+( const IvDoubleVector3& other ) const
+{
+    return IvDoubleVector3( x + other.x, y + other.y, z + other.z );
+
+}   // End of IvDoubleVector3::operator+()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator+=()
+//-------------------------------------------------------------------------------
+// Add vector to self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3&
+operator+=( IvDoubleVector3& self, const IvDoubleVector3& other )
+{
+    self.x += other.x;
+    self.y += other.y;
+    self.z += other.z;
+
+    return self;
+
+}   // End of IvDoubleVector3::operator+=()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator-()
+//-------------------------------------------------------------------------------
+// Subtract vector from self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+IvDoubleVector3::operator-( const IvDoubleVector3& other ) const
+{
+    return IvDoubleVector3( x - other.x, y - other.y, z - other.z );
+
+}   // End of IvDoubleVector3::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator-=()
+//-------------------------------------------------------------------------------
+// Subtract vector from self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3&
+operator-=( IvDoubleVector3& self, const IvDoubleVector3& other )
+{
+    self.x -= other.x;
+    self.y -= other.y;
+    self.z -= other.z;
+
+    return self;
+
+}   // End of IvDoubleVector3::operator-=()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator-() (unary)
+//-------------------------------------------------------------------------------
+// Negate self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+IvDoubleVector3::operator-() const
+{
+    return IvDoubleVector3(-x, -y, -z);
+}    // End of IvDoubleVector3::operator-()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+IvDoubleVector3::operator*( double scalar ) const
+{
+    return IvDoubleVector3( scalar*x, scalar*y, scalar*z );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+operator*( double scalar, const IvDoubleVector3& vector )
+{
+    return IvDoubleVector3( scalar*vector.x, scalar*vector.y, scalar*vector.z );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication by self
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3&
+IvDoubleVector3::operator*=( double scalar )
+{
+    x *= scalar;
+    y *= scalar;
+    z *= scalar;
+
+    return *this;
+
+}   // End of IvDoubleVector3::operator*=()
+
+//-------------------------------------------------------------------------------
+// @ operator/()
+//-------------------------------------------------------------------------------
+// Scalar division
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+IvDoubleVector3::operator/( double scalar ) const
+{
+    return IvDoubleVector3( x/scalar, y/scalar, z/scalar );
+
+}   // End of operator/()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::operator/=()
+//-------------------------------------------------------------------------------
+// Scalar division by self
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3&
+IvDoubleVector3::operator/=( double scalar )
+{
+    x /= scalar;
+    y /= scalar;
+    z /= scalar;
+
+    return *this;
+
+}   // End of IvDoubleVector3::operator/=()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::Dot()
+//-------------------------------------------------------------------------------
+// Dot product by self
+//-------------------------------------------------------------------------------
+inline constexpr double
+IvDoubleVector3::Dot( const IvDoubleVector3& vector ) const
+{
+    return (x*vector.x + y*vector.y + z*vector.z);
+
+}   // End of IvDoubleVector3::Dot()
+
+//-------------------------------------------------------------------------------
+// @ Dot()
+//-------------------------------------------------------------------------------
+// Dot product friend operator
+//-------------------------------------------------------------------------------
+inline constexpr double
+Dot( const IvDoubleVector3& vector1, const IvDoubleVector3& vector2 )
+{
+    return (vector1.x*vector2.x + vector1.y*vector2.y + vector1.z*vector2.z);
+
+}   // End of Dot()
+
+//-------------------------------------------------------------------------------
+// @ IvDoubleVector3::Cross()
+//-------------------------------------------------------------------------------
+// Cross product by self
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+IvDoubleVector3::Cross( const IvDoubleVector3& vector ) const
+{
+    return IvDoubleVector3( y*vector.z - z*vector.y,
+                      z*vector.x - x*vector.z,
+                      x*vector.y - y*vector.x );
+
+}   // End of IvDoubleVector3::Cross()
+
+//-------------------------------------------------------------------------------
+// @ Cross()
+//-------------------------------------------------------------------------------
+// Cross product friend operator
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+Cross( const IvDoubleVector3& vector1, const IvDoubleVector3& vector2 )
+{
+    return IvDoubleVector3( vector1.y*vector2.z - vector1.z*vector2.y,
+                      vector1.z*vector2.x - vector1.x*vector2.z,
+                      vector1.x*vector2.y - vector1.y*vector2.x );
+
+}   // End of Cross()
+
+//-------------------------------------------------------------------------------
+// @ Lerp()
+//-------------------------------------------------------------------------------
+// a + t*(b - a) in one pass: each element is rounded as in the operator
+// expression, without building the two intermediate vectors
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+Lerp( const IvDoubleVector3& a, const IvDoubleVector3& b, double t )
+{
+    return IvDoubleVector3( a.x + t*(b.x - a.x),
+                            a.y + t*(b.y - a.y),
+                            a.z + t*(b.z - a.z) );
+
+}   // End of Lerp()
+
+//-------------------------------------------------------------------------------
+// @ QuadLerp()
+//-------------------------------------------------------------------------------
+// Bilinear interpolation in the quad a b c d (a at u = v = 0, b at u = 1,
+// c at u = v = 1, d at v = 1): Lerp( Lerp(a, b, u), Lerp(d, c, u), v ) one
+// element at a time
+//-------------------------------------------------------------------------------
+inline constexpr IvDoubleVector3
+QuadLerp( const IvDoubleVector3& a, const IvDoubleVector3& b,
+          const IvDoubleVector3& c, const IvDoubleVector3& d, double u, double v )
+{
+    double abx = a.x + u*(b.x - a.x), dcx = d.x + u*(c.x - d.x);
+    double aby = a.y + u*(b.y - a.y), dcy = d.y + u*(c.y - d.y);
+    double abz = a.z + u*(b.z - a.z), dcz = d.z + u*(c.z - d.z);
+
+    return IvDoubleVector3( abx + v*(dcx - abx),
+                            aby + v*(dcy - aby),
+                            abz + v*(dcz - abz) );
+
+}   // End of QuadLerp()
+
 //-------------------------------------------------------------------------------
 //-- Externs --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
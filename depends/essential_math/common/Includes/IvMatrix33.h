@@ -35,20 +35,19 @@ class IvMatrix33
     friend class IvMatrix44;
 public:
     // constructor/destructor
-    inline IvMatrix33() {}
-    inline ~IvMatrix33() {}
+    IvMatrix33() = default;
     explicit IvMatrix33( const IvQuat& quat );
     
     // copy operations
-    IvMatrix33(const IvMatrix33& other);
-    IvMatrix33& operator=(const IvMatrix33& other);
+    IvMatrix33(const IvMatrix33& other) = default;
+    IvMatrix33& operator=(const IvMatrix33& other) = default;
 
     // text output (for debugging)
     friend IvWriter& operator<<(IvWriter& out, const IvMatrix33& source);
 
     // accessors
-    inline float& operator()(unsigned int i, unsigned int j);
-    inline float operator()(unsigned int i, unsigned int j) const;
+    inline constexpr float& operator()(unsigned int i, unsigned int j);
+    inline constexpr float operator()(unsigned int i, unsigned int j) const;
 
     // comparison
     bool operator==( const IvMatrix33& other ) const;
@@ -66,18 +65,18 @@ public:
     IvVector3 GetColumn( unsigned int i ) const; 
 
     void Clean();
-    void Identity();
+    inline constexpr void Identity();
 
     IvMatrix33& Inverse();
     friend IvMatrix33 Inverse( const IvMatrix33& mat );
 
-    IvMatrix33& Transpose();
-    friend IvMatrix33 Transpose( const IvMatrix33& mat );
+    inline constexpr IvMatrix33& Transpose();
+    friend inline constexpr IvMatrix33 Transpose( const IvMatrix33& mat );
 
     // useful computations
-    IvMatrix33 Adjoint() const;
-    float Determinant() const;
-    float Trace() const;
+    inline constexpr IvMatrix33 Adjoint() const;
+    inline constexpr float Determinant() const;
+    inline constexpr float Trace() const;
         
     // transformations
     IvMatrix33& Rotation( const IvQuat& rotate );
@@ -96,25 +95,25 @@ public:
     // operators
 
     // addition and subtraction
-    IvMatrix33 operator+( const IvMatrix33& other ) const;
-    IvMatrix33& operator+=( const IvMatrix33& other );
-    IvMatrix33 operator-( const IvMatrix33& other ) const;
-    IvMatrix33& operator-=( const IvMatrix33& other );
+    inline constexpr IvMatrix33 operator+( const IvMatrix33& other ) const;
+    inline constexpr IvMatrix33& operator+=( const IvMatrix33& other );
+    inline constexpr IvMatrix33 operator-( const IvMatrix33& other ) const;
+    inline constexpr IvMatrix33& operator-=( const IvMatrix33& other );
 
-    IvMatrix33 operator-() const;
+    inline constexpr IvMatrix33 operator-() const;
 
     // multiplication
-    IvMatrix33& operator*=( const IvMatrix33& matrix );
-    IvMatrix33 operator*( const IvMatrix33& matrix ) const;
+    inline constexpr IvMatrix33& operator*=( const IvMatrix33& matrix );
+    inline constexpr IvMatrix33 operator*( const IvMatrix33& matrix ) const;
 
     // column vector multiplier
-    IvVector3 operator*( const IvVector3& vector ) const;
+    inline constexpr IvVector3 operator*( const IvVector3& vector ) const;
     // row vector multiplier
-    friend IvVector3 operator*( const IvVector3& vector, const IvMatrix33& matrix );
+    friend inline constexpr IvVector3 operator*( const IvVector3& vector, const IvMatrix33& matrix );
 
-    IvMatrix33& operator*=( float scalar );
-    friend IvMatrix33 operator*( float scalar, const IvMatrix33& matrix );
-    IvMatrix33 operator*( float scalar ) const;
+    inline constexpr IvMatrix33& operator*=( float scalar );
+    friend inline constexpr IvMatrix33 operator*( float scalar, const IvMatrix33& matrix );
+    inline constexpr IvMatrix33 operator*( float scalar ) const;
 
     // low-level data accessors - implementation-dependent
     operator float*() { return mV; }
@@ -128,7 +127,7 @@ private:
 };
 
 IvMatrix33 Inverse( const IvMatrix33& mat );
-IvMatrix33 Transpose( const IvMatrix33& mat );
+inline constexpr IvMatrix33 Transpose( const IvMatrix33& mat );
 
 //-------------------------------------------------------------------------------
 //-- Inlines --------------------------------------------------------------------
@@ -139,7 +138,7 @@ IvMatrix33 Transpose( const IvMatrix33& mat );
 //-------------------------------------------------------------------------------
 // 2D array accessor
 //-------------------------------------------------------------------------------
-inline float&
+inline constexpr float&
 IvMatrix33::operator()(unsigned int i, unsigned int j)
 {
    return mV[i + 3*j];
@@ -151,13 +150,376 @@ IvMatrix33::operator()(unsigned int i, unsigned int j)
 //-------------------------------------------------------------------------------
 // 2D array accessor
 //-------------------------------------------------------------------------------
-inline float
+inline constexpr float
 IvMatrix33::operator()(unsigned int i, unsigned int j) const
 {
    return mV[i + 3*j];
 
 }   // End of IvMatrix33::operator()()
 
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::Identity()
+//-------------------------------------------------------------------------------
+// Set to identity matrix
+//-------------------------------------------------------------------------------
+inline constexpr void
+IvMatrix33::Identity()
+{
+    mV[0] = 1.0f;
+    mV[1] = 0.0f;
+    mV[2] = 0.0f;
+    mV[3] = 0.0f;
+    mV[4] = 1.0f;
+    mV[5] = 0.0f;
+    mV[6] = 0.0f;
+    mV[7] = 0.0f;
+    mV[8] = 1.0f;
+
+}   // End of IvMatrix33::Identity()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::Transpose()
+//-------------------------------------------------------------------------------
+// Set self to transpose
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33&
+IvMatrix33::Transpose()
+{
+    float temp = mV[1];
+    mV[1] = mV[3];
+    mV[3] = temp;
+
+    temp = mV[2];
+    mV[2] = mV[6];
+    mV[6] = temp;
+
+    temp = mV[5];
+    mV[5] = mV[7];
+    mV[7] = temp;
+
+    return *this;
+
+}   // End of IvMatrix33::Transpose()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::Transpose()
+//-------------------------------------------------------------------------------
+// Compute matrix transpose
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33
+Transpose( const IvMatrix33& mat )
+{
+    IvMatrix33 result{};
+
+    result.mV[0] = mat.mV[0];
+    result.mV[1] = mat.mV[3];
+    result.mV[2] = mat.mV[6];
+    result.mV[3] = mat.mV[1];
+    result.mV[4] = mat.mV[4];
+    result.mV[5] = mat.mV[7];
+    result.mV[6] = mat.mV[2];
+    result.mV[7] = mat.mV[5];
+    result.mV[8] = mat.mV[8];
+
+    return result;
+
+}   // End of IvMatrix33::Transpose()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::Determinant()
+//-------------------------------------------------------------------------------
+// Get determinant of matrix
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvMatrix33::Determinant() const
+{
+    return mV[0]*(mV[4]*mV[8] - mV[5]*mV[7])
+         + mV[3]*(mV[2]*mV[7] - mV[1]*mV[8])
+         + mV[6]*(mV[1]*mV[5] - mV[2]*mV[4]);
+
+}   // End of IvMatrix33::Determinant()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::Adjoint()
+//-------------------------------------------------------------------------------
+// Compute matrix adjoint
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33
+IvMatrix33::Adjoint() const
+{
+    IvMatrix33 result{};
+
+    // compute transpose of cofactors
+    result.mV[0] = mV[4]*mV[8] - mV[5]*mV[7];
+    result.mV[1] = mV[2]*mV[7] - mV[1]*mV[8];
+    result.mV[2] = mV[1]*mV[5] - mV[2]*mV[4];
+
+    result.mV[3] = mV[5]*mV[6] - mV[3]*mV[8];
+    result.mV[4] = mV[0]*mV[8] - mV[2]*mV[6];
+    result.mV[5] = mV[2]*mV[3] - mV[0]*mV[5];
+
+    result.mV[6] = mV[3]*mV[7] - mV[4]*mV[6];
+    result.mV[7] = mV[1]*mV[6] - mV[0]*mV[7];
+    result.mV[8] = mV[0]*mV[4] - mV[1]*mV[3];
+
+    return result;
+
+}   // End of IvMatrix33::Adjoint()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::Trace()
+//-------------------------------------------------------------------------------
+// Get trace of matrix
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvMatrix33::Trace() const
+{
+    return mV[0] + mV[4] + mV[8];
+
+}   // End of IvMatrix33::Trace()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator+()
+//-------------------------------------------------------------------------------
+// Matrix addition
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33
+IvMatrix33::operator+( const IvMatrix33& other ) const
+{
+    IvMatrix33 result{};
+
+    for (unsigned int i = 0; i < 9; ++i)
+    {
+        result.mV[i] = mV[i] + other.mV[i];
+    }
+
+    return result;
+
+}   // End of IvMatrix33::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator+=()
+//-------------------------------------------------------------------------------
+// Matrix addition by self
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33&
+IvMatrix33::operator+=( const IvMatrix33& other )
+{
+    for (unsigned int i = 0; i < 9; ++i)
+    {
+        mV[i] += other.mV[i];
+    }
+
+    return *this;
+
+}   // End of IvMatrix33::operator+=()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator-()
+//-------------------------------------------------------------------------------
+// Matrix subtraction
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33
+IvMatrix33::operator-( const IvMatrix33& other ) const
+{
+    IvMatrix33 result{};
+
+    for (unsigned int i = 0; i < 9; ++i)
+    {
+        result.mV[i] = mV[i] - other.mV[i];
+    }
+
+    return result;
+
+}   // End of IvMatrix33::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator-=()
+//-------------------------------------------------------------------------------
+// Matrix subtraction by self
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33&
+IvMatrix33::operator-=( const IvMatrix33& other )
+{
+    for (unsigned int i = 0; i < 9; ++i)
+    {
+        mV[i] -= other.mV[i];
+    }
+
+    return *this;
+
+}   // End of IvMatrix33::operator-=()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator-=() (unary)
+//-------------------------------------------------------------------------------
+// Negate self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33
+IvMatrix33::operator-() const
+{
+    IvMatrix33 result{};
+
+    for (unsigned int i = 0; i < 9; ++i)
+    {
+        result.mV[i] = -mV[i];
+    }
+
+    return result;
+
+}    // End of IvQuat::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator*()
+//-------------------------------------------------------------------------------
+// Matrix multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33
+IvMatrix33::operator*( const IvMatrix33& other ) const
+{
+    IvMatrix33 result{};
+
+    result.mV[0] = mV[0]*other.mV[0] + mV[3]*other.mV[1] + mV[6]*other.mV[2];
+    result.mV[1] = mV[1]*other.mV[0] + mV[4]*other.mV[1] + mV[7]*other.mV[2];
+    result.mV[2] = mV[2]*other.mV[0] + mV[5]*other.mV[1] + mV[8]*other.mV[2];
+    result.mV[3] = mV[0]*other.mV[3] + mV[3]*other.mV[4] + mV[6]*other.mV[5];
+    result.mV[4] = mV[1]*other.mV[3] + mV[4]*other.mV[4] + mV[7]*other.mV[5];
+    result.mV[5] = mV[2]*other.mV[3] + mV[5]*other.mV[4] + mV[8]*other.mV[5];
+    result.mV[6] = mV[0]*other.mV[6] + mV[3]*other.mV[7] + mV[6]*other.mV[8];
+    result.mV[7] = mV[1]*other.mV[6] + mV[4]*other.mV[7] + mV[7]*other.mV[8];
+    result.mV[8] = mV[2]*other.mV[6] + mV[5]*other.mV[7] + mV[8]*other.mV[8];
+
+    return result;
+
+}   // End of IvMatrix33::operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator*=()
+//-------------------------------------------------------------------------------
+// Matrix multiplication by self
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33&
+IvMatrix33::operator*=( const IvMatrix33& other )
+{
+    IvMatrix33 result{};
+
+    result.mV[0] = mV[0]*other.mV[0] + mV[3]*other.mV[1] + mV[6]*other.mV[2];
+    result.mV[1] = mV[1]*other.mV[0] + mV[4]*other.mV[1] + mV[7]*other.mV[2];
+    result.mV[2] = mV[2]*other.mV[0] + mV[5]*other.mV[1] + mV[8]*other.mV[2];
+    result.mV[3] = mV[0]*other.mV[3] + mV[3]*other.mV[4] + mV[6]*other.mV[5];
+    result.mV[4] = mV[1]*other.mV[3] + mV[4]*other.mV[4] + mV[7]*other.mV[5];
+    result.mV[5] = mV[2]*other.mV[3] + mV[5]*other.mV[4] + mV[8]*other.mV[5];
+    result.mV[6] = mV[0]*other.mV[6] + mV[3]*other.mV[7] + mV[6]*other.mV[8];
+    result.mV[7] = mV[1]*other.mV[6] + mV[4]*other.mV[7] + mV[7]*other.mV[8];
+    result.mV[8] = mV[2]*other.mV[6] + mV[5]*other.mV[7] + mV[8]*other.mV[8];
+
+    for (unsigned int i = 0; i < 9; ++i)
+    {
+        mV[i] = result.mV[i];
+    }
+
+    return *this;
+
+}   // End of IvMatrix33::operator*=()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator*()
+//-------------------------------------------------------------------------------
+// Matrix-column vector multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+IvMatrix33::operator*( const IvVector3& other ) const
+{
+    IvVector3 result{};
+
+    result.x = mV[0]*other.x + mV[3]*other.y + mV[6]*other.z;
+    result.y = mV[1]*other.x + mV[4]*other.y + mV[7]*other.z;
+    result.z = mV[2]*other.x + mV[5]*other.y + mV[8]*other.z;
+
+    return result;
+
+}   // End of IvMatrix33::operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::operator*()
+//-------------------------------------------------------------------------------
+// Row vector-matrix multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+operator*( const IvVector3& vector, const IvMatrix33& mat )
+{
+    IvVector3 result{};
+
+    result.x = mat.mV[0]*vector.x + mat.mV[1]*vector.y + mat.mV[2]*vector.z;
+    result.y = mat.mV[3]*vector.x + mat.mV[4]*vector.y + mat.mV[5]*vector.z;
+    result.z = mat.mV[6]*vector.x + mat.mV[7]*vector.y + mat.mV[8]*vector.z;
+
+    return result;
+
+}   // End of IvMatrix33::operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::*=()
+//-------------------------------------------------------------------------------
+// Matrix-scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33& IvMatrix33::operator*=( float scalar )
+{
+    mV[0] *= scalar;
+    mV[1] *= scalar;
+    mV[2] *= scalar;
+    mV[3] *= scalar;
+    mV[4] *= scalar;
+    mV[5] *= scalar;
+    mV[6] *= scalar;
+    mV[7] *= scalar;
+    mV[8] *= scalar;
+
+    return *this;
+}  // End of IvMatrix33::operator*=()
+
+//-------------------------------------------------------------------------------
+// @ friend IvMatrix33 *()
+//-------------------------------------------------------------------------------
+// Matrix-scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33 operator*( float scalar, const IvMatrix33& matrix )
+{
+    IvMatrix33 result{};
+    result.mV[0] = matrix.mV[0] * scalar;
+    result.mV[1] = matrix.mV[1] * scalar;
+    result.mV[2] = matrix.mV[2] * scalar;
+    result.mV[3] = matrix.mV[3] * scalar;
+    result.mV[4] = matrix.mV[4] * scalar;
+    result.mV[5] = matrix.mV[5] * scalar;
+    result.mV[6] = matrix.mV[6] * scalar;
+    result.mV[7] = matrix.mV[7] * scalar;
+    result.mV[8] = matrix.mV[8] * scalar;
+
+    return result;
+}  // End of friend IvMatrix33 operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix33::*()
+//-------------------------------------------------------------------------------
+// Matrix-scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix33 IvMatrix33::operator*( float scalar ) const
+{
+    IvMatrix33 result{};
+    result.mV[0] = mV[0] * scalar;
+    result.mV[1] = mV[1] * scalar;
+    result.mV[2] = mV[2] * scalar;
+    result.mV[3] = mV[3] * scalar;
+    result.mV[4] = mV[4] * scalar;
+    result.mV[5] = mV[5] * scalar;
+    result.mV[6] = mV[6] * scalar;
+    result.mV[7] = mV[7] * scalar;
+    result.mV[8] = mV[8] * scalar;
+
+    return result;
+}  // End of IvMatrix33::operator*=()
+
 //-------------------------------------------------------------------------------
 //-- Externs --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
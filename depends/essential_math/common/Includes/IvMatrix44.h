@@ -38,21 +38,20 @@ class IvMatrix44
 {
 public:
     // constructor/destructor
-    inline IvMatrix44() { Identity(); }
-    inline ~IvMatrix44() {}
+    inline constexpr IvMatrix44() : mV{} { Identity(); }
     explicit IvMatrix44( const IvQuat& quat );
     explicit IvMatrix44( const IvMatrix33& matrix );
     
     // copy operations
-    IvMatrix44(const IvMatrix44& other);
-    IvMatrix44& operator=(const IvMatrix44& other);
+    IvMatrix44(const IvMatrix44& other) = default;
+    IvMatrix44& operator=(const IvMatrix44& other) = default;
 
     // text output (for debugging)
     friend IvWriter& operator<<(IvWriter& out, const IvMatrix44& source);
 
     // accessors
-    float &operator()(unsigned int i, unsigned int j);
-    float operator()(unsigned int i, unsigned int j) const;
+    inline constexpr float &operator()(unsigned int i, unsigned int j);
+    inline constexpr float operator()(unsigned int i, unsigned int j) const;
     inline const float* GetFloatPtr() { return mV; }
 
     // comparison
@@ -71,7 +70,7 @@ public:
     void GetColumns( IvVector4& col1, IvVector4& col2, IvVector4& col3, IvVector4& col4 ); 
 
     void Clean();
-    void Identity();
+    inline constexpr void Identity();
 
     IvMatrix44& AffineInverse();
     friend IvMatrix44 AffineInverse( const IvMatrix44& mat );
@@ -98,12 +97,12 @@ public:
     // operators
 
     // addition and subtraction
-    IvMatrix44 operator+( const IvMatrix44& other ) const;
-    IvMatrix44& operator+=( const IvMatrix44& other );
-    IvMatrix44 operator-( const IvMatrix44& other ) const;
-    IvMatrix44& operator-=( const IvMatrix44& other );
+    inline constexpr IvMatrix44 operator+( const IvMatrix44& other ) const;
+    inline constexpr IvMatrix44& operator+=( const IvMatrix44& other );
+    inline constexpr IvMatrix44 operator-( const IvMatrix44& other ) const;
+    inline constexpr IvMatrix44& operator-=( const IvMatrix44& other );
 
-    IvMatrix44 operator-() const;
+    inline constexpr IvMatrix44 operator-() const;
 
     // multiplication
     IvMatrix44& operator*=( const IvMatrix44& matrix );
@@ -115,15 +114,16 @@ public:
     friend IvVector4 operator*( const IvVector4& vector, const IvMatrix44& matrix );
 
     // scalar multiplication
-    IvMatrix44& operator*=( float scalar );
-    friend IvMatrix44 operator*( float scalar, const IvMatrix44& matrix );
-    IvMatrix44 operator*( float scalar ) const;
+    inline constexpr IvMatrix44& operator*=( float scalar );
+    friend inline constexpr IvMatrix44 operator*( float scalar, const IvMatrix44& matrix );
+    inline constexpr IvMatrix44 operator*( float scalar ) const;
 
     // vector3 ops
     IvVector3 Transform( const IvVector3& point ) const;
 
     // point ops
     IvVector3 TransformPoint( const IvVector3& point ) const;
+    void TransformPoints( const IvVector3* in, IvVector3* out, unsigned int count ) const;
 
     // low-level data accessors - implementation-dependent
     operator float*() { return mV; }
@@ -148,7 +148,7 @@ IvMatrix44 Transpose( const IvMatrix44& mat );
 //-------------------------------------------------------------------------------
 // 2D array accessor
 //-------------------------------------------------------------------------------
-inline float&
+inline constexpr float&
 IvMatrix44::operator()(unsigned int i, unsigned int j)
 {
    return mV[i + 4*j];
@@ -160,13 +160,214 @@ IvMatrix44::operator()(unsigned int i, unsigned int j)
 //-------------------------------------------------------------------------------
 // 2D array accessor
 //-------------------------------------------------------------------------------
-inline float
+inline constexpr float
 IvMatrix44::operator()(unsigned int i, unsigned int j) const
 {
    return mV[i + 4*j];
 
 }   // End of IvMatrix44::operator()()
 
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::Identity()
+//-------------------------------------------------------------------------------
+// Set to identity matrix
+//-------------------------------------------------------------------------------
+inline constexpr void
+IvMatrix44::Identity()
+{
+    mV[0] = 1.0f;
+    mV[1] = 0.0f;
+    mV[2] = 0.0f;
+    mV[3] = 0.0f;
+    mV[4] = 0.0f;
+    mV[5] = 1.0f;
+    mV[6] = 0.0f;
+    mV[7] = 0.0f;
+    mV[8] = 0.0f;
+    mV[9] = 0.0f;
+    mV[10] = 1.0f;
+    mV[11] = 0.0f;
+    mV[12] = 0.0f;
+    mV[13] = 0.0f;
+    mV[14] = 0.0f;
+    mV[15] = 1.0f;
+
+}   // End of IvMatrix44::Identity()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::operator+()
+//-------------------------------------------------------------------------------
+// Matrix addition
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44
+IvMatrix44::operator+( const IvMatrix44& other ) const
+{
+    IvMatrix44 result;
+
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        result.mV[i] = mV[i] + other.mV[i];
+    }
+
+    return result;
+
+}   // End of IvMatrix44::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::operator+=()
+//-------------------------------------------------------------------------------
+// Matrix addition by self
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44&
+IvMatrix44::operator+=( const IvMatrix44& other )
+{
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        mV[i] += other.mV[i];
+    }
+
+    return *this;
+
+}   // End of IvMatrix44::operator+=()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::operator-()
+//-------------------------------------------------------------------------------
+// Matrix subtraction
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44
+IvMatrix44::operator-( const IvMatrix44& other ) const
+{
+    IvMatrix44 result;
+
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        result.mV[i] = mV[i] - other.mV[i];
+    }
+
+    return result;
+
+}   // End of IvMatrix44::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::operator-=()
+//-------------------------------------------------------------------------------
+// Matrix subtraction by self
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44&
+IvMatrix44::operator-=( const IvMatrix44& other )
+{
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        mV[i] -= other.mV[i];
+    }
+
+    return *this;
+
+}   // End of IvMatrix44::operator-=()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::operator-=() (unary)
+//-------------------------------------------------------------------------------
+// Negate self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44
+IvMatrix44::operator-() const
+{
+    IvMatrix44 result;
+
+    for (unsigned int i = 0; i < 16; ++i)
+    {
+        result.mV[i] = -mV[i];
+    }
+
+    return result;
+
+}    // End of IvQuat::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::*=()
+//-------------------------------------------------------------------------------
+// Matrix-scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44& IvMatrix44::operator*=( float scalar )
+{
+    mV[0] *= scalar;
+    mV[1] *= scalar;
+    mV[2] *= scalar;
+    mV[3] *= scalar;
+    mV[4] *= scalar;
+    mV[5] *= scalar;
+    mV[6] *= scalar;
+    mV[7] *= scalar;
+    mV[8] *= scalar;
+    mV[9] *= scalar;
+    mV[10] *= scalar;
+    mV[11] *= scalar;
+    mV[12] *= scalar;
+    mV[13] *= scalar;
+    mV[14] *= scalar;
+    mV[15] *= scalar;
+
+    return *this;
+}  // End of IvMatrix44::operator*=()
+
+//-------------------------------------------------------------------------------
+// @ friend IvMatrix44 *()
+//-------------------------------------------------------------------------------
+// Matrix-scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44 operator*( float scalar, const IvMatrix44& matrix )
+{
+    IvMatrix44 result;
+    result.mV[0] = matrix.mV[0] * scalar;
+    result.mV[1] = matrix.mV[1] * scalar;
+    result.mV[2] = matrix.mV[2] * scalar;
+    result.mV[3] = matrix.mV[3] * scalar;
+    result.mV[4] = matrix.mV[4] * scalar;
+    result.mV[5] = matrix.mV[5] * scalar;
+    result.mV[6] = matrix.mV[6] * scalar;
+    result.mV[7] = matrix.mV[7] * scalar;
+    result.mV[8] = matrix.mV[8] * scalar;
+    result.mV[9] = matrix.mV[9] * scalar;
+    result.mV[10] = matrix.mV[10] * scalar;
+    result.mV[11] = matrix.mV[11] * scalar;
+    result.mV[12] = matrix.mV[12] * scalar;
+    result.mV[13] = matrix.mV[13] * scalar;
+    result.mV[14] = matrix.mV[14] * scalar;
+    result.mV[15] = matrix.mV[15] * scalar;
+
+    return result;
+}  // End of friend IvMatrix44 operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::*()
+//-------------------------------------------------------------------------------
+// Matrix-scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvMatrix44 IvMatrix44::operator*( float scalar ) const
+{
+    IvMatrix44 result;
+    result.mV[0] = mV[0] * scalar;
+    result.mV[1] = mV[1] * scalar;
+    result.mV[2] = mV[2] * scalar;
+    result.mV[3] = mV[3] * scalar;
+    result.mV[4] = mV[4] * scalar;
+    result.mV[5] = mV[5] * scalar;
+    result.mV[6] = mV[6] * scalar;
+    result.mV[7] = mV[7] * scalar;
+    result.mV[8] = mV[8] * scalar;
+    result.mV[9] = mV[9] * scalar;
+    result.mV[10] = mV[10] * scalar;
+    result.mV[11] = mV[11] * scalar;
+    result.mV[12] = mV[12] * scalar;
+    result.mV[13] = mV[13] * scalar;
+    result.mV[14] = mV[14] * scalar;
+    result.mV[15] = mV[15] * scalar;
+
+    return result;
+}  // End of IvMatrix44::operator*=()
+
 //-------------------------------------------------------------------------------
 //-- Externs --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
@@ -75,6 +75,7 @@ public:
 
     // manipulators
     inline void Set( float _w, float _x, float _y, float _z );
+    inline void Get( float& _w, float& _x, float& _y, float& _z ) const;
     void Set( const IvVector3& axis, float angle );
     void Set( const IvVector3& from, const IvVector3& to );
     void Set( const IvMatrix33& rotation );
@@ -151,6 +152,17 @@ IvQuat::Set( float _w, float _x, float _y, float _z )
     w = _w; x = _x; y = _y; z = _z;
 }   // End of IvQuat::Set()
 
+//-------------------------------------------------------------------------------
+// @ IvQuat::Get()
+//-------------------------------------------------------------------------------
+// Get vector elements
+//-------------------------------------------------------------------------------
+inline void 
+IvQuat::Get( float& _w, float& _x, float& _y, float& _z ) const
+{
+    _w = w; _x = x; _y = y; _z = z;
+}   // End of IvQuat::Get()
+
 //-------------------------------------------------------------------------------
 // @ IvQuat::Zero()
 //-------------------------------------------------------------------------------
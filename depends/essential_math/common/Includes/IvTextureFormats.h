@@ -29,8 +29,10 @@ enum IvTextureFormat
 	kRGBAFloat16TexFmt,
 	kFloat32Fmt,
 	kFloat128Fmt,
+	kRGB9E5TexFmt,      // shared exponent, sampled only (no render target)
+	kFloat16Fmt,
     
-    kLastTexFmt = kFloat128Fmt
+    kLastTexFmt = kFloat16Fmt
 };
 static const int kTexFmtCount = kLastTexFmt+1;
 
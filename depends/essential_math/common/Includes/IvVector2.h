@@ -34,12 +34,11 @@ class IvVector2
 {
 public:
     // constructor/destructor
-    inline IvVector2() {}
-    inline IvVector2( float _x, float _y ) :
+    IvVector2() = default;
+    inline constexpr IvVector2( float _x, float _y ) :
         x(_x), y(_y)
     {
     }
-    inline ~IvVector2() {}
     
     // text output (for debugging)
     friend IvWriter& operator<<(IvWriter& out, const IvVector2& source);
@@ -49,7 +48,7 @@ public:
     inline float operator[]( unsigned int i ) const { return (&x)[i]; }
 
     float Length() const;
-    float LengthSquared() const;
+    inline constexpr float LengthSquared() const;
 
     // comparison
     bool operator==( const IvVector2& other ) const;
@@ -57,36 +56,36 @@ public:
     bool IsZero() const;
 
     // manipulators
-    inline void Set( float _x, float _y );
+    inline constexpr void Set( float _x, float _y );
     void Clean();       // sets near-zero elements to 0
-    inline void Zero(); // sets all elements to 0
+    inline constexpr void Zero(); // sets all elements to 0
     void Normalize();   // sets to unit vector
 
     // operators
-    IvVector2 operator-() const;
+    inline constexpr IvVector2 operator-() const;
 
     // addition/subtraction
-    IvVector2 operator+( const IvVector2& other ) const;
-    friend IvVector2& operator+=( IvVector2& self, const IvVector2& other );
-    IvVector2 operator-( const IvVector2& other ) const;
-    friend IvVector2& operator-=( IvVector2& self, const IvVector2& other );
+    inline constexpr IvVector2 operator+( const IvVector2& other ) const;
+    friend inline constexpr IvVector2& operator+=( IvVector2& self, const IvVector2& other );
+    inline constexpr IvVector2 operator-( const IvVector2& other ) const;
+    friend inline constexpr IvVector2& operator-=( IvVector2& self, const IvVector2& other );
 
 
     // scalar multiplication
-    IvVector2   operator*( float scalar );
-    friend IvVector2    operator*( float scalar, const IvVector2& vector );
-    IvVector2&          operator*=( float scalar );
-    IvVector2   operator/( float scalar );
-    IvVector2&          operator/=( float scalar );
+    inline constexpr IvVector2   operator*( float scalar ) const;
+    friend inline constexpr IvVector2    operator*( float scalar, const IvVector2& vector );
+    inline constexpr IvVector2&          operator*=( float scalar );
+    inline constexpr IvVector2   operator/( float scalar ) const;
+    inline constexpr IvVector2&          operator/=( float scalar );
 
     // dot product
-    float               Dot( const IvVector2& vector ) const;
-    friend float        Dot( const IvVector2& vector1, const IvVector2& vector2 );
+    inline constexpr float               Dot( const IvVector2& vector ) const;
+    friend inline constexpr float        Dot( const IvVector2& vector1, const IvVector2& vector2 );
 
     // perpendicular and cross product equivalent
-    IvVector2 Perpendicular() const { return IvVector2(-y, x); } 
-    float               PerpDot( const IvVector2& vector ) const; 
-    friend float        PerpDot( const IvVector2& vector1, const IvVector2& vector2 );
+    inline constexpr IvVector2 Perpendicular() const { return IvVector2(-y, x); } 
+    inline constexpr float               PerpDot( const IvVector2& vector ) const; 
+    friend inline constexpr float        PerpDot( const IvVector2& vector1, const IvVector2& vector2 );
 
     // useful defaults
     static IvVector2    xAxis;
@@ -107,7 +106,7 @@ public:
 //-------------------------------------------------------------------------------
 // Set vector elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvVector2::Set( float _x, float _y )
 {
     x = _x; y = _y;
@@ -118,12 +117,203 @@ IvVector2::Set( float _x, float _y )
 //-------------------------------------------------------------------------------
 // Zero all elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvVector2::Zero()
 {
     x = y = 0.0f;
 }   // End of IvVector2::Zero()
 
+//-------------------------------------------------------------------------------
+// @ IvVector2::LengthSquared()
+//-------------------------------------------------------------------------------
+// Vector length squared (avoids square root)
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvVector2::LengthSquared() const
+{
+    return (x*x + y*y);
+
+}   // End of IvVector2::LengthSquared()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::operator+()
+//-------------------------------------------------------------------------------
+// Add vector to self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2
+IvVector2::operator+( const IvVector2& other ) const
+{
+    return IvVector2( x + other.x, y + other.y );
+
+}   // End of IvVector2::operator+()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::operator+=()
+//-------------------------------------------------------------------------------
+// Add vector to self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2&
+operator+=( IvVector2& self, const IvVector2& other )
+{
+    self.x += other.x;
+    self.y += other.y;
+
+    return self;
+
+}   // End of IvVector2::operator+=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::operator-()
+//-------------------------------------------------------------------------------
+// Subtract vector from self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2
+IvVector2::operator-( const IvVector2& other ) const
+{
+    return IvVector2( x - other.x, y - other.y );
+
+}   // End of IvVector2::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::operator-=()
+//-------------------------------------------------------------------------------
+// Subtract vector from self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2&
+operator-=( IvVector2& self, const IvVector2& other )
+{
+    self.x -= other.x;
+    self.y -= other.y;
+
+    return self;
+
+}   // End of IvVector2::operator-=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::operator-() (unary)
+//-------------------------------------------------------------------------------
+// Negate self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2
+IvVector2::operator-() const
+{
+    return IvVector2(-x, -y);
+}    // End of IvVector2::operator-()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2
+IvVector2::operator*( float scalar ) const
+{
+    return IvVector2( scalar*x, scalar*y );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2
+operator*( float scalar, const IvVector2& vector )
+{
+    return IvVector2( scalar*vector.x, scalar*vector.y );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication by self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2&
+IvVector2::operator*=( float scalar )
+{
+    x *= scalar;
+    y *= scalar;
+
+    return *this;
+
+}   // End of IvVector2::operator*=()
+
+//-------------------------------------------------------------------------------
+// @ operator/()
+//-------------------------------------------------------------------------------
+// Scalar division
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2
+IvVector2::operator/( float scalar ) const
+{
+    return IvVector2( x/scalar, y/scalar );
+
+}   // End of operator/()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::operator/=()
+//-------------------------------------------------------------------------------
+// Scalar division by self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector2&
+IvVector2::operator/=( float scalar )
+{
+    x /= scalar;
+    y /= scalar;
+
+    return *this;
+
+}   // End of IvVector2::operator/=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::Dot()
+//-------------------------------------------------------------------------------
+// Dot product by self
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvVector2::Dot( const IvVector2& vector ) const
+{
+    return (x*vector.x + y*vector.y);
+
+}   // End of IvVector2::Dot()
+
+//-------------------------------------------------------------------------------
+// @ Dot()
+//-------------------------------------------------------------------------------
+// Dot product friend operator
+//-------------------------------------------------------------------------------
+inline constexpr float
+Dot( const IvVector2& vector1, const IvVector2& vector2 )
+{
+    return (vector1.x*vector2.x + vector1.y*vector2.y);
+
+}   // End of Dot()
+
+//-------------------------------------------------------------------------------
+// @ IvVector2::PerpDot()
+//-------------------------------------------------------------------------------
+// Perpendicular dot product by self
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvVector2::PerpDot( const IvVector2& vector ) const
+{
+    return (x*vector.y - y*vector.x);
+
+}   // End of IvVector2::Dot()
+
+//-------------------------------------------------------------------------------
+// @ Dot()
+//-------------------------------------------------------------------------------
+// Dot product friend operator
+//-------------------------------------------------------------------------------
+inline constexpr float
+PerpDot( const IvVector2& vector1, const IvVector2& vector2 )
+{
+    return (vector1.x*vector2.y - vector1.y*vector2.x);
+
+}   // End of Dot()
+
 //-------------------------------------------------------------------------------
 //-- Externs --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
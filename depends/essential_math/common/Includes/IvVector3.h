@@ -41,16 +41,15 @@ class IvVector3
     
 public:
     // constructor/destructor
-    inline IvVector3() {}
-    inline IvVector3( float _x, float _y, float _z ) :
+    IvVector3() = default;
+    inline constexpr IvVector3( float _x, float _y, float _z ) :
         x(_x), y(_y), z(_z)
     {
     }
-    inline ~IvVector3() {}
 
     // copy operations
-    IvVector3(const IvVector3& other);
-    IvVector3& operator=(const IvVector3& other);
+    IvVector3(const IvVector3& other) = default;
+    IvVector3& operator=(const IvVector3& other) = default;
 
     // text output (for debugging)
     friend IvWriter& operator<<(IvWriter& out, const IvVector3& source);
@@ -60,10 +59,10 @@ public:
     inline float operator[]( unsigned int i ) const { return (&x)[i]; }
 
     float Length() const;
-    float LengthSquared() const;
+    inline constexpr float LengthSquared() const;
 
     friend float Distance( const IvVector3& p0, const IvVector3& p1 );
-    friend float DistanceSquared( const IvVector3& p0, const IvVector3& p1 );
+    friend inline constexpr float DistanceSquared( const IvVector3& p0, const IvVector3& p1 );
 
     // comparison
     bool operator==( const IvVector3& other ) const;
@@ -72,36 +71,36 @@ public:
     bool IsUnit() const;
 
     // manipulators
-    inline void Set( float _x, float _y, float _z );
+    inline constexpr void Set( float _x, float _y, float _z );
     void Clean();       // sets near-zero elements to 0
-    inline void Zero(); // sets all elements to 0
+    inline constexpr void Zero(); // sets all elements to 0
     void Normalize();   // sets to unit vector
 
     // operators
 
     // addition/subtraction
-    IvVector3 operator+( const IvVector3& other ) const;
-    friend IvVector3& operator+=( IvVector3& vector, const IvVector3& other );
-    IvVector3 operator-( const IvVector3& other ) const;
-    friend IvVector3& operator-=( IvVector3& vector, const IvVector3& other );
+    inline constexpr IvVector3 operator+( const IvVector3& other ) const;
+    friend inline constexpr IvVector3& operator+=( IvVector3& vector, const IvVector3& other );
+    inline constexpr IvVector3 operator-( const IvVector3& other ) const;
+    friend inline constexpr IvVector3& operator-=( IvVector3& vector, const IvVector3& other );
 
-    IvVector3 operator-() const;
+    inline constexpr IvVector3 operator-() const;
 
     // scalar multiplication
-    IvVector3   operator*( float scalar ) const;
-    friend IvVector3    operator*( float scalar, const IvVector3& vector );
-    IvVector3&          operator*=( float scalar );
-    IvVector3   operator/( float scalar ) const;
-    IvVector3&          operator/=( float scalar );
+    inline constexpr IvVector3   operator*( float scalar ) const;
+    friend inline constexpr IvVector3    operator*( float scalar, const IvVector3& vector );
+    inline constexpr IvVector3&          operator*=( float scalar );
+    inline constexpr IvVector3   operator/( float scalar ) const;
+    inline constexpr IvVector3&          operator/=( float scalar );
 
     // dot product/cross product
-    float               Dot( const IvVector3& vector ) const;
-    friend float        Dot( const IvVector3& vector1, const IvVector3& vector2 );
-    IvVector3           Cross( const IvVector3& vector ) const;
-    friend IvVector3    Cross( const IvVector3& vector1, const IvVector3& vector2 );
+    inline constexpr float               Dot( const IvVector3& vector ) const;
+    friend inline constexpr float        Dot( const IvVector3& vector1, const IvVector3& vector2 );
+    inline constexpr IvVector3           Cross( const IvVector3& vector ) const;
+    friend inline constexpr IvVector3    Cross( const IvVector3& vector1, const IvVector3& vector2 );
 
     // matrix products
-    friend IvVector3 operator*( const IvVector3& vector, const IvMatrix33& mat );
+    friend inline constexpr IvVector3 operator*( const IvVector3& vector, const IvMatrix33& mat );
  
     // useful defaults
     static IvVector3    xAxis;
@@ -114,7 +113,7 @@ public:
 };
 
 float Distance( const IvVector3& p0, const IvVector3& p1 );
-float DistanceSquared( const IvVector3& p0, const IvVector3& p1 );
+inline constexpr float DistanceSquared( const IvVector3& p0, const IvVector3& p1 );
 
 //-------------------------------------------------------------------------------
 //-- Inlines --------------------------------------------------------------------
@@ -125,7 +124,7 @@ float DistanceSquared( const IvVector3& p0, const IvVector3& p1 );
 //-------------------------------------------------------------------------------
 // Set vector elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvVector3::Set( float _x, float _y, float _z )
 {
     x = _x; y = _y; z = _z;
@@ -136,17 +135,232 @@ IvVector3::Set( float _x, float _y, float _z )
 //-------------------------------------------------------------------------------
 // Zero all elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvVector3::Zero()
 {
     x = y = z = 0.0f;
 }   // End of IvVector3::Zero()
 
-inline IvVector3 operator*(const IvVector3& v1, const IvVector3& v2)
+inline constexpr IvVector3 operator*(const IvVector3& v1, const IvVector3& v2)
 {
 	return IvVector3{ v1.x * v2.x, v1.y * v2.y, v1.z * v2.z };
 }
 
+//-------------------------------------------------------------------------------
+// @ IvVector3::LengthSquared()
+//-------------------------------------------------------------------------------
+// Vector length squared (avoids square root)
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvVector3::LengthSquared() const
+{
+    return (x*x + y*y + z*z);
+
+}   // End of IvVector3::LengthSquared()
+
+//-------------------------------------------------------------------------------
+// @ ::DistanceSquared()
+//-------------------------------------------------------------------------------
+// Point distance
+//-------------------------------------------------------------------------------
+inline constexpr float
+DistanceSquared( const IvVector3& p0, const IvVector3& p1 )
+{
+    float x = p0.x - p1.x;
+    float y = p0.y - p1.y;
+    float z = p0.z - p1.z;
+
+    return ( x*x + y*y + z*z );
+
+}   // End of ::DistanceSquared()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::operator+()
+//-------------------------------------------------------------------------------
+// Add vector to self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+IvVector3::operator+( const IvVector3& other ) const
+{
+    return IvVector3( x + other.x, y + other.y, z + other.z );
+
+}   // End of IvVector3::operator+()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::operator+=()
+//-------------------------------------------------------------------------------
+// Add vector to self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3&
+operator+=( IvVector3& self, const IvVector3& other )
+{
+    self.x += other.x;
+    self.y += other.y;
+    self.z += other.z;
+
+    return self;
+
+}   // End of IvVector3::operator+=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::operator-()
+//-------------------------------------------------------------------------------
+// Subtract vector from self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+IvVector3::operator-( const IvVector3& other ) const
+{
+    return IvVector3( x - other.x, y - other.y, z - other.z );
+
+}   // End of IvVector3::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::operator-=()
+//-------------------------------------------------------------------------------
+// Subtract vector from self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3&
+operator-=( IvVector3& self, const IvVector3& other )
+{
+    self.x -= other.x;
+    self.y -= other.y;
+    self.z -= other.z;
+
+    return self;
+
+}   // End of IvVector3::operator-=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::operator-=() (unary)
+//-------------------------------------------------------------------------------
+// Negate self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+IvVector3::operator-() const
+{
+    return IvVector3(-x, -y, -z);
+}    // End of IvVector3::operator-()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+IvVector3::operator*( float scalar ) const
+{
+    return IvVector3( scalar*x, scalar*y, scalar*z );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+operator*( float scalar, const IvVector3& vector )
+{
+    return IvVector3( scalar*vector.x, scalar*vector.y, scalar*vector.z );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication by self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3&
+IvVector3::operator*=( float scalar )
+{
+    x *= scalar;
+    y *= scalar;
+    z *= scalar;
+
+    return *this;
+
+}   // End of IvVector3::operator*=()
+
+//-------------------------------------------------------------------------------
+// @ operator/()
+//-------------------------------------------------------------------------------
+// Scalar division
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+IvVector3::operator/( float scalar ) const
+{
+    return IvVector3( x/scalar, y/scalar, z/scalar );
+
+}   // End of operator/()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::operator/=()
+//-------------------------------------------------------------------------------
+// Scalar division by self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3&
+IvVector3::operator/=( float scalar )
+{
+    x /= scalar;
+    y /= scalar;
+    z /= scalar;
+
+    return *this;
+
+}   // End of IvVector3::operator/=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::Dot()
+//-------------------------------------------------------------------------------
+// Dot product by self
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvVector3::Dot( const IvVector3& vector ) const
+{
+    return (x*vector.x + y*vector.y + z*vector.z);
+
+}   // End of IvVector3::Dot()
+
+//-------------------------------------------------------------------------------
+// @ Dot()
+//-------------------------------------------------------------------------------
+// Dot product friend operator
+//-------------------------------------------------------------------------------
+inline constexpr float
+Dot( const IvVector3& vector1, const IvVector3& vector2 )
+{
+    return (vector1.x*vector2.x + vector1.y*vector2.y + vector1.z*vector2.z);
+
+}   // End of Dot()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3::Cross()
+//-------------------------------------------------------------------------------
+// Cross product by self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+IvVector3::Cross( const IvVector3& vector ) const
+{
+    return IvVector3( y*vector.z - z*vector.y,
+                      z*vector.x - x*vector.z,
+                      x*vector.y - y*vector.x );
+
+}   // End of IvVector3::Cross()
+
+//-------------------------------------------------------------------------------
+// @ Cross()
+//-------------------------------------------------------------------------------
+// Cross product friend operator
+//-------------------------------------------------------------------------------
+inline constexpr IvVector3
+Cross( const IvVector3& vector1, const IvVector3& vector2 )
+{
+    return IvVector3( vector1.y*vector2.z - vector1.z*vector2.y,
+                      vector1.z*vector2.x - vector1.x*vector2.z,
+                      vector1.x*vector2.y - vector1.y*vector2.x );
+
+}   // End of Cross()
+
 //-------------------------------------------------------------------------------
 //-- Externs --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
@@ -38,16 +38,15 @@ class IvVector4
     
 public:
     // constructor/destructor
-    inline IvVector4() {}
-    inline IvVector4( float _x, float _y, float _z, float _w ) :
+    IvVector4() = default;
+    inline constexpr IvVector4( float _x, float _y, float _z, float _w ) :
         x(_x), y(_y), z(_z), w(_w)
     {
     }
-    inline ~IvVector4() {}
 
     // copy operations
-    IvVector4(const IvVector4& other);
-    IvVector4& operator=(const IvVector4& other);
+    IvVector4(const IvVector4& other) = default;
+    IvVector4& operator=(const IvVector4& other) = default;
 
     // text output (for debugging)
     friend IvWriter& operator<<(IvWriter& out, const IvVector4& source);
@@ -57,7 +56,7 @@ public:
     inline float operator[]( unsigned int i ) const    { return (&x)[i]; }
 
     float Length() const;
-    float LengthSquared() const;
+    inline constexpr float LengthSquared() const;
 
     // comparison
     bool operator==( const IvVector4& other ) const;
@@ -66,29 +65,29 @@ public:
     bool IsUnit() const;
 
     // manipulators
-    inline void Set( float _x, float _y, float _z, float _w );
+    inline constexpr void Set( float _x, float _y, float _z, float _w );
     void Clean();       // sets near-zero elements to 0
-    inline void Zero(); // sets all elements to 0
+    inline constexpr void Zero(); // sets all elements to 0
     void Normalize();   // sets to unit vector
 
     // operators
 
     // addition/subtraction
-    IvVector4 operator+( const IvVector4& other ) const;
-    IvVector4& operator+=( const IvVector4& other );
-    IvVector4 operator-( const IvVector4& other ) const;
-    IvVector4& operator-=( const IvVector4& other );
+    inline constexpr IvVector4 operator+( const IvVector4& other ) const;
+    inline constexpr IvVector4& operator+=( const IvVector4& other );
+    inline constexpr IvVector4 operator-( const IvVector4& other ) const;
+    inline constexpr IvVector4& operator-=( const IvVector4& other );
 
     // scalar multiplication
-    IvVector4    operator*( float scalar );
-    friend IvVector4    operator*( float scalar, const IvVector4& vector );
-    IvVector4&          operator*=( float scalar );
-    IvVector4    operator/( float scalar );
-    IvVector4&          operator/=( float scalar );
+    inline constexpr IvVector4    operator*( float scalar ) const;
+    friend inline constexpr IvVector4    operator*( float scalar, const IvVector4& vector );
+    inline constexpr IvVector4&          operator*=( float scalar );
+    inline constexpr IvVector4    operator/( float scalar ) const;
+    inline constexpr IvVector4&          operator/=( float scalar );
 
     // dot product
-    float              Dot( const IvVector4& vector ) const;
-    friend float       Dot( const IvVector4& vector1, const IvVector4& vector2 );
+    inline constexpr float              Dot( const IvVector4& vector ) const;
+    friend inline constexpr float       Dot( const IvVector4& vector1, const IvVector4& vector2 );
 
     // matrix products
     friend IvVector4 operator*( const IvVector4& vector, const IvMatrix44& mat );
@@ -113,7 +112,7 @@ public:
 //-------------------------------------------------------------------------------
 // Set vector elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvVector4::Set( float _x, float _y, float _z, float _w )
 {
     x = _x; y = _y; z = _z; w = _w;
@@ -124,12 +123,179 @@ IvVector4::Set( float _x, float _y, float _z, float _w )
 //-------------------------------------------------------------------------------
 // Zero all elements
 //-------------------------------------------------------------------------------
-inline void 
+inline constexpr void
 IvVector4::Zero()
 {
     x = y = z = w = 0.0f;
 }   // End of IvVector4::Zero()
 
+//-------------------------------------------------------------------------------
+// @ IvVector4::LengthSquared()
+//-------------------------------------------------------------------------------
+// Vector length squared (avoids square root)
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvVector4::LengthSquared() const
+{
+    return ( x*x + y*y + z*z + w*w );
+
+}   // End of IvVector4::LengthSquared()
+
+//-------------------------------------------------------------------------------
+// @ IvVector4::operator+()
+//-------------------------------------------------------------------------------
+// Add vector to self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4
+IvVector4::operator+( const IvVector4& other ) const
+{
+    return IvVector4( x + other.x, y + other.y, z + other.z, w + other.w );
+
+}   // End of IvVector4::operator+()
+
+//-------------------------------------------------------------------------------
+// @ IvVector4::operator+=()
+//-------------------------------------------------------------------------------
+// Add vector to self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4&
+IvVector4::operator+=( const IvVector4& other )
+{
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    w += other.w;
+
+    return *this;
+
+}   // End of IvVector4::operator+=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector4::operator-()
+//-------------------------------------------------------------------------------
+// Subtract vector from self and return
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4
+IvVector4::operator-( const IvVector4& other ) const
+{
+    return IvVector4( x - other.x, y - other.y, z - other.z, w - other.w );
+
+}   // End of IvVector4::operator-()
+
+//-------------------------------------------------------------------------------
+// @ IvVector4::operator-=()
+//-------------------------------------------------------------------------------
+// Subtract vector from self, store in self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4&
+IvVector4::operator-=( const IvVector4& other )
+{
+    x -= other.x;
+    y -= other.y;
+    z -= other.z;
+    w -= other.w;
+
+    return *this;
+
+}   // End of IvVector4::operator-=()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4
+IvVector4::operator*( float scalar ) const
+{
+    return IvVector4( scalar*x, scalar*y, scalar*z,
+                      scalar*w );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4
+operator*( float scalar, const IvVector4& vector )
+{
+    return IvVector4( scalar*vector.x, scalar*vector.y, scalar*vector.z,
+                      scalar*vector.w );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvVector4::operator*()
+//-------------------------------------------------------------------------------
+// Scalar multiplication by self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4&
+IvVector4::operator*=( float scalar )
+{
+    x *= scalar;
+    y *= scalar;
+    z *= scalar;
+    w *= scalar;
+
+    return *this;
+
+}   // End of IvVector4::operator*()
+
+//-------------------------------------------------------------------------------
+// @ operator/()
+//-------------------------------------------------------------------------------
+// Scalar division
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4
+IvVector4::operator/( float scalar ) const
+{
+    return IvVector4( x/scalar, y/scalar, z/scalar, w/scalar );
+
+}   // End of operator*()
+
+//-------------------------------------------------------------------------------
+// @ IvVector4::operator/=()
+//-------------------------------------------------------------------------------
+// Scalar division by self
+//-------------------------------------------------------------------------------
+inline constexpr IvVector4&
+IvVector4::operator/=( float scalar )
+{
+    x /= scalar;
+    y /= scalar;
+    z /= scalar;
+    w /= scalar;
+
+    return *this;
+
+}   // End of IvVector4::operator/=()
+
+//-------------------------------------------------------------------------------
+// @ IvVector4::Dot()
+//-------------------------------------------------------------------------------
+// Dot product by self
+//-------------------------------------------------------------------------------
+inline constexpr float
+IvVector4::Dot( const IvVector4& vector ) const
+{
+    return (x*vector.x + y*vector.y + z*vector.z + w*vector.w);
+
+}   // End of IvVector4::Dot()
+
+//-------------------------------------------------------------------------------
+// @ Dot()
+//-------------------------------------------------------------------------------
+// Dot product friend operator
+//-------------------------------------------------------------------------------
+inline constexpr float
+Dot( const IvVector4& vector1, const IvVector4& vector2 )
+{
+    return (vector1.x*vector2.x + vector1.y*vector2.y + vector1.z*vector2.z
+            + vector1.w*vector2.w);
+
+}   // End of Dot()
+
 //-------------------------------------------------------------------------------
 //-- Externs --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
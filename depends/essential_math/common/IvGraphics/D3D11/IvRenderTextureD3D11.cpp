@@ -3,6 +3,7 @@
 #include "D3D11\IvRendererD3D11.h"
 
 #include <d3d11.h>
+#include <cstring>
 
 void IvRenderTextureD3D11::Destroy()
 {
@@ -138,7 +139,9 @@ bool IvRenderTextureD3D11::Resize(size_t width, size_t height, size_t depth, IvT
 	textureDesc.MipLevels = 0;
 	textureDesc.Format = D3DTextureFormatMapping[format];
 	textureDesc.Usage = D3D11_USAGE_DEFAULT;
-	textureDesc.BindFlags = D3D10_BIND_RENDER_TARGET | D3D10_BIND_SHADER_RESOURCE;
+	// shared exponent formats can't be rendered to, only loaded with LoadData
+	const bool renderable = format != kRGB9E5TexFmt;
+	textureDesc.BindFlags = renderable ? D3D10_BIND_RENDER_TARGET | D3D10_BIND_SHADER_RESOURCE : D3D10_BIND_SHADER_RESOURCE;
 	textureDesc.CPUAccessFlags = 0;
 	textureDesc.MiscFlags = 0;
 
@@ -149,19 +152,22 @@ bool IvRenderTextureD3D11::Resize(size_t width, size_t height, size_t depth, IvT
 		return false;
 	}
 
-	// Setup the description of the render target view.
-	D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc;
-	renderTargetViewDesc.Format = textureDesc.Format;
-	renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE3D;
-	renderTargetViewDesc.Texture3D.MipSlice = 0;
-	renderTargetViewDesc.Texture3D.FirstWSlice = 0;
-	renderTargetViewDesc.Texture3D.WSize = (UINT)(-1);
-
-	// Create the render target view.
-	result = device->CreateRenderTargetView(mTexturePtr, &renderTargetViewDesc, &mRenderTargetView);
-	if (FAILED(result))
+	if (renderable)
 	{
-		return false;
+		// Setup the description of the render target view.
+		D3D11_RENDER_TARGET_VIEW_DESC renderTargetViewDesc;
+		renderTargetViewDesc.Format = textureDesc.Format;
+		renderTargetViewDesc.ViewDimension = D3D11_RTV_DIMENSION_TEXTURE3D;
+		renderTargetViewDesc.Texture3D.MipSlice = 0;
+		renderTargetViewDesc.Texture3D.FirstWSlice = 0;
+		renderTargetViewDesc.Texture3D.WSize = (UINT)(-1);
+
+		// Create the render target view.
+		result = device->CreateRenderTargetView(mTexturePtr, &renderTargetViewDesc, &mRenderTargetView);
+		if (FAILED(result))
+		{
+			return false;
+		}
 	}
 
 	// Setup the description of the shader resource view.
@@ -184,7 +190,7 @@ bool IvRenderTextureD3D11::Resize(size_t width, size_t height, size_t depth, IvT
 void IvRenderTextureD3D11::Set3DSlice(size_t sliceNum)
 {
 	// Check if texture is actuall 3d
-	if (mWidth == 0) return;
+	if (mWidth == 0 || !mRenderTargetView) return;
 
 	mRenderTargetView->Release();
 	mRenderTargetView = nullptr;
@@ -209,3 +215,78 @@ void IvRenderTextureD3D11::Set3DSlice(size_t sliceNum)
 		// do nothing
 	}
 }
+
+bool IvRenderTextureD3D11::LoadData(const void* data)
+{
+	if (!mTexturePtr || !data) return false;
+
+	auto& d3d11renderer = static_cast<IvRendererD3D11&>(*IvRenderer::mRenderer);
+	unsigned int texelSize = sInternalTextureFormatSize[mFormat];
+	d3d11renderer.GetContext()->UpdateSubresource(mTexturePtr, 0, nullptr, data,
+		mWidth * texelSize, mWidth * mHeight * texelSize);
+	return true;
+}
+
+bool IvRenderTextureD3D11::ReadData(void* data)
+{
+	if (!mTexturePtr || !data) return false;
+
+	auto& d3d11renderer = static_cast<IvRendererD3D11&>(*IvRenderer::mRenderer);
+	auto* device = d3d11renderer.GetDevice();
+	auto* context = d3d11renderer.GetContext();
+	const unsigned int texelSize = sInternalTextureFormatSize[mFormat];
+	const unsigned int depth = Is3D() ? mDepth : 1;
+
+	// copy to a staging texture of the same size, then map that one
+	ID3D11Resource* staging = nullptr;
+	HRESULT result;
+	if (Is3D())
+	{
+		D3D11_TEXTURE3D_DESC desc;
+		static_cast<ID3D11Texture3D*>(mTexturePtr)->GetDesc(&desc);
+		desc.MipLevels = 1;
+		desc.Usage = D3D11_USAGE_STAGING;
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		result = device->CreateTexture3D(&desc, nullptr, (ID3D11Texture3D**)&staging);
+	}
+	else
+	{
+		D3D11_TEXTURE2D_DESC desc;
+		static_cast<ID3D11Texture2D*>(mTexturePtr)->GetDesc(&desc);
+		desc.Usage = D3D11_USAGE_STAGING;
+		desc.BindFlags = 0;
+		desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+		result = device->CreateTexture2D(&desc, nullptr, (ID3D11Texture2D**)&staging);
+	}
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	context->CopySubresourceRegion(staging, 0, 0, 0, 0, mTexturePtr, 0, nullptr);
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	result = context->Map(staging, 0, D3D11_MAP_READ, 0, &mapped);
+	if (FAILED(result))
+	{
+		staging->Release();
+		return false;
+	}
+
+	// rows of the mapped texture may be padded
+	const unsigned int rowSize = mWidth * texelSize;
+	unsigned char* out = static_cast<unsigned char*>(data);
+	for (unsigned int z = 0; z < depth; ++z)
+	{
+		for (unsigned int y = 0; y < mHeight; ++y)
+		{
+			const unsigned char* row = static_cast<const unsigned char*>(mapped.pData) + z * mapped.DepthPitch + y * mapped.RowPitch;
+			memcpy(out, row, rowSize);
+			out += rowSize;
+		}
+	}
+
+	context->Unmap(staging, 0);
+	staging->Release();
+	return true;
+}
@@ -17,6 +17,8 @@ public:
 	virtual bool Resize(size_t width, size_t height, IvTextureFormat format, IvResourceManager& resman) override final;
 	virtual bool Resize(size_t width, size_t height, size_t depth, IvTextureFormat format, IvResourceManager & resman) override final;
 	virtual void Set3DSlice(size_t sliceNum) override final;
+	virtual bool LoadData(const void* data) override final;
+	virtual bool ReadData(void* data) override final;
 
 	ID3D11RenderTargetView* GetTargetView() { return mRenderTargetView; }
 	ID3D11RenderTargetView** GetPtrToTargetView() { return &mRenderTargetView; }
@@ -7,6 +7,10 @@ public:
 	virtual bool Resize(size_t width, size_t height, IvTextureFormat format, class IvResourceManager& renderer) = 0;
 	virtual bool Resize(size_t width, size_t height, size_t depth, IvTextureFormat format, IvResourceManager & resman) = 0;
 	virtual void Set3DSlice(size_t sliceNum) = 0;
+	// Replaces the whole texture (all slices) with tightly packed texels of its format.
+	virtual bool LoadData(const void* data) = 0;
+	// Copies the whole texture back, tightly packed; waits for the GPU.
+	virtual bool ReadData(void* data) = 0;
 
 	IvRenderTexture() {};
 	virtual ~IvRenderTexture() {};
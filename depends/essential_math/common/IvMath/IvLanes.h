@@ -0,0 +1,311 @@
+//===============================================================================
+// @ IvLanes.h
+//
+// Fixed-width SIMD lanes of float or double for the batch math types
+// ------------------------------------------------------------------------------
+//
+// IvFloat4, IvFloat8, IvDouble2, IvDouble4 and IvDouble8 hold 4, 8, 2, 4
+// and 8 values and share one interface: broadcast construction, Load() and
+// Store() of contiguous (unaligned) values, + - * /, Sqrt(), Min(), Max(),
+// Abs() and SelectGreaterEqual(). Each maps to native registers where the
+// path in IvSIMD.h has them (SSE: 4 floats or 2 doubles, AVX: 8 floats or
+// 4 doubles) and to two halves or a plain array otherwise, so code written
+// against one width compiles everywhere.
+//
+// Every lane is computed with the IEEE operation of the scalar code, so a
+// lane gives the same bits as the scalar expression it replaces.
+//
+//===============================================================================
+
+#ifndef __IvLanes__h__
+#define __IvLanes__h__
+
+//-------------------------------------------------------------------------------
+//-- Dependencies ---------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+#include "IvSIMD.h"
+#include <math.h>
+
+//-------------------------------------------------------------------------------
+//-- Classes --------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------
+// @ IvScalarLanes
+//-------------------------------------------------------------------------------
+// Portable lanes, a plain array the compiler may vectorize on its own
+//-------------------------------------------------------------------------------
+template <typename T, unsigned int N>
+class IvScalarLanes
+{
+public:
+    typedef T Scalar;
+    enum { Width = N };
+
+    inline IvScalarLanes() {}
+    inline explicit IvScalarLanes( T s )         { for (unsigned int i = 0; i < N; ++i) v[i] = s; }
+
+    static inline IvScalarLanes Load( const T* p )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = p[i];
+        return r;
+    }
+    inline void Store( T* p ) const              { for (unsigned int i = 0; i < N; ++i) p[i] = v[i]; }
+
+    friend inline IvScalarLanes operator+( const IvScalarLanes& a, const IvScalarLanes& b )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = a.v[i] + b.v[i];
+        return r;
+    }
+    friend inline IvScalarLanes operator-( const IvScalarLanes& a, const IvScalarLanes& b )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = a.v[i] - b.v[i];
+        return r;
+    }
+    friend inline IvScalarLanes operator*( const IvScalarLanes& a, const IvScalarLanes& b )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = a.v[i] * b.v[i];
+        return r;
+    }
+    friend inline IvScalarLanes operator/( const IvScalarLanes& a, const IvScalarLanes& b )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = a.v[i] / b.v[i];
+        return r;
+    }
+    friend inline IvScalarLanes Sqrt( const IvScalarLanes& a )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = sqrt( a.v[i] );
+        return r;
+    }
+    friend inline IvScalarLanes Min( const IvScalarLanes& a, const IvScalarLanes& b )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+        return r;
+    }
+    friend inline IvScalarLanes Max( const IvScalarLanes& a, const IvScalarLanes& b )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+        return r;
+    }
+    friend inline IvScalarLanes Abs( const IvScalarLanes& a )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = fabs( a.v[i] );
+        return r;
+    }
+    // a >= b ? x : y per lane
+    friend inline IvScalarLanes SelectGreaterEqual( const IvScalarLanes& a, const IvScalarLanes& b,
+                                                    const IvScalarLanes& x, const IvScalarLanes& y )
+    {
+        IvScalarLanes r;
+        for (unsigned int i = 0; i < N; ++i) r.v[i] = a.v[i] >= b.v[i] ? x.v[i] : y.v[i];
+        return r;
+    }
+
+    T v[N];
+};
+
+//-------------------------------------------------------------------------------
+// @ IvLanePair
+//-------------------------------------------------------------------------------
+// Twice the lanes of H, as two halves
+//-------------------------------------------------------------------------------
+template <typename H>
+class IvLanePair
+{
+public:
+    typedef typename H::Scalar Scalar;
+    enum { Width = 2*H::Width };
+
+    inline IvLanePair() {}
+    inline IvLanePair( const H& _lo, const H& _hi ) : lo(_lo), hi(_hi) {}
+    inline explicit IvLanePair( Scalar s ) : lo(s), hi(s) {}
+
+    static inline IvLanePair Load( const Scalar* p )  { return IvLanePair( H::Load( p ), H::Load( p + H::Width ) ); }
+    inline void Store( Scalar* p ) const             { lo.Store( p ); hi.Store( p + H::Width ); }
+
+    friend inline IvLanePair operator+( const IvLanePair& a, const IvLanePair& b ) { return IvLanePair( a.lo + b.lo, a.hi + b.hi ); }
+    friend inline IvLanePair operator-( const IvLanePair& a, const IvLanePair& b ) { return IvLanePair( a.lo - b.lo, a.hi - b.hi ); }
+    friend inline IvLanePair operator*( const IvLanePair& a, const IvLanePair& b ) { return IvLanePair( a.lo * b.lo, a.hi * b.hi ); }
+    friend inline IvLanePair operator/( const IvLanePair& a, const IvLanePair& b ) { return IvLanePair( a.lo / b.lo, a.hi / b.hi ); }
+    friend inline IvLanePair Sqrt( const IvLanePair& a )                          { return IvLanePair( Sqrt( a.lo ), Sqrt( a.hi ) ); }
+    friend inline IvLanePair Min( const IvLanePair& a, const IvLanePair& b )      { return IvLanePair( Min( a.lo, b.lo ), Min( a.hi, b.hi ) ); }
+    friend inline IvLanePair Max( const IvLanePair& a, const IvLanePair& b )      { return IvLanePair( Max( a.lo, b.lo ), Max( a.hi, b.hi ) ); }
+    friend inline IvLanePair Abs( const IvLanePair& a )                           { return IvLanePair( Abs( a.lo ), Abs( a.hi ) ); }
+    friend inline IvLanePair SelectGreaterEqual( const IvLanePair& a, const IvLanePair& b,
+                                                 const IvLanePair& x, const IvLanePair& y )
+    {
+        return IvLanePair( SelectGreaterEqual( a.lo, b.lo, x.lo, y.lo ), SelectGreaterEqual( a.hi, b.hi, x.hi, y.hi ) );
+    }
+
+    H lo, hi;
+};
+
+#if defined(IV_SIMD_SSE)
+
+//-------------------------------------------------------------------------------
+// @ IvFloat4
+//-------------------------------------------------------------------------------
+// 4 floats in an SSE register
+//-------------------------------------------------------------------------------
+class IvFloat4
+{
+public:
+    typedef float Scalar;
+    enum { Width = 4 };
+
+    inline IvFloat4() {}
+    inline IvFloat4( __m128 _v ) : v(_v) {}
+    inline explicit IvFloat4( float s ) : v(_mm_set1_ps( s )) {}
+
+    static inline IvFloat4 Load( const float* p )  { return _mm_loadu_ps( p ); }
+    inline void Store( float* p ) const           { _mm_storeu_ps( p, v ); }
+
+    friend inline IvFloat4 operator+( const IvFloat4& a, const IvFloat4& b ) { return _mm_add_ps( a.v, b.v ); }
+    friend inline IvFloat4 operator-( const IvFloat4& a, const IvFloat4& b ) { return _mm_sub_ps( a.v, b.v ); }
+    friend inline IvFloat4 operator*( const IvFloat4& a, const IvFloat4& b ) { return _mm_mul_ps( a.v, b.v ); }
+    friend inline IvFloat4 operator/( const IvFloat4& a, const IvFloat4& b ) { return _mm_div_ps( a.v, b.v ); }
+    friend inline IvFloat4 Sqrt( const IvFloat4& a )                        { return _mm_sqrt_ps( a.v ); }
+    friend inline IvFloat4 Min( const IvFloat4& a, const IvFloat4& b )      { return _mm_min_ps( a.v, b.v ); }
+    friend inline IvFloat4 Max( const IvFloat4& a, const IvFloat4& b )      { return _mm_max_ps( a.v, b.v ); }
+    friend inline IvFloat4 Abs( const IvFloat4& a )                         { return _mm_andnot_ps( _mm_set1_ps( -0.0f ), a.v ); }
+    friend inline IvFloat4 SelectGreaterEqual( const IvFloat4& a, const IvFloat4& b, const IvFloat4& x, const IvFloat4& y )
+    {
+        __m128 mask = _mm_cmpge_ps( a.v, b.v );
+        return _mm_or_ps( _mm_and_ps( mask, x.v ), _mm_andnot_ps( mask, y.v ) );
+    }
+
+    __m128 v;
+};
+
+//-------------------------------------------------------------------------------
+// @ IvDouble2
+//-------------------------------------------------------------------------------
+// 2 doubles in an SSE2 register
+//-------------------------------------------------------------------------------
+class IvDouble2
+{
+public:
+    typedef double Scalar;
+    enum { Width = 2 };
+
+    inline IvDouble2() {}
+    inline IvDouble2( __m128d _v ) : v(_v) {}
+    inline explicit IvDouble2( double s ) : v(_mm_set1_pd( s )) {}
+
+    static inline IvDouble2 Load( const double* p )  { return _mm_loadu_pd( p ); }
+    inline void Store( double* p ) const            { _mm_storeu_pd( p, v ); }
+
+    friend inline IvDouble2 operator+( const IvDouble2& a, const IvDouble2& b ) { return _mm_add_pd( a.v, b.v ); }
+    friend inline IvDouble2 operator-( const IvDouble2& a, const IvDouble2& b ) { return _mm_sub_pd( a.v, b.v ); }
+    friend inline IvDouble2 operator*( const IvDouble2& a, const IvDouble2& b ) { return _mm_mul_pd( a.v, b.v ); }
+    friend inline IvDouble2 operator/( const IvDouble2& a, const IvDouble2& b ) { return _mm_div_pd( a.v, b.v ); }
+    friend inline IvDouble2 Sqrt( const IvDouble2& a )                         { return _mm_sqrt_pd( a.v ); }
+    friend inline IvDouble2 Min( const IvDouble2& a, const IvDouble2& b )      { return _mm_min_pd( a.v, b.v ); }
+    friend inline IvDouble2 Max( const IvDouble2& a, const IvDouble2& b )      { return _mm_max_pd( a.v, b.v ); }
+    friend inline IvDouble2 Abs( const IvDouble2& a )                          { return _mm_andnot_pd( _mm_set1_pd( -0.0 ), a.v ); }
+    friend inline IvDouble2 SelectGreaterEqual( const IvDouble2& a, const IvDouble2& b, const IvDouble2& x, const IvDouble2& y )
+    {
+        __m128d mask = _mm_cmpge_pd( a.v, b.v );
+        return _mm_or_pd( _mm_and_pd( mask, x.v ), _mm_andnot_pd( mask, y.v ) );
+    }
+
+    __m128d v;
+};
+
+#else
+
+typedef IvScalarLanes<float, 4> IvFloat4;
+typedef IvScalarLanes<double, 2> IvDouble2;
+
+#endif
+
+#if defined(IV_SIMD_AVX)
+
+//-------------------------------------------------------------------------------
+// @ IvFloat8
+//-------------------------------------------------------------------------------
+// 8 floats in an AVX register
+//-------------------------------------------------------------------------------
+class IvFloat8
+{
+public:
+    typedef float Scalar;
+    enum { Width = 8 };
+
+    inline IvFloat8() {}
+    inline IvFloat8( __m256 _v ) : v(_v) {}
+    inline explicit IvFloat8( float s ) : v(_mm256_set1_ps( s )) {}
+
+    static inline IvFloat8 Load( const float* p )  { return _mm256_loadu_ps( p ); }
+    inline void Store( float* p ) const           { _mm256_storeu_ps( p, v ); }
+
+    friend inline IvFloat8 operator+( const IvFloat8& a, const IvFloat8& b ) { return _mm256_add_ps( a.v, b.v ); }
+    friend inline IvFloat8 operator-( const IvFloat8& a, const IvFloat8& b ) { return _mm256_sub_ps( a.v, b.v ); }
+    friend inline IvFloat8 operator*( const IvFloat8& a, const IvFloat8& b ) { return _mm256_mul_ps( a.v, b.v ); }
+    friend inline IvFloat8 operator/( const IvFloat8& a, const IvFloat8& b ) { return _mm256_div_ps( a.v, b.v ); }
+    friend inline IvFloat8 Sqrt( const IvFloat8& a )                        { return _mm256_sqrt_ps( a.v ); }
+    friend inline IvFloat8 Min( const IvFloat8& a, const IvFloat8& b )      { return _mm256_min_ps( a.v, b.v ); }
+    friend inline IvFloat8 Max( const IvFloat8& a, const IvFloat8& b )      { return _mm256_max_ps( a.v, b.v ); }
+    friend inline IvFloat8 Abs( const IvFloat8& a )                         { return _mm256_andnot_ps( _mm256_set1_ps( -0.0f ), a.v ); }
+    friend inline IvFloat8 SelectGreaterEqual( const IvFloat8& a, const IvFloat8& b, const IvFloat8& x, const IvFloat8& y )
+    {
+        return _mm256_blendv_ps( y.v, x.v, _mm256_cmp_ps( a.v, b.v, _CMP_GE_OQ ) );
+    }
+
+    __m256 v;
+};
+
+//-------------------------------------------------------------------------------
+// @ IvDouble4
+//-------------------------------------------------------------------------------
+// 4 doubles in an AVX register
+//-------------------------------------------------------------------------------
+class IvDouble4
+{
+public:
+    typedef double Scalar;
+    enum { Width = 4 };
+
+    inline IvDouble4() {}
+    inline IvDouble4( __m256d _v ) : v(_v) {}
+    inline explicit IvDouble4( double s ) : v(_mm256_set1_pd( s )) {}
+
+    static inline IvDouble4 Load( const double* p )  { return _mm256_loadu_pd( p ); }
+    inline void Store( double* p ) const            { _mm256_storeu_pd( p, v ); }
+
+    friend inline IvDouble4 operator+( const IvDouble4& a, const IvDouble4& b ) { return _mm256_add_pd( a.v, b.v ); }
+    friend inline IvDouble4 operator-( const IvDouble4& a, const IvDouble4& b ) { return _mm256_sub_pd( a.v, b.v ); }
+    friend inline IvDouble4 operator*( const IvDouble4& a, const IvDouble4& b ) { return _mm256_mul_pd( a.v, b.v ); }
+    friend inline IvDouble4 operator/( const IvDouble4& a, const IvDouble4& b ) { return _mm256_div_pd( a.v, b.v ); }
+    friend inline IvDouble4 Sqrt( const IvDouble4& a )                         { return _mm256_sqrt_pd( a.v ); }
+    friend inline IvDouble4 Min( const IvDouble4& a, const IvDouble4& b )      { return _mm256_min_pd( a.v, b.v ); }
+    friend inline IvDouble4 Max( const IvDouble4& a, const IvDouble4& b )      { return _mm256_max_pd( a.v, b.v ); }
+    friend inline IvDouble4 Abs( const IvDouble4& a )                          { return _mm256_andnot_pd( _mm256_set1_pd( -0.0 ), a.v ); }
+    friend inline IvDouble4 SelectGreaterEqual( const IvDouble4& a, const IvDouble4& b, const IvDouble4& x, const IvDouble4& y )
+    {
+        return _mm256_blendv_pd( y.v, x.v, _mm256_cmp_pd( a.v, b.v, _CMP_GE_OQ ) );
+    }
+
+    __m256d v;
+};
+
+#else
+
+typedef IvLanePair<IvFloat4> IvFloat8;
+typedef IvLanePair<IvDouble2> IvDouble4;
+
+#endif
+
+typedef IvLanePair<IvDouble4> IvDouble8;
+
+#endif
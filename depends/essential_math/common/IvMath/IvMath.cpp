@@ -16,6 +16,7 @@
 //----------------------------------------------------------------------------
 
 #include "IvMath.h"
+#include "IvSIMD.h"
 
 //----------------------------------------------------------------------------
 //-- Static Variables --------------------------------------------------------
@@ -113,3 +114,19 @@ void IvFastSinCos( float a, float& sina, float& cosa )
 }  // End of IvFastSinCos
 
 
+//-------------------------------------------------------------------------------
+// @ IvSIMDPath()
+//-------------------------------------------------------------------------------
+// Name of the code path compiled into the library, for logs and benchmarks
+//-------------------------------------------------------------------------------
+const char* IvSIMDPath()
+{
+#if defined(IV_SIMD_AVX)
+    return "avx";
+#elif defined(IV_SIMD_SSE)
+    return "sse";
+#else
+    return "scalar";
+#endif
+
+}   // End of IvSIMDPath()
@@ -42,53 +42,6 @@ IvMatrix33::IvMatrix33( const IvQuat& quat )
 }   // End of IvMatrix33::IvMatrix33()
 
 
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::IvMatrix33()
-//-------------------------------------------------------------------------------
-// Copy constructor
-//-------------------------------------------------------------------------------
-IvMatrix33::IvMatrix33(const IvMatrix33& other)
-{
-    mV[0] = other.mV[0];
-    mV[1] = other.mV[1];
-    mV[2] = other.mV[2];
-    mV[3] = other.mV[3];
-    mV[4] = other.mV[4];
-    mV[5] = other.mV[5];
-    mV[6] = other.mV[6];
-    mV[7] = other.mV[7];
-    mV[8] = other.mV[8];
-
-}   // End of IvMatrix33::IvMatrix33()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator=()
-//-------------------------------------------------------------------------------
-// Assignment operator
-//-------------------------------------------------------------------------------
-IvMatrix33&
-IvMatrix33::operator=(const IvMatrix33& other)
-{
-    // if same object
-    if ( this == &other )
-        return *this;
-        
-    mV[0] = other.mV[0];
-    mV[1] = other.mV[1];
-    mV[2] = other.mV[2];
-    mV[3] = other.mV[3];
-    mV[4] = other.mV[4];
-    mV[5] = other.mV[5];
-    mV[6] = other.mV[6];
-    mV[7] = other.mV[7];
-    mV[8] = other.mV[8];
-    
-    return *this;
-
-}   // End of IvMatrix33::operator=()
-
-
 //-------------------------------------------------------------------------------
 // @ operator<<()
 //-------------------------------------------------------------------------------
@@ -325,27 +278,6 @@ IvMatrix33::Clean()
 }   // End of IvMatrix33::Clean()
 
 
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::Identity()
-//-------------------------------------------------------------------------------
-// Set to identity matrix
-//-------------------------------------------------------------------------------
-void
-IvMatrix33::Identity()
-{
-    mV[0] = 1.0f;
-    mV[1] = 0.0f;
-    mV[2] = 0.0f;
-    mV[3] = 0.0f;
-    mV[4] = 1.0f;
-    mV[5] = 0.0f;
-    mV[6] = 0.0f;
-    mV[7] = 0.0f;
-    mV[8] = 1.0f;
-
-}   // End of IvMatrix33::Identity()
-
-
 //-------------------------------------------------------------------------------
 // @ IvMatrix33::Inverse()
 //-------------------------------------------------------------------------------
@@ -402,112 +334,6 @@ Inverse( const IvMatrix33& mat )
 }   // End of IvMatrix33::Inverse()
 
 
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::Transpose()
-//-------------------------------------------------------------------------------
-// Set self to transpose
-//-------------------------------------------------------------------------------
-IvMatrix33& 
-IvMatrix33::Transpose()
-{
-    float temp = mV[1];
-    mV[1] = mV[3];
-    mV[3] = temp;
-
-    temp = mV[2];
-    mV[2] = mV[6];
-    mV[6] = temp;
-
-    temp = mV[5];
-    mV[5] = mV[7];
-    mV[7] = temp;
-
-    return *this;
-
-}   // End of IvMatrix33::Transpose()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::Transpose()
-//-------------------------------------------------------------------------------
-// Compute matrix transpose
-//-------------------------------------------------------------------------------
-IvMatrix33 
-Transpose( const IvMatrix33& mat )
-{
-    IvMatrix33 result;
-
-    result.mV[0] = mat.mV[0];
-    result.mV[1] = mat.mV[3];
-    result.mV[2] = mat.mV[6];
-    result.mV[3] = mat.mV[1];
-    result.mV[4] = mat.mV[4];
-    result.mV[5] = mat.mV[7];
-    result.mV[6] = mat.mV[2];
-    result.mV[7] = mat.mV[5];
-    result.mV[8] = mat.mV[8];
-
-    return result;
-
-}   // End of IvMatrix33::Transpose()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::Determinant()
-//-------------------------------------------------------------------------------
-// Get determinant of matrix
-//-------------------------------------------------------------------------------
-float 
-IvMatrix33::Determinant() const
-{
-    return mV[0]*(mV[4]*mV[8] - mV[5]*mV[7]) 
-         + mV[3]*(mV[2]*mV[7] - mV[1]*mV[8])
-         + mV[6]*(mV[1]*mV[5] - mV[2]*mV[4]);
-
-}   // End of IvMatrix33::Determinant()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::Adjoint()
-//-------------------------------------------------------------------------------
-// Compute matrix adjoint
-//-------------------------------------------------------------------------------
-IvMatrix33 
-IvMatrix33::Adjoint() const
-{
-    IvMatrix33 result;
-    
-    // compute transpose of cofactors
-    result.mV[0] = mV[4]*mV[8] - mV[5]*mV[7];
-    result.mV[1] = mV[2]*mV[7] - mV[1]*mV[8];
-    result.mV[2] = mV[1]*mV[5] - mV[2]*mV[4];
-   
-    result.mV[3] = mV[5]*mV[6] - mV[3]*mV[8];
-    result.mV[4] = mV[0]*mV[8] - mV[2]*mV[6];
-    result.mV[5] = mV[2]*mV[3] - mV[0]*mV[5];
-
-    result.mV[6] = mV[3]*mV[7] - mV[4]*mV[6];
-    result.mV[7] = mV[1]*mV[6] - mV[0]*mV[7];
-    result.mV[8] = mV[0]*mV[4] - mV[1]*mV[3];
-
-    return result;
-
-}   // End of IvMatrix33::Adjoint()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::Trace()
-//-------------------------------------------------------------------------------
-// Get trace of matrix
-//-------------------------------------------------------------------------------
-float 
-IvMatrix33::Trace() const
-{
-    return mV[0] + mV[4] + mV[8];
-
-}   // End of IvMatrix33::Trace()
-
-
 //-------------------------------------------------------------------------------
 // @ IvMatrix33::Rotation()
 //-------------------------------------------------------------------------------
@@ -603,7 +429,7 @@ IvMatrix33::Rotation( const IvVector3& axis, float angle )
     // intermediate values
     float tx = t*nAxis.x;  float ty = t*nAxis.y;  float tz = t*nAxis.z;
     float sx = s*nAxis.x;  float sy = s*nAxis.y;  float sz = s*nAxis.z;
-    float txy = tx*nAxis.y; float tyz = tx*nAxis.z; float txz = tx*nAxis.z;
+    float txy = tx*nAxis.y; float tyz = ty*nAxis.z; float txz = tx*nAxis.z;
 
     // set matrix
     mV[0] = tx*nAxis.x + c;
@@ -805,258 +631,3 @@ IvMatrix33::GetAxisAngle( IvVector3& axis, float& angle )
 
 }  // End of IvMatrix33::GetAxisAngle()
 
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator+()
-//-------------------------------------------------------------------------------
-// Matrix addition 
-//-------------------------------------------------------------------------------
-IvMatrix33
-IvMatrix33::operator+( const IvMatrix33& other ) const
-{
-    IvMatrix33 result;
-
-    for (unsigned int i = 0; i < 9; ++i)
-    {
-        result.mV[i] = mV[i] + other.mV[i];
-    }
-
-    return result;
-
-}   // End of IvMatrix33::operator-()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator+=()
-//-------------------------------------------------------------------------------
-// Matrix addition by self
-//-------------------------------------------------------------------------------
-IvMatrix33&
-IvMatrix33::operator+=( const IvMatrix33& other )
-{
-    for (unsigned int i = 0; i < 9; ++i)
-    {
-        mV[i] += other.mV[i];
-    }
-
-    return *this;
-
-}   // End of IvMatrix33::operator+=()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator-()
-//-------------------------------------------------------------------------------
-// Matrix subtraction 
-//-------------------------------------------------------------------------------
-IvMatrix33
-IvMatrix33::operator-( const IvMatrix33& other ) const
-{
-    IvMatrix33 result;
-
-    for (unsigned int i = 0; i < 9; ++i)
-    {
-        result.mV[i] = mV[i] - other.mV[i];
-    }
-
-    return result;
-
-}   // End of IvMatrix33::operator-()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator-=()
-//-------------------------------------------------------------------------------
-// Matrix subtraction by self
-//-------------------------------------------------------------------------------
-IvMatrix33&
-IvMatrix33::operator-=( const IvMatrix33& other )
-{
-    for (unsigned int i = 0; i < 9; ++i)
-    {
-        mV[i] -= other.mV[i];
-    }
-
-    return *this;
-
-}   // End of IvMatrix33::operator-=()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator-=() (unary)
-//-------------------------------------------------------------------------------
-// Negate self and return
-//-------------------------------------------------------------------------------
-IvMatrix33
-IvMatrix33::operator-() const
-{
-    IvMatrix33 result;
-
-    for (unsigned int i = 0; i < 9; ++i)
-    {
-        result.mV[i] = -mV[i];
-    }
-
-    return result;
-
-}    // End of IvQuat::operator-()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator*()
-//-------------------------------------------------------------------------------
-// Matrix multiplication
-//-------------------------------------------------------------------------------
-IvMatrix33  
-IvMatrix33::operator*( const IvMatrix33& other ) const
-{
-    IvMatrix33 result;
-
-    result.mV[0] = mV[0]*other.mV[0] + mV[3]*other.mV[1] + mV[6]*other.mV[2];
-    result.mV[1] = mV[1]*other.mV[0] + mV[4]*other.mV[1] + mV[7]*other.mV[2];
-    result.mV[2] = mV[2]*other.mV[0] + mV[5]*other.mV[1] + mV[8]*other.mV[2];
-    result.mV[3] = mV[0]*other.mV[3] + mV[3]*other.mV[4] + mV[6]*other.mV[5];
-    result.mV[4] = mV[1]*other.mV[3] + mV[4]*other.mV[4] + mV[7]*other.mV[5];
-    result.mV[5] = mV[2]*other.mV[3] + mV[5]*other.mV[4] + mV[8]*other.mV[5];
-    result.mV[6] = mV[0]*other.mV[6] + mV[3]*other.mV[7] + mV[6]*other.mV[8];
-    result.mV[7] = mV[1]*other.mV[6] + mV[4]*other.mV[7] + mV[7]*other.mV[8];
-    result.mV[8] = mV[2]*other.mV[6] + mV[5]*other.mV[7] + mV[8]*other.mV[8];
-
-    return result;
-
-}   // End of IvMatrix33::operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator*=()
-//-------------------------------------------------------------------------------
-// Matrix multiplication by self
-//-------------------------------------------------------------------------------
-IvMatrix33&
-IvMatrix33::operator*=( const IvMatrix33& other )
-{
-    IvMatrix33 result;
-
-    result.mV[0] = mV[0]*other.mV[0] + mV[3]*other.mV[1] + mV[6]*other.mV[2];
-    result.mV[1] = mV[1]*other.mV[0] + mV[4]*other.mV[1] + mV[7]*other.mV[2];
-    result.mV[2] = mV[2]*other.mV[0] + mV[5]*other.mV[1] + mV[8]*other.mV[2];
-    result.mV[3] = mV[0]*other.mV[3] + mV[3]*other.mV[4] + mV[6]*other.mV[5];
-    result.mV[4] = mV[1]*other.mV[3] + mV[4]*other.mV[4] + mV[7]*other.mV[5];
-    result.mV[5] = mV[2]*other.mV[3] + mV[5]*other.mV[4] + mV[8]*other.mV[5];
-    result.mV[6] = mV[0]*other.mV[6] + mV[3]*other.mV[7] + mV[6]*other.mV[8];
-    result.mV[7] = mV[1]*other.mV[6] + mV[4]*other.mV[7] + mV[7]*other.mV[8];
-    result.mV[8] = mV[2]*other.mV[6] + mV[5]*other.mV[7] + mV[8]*other.mV[8];
-
-    for (unsigned int i = 0; i < 9; ++i)
-    {
-        mV[i] = result.mV[i];
-    }
-
-    return *this;
-
-}   // End of IvMatrix33::operator*=()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator*()
-//-------------------------------------------------------------------------------
-// Matrix-column vector multiplication
-//-------------------------------------------------------------------------------
-IvVector3   
-IvMatrix33::operator*( const IvVector3& other ) const
-{
-    IvVector3 result;
-
-    result.x = mV[0]*other.x + mV[3]*other.y + mV[6]*other.z;
-    result.y = mV[1]*other.x + mV[4]*other.y + mV[7]*other.z;
-    result.z = mV[2]*other.x + mV[5]*other.y + mV[8]*other.z;
-
-    return result;
-
-}   // End of IvMatrix33::operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::operator*()
-//-------------------------------------------------------------------------------
-// Row vector-matrix multiplication
-//-------------------------------------------------------------------------------
-IvVector3   
-operator*( const IvVector3& vector, const IvMatrix33& mat )
-{
-    IvVector3 result;
-
-    result.x = mat.mV[0]*vector.x + mat.mV[1]*vector.y + mat.mV[2]*vector.z;
-    result.y = mat.mV[3]*vector.x + mat.mV[4]*vector.y + mat.mV[5]*vector.z;
-    result.z = mat.mV[6]*vector.x + mat.mV[7]*vector.y + mat.mV[8]*vector.z;
-
-    return result;
-
-}   // End of IvMatrix33::operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::*=()
-//-------------------------------------------------------------------------------
-// Matrix-scalar multiplication
-//-------------------------------------------------------------------------------
-IvMatrix33& IvMatrix33::operator*=( float scalar )
-{
-    mV[0] *= scalar;
-    mV[1] *= scalar;
-    mV[2] *= scalar;
-    mV[3] *= scalar;
-    mV[4] *= scalar;
-    mV[5] *= scalar;
-    mV[6] *= scalar;
-    mV[7] *= scalar;
-    mV[8] *= scalar;
-
-    return *this;
-}  // End of IvMatrix33::operator*=()
-
-
-//-------------------------------------------------------------------------------
-// @ friend IvMatrix33 *()
-//-------------------------------------------------------------------------------
-// Matrix-scalar multiplication
-//-------------------------------------------------------------------------------
-IvMatrix33 operator*( float scalar, const IvMatrix33& matrix )
-{
-    IvMatrix33 result;
-    result.mV[0] = matrix.mV[0] * scalar;
-    result.mV[1] = matrix.mV[1] * scalar;
-    result.mV[2] = matrix.mV[2] * scalar;
-    result.mV[3] = matrix.mV[3] * scalar;
-    result.mV[4] = matrix.mV[4] * scalar;
-    result.mV[5] = matrix.mV[5] * scalar;
-    result.mV[6] = matrix.mV[6] * scalar;
-    result.mV[7] = matrix.mV[7] * scalar;
-    result.mV[8] = matrix.mV[8] * scalar;
-
-    return result;
-}  // End of friend IvMatrix33 operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix33::*()
-//-------------------------------------------------------------------------------
-// Matrix-scalar multiplication
-//-------------------------------------------------------------------------------
-IvMatrix33 IvMatrix33::operator*( float scalar ) const
-{
-    IvMatrix33 result;
-    result.mV[0] = mV[0] * scalar;
-    result.mV[1] = mV[1] * scalar;
-    result.mV[2] = mV[2] * scalar;
-    result.mV[3] = mV[3] * scalar;
-    result.mV[4] = mV[4] * scalar;
-    result.mV[5] = mV[5] * scalar;
-    result.mV[6] = mV[6] * scalar;
-    result.mV[7] = mV[7] * scalar;
-    result.mV[8] = mV[8] * scalar;
-
-    return result;
-}  // End of IvMatrix33::operator*=()
-
-
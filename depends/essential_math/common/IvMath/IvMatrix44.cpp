@@ -23,97 +23,109 @@
 #include "IvVector4.h"
 
 #include "IvAssert.h"
+#include "IvSIMD.h"
 
 //-------------------------------------------------------------------------------
 //-- Static Members -------------------------------------------------------------
 //-------------------------------------------------------------------------------
 
-//-------------------------------------------------------------------------------
-//-- Methods --------------------------------------------------------------------
-//-------------------------------------------------------------------------------
+#if defined(IV_SIMD_SSE)
+#define IV_SPLAT( v, i ) _mm_shuffle_ps( (v), (v), _MM_SHUFFLE( i, i, i, i ) )
 
 //-------------------------------------------------------------------------------
-// @ IvMatrix44::IvMatrix44()
+// @ ::SIMDMultiply()
 //-------------------------------------------------------------------------------
-// Axis-angle constructor
+// result = a*b for column-major arrays, in the order of the scalar code;
+// result may alias a or b
 //-------------------------------------------------------------------------------
-IvMatrix44::IvMatrix44( const IvQuat& quat )
+static inline void
+SIMDMultiply( float* result, const float* a, const float* b )
 {
-    (void) Rotation( quat );
+    __m128 a0 = _mm_loadu_ps( a );
+    __m128 a1 = _mm_loadu_ps( a + 4 );
+    __m128 a2 = _mm_loadu_ps( a + 8 );
+    __m128 a3 = _mm_loadu_ps( a + 12 );
+
+#if defined(IV_SIMD_AVX)
+    // two result columns per register
+    __m256 a00 = _mm256_insertf128_ps( _mm256_castps128_ps256( a0 ), a0, 1 );
+    __m256 a11 = _mm256_insertf128_ps( _mm256_castps128_ps256( a1 ), a1, 1 );
+    __m256 a22 = _mm256_insertf128_ps( _mm256_castps128_ps256( a2 ), a2, 1 );
+    __m256 a33 = _mm256_insertf128_ps( _mm256_castps128_ps256( a3 ), a3, 1 );
+    __m256 b01 = _mm256_loadu_ps( b );
+    __m256 b23 = _mm256_loadu_ps( b + 8 );
+
+    __m256 r01 = _mm256_mul_ps( a00, _mm256_shuffle_ps( b01, b01, 0x00 ) );
+    r01 = _mm256_add_ps( r01, _mm256_mul_ps( a11, _mm256_shuffle_ps( b01, b01, 0x55 ) ) );
+    r01 = _mm256_add_ps( r01, _mm256_mul_ps( a22, _mm256_shuffle_ps( b01, b01, 0xaa ) ) );
+    r01 = _mm256_add_ps( r01, _mm256_mul_ps( a33, _mm256_shuffle_ps( b01, b01, 0xff ) ) );
+
+    __m256 r23 = _mm256_mul_ps( a00, _mm256_shuffle_ps( b23, b23, 0x00 ) );
+    r23 = _mm256_add_ps( r23, _mm256_mul_ps( a11, _mm256_shuffle_ps( b23, b23, 0x55 ) ) );
+    r23 = _mm256_add_ps( r23, _mm256_mul_ps( a22, _mm256_shuffle_ps( b23, b23, 0xaa ) ) );
+    r23 = _mm256_add_ps( r23, _mm256_mul_ps( a33, _mm256_shuffle_ps( b23, b23, 0xff ) ) );
+
+    _mm256_storeu_ps( result, r01 );
+    _mm256_storeu_ps( result + 8, r23 );
+#else
+    // column j of b is read before column j of result is written
+    for (unsigned int j = 0; j < 16; j += 4)
+    {
+        __m128 bj = _mm_loadu_ps( b + j );
+        __m128 r = _mm_mul_ps( a0, IV_SPLAT( bj, 0 ) );
+        r = _mm_add_ps( r, _mm_mul_ps( a1, IV_SPLAT( bj, 1 ) ) );
+        r = _mm_add_ps( r, _mm_mul_ps( a2, IV_SPLAT( bj, 2 ) ) );
+        r = _mm_add_ps( r, _mm_mul_ps( a3, IV_SPLAT( bj, 3 ) ) );
+        _mm_storeu_ps( result + j, r );
+    }
+#endif
 
-}   // End of IvMatrix44::IvMatrix44()
+}   // End of ::SIMDMultiply()
 
 
 //-------------------------------------------------------------------------------
-// @ IvMatrix44::IvMatrix44()
+// @ ::SIMDCross()
 //-------------------------------------------------------------------------------
-// Copy constructor
+// Cross product of the xyz lanes, w is 0
 //-------------------------------------------------------------------------------
-IvMatrix44::IvMatrix44(const IvMatrix44& other)
+static inline __m128
+SIMDCross( __m128 a, __m128 b )
 {
-    mV[0] = other.mV[0];
-    mV[1] = other.mV[1];
-    mV[2] = other.mV[2];
-    mV[3] = other.mV[3];
-    mV[4] = other.mV[4];
-    mV[5] = other.mV[5];
-    mV[6] = other.mV[6];
-    mV[7] = other.mV[7];
-    mV[8] = other.mV[8];
-    mV[9] = other.mV[9];
-    mV[10] = other.mV[10];
-    mV[11] = other.mV[11];
-    mV[12] = other.mV[12];
-    mV[13] = other.mV[13];
-    mV[14] = other.mV[14];
-    mV[15] = other.mV[15];
+    __m128 a_yzx = _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+    __m128 b_yzx = _mm_shuffle_ps( b, b, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+    __m128 a_zxy = _mm_shuffle_ps( a, a, _MM_SHUFFLE( 3, 1, 0, 2 ) );
+    __m128 b_zxy = _mm_shuffle_ps( b, b, _MM_SHUFFLE( 3, 1, 0, 2 ) );
+    return _mm_sub_ps( _mm_mul_ps( a_yzx, b_zxy ), _mm_mul_ps( a_zxy, b_yzx ) );
 
-}   // End of IvMatrix44::IvMatrix44()
+}   // End of ::SIMDCross()
+#endif
+
+//-------------------------------------------------------------------------------
+//-- Methods --------------------------------------------------------------------
+//-------------------------------------------------------------------------------
 
 //-------------------------------------------------------------------------------
 // @ IvMatrix44::IvMatrix44()
 //-------------------------------------------------------------------------------
-// IvMatrix33 conversion constructor
+// Axis-angle constructor
 //-------------------------------------------------------------------------------
-IvMatrix44::IvMatrix44(const IvMatrix33& other)
+IvMatrix44::IvMatrix44( const IvQuat& quat )
 {
-    (void) Rotation( other );
+    (void) Rotation( quat );
 
 }   // End of IvMatrix44::IvMatrix44()
 
 
 //-------------------------------------------------------------------------------
-// @ IvMatrix44::operator=()
+// @ IvMatrix44::IvMatrix44()
 //-------------------------------------------------------------------------------
-// Assignment operator
+// IvMatrix33 conversion constructor
 //-------------------------------------------------------------------------------
-IvMatrix44&
-IvMatrix44::operator=(const IvMatrix44& other)
+IvMatrix44::IvMatrix44(const IvMatrix33& other)
 {
-    // if same object
-    if ( this == &other )
-        return *this;
-        
-    mV[0] = other.mV[0];
-    mV[1] = other.mV[1];
-    mV[2] = other.mV[2];
-    mV[3] = other.mV[3];
-    mV[4] = other.mV[4];
-    mV[5] = other.mV[5];
-    mV[6] = other.mV[6];
-    mV[7] = other.mV[7];
-    mV[8] = other.mV[8];
-    mV[9] = other.mV[9];
-    mV[10] = other.mV[10];
-    mV[11] = other.mV[11];
-    mV[12] = other.mV[12];
-    mV[13] = other.mV[13];
-    mV[14] = other.mV[14];
-    mV[15] = other.mV[15];
-    
-    return *this;
+    (void) Rotation( other );
 
-}   // End of IvMatrix44::operator=()
+}   // End of IvMatrix44::IvMatrix44()
 
 
 //-------------------------------------------------------------------------------
@@ -240,34 +252,6 @@ IvMatrix44::Clean()
 }   // End of IvMatrix44::Clean()
 
 
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::Identity()
-//-------------------------------------------------------------------------------
-// Set to identity matrix
-//-------------------------------------------------------------------------------
-void
-IvMatrix44::Identity()
-{
-    mV[0] = 1.0f;
-    mV[1] = 0.0f;
-    mV[2] = 0.0f;
-    mV[3] = 0.0f;
-    mV[4] = 0.0f;
-    mV[5] = 1.0f;
-    mV[6] = 0.0f;
-    mV[7] = 0.0f;
-    mV[8] = 0.0f;
-    mV[9] = 0.0f;
-    mV[10] = 1.0f;
-    mV[11] = 0.0f;
-    mV[12] = 0.0f;
-    mV[13] = 0.0f;
-    mV[14] = 0.0f;
-    mV[15] = 1.0f;
-
-}   // End of IvMatrix44::Identity()
-
-
 //-----------------------------------------------------------------------------
 // @ IvMatrix44::AffineInverse()
 //-----------------------------------------------------------------------------
@@ -295,6 +279,45 @@ AffineInverse( const IvMatrix44& mat )
 {
     IvMatrix44 result;
     
+#if defined(IV_SIMD_SSE)
+    __m128 c0 = _mm_loadu_ps( mat.mV );
+    __m128 c1 = _mm_loadu_ps( mat.mV + 4 );
+    __m128 c2 = _mm_loadu_ps( mat.mV + 8 );
+
+    // rows of the adjunct of the upper 3x3 are the cross products of its columns
+    __m128 r0 = SIMDCross( c1, c2 );
+    __m128 r1 = SIMDCross( c2, c0 );
+    __m128 r2 = SIMDCross( c0, c1 );
+    __m128 r3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+
+    float cofactors[4];
+    _mm_storeu_ps( cofactors, r0 );
+    float det = mat.mV[0]*cofactors[0] + mat.mV[4]*cofactors[1] + mat.mV[8]*cofactors[2];
+    if (IvIsZero( det ))
+    {
+        ASSERT( false );
+        ERROR_OUT( "Matrix44::Inverse() -- singular matrix\n" );
+        return result;
+    }
+
+    __m128 invDet = _mm_set1_ps( 1.0f/det );
+    r0 = _mm_mul_ps( invDet, r0 );
+    r1 = _mm_mul_ps( invDet, r1 );
+    r2 = _mm_mul_ps( invDet, r2 );
+
+    // multiply -translation by inverted 3x3 to get its inverse
+    __m128 xlate = _mm_loadu_ps( mat.mV + 12 );
+    r3 = _mm_xor_ps( _mm_mul_ps( r0, IV_SPLAT( xlate, 0 ) ), _mm_set1_ps( -0.0f ) );
+    r3 = _mm_sub_ps( r3, _mm_mul_ps( r1, IV_SPLAT( xlate, 1 ) ) );
+    r3 = _mm_sub_ps( r3, _mm_mul_ps( r2, IV_SPLAT( xlate, 2 ) ) );
+
+    _mm_storeu_ps( result.mV, r0 );
+    _mm_storeu_ps( result.mV + 4, r1 );
+    _mm_storeu_ps( result.mV + 8, r2 );
+    _mm_storeu_ps( result.mV + 12, r3 );
+    result.mV[15] = 1.0f;
+#else
     // compute upper left 3x3 matrix determinant
     float cofactor0 = mat.mV[5]*mat.mV[10] - mat.mV[6]*mat.mV[9];
     float cofactor4 = mat.mV[2]*mat.mV[9] - mat.mV[1]*mat.mV[10];
@@ -326,6 +349,7 @@ AffineInverse( const IvMatrix44& mat )
     result.mV[12] = -result.mV[0]*mat.mV[12] - result.mV[4]*mat.mV[13] - result.mV[8]*mat.mV[14];
     result.mV[13] = -result.mV[1]*mat.mV[12] - result.mV[5]*mat.mV[13] - result.mV[9]*mat.mV[14];
     result.mV[14] = -result.mV[2]*mat.mV[12] - result.mV[6]*mat.mV[13] - result.mV[10]*mat.mV[14];
+#endif
 
     return result;
 
@@ -340,6 +364,17 @@ AffineInverse( const IvMatrix44& mat )
 IvMatrix44& 
 IvMatrix44::Transpose()
 {
+#if defined(IV_SIMD_SSE)
+    __m128 c0 = _mm_loadu_ps( mV );
+    __m128 c1 = _mm_loadu_ps( mV + 4 );
+    __m128 c2 = _mm_loadu_ps( mV + 8 );
+    __m128 c3 = _mm_loadu_ps( mV + 12 );
+    _MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+    _mm_storeu_ps( mV, c0 );
+    _mm_storeu_ps( mV + 4, c1 );
+    _mm_storeu_ps( mV + 8, c2 );
+    _mm_storeu_ps( mV + 12, c3 );
+#else
     float temp = mV[1];
     mV[1] = mV[4];
     mV[4] = temp;
@@ -363,6 +398,7 @@ IvMatrix44::Transpose()
     temp = mV[11];
     mV[11] = mV[14];
     mV[14] = temp;
+#endif
 
     return *this;
 
@@ -379,6 +415,17 @@ Transpose( const IvMatrix44& mat )
 {
     IvMatrix44 result;
 
+#if defined(IV_SIMD_SSE)
+    __m128 c0 = _mm_loadu_ps( mat.mV );
+    __m128 c1 = _mm_loadu_ps( mat.mV + 4 );
+    __m128 c2 = _mm_loadu_ps( mat.mV + 8 );
+    __m128 c3 = _mm_loadu_ps( mat.mV + 12 );
+    _MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+    _mm_storeu_ps( result.mV, c0 );
+    _mm_storeu_ps( result.mV + 4, c1 );
+    _mm_storeu_ps( result.mV + 8, c2 );
+    _mm_storeu_ps( result.mV + 12, c3 );
+#else
     result.mV[0] = mat.mV[0];
     result.mV[1] = mat.mV[4];
     result.mV[2] = mat.mV[8];
@@ -395,6 +442,7 @@ Transpose( const IvMatrix44& mat )
     result.mV[13] = mat.mV[7];
     result.mV[14] = mat.mV[11];
     result.mV[15] = mat.mV[15];
+#endif
 
     return result;
 
@@ -813,102 +861,6 @@ IvMatrix44::GetAxisAngle( IvVector3& axis, float& angle )
 }  // End of IvMatrix44::GetAxisAngle()
 
 
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::operator+()
-//-------------------------------------------------------------------------------
-// Matrix addition 
-//-------------------------------------------------------------------------------
-IvMatrix44
-IvMatrix44::operator+( const IvMatrix44& other ) const
-{
-    IvMatrix44 result;
-
-    for (unsigned int i = 0; i < 16; ++i)
-    {
-        result.mV[i] = mV[i] + other.mV[i];
-    }
-
-    return result;
-
-}   // End of IvMatrix44::operator-()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::operator+=()
-//-------------------------------------------------------------------------------
-// Matrix addition by self
-//-------------------------------------------------------------------------------
-IvMatrix44&
-IvMatrix44::operator+=( const IvMatrix44& other )
-{
-    for (unsigned int i = 0; i < 16; ++i)
-    {
-        mV[i] += other.mV[i];
-    }
-
-    return *this;
-
-}   // End of IvMatrix44::operator+=()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::operator-()
-//-------------------------------------------------------------------------------
-// Matrix subtraction 
-//-------------------------------------------------------------------------------
-IvMatrix44
-IvMatrix44::operator-( const IvMatrix44& other ) const
-{
-    IvMatrix44 result;
-
-    for (unsigned int i = 0; i < 16; ++i)
-    {
-        result.mV[i] = mV[i] - other.mV[i];
-    }
-
-    return result;
-
-}   // End of IvMatrix44::operator-()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::operator-=()
-//-------------------------------------------------------------------------------
-// Matrix subtraction by self
-//-------------------------------------------------------------------------------
-IvMatrix44&
-IvMatrix44::operator-=( const IvMatrix44& other )
-{
-    for (unsigned int i = 0; i < 16; ++i)
-    {
-        mV[i] -= other.mV[i];
-    }
-
-    return *this;
-
-}   // End of IvMatrix44::operator-=()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::operator-=() (unary)
-//-------------------------------------------------------------------------------
-// Negate self and return
-//-------------------------------------------------------------------------------
-IvMatrix44
-IvMatrix44::operator-() const
-{
-    IvMatrix44 result;
-
-    for (unsigned int i = 0; i < 16; ++i)
-    {
-        result.mV[i] = -mV[i];
-    }
-
-    return result;
-
-}    // End of IvQuat::operator-()
-
-
 //-------------------------------------------------------------------------------
 // @ IvMatrix44::operator*()
 //-------------------------------------------------------------------------------
@@ -919,6 +871,9 @@ IvMatrix44::operator*( const IvMatrix44& other ) const
 {
     IvMatrix44 result;
 
+#if defined(IV_SIMD_SSE)
+    SIMDMultiply( result.mV, mV, other.mV );
+#else
     result.mV[0] = mV[0]*other.mV[0] + mV[4]*other.mV[1] + mV[8]*other.mV[2] 
                     + mV[12]*other.mV[3];
     result.mV[1] = mV[1]*other.mV[0] + mV[5]*other.mV[1] + mV[9]*other.mV[2] 
@@ -954,6 +909,7 @@ IvMatrix44::operator*( const IvMatrix44& other ) const
                     + mV[14]*other.mV[15];
     result.mV[15] = mV[3]*other.mV[12] + mV[7]*other.mV[13] + mV[11]*other.mV[14] 
                     + mV[15]*other.mV[15];
+#endif
 
     return result;
 
@@ -968,6 +924,9 @@ IvMatrix44::operator*( const IvMatrix44& other ) const
 IvMatrix44&
 IvMatrix44::operator*=( const IvMatrix44& other )
 {
+#if defined(IV_SIMD_SSE)
+    SIMDMultiply( mV, mV, other.mV );
+#else
     IvMatrix44 result;
 
     result.mV[0] = mV[0]*other.mV[0] + mV[4]*other.mV[1] + mV[8]*other.mV[2] 
@@ -1010,6 +969,7 @@ IvMatrix44::operator*=( const IvMatrix44& other )
     {
         mV[i] = result.mV[i];
     }
+#endif
 
     return *this;
 
@@ -1026,10 +986,19 @@ IvMatrix44::operator*( const IvVector4& other ) const
 {
     IvVector4 result;
 
+#if defined(IV_SIMD_SSE)
+    __m128 v = _mm_loadu_ps( &other.x );
+    __m128 r = _mm_mul_ps( _mm_loadu_ps( mV ), IV_SPLAT( v, 0 ) );
+    r = _mm_add_ps( r, _mm_mul_ps( _mm_loadu_ps( mV + 4 ), IV_SPLAT( v, 1 ) ) );
+    r = _mm_add_ps( r, _mm_mul_ps( _mm_loadu_ps( mV + 8 ), IV_SPLAT( v, 2 ) ) );
+    r = _mm_add_ps( r, _mm_mul_ps( _mm_loadu_ps( mV + 12 ), IV_SPLAT( v, 3 ) ) );
+    _mm_storeu_ps( &result.x, r );
+#else
     result.x = mV[0]*other.x + mV[4]*other.y + mV[8]*other.z + mV[12]*other.w;
     result.y = mV[1]*other.x + mV[5]*other.y + mV[9]*other.z + mV[13]*other.w;
     result.z = mV[2]*other.x + mV[6]*other.y + mV[10]*other.z + mV[14]*other.w;
     result.w = mV[3]*other.x + mV[7]*other.y + mV[11]*other.z + mV[15]*other.w;
+#endif
 
     return result;
 
@@ -1046,6 +1015,20 @@ operator*( const IvVector4& vector, const IvMatrix44& matrix )
 {
     IvVector4 result;
 
+#if defined(IV_SIMD_SSE)
+    // the rows of the transpose against the vector, as for a column vector
+    __m128 c0 = _mm_loadu_ps( matrix.mV );
+    __m128 c1 = _mm_loadu_ps( matrix.mV + 4 );
+    __m128 c2 = _mm_loadu_ps( matrix.mV + 8 );
+    __m128 c3 = _mm_loadu_ps( matrix.mV + 12 );
+    _MM_TRANSPOSE4_PS( c0, c1, c2, c3 );
+    __m128 v = _mm_loadu_ps( &vector.x );
+    __m128 r = _mm_mul_ps( c0, IV_SPLAT( v, 0 ) );
+    r = _mm_add_ps( r, _mm_mul_ps( c1, IV_SPLAT( v, 1 ) ) );
+    r = _mm_add_ps( r, _mm_mul_ps( c2, IV_SPLAT( v, 2 ) ) );
+    r = _mm_add_ps( r, _mm_mul_ps( c3, IV_SPLAT( v, 3 ) ) );
+    _mm_storeu_ps( &result.x, r );
+#else
     result.x = matrix.mV[0]*vector.x + matrix.mV[1]*vector.y 
              + matrix.mV[2]*vector.z + matrix.mV[3]*vector.w;
     result.y = matrix.mV[4]*vector.x + matrix.mV[5]*vector.y 
@@ -1054,98 +1037,13 @@ operator*( const IvVector4& vector, const IvMatrix44& matrix )
              + matrix.mV[10]*vector.z + matrix.mV[11]*vector.w;
     result.w = matrix.mV[12]*vector.x + matrix.mV[13]*vector.y 
              + matrix.mV[14]*vector.z + matrix.mV[15]*vector.w;
+#endif
 
     return result;
 
 }   // End of IvMatrix44::operator*()
 
 
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::*=()
-//-------------------------------------------------------------------------------
-// Matrix-scalar multiplication
-//-------------------------------------------------------------------------------
-IvMatrix44& IvMatrix44::operator*=( float scalar )
-{
-    mV[0] *= scalar;
-    mV[1] *= scalar;
-    mV[2] *= scalar;
-    mV[3] *= scalar;
-    mV[4] *= scalar;
-    mV[5] *= scalar;
-    mV[6] *= scalar;
-    mV[7] *= scalar;
-    mV[8] *= scalar;
-    mV[9] *= scalar;
-    mV[10] *= scalar;
-    mV[11] *= scalar;
-    mV[12] *= scalar;
-    mV[13] *= scalar;
-    mV[14] *= scalar;
-    mV[15] *= scalar;
-
-    return *this;
-}  // End of IvMatrix44::operator*=()
-
-
-//-------------------------------------------------------------------------------
-// @ friend IvMatrix44 *()
-//-------------------------------------------------------------------------------
-// Matrix-scalar multiplication
-//-------------------------------------------------------------------------------
-IvMatrix44 operator*( float scalar, const IvMatrix44& matrix )
-{
-    IvMatrix44 result;
-    result.mV[0] = matrix.mV[0] * scalar;
-    result.mV[1] = matrix.mV[1] * scalar;
-    result.mV[2] = matrix.mV[2] * scalar;
-    result.mV[3] = matrix.mV[3] * scalar;
-    result.mV[4] = matrix.mV[4] * scalar;
-    result.mV[5] = matrix.mV[5] * scalar;
-    result.mV[6] = matrix.mV[6] * scalar;
-    result.mV[7] = matrix.mV[7] * scalar;
-    result.mV[8] = matrix.mV[8] * scalar;
-    result.mV[9] = matrix.mV[9] * scalar;
-    result.mV[10] = matrix.mV[10] * scalar;
-    result.mV[11] = matrix.mV[11] * scalar;
-    result.mV[12] = matrix.mV[12] * scalar;
-    result.mV[13] = matrix.mV[13] * scalar;
-    result.mV[14] = matrix.mV[14] * scalar;
-    result.mV[15] = matrix.mV[15] * scalar;
-
-    return result;
-}  // End of friend IvMatrix44 operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ IvMatrix44::*()
-//-------------------------------------------------------------------------------
-// Matrix-scalar multiplication
-//-------------------------------------------------------------------------------
-IvMatrix44 IvMatrix44::operator*( float scalar ) const
-{
-    IvMatrix44 result;
-    result.mV[0] = mV[0] * scalar;
-    result.mV[1] = mV[1] * scalar;
-    result.mV[2] = mV[2] * scalar;
-    result.mV[3] = mV[3] * scalar;
-    result.mV[4] = mV[4] * scalar;
-    result.mV[5] = mV[5] * scalar;
-    result.mV[6] = mV[6] * scalar;
-    result.mV[7] = mV[7] * scalar;
-    result.mV[8] = mV[8] * scalar;
-    result.mV[9] = mV[9] * scalar;
-    result.mV[10] = mV[10] * scalar;
-    result.mV[11] = mV[11] * scalar;
-    result.mV[12] = mV[12] * scalar;
-    result.mV[13] = mV[13] * scalar;
-    result.mV[14] = mV[14] * scalar;
-    result.mV[15] = mV[15] * scalar;
-
-    return result;
-}  // End of IvMatrix44::operator*=()
-
-
 //-------------------------------------------------------------------------------
 // @ IvMatrix44::Transform()
 //-------------------------------------------------------------------------------
@@ -1182,3 +1080,59 @@ IvMatrix44::TransformPoint( const IvVector3& other ) const
     return result;
 
 }   // End of IvMatrix44::TransformPoint()
+
+
+//-------------------------------------------------------------------------------
+// @ IvMatrix44::TransformPoints()
+//-------------------------------------------------------------------------------
+// Matrix-point multiplication of an array, same results as TransformPoint();
+// out may alias in
+//-------------------------------------------------------------------------------
+void
+IvMatrix44::TransformPoints( const IvVector3* in, IvVector3* out, unsigned int count ) const
+{
+    unsigned int i = 0;
+
+#if defined(IV_SIMD_SSE)
+    static_assert( sizeof(IvVector3) == 3*sizeof(float), "IvVector3 must be three packed floats" );
+
+    __m128 m0 = _mm_set1_ps( mV[0] ), m1 = _mm_set1_ps( mV[1] ), m2 = _mm_set1_ps( mV[2] );
+    __m128 m4 = _mm_set1_ps( mV[4] ), m5 = _mm_set1_ps( mV[5] ), m6 = _mm_set1_ps( mV[6] );
+    __m128 m8 = _mm_set1_ps( mV[8] ), m9 = _mm_set1_ps( mV[9] ), m10 = _mm_set1_ps( mV[10] );
+    __m128 m12 = _mm_set1_ps( mV[12] ), m13 = _mm_set1_ps( mV[13] ), m14 = _mm_set1_ps( mV[14] );
+
+    // four points at a time: x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+    for ( ; i + 4 <= count; i += 4)
+    {
+        const float* src = &in[i].x;
+        __m128 v0 = _mm_loadu_ps( src );
+        __m128 v1 = _mm_loadu_ps( src + 4 );
+        __m128 v2 = _mm_loadu_ps( src + 8 );
+
+        __m128 t = _mm_shuffle_ps( v1, v2, _MM_SHUFFLE( 1, 0, 3, 2 ) );
+        __m128 x = _mm_shuffle_ps( v0, t, _MM_SHUFFLE( 3, 0, 3, 0 ) );
+        __m128 y = _mm_shuffle_ps( _mm_shuffle_ps( v0, v1, _MM_SHUFFLE( 0, 0, 1, 1 ) ),
+                                   _mm_shuffle_ps( v1, v2, _MM_SHUFFLE( 2, 2, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+        __m128 z = _mm_shuffle_ps( _mm_shuffle_ps( v0, v1, _MM_SHUFFLE( 1, 1, 2, 2 ) ),
+                                   _mm_shuffle_ps( v2, v2, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+        __m128 rx = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( m0, x ), _mm_mul_ps( m4, y ) ), _mm_mul_ps( m8, z ) ), m12 );
+        __m128 ry = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( m1, x ), _mm_mul_ps( m5, y ) ), _mm_mul_ps( m9, z ) ), m13 );
+        __m128 rz = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( m2, x ), _mm_mul_ps( m6, y ) ), _mm_mul_ps( m10, z ) ), m14 );
+
+        float* dst = &out[i].x;
+        __m128 xy = _mm_unpacklo_ps( rx, ry );
+        _mm_storeu_ps( dst, _mm_shuffle_ps( xy, _mm_shuffle_ps( rz, rx, _MM_SHUFFLE( 1, 1, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 1, 0 ) ) );
+        _mm_storeu_ps( dst + 4, _mm_shuffle_ps( _mm_shuffle_ps( ry, rz, _MM_SHUFFLE( 1, 1, 1, 1 ) ),
+                                                _mm_shuffle_ps( rx, ry, _MM_SHUFFLE( 2, 2, 2, 2 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+        _mm_storeu_ps( dst + 8, _mm_shuffle_ps( _mm_shuffle_ps( rz, rx, _MM_SHUFFLE( 3, 3, 2, 2 ) ),
+                                                _mm_shuffle_ps( ry, rz, _MM_SHUFFLE( 3, 3, 3, 3 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+    }
+#endif
+
+    for ( ; i < count; ++i)
+    {
+        out[i] = TransformPoint( in[i] );
+    }
+
+}   // End of IvMatrix44::TransformPoints()
@@ -0,0 +1,42 @@
+//===============================================================================
+// @ IvSIMD.h
+//
+// Compile-time selection of the SIMD code paths of the math classes
+// ------------------------------------------------------------------------------
+//
+// The SSE path is used wherever the target guarantees SSE2 (x86-64, or x86
+// with /arch:SSE2 or -msse2), the AVX path on top of it where the compiler
+// targets AVX (/arch:AVX, -mavx). Defining IV_SIMD_SCALAR selects the
+// scalar code everywhere, as does any other architecture.
+//
+// The SIMD paths add and multiply in the same order as the scalar code, so
+// without fused multiply-add contraction both give the same bits.
+//
+//===============================================================================
+
+#ifndef __IvSIMD__h__
+#define __IvSIMD__h__
+
+//-------------------------------------------------------------------------------
+//-- Dependencies ---------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+#if !defined(IV_SIMD_SCALAR)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IV_SIMD_SSE 1
+#include <emmintrin.h>
+#endif
+#if defined(IV_SIMD_SSE) && defined(__AVX__)
+#define IV_SIMD_AVX 1
+#include <immintrin.h>
+#endif
+#endif
+
+//-------------------------------------------------------------------------------
+//-- Functions ------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+// Name of the code path IvMath was compiled with: "avx", "sse" or "scalar"
+extern const char* IvSIMDPath();
+
+#endif
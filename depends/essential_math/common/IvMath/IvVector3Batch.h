@@ -0,0 +1,293 @@
+//===============================================================================
+// @ IvVector3Batch.h
+//
+// Structure-of-arrays batches of 3D vectors
+// ------------------------------------------------------------------------------
+//
+// IvVector3Batch<Lanes> holds Lanes::Width vectors as one lane type per
+// component (IvLanes.h), so each operation works on the whole batch at once:
+//
+//     IvVector3x4, IvVector3x8               4 or 8 IvVector3
+//     IvDoubleVector3x4, IvDoubleVector3x8   4 or 8 IvDoubleVector3
+//
+// Load() and Store() convert from and to arrays of IvVector3 or
+// IvDoubleVector3. IvBatchTransform() and IvBatchForEach() run a function
+// over an array, a batch at a time, including the last partial batch.
+// Every operation computes what the scalar type does, in the same order,
+// so a lane of a batch matches the scalar result bit for bit.
+//
+//===============================================================================
+
+#ifndef __IvVector3Batch__h__
+#define __IvVector3Batch__h__
+
+//-------------------------------------------------------------------------------
+//-- Dependencies ---------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+#include "IvLanes.h"
+#include "IvMath.h"
+#include "IvMatrix33.h"
+#include "IvMatrix44.h"
+
+#include <stddef.h>
+
+//-------------------------------------------------------------------------------
+//-- Classes --------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+template <typename Lanes>
+class IvVector3Batch
+{
+public:
+    typedef typename Lanes::Scalar Scalar;
+    enum { Width = Lanes::Width };
+
+    // constructor/destructor
+    inline IvVector3Batch() {}
+    inline IvVector3Batch( const Lanes& _x, const Lanes& _y, const Lanes& _z ) :
+        x(_x), y(_y), z(_z)
+    {
+    }
+    // every lane the same vector
+    inline IvVector3Batch( Scalar _x, Scalar _y, Scalar _z ) :
+        x(_x), y(_y), z(_z)
+    {
+    }
+
+    // conversion from and to arrays of IvVector3 / IvDoubleVector3; the
+    // partial forms read `count` < Width vectors (the last one fills the
+    // remaining lanes) and write only `count`
+    template <typename V> inline void Load( const V* src );
+    template <typename V> inline void Load( const V* src, unsigned int count );
+    template <typename V> inline void Store( V* dst ) const;
+    template <typename V> inline void Store( V* dst, unsigned int count ) const;
+
+    inline Lanes LengthSquared() const             { return x*x + y*y + z*z; }
+    inline Lanes Length() const                    { return Sqrt( LengthSquared() ); }
+    inline void Normalize();   // sets to unit vectors, near-zero ones to 0
+
+    // addition/subtraction
+    inline IvVector3Batch operator+( const IvVector3Batch& other ) const { return IvVector3Batch( x + other.x, y + other.y, z + other.z ); }
+    inline IvVector3Batch operator-( const IvVector3Batch& other ) const { return IvVector3Batch( x - other.x, y - other.y, z - other.z ); }
+    inline IvVector3Batch& operator+=( const IvVector3Batch& other )     { x = x + other.x; y = y + other.y; z = z + other.z; return *this; }
+    inline IvVector3Batch& operator-=( const IvVector3Batch& other )     { x = x - other.x; y = y - other.y; z = z - other.z; return *this; }
+
+    // scalar multiplication, one scalar or one per lane
+    inline IvVector3Batch operator*( const Lanes& scalar ) const          { return IvVector3Batch( x*scalar, y*scalar, z*scalar ); }
+    inline IvVector3Batch operator*( Scalar scalar ) const               { return *this * Lanes( scalar ); }
+    inline IvVector3Batch& operator*=( const Lanes& scalar )             { x = x*scalar; y = y*scalar; z = z*scalar; return *this; }
+
+    // dot product/cross product
+    friend inline Lanes Dot( const IvVector3Batch& a, const IvVector3Batch& b )
+    {
+        return a.x*b.x + a.y*b.y + a.z*b.z;
+    }
+    friend inline IvVector3Batch Cross( const IvVector3Batch& a, const IvVector3Batch& b )
+    {
+        return IvVector3Batch( a.y*b.z - a.z*b.y,
+                               a.z*b.x - a.x*b.z,
+                               a.x*b.y - a.y*b.x );
+    }
+
+    // a + (b - a)*t
+    friend inline IvVector3Batch Lerp( const IvVector3Batch& a, const IvVector3Batch& b, const Lanes& t )
+    {
+        return a + (b - a)*t;
+    }
+
+    // matrix products, as IvMatrix44::TransformPoint() / Transform() and
+    // IvMatrix33::operator*() for column vectors
+    friend inline IvVector3Batch TransformPoint( const IvMatrix44& m, const IvVector3Batch& p )
+    {
+        const float* v = m;
+        return IvVector3Batch( Lanes( v[0] )*p.x + Lanes( v[4] )*p.y + Lanes( v[8] )*p.z + Lanes( v[12] ),
+                               Lanes( v[1] )*p.x + Lanes( v[5] )*p.y + Lanes( v[9] )*p.z + Lanes( v[13] ),
+                               Lanes( v[2] )*p.x + Lanes( v[6] )*p.y + Lanes( v[10] )*p.z + Lanes( v[14] ) );
+    }
+    friend inline IvVector3Batch Transform( const IvMatrix44& m, const IvVector3Batch& p )
+    {
+        const float* v = m;
+        return IvVector3Batch( Lanes( v[0] )*p.x + Lanes( v[4] )*p.y + Lanes( v[8] )*p.z,
+                               Lanes( v[1] )*p.x + Lanes( v[5] )*p.y + Lanes( v[9] )*p.z,
+                               Lanes( v[2] )*p.x + Lanes( v[6] )*p.y + Lanes( v[10] )*p.z );
+    }
+    friend inline IvVector3Batch operator*( const IvMatrix33& m, const IvVector3Batch& p )
+    {
+        return IvVector3Batch( Lanes( m(0, 0) )*p.x + Lanes( m(0, 1) )*p.y + Lanes( m(0, 2) )*p.z,
+                               Lanes( m(1, 0) )*p.x + Lanes( m(1, 1) )*p.y + Lanes( m(1, 2) )*p.z,
+                               Lanes( m(2, 0) )*p.x + Lanes( m(2, 1) )*p.y + Lanes( m(2, 2) )*p.z );
+    }
+
+    // member variables
+    Lanes x, y, z;
+};
+
+typedef IvVector3Batch<IvFloat4>  IvVector3x4;
+typedef IvVector3Batch<IvFloat8>  IvVector3x8;
+typedef IvVector3Batch<IvDouble4> IvDoubleVector3x4;
+typedef IvVector3Batch<IvDouble8> IvDoubleVector3x8;
+
+//-------------------------------------------------------------------------------
+//-- Inlines --------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------
+// @ IvVector3Batch::Load()
+//-------------------------------------------------------------------------------
+// Gather Width vectors into the component lanes
+//-------------------------------------------------------------------------------
+template <typename Lanes>
+template <typename V>
+inline void
+IvVector3Batch<Lanes>::Load( const V* src )
+{
+    Scalar sx[Width], sy[Width], sz[Width];
+    for (unsigned int i = 0; i < Width; ++i)
+    {
+        sx[i] = src[i].x;
+        sy[i] = src[i].y;
+        sz[i] = src[i].z;
+    }
+    x = Lanes::Load( sx );
+    y = Lanes::Load( sy );
+    z = Lanes::Load( sz );
+
+}   // End of IvVector3Batch::Load()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3Batch::Load()
+//-------------------------------------------------------------------------------
+// Gather count < Width vectors, the last one repeated into the other lanes
+//-------------------------------------------------------------------------------
+template <typename Lanes>
+template <typename V>
+inline void
+IvVector3Batch<Lanes>::Load( const V* src, unsigned int count )
+{
+    Scalar sx[Width], sy[Width], sz[Width];
+    for (unsigned int i = 0; i < Width; ++i)
+    {
+        const V& v = src[i < count ? i : count - 1];
+        sx[i] = v.x;
+        sy[i] = v.y;
+        sz[i] = v.z;
+    }
+    x = Lanes::Load( sx );
+    y = Lanes::Load( sy );
+    z = Lanes::Load( sz );
+
+}   // End of IvVector3Batch::Load()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3Batch::Store()
+//-------------------------------------------------------------------------------
+// Scatter the lanes into Width vectors
+//-------------------------------------------------------------------------------
+template <typename Lanes>
+template <typename V>
+inline void
+IvVector3Batch<Lanes>::Store( V* dst ) const
+{
+    Store( dst, Width );
+
+}   // End of IvVector3Batch::Store()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3Batch::Store()
+//-------------------------------------------------------------------------------
+// Scatter the first count lanes
+//-------------------------------------------------------------------------------
+template <typename Lanes>
+template <typename V>
+inline void
+IvVector3Batch<Lanes>::Store( V* dst, unsigned int count ) const
+{
+    Scalar sx[Width], sy[Width], sz[Width];
+    x.Store( sx );
+    y.Store( sy );
+    z.Store( sz );
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        dst[i].x = sx[i];
+        dst[i].y = sy[i];
+        dst[i].z = sz[i];
+    }
+
+}   // End of IvVector3Batch::Store()
+
+//-------------------------------------------------------------------------------
+// @ IvVector3Batch::Normalize()
+//-------------------------------------------------------------------------------
+// Set to unit vectors; lanes whose squared length IvIsZero() become 0
+//-------------------------------------------------------------------------------
+template <typename Lanes>
+inline void
+IvVector3Batch<Lanes>::Normalize()
+{
+    Lanes lengthsq = LengthSquared();
+    Lanes factor = SelectGreaterEqual( Lanes( Scalar(kEpsilon) ), Abs( lengthsq ),
+                                       Lanes( Scalar(0) ), Lanes( Scalar(1) ) / Sqrt( lengthsq ) );
+    x = x*factor;
+    y = y*factor;
+    z = z*factor;
+
+}   // End of IvVector3Batch::Normalize()
+
+//-------------------------------------------------------------------------------
+//-- Functions ------------------------------------------------------------------
+//-------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------
+// @ IvBatchTransform()
+//-------------------------------------------------------------------------------
+// out[i] = function( in[i] ) for count vectors, Batch::Width at a time;
+// function takes and returns a Batch. out may alias in.
+//-------------------------------------------------------------------------------
+template <typename Batch, typename V, typename Function>
+inline void
+IvBatchTransform( const V* in, V* out, size_t count, Function function )
+{
+    size_t i = 0;
+    for ( ; i + Batch::Width <= count; i += Batch::Width)
+    {
+        Batch batch;
+        batch.Load( in + i );
+        function( batch ).Store( out + i );
+    }
+    if (i < count)
+    {
+        Batch batch;
+        batch.Load( in + i, (unsigned int)(count - i) );
+        function( batch ).Store( out + i, (unsigned int)(count - i) );
+    }
+
+}   // End of IvBatchTransform()
+
+//-------------------------------------------------------------------------------
+// @ IvBatchForEach()
+//-------------------------------------------------------------------------------
+// function( batch, first, lanes ) for count vectors, Batch::Width at a time;
+// the last batch has lanes < Width valid lanes, starting at in[first]
+//-------------------------------------------------------------------------------
+template <typename Batch, typename V, typename Function>
+inline void
+IvBatchForEach( const V* in, size_t count, Function function )
+{
+    size_t i = 0;
+    for ( ; i + Batch::Width <= count; i += Batch::Width)
+    {
+        Batch batch;
+        batch.Load( in + i );
+        function( (const Batch&)batch, i, (unsigned int)Batch::Width );
+    }
+    if (i < count)
+    {
+        Batch batch;
+        batch.Load( in + i, (unsigned int)(count - i) );
+        function( (const Batch&)batch, i, (unsigned int)(count - i) );
+    }
+
+}   // End of IvBatchForEach()
+
+#endif
@@ -32,43 +32,6 @@ IvVector4 IvVector4::origin( 0.0f, 0.0f, 0.0f, 0.0f );
 //-- Methods --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
 
-//-------------------------------------------------------------------------------
-// @ IvVector4::IvVector4()
-//-------------------------------------------------------------------------------
-// Copy constructor
-//-------------------------------------------------------------------------------
-IvVector4::IvVector4(const IvVector4& other) : 
-    x( other.x ),
-    y( other.y ),
-    z( other.z ),
-    w( other.w )
-{
-
-}   // End of IvVector4::IvVector4()
-
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::operator=()
-//-------------------------------------------------------------------------------
-// Assignment operator
-//-------------------------------------------------------------------------------
-IvVector4&
-IvVector4::operator=(const IvVector4& other)
-{
-    // if same object
-    if ( this == &other )
-        return *this;
-        
-    x = other.x;
-    y = other.y;
-    z = other.z;
-    w = other.w;
-    
-    return *this;
-
-}   // End of IvVector4::operator=()
-
-
 //-------------------------------------------------------------------------------
 // @ operator<<()
 //-------------------------------------------------------------------------------
@@ -98,19 +61,6 @@ IvVector4::Length() const
 }   // End of IvVector4::Length()
 
 
-//-------------------------------------------------------------------------------
-// @ IvVector4::LengthSquared()
-//-------------------------------------------------------------------------------
-// Vector length squared (avoids square root)
-//-------------------------------------------------------------------------------
-float 
-IvVector4::LengthSquared() const
-{
-    return ( x*x + y*y + z*z + w*w );
-
-}   // End of IvVector4::LengthSquared()
-
-
 //-------------------------------------------------------------------------------
 // @ IvVector4::operator==()
 //-------------------------------------------------------------------------------
@@ -228,168 +178,3 @@ IvVector4::Normalize()
 
 }   // End of IvVector4::Normalize()
 
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::operator+()
-//-------------------------------------------------------------------------------
-// Add vector to self and return
-//-------------------------------------------------------------------------------
-IvVector4 
-IvVector4::operator+( const IvVector4& other ) const
-{
-    return IvVector4( x + other.x, y + other.y, z + other.z, w + other.w );
-
-}   // End of IvVector4::operator+()
-
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::operator+=()
-//-------------------------------------------------------------------------------
-// Add vector to self, store in self
-//-------------------------------------------------------------------------------
-IvVector4& 
-IvVector4::operator+=( const IvVector4& other )
-{
-    x += other.x;
-    y += other.y;
-    z += other.z;
-    w += other.w;
-
-    return *this;
-
-}   // End of IvVector4::operator+=()
-
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::operator-()
-//-------------------------------------------------------------------------------
-// Subtract vector from self and return
-//-------------------------------------------------------------------------------
-IvVector4 
-IvVector4::operator-( const IvVector4& other ) const
-{
-    return IvVector4( x - other.x, y - other.y, z - other.z, w - other.w );
-
-}   // End of IvVector4::operator-()
-
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::operator-=()
-//-------------------------------------------------------------------------------
-// Subtract vector from self, store in self
-//-------------------------------------------------------------------------------
-IvVector4& 
-IvVector4::operator-=( const IvVector4& other )
-{
-    x -= other.x;
-    y -= other.y;
-    z -= other.z;
-    w -= other.w;
-
-    return *this;
-
-}   // End of IvVector4::operator-=()
-
-
-//-------------------------------------------------------------------------------
-// @ operator*()
-//-------------------------------------------------------------------------------
-// Scalar multiplication
-//-------------------------------------------------------------------------------
-IvVector4   
-IvVector4::operator*( float scalar )
-{
-    return IvVector4( scalar*x, scalar*y, scalar*z,
-                      scalar*w );
-
-}   // End of operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ operator*()
-//-------------------------------------------------------------------------------
-// Scalar multiplication
-//-------------------------------------------------------------------------------
-IvVector4   
-operator*( float scalar, const IvVector4& vector )
-{
-    return IvVector4( scalar*vector.x, scalar*vector.y, scalar*vector.z,
-                      scalar*vector.w );
-
-}   // End of operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::operator*()
-//-------------------------------------------------------------------------------
-// Scalar multiplication by self
-//-------------------------------------------------------------------------------
-IvVector4&
-IvVector4::operator*=( float scalar )
-{
-    x *= scalar;
-    y *= scalar;
-    z *= scalar;
-    w *= scalar;
-
-    return *this;
-
-}   // End of IvVector4::operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ operator/()
-//-------------------------------------------------------------------------------
-// Scalar division
-//-------------------------------------------------------------------------------
-IvVector4   
-IvVector4::operator/( float scalar )
-{
-    return IvVector4( x/scalar, y/scalar, z/scalar, w/scalar );
-
-}   // End of operator*()
-
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::operator/=()
-//-------------------------------------------------------------------------------
-// Scalar division by self
-//-------------------------------------------------------------------------------
-IvVector4&
-IvVector4::operator/=( float scalar )
-{
-    x /= scalar;
-    y /= scalar;
-    z /= scalar;
-    w /= scalar;
-
-    return *this;
-
-}   // End of IvVector4::operator/=()
-
-
-//-------------------------------------------------------------------------------
-// @ IvVector4::Dot()
-//-------------------------------------------------------------------------------
-// Dot product by self
-//-------------------------------------------------------------------------------
-float               
-IvVector4::Dot( const IvVector4& vector ) const
-{
-    return (x*vector.x + y*vector.y + z*vector.z + w*vector.w);
-
-}   // End of IvVector4::Dot()
-
-
-//-------------------------------------------------------------------------------
-// @ Dot()
-//-------------------------------------------------------------------------------
-// Dot product friend operator
-//-------------------------------------------------------------------------------
-float               
-Dot( const IvVector4& vector1, const IvVector4& vector2 )
-{
-    return (vector1.x*vector2.x + vector1.y*vector2.y + vector1.z*vector2.z
-            + vector1.w*vector2.w);
-
-}   // End of Dot()
@@ -0,0 +1,57 @@
+#include "AerialPerspective.h"
+#include "AtmosphereCache.h"
+
+#include <IvResourceManager.h>
+
+namespace cali
+{
+	aerial_perspective_volume::aerial_perspective_volume(IvRenderer& renderer, int size, float max_distance_km) :
+		m_volume(size, size, size, max_distance_km)
+	{
+		auto& resman = *renderer.GetResourceManager();
+		m_in_scattering_texture = std::unique_ptr<IvRenderTexture>(
+			resman.CreateRenderTexture(size, size, size, IvTextureFormat::kRGBAFloat16TexFmt));
+		m_transmittance_texture = std::unique_ptr<IvRenderTexture>(
+			resman.CreateRenderTexture(size, size, size, IvTextureFormat::kRGBAFloat16TexFmt));
+		if (!m_in_scattering_texture || !m_transmittance_texture)
+			throw std::exception("sky: failed to create the aerial perspective textures!");
+
+		m_cbuffer = resman.CreateConstantBuffer(sizeof(constant_buffer::AerialPerspective));
+		if (!m_cbuffer.valid())
+			throw std::exception("sky: failed to create the aerial perspective constant buffer!");
+		// the terrain does the per pixel lookups until the first volume
+		m_cbuffer->forward = { 0.f, 0.f, 1.f, 0.f };
+		renderer.UpdateConstantBuffer(m_cbuffer.ivcbuffer());
+		renderer.SetConstantBuffer(m_cbuffer.ivcbuffer(), 4);
+		m_half_texels.resize((size_t)size * size * size * 4);
+	}
+
+	bool aerial_perspective_volume::upload(IvRenderTexture& texture, const atmosphere::texture_3d& texels)
+	{
+		uint16_t* out = m_half_texels.data();
+		for (const atmosphere::rgba& t : texels.texels)
+		{
+			*out++ = atmosphere::float_to_half(t.r);
+			*out++ = atmosphere::float_to_half(t.g);
+			*out++ = atmosphere::float_to_half(t.b);
+			*out++ = atmosphere::float_to_half(t.a);
+		}
+		return texture.LoadData(m_half_texels.data());
+	}
+
+	void aerial_perspective_volume::update(IvRenderer& renderer, const atmosphere::atmosphere_query& query,
+		const atmosphere::froxel_camera& camera, const IvVector3& sun_direction, float world_units_per_km)
+	{
+		m_volume.compute(query, camera, sun_direction);
+		const bool uploaded = upload(*m_in_scattering_texture, m_volume.in_scattering()) &&
+			upload(*m_transmittance_texture, m_volume.transmittance());
+
+		const IvVector3 right = camera.right * (1.0f / camera.tan_half_fov_x);
+		const IvVector3 up = camera.up * (1.0f / camera.tan_half_fov_y);
+		m_cbuffer->right = { right.x, right.y, right.z, 0.f };
+		m_cbuffer->up = { up.x, up.y, up.z, 0.f };
+		m_cbuffer->forward = { camera.forward.x, camera.forward.y, camera.forward.z, uploaded ? 1.f : 0.f };
+		m_cbuffer->depth = { 1.f / world_units_per_km, 1.f / m_volume.max_distance(), 0.f, 0.f };
+		renderer.UpdateConstantBuffer(m_cbuffer.ivcbuffer());
+	}
+}
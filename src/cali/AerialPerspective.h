@@ -0,0 +1,42 @@
+#pragma once
+#include "AtmosphereAerialPerspective.h"
+#include "ConstantBuffer.h"
+#include "ConstantBufferWrapper.h"
+
+#include <IvRenderer.h>
+#include <IvRenderTexture.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cali
+{
+	// The aerial perspective froxel volume of the terrain: computed on the CPU
+	// every frame (atmosphere::aerial_perspective), uploaded as two RGBA16F 3D
+	// textures and described to the shaders in the AerialPerspective cbuffer
+	// (b4).
+	class aerial_perspective_volume
+	{
+	public:
+		aerial_perspective_volume(IvRenderer& renderer, int size = 32, float max_distance_km = 128.0f);
+
+		// `camera` relative to the planet center in km; its basis and field of
+		// view those of the view the terrain is rendered with.
+		void update(IvRenderer& renderer, const atmosphere::atmosphere_query& query, const atmosphere::froxel_camera& camera,
+			const IvVector3& sun_direction, float world_units_per_km);
+
+		IvTexture* in_scattering_texture() const { return m_in_scattering_texture.get(); }
+		IvTexture* transmittance_texture() const { return m_transmittance_texture.get(); }
+		double last_compute_ms() const { return m_volume.last_compute_ms(); }
+
+	private:
+		bool upload(IvRenderTexture& texture, const atmosphere::texture_3d& texels);
+
+		atmosphere::aerial_perspective m_volume;
+		std::unique_ptr<IvRenderTexture> m_in_scattering_texture;
+		std::unique_ptr<IvRenderTexture> m_transmittance_texture;
+		constant_buffer_wrapper<constant_buffer::AerialPerspective> m_cbuffer;
+		std::vector<uint16_t> m_half_texels;
+	};
+}
@@ -0,0 +1,229 @@
+#include "AssetCache.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace cali
+{
+	namespace
+	{
+		const char c_magic[4] = { 'C', 'A', 'S', 'T' };
+		const uint32_t c_format_version = 1;
+
+		struct entry_header
+		{
+			char magic[4];
+			uint32_t format_version;
+			uint32_t asset_version;
+			uint32_t reserved;
+			uint64_t size;
+			uint64_t checksum; // fnv1a of the payload
+		};
+
+		// unique per process and per call, so writers of the same key never
+		// share a temp file before their rename
+		std::string temp_suffix()
+		{
+			static std::atomic<uint64_t> counter(0);
+#ifdef _WIN32
+			const unsigned long pid = GetCurrentProcessId();
+#else
+			const unsigned long pid = (unsigned long)getpid();
+#endif
+			return "." + std::to_string(pid) + "." + std::to_string(counter++) + ".tmp";
+		}
+
+		uint64_t fnv1a(const void* data, size_t size)
+		{
+			const unsigned char* bytes = static_cast<const unsigned char*>(data);
+			uint64_t h = 14695981039346656037ULL;
+			for (size_t i = 0; i < size; ++i) { h ^= bytes[i]; h *= 1099511628211ULL; }
+			return h;
+		}
+
+		bool valid_key(const std::string& key)
+		{
+			if (key.empty()) return false;
+			for (char c : key)
+			{
+				bool ok = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '-';
+				if (!ok) return false;
+			}
+			return key[0] != '.';
+		}
+
+		bool valid_header(const entry_header& header, uint32_t version)
+		{
+			return !memcmp(header.magic, c_magic, sizeof(c_magic)) &&
+				header.format_version == c_format_version &&
+				header.asset_version == version;
+		}
+
+		// Maps the whole file read-only; nullptr if it is missing or empty.
+		void* map_file(const std::string& path, size_t& size)
+		{
+#ifdef _WIN32
+			HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE) return nullptr;
+			LARGE_INTEGER file_size;
+			void* view = nullptr;
+			if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+			{
+				HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mapping)
+				{
+					view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+					CloseHandle(mapping);
+				}
+				size = (size_t)file_size.QuadPart;
+			}
+			CloseHandle(file);
+			return view;
+#else
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) return nullptr;
+			struct stat st;
+			void* view = nullptr;
+			if (fstat(fd, &st) == 0 && st.st_size > 0)
+			{
+				view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (view == MAP_FAILED) view = nullptr;
+				size = (size_t)st.st_size;
+			}
+			::close(fd);
+			return view;
+#endif
+		}
+
+		void unmap_file(void* view, size_t size)
+		{
+#ifdef _WIN32
+			(void)size;
+			UnmapViewOfFile(view);
+#else
+			munmap(view, size);
+#endif
+		}
+	}
+
+	void mapped_asset::close()
+	{
+		if (m_view) unmap_file(m_view, m_view_size);
+		m_view = nullptr;
+		m_view_size = 0;
+		m_data = nullptr;
+		m_size = 0;
+	}
+
+	std::string asset_cache::entry_path(const std::string& key) const
+	{
+		if (!valid_key(key)) throw std::invalid_argument("asset_cache: invalid key '" + key + "'");
+		return (std::filesystem::path(m_directory) / (key + ".bin")).string();
+	}
+
+	bool asset_cache::load(const std::string& key, uint32_t version, std::vector<unsigned char>& data) const
+	{
+		if (!enabled()) return false;
+		const std::string path = entry_path(key);
+		FILE* f = fopen(path.c_str(), "rb");
+		if (!f) return false;
+
+		// the size is checked against the file, as map() does, before anything
+		// is allocated for it
+		entry_header header;
+		std::error_code error;
+		const uintmax_t file_size = std::filesystem::file_size(path, error);
+		bool ok = !error && fread(&header, sizeof(header), 1, f) == 1 && valid_header(header, version) &&
+			header.size == file_size - sizeof(header);
+		if (ok)
+		{
+			data.resize((size_t)header.size);
+			ok = (header.size == 0 || fread(data.data(), 1, data.size(), f) == data.size()) &&
+				fnv1a(data.data(), data.size()) == header.checksum;
+		}
+		fclose(f);
+		if (!ok) data.clear();
+		return ok;
+	}
+
+	bool asset_cache::map(const std::string& key, uint32_t version, mapped_asset& mapped) const
+	{
+		mapped.close();
+		if (!enabled()) return false;
+		size_t view_size = 0;
+		void* view = map_file(entry_path(key), view_size);
+		if (!view) return false;
+
+		const unsigned char* bytes = static_cast<const unsigned char*>(view);
+		entry_header header;
+		bool ok = view_size >= sizeof(header);
+		if (ok)
+		{
+			memcpy(&header, bytes, sizeof(header));
+			ok = valid_header(header, version) && header.size == view_size - sizeof(header) &&
+				fnv1a(bytes + sizeof(header), (size_t)header.size) == header.checksum;
+		}
+		if (!ok)
+		{
+			unmap_file(view, view_size);
+			return false;
+		}
+		mapped.m_view = view;
+		mapped.m_view_size = view_size;
+		mapped.m_data = bytes + sizeof(header);
+		mapped.m_size = (size_t)header.size;
+		return true;
+	}
+
+	bool asset_cache::store(const std::string& key, uint32_t version, const void* data, size_t size) const
+	{
+		if (!enabled()) return false;
+		const std::string path = entry_path(key);
+		const std::string temp_path = path + temp_suffix();
+
+		std::error_code error;
+		std::filesystem::create_directories(m_directory, error);
+		if (error) return false;
+
+		FILE* f = fopen(temp_path.c_str(), "wb");
+		if (!f) return false;
+		entry_header header = {};
+		memcpy(header.magic, c_magic, sizeof(c_magic));
+		header.format_version = c_format_version;
+		header.asset_version = version;
+		header.size = size;
+		header.checksum = fnv1a(data, size);
+		bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && (size == 0 || fwrite(data, 1, size, f) == size);
+		ok = fclose(f) == 0 && ok;
+
+		if (ok) std::filesystem::rename(temp_path, path, error);
+		if (!ok || error)
+		{
+			std::filesystem::remove(temp_path, error);
+			return false;
+		}
+		return true;
+	}
+
+	bool asset_cache::remove(const std::string& key) const
+	{
+		if (!enabled()) return false;
+		std::error_code error;
+		return std::filesystem::remove(entry_path(key), error);
+	}
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cali
+{
+	// A cache entry mapped read-only into memory. The payload stays valid until
+	// the mapping is closed or the object is destroyed.
+	class mapped_asset
+	{
+		void* m_view = nullptr;
+		size_t m_view_size = 0;
+		const unsigned char* m_data = nullptr;
+		size_t m_size = 0;
+
+		mapped_asset(const mapped_asset&) = delete;
+		mapped_asset& operator=(const mapped_asset&) = delete;
+
+		friend class asset_cache;
+
+	public:
+		mapped_asset() {}
+		~mapped_asset() { close(); }
+
+		bool is_open() const { return m_view != nullptr; }
+		const unsigned char* data() const { return m_data; }
+		size_t size() const { return m_size; }
+
+		void close();
+	};
+
+	// On-disk cache for generated assets (eroded heightmaps, ...), one file per
+	// key in a directory. Each entry records the asset version and a checksum of
+	// its payload, so entries from an older generator or torn writes are treated
+	// as missing. A default-constructed cache is disabled: nothing is loaded or
+	// stored.
+	class asset_cache
+	{
+		std::string m_directory;
+
+	public:
+		asset_cache() {}
+		explicit asset_cache(const std::string& directory) : m_directory(directory) {}
+
+		bool enabled() const { return !m_directory.empty(); }
+		const std::string& directory() const { return m_directory; }
+
+		// Keys are file names: [a-z0-9_.-] only.
+		std::string entry_path(const std::string& key) const;
+
+		// False when the entry is missing, has another version or is corrupt.
+		bool load(const std::string& key, uint32_t version, std::vector<unsigned char>& data) const;
+
+		// Like load(), without the copy: the payload is checked in place. False
+		// (and `mapped` closed) under the same conditions as load().
+		bool map(const std::string& key, uint32_t version, mapped_asset& mapped) const;
+
+		// Writes through a temporary file renamed into place, so readers never
+		// see a partial entry. False if the cache is disabled or the write failed.
+		bool store(const std::string& key, uint32_t version, const void* data, size_t size) const;
+
+		bool remove(const std::string& key) const;
+	};
+}
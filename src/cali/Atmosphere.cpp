@@ -0,0 +1,721 @@
+#include "Atmosphere.h"
+#include "AtmosphereFunctions.h"
+#include "CaliThreads.h"
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+namespace cali
+{
+namespace atmosphere
+{
+	using namespace common;
+
+	namespace
+	{
+		const int c_single_scattering_samples = 50;
+		const int c_multiple_scattering_samples = 50;
+		const int c_density_samples = 16;
+		const int c_indirect_irradiance_samples = 32;
+
+		// A trapezoidal integration weight, as in the shaders.
+		float sample_weight(int i, int sample_count)
+		{
+			return (i == 0 || i == sample_count) ? 0.5f : 1.0f;
+		}
+
+		// Bilinear lookup along one row of values, with the clamp of texture_2d::sample.
+		rgba sample_row(const std::vector<rgba>& row, float u)
+		{
+			const int width = (int)row.size();
+			float tx = u * width - 0.5f;
+			float fx0 = floorf(tx);
+			int x0 = std::clamp((int)fx0, 0, width - 1), x1 = std::clamp((int)fx0 + 1, 0, width - 1);
+			return lerp(row[x0], row[x1], tx - fx0);
+		}
+
+		// Both lookups of get_scattering for one (r, mu, mu_s) are at u = (k + u_mu_s) / NU
+		// for the integer k below u_nu * (NU - 1). slices[k] holds the k-th one.
+		rgba lerp_nu_slices(const rgba* slices, int nu_size, float nu)
+		{
+			float tex_coord_x = (nu + 1.0f) / 2.0f * (float)(nu_size - 1);
+			float tex_x = floorf(tex_coord_x);
+			int k = std::clamp((int)tex_x, 0, nu_size - 1);
+			float f = std::clamp(tex_coord_x - (float)k, 0.0f, 1.0f);
+			return slices[k] * (1.0f - f) + slices[k + 1] * f;
+		}
+
+		void fill_nu_slices(const texture_3d& texture, int nu_size, float u_mu_s, float u_mu, float u_r, rgba* slices)
+		{
+			for (int k = 0; k <= nu_size; ++k)
+				slices[k] = texture.sample(((float)k + u_mu_s) / (float)nu_size, u_mu, u_r).rgb();
+		}
+
+		double elapsed_ms(std::chrono::steady_clock::time_point start)
+		{
+			return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		// Schuler's approximation of the Chapman function for mu >= 0, exact at
+		// the zenith and, for large x, at the horizon. x = r / scale height.
+		float chapman_upper(float x, float mu)
+		{
+			const float c = sqrtf(0.5f * c_pi * x);
+			return c / ((c - 1.0f) * mu + 1.0f);
+		}
+
+		// Optical length from r along mu to infinity of a layer with density 1 at
+		// the ground; rays going down are folded at their lowest point.
+		float chapman_optical_length(const atmosphere_parameters& atm, float scale_height, float r, float mu)
+		{
+			const float here = scale_height * expf(-(r - atm.bottom_radius) / scale_height);
+			if (mu >= 0.0f) return here * chapman_upper(r / scale_height, mu);
+			const float r_0 = r * sqrtf(1.0f - mu * mu);
+			const float lowest = scale_height * expf(-(r_0 - atm.bottom_radius) / scale_height);
+			return 2.0f * lowest * chapman_upper(r_0 / scale_height, 0.0f) - here * chapman_upper(r / scale_height, -mu);
+		}
+	}
+
+	atmosphere_parameters earth_atmosphere()
+	{
+		atmosphere_parameters atmosphere;
+		atmosphere.solar_irradiance = rgba(1.474000f, 1.850400f, 1.911980f);
+		atmosphere.sun_angular_radius = 0.004675f;
+		atmosphere.bottom_radius = 6360.0f;
+		atmosphere.top_radius = 6600.0f;
+		atmosphere.rayleigh_scale_height = 8.0f;
+		atmosphere.rayleigh_scattering = rgba(0.005802f, 0.013558f, 0.033100f);
+		atmosphere.mie_scale_height = 1.2f;
+		atmosphere.mie_scattering = rgba(0.003996f, 0.003996f, 0.003996f);
+		atmosphere.mie_extinction = rgba(0.004440f, 0.004440f, 0.004440f);
+		atmosphere.mie_phase_function_g = 0.8f;
+		atmosphere.ground_albedo = rgba(0.1f, 0.1f, 0.1f);
+		atmosphere.mu_s_min = -0.207912f;
+		return atmosphere;
+	}
+
+	lut_sizes lut_sizes_for(lut_tier tier)
+	{
+		lut_sizes sizes;
+		switch (tier)
+		{
+		case lut_tier::low:
+			sizes.transmittance_width = 64;
+			sizes.transmittance_height = 16;
+			sizes.scattering_r = 8;
+			sizes.scattering_mu = 32;
+			sizes.scattering_mu_s = 16;
+			sizes.scattering_nu = 4;
+			sizes.irradiance_width = 32;
+			sizes.irradiance_height = 8;
+			break;
+		case lut_tier::medium:
+			sizes.transmittance_width = 128;
+			sizes.transmittance_height = 32;
+			sizes.scattering_r = 16;
+			sizes.scattering_mu = 64;
+			sizes.scattering_mu_s = 32;
+			sizes.scattering_nu = 8;
+			sizes.irradiance_width = 64;
+			sizes.irradiance_height = 16;
+			break;
+		case lut_tier::high:
+			break;
+		default:
+			throw std::invalid_argument("atmosphere: unknown lut tier");
+		}
+		return sizes;
+	}
+
+	const char* lut_tier_name(lut_tier tier)
+	{
+		switch (tier)
+		{
+		case lut_tier::low: return "low";
+		case lut_tier::medium: return "medium";
+		case lut_tier::high: return "high";
+		}
+		return "unknown";
+	}
+
+	precompute_pipeline::precompute_pipeline(const atmosphere_parameters& atmosphere, const lut_sizes& sizes)
+		: m_atmosphere(atmosphere), m_sizes(sizes)
+	{
+		if (sizes.transmittance_width < 2 || sizes.transmittance_height < 2 ||
+			sizes.scattering_r < 2 || sizes.scattering_mu < 4 || sizes.scattering_mu % 2 != 0 ||
+			sizes.scattering_mu_s < 2 || sizes.scattering_nu < 2 ||
+			sizes.irradiance_width < 2 || sizes.irradiance_height < 2)
+			throw std::invalid_argument("atmosphere: invalid lut sizes");
+
+		m_transmittance.resize(sizes.transmittance_width, sizes.transmittance_height);
+		m_delta_irradiance.resize(sizes.irradiance_width, sizes.irradiance_height);
+		m_irradiance.resize(sizes.irradiance_width, sizes.irradiance_height);
+		m_scattering.resize(sizes.scattering_width(), sizes.scattering_height(), sizes.scattering_depth());
+		m_delta_rayleigh_scattering.resize(sizes.scattering_width(), sizes.scattering_height(), sizes.scattering_depth());
+		m_delta_mie_scattering.resize(sizes.scattering_width(), sizes.scattering_height(), sizes.scattering_depth());
+		m_delta_scattering_density.resize(sizes.scattering_width(), sizes.scattering_height(), sizes.scattering_depth());
+	}
+
+	void precompute_pipeline::compute_transmittance(int row)
+	{
+		const atmosphere_parameters& atm = m_atmosphere;
+		const int SAMPLE_COUNT = 500;
+		for (int x = 0; x < m_sizes.transmittance_width; ++x)
+		{
+			float r, mu;
+			get_r_mu_from_transmittance_texture_uv(atm, m_sizes,
+				((float)x + 0.5f) / (float)m_sizes.transmittance_width,
+				((float)row + 0.5f) / (float)m_sizes.transmittance_height, r, mu);
+
+			// compute_optical_length_to_top_atmosphere_boundary for both scale
+			// heights in one walk along the ray
+			float dx = distance_to_top_atmosphere_boundary(atm, r, mu) / (float)SAMPLE_COUNT;
+			float rayleigh = 0.0f, mie = 0.0f;
+			for (int i = 0; i <= SAMPLE_COUNT; ++i)
+			{
+				float d_i = (float)i * dx;
+				float altitude = sqrtf(d_i * d_i + 2.0f * r * mu * d_i + r * r) - atm.bottom_radius;
+				float weight_i = sample_weight(i, SAMPLE_COUNT);
+				rayleigh += expf(-altitude / atm.rayleigh_scale_height) * weight_i * dx;
+				mie += expf(-altitude / atm.mie_scale_height) * weight_i * dx;
+			}
+			rgba optical_depth = atm.rayleigh_scattering * rayleigh + atm.mie_extinction * mie;
+			m_transmittance.at(x, row) = exp(rgba(0.0f) - optical_depth.rgb());
+		}
+	}
+
+	void precompute_pipeline::compute_direct_irradiance(int row)
+	{
+		for (int x = 0; x < m_sizes.irradiance_width; ++x)
+		{
+			float r, mu_s;
+			get_r_mu_s_from_irradiance_texture_uv(m_atmosphere, m_sizes,
+				((float)x + 0.5f) / (float)m_sizes.irradiance_width,
+				((float)row + 0.5f) / (float)m_sizes.irradiance_height, r, mu_s);
+			m_delta_irradiance.at(x, row) =
+				common::compute_direct_irradiance(m_atmosphere, m_sizes, m_transmittance, r, mu_s).with_alpha(1.0f);
+		}
+	}
+
+	// r, mu and the ray samples only depend on the row; per texel just the sun
+	// transmittance at each sample is left.
+	void precompute_pipeline::compute_single_scattering(int layer, int first_row, int end_row)
+	{
+		const atmosphere_parameters& atm = m_atmosphere;
+		const int SAMPLE_COUNT = c_single_scattering_samples;
+		const float frag_z = (float)layer + 0.5f;
+		float d[SAMPLE_COUNT + 1], r_d[SAMPLE_COUNT + 1];
+		rgba rayleigh_d[SAMPLE_COUNT + 1], mie_d[SAMPLE_COUNT + 1];
+
+		for (int y = first_row; y < end_row; ++y)
+		{
+			const float frag_y = (float)y + 0.5f;
+			float r, mu, mu_s, nu;
+			bool ray_r_mu_intersects_ground;
+			get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, 0.5f, frag_y, frag_z,
+				r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+
+			float dx = distance_to_nearest_atmosphere_boundary(atm, r, mu, ray_r_mu_intersects_ground) / (float)SAMPLE_COUNT;
+			for (int i = 0; i <= SAMPLE_COUNT; ++i)
+			{
+				d[i] = (float)i * dx;
+				r_d[i] = clamp_radius(atm, sqrtf(d[i] * d[i] + 2.0f * r * mu * d[i] + r * r));
+				rgba transmittance = get_transmittance(atm, m_sizes, m_transmittance, r, mu, d[i], ray_r_mu_intersects_ground) *
+					sample_weight(i, SAMPLE_COUNT);
+				rayleigh_d[i] = transmittance * expf(-(r_d[i] - atm.bottom_radius) / atm.rayleigh_scale_height);
+				mie_d[i] = transmittance * expf(-(r_d[i] - atm.bottom_radius) / atm.mie_scale_height);
+			}
+
+			for (int x = 0; x < m_sizes.scattering_width(); ++x)
+			{
+				get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, (float)x + 0.5f, frag_y, frag_z,
+					r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+				rgba rayleigh_sum, mie_sum;
+				for (int i = 0; i <= SAMPLE_COUNT; ++i)
+				{
+					float mu_s_d = clamp_cosine((r * mu_s + d[i] * nu) / r_d[i]);
+					if (ray_intersects_ground(atm, r_d[i], mu_s_d)) continue;
+					rgba sun = get_transmittance_to_top_atmosphere_boundary(atm, m_sizes, m_transmittance, r_d[i], mu_s_d);
+					rayleigh_sum += rayleigh_d[i] * sun;
+					mie_sum += mie_d[i] * sun;
+				}
+				rgba rayleigh = (rayleigh_sum * dx * atm.solar_irradiance * atm.rayleigh_scattering).rgb();
+				rgba mie = (mie_sum * dx * atm.solar_irradiance * atm.mie_scattering).rgb();
+				m_delta_rayleigh_scattering.at(x, y, layer) = rayleigh.with_alpha(1.0f);
+				m_delta_mie_scattering.at(x, y, layer) = mie.with_alpha(1.0f);
+				m_scattering.at(x, y, layer) = rayleigh.with_alpha(mie.r);
+			}
+		}
+	}
+
+	// Within a layer r is fixed, the incident directions are the same for every
+	// texel and mu_s only takes MU_S values, so the incident radiance lookups
+	// reduce to a lerp between precomputed nu slices. The phase functions of the
+	// view direction only depend on the row, and directions phi and 2pi - phi
+	// share them.
+	void precompute_pipeline::compute_scattering_density(int scattering_order, int layer, int first_row, int end_row)
+	{
+		const atmosphere_parameters& atm = m_atmosphere;
+		const int SAMPLE_COUNT = c_density_samples;
+		const int PHI_COUNT = 2 * SAMPLE_COUNT;
+		const float dphi = c_pi / (float)SAMPLE_COUNT;
+		const float dtheta = c_pi / (float)SAMPLE_COUNT;
+		const int nu_size = m_sizes.scattering_nu;
+		const int mu_s_size = m_sizes.scattering_mu_s;
+		const int slice_count = nu_size + 1;
+		const bool single = scattering_order - 1 == 1;
+		const float frag_z = (float)layer + 0.5f;
+		const texture_3d& single_rayleigh = m_delta_rayleigh_scattering;
+		const texture_3d& single_mie = m_delta_mie_scattering;
+		const texture_3d& multiple = m_delta_rayleigh_scattering;
+
+		float r, mu, mu_s, nu;
+		bool ray_r_mu_intersects_ground;
+		get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, 0.5f, 0.5f, frag_z,
+			r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+		const rgba rayleigh_coefficient = atm.rayleigh_scattering * expf(-(r - atm.bottom_radius) / atm.rayleigh_scale_height);
+		const rgba mie_coefficient = atm.mie_scattering * expf(-(r - atm.bottom_radius) / atm.mie_scale_height);
+
+		struct direction { float x, y, z; };
+		std::vector<direction> omega_i(SAMPLE_COUNT * PHI_COUNT), ground_normal(SAMPLE_COUNT * PHI_COUNT);
+		bool ground[SAMPLE_COUNT];
+		float domega[SAMPLE_COUNT];
+		rgba ground_factor[SAMPLE_COUNT];
+		for (int l = 0; l < SAMPLE_COUNT; ++l)
+		{
+			float theta = ((float)l + 0.5f) * dtheta;
+			float cos_theta = cosf(theta), sin_theta = sinf(theta);
+			ground[l] = ray_intersects_ground(atm, r, cos_theta);
+			domega[l] = dtheta * dphi * sinf(theta);
+			float distance_to_ground = 0.0f;
+			ground_factor[l] = rgba();
+			if (ground[l])
+			{
+				distance_to_ground = distance_to_bottom_atmosphere_boundary(atm, r, cos_theta);
+				ground_factor[l] = get_transmittance(atm, m_sizes, m_transmittance, r, cos_theta, distance_to_ground, true) *
+					atm.ground_albedo * (1.0f / c_pi);
+			}
+			for (int m = 0; m < PHI_COUNT; ++m)
+			{
+				float phi = ((float)m + 0.5f) * dphi;
+				direction w = { cosf(phi) * sin_theta, sinf(phi) * sin_theta, cos_theta };
+				direction n = { w.x * distance_to_ground, w.y * distance_to_ground, r + w.z * distance_to_ground };
+				float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+				omega_i[l * PHI_COUNT + m] = w;
+				ground_normal[l * PHI_COUNT + m] = { n.x / length, n.y / length, n.z / length };
+			}
+		}
+
+		// slices[(c * SAMPLE_COUNT + l) * slice_count + k] for mu_s column c
+		std::vector<rgba> slices_a((size_t)mu_s_size * SAMPLE_COUNT * slice_count);
+		std::vector<rgba> slices_b(single ? slices_a.size() : 0);
+		std::vector<float> column_mu_s(mu_s_size);
+		for (int c = 0; c < mu_s_size; ++c)
+		{
+			float c_r, c_mu, c_nu;
+			bool c_ground;
+			get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, (float)c + 0.5f, 0.5f, frag_z,
+				c_r, c_mu, column_mu_s[c], c_nu, c_ground);
+			for (int l = 0; l < SAMPLE_COUNT; ++l)
+			{
+				float uvwz[4];
+				get_scattering_texture_uvwz_from_r_mu_mu_s_nu(atm, m_sizes, r, omega_i[l * PHI_COUNT].z, column_mu_s[c], 0.0f,
+					ground[l], uvwz);
+				const size_t offset = ((size_t)c * SAMPLE_COUNT + l) * slice_count;
+				fill_nu_slices(single ? single_rayleigh : multiple, nu_size, uvwz[1], uvwz[2], uvwz[3], &slices_a[offset]);
+				if (single) fill_nu_slices(single_mie, nu_size, uvwz[1], uvwz[2], uvwz[3], &slices_b[offset]);
+			}
+		}
+
+		std::vector<rgba> phase(SAMPLE_COUNT * SAMPLE_COUNT);
+		for (int y = first_row; y < end_row; ++y)
+		{
+			const float frag_y = (float)y + 0.5f;
+			get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, 0.5f, frag_y, frag_z,
+				r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+			const direction omega = { sqrtf(1.0f - mu * mu), 0.0f, mu };
+			for (int l = 0; l < SAMPLE_COUNT; ++l)
+				for (int m = 0; m < SAMPLE_COUNT; ++m)
+				{
+					const direction& w = omega_i[l * PHI_COUNT + m];
+					float nu2 = omega.x * w.x + omega.z * w.z;
+					phase[l * SAMPLE_COUNT + m] = (rayleigh_coefficient * rayleigh_phase_function(nu2) +
+						mie_coefficient * mie_phase_function(atm.mie_phase_function_g, nu2)) * domega[l];
+				}
+
+			for (int x = 0; x < m_sizes.scattering_width(); ++x)
+			{
+				get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, (float)x + 0.5f, frag_y, frag_z,
+					r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+				const int c = x % mu_s_size;
+				float sun_dir_x = omega.x == 0.0f ? 0.0f : (nu - mu * mu_s) / omega.x;
+				float sun_dir_y = sqrtf(std::max(1.0f - sun_dir_x * sun_dir_x - mu_s * mu_s, 0.0f));
+				const direction omega_s = { sun_dir_x, sun_dir_y, mu_s };
+
+				rgba rayleigh_mie;
+				for (int l = 0; l < SAMPLE_COUNT; ++l)
+				{
+					const size_t offset = ((size_t)c * SAMPLE_COUNT + l) * slice_count;
+					for (int m = 0; m < PHI_COUNT; ++m)
+					{
+						const direction& w = omega_i[l * PHI_COUNT + m];
+						float nu1 = omega_s.x * w.x + omega_s.y * w.y + omega_s.z * w.z;
+						rgba incident_radiance = lerp_nu_slices(&slices_a[offset], nu_size, nu1);
+						if (single)
+							incident_radiance = incident_radiance * rayleigh_phase_function(nu1) +
+								lerp_nu_slices(&slices_b[offset], nu_size, nu1) * mie_phase_function(atm.mie_phase_function_g, nu1);
+						if (ground[l])
+						{
+							const direction& n = ground_normal[l * PHI_COUNT + m];
+							float ground_mu_s = n.x * omega_s.x + n.y * omega_s.y + n.z * omega_s.z;
+							incident_radiance += ground_factor[l] *
+								get_irradiance(atm, m_sizes, m_delta_irradiance, atm.bottom_radius, ground_mu_s);
+						}
+						const int pair = m < SAMPLE_COUNT ? m : PHI_COUNT - 1 - m;
+						rayleigh_mie += incident_radiance * phase[l * SAMPLE_COUNT + pair];
+					}
+				}
+				m_delta_scattering_density.at(x, y, layer) = rayleigh_mie.rgb().with_alpha(1.0f);
+			}
+		}
+	}
+
+	// Same idea as the density pass: along a row r is fixed, and for one texel
+	// only nu changes between the directions of a ring.
+	void precompute_pipeline::compute_indirect_irradiance(int scattering_order, int row)
+	{
+		const atmosphere_parameters& atm = m_atmosphere;
+		const int SAMPLE_COUNT = c_indirect_irradiance_samples;
+		const int THETA_COUNT = SAMPLE_COUNT / 2;
+		const int PHI_COUNT = 2 * SAMPLE_COUNT;
+		const float dphi = c_pi / (float)SAMPLE_COUNT;
+		const float dtheta = c_pi / (float)SAMPLE_COUNT;
+		const int nu_size = m_sizes.scattering_nu;
+		const int slice_count = nu_size + 1;
+		const bool single = scattering_order - 1 == 1;
+
+		float r, mu_s;
+		get_r_mu_s_from_irradiance_texture_uv(atm, m_sizes, 0.5f / (float)m_sizes.irradiance_width,
+			((float)row + 0.5f) / (float)m_sizes.irradiance_height, r, mu_s);
+
+		float cos_theta[THETA_COUNT];
+		bool ground[THETA_COUNT];
+		std::vector<float> omega_x(THETA_COUNT * PHI_COUNT), weight(THETA_COUNT * PHI_COUNT);
+		for (int j = 0; j < THETA_COUNT; ++j)
+		{
+			float theta = ((float)j + 0.5f) * dtheta;
+			cos_theta[j] = cosf(theta);
+			ground[j] = ray_intersects_ground(atm, r, cos_theta[j]);
+			for (int i = 0; i < PHI_COUNT; ++i)
+			{
+				float phi = ((float)i + 0.5f) * dphi;
+				omega_x[j * PHI_COUNT + i] = cosf(phi) * sinf(theta);
+				weight[j * PHI_COUNT + i] = cosf(theta) * dtheta * dphi * sinf(theta);
+			}
+		}
+
+		std::vector<rgba> slices_a(THETA_COUNT * slice_count), slices_b(single ? slices_a.size() : 0);
+		for (int x = 0; x < m_sizes.irradiance_width; ++x)
+		{
+			get_r_mu_s_from_irradiance_texture_uv(atm, m_sizes, ((float)x + 0.5f) / (float)m_sizes.irradiance_width,
+				((float)row + 0.5f) / (float)m_sizes.irradiance_height, r, mu_s);
+			const float omega_s_x = sqrtf(1.0f - mu_s * mu_s);
+			for (int j = 0; j < THETA_COUNT; ++j)
+			{
+				float uvwz[4];
+				get_scattering_texture_uvwz_from_r_mu_mu_s_nu(atm, m_sizes, r, cos_theta[j], mu_s, 0.0f, ground[j], uvwz);
+				// single rayleigh, or the previous order's multiple scattering
+				fill_nu_slices(m_delta_rayleigh_scattering, nu_size, uvwz[1], uvwz[2], uvwz[3], &slices_a[j * slice_count]);
+				if (single) fill_nu_slices(m_delta_mie_scattering, nu_size, uvwz[1], uvwz[2], uvwz[3], &slices_b[j * slice_count]);
+			}
+
+			rgba result;
+			for (int j = 0; j < THETA_COUNT; ++j)
+				for (int i = 0; i < PHI_COUNT; ++i)
+				{
+					float nu = omega_x[j * PHI_COUNT + i] * omega_s_x + cos_theta[j] * mu_s;
+					rgba scattering = lerp_nu_slices(&slices_a[j * slice_count], nu_size, nu);
+					if (single)
+						scattering = scattering * rayleigh_phase_function(nu) +
+							lerp_nu_slices(&slices_b[j * slice_count], nu_size, nu) * mie_phase_function(atm.mie_phase_function_g, nu);
+					result += scattering * weight[j * PHI_COUNT + i];
+				}
+			m_delta_irradiance.at(x, row) = result.with_alpha(1.0f);
+			m_irradiance.at(x, row) += result.with_alpha(1.0f);
+		}
+	}
+
+	// Along a row r, mu and the ray samples are fixed, and so are the (mu, r)
+	// coordinates of every density lookup: the density texture is reduced to one
+	// row of values per sample, which the texels of the row then index by
+	// (nu, mu_s).
+	void precompute_pipeline::compute_multiple_scattering(int scattering_order, int layer, int first_row, int end_row)
+	{
+		(void)scattering_order;
+		const atmosphere_parameters& atm = m_atmosphere;
+		const int SAMPLE_COUNT = c_multiple_scattering_samples;
+		const int width = m_sizes.scattering_width();
+		const int nu_size = m_sizes.scattering_nu;
+		const float frag_z = (float)layer + 0.5f;
+		const texture_3d& density = m_delta_scattering_density;
+		float d[SAMPLE_COUNT + 1], r_i[SAMPLE_COUNT + 1];
+		rgba transmittance_i[SAMPLE_COUNT + 1];
+		std::vector<std::vector<rgba>> density_row(SAMPLE_COUNT + 1, std::vector<rgba>(width));
+
+		for (int y = first_row; y < end_row; ++y)
+		{
+			const float frag_y = (float)y + 0.5f;
+			float r, mu, mu_s, nu;
+			bool ray_r_mu_intersects_ground;
+			get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, 0.5f, frag_y, frag_z,
+				r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+
+			float dx = distance_to_nearest_atmosphere_boundary(atm, r, mu, ray_r_mu_intersects_ground) / (float)SAMPLE_COUNT;
+			for (int i = 0; i <= SAMPLE_COUNT; ++i)
+			{
+				d[i] = (float)i * dx;
+				r_i[i] = clamp_radius(atm, sqrtf(d[i] * d[i] + 2.0f * r * mu * d[i] + r * r));
+				float mu_i = clamp_cosine((r * mu + d[i]) / r_i[i]);
+				transmittance_i[i] = get_transmittance(atm, m_sizes, m_transmittance, r, mu, d[i], ray_r_mu_intersects_ground) *
+					(dx * sample_weight(i, SAMPLE_COUNT));
+
+				float uvwz[4];
+				get_scattering_texture_uvwz_from_r_mu_mu_s_nu(atm, m_sizes, r_i[i], mu_i, 1.0f, 0.0f,
+					ray_r_mu_intersects_ground, uvwz);
+				float ty = uvwz[2] * density.height - 0.5f, tz = uvwz[3] * density.depth - 0.5f;
+				float fy0 = floorf(ty), fz0 = floorf(tz);
+				float fy = ty - fy0, fz = tz - fz0;
+				int y0 = std::clamp((int)fy0, 0, density.height - 1), y1 = std::clamp((int)fy0 + 1, 0, density.height - 1);
+				int z0 = std::clamp((int)fz0, 0, density.depth - 1), z1 = std::clamp((int)fz0 + 1, 0, density.depth - 1);
+				for (int column = 0; column < width; ++column)
+					density_row[i][column] = lerp(
+						lerp(density.at(column, y0, z0), density.at(column, y1, z0), fy),
+						lerp(density.at(column, y0, z1), density.at(column, y1, z1), fy), fz);
+			}
+
+			for (int x = 0; x < width; ++x)
+			{
+				get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, m_sizes, (float)x + 0.5f, frag_y, frag_z,
+					r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+				float tex_coord_x = (nu + 1.0f) / 2.0f * (float)(nu_size - 1);
+				float tex_x = floorf(tex_coord_x);
+				float lerp_x = tex_coord_x - tex_x;
+				rgba rayleigh_mie_sum;
+				for (int i = 0; i <= SAMPLE_COUNT; ++i)
+				{
+					float mu_s_i = clamp_cosine((r * mu_s + d[i] * nu) / r_i[i]);
+					float u_mu_s = get_scattering_texture_u_mu_s(atm, m_sizes, mu_s_i);
+					rgba s0 = sample_row(density_row[i], (tex_x + u_mu_s) / (float)nu_size);
+					rgba s1 = sample_row(density_row[i], (tex_x + 1.0f + u_mu_s) / (float)nu_size);
+					rayleigh_mie_sum += (s0 * (1.0f - lerp_x) + s1 * lerp_x).rgb() * transmittance_i[i];
+				}
+				rgba delta_multiple_scattering = rayleigh_mie_sum.rgb();
+				m_delta_rayleigh_scattering.at(x, y, layer) = delta_multiple_scattering.with_alpha(1.0f);
+				m_scattering.at(x, y, layer) += (delta_multiple_scattering * (1.0f / rayleigh_phase_function(nu))).rgb();
+			}
+		}
+	}
+
+	void precompute_pipeline::take_luts(luts& out)
+	{
+		out.sizes = m_sizes;
+		out.transmittance = std::move(m_transmittance);
+		out.scattering = std::move(m_scattering);
+		out.irradiance = std::move(m_irradiance);
+	}
+
+	bool precompute(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, luts& out,
+		int scattering_orders, int threads, precompute_stats* stats, const std::atomic<bool>* cancel)
+	{
+		if (scattering_orders < 1) throw std::invalid_argument("atmosphere: scattering_orders must be at least 1");
+		const auto start = std::chrono::steady_clock::now();
+		int thread_count = threads > 0 ? threads : (int)std::thread::hardware_concurrency();
+		thread_count = std::max(1, thread_count);
+
+		precompute_pipeline pipeline(atmosphere, sizes);
+		precompute_stats local;
+		auto pass = [&](double& ms, int count, auto&& f)
+		{
+			const auto pass_start = std::chrono::steady_clock::now();
+			parallel_for(count, thread_count, f, cancel);
+			ms += elapsed_ms(pass_start);
+		};
+
+		pass(local.transmittance_ms, sizes.transmittance_height, [&](int row) { pipeline.compute_transmittance(row); });
+		pass(local.direct_irradiance_ms, sizes.irradiance_height, [&](int row) { pipeline.compute_direct_irradiance(row); });
+		pass(local.single_scattering_ms, sizes.scattering_depth(), [&](int layer) { pipeline.compute_single_scattering(layer); });
+		for (int order = 2; order <= scattering_orders; ++order)
+		{
+			pass(local.scattering_density_ms, sizes.scattering_depth(),
+				[&](int layer) { pipeline.compute_scattering_density(order, layer); });
+			pass(local.indirect_irradiance_ms, sizes.irradiance_height,
+				[&](int row) { pipeline.compute_indirect_irradiance(order, row); });
+			pass(local.multiple_scattering_ms, sizes.scattering_depth(),
+				[&](int layer) { pipeline.compute_multiple_scattering(order, layer); });
+		}
+		if (cancel && *cancel) return false;
+		pipeline.take_luts(out);
+
+		if (stats)
+		{
+			local.total_ms = elapsed_ms(start);
+			local.threads = thread_count;
+			*stats = local;
+		}
+		return true;
+	}
+
+	incremental_precompute::incremental_precompute(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		int scattering_orders)
+		: m_pipeline(atmosphere, sizes), m_scattering_orders(scattering_orders), m_stage(stage::transmittance), m_order(2),
+		m_index(0), m_steps_done(0), m_step_count(0)
+	{
+		if (scattering_orders < 1) throw std::invalid_argument("atmosphere: scattering_orders must be at least 1");
+		m_step_count = stage_steps(stage::transmittance) + stage_steps(stage::direct_irradiance) +
+			stage_steps(stage::single_scattering) + (scattering_orders - 1) * (stage_steps(stage::scattering_density) +
+				stage_steps(stage::indirect_irradiance) + stage_steps(stage::multiple_scattering));
+	}
+
+	int incremental_precompute::stage_steps(stage s) const
+	{
+		const lut_sizes& sizes = m_pipeline.sizes();
+		switch (s)
+		{
+		case stage::transmittance: return sizes.transmittance_height;
+		case stage::direct_irradiance:
+		case stage::indirect_irradiance: return sizes.irradiance_height;
+		case stage::single_scattering:
+		case stage::scattering_density:
+		case stage::multiple_scattering: return sizes.scattering_depth() * sizes.scattering_height();
+		default: return 0;
+		}
+	}
+
+	void incremental_precompute::next_stage()
+	{
+		m_index = 0;
+		switch (m_stage)
+		{
+		case stage::transmittance: m_stage = stage::direct_irradiance; break;
+		case stage::direct_irradiance: m_stage = stage::single_scattering; break;
+		case stage::single_scattering:
+			m_stage = m_scattering_orders >= 2 ? stage::scattering_density : stage::complete;
+			break;
+		case stage::scattering_density: m_stage = stage::indirect_irradiance; break;
+		case stage::indirect_irradiance: m_stage = stage::multiple_scattering; break;
+		case stage::multiple_scattering:
+			m_stage = ++m_order <= m_scattering_orders ? stage::scattering_density : stage::complete;
+			break;
+		default: break;
+		}
+	}
+
+	bool incremental_precompute::step()
+	{
+		if (m_stage == stage::complete) return false;
+		const int height = m_pipeline.sizes().scattering_height();
+		const int layer = m_index / height, row = m_index % height;
+		switch (m_stage)
+		{
+		case stage::transmittance: m_pipeline.compute_transmittance(m_index); break;
+		case stage::direct_irradiance: m_pipeline.compute_direct_irradiance(m_index); break;
+		case stage::single_scattering: m_pipeline.compute_single_scattering(layer, row, row + 1); break;
+		case stage::scattering_density: m_pipeline.compute_scattering_density(m_order, layer, row, row + 1); break;
+		case stage::indirect_irradiance: m_pipeline.compute_indirect_irradiance(m_order, m_index); break;
+		case stage::multiple_scattering: m_pipeline.compute_multiple_scattering(m_order, layer, row, row + 1); break;
+		default: break;
+		}
+		++m_steps_done;
+		if (++m_index == stage_steps(m_stage)) next_stage();
+		return m_stage != stage::complete;
+	}
+
+	bool incremental_precompute::advance(double budget_ms)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		while (step() && elapsed_ms(start) < budget_ms) {}
+		return is_complete();
+	}
+
+	void incremental_precompute::take_luts(luts& out)
+	{
+		if (!is_complete()) throw std::logic_error("atmosphere: the precompute is not complete");
+		m_pipeline.take_luts(out);
+	}
+
+	void analytic_luts(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, luts& out)
+	{
+		const atmosphere_parameters& atm = atmosphere;
+		out.sizes = sizes;
+		out.transmittance.resize(sizes.transmittance_width, sizes.transmittance_height);
+		out.scattering.resize(sizes.scattering_width(), sizes.scattering_height(), sizes.scattering_depth());
+		out.irradiance.resize(sizes.irradiance_width, sizes.irradiance_height);
+
+		for (int y = 0; y < sizes.transmittance_height; ++y)
+			for (int x = 0; x < sizes.transmittance_width; ++x)
+			{
+				float r, mu;
+				get_r_mu_from_transmittance_texture_uv(atm, sizes, ((float)x + 0.5f) / (float)sizes.transmittance_width,
+					((float)y + 0.5f) / (float)sizes.transmittance_height, r, mu);
+				rgba optical_depth = atm.rayleigh_scattering * chapman_optical_length(atm, atm.rayleigh_scale_height, r, mu) +
+					atm.mie_extinction * chapman_optical_length(atm, atm.mie_scale_height, r, mu);
+				out.transmittance.at(x, y) = exp(rgba(0.0f) - optical_depth.rgb());
+			}
+
+		for (int z = 0; z < sizes.scattering_depth(); ++z)
+			for (int y = 0; y < sizes.scattering_height(); ++y)
+				for (int x = 0; x < sizes.scattering_width(); ++x)
+				{
+					float r, mu, mu_s, nu;
+					bool ray_r_mu_intersects_ground;
+					get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(atm, sizes, (float)x + 0.5f, (float)y + 0.5f,
+						(float)z + 0.5f, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+					if (ray_intersects_ground(atm, r, mu_s)) continue;
+					const rgba rayleigh = atm.rayleigh_scattering * expf(-(r - atm.bottom_radius) / atm.rayleigh_scale_height);
+					const float mie_density = expf(-(r - atm.bottom_radius) / atm.mie_scale_height);
+					const rgba extinction = (rayleigh + atm.mie_extinction * mie_density).with_alpha(1.0f);
+					const float d = distance_to_nearest_atmosphere_boundary(atm, r, mu, ray_r_mu_intersects_ground);
+					const rgba view = get_transmittance(atm, sizes, out.transmittance, r, mu, d, ray_r_mu_intersects_ground);
+					const rgba sun = get_transmittance_to_top_atmosphere_boundary(atm, sizes, out.transmittance, r, mu_s);
+					// in-scattering of a homogeneous layer: (1 - T) / extinction per unit scattering
+					const rgba in_scattered = atm.solar_irradiance * sun * (rgba(1.0f) - view) / extinction;
+					const rgba mie = (in_scattered * atm.mie_scattering * mie_density).rgb();
+					out.scattering.at(x, y, z) = (in_scattered * rayleigh).rgb().with_alpha(mie.r);
+				}
+	}
+
+	void lut_scheduler::adopt(const atmosphere_parameters& atmosphere, std::shared_ptr<const luts> luts)
+	{
+		m_pending.reset();
+		m_current_atmosphere = atmosphere;
+		std::atomic_store(&m_current, std::move(luts));
+	}
+
+	void lut_scheduler::begin(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, int scattering_orders)
+	{
+		m_pending = std::make_unique<incremental_precompute>(atmosphere, sizes, scattering_orders);
+		m_pending_atmosphere = atmosphere;
+		if (!m_current || m_current_atmosphere.bottom_radius != atmosphere.bottom_radius ||
+			m_current_atmosphere.top_radius != atmosphere.top_radius)
+		{
+			auto fallback = std::make_shared<luts>();
+			analytic_luts(atmosphere, sizes, *fallback);
+			m_current_atmosphere = atmosphere;
+			std::atomic_store(&m_current, std::shared_ptr<const luts>(std::move(fallback)));
+		}
+	}
+
+	bool lut_scheduler::update(double budget_ms)
+	{
+		if (!m_pending || !m_pending->advance(budget_ms)) return false;
+		auto complete = std::make_shared<luts>();
+		m_pending->take_luts(*complete);
+		m_pending.reset();
+		m_current_atmosphere = m_pending_atmosphere;
+		std::atomic_store(&m_current, std::shared_ptr<const luts>(std::move(complete)));
+		return true;
+	}
+}
+}
@@ -0,0 +1,321 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// the SSE path of the spectra follows IvMath's (CALI_MATH_SIMD)
+#include <IvSIMD.h>
+
+#include "shaders/BrunetonCommonDefs.h"
+
+namespace cali
+{
+namespace atmosphere
+{
+	// One spectrum or texel: the three wavelengths of the model in rgb plus the
+	// alpha channel of the textures. The four channels are computed at once.
+	struct alignas(16) rgba
+	{
+		float r, g, b, a;
+
+		rgba() : r(0.0f), g(0.0f), b(0.0f), a(0.0f) {}
+		rgba(float r, float g, float b, float a = 0.0f) : r(r), g(g), b(b), a(a) {}
+		explicit rgba(float v) : r(v), g(v), b(v), a(v) {}
+
+		rgba rgb() const { return rgba(r, g, b, 0.0f); }
+		rgba with_alpha(float alpha) const { return rgba(r, g, b, alpha); }
+	};
+
+#if defined(IV_SIMD_SSE)
+	namespace simd
+	{
+		inline __m128 load(const rgba& x) { return _mm_load_ps(&x.r); }
+		inline rgba store(__m128 v) { rgba x; _mm_store_ps(&x.r, v); return x; }
+	}
+	inline rgba operator+(const rgba& x, const rgba& y) { return simd::store(_mm_add_ps(simd::load(x), simd::load(y))); }
+	inline rgba operator-(const rgba& x, const rgba& y) { return simd::store(_mm_sub_ps(simd::load(x), simd::load(y))); }
+	inline rgba operator*(const rgba& x, const rgba& y) { return simd::store(_mm_mul_ps(simd::load(x), simd::load(y))); }
+	inline rgba operator/(const rgba& x, const rgba& y) { return simd::store(_mm_div_ps(simd::load(x), simd::load(y))); }
+	inline rgba operator*(const rgba& x, float s) { return simd::store(_mm_mul_ps(simd::load(x), _mm_set1_ps(s))); }
+	inline rgba min_per_lane(const rgba& x, const rgba& y) { return simd::store(_mm_min_ps(simd::load(x), simd::load(y))); }
+#else
+	inline rgba operator+(const rgba& x, const rgba& y) { return rgba(x.r + y.r, x.g + y.g, x.b + y.b, x.a + y.a); }
+	inline rgba operator-(const rgba& x, const rgba& y) { return rgba(x.r - y.r, x.g - y.g, x.b - y.b, x.a - y.a); }
+	inline rgba operator*(const rgba& x, const rgba& y) { return rgba(x.r * y.r, x.g * y.g, x.b * y.b, x.a * y.a); }
+	inline rgba operator/(const rgba& x, const rgba& y) { return rgba(x.r / y.r, x.g / y.g, x.b / y.b, x.a / y.a); }
+	inline rgba operator*(const rgba& x, float s) { return rgba(x.r * s, x.g * s, x.b * s, x.a * s); }
+	inline rgba min_per_lane(const rgba& x, const rgba& y) { return rgba((std::min)(x.r, y.r), (std::min)(x.g, y.g), (std::min)(x.b, y.b), (std::min)(x.a, y.a)); }
+#endif
+	inline rgba operator*(float s, const rgba& x) { return x * s; }
+	inline rgba& operator+=(rgba& x, const rgba& y) { return x = x + y; }
+	inline rgba& operator*=(rgba& x, const rgba& y) { return x = x * y; }
+	inline rgba exp(const rgba& x) { return rgba(expf(x.r), expf(x.g), expf(x.b), expf(x.a)); }
+	inline rgba lerp(const rgba& x, const rgba& y, float t) { return x * (1.0f - t) + y * t; }
+
+	// Row-major texel storage, row 0 at v = 0 (the first row of the D3D texture).
+	// sample() is bilinear with clamp to edge, the sampler the GPU passes use.
+	struct texture_2d
+	{
+		int width = 0, height = 0;
+		std::vector<rgba> texels;
+
+		void resize(int w, int h) { width = w; height = h; texels.assign((size_t)w * h, rgba()); }
+		rgba& at(int x, int y) { return texels[(size_t)y * width + x]; }
+		const rgba& at(int x, int y) const { return texels[(size_t)y * width + x]; }
+
+		rgba sample(float u, float v) const
+		{
+			float tx = u * width - 0.5f, ty = v * height - 0.5f;
+			float fx0 = floorf(tx), fy0 = floorf(ty);
+			float fx = tx - fx0, fy = ty - fy0;
+			int x0 = std::clamp((int)fx0, 0, width - 1), x1 = std::clamp((int)fx0 + 1, 0, width - 1);
+			int y0 = std::clamp((int)fy0, 0, height - 1), y1 = std::clamp((int)fy0 + 1, 0, height - 1);
+			return lerp(lerp(at(x0, y0), at(x1, y0), fx), lerp(at(x0, y1), at(x1, y1), fx), fy);
+		}
+	};
+
+	struct texture_3d
+	{
+		int width = 0, height = 0, depth = 0;
+		std::vector<rgba> texels;
+
+		void resize(int w, int h, int d) { width = w; height = h; depth = d; texels.assign((size_t)w * h * d, rgba()); }
+		rgba& at(int x, int y, int z) { return texels[((size_t)z * height + y) * width + x]; }
+		const rgba& at(int x, int y, int z) const { return texels[((size_t)z * height + y) * width + x]; }
+
+		rgba sample(float u, float v, float w) const
+		{
+			float tx = u * width - 0.5f, ty = v * height - 0.5f, tz = w * depth - 0.5f;
+			float fx0 = floorf(tx), fy0 = floorf(ty), fz0 = floorf(tz);
+			float fx = tx - fx0, fy = ty - fy0, fz = tz - fz0;
+			int x0 = std::clamp((int)fx0, 0, width - 1), x1 = std::clamp((int)fx0 + 1, 0, width - 1);
+			int y0 = std::clamp((int)fy0, 0, height - 1), y1 = std::clamp((int)fy0 + 1, 0, height - 1);
+			int z0 = std::clamp((int)fz0, 0, depth - 1), z1 = std::clamp((int)fz0 + 1, 0, depth - 1);
+			rgba near_z = lerp(lerp(at(x0, y0, z0), at(x1, y0, z0), fx), lerp(at(x0, y1, z0), at(x1, y1, z0), fx), fy);
+			rgba far_z = lerp(lerp(at(x0, y0, z1), at(x1, y0, z1), fx), lerp(at(x0, y1, z1), at(x1, y1, z1), fx), fy);
+			return lerp(near_z, far_z, fz);
+		}
+	};
+
+	// AtmosphereParameters of bruneton_common.fx; lengths in km.
+	struct atmosphere_parameters
+	{
+		rgba solar_irradiance;
+		float sun_angular_radius;
+		float bottom_radius;
+		float top_radius;
+		float rayleigh_scale_height;
+		rgba rayleigh_scattering;
+		float mie_scale_height;
+		rgba mie_scattering;
+		rgba mie_extinction;
+		float mie_phase_function_g;
+		rgba ground_albedo;
+		float mu_s_min;
+	};
+
+	// The atmosphere bruneton starts with, and passes to the shaders as
+	// ATMOSPHERE (the Atmosphere cbuffer, b5).
+	atmosphere_parameters earth_atmosphere();
+
+	// Texture sizes; the defaults are those of shaders/BrunetonCommonDefs.h.
+	struct lut_sizes
+	{
+		int transmittance_width = TRANSMITTANCE_TEXTURE_WIDTH;
+		int transmittance_height = TRANSMITTANCE_TEXTURE_HEIGHT;
+		int scattering_r = SCATTERING_TEXTURE_R_SIZE;
+		int scattering_mu = SCATTERING_TEXTURE_MU_SIZE;
+		int scattering_mu_s = SCATTERING_TEXTURE_MU_S_SIZE;
+		int scattering_nu = SCATTERING_TEXTURE_NU_SIZE;
+		int irradiance_width = IRRADIANCE_TEXTURE_WIDTH;
+		int irradiance_height = IRRADIANCE_TEXTURE_HEIGHT;
+
+		int scattering_width() const { return scattering_nu * scattering_mu_s; }
+		int scattering_height() const { return scattering_mu; }
+		int scattering_depth() const { return scattering_r; }
+	};
+
+	// Resolution presets, precompute time and memory against sky quality; high
+	// is the default lut_sizes. compare_luts (AtmosphereQuery.h) measures what
+	// the others lose, cali_bench --lut-tiers reports it.
+	enum class lut_tier { low, medium, high };
+	lut_sizes lut_sizes_for(lut_tier tier);
+	const char* lut_tier_name(lut_tier tier);
+
+	// What bruneton::precompute leaves for the renderer.
+	struct luts
+	{
+		lut_sizes sizes;
+		texture_2d transmittance;
+		texture_3d scattering;   // rayleigh + multiple in rgb, single mie red in alpha
+		texture_2d irradiance;   // indirect irradiance only, like the GPU texture
+	};
+
+	// The passes of bruneton::precompute on the CPU, with the same intermediate
+	// textures and in the same order:
+	//   transmittance, direct irradiance, single scattering, then for each
+	//   scattering order >= 2: scattering density, indirect irradiance,
+	//   multiple scattering.
+	// 2D passes run one row, 3D passes one r-layer per call, or the rows
+	// [first_row, end_row) of it. Rows and layers of one pass are independent,
+	// so they can go to different threads.
+	class precompute_pipeline
+	{
+	public:
+		precompute_pipeline(const atmosphere_parameters& atmosphere, const lut_sizes& sizes);
+
+		void compute_transmittance(int row);
+		void compute_direct_irradiance(int row);
+		void compute_single_scattering(int layer) { compute_single_scattering(layer, 0, m_sizes.scattering_height()); }
+		void compute_single_scattering(int layer, int first_row, int end_row);
+		void compute_scattering_density(int scattering_order, int layer)
+		{
+			compute_scattering_density(scattering_order, layer, 0, m_sizes.scattering_height());
+		}
+		void compute_scattering_density(int scattering_order, int layer, int first_row, int end_row);
+		void compute_indirect_irradiance(int scattering_order, int row);
+		void compute_multiple_scattering(int scattering_order, int layer)
+		{
+			compute_multiple_scattering(scattering_order, layer, 0, m_sizes.scattering_height());
+		}
+		void compute_multiple_scattering(int scattering_order, int layer, int first_row, int end_row);
+
+		const atmosphere_parameters& atmosphere() const { return m_atmosphere; }
+		const lut_sizes& sizes() const { return m_sizes; }
+		const texture_2d& transmittance() const { return m_transmittance; }
+		const texture_2d& delta_irradiance() const { return m_delta_irradiance; }
+		const texture_2d& irradiance() const { return m_irradiance; }
+		const texture_3d& scattering() const { return m_scattering; }
+		const texture_3d& delta_rayleigh_scattering() const { return m_delta_rayleigh_scattering; }
+		const texture_3d& delta_mie_scattering() const { return m_delta_mie_scattering; }
+		const texture_3d& delta_scattering_density() const { return m_delta_scattering_density; }
+
+		// Moves the final textures out; the pipeline is spent afterwards.
+		void take_luts(luts& out);
+
+	private:
+		atmosphere_parameters m_atmosphere;
+		lut_sizes m_sizes;
+		texture_2d m_transmittance;
+		texture_2d m_delta_irradiance;
+		texture_2d m_irradiance;
+		texture_3d m_scattering;
+		texture_3d m_delta_rayleigh_scattering; // also delta multiple scattering from order 2 on
+		texture_3d m_delta_mie_scattering;
+		texture_3d m_delta_scattering_density;
+	};
+
+	static const int c_scattering_orders = 4;
+
+	struct precompute_stats
+	{
+		double transmittance_ms = 0.0;
+		double direct_irradiance_ms = 0.0;
+		double single_scattering_ms = 0.0;
+		double scattering_density_ms = 0.0;   // all orders
+		double indirect_irradiance_ms = 0.0;
+		double multiple_scattering_ms = 0.0;
+		double total_ms = 0.0;
+		int threads = 0;
+	};
+
+	// Runs the whole pipeline, rows and layers spread over `threads` (0:
+	// hardware concurrency). Setting `cancel` stops it after the rows and
+	// layers in flight; it then returns false and leaves `out` untouched.
+	bool precompute(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, luts& out,
+		int scattering_orders = c_scattering_orders, int threads = 0, precompute_stats* stats = nullptr,
+		const std::atomic<bool>* cancel = nullptr);
+
+	// precompute() as a state machine that runs a bounded amount of work per
+	// call, for recomputing the LUTs over several frames. The unit of work is
+	// one row, of a 2D texture or of one layer of a 3D one; the rows are the
+	// same as those of precompute(), which the result matches exactly.
+	class incremental_precompute
+	{
+	public:
+		incremental_precompute(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+			int scattering_orders = c_scattering_orders);
+
+		// Runs one row. False once every pass is done.
+		bool step();
+		// Runs rows until budget_ms have passed, at least one. True once every
+		// pass is done. A row of the scattering density pass is the longest,
+		// a few ms at the default sizes.
+		bool advance(double budget_ms);
+
+		bool is_complete() const { return m_stage == stage::complete; }
+		int steps_done() const { return m_steps_done; }
+		int step_count() const { return m_step_count; }
+		float progress() const { return (float)m_steps_done / (float)m_step_count; }
+
+		// Moves the final textures out once complete.
+		void take_luts(luts& out);
+
+	private:
+		enum class stage
+		{
+			transmittance,
+			direct_irradiance,
+			single_scattering,
+			scattering_density,
+			indirect_irradiance,
+			multiple_scattering,
+			complete
+		};
+
+		int stage_steps(stage s) const;
+		void next_stage();
+
+		precompute_pipeline m_pipeline;
+		const int m_scattering_orders;
+		stage m_stage;
+		int m_order;
+		int m_index;    // row within the stage; layer * scattering_height + row for 3D passes
+		int m_steps_done;
+		int m_step_count;
+	};
+
+	// Cheap stand-in for the LUTs while no precomputed set exists yet:
+	// transmittance from the Chapman function approximation for an atmosphere
+	// without top, single scattering of a homogeneous layer at the density of
+	// the view point, no indirect irradiance. A few hundred ms at the default
+	// sizes, against tens of seconds for precompute().
+	void analytic_luts(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, luts& out);
+
+	// The LUTs the CPU side reads and the set being computed for new
+	// parameters. current() keeps returning the previous set until the new set
+	// is complete; then the new set replaces it in one pointer exchange. The
+	// analytic set of the new parameters stands in when there was none, or
+	// when the previous one is of another planet (other bottom or top radius),
+	// whose sky does not fit the new ground. update(), begin() and adopt()
+	// belong to one thread, current() can be called from any.
+	class lut_scheduler
+	{
+	public:
+		// Makes `luts` the current set, of `atmosphere`: LUTs computed
+		// elsewhere (the GPU, the cache). Drops a set still in progress.
+		void adopt(const atmosphere_parameters& atmosphere, std::shared_ptr<const luts> luts);
+		// Starts the LUTs of `atmosphere`, dropping a set still in progress.
+		void begin(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+			int scattering_orders = c_scattering_orders);
+		// Advances the set in progress by about budget_ms. True when it was
+		// completed, and became current, in this call.
+		bool update(double budget_ms);
+
+		bool is_pending() const { return m_pending != nullptr; }
+		float progress() const { return m_pending ? m_pending->progress() : 1.0f; }
+		std::shared_ptr<const luts> current() const { return std::atomic_load(&m_current); }
+		// The parameters of current(), on the thread of update().
+		const atmosphere_parameters& current_atmosphere() const { return m_current_atmosphere; }
+
+	private:
+		std::unique_ptr<incremental_precompute> m_pending;
+		atmosphere_parameters m_pending_atmosphere;
+		std::shared_ptr<const luts> m_current;
+		atmosphere_parameters m_current_atmosphere;
+	};
+}
+}
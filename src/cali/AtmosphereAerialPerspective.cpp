@@ -0,0 +1,124 @@
+#include "AtmosphereAerialPerspective.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace cali
+{
+namespace atmosphere
+{
+	aerial_perspective::aerial_perspective(int width, int height, int depth, float max_distance_km, int threads) :
+		m_max_distance(max_distance_km),
+		m_last_compute_ms(0.0),
+		m_query(nullptr),
+		m_camera(),
+		m_sun_direction(0.0f, 0.0f, 0.0f),
+		m_next_ray(0),
+		m_frame(0),
+		m_busy_workers(0),
+		m_stop(false)
+	{
+		if (width <= 0 || height <= 0 || depth <= 0 || !(max_distance_km > 0.0f))
+			throw std::invalid_argument("atmosphere: invalid aerial perspective volume");
+
+		m_in_scattering.resize(width, height, depth);
+		m_transmittance.resize(width, height, depth);
+		m_slice_distances.resize(depth);
+		for (int z = 0; z < depth; ++z) m_slice_distances[z] = slice_distance(z);
+
+		const int thread_count = threads > 0 ? threads : (std::max)(1, (int)std::thread::hardware_concurrency());
+		for (int i = 1; i < thread_count; ++i) m_workers.emplace_back(&aerial_perspective::work, this);
+	}
+
+	aerial_perspective::~aerial_perspective()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_start.notify_all();
+		for (std::thread& worker : m_workers) worker.join();
+	}
+
+	float aerial_perspective::slice_distance(int z) const
+	{
+		const float w = ((float)z + 0.5f) / (float)m_in_scattering.depth;
+		return m_max_distance * w * w;
+	}
+
+	float aerial_perspective::depth_coordinate(float distance_km) const
+	{
+		return sqrtf((std::max)(distance_km, 0.0f) / m_max_distance);
+	}
+
+	IvVector3 aerial_perspective::view_ray(const froxel_camera& camera, int x, int y) const
+	{
+		const float u = ((float)x + 0.5f) / (float)m_in_scattering.width;
+		const float v = ((float)y + 0.5f) / (float)m_in_scattering.height;
+		IvVector3 ray = camera.forward + camera.right * ((2.0f * u - 1.0f) * camera.tan_half_fov_x) +
+			camera.up * ((1.0f - 2.0f * v) * camera.tan_half_fov_y);
+		ray.Normalize();
+		return ray;
+	}
+
+	void aerial_perspective::compute(const atmosphere_query& query, const froxel_camera& camera, const IvVector3& sun_direction)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_query = &query;
+			m_camera = camera;
+			m_sun_direction = sun_direction;
+			m_next_ray = 0;
+			m_busy_workers = (int)m_workers.size();
+			++m_frame;
+		}
+		m_start.notify_all();
+		compute_rays();
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [this]() { return m_busy_workers == 0; });
+			m_query = nullptr;
+		}
+		m_last_compute_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void aerial_perspective::work()
+	{
+		uint64_t frame = 0;
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_start.wait(lock, [&]() { return m_stop || m_frame != frame; });
+				if (m_stop) return;
+				frame = m_frame;
+			}
+			compute_rays();
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_busy_workers == 0) m_done.notify_one();
+			}
+		}
+	}
+
+	void aerial_perspective::compute_rays()
+	{
+		const int width = m_in_scattering.width, height = m_in_scattering.height, depth = m_in_scattering.depth;
+		std::vector<rgba> radiance(depth), transmittance(depth);
+		for (int ray = m_next_ray++; ray < width * height; ray = m_next_ray++)
+		{
+			const int x = ray % width, y = ray / width;
+			m_query->sky_radiance_to_points(m_camera.position, view_ray(m_camera, x, y), m_slice_distances.data(), depth,
+				m_sun_direction, radiance.data(), transmittance.data());
+			for (int z = 0; z < depth; ++z)
+			{
+				m_in_scattering.at(x, y, z) = radiance[z];
+				m_transmittance.at(x, y, z) = transmittance[z];
+			}
+		}
+	}
+}
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include "AtmosphereQuery.h"
+
+#include <IvVector3.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace cali
+{
+namespace atmosphere
+{
+	// The camera of a froxel volume: position relative to the planet center
+	// in km, unit basis and the tangents of half the field of view.
+	struct froxel_camera
+	{
+		IvVector3 position;
+		IvVector3 forward;
+		IvVector3 right;
+		IvVector3 up;
+		float tan_half_fov_x;
+		float tan_half_fov_y;
+	};
+
+	// Aerial perspective as a camera-aligned froxel volume: the in-scattering
+	// (GetSkyRadianceToPoint) and the transmittance from the camera to the
+	// center of every froxel, so a pixel shader does one trilinear fetch
+	// instead of two scattering lookups. Texel (x, y) is the view ray through
+	// u = (x + 0.5) / width, v = (y + 0.5) / height of the screen (v down),
+	// slice z the distance max_distance * w^2 along it, w = (z + 0.5) / depth:
+	// finer near the camera, where the in-scattering changes fastest.
+	//
+	// compute() fills the volume on persistent worker threads plus the
+	// calling one, one view ray per unit of work; every froxel depends on its
+	// ray only, so the result does not depend on the thread count.
+	class aerial_perspective
+	{
+	public:
+		// threads = 0: hardware concurrency.
+		explicit aerial_perspective(int width = 32, int height = 32, int depth = 32, float max_distance_km = 128.0f,
+			int threads = 0);
+		~aerial_perspective();
+
+		aerial_perspective(const aerial_perspective&) = delete;
+		aerial_perspective& operator=(const aerial_perspective&) = delete;
+
+		// Blocks until the volume is complete.
+		void compute(const atmosphere_query& query, const froxel_camera& camera, const IvVector3& sun_direction);
+
+		// rgb, alpha 0
+		const texture_3d& in_scattering() const { return m_in_scattering; }
+		const texture_3d& transmittance() const { return m_transmittance; }
+
+		float max_distance() const { return m_max_distance; }
+		int threads() const { return (int)m_workers.size() + 1; }
+		double last_compute_ms() const { return m_last_compute_ms; }
+
+		// Distance of the centers of slice z in km, and the w coordinate of a
+		// distance, as the shader computes it.
+		float slice_distance(int z) const;
+		float depth_coordinate(float distance_km) const;
+		// The unit view ray through froxel column (x, y).
+		IvVector3 view_ray(const froxel_camera& camera, int x, int y) const;
+
+	private:
+		void work();
+		void compute_rays();
+
+		texture_3d m_in_scattering;
+		texture_3d m_transmittance;
+		float m_max_distance;
+		std::vector<float> m_slice_distances;
+		double m_last_compute_ms;
+
+		// the frame in flight
+		const atmosphere_query* m_query;
+		froxel_camera m_camera;
+		IvVector3 m_sun_direction;
+		std::atomic<int> m_next_ray;
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_mutex;
+		std::condition_variable m_start;
+		std::condition_variable m_done;
+		uint64_t m_frame;
+		int m_busy_workers;
+		bool m_stop;
+	};
+}
+}
@@ -0,0 +1,106 @@
+#include "AtmosphereAmbient.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cali
+{
+namespace atmosphere
+{
+	namespace
+	{
+		const float c_pi = 3.14159265358979323846f;
+	}
+
+	void sh9::basis(const IvVector3& d, float out[9])
+	{
+		out[0] = 0.282095f;
+		out[1] = 0.488603f * d.y;
+		out[2] = 0.488603f * d.z;
+		out[3] = 0.488603f * d.x;
+		out[4] = 1.092548f * d.x * d.y;
+		out[5] = 1.092548f * d.y * d.z;
+		out[6] = 0.315392f * (3.0f * d.z * d.z - 1.0f);
+		out[7] = 1.092548f * d.x * d.z;
+		out[8] = 0.546274f * (d.x * d.x - d.y * d.y);
+	}
+
+	rgba sh9::evaluate(const IvVector3& direction) const
+	{
+		float y[9];
+		basis(direction, y);
+		rgba result;
+		for (int i = 0; i < 9; ++i) result += c[i] * y[i];
+		return result;
+	}
+
+	sh9 sh9::irradiance() const
+	{
+		// Ramamoorthi and Hanrahan: A_0 = pi, A_1 = 2 pi / 3, A_2 = pi / 4
+		const float a[3] = { c_pi, 2.0f * c_pi / 3.0f, c_pi / 4.0f };
+		sh9 result;
+		result.c[0] = c[0] * a[0];
+		for (int i = 1; i < 4; ++i) result.c[i] = c[i] * a[1];
+		for (int i = 4; i < 9; ++i) result.c[i] = c[i] * a[2];
+		return result;
+	}
+
+	std::vector<IvVector3> sphere_directions(size_t count)
+	{
+		const float golden_angle = c_pi * (3.0f - sqrtf(5.0f));
+		std::vector<IvVector3> directions(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float z = 1.0f - (2.0f * (float)i + 1.0f) / (float)count;
+			const float r = sqrtf((std::max)(1.0f - z * z, 0.0f));
+			const float phi = golden_angle * (float)i;
+			directions[i] = IvVector3(r * cosf(phi), r * sinf(phi), z);
+		}
+		return directions;
+	}
+
+	sh9 project_sh9(const IvVector3* directions, const rgba* values, size_t count)
+	{
+		sh9 result;
+		if (count == 0) return result;
+		for (size_t i = 0; i < count; ++i)
+		{
+			float y[9];
+			sh9::basis(directions[i], y);
+			for (int k = 0; k < 9; ++k) result.c[k] += values[i] * y[k];
+		}
+		const float weight = 4.0f * c_pi / (float)count;
+		for (rgba& c : result.c) c = c * weight;
+		return result;
+	}
+
+	sky_ambient::sky_ambient(size_t direction_count, float sun_threshold_radians, float altitude_threshold_km) :
+		m_directions(sphere_directions(direction_count)),
+		m_radiance(direction_count),
+		m_cos_sun_threshold(cosf(sun_threshold_radians)),
+		m_altitude_threshold(altitude_threshold_km),
+		m_sun_direction(0.0f, 0.0f, 0.0f),
+		m_altitude(0.0f),
+		m_projections(0)
+	{
+	}
+
+	bool sky_ambient::update(const std::shared_ptr<const atmosphere_query>& query, const IvVector3& camera,
+		const IvVector3& sun_direction)
+	{
+		if (!query) return false;
+		const float altitude = camera.Length() - query->atmosphere().bottom_radius;
+		if (query == m_query && sun_direction.Dot(m_sun_direction) >= m_cos_sun_threshold &&
+			fabsf(altitude - m_altitude) <= m_altitude_threshold)
+			return false;
+
+		query->sky_radiance(camera, m_directions.data(), m_directions.size(), sun_direction, m_radiance.data());
+		m_irradiance = project_sh9(m_directions.data(), m_radiance.data(), m_directions.size()).irradiance();
+		m_query = query;
+		m_sun_direction = sun_direction;
+		m_altitude = altitude;
+		++m_projections;
+		return true;
+	}
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "AtmosphereQuery.h"
+
+#include <IvVector3.h>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace cali
+{
+namespace atmosphere
+{
+	// L2 spherical harmonics of an rgb function of the direction, in the
+	// order (l, m) = (0,0), (1,-1), (1,0), (1,1), (2,-2), (2,-1), (2,0), (2,1), (2,2)
+	// of the real basis: y, z, x for l = 1.
+	struct sh9
+	{
+		rgba c[9];
+
+		static void basis(const IvVector3& d, float out[9]);
+
+		rgba evaluate(const IvVector3& direction) const;
+		// The cosine lobe convolution: irradiance on a surface facing
+		// `normal` when the coefficients are those of the radiance.
+		sh9 irradiance() const;
+	};
+
+	// `count` unit directions spread evenly over the sphere (Fibonacci spiral).
+	std::vector<IvVector3> sphere_directions(size_t count);
+
+	// Monte Carlo projection with equal weights 4 pi / count; `directions`
+	// should cover the sphere evenly.
+	sh9 project_sh9(const IvVector3* directions, const rgba* values, size_t count);
+
+	// The sky radiance around a camera as SH irradiance coefficients for
+	// ambient lighting. update() projects it again only once the sun has moved
+	// by more than the threshold, the camera has changed altitude or the LUTs
+	// have been replaced; a projection is one batched sky_radiance() over the
+	// direction set.
+	class sky_ambient
+	{
+	public:
+		explicit sky_ambient(size_t direction_count = 256, float sun_threshold_radians = 0.01f,
+			float altitude_threshold_km = 1.0f);
+
+		// `camera` relative to the planet center in km, as in atmosphere_query.
+		// True when the coefficients changed. Keeps `query` for the comparison.
+		bool update(const std::shared_ptr<const atmosphere_query>& query, const IvVector3& camera,
+			const IvVector3& sun_direction);
+
+		// Irradiance coefficients, evaluate() gives the sky irradiance of a normal.
+		const sh9& irradiance() const { return m_irradiance; }
+		bool is_valid() const { return m_query != nullptr; }
+		int projections() const { return m_projections; }
+
+	private:
+		std::vector<IvVector3> m_directions;
+		std::vector<rgba> m_radiance;
+		float m_cos_sun_threshold;
+		float m_altitude_threshold;
+
+		std::shared_ptr<const atmosphere_query> m_query;
+		IvVector3 m_sun_direction;
+		float m_altitude;
+		sh9 m_irradiance;
+		int m_projections;
+	};
+}
+}
@@ -0,0 +1,279 @@
+#include "AtmosphereCache.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace cali
+{
+namespace atmosphere
+{
+	namespace
+	{
+		// payload: header, then transmittance, scattering and irradiance texels
+		struct lut_file_header
+		{
+			uint64_t hash;
+			int32_t sizes[8];
+			int32_t scattering_orders;
+			int32_t reserved;
+		};
+
+		void size_array(const lut_sizes& sizes, int32_t out[8])
+		{
+			out[0] = sizes.transmittance_width;
+			out[1] = sizes.transmittance_height;
+			out[2] = sizes.scattering_r;
+			out[3] = sizes.scattering_mu;
+			out[4] = sizes.scattering_mu_s;
+			out[5] = sizes.scattering_nu;
+			out[6] = sizes.irradiance_width;
+			out[7] = sizes.irradiance_height;
+		}
+
+		size_t texel_count_2d(int width, int height) { return (size_t)width * height * 4; }
+
+		struct fnv1a_hasher
+		{
+			uint64_t h = 14695981039346656037ULL;
+
+			void add(const void* data, size_t size)
+			{
+				const unsigned char* bytes = static_cast<const unsigned char*>(data);
+				for (size_t i = 0; i < size; ++i) { h ^= bytes[i]; h *= 1099511628211ULL; }
+			}
+			void add(float v) { add(&v, sizeof(v)); }
+			void add(const rgba& v) { add(v.r); add(v.g); add(v.b); }
+		};
+
+		const uint16_t* read_texels(const uint16_t* in, std::vector<rgba>& texels)
+		{
+			for (rgba& t : texels)
+			{
+				t = rgba(half_to_float(in[0]), half_to_float(in[1]), half_to_float(in[2]), half_to_float(in[3]));
+				in += 4;
+			}
+			return in;
+		}
+
+		uint16_t* append_texels(const std::vector<rgba>& texels, uint16_t* out)
+		{
+			for (const rgba& t : texels)
+			{
+				*out++ = float_to_half(t.r);
+				*out++ = float_to_half(t.g);
+				*out++ = float_to_half(t.b);
+				*out++ = float_to_half(t.a);
+			}
+			return out;
+		}
+	}
+
+	uint16_t float_to_half(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		const uint16_t sign = (uint16_t)((bits >> 16) & 0x8000);
+		const uint32_t magnitude = bits & 0x7fffffff;
+
+		if (magnitude >= 0x7f800000) return sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0); // inf, nan
+		if (magnitude >= 0x477ff000) return sign | 0x7c00; // rounds above 65504
+		if (magnitude < 0x38800000) // below the smallest normal half
+		{
+			if (magnitude < 0x33000000) return sign; // at most half of the smallest denormal
+			const uint32_t mantissa = (magnitude & 0x7fffff) | 0x800000;
+			const uint32_t shift = 126 - (magnitude >> 23);
+			uint32_t half = mantissa >> shift;
+			const uint32_t remainder = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+			if (remainder > halfway || (remainder == halfway && (half & 1))) ++half;
+			return sign | (uint16_t)half;
+		}
+		uint32_t half = (magnitude - 0x38000000) >> 13;
+		const uint32_t remainder = magnitude & 0x1fff;
+		if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1))) ++half;
+		return sign | (uint16_t)half;
+	}
+
+	float half_to_float(uint16_t value)
+	{
+		const uint32_t sign = (uint32_t)(value & 0x8000) << 16;
+		const uint32_t exponent = (value >> 10) & 0x1f, mantissa = value & 0x3ff;
+		if (exponent == 0)
+		{
+			float denormal = ldexpf((float)mantissa, -24);
+			return sign ? -denormal : denormal;
+		}
+		uint32_t bits = exponent == 31 ? sign | 0x7f800000 | (mantissa << 13) : sign | ((exponent + 112) << 23) | (mantissa << 13);
+		float result;
+		memcpy(&result, &bits, sizeof(result));
+		return result;
+	}
+
+	uint32_t float3_to_rgb9e5(float r, float g, float b)
+	{
+		// EXT_texture_shared_exponent, N = 9 mantissa bits, B = 15 exponent bias
+		const float max_value = 65408.0f; // (2^9 - 1) / 2^9 * 2^16
+		auto clamp_channel = [&](float v) { return v > 0.0f ? (std::min)(v, max_value) : 0.0f; };
+		const float rc = clamp_channel(r), gc = clamp_channel(g), bc = clamp_channel(b);
+		const float max_channel = (std::max)(rc, (std::max)(gc, bc));
+
+		int exponent = 0;
+		if (max_channel > 0.0f)
+		{
+			int e;
+			frexpf(max_channel, &e); // max_channel in [2^(e-1), 2^e)
+			exponent = (std::max)(-16, e - 1) + 16;
+		}
+		if ((int)floorf(max_channel * ldexpf(1.0f, 24 - exponent) + 0.5f) == 512) ++exponent;
+
+		const float scale = ldexpf(1.0f, 24 - exponent);
+		const uint32_t rm = (uint32_t)floorf(rc * scale + 0.5f);
+		const uint32_t gm = (uint32_t)floorf(gc * scale + 0.5f);
+		const uint32_t bm = (uint32_t)floorf(bc * scale + 0.5f);
+		return rm | (gm << 9) | (bm << 18) | ((uint32_t)exponent << 27);
+	}
+
+	void rgb9e5_to_float3(uint32_t value, float& r, float& g, float& b)
+	{
+		const float scale = ldexpf(1.0f, (int)(value >> 27) - 24);
+		r = (float)(value & 0x1ff) * scale;
+		g = (float)((value >> 9) & 0x1ff) * scale;
+		b = (float)((value >> 18) & 0x1ff) * scale;
+	}
+
+	void compact_scattering(const std::vector<rgba>& scattering, uint32_t* rgb, uint16_t* mie_red)
+	{
+		for (size_t i = 0; i < scattering.size(); ++i)
+		{
+			const rgba& t = scattering[i];
+			rgb[i] = float3_to_rgb9e5(t.r, t.g, t.b);
+			mie_red[i] = float_to_half(t.a);
+		}
+	}
+
+	void compact_scattering(const uint16_t* half_texels, size_t texel_count, uint32_t* rgb, uint16_t* mie_red)
+	{
+		for (size_t i = 0; i < texel_count; ++i)
+		{
+			const uint16_t* t = half_texels + i * 4;
+			rgb[i] = float3_to_rgb9e5(half_to_float(t[0]), half_to_float(t[1]), half_to_float(t[2]));
+			mie_red[i] = t[3];
+		}
+	}
+
+	lut_memory gpu_lut_memory(const lut_sizes& sizes, bool compact_scattering)
+	{
+		const size_t rgba16f = 4 * sizeof(uint16_t);
+		const size_t transmittance = (size_t)sizes.transmittance_width * sizes.transmittance_height;
+		const size_t irradiance = (size_t)sizes.irradiance_width * sizes.irradiance_height;
+		const size_t scattering = (size_t)sizes.scattering_width() * sizes.scattering_height() * sizes.scattering_depth();
+
+		lut_memory memory;
+		memory.transmittance = transmittance * rgba16f;
+		memory.irradiance = irradiance * rgba16f;
+		memory.scattering = compact_scattering ? scattering * (sizeof(uint32_t) + sizeof(uint16_t)) : scattering * rgba16f;
+		// delta irradiance, rayleigh (and multiple), mie and scattering density
+		memory.intermediates = irradiance * rgba16f + 3 * scattering * rgba16f;
+		if (compact_scattering) memory.intermediates += scattering * rgba16f;
+		return memory;
+	}
+
+	uint64_t lut_hash(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, int scattering_orders)
+	{
+		fnv1a_hasher hasher;
+		hasher.add(atmosphere.solar_irradiance);
+		hasher.add(atmosphere.sun_angular_radius);
+		hasher.add(atmosphere.bottom_radius);
+		hasher.add(atmosphere.top_radius);
+		hasher.add(atmosphere.rayleigh_scale_height);
+		hasher.add(atmosphere.rayleigh_scattering);
+		hasher.add(atmosphere.mie_scale_height);
+		hasher.add(atmosphere.mie_scattering);
+		hasher.add(atmosphere.mie_extinction);
+		hasher.add(atmosphere.mie_phase_function_g);
+		hasher.add(atmosphere.ground_albedo);
+		hasher.add(atmosphere.mu_s_min);
+		int32_t size_values[8];
+		size_array(sizes, size_values);
+		hasher.add(size_values, sizeof(size_values));
+		const int32_t orders = scattering_orders;
+		hasher.add(&orders, sizeof(orders));
+		return hasher.h;
+	}
+
+	std::string lut_cache_key(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, int scattering_orders)
+	{
+		char key[64];
+		snprintf(key, sizeof(key), "atmosphere_luts_%016llx", (unsigned long long)lut_hash(atmosphere, sizes, scattering_orders));
+		return key;
+	}
+
+	bool load_luts(const asset_cache& cache, const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		int scattering_orders, mapped_luts& out)
+	{
+		out.close();
+		if (!cache.map(lut_cache_key(atmosphere, sizes, scattering_orders), c_lut_cache_version, out.m_file)) return false;
+
+		const size_t transmittance = texel_count_2d(sizes.transmittance_width, sizes.transmittance_height);
+		const size_t scattering = texel_count_2d(sizes.scattering_width(), sizes.scattering_height()) * sizes.scattering_depth();
+		const size_t irradiance = texel_count_2d(sizes.irradiance_width, sizes.irradiance_height);
+		lut_file_header header;
+		int32_t size_values[8];
+		size_array(sizes, size_values);
+		bool ok = out.m_file.size() == sizeof(header) + (transmittance + scattering + irradiance) * sizeof(uint16_t);
+		if (ok)
+		{
+			memcpy(&header, out.m_file.data(), sizeof(header));
+			ok = header.hash == lut_hash(atmosphere, sizes, scattering_orders) &&
+				!memcmp(header.sizes, size_values, sizeof(size_values)) && header.scattering_orders == scattering_orders;
+		}
+		if (!ok)
+		{
+			out.close();
+			return false;
+		}
+		out.m_sizes = sizes;
+		out.m_transmittance = reinterpret_cast<const uint16_t*>(out.m_file.data() + sizeof(header));
+		out.m_scattering = out.m_transmittance + transmittance;
+		out.m_irradiance = out.m_scattering + scattering;
+		return true;
+	}
+
+	void unpack_luts(const lut_sizes& sizes, const uint16_t* transmittance, const uint16_t* scattering,
+		const uint16_t* irradiance, luts& out)
+	{
+		out.sizes = sizes;
+		out.transmittance.resize(sizes.transmittance_width, sizes.transmittance_height);
+		out.scattering.resize(sizes.scattering_width(), sizes.scattering_height(), sizes.scattering_depth());
+		out.irradiance.resize(sizes.irradiance_width, sizes.irradiance_height);
+		read_texels(transmittance, out.transmittance.texels);
+		read_texels(scattering, out.scattering.texels);
+		read_texels(irradiance, out.irradiance.texels);
+	}
+
+	void unpack_luts(const mapped_luts& mapped, luts& out)
+	{
+		unpack_luts(mapped.sizes(), mapped.transmittance(), mapped.scattering(), mapped.irradiance(), out);
+	}
+
+	bool store_luts(const asset_cache& cache, const atmosphere_parameters& atmosphere, const luts& luts,
+		int scattering_orders)
+	{
+		const size_t texels = luts.transmittance.texels.size() + luts.scattering.texels.size() + luts.irradiance.texels.size();
+		std::vector<unsigned char> data(sizeof(lut_file_header) + texels * 4 * sizeof(uint16_t));
+
+		lut_file_header header = {};
+		header.hash = lut_hash(atmosphere, luts.sizes, scattering_orders);
+		size_array(luts.sizes, header.sizes);
+		header.scattering_orders = scattering_orders;
+		memcpy(data.data(), &header, sizeof(header));
+
+		uint16_t* out = reinterpret_cast<uint16_t*>(data.data() + sizeof(header));
+		out = append_texels(luts.transmittance.texels, out);
+		out = append_texels(luts.scattering.texels, out);
+		append_texels(luts.irradiance.texels, out);
+		return cache.store(lut_cache_key(atmosphere, luts.sizes, scattering_orders), c_lut_cache_version, data.data(), data.size());
+	}
+}
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "AssetCache.h"
+#include "Atmosphere.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cali
+{
+namespace atmosphere
+{
+	// Bump when the precompute changes its output for the same parameters
+	// (shader or port fixes, sample counts); older entries are then ignored.
+	static const uint32_t c_lut_cache_version = 1;
+
+	// IEEE half floats, the texel format of the GPU textures (RGBA16F).
+	// float_to_half rounds to nearest even.
+	uint16_t float_to_half(float value);
+	float half_to_float(uint16_t value);
+
+	// DXGI_FORMAT_R9G9B9E5_SHAREDEXP: three 9 bit mantissas and one 5 bit
+	// exponent. Negative values and NaN become 0, values above 65408 clamp.
+	// Rounds to nearest; the error of a channel is at most half a step of the
+	// largest one.
+	uint32_t float3_to_rgb9e5(float r, float g, float b);
+	void rgb9e5_to_float3(uint32_t value, float& r, float& g, float& b);
+
+	// The combined scattering texels (rgb: rayleigh + multiple, alpha: single
+	// mie red) in the ATMOSPHERE_COMPACT_SCATTERING layout: rgb as RGB9E5 and
+	// the alpha as a half, in two textures.
+	void compact_scattering(const std::vector<rgba>& scattering, uint32_t* rgb, uint16_t* mie_red);
+	void compact_scattering(const uint16_t* half_texels, size_t texel_count, uint32_t* rgb, uint16_t* mie_red);
+
+	// GPU memory of the LUT textures, in bytes.
+	struct lut_memory
+	{
+		size_t transmittance = 0;
+		size_t irradiance = 0;
+		size_t scattering = 0;     // with the single mie texture when compact
+		size_t intermediates = 0;  // delta textures, only while the GPU precomputes
+
+		size_t resident() const { return transmittance + irradiance + scattering; }
+		size_t peak() const { return resident() + intermediates; }
+	};
+
+	// With compact scattering the GPU precompute also needs an RGBA16F
+	// scattering target, which is read back and converted.
+	lut_memory gpu_lut_memory(const lut_sizes& sizes, bool compact_scattering);
+
+	// Everything the LUTs depend on.
+	uint64_t lut_hash(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, int scattering_orders);
+	std::string lut_cache_key(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, int scattering_orders);
+
+	// The three LUTs of a cache entry as RGBA16F texels, ready to be uploaded as
+	// they are: rows top to bottom, 3D slices one after the other. The texels
+	// point into the mapped file.
+	class mapped_luts
+	{
+		mapped_asset m_file;
+		lut_sizes m_sizes;
+		const uint16_t* m_transmittance = nullptr;
+		const uint16_t* m_scattering = nullptr;
+		const uint16_t* m_irradiance = nullptr;
+
+		friend bool load_luts(const asset_cache& cache, const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+			int scattering_orders, mapped_luts& out);
+
+	public:
+		bool is_open() const { return m_file.is_open(); }
+		const lut_sizes& sizes() const { return m_sizes; }
+		size_t bytes() const { return m_file.size(); }
+
+		const uint16_t* transmittance() const { return m_transmittance; }
+		const uint16_t* scattering() const { return m_scattering; }
+		const uint16_t* irradiance() const { return m_irradiance; }
+
+		void close() { m_file.close(); m_transmittance = m_scattering = m_irradiance = nullptr; }
+	};
+
+	// False on a miss: no entry for these parameters, or one from another
+	// version, of other sizes or corrupt.
+	bool load_luts(const asset_cache& cache, const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		int scattering_orders, mapped_luts& out);
+
+	// The halves of the three LUTs, mapped or read back from the GPU, as float
+	// LUTs for the CPU side (atmosphere_query). Exact: storing them again
+	// writes the same halves.
+	void unpack_luts(const lut_sizes& sizes, const uint16_t* transmittance, const uint16_t* scattering,
+		const uint16_t* irradiance, luts& out);
+	void unpack_luts(const mapped_luts& mapped, luts& out);
+
+	bool store_luts(const asset_cache& cache, const atmosphere_parameters& atmosphere, const luts& luts,
+		int scattering_orders);
+}
+}
@@ -0,0 +1,327 @@
+#include "AtmosphereFit.h"
+#include "AtmosphereFunctions.h"
+
+#include <cmath>
+#include <vector>
+
+namespace cali
+{
+namespace atmosphere
+{
+	namespace
+	{
+		const int c_order = transmittance_fit::degree + 1;
+		const double c_pi = 3.14159265358979323846;
+
+		// (r, mu) of the unit range coordinates of the transmittance texture
+		void r_mu_from_unit_range(double bottom_radius, double top_radius, double x_mu, double x_r, double& r, double& mu,
+			double& d)
+		{
+			const double H = std::sqrt(top_radius * top_radius - bottom_radius * bottom_radius);
+			const double rho = H * x_r;
+			r = std::sqrt(rho * rho + bottom_radius * bottom_radius);
+			const double d_min = top_radius - r;
+			const double d_max = rho + H;
+			d = d_min + x_mu * (d_max - d_min);
+			mu = d == 0.0 ? 1.0 : (H * H - rho * rho - d * d) / (2.0 * r * d);
+			mu = std::fmax(-1.0, std::fmin(1.0, mu));
+		}
+
+		double optical_length(double bottom_radius, double scale_height, double r, double mu, double d)
+		{
+			const int SAMPLE_COUNT = 2000;
+			const double dx = d / SAMPLE_COUNT;
+			double result = 0.0;
+			for (int i = 0; i <= SAMPLE_COUNT; ++i)
+			{
+				const double d_i = i * dx;
+				const double r_i = std::sqrt(d_i * d_i + 2.0 * r * mu * d_i + r * r);
+				result += std::exp(-(r_i - bottom_radius) / scale_height) * (i == 0 || i == SAMPLE_COUNT ? 0.5 : 1.0) * dx;
+			}
+			return result;
+		}
+
+		void chebyshev(double x, double out[c_order])
+		{
+			out[0] = 1.0;
+			out[1] = x;
+			for (int k = 2; k < c_order; ++k) out[k] = 2.0 * x * out[k - 1] - out[k - 2];
+		}
+
+		// Least squares by modified Gram-Schmidt; `columns` is overwritten.
+		std::vector<double> least_squares(std::vector<std::vector<double>>& columns, const std::vector<double>& y)
+		{
+			const size_t n = columns.size(), m = y.size();
+			std::vector<double> R(n * n, 0.0), c(n, 0.0);
+			for (size_t j = 0; j < n; ++j)
+			{
+				std::vector<double>& q = columns[j];
+				for (size_t k = 0; k < j; ++k)
+				{
+					double dot = 0.0;
+					for (size_t i = 0; i < m; ++i) dot += columns[k][i] * q[i];
+					R[k * n + j] = dot;
+					for (size_t i = 0; i < m; ++i) q[i] -= dot * columns[k][i];
+				}
+				double norm = 0.0;
+				for (size_t i = 0; i < m; ++i) norm += q[i] * q[i];
+				norm = std::sqrt(norm);
+				R[j * n + j] = norm;
+				for (size_t i = 0; i < m; ++i) q[i] /= norm;
+			}
+			for (size_t j = 0; j < n; ++j)
+				for (size_t i = 0; i < m; ++i) c[j] += columns[j][i] * y[i];
+			for (size_t j = n; j-- > 0;)
+			{
+				for (size_t k = j + 1; k < n; ++k) c[j] -= R[j * n + k] * c[k];
+				c[j] /= R[j * n + j];
+			}
+			return c;
+		}
+
+		// Chebyshev coefficients c[j * c_order + i] of T_i(s) T_j(t) to the power basis
+		void to_power_basis(const std::vector<double>& c, float out[transmittance_fit::coefficient_count])
+		{
+			// power[k][m]: coefficient of x^m in T_k(x)
+			double power[c_order][c_order] = {};
+			power[0][0] = 1.0;
+			power[1][1] = 1.0;
+			for (int k = 2; k < c_order; ++k)
+				for (int m = 0; m < c_order; ++m)
+					power[k][m] = (m > 0 ? 2.0 * power[k - 1][m - 1] : 0.0) - power[k - 2][m];
+
+			for (int j2 = 0; j2 < c_order; ++j2)
+				for (int i2 = 0; i2 < c_order; ++i2)
+				{
+					double sum = 0.0;
+					for (int j = j2; j < c_order; ++j)
+						for (int i = i2; i < c_order; ++i) sum += c[j * c_order + i] * power[j][j2] * power[i][i2];
+					out[j2 * c_order + i2] = (float)sum;
+				}
+		}
+
+		float polynomial(const float* c, float s, float t)
+		{
+			float result = 0.0f;
+			for (int j = c_order - 1; j >= 0; --j)
+			{
+				const float* row = c + j * c_order;
+				float p = row[c_order - 1];
+				for (int i = c_order - 2; i >= 0; --i) p = p * s + row[i];
+				result = result * t + p;
+			}
+			return result;
+		}
+
+		// s, t, distance to the top and altitude, as in the shader
+		struct fit_coordinates
+		{
+			float s, t, d, h;
+		};
+
+		fit_coordinates coordinates(const atmosphere_parameters& atmosphere, float r, float mu)
+		{
+			r = std::clamp(r, atmosphere.bottom_radius, atmosphere.top_radius);
+			const float H = sqrtf(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+			const float rho = common::safe_sqrt(r * r - atmosphere.bottom_radius * atmosphere.bottom_radius);
+			const float d_min = atmosphere.top_radius - r;
+			const float d_max = rho + H;
+			const float d = std::clamp(common::distance_to_top_atmosphere_boundary(atmosphere, r, mu), d_min, d_max);
+			fit_coordinates c;
+			c.s = 2.0f * (d_max > d_min ? (d - d_min) / (d_max - d_min) : 0.0f) - 1.0f;
+			c.t = 2.0f * rho / H - 1.0f;
+			c.d = d;
+			c.h = r - atmosphere.bottom_radius;
+			return c;
+		}
+
+#if defined(IV_SIMD_SSE)
+		// Cephes expf, about 2 ulp
+		__m128 exp_ps(__m128 x)
+		{
+			x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.3f));
+			__m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(0.5f));
+			__m128 floor_fx = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+			floor_fx = _mm_sub_ps(floor_fx, _mm_and_ps(_mm_cmpgt_ps(floor_fx, fx), _mm_set1_ps(1.0f)));
+			x = _mm_sub_ps(x, _mm_mul_ps(floor_fx, _mm_set1_ps(0.693359375f)));
+			x = _mm_sub_ps(x, _mm_mul_ps(floor_fx, _mm_set1_ps(-2.12194440e-4f)));
+
+			__m128 y = _mm_set1_ps(1.9875691500e-4f);
+			y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.3981999507e-3f));
+			y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(8.3334519073e-3f));
+			y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(4.1665795894e-2f));
+			y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(1.6666665459e-1f));
+			y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(5.0000001201e-1f));
+			y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(x, x)), x), _mm_set1_ps(1.0f));
+
+			const __m128i n = _mm_add_epi32(_mm_cvttps_epi32(floor_fx), _mm_set1_epi32(0x7f));
+			return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(n, 23)));
+		}
+
+		__m128 polynomial_ps(const float* c, __m128 s, __m128 t)
+		{
+			__m128 result = _mm_setzero_ps();
+			for (int j = c_order - 1; j >= 0; --j)
+			{
+				const float* row = c + j * c_order;
+				__m128 p = _mm_set1_ps(row[c_order - 1]);
+				for (int i = c_order - 2; i >= 0; --i) p = _mm_add_ps(_mm_mul_ps(p, s), _mm_set1_ps(row[i]));
+				result = _mm_add_ps(_mm_mul_ps(result, t), p);
+			}
+			return result;
+		}
+#endif
+	}
+
+	bool transmittance_fit::fits(const atmosphere_parameters& atmosphere) const
+	{
+		return bottom_radius == atmosphere.bottom_radius && top_radius == atmosphere.top_radius &&
+			rayleigh_scale_height == atmosphere.rayleigh_scale_height && mie_scale_height == atmosphere.mie_scale_height;
+	}
+
+	transmittance_fit fit_transmittance(const atmosphere_parameters& atmosphere)
+	{
+		const int NODE_COUNT = 48;
+		const double bottom = atmosphere.bottom_radius, top = atmosphere.top_radius;
+		const double scale_heights[2] = { atmosphere.rayleigh_scale_height, atmosphere.mie_scale_height };
+
+		std::vector<std::vector<double>> columns[2];
+		std::vector<double> y[2];
+		for (int layer = 0; layer < 2; ++layer)
+		{
+			columns[layer].assign(c_order * c_order, std::vector<double>());
+			for (std::vector<double>& column : columns[layer]) column.reserve(NODE_COUNT * NODE_COUNT);
+			y[layer].reserve(NODE_COUNT * NODE_COUNT);
+		}
+
+		for (int j = 0; j < NODE_COUNT; ++j)
+			for (int i = 0; i < NODE_COUNT; ++i)
+			{
+				const double s = -std::cos(c_pi * (i + 0.5) / NODE_COUNT), t = -std::cos(c_pi * (j + 0.5) / NODE_COUNT);
+				double r, mu, d;
+				r_mu_from_unit_range(bottom, top, 0.5 * (s + 1.0), 0.5 * (t + 1.0), r, mu, d);
+				double cs[c_order], ct[c_order];
+				chebyshev(s, cs);
+				chebyshev(t, ct);
+				for (int layer = 0; layer < 2; ++layer)
+				{
+					// log of the mean density along the ray relative to the start
+					const double length = optical_length(bottom, scale_heights[layer], r, mu, d);
+					y[layer].push_back(d > 0.0 ? std::log(length / d) + (r - bottom) / scale_heights[layer] : 0.0);
+					for (int b = 0; b < c_order; ++b)
+						for (int a = 0; a < c_order; ++a) columns[layer][b * c_order + a].push_back(cs[a] * ct[b]);
+				}
+			}
+
+		transmittance_fit fit;
+		fit.bottom_radius = atmosphere.bottom_radius;
+		fit.top_radius = atmosphere.top_radius;
+		fit.rayleigh_scale_height = atmosphere.rayleigh_scale_height;
+		fit.mie_scale_height = atmosphere.mie_scale_height;
+		to_power_basis(least_squares(columns[0], y[0]), fit.rayleigh);
+		to_power_basis(least_squares(columns[1], y[1]), fit.mie);
+
+		const transmittance_error error = measure_transmittance_error(atmosphere,
+			[&](float r, float mu) { return fitted_transmittance_to_top(fit, atmosphere, r, mu); });
+		fit.max_error = error.max_abs;
+		fit.mean_error = error.mean_abs;
+		return fit;
+	}
+
+	transmittance_error measure_transmittance_error(const atmosphere_parameters& atmosphere,
+		const std::function<rgba(float r, float mu)>& transmittance)
+	{
+		const int STEPS = 100;
+		transmittance_error error;
+		double sum = 0.0;
+		for (int j = 0; j <= STEPS; ++j)
+			for (int i = 0; i <= STEPS; ++i)
+			{
+				double r, mu, d;
+				r_mu_from_unit_range(atmosphere.bottom_radius, atmosphere.top_radius, (double)i / STEPS, (double)j / STEPS, r, mu, d);
+				const rgba expected = common::compute_transmittance_to_top_atmosphere_boundary(atmosphere, (float)r, (float)mu);
+				const rgba actual = transmittance((float)r, (float)mu);
+				const float e[3] = { expected.r, expected.g, expected.b }, a[3] = { actual.r, actual.g, actual.b };
+				float sample_error = 0.0f;
+				for (int c = 0; c < 3; ++c)
+				{
+					const float abs_error = fabsf(a[c] - e[c]);
+					sample_error = (std::max)(sample_error, abs_error);
+					if (e[c] > 0.01f) error.max_relative = (std::max)(error.max_relative, abs_error / e[c]);
+				}
+				error.max_abs = (std::max)(error.max_abs, sample_error);
+				sum += sample_error;
+			}
+		error.mean_abs = (float)(sum / ((STEPS + 1) * (STEPS + 1)));
+		return error;
+	}
+
+	rgba fitted_transmittance_to_top(const transmittance_fit& fit, const atmosphere_parameters& atmosphere, float r, float mu)
+	{
+		const fit_coordinates c = coordinates(atmosphere, r, mu);
+		const float rayleigh = c.d * expf(polynomial(fit.rayleigh, c.s, c.t) - c.h / atmosphere.rayleigh_scale_height);
+		const float mie = c.d * expf(polynomial(fit.mie, c.s, c.t) - c.h / atmosphere.mie_scale_height);
+		const rgba optical_depth = atmosphere.rayleigh_scattering * rayleigh + atmosphere.mie_extinction * mie;
+		return exp(rgba(0.0f) - optical_depth.rgb());
+	}
+
+	void fitted_transmittance_to_top(const transmittance_fit& fit, const atmosphere_parameters& atmosphere,
+		const float* r, const float* mu, size_t count, rgba* transmittance)
+	{
+		size_t i = 0;
+#if defined(IV_SIMD_SSE)
+		const __m128 bottom_radius = _mm_set1_ps(atmosphere.bottom_radius);
+		const __m128 top_radius = _mm_set1_ps(atmosphere.top_radius);
+		const __m128 bottom_radius_sq = _mm_set1_ps(atmosphere.bottom_radius * atmosphere.bottom_radius);
+		const __m128 top_radius_sq = _mm_set1_ps(atmosphere.top_radius * atmosphere.top_radius);
+		const float H = sqrtf(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		const __m128 one = _mm_set1_ps(1.0f), two = _mm_set1_ps(2.0f), zero = _mm_setzero_ps();
+		const __m128 inverse_rayleigh_scale_height = _mm_set1_ps(1.0f / atmosphere.rayleigh_scale_height);
+		const __m128 inverse_mie_scale_height = _mm_set1_ps(1.0f / atmosphere.mie_scale_height);
+		const float* rayleigh_scattering = &atmosphere.rayleigh_scattering.r;
+		const float* mie_extinction = &atmosphere.mie_extinction.r;
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 r4 = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(r + i), bottom_radius), top_radius);
+			const __m128 mu4 = _mm_loadu_ps(mu + i);
+			const __m128 r_sq = _mm_mul_ps(r4, r4);
+			const __m128 rho = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(r_sq, bottom_radius_sq), zero));
+			const __m128 d_min = _mm_sub_ps(top_radius, r4);
+			const __m128 d_max = _mm_add_ps(rho, _mm_set1_ps(H));
+			const __m128 discriminant = _mm_add_ps(_mm_mul_ps(r_sq, _mm_sub_ps(_mm_mul_ps(mu4, mu4), one)), top_radius_sq);
+			__m128 d = _mm_sub_ps(_mm_sqrt_ps(_mm_max_ps(discriminant, zero)), _mm_mul_ps(r4, mu4));
+			d = _mm_min_ps(_mm_max_ps(d, d_min), d_max);
+			const __m128 range = _mm_sub_ps(d_max, d_min);
+			const __m128 x_mu = _mm_and_ps(_mm_div_ps(_mm_sub_ps(d, d_min), range), _mm_cmpgt_ps(range, zero));
+			const __m128 s = _mm_sub_ps(_mm_mul_ps(two, x_mu), one);
+			const __m128 t = _mm_sub_ps(_mm_mul_ps(two, _mm_div_ps(rho, _mm_set1_ps(H))), one);
+			const __m128 h = _mm_sub_ps(r4, bottom_radius);
+
+			const __m128 rayleigh = _mm_mul_ps(d, exp_ps(_mm_sub_ps(polynomial_ps(fit.rayleigh, s, t),
+				_mm_mul_ps(h, inverse_rayleigh_scale_height))));
+			const __m128 mie = _mm_mul_ps(d, exp_ps(_mm_sub_ps(polynomial_ps(fit.mie, s, t),
+				_mm_mul_ps(h, inverse_mie_scale_height))));
+
+			__m128 channels[4];
+			for (int c = 0; c < 3; ++c)
+				channels[c] = exp_ps(_mm_sub_ps(zero, _mm_add_ps(_mm_mul_ps(rayleigh, _mm_set1_ps(rayleigh_scattering[c])),
+					_mm_mul_ps(mie, _mm_set1_ps(mie_extinction[c])))));
+			channels[3] = one;
+			_MM_TRANSPOSE4_PS(channels[0], channels[1], channels[2], channels[3]);
+			for (int k = 0; k < 4; ++k) _mm_store_ps(&transmittance[i + k].r, channels[k]);
+		}
+#endif
+		for (; i < count; ++i) transmittance[i] = fitted_transmittance_to_top(fit, atmosphere, r[i], mu[i]);
+	}
+
+	rgba fitted_transmittance_to_sun(const transmittance_fit& fit, const atmosphere_parameters& atmosphere, float r, float mu_s)
+	{
+		float sin_theta_h = atmosphere.bottom_radius / r;
+		float cos_theta_h = -sqrtf((std::max)(1.0f - sin_theta_h * sin_theta_h, 0.0f));
+		return fitted_transmittance_to_top(fit, atmosphere, r, mu_s).rgb() *
+			common::smoothstep(-sin_theta_h * atmosphere.sun_angular_radius, sin_theta_h * atmosphere.sun_angular_radius,
+				mu_s - cos_theta_h);
+	}
+}
+}
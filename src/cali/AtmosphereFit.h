@@ -0,0 +1,72 @@
+#pragma once
+#include "Atmosphere.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace cali
+{
+namespace atmosphere
+{
+	// Transmittance to the top of the atmosphere without the LUT: the optical
+	// length of the rayleigh and of the mie layer as
+	//   d * exp(P(s, t) - h / scale_height)
+	// with d the distance to the top, h the altitude and P a polynomial of
+	// degree 6 in s = 2 x_mu - 1 and t = 2 x_r - 1, the unit range coordinates
+	// of the transmittance texture. P is the log of the mean density along the
+	// ray relative to the start, which is smooth where the optical length is
+	// not. The fit depends on the radii and scale heights only; the extinction
+	// coefficients are those of the atmosphere it is evaluated with.
+	//
+	// cali_fit_transmittance computes it offline and writes AtmosphereFitEarth.h
+	// and shaders/bruneton_transmittance_fit.fx.
+	struct transmittance_fit
+	{
+		static const int degree = 6;
+		static const int coefficient_count = (degree + 1) * (degree + 1);
+
+		float bottom_radius;
+		float top_radius;
+		float rayleigh_scale_height;
+		float mie_scale_height;
+		// power basis, coefficient of s^i t^j at j * (degree + 1) + i
+		float rayleigh[coefficient_count];
+		float mie[coefficient_count];
+		// measured by fit_transmittance, in transmittance (0 to 1) over the
+		// domain of the LUT
+		float max_error;
+		float mean_error;
+
+		// Whether the fit was made for the geometry of `atmosphere`.
+		bool fits(const atmosphere_parameters& atmosphere) const;
+	};
+
+	// Least squares fit at Chebyshev nodes of both coordinates, against
+	// optical lengths integrated in double precision; fills the error bounds.
+	transmittance_fit fit_transmittance(const atmosphere_parameters& atmosphere);
+
+	// Errors of a transmittance function against
+	// compute_transmittance_to_top_atmosphere_boundary (what the LUT stores)
+	// on a 101 x 101 grid over the domain of the LUT, largest of the three
+	// channels per sample.
+	struct transmittance_error
+	{
+		float max_abs = 0.0f;
+		float mean_abs = 0.0f;
+		float max_relative = 0.0f; // where the transmittance is above 1%
+	};
+	transmittance_error measure_transmittance_error(const atmosphere_parameters& atmosphere,
+		const std::function<rgba(float r, float mu)>& transmittance);
+
+	// GetTransmittanceToTopAtmosphereBoundary; the rays below the horizon get
+	// the horizon value, like the clamped LUT coordinate.
+	rgba fitted_transmittance_to_top(const transmittance_fit& fit, const atmosphere_parameters& atmosphere,
+		float r, float mu);
+	// The same for `count` (r, mu) pairs, four at a time with SSE.
+	void fitted_transmittance_to_top(const transmittance_fit& fit, const atmosphere_parameters& atmosphere,
+		const float* r, const float* mu, size_t count, rgba* transmittance);
+	// GetTransmittanceToSun: times the fraction of the sun disc above the horizon.
+	rgba fitted_transmittance_to_sun(const transmittance_fit& fit, const atmosphere_parameters& atmosphere,
+		float r, float mu_s);
+}
+}
@@ -0,0 +1,38 @@
+#pragma once
+// Generated by cali_fit_transmittance from earth_atmosphere(), do not edit.
+// Transmittance error: max 4.74e-03, mean 3.86e-04.
+#include "AtmosphereFit.h"
+
+namespace cali
+{
+namespace atmosphere
+{
+	inline const transmittance_fit& earth_transmittance_fit()
+	{
+		static const transmittance_fit fit =
+		{
+			6360.0f, 6600.0f, 8.0f, 1.20000005f,
+			{
+				-1.9825362f, 2.88822913f, 3.34288836f, 2.29874253f, 0.317038894f, -0.602208376f, -0.206969276f,
+				2.41440582f, 5.95814323f, 8.22207451f, 1.98779929f, -4.30039644f, -0.958848953f, 1.46826899f,
+				2.59843969f, 7.14416265f, 6.05798769f, -6.71477222f, -8.37330723f, 2.95369673f, 3.9090445f,
+				2.44165039f, 3.04880977f, -7.87243795f, -6.2565918f, 8.32682037f, 3.46915698f, -3.21280861f,
+				1.3763119f, -2.67860842f, -11.1176796f, 6.09218407f, 17.480587f, -3.19519377f, -8.38583565f,
+				-0.182968497f, -2.41130114f, 3.49284172f, 4.26912785f, -4.17946959f, -2.44361973f, 1.7205838f,
+				-0.392344207f, -0.135204911f, 5.98077631f, -1.59187019f, -9.58224773f, 0.981021285f, 4.70721865f
+			},
+			{
+				-3.54536462f, 7.96653271f, 24.7102509f, 29.9028835f, 3.1205399f, -11.3769646f, -2.74226737f,
+				5.30514288f, 42.8367577f, 102.921532f, 16.799284f, -102.309158f, -10.067564f, 45.3878174f,
+				15.815547f, 82.3345947f, 72.9513474f, -138.026718f, -136.246414f, 80.8300247f, 73.9981689f,
+				25.9952278f, 32.0443878f, -165.326935f, -81.6722488f, 273.128693f, 51.149704f, -137.371964f,
+				14.2974062f, -46.5629616f, -171.031418f, 158.284393f, 343.863068f, -111.218597f, -191.737122f,
+				-5.20464897f, -26.3896999f, 87.6012344f, 66.3491287f, -171.400284f, -42.2630768f, 92.4355621f,
+				-5.41474819f, 5.59470987f, 99.3144913f, -49.440155f, -211.540207f, 41.7717896f, 121.372276f
+			},
+			0.00474232435f, 0.000386099273f
+		};
+		return fit;
+	}
+}
+}
@@ -0,0 +1,605 @@
+#pragma once
+// C++ port of shaders/bruneton_common.fx and of the per-texel functions of the
+// bruneton_*.hlslf precompute passes, internal to Atmosphere.cpp and its tests.
+// Names and float math follow the HLSL one to one so the two can be compared
+// side by side; a change to a shader function must be mirrored here.
+#include "Atmosphere.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace cali
+{
+namespace atmosphere
+{
+namespace common
+{
+	const float c_pi = 3.14159265358979323846f;
+
+	inline float get_unit_range_from_texture_coord(float u, int texture_size)
+	{
+		return (u - 0.5f / (float)texture_size) / (1.0f - 1.0f / (float)texture_size);
+	}
+
+	inline float get_texture_coord_from_unit_range(float x, int texture_size)
+	{
+		return 0.5f / (float)texture_size + x * (1.0f - 1.0f / (float)texture_size);
+	}
+
+	inline float clamp_cosine(float mu) { return std::clamp(mu, -1.0f, 1.0f); }
+	inline float clamp_distance(float d) { return std::max(d, 0.0f); }
+	inline float clamp_radius(const atmosphere_parameters& atmosphere, float r) { return std::clamp(r, atmosphere.bottom_radius, atmosphere.top_radius); }
+	inline float safe_sqrt(float a) { return sqrtf(std::max(a, 0.0f)); }
+
+	inline bool ray_intersects_ground(const atmosphere_parameters& atmosphere, float r, float mu)
+	{
+		return mu < 0.0f && r * r * (mu * mu - 1.0f) + atmosphere.bottom_radius * atmosphere.bottom_radius >= 0.0f;
+	}
+
+	inline float rayleigh_phase_function(float nu)
+	{
+		const float k = 3.0f / (16.0f * c_pi);
+		return k * (1.0f + nu * nu);
+	}
+
+	inline float mie_phase_function(float g, float nu)
+	{
+		const float k = 3.0f / (8.0f * c_pi) * (1.0f - g * g) / (2.0f + g * g);
+		const float x = fabsf(1.0f + g * g - 2.0f * g * nu);
+		return k * (1.0f + nu * nu) / (x * sqrtf(x)); // pow(x, 1.5)
+	}
+
+	inline float distance_to_top_atmosphere_boundary(const atmosphere_parameters& atmosphere, float r, float mu)
+	{
+		float discriminant = r * r * (mu * mu - 1.0f) + atmosphere.top_radius * atmosphere.top_radius;
+		return clamp_distance(-r * mu + safe_sqrt(discriminant));
+	}
+
+	inline float distance_to_bottom_atmosphere_boundary(const atmosphere_parameters& atmosphere, float r, float mu)
+	{
+		float discriminant = r * r * (mu * mu - 1.0f) + atmosphere.bottom_radius * atmosphere.bottom_radius;
+		return clamp_distance(-r * mu - safe_sqrt(discriminant));
+	}
+
+	inline float distance_to_nearest_atmosphere_boundary(const atmosphere_parameters& atmosphere, float r, float mu,
+		bool ray_r_mu_intersects_ground)
+	{
+		return ray_r_mu_intersects_ground ? distance_to_bottom_atmosphere_boundary(atmosphere, r, mu) :
+			distance_to_top_atmosphere_boundary(atmosphere, r, mu);
+	}
+
+	// ---------------------------------------------------------------------
+	// Transmittance
+	// ---------------------------------------------------------------------
+
+	inline void get_transmittance_texture_uv_from_r_mu(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		float r, float mu, float& u, float& v)
+	{
+		float H = sqrtf(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float rho = safe_sqrt(r * r - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float d = distance_to_top_atmosphere_boundary(atmosphere, r, mu);
+		float d_min = atmosphere.top_radius - r;
+		float d_max = rho + H;
+		float x_mu = (d - d_min) / (d_max - d_min);
+		float x_r = rho / H;
+		u = get_texture_coord_from_unit_range(x_mu, sizes.transmittance_width);
+		v = get_texture_coord_from_unit_range(x_r, sizes.transmittance_height);
+	}
+
+	// bruneton_transmittance.hlslf
+	inline void get_r_mu_from_transmittance_texture_uv(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		float u, float v, float& r, float& mu)
+	{
+		float x_mu = get_unit_range_from_texture_coord(u, sizes.transmittance_width);
+		float x_r = get_unit_range_from_texture_coord(v, sizes.transmittance_height);
+		float H = sqrtf(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float rho = H * x_r;
+		r = sqrtf(rho * rho + atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float d_min = atmosphere.top_radius - r;
+		float d_max = rho + H;
+		float d = d_min + x_mu * (d_max - d_min);
+		mu = d == 0.0f ? 1.0f : (H * H - rho * rho - d * d) / (2.0f * r * d);
+		mu = clamp_cosine(mu);
+	}
+
+	inline rgba get_transmittance_to_top_atmosphere_boundary(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, float r, float mu)
+	{
+		float u, v;
+		get_transmittance_texture_uv_from_r_mu(atmosphere, sizes, r, mu, u, v);
+		return transmittance_texture.sample(u, v);
+	}
+
+	inline rgba get_transmittance(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, float r, float mu, float d, bool ray_r_mu_intersects_ground)
+	{
+		float r_d = clamp_radius(atmosphere, sqrtf(d * d + 2.0f * r * mu * d + r * r));
+		float mu_d = clamp_cosine((r * mu + d) / r_d);
+		const rgba one(1.0f);
+		if (ray_r_mu_intersects_ground)
+			return min_per_lane(get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r_d, -mu_d) /
+				get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r, -mu), one);
+		return min_per_lane(get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r, mu) /
+			get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r_d, mu_d), one);
+	}
+
+	inline float compute_optical_length_to_top_atmosphere_boundary(const atmosphere_parameters& atmosphere,
+		float scale_height, float r, float mu)
+	{
+		const int SAMPLE_COUNT = 500;
+		float dx = distance_to_top_atmosphere_boundary(atmosphere, r, mu) / (float)SAMPLE_COUNT;
+		float result = 0.0f;
+		for (int i = 0; i <= SAMPLE_COUNT; ++i)
+		{
+			float d_i = (float)i * dx;
+			float r_i = sqrtf(d_i * d_i + 2.0f * r * mu * d_i + r * r);
+			float y_i = expf(-(r_i - atmosphere.bottom_radius) / scale_height);
+			float weight_i = i == 0 || i == SAMPLE_COUNT ? 0.5f : 1.0f;
+			result += y_i * weight_i * dx;
+		}
+		return result;
+	}
+
+	inline rgba compute_transmittance_to_top_atmosphere_boundary(const atmosphere_parameters& atmosphere, float r, float mu)
+	{
+		float rayleigh = compute_optical_length_to_top_atmosphere_boundary(atmosphere, atmosphere.rayleigh_scale_height, r, mu);
+		float mie = compute_optical_length_to_top_atmosphere_boundary(atmosphere, atmosphere.mie_scale_height, r, mu);
+		rgba optical_depth = atmosphere.rayleigh_scattering * rayleigh + atmosphere.mie_extinction * mie;
+		return exp(rgba(0.0f) - optical_depth.rgb());
+	}
+
+	// ---------------------------------------------------------------------
+	// Scattering texture parameterization
+	// ---------------------------------------------------------------------
+
+	inline void get_r_mu_mu_s_nu_from_scattering_texture_uvwz(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		float u, float v, float w, float z, float& r, float& mu, float& mu_s, float& nu, bool& ray_r_mu_intersects_ground)
+	{
+		float H = sqrtf(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float rho = H * get_unit_range_from_texture_coord(z, sizes.scattering_r);
+		r = sqrtf(rho * rho + atmosphere.bottom_radius * atmosphere.bottom_radius);
+		if (w < 0.5f)
+		{
+			float d_min = r - atmosphere.bottom_radius;
+			float d_max = rho;
+			float d = d_min + (d_max - d_min) * get_unit_range_from_texture_coord(1.0f - 2.0f * w, sizes.scattering_mu / 2);
+			mu = d == 0.0f ? -1.0f : clamp_cosine(-(rho * rho + d * d) / (2.0f * r * d));
+			ray_r_mu_intersects_ground = true;
+		}
+		else
+		{
+			float d_min = atmosphere.top_radius - r;
+			float d_max = rho + H;
+			float d = d_min + (d_max - d_min) * get_unit_range_from_texture_coord(2.0f * w - 1.0f, sizes.scattering_mu / 2);
+			mu = d == 0.0f ? 1.0f : clamp_cosine((H * H - rho * rho - d * d) / (2.0f * r * d));
+			ray_r_mu_intersects_ground = false;
+		}
+		float x_mu_s = get_unit_range_from_texture_coord(v, sizes.scattering_mu_s);
+		float d_min = atmosphere.top_radius - atmosphere.bottom_radius;
+		float d_max = H;
+		float A = -2.0f * atmosphere.mu_s_min * atmosphere.bottom_radius / (d_max - d_min);
+		float a = (A - x_mu_s * A) / (1.0f + x_mu_s * A);
+		float d = d_min + std::min(a, A) * (d_max - d_min);
+		mu_s = d == 0.0f ? 1.0f : clamp_cosine((H * H - d * d) / (2.0f * atmosphere.bottom_radius * d));
+		nu = clamp_cosine(u * 2.0f - 1.0f);
+	}
+
+	// frag_coord: pixel centre (x + 0.5, y + 0.5, layer + 0.5) of the 3D texture
+	inline void get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		float frag_x, float frag_y, float frag_z, float& r, float& mu, float& mu_s, float& nu, bool& ray_r_mu_intersects_ground)
+	{
+		const float mu_s_size = (float)sizes.scattering_mu_s;
+		float frag_coord_nu = floorf(frag_x / mu_s_size);
+		float frag_coord_mu_s = frag_x - mu_s_size * floorf(frag_x / mu_s_size); // GlMod
+		get_r_mu_mu_s_nu_from_scattering_texture_uvwz(atmosphere, sizes,
+			frag_coord_nu / (float)(sizes.scattering_nu - 1), frag_coord_mu_s / mu_s_size,
+			frag_y / (float)sizes.scattering_mu, frag_z / (float)sizes.scattering_r,
+			r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+		nu = std::clamp(nu, mu * mu_s - sqrtf((1.0f - mu * mu) * (1.0f - mu_s * mu_s)),
+			mu * mu_s + sqrtf((1.0f - mu * mu) * (1.0f - mu_s * mu_s)));
+	}
+
+	// The mu_s part of GetScatteringTextureUvwzFromRMuMuSNu, on its own because
+	// it is the only coordinate that changes along a multiple scattering row.
+	inline float get_scattering_texture_u_mu_s(const atmosphere_parameters& atmosphere, const lut_sizes& sizes, float mu_s)
+	{
+		float H = sqrtf(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float d = distance_to_top_atmosphere_boundary(atmosphere, atmosphere.bottom_radius, mu_s);
+		float d_min = atmosphere.top_radius - atmosphere.bottom_radius;
+		float d_max = H;
+		float a = (d - d_min) / (d_max - d_min);
+		float A = -2.0f * atmosphere.mu_s_min * atmosphere.bottom_radius / (d_max - d_min);
+		return get_texture_coord_from_unit_range(std::max(1.0f - a / A, 0.0f) / (1.0f + a), sizes.scattering_mu_s);
+	}
+
+	// uvwz = (u_nu, u_mu_s, u_mu, u_r)
+	inline void get_scattering_texture_uvwz_from_r_mu_mu_s_nu(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		float r, float mu, float mu_s, float nu, bool ray_r_mu_intersects_ground, float uvwz[4])
+	{
+		float H = sqrtf(atmosphere.top_radius * atmosphere.top_radius - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float rho = safe_sqrt(r * r - atmosphere.bottom_radius * atmosphere.bottom_radius);
+		float u_r = get_texture_coord_from_unit_range(rho / H, sizes.scattering_r);
+		float r_mu = r * mu;
+		float discriminant = r_mu * r_mu - r * r + atmosphere.bottom_radius * atmosphere.bottom_radius;
+		float u_mu;
+		if (ray_r_mu_intersects_ground)
+		{
+			float d = -r_mu - safe_sqrt(discriminant);
+			float d_min = r - atmosphere.bottom_radius;
+			float d_max = rho;
+			u_mu = 0.5f - 0.5f * get_texture_coord_from_unit_range(d_max == d_min ? 0.0f :
+				(d - d_min) / (d_max - d_min), sizes.scattering_mu / 2);
+		}
+		else
+		{
+			float d = -r_mu + safe_sqrt(discriminant + H * H);
+			float d_min = atmosphere.top_radius - r;
+			float d_max = rho + H;
+			u_mu = 0.5f + 0.5f * get_texture_coord_from_unit_range((d - d_min) / (d_max - d_min), sizes.scattering_mu / 2);
+		}
+		float u_mu_s = get_scattering_texture_u_mu_s(atmosphere, sizes, mu_s);
+		float u_nu = (nu + 1.0f) / 2.0f;
+		uvwz[0] = u_nu; uvwz[1] = u_mu_s; uvwz[2] = u_mu; uvwz[3] = u_r;
+	}
+
+	inline rgba get_scattering(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_3d& scattering_texture, float r, float mu, float mu_s, float nu, bool ray_r_mu_intersects_ground)
+	{
+		float uvwz[4];
+		get_scattering_texture_uvwz_from_r_mu_mu_s_nu(atmosphere, sizes, r, mu, mu_s, nu, ray_r_mu_intersects_ground, uvwz);
+		float tex_coord_x = uvwz[0] * (float)(sizes.scattering_nu - 1);
+		float tex_x = floorf(tex_coord_x);
+		float lerp_x = tex_coord_x - tex_x;
+		rgba s0 = scattering_texture.sample((tex_x + uvwz[1]) / (float)sizes.scattering_nu, uvwz[2], uvwz[3]);
+		rgba s1 = scattering_texture.sample((tex_x + 1.0f + uvwz[1]) / (float)sizes.scattering_nu, uvwz[2], uvwz[3]);
+		return (s0 * (1.0f - lerp_x) + s1 * lerp_x).rgb();
+	}
+
+	inline rgba get_scattering(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_3d& single_rayleigh_scattering_texture, const texture_3d& single_mie_scattering_texture,
+		const texture_3d& multiple_scattering_texture, float r, float mu, float mu_s, float nu,
+		bool ray_r_mu_intersects_ground, int scattering_order)
+	{
+		if (scattering_order == 1)
+		{
+			rgba rayleigh = get_scattering(atmosphere, sizes, single_rayleigh_scattering_texture, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+			rgba mie = get_scattering(atmosphere, sizes, single_mie_scattering_texture, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+			return rayleigh * rayleigh_phase_function(nu) + mie * mie_phase_function(atmosphere.mie_phase_function_g, nu);
+		}
+		return get_scattering(atmosphere, sizes, multiple_scattering_texture, r, mu, mu_s, nu, ray_r_mu_intersects_ground);
+	}
+
+	// ---------------------------------------------------------------------
+	// Irradiance
+	// ---------------------------------------------------------------------
+
+	inline void get_irradiance_texture_uv_from_r_mu_s(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		float r, float mu_s, float& u, float& v)
+	{
+		float x_r = (r - atmosphere.bottom_radius) / (atmosphere.top_radius - atmosphere.bottom_radius);
+		float x_mu_s = mu_s * 0.5f + 0.5f;
+		u = get_texture_coord_from_unit_range(x_mu_s, sizes.irradiance_width);
+		v = get_texture_coord_from_unit_range(x_r, sizes.irradiance_height);
+	}
+
+	// bruneton_irradiance.hlslf / bruneton_indirect_irradiance.hlslf
+	inline void get_r_mu_s_from_irradiance_texture_uv(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		float u, float v, float& r, float& mu_s)
+	{
+		float x_mu_s = get_unit_range_from_texture_coord(u, sizes.irradiance_width);
+		float x_r = get_unit_range_from_texture_coord(v, sizes.irradiance_height);
+		r = atmosphere.bottom_radius + x_r * (atmosphere.top_radius - atmosphere.bottom_radius);
+		mu_s = clamp_cosine(2.0f * x_mu_s - 1.0f);
+	}
+
+	inline rgba get_irradiance(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& irradiance_texture, float r, float mu_s)
+	{
+		float u, v;
+		get_irradiance_texture_uv_from_r_mu_s(atmosphere, sizes, r, mu_s, u, v);
+		return irradiance_texture.sample(u, v).rgb();
+	}
+
+	inline rgba compute_direct_irradiance(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, float r, float mu_s)
+	{
+		return (atmosphere.solar_irradiance *
+			get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r, mu_s) *
+			std::max(mu_s, 0.0f)).rgb();
+	}
+
+	// ---------------------------------------------------------------------
+	// Reference versions of the scattering passes, one texel at a time exactly
+	// as the shaders do it. Atmosphere.cpp computes the same sums with the
+	// per-row and per-layer invariants hoisted; the tests compare the two.
+	// ---------------------------------------------------------------------
+
+	inline void compute_single_scattering_integrand(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, float r, float mu, float mu_s, float nu, float d,
+		bool ray_r_mu_intersects_ground, rgba& rayleigh, rgba& mie)
+	{
+		float r_d = clamp_radius(atmosphere, sqrtf(d * d + 2.0f * r * mu * d + r * r));
+		float mu_s_d = clamp_cosine((r * mu_s + d * nu) / r_d);
+		if (ray_intersects_ground(atmosphere, r_d, mu_s_d))
+		{
+			rayleigh = rgba();
+			mie = rgba();
+			return;
+		}
+		rgba transmittance =
+			get_transmittance(atmosphere, sizes, transmittance_texture, r, mu, d, ray_r_mu_intersects_ground) *
+			get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r_d, mu_s_d);
+		rayleigh = transmittance * expf(-(r_d - atmosphere.bottom_radius) / atmosphere.rayleigh_scale_height);
+		mie = transmittance * expf(-(r_d - atmosphere.bottom_radius) / atmosphere.mie_scale_height);
+	}
+
+	inline void compute_single_scattering(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, float r, float mu, float mu_s, float nu,
+		bool ray_r_mu_intersects_ground, rgba& rayleigh, rgba& mie)
+	{
+		const int SAMPLE_COUNT = 50;
+		float dx = distance_to_nearest_atmosphere_boundary(atmosphere, r, mu, ray_r_mu_intersects_ground) / (float)SAMPLE_COUNT;
+		rgba rayleigh_sum, mie_sum;
+		for (int i = 0; i <= SAMPLE_COUNT; ++i)
+		{
+			float d_i = (float)i * dx;
+			rgba rayleigh_i, mie_i;
+			compute_single_scattering_integrand(atmosphere, sizes, transmittance_texture, r, mu, mu_s, nu, d_i,
+				ray_r_mu_intersects_ground, rayleigh_i, mie_i);
+			float weight_i = (i == 0 || i == SAMPLE_COUNT) ? 0.5f : 1.0f;
+			rayleigh_sum += rayleigh_i * weight_i;
+			mie_sum += mie_i * weight_i;
+		}
+		rayleigh = (rayleigh_sum * dx * atmosphere.solar_irradiance * atmosphere.rayleigh_scattering).rgb();
+		mie = (mie_sum * dx * atmosphere.solar_irradiance * atmosphere.mie_scattering).rgb();
+	}
+
+	inline rgba compute_scattering_density(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, const texture_3d& single_rayleigh_scattering_texture,
+		const texture_3d& single_mie_scattering_texture, const texture_3d& multiple_scattering_texture,
+		const texture_2d& irradiance_texture, float r, float mu, float mu_s, float nu, int scattering_order)
+	{
+		float omega[3] = { sqrtf(1.0f - mu * mu), 0.0f, mu };
+		float sun_dir_x = omega[0] == 0.0f ? 0.0f : (nu - mu * mu_s) / omega[0];
+		float sun_dir_y = sqrtf(std::max(1.0f - sun_dir_x * sun_dir_x - mu_s * mu_s, 0.0f));
+		float omega_s[3] = { sun_dir_x, sun_dir_y, mu_s };
+		const int SAMPLE_COUNT = 16;
+		const float dphi = c_pi / (float)SAMPLE_COUNT;
+		const float dtheta = c_pi / (float)SAMPLE_COUNT;
+		rgba rayleigh_mie;
+		for (int l = 0; l < SAMPLE_COUNT; ++l)
+		{
+			float theta = ((float)l + 0.5f) * dtheta;
+			float cos_theta = cosf(theta);
+			float sin_theta = sinf(theta);
+			bool ray_r_theta_intersects_ground = ray_intersects_ground(atmosphere, r, cos_theta);
+			float distance_to_ground = 0.0f;
+			rgba transmittance_to_ground, ground_albedo;
+			if (ray_r_theta_intersects_ground)
+			{
+				distance_to_ground = distance_to_bottom_atmosphere_boundary(atmosphere, r, cos_theta);
+				transmittance_to_ground = get_transmittance(atmosphere, sizes, transmittance_texture, r, cos_theta, distance_to_ground, true);
+				ground_albedo = atmosphere.ground_albedo;
+			}
+			for (int m = 0; m < 2 * SAMPLE_COUNT; ++m)
+			{
+				float phi = ((float)m + 0.5f) * dphi;
+				float omega_i[3] = { cosf(phi) * sin_theta, sinf(phi) * sin_theta, cos_theta };
+				float domega_i = dtheta * dphi * sinf(theta);
+				float nu1 = omega_s[0] * omega_i[0] + omega_s[1] * omega_i[1] + omega_s[2] * omega_i[2];
+				rgba incident_radiance = get_scattering(atmosphere, sizes, single_rayleigh_scattering_texture,
+					single_mie_scattering_texture, multiple_scattering_texture, r, omega_i[2], mu_s, nu1,
+					ray_r_theta_intersects_ground, scattering_order - 1);
+				float ground_normal[3] = { omega_i[0] * distance_to_ground, omega_i[1] * distance_to_ground, r + omega_i[2] * distance_to_ground };
+				float length = sqrtf(ground_normal[0] * ground_normal[0] + ground_normal[1] * ground_normal[1] + ground_normal[2] * ground_normal[2]);
+				float ground_mu_s = (ground_normal[0] * omega_s[0] + ground_normal[1] * omega_s[1] + ground_normal[2] * omega_s[2]) / length;
+				rgba ground_irradiance = get_irradiance(atmosphere, sizes, irradiance_texture, atmosphere.bottom_radius, ground_mu_s);
+				incident_radiance += transmittance_to_ground * ground_albedo * (1.0f / c_pi) * ground_irradiance;
+				float nu2 = omega[0] * omega_i[0] + omega[1] * omega_i[1] + omega[2] * omega_i[2];
+				float rayleigh_density = expf(-(r - atmosphere.bottom_radius) / atmosphere.rayleigh_scale_height);
+				float mie_density = expf(-(r - atmosphere.bottom_radius) / atmosphere.mie_scale_height);
+				rayleigh_mie += incident_radiance * (
+					atmosphere.rayleigh_scattering * rayleigh_density * rayleigh_phase_function(nu2) +
+					atmosphere.mie_scattering * mie_density * mie_phase_function(atmosphere.mie_phase_function_g, nu2)) * domega_i;
+			}
+		}
+		return rayleigh_mie.rgb();
+	}
+
+	inline rgba compute_indirect_irradiance(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_3d& single_rayleigh_scattering_texture, const texture_3d& single_mie_scattering_texture,
+		const texture_3d& multiple_scattering_texture, float r, float mu_s, int scattering_order)
+	{
+		const int SAMPLE_COUNT = 32;
+		const float dphi = c_pi / (float)SAMPLE_COUNT;
+		const float dtheta = c_pi / (float)SAMPLE_COUNT;
+		rgba result;
+		float omega_s[3] = { sqrtf(1.0f - mu_s * mu_s), 0.0f, mu_s };
+		for (int j = 0; j < SAMPLE_COUNT / 2; ++j)
+		{
+			float theta = ((float)j + 0.5f) * dtheta;
+			bool ray_r_theta_intersects_ground = ray_intersects_ground(atmosphere, r, cosf(theta));
+			for (int i = 0; i < 2 * SAMPLE_COUNT; ++i)
+			{
+				float phi = ((float)i + 0.5f) * dphi;
+				float omega[3] = { cosf(phi) * sinf(theta), sinf(phi) * sinf(theta), cosf(theta) };
+				float domega = dtheta * dphi * sinf(theta);
+				float nu = omega[0] * omega_s[0] + omega[1] * omega_s[1] + omega[2] * omega_s[2];
+				result += get_scattering(atmosphere, sizes, single_rayleigh_scattering_texture, single_mie_scattering_texture,
+					multiple_scattering_texture, r, omega[2], mu_s, nu, ray_r_theta_intersects_ground, scattering_order) * (omega[2] * domega);
+			}
+		}
+		return result;
+	}
+
+	inline rgba compute_multiple_scattering(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, const texture_3d& scattering_density_texture,
+		float r, float mu, float mu_s, float nu, bool ray_r_mu_intersects_ground)
+	{
+		const int SAMPLE_COUNT = 50;
+		float dx = distance_to_nearest_atmosphere_boundary(atmosphere, r, mu, ray_r_mu_intersects_ground) / (float)SAMPLE_COUNT;
+		rgba rayleigh_mie_sum;
+		for (int i = 0; i <= SAMPLE_COUNT; ++i)
+		{
+			float d_i = (float)i * dx;
+			float r_i = clamp_radius(atmosphere, sqrtf(d_i * d_i + 2.0f * r * mu * d_i + r * r));
+			float mu_i = clamp_cosine((r * mu + d_i) / r_i);
+			float mu_s_i = clamp_cosine((r * mu_s + d_i * nu) / r_i);
+			rgba rayleigh_mie_i =
+				get_scattering(atmosphere, sizes, scattering_density_texture, r_i, mu_i, mu_s_i, nu, ray_r_mu_intersects_ground) *
+				get_transmittance(atmosphere, sizes, transmittance_texture, r, mu, d_i, ray_r_mu_intersects_ground) * dx;
+			float weight_i = (i == 0 || i == SAMPLE_COUNT) ? 0.5f : 1.0f;
+			rayleigh_mie_sum += rayleigh_mie_i * weight_i;
+		}
+		return rayleigh_mie_sum.rgb();
+	}
+
+	// ---------------------------------------------------------------------
+	// Rendering (bruneton_common.fx, with shadow_length = 0 as the sky and
+	// terrain shaders use it), the reference of atmosphere_query
+	// ---------------------------------------------------------------------
+
+	inline float dot3(const float a[3], const float b[3]) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+	inline float smoothstep(float edge0, float edge1, float x)
+	{
+		float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+		return t * t * (3.0f - 2.0f * t);
+	}
+
+	inline rgba get_extrapolated_single_mie_scattering(const atmosphere_parameters& atmosphere, const rgba& scattering)
+	{
+		if (scattering.r == 0.0f) return rgba();
+		return scattering.rgb() * (scattering.a / scattering.r) *
+			(atmosphere.rayleigh_scattering.r / atmosphere.mie_scattering.r) *
+			(atmosphere.mie_scattering / atmosphere.rayleigh_scattering).rgb();
+	}
+
+	inline rgba get_combined_scattering(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_3d& scattering_texture, float r, float mu, float mu_s, float nu, bool ray_r_mu_intersects_ground,
+		rgba& single_mie_scattering)
+	{
+		float uvwz[4];
+		get_scattering_texture_uvwz_from_r_mu_mu_s_nu(atmosphere, sizes, r, mu, mu_s, nu, ray_r_mu_intersects_ground, uvwz);
+		float tex_coord_x = uvwz[0] * (float)(sizes.scattering_nu - 1);
+		float tex_x = floorf(tex_coord_x);
+		float lerp_x = tex_coord_x - tex_x;
+		rgba combined_scattering =
+			scattering_texture.sample((tex_x + uvwz[1]) / (float)sizes.scattering_nu, uvwz[2], uvwz[3]) * (1.0f - lerp_x) +
+			scattering_texture.sample((tex_x + 1.0f + uvwz[1]) / (float)sizes.scattering_nu, uvwz[2], uvwz[3]) * lerp_x;
+		single_mie_scattering = get_extrapolated_single_mie_scattering(atmosphere, combined_scattering);
+		return combined_scattering.rgb();
+	}
+
+	// camera relative to the planet center, view_ray and sun_direction unit
+	inline rgba get_sky_radiance(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, const texture_3d& scattering_texture,
+		const float camera[3], const float view_ray[3], const float sun_direction[3], rgba& transmittance)
+	{
+		float position[3] = { camera[0], camera[1], camera[2] };
+		float r = sqrtf(dot3(position, position));
+		float rmu = dot3(position, view_ray);
+		float distance_to_top_atmosphere_boundary = -rmu - sqrtf(rmu * rmu - r * r + atmosphere.top_radius * atmosphere.top_radius);
+		if (distance_to_top_atmosphere_boundary > 0.0f)
+		{
+			for (int i = 0; i < 3; ++i) position[i] += view_ray[i] * distance_to_top_atmosphere_boundary;
+			r = atmosphere.top_radius;
+			rmu += distance_to_top_atmosphere_boundary;
+		}
+		if (r > atmosphere.top_radius)
+		{
+			transmittance = rgba(1.0f, 1.0f, 1.0f);
+			return rgba();
+		}
+		float mu = rmu / r;
+		float mu_s = dot3(position, sun_direction) / r;
+		float nu = dot3(view_ray, sun_direction);
+		bool ray_r_mu_intersects_ground = ray_intersects_ground(atmosphere, r, mu);
+
+		transmittance = ray_r_mu_intersects_ground ? rgba() :
+			get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r, mu).rgb();
+
+		rgba single_mie_scattering;
+		rgba scattering = get_combined_scattering(atmosphere, sizes, scattering_texture, r, mu, mu_s, nu,
+			ray_r_mu_intersects_ground, single_mie_scattering);
+		return scattering * rayleigh_phase_function(nu) +
+			single_mie_scattering * mie_phase_function(atmosphere.mie_phase_function_g, nu);
+	}
+
+	// camera and point relative to the planet center, sun_direction unit
+	inline rgba get_sky_radiance_to_point(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, const texture_3d& scattering_texture,
+		const float camera[3], const float point[3], const float sun_direction[3], rgba& transmittance)
+	{
+		float view_ray[3] = { point[0] - camera[0], point[1] - camera[1], point[2] - camera[2] };
+		const float length = sqrtf(dot3(view_ray, view_ray));
+		for (float& v : view_ray) v /= length;
+		float position[3] = { camera[0], camera[1], camera[2] };
+		float r = sqrtf(dot3(position, position));
+		float rmu = dot3(position, view_ray);
+		float distance_to_top_atmosphere_boundary = -rmu - sqrtf(rmu * rmu - r * r + atmosphere.top_radius * atmosphere.top_radius);
+		if (distance_to_top_atmosphere_boundary > 0.0f)
+		{
+			for (int i = 0; i < 3; ++i) position[i] += view_ray[i] * distance_to_top_atmosphere_boundary;
+			r = atmosphere.top_radius;
+			rmu += distance_to_top_atmosphere_boundary;
+		}
+		float mu = rmu / r;
+		float mu_s = dot3(position, sun_direction) / r;
+		float nu = dot3(view_ray, sun_direction);
+		const float to_point[3] = { point[0] - position[0], point[1] - position[1], point[2] - position[2] };
+		float d = sqrtf(dot3(to_point, to_point));
+		bool ray_r_mu_intersects_ground = ray_intersects_ground(atmosphere, r, mu);
+		transmittance = get_transmittance(atmosphere, sizes, transmittance_texture, r, mu, d, ray_r_mu_intersects_ground).rgb();
+
+		rgba single_mie_scattering;
+		rgba scattering = get_combined_scattering(atmosphere, sizes, scattering_texture, r, mu, mu_s, nu,
+			ray_r_mu_intersects_ground, single_mie_scattering);
+
+		float r_p = clamp_radius(atmosphere, sqrtf(d * d + 2.0f * r * mu * d + r * r));
+		float mu_p = (r * mu + d) / r_p;
+		float mu_s_p = (r * mu_s + d * nu) / r_p;
+		rgba single_mie_scattering_p;
+		rgba scattering_p = get_combined_scattering(atmosphere, sizes, scattering_texture, r_p, mu_p, mu_s_p, nu,
+			ray_r_mu_intersects_ground, single_mie_scattering_p);
+
+		scattering = scattering - transmittance * scattering_p;
+		single_mie_scattering = single_mie_scattering - transmittance * single_mie_scattering_p;
+		single_mie_scattering = get_extrapolated_single_mie_scattering(atmosphere,
+			rgba(scattering.r, scattering.g, scattering.b, single_mie_scattering.r));
+		single_mie_scattering = single_mie_scattering * smoothstep(0.0f, 0.01f, mu_s);
+		return scattering * rayleigh_phase_function(nu) +
+			single_mie_scattering * mie_phase_function(atmosphere.mie_phase_function_g, nu);
+	}
+
+	inline rgba get_sun_and_sky_irradiance(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, const texture_2d& irradiance_texture,
+		const float point[3], const float normal[3], const float sun_direction[3], rgba& sky_irradiance)
+	{
+		float r = sqrtf(dot3(point, point));
+		float mu_s = dot3(point, sun_direction) / r;
+
+		sky_irradiance = get_irradiance(atmosphere, sizes, irradiance_texture, r, mu_s) *
+			((1.0f + dot3(normal, point) / r) * 0.5f);
+
+		return atmosphere.solar_irradiance.rgb() *
+			get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r, mu_s) *
+			smoothstep(-atmosphere.sun_angular_radius, atmosphere.sun_angular_radius, mu_s) *
+			std::max(dot3(normal, sun_direction), 0.0f);
+	}
+
+	// GetTransmittanceToSun of the reference implementation (not used by the
+	// shaders here): the fraction of the sun disc above the horizon, times
+	// the transmittance to the top of the atmosphere.
+	inline rgba get_transmittance_to_sun(const atmosphere_parameters& atmosphere, const lut_sizes& sizes,
+		const texture_2d& transmittance_texture, float r, float mu_s)
+	{
+		float sin_theta_h = atmosphere.bottom_radius / r;
+		float cos_theta_h = -sqrtf(std::max(1.0f - sin_theta_h * sin_theta_h, 0.0f));
+		return get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, transmittance_texture, r, mu_s).rgb() *
+			smoothstep(-sin_theta_h * atmosphere.sun_angular_radius, sin_theta_h * atmosphere.sun_angular_radius,
+				mu_s - cos_theta_h);
+	}
+}
+}
+}
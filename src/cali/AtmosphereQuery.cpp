@@ -0,0 +1,351 @@
+#include "AtmosphereQuery.h"
+#include "AtmosphereFunctions.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace cali
+{
+namespace atmosphere
+{
+	namespace
+	{
+		inline float dot(const IvVector3& a, const IvVector3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+		const float c_pi = 3.14159265358979323846f;
+
+		float channel_error(const rgba& test, const rgba& reference, float floor)
+		{
+			return (std::max)({ fabsf(test.r - reference.r) / (std::max)(fabsf(reference.r), floor),
+				fabsf(test.g - reference.g) / (std::max)(fabsf(reference.g), floor),
+				fabsf(test.b - reference.b) / (std::max)(fabsf(reference.b), floor) });
+		}
+
+		float largest_channel(const rgba* values, size_t count)
+		{
+			float largest = 0.0f;
+			for (size_t i = 0; i < count; ++i) largest = (std::max)({ largest, values[i].r, values[i].g, values[i].b });
+			return largest;
+		}
+
+		error_stats summarize(std::vector<float>& errors)
+		{
+			error_stats stats;
+			stats.samples = errors.size();
+			if (errors.empty()) return stats;
+			double sum = 0.0;
+			for (float e : errors) sum += e;
+			stats.mean = (float)(sum / errors.size());
+			const size_t p95 = (errors.size() * 95) / 100;
+			std::nth_element(errors.begin(), errors.begin() + p95, errors.end());
+			stats.p95 = errors[p95];
+			stats.max = *std::max_element(errors.begin(), errors.end());
+			return stats;
+		}
+	}
+
+	atmosphere_query::atmosphere_query(const atmosphere_parameters& atmosphere, std::shared_ptr<const luts> luts) :
+		m_atmosphere(atmosphere),
+		m_luts(std::move(luts))
+	{
+		if (!m_luts || m_luts->scattering.texels.empty())
+			throw std::invalid_argument("atmosphere: atmosphere_query needs lookup tables");
+
+		m_bottom_radius_sq = atmosphere.bottom_radius * atmosphere.bottom_radius;
+		m_top_radius_sq = atmosphere.top_radius * atmosphere.top_radius;
+		m_H = sqrtf(m_top_radius_sq - m_bottom_radius_sq);
+		m_mu_s_d_min = atmosphere.top_radius - atmosphere.bottom_radius;
+		m_mu_s_d_range = m_H - m_mu_s_d_min;
+		m_mu_s_A = -2.0f * atmosphere.mu_s_min * atmosphere.bottom_radius / m_mu_s_d_range;
+		m_mie_g = atmosphere.mie_phase_function_g;
+		m_mie_extrapolation = (atmosphere.rayleigh_scattering.r / atmosphere.mie_scattering.r) *
+			(atmosphere.mie_scattering / atmosphere.rayleigh_scattering).rgb();
+	}
+
+	atmosphere_query::altitude atmosphere_query::at_radius(float r) const
+	{
+		const lut_sizes& sizes = m_luts->sizes;
+		altitude a;
+		a.r = r;
+		a.rho = common::safe_sqrt(r * r - m_bottom_radius_sq);
+		a.transmittance_v = common::get_texture_coord_from_unit_range(a.rho / m_H, sizes.transmittance_height);
+		a.transmittance_d_min = m_atmosphere.top_radius - r;
+		a.transmittance_d_range = a.rho + m_H - a.transmittance_d_min;
+		a.scattering_w = common::get_texture_coord_from_unit_range(a.rho / m_H, sizes.scattering_r);
+		return a;
+	}
+
+	float atmosphere_query::scattering_u_mu_s(float mu_s) const
+	{
+		float d = common::distance_to_top_atmosphere_boundary(m_atmosphere, m_atmosphere.bottom_radius, mu_s);
+		float a = (d - m_mu_s_d_min) / m_mu_s_d_range;
+		return common::get_texture_coord_from_unit_range((std::max)(1.0f - a / m_mu_s_A, 0.0f) / (1.0f + a),
+			m_luts->sizes.scattering_mu_s);
+	}
+
+	rgba atmosphere_query::transmittance_to_top(const altitude& a, float mu) const
+	{
+		float d = common::clamp_distance(-a.r * mu + common::safe_sqrt(a.r * a.r * (mu * mu - 1.0f) + m_top_radius_sq));
+		float u = common::get_texture_coord_from_unit_range((d - a.transmittance_d_min) / a.transmittance_d_range,
+			m_luts->sizes.transmittance_width);
+		return m_luts->transmittance.sample(u, a.transmittance_v);
+	}
+
+	// GetCombinedScattering: the two nu slices share the mu and r weights, so
+	// the 16 texels are blended with one set of y and z coordinates.
+	rgba atmosphere_query::combined_scattering(const altitude& a, float mu, float u_mu_s, float nu,
+		bool ray_r_mu_intersects_ground, rgba& single_mie_scattering) const
+	{
+		const lut_sizes& sizes = m_luts->sizes;
+		const texture_3d& t = m_luts->scattering;
+
+		float r_mu = a.r * mu;
+		float discriminant = r_mu * r_mu - a.r * a.r + m_bottom_radius_sq;
+		float u_mu;
+		if (ray_r_mu_intersects_ground)
+		{
+			float d = -r_mu - common::safe_sqrt(discriminant);
+			float d_min = a.r - m_atmosphere.bottom_radius;
+			float d_max = a.rho;
+			u_mu = 0.5f - 0.5f * common::get_texture_coord_from_unit_range(d_max == d_min ? 0.0f :
+				(d - d_min) / (d_max - d_min), sizes.scattering_mu / 2);
+		}
+		else
+		{
+			float d = -r_mu + common::safe_sqrt(discriminant + m_H * m_H);
+			float d_min = m_atmosphere.top_radius - a.r;
+			float d_max = a.rho + m_H;
+			u_mu = 0.5f + 0.5f * common::get_texture_coord_from_unit_range((d - d_min) / (d_max - d_min), sizes.scattering_mu / 2);
+		}
+
+		float tex_coord_x = (nu + 1.0f) / 2.0f * (float)(sizes.scattering_nu - 1);
+		float tex_x = floorf(tex_coord_x);
+		float lerp_x = tex_coord_x - tex_x;
+
+		float ty = u_mu * t.height - 0.5f, tz = a.scattering_w * t.depth - 0.5f;
+		float fy0 = floorf(ty), fz0 = floorf(tz);
+		float fy = ty - fy0, fz = tz - fz0;
+		int y0 = std::clamp((int)fy0, 0, t.height - 1), y1 = std::clamp((int)fy0 + 1, 0, t.height - 1);
+		int z0 = std::clamp((int)fz0, 0, t.depth - 1), z1 = std::clamp((int)fz0 + 1, 0, t.depth - 1);
+		const rgba* rows[4] = { &t.at(0, y0, z0), &t.at(0, y1, z0), &t.at(0, y0, z1), &t.at(0, y1, z1) };
+
+		auto sample_slice = [&](float u)
+		{
+			float tx = u * t.width - 0.5f;
+			float fx0 = floorf(tx);
+			float fx = tx - fx0;
+			int x0 = std::clamp((int)fx0, 0, t.width - 1), x1 = std::clamp((int)fx0 + 1, 0, t.width - 1);
+			rgba near_z = lerp(lerp(rows[0][x0], rows[0][x1], fx), lerp(rows[1][x0], rows[1][x1], fx), fy);
+			rgba far_z = lerp(lerp(rows[2][x0], rows[2][x1], fx), lerp(rows[3][x0], rows[3][x1], fx), fy);
+			return lerp(near_z, far_z, fz);
+		};
+
+		rgba combined_scattering =
+			sample_slice((tex_x + u_mu_s) / (float)sizes.scattering_nu) * (1.0f - lerp_x) +
+			sample_slice((tex_x + 1.0f + u_mu_s) / (float)sizes.scattering_nu) * lerp_x;
+		single_mie_scattering = combined_scattering.r == 0.0f ? rgba() :
+			combined_scattering.rgb() * (combined_scattering.a / combined_scattering.r) * m_mie_extrapolation;
+		return combined_scattering.rgb();
+	}
+
+	rgba atmosphere_query::radiance_inside(const altitude& a, const IvVector3& position, const IvVector3& view_ray,
+		float u_mu_s, const IvVector3& sun_direction, rgba* transmittance) const
+	{
+		float mu = dot(position, view_ray) / a.r;
+		float nu = dot(view_ray, sun_direction);
+		bool ray_r_mu_intersects_ground = common::ray_intersects_ground(m_atmosphere, a.r, mu);
+		if (transmittance) *transmittance = ray_r_mu_intersects_ground ? rgba() : transmittance_to_top(a, mu).rgb();
+
+		rgba single_mie_scattering;
+		rgba scattering = combined_scattering(a, mu, u_mu_s, nu, ray_r_mu_intersects_ground, single_mie_scattering);
+		return scattering * common::rayleigh_phase_function(nu) +
+			single_mie_scattering * common::mie_phase_function(m_mie_g, nu);
+	}
+
+	rgba atmosphere_query::sun_transmittance(const IvVector3& point, const IvVector3& sun_direction) const
+	{
+		const float r = sqrtf(dot(point, point));
+		const float mu_s = dot(point, sun_direction) / r;
+		return common::get_transmittance_to_sun(m_atmosphere, m_luts->sizes, m_luts->transmittance, r, mu_s);
+	}
+
+	rgba atmosphere_query::sky_radiance(const IvVector3& camera, const IvVector3& view_ray, const IvVector3& sun_direction,
+		rgba* transmittance) const
+	{
+		IvVector3 position = camera;
+		float r = sqrtf(dot(position, position));
+		float rmu = dot(position, view_ray);
+		float distance_to_top_atmosphere_boundary = -rmu - sqrtf(rmu * rmu - r * r + m_top_radius_sq);
+		if (distance_to_top_atmosphere_boundary > 0.0f)
+		{
+			position = position + view_ray * distance_to_top_atmosphere_boundary;
+			r = m_atmosphere.top_radius;
+		}
+		if (r > m_atmosphere.top_radius)
+		{
+			if (transmittance) *transmittance = rgba(1.0f, 1.0f, 1.0f);
+			return rgba();
+		}
+		return radiance_inside(at_radius(r), position, view_ray, scattering_u_mu_s(dot(position, sun_direction) / r),
+			sun_direction, transmittance);
+	}
+
+	void atmosphere_query::sky_radiance(const IvVector3& camera, const IvVector3* view_rays, size_t count,
+		const IvVector3& sun_direction, rgba* radiance, rgba* transmittance) const
+	{
+		const float r = sqrtf(dot(camera, camera));
+		if (r > m_atmosphere.top_radius)
+		{
+			// every ray enters the atmosphere somewhere else
+			for (size_t i = 0; i < count; ++i)
+				radiance[i] = sky_radiance(camera, view_rays[i], sun_direction, transmittance ? transmittance + i : nullptr);
+			return;
+		}
+
+		const altitude a = at_radius(r);
+		const float u_mu_s = scattering_u_mu_s(dot(camera, sun_direction) / r);
+		for (size_t i = 0; i < count; ++i)
+			radiance[i] = radiance_inside(a, camera, view_rays[i], u_mu_s, sun_direction, transmittance ? transmittance + i : nullptr);
+	}
+
+	rgba atmosphere_query::sky_radiance_to_point(const IvVector3& camera, const IvVector3& point,
+		const IvVector3& sun_direction, rgba& transmittance) const
+	{
+		IvVector3 view_ray = point - camera;
+		const float distance = sqrtf(dot(view_ray, view_ray));
+		view_ray = view_ray * (1.0f / distance);
+		rgba radiance;
+		sky_radiance_to_points(camera, view_ray, &distance, 1, sun_direction, &radiance, &transmittance);
+		return radiance;
+	}
+
+	void atmosphere_query::sky_radiance_to_points(const IvVector3& camera, const IvVector3& view_ray, const float* distances,
+		size_t count, const IvVector3& sun_direction, rgba* radiance, rgba* transmittance) const
+	{
+		IvVector3 position = camera;
+		float r = sqrtf(dot(position, position));
+		float rmu = dot(position, view_ray);
+		float distance_to_top_atmosphere_boundary = -rmu - sqrtf(rmu * rmu - r * r + m_top_radius_sq);
+		float start = 0.0f;
+		if (distance_to_top_atmosphere_boundary > 0.0f)
+		{
+			position = position + view_ray * distance_to_top_atmosphere_boundary;
+			r = m_atmosphere.top_radius;
+			rmu += distance_to_top_atmosphere_boundary;
+			start = distance_to_top_atmosphere_boundary;
+		}
+		const float mu = rmu / r;
+		const float mu_s = dot(position, sun_direction) / r;
+		const float nu = dot(view_ray, sun_direction);
+		const bool ray_r_mu_intersects_ground = common::ray_intersects_ground(m_atmosphere, r, mu);
+		const float rayleigh_phase = common::rayleigh_phase_function(nu);
+		const float mie_phase = common::mie_phase_function(m_mie_g, nu) * common::smoothstep(0.0f, 0.01f, mu_s);
+
+		// what depends on the camera end only
+		const altitude a = at_radius(r);
+		const rgba transmittance_at_camera = transmittance_to_top(a, ray_r_mu_intersects_ground ? -mu : mu);
+		rgba single_mie_scattering;
+		const rgba scattering = combined_scattering(a, mu, scattering_u_mu_s(mu_s), nu, ray_r_mu_intersects_ground,
+			single_mie_scattering);
+
+		const rgba one(1.0f);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const float d = fabsf(distances[i] - start);
+			const float r_p = common::clamp_radius(m_atmosphere, sqrtf(d * d + 2.0f * r * mu * d + r * r));
+			const float mu_p = (r * mu + d) / r_p;
+			const float mu_s_p = (r * mu_s + d * nu) / r_p;
+			const altitude a_p = at_radius(r_p);
+
+			// GetTransmittance
+			const float mu_d = common::clamp_cosine(mu_p);
+			const rgba t = ray_r_mu_intersects_ground ?
+				min_per_lane(transmittance_to_top(a_p, -mu_d) / transmittance_at_camera, one) :
+				min_per_lane(transmittance_at_camera / transmittance_to_top(a_p, mu_d), one);
+			transmittance[i] = t.rgb();
+
+			rgba single_mie_scattering_p;
+			const rgba scattering_p = combined_scattering(a_p, mu_p, scattering_u_mu_s(mu_s_p), nu, ray_r_mu_intersects_ground,
+				single_mie_scattering_p);
+			const rgba in_scattering = scattering - transmittance[i] * scattering_p;
+			const float mie_red = single_mie_scattering.r - transmittance[i].r * single_mie_scattering_p.r;
+			const rgba mie = in_scattering.r == 0.0f ? rgba() : in_scattering * (mie_red / in_scattering.r) * m_mie_extrapolation;
+			radiance[i] = in_scattering * rayleigh_phase + mie * mie_phase;
+		}
+	}
+
+	rgba atmosphere_query::sun_and_sky_irradiance(const IvVector3& point, const IvVector3& normal,
+		const IvVector3& sun_direction, rgba& sky_irradiance) const
+	{
+		const float r = sqrtf(dot(point, point));
+		const float mu_s = dot(point, sun_direction) / r;
+		const altitude a = at_radius(r);
+
+		sky_irradiance = common::get_irradiance(m_atmosphere, m_luts->sizes, m_luts->irradiance, r, mu_s) *
+			((1.0f + dot(normal, point) / r) * 0.5f);
+
+		return m_atmosphere.solar_irradiance.rgb() * transmittance_to_top(a, mu_s) *
+			common::smoothstep(-m_atmosphere.sun_angular_radius, m_atmosphere.sun_angular_radius, mu_s) *
+			(std::max)(dot(normal, sun_direction), 0.0f);
+	}
+
+	lut_error compare_luts(const atmosphere_query& test, const atmosphere_query& reference)
+	{
+		const float c_altitudes_km[] = { 0.2f, 2.0f, 8.0f, 30.0f };
+		// sun elevations in degrees, down to the end of civil twilight
+		const float c_sun_elevations[] = { 90.0f, 45.0f, 20.0f, 8.0f, 3.0f, 0.0f, -3.0f, -6.0f };
+		const int c_view_elevations = 91;   // -90 to 90 degrees
+		const int c_view_azimuths = 9;      // 0 to 180 degrees from the sun, the other half is mirrored
+
+		const float bottom_radius = reference.atmosphere().bottom_radius;
+		const float floor = 1e-3f;
+
+		std::vector<IvVector3> view_rays;
+		for (int e = 0; e < c_view_elevations; ++e)
+		{
+			const float elevation = c_pi * ((float)e / (c_view_elevations - 1) - 0.5f);
+			for (int a = 0; a < c_view_azimuths; ++a)
+			{
+				const float azimuth = c_pi * (float)a / (c_view_azimuths - 1);
+				view_rays.push_back(IvVector3(cosf(elevation) * cosf(azimuth), sinf(elevation), cosf(elevation) * sinf(azimuth)));
+			}
+		}
+		std::vector<rgba> test_radiance(view_rays.size()), reference_radiance(view_rays.size());
+
+		std::vector<float> radiance_errors, transmittance_errors, irradiance_errors;
+		const IvVector3 up(0.0f, 1.0f, 0.0f);
+		for (float altitude : c_altitudes_km)
+		{
+			const IvVector3 camera(0.0f, bottom_radius + altitude, 0.0f);
+			for (float sun_elevation : c_sun_elevations)
+			{
+				const float s = sun_elevation * c_pi / 180.0f;
+				const IvVector3 sun_direction(cosf(s), sinf(s), 0.0f);
+
+				test.sky_radiance(camera, view_rays.data(), view_rays.size(), sun_direction, test_radiance.data());
+				reference.sky_radiance(camera, view_rays.data(), view_rays.size(), sun_direction, reference_radiance.data());
+				const float radiance_floor = (std::max)(largest_channel(reference_radiance.data(), reference_radiance.size()) * floor, 1e-30f);
+				for (size_t i = 0; i < view_rays.size(); ++i)
+					radiance_errors.push_back(channel_error(test_radiance[i], reference_radiance[i], radiance_floor));
+
+				transmittance_errors.push_back(channel_error(test.sun_transmittance(camera, sun_direction),
+					reference.sun_transmittance(camera, sun_direction), floor));
+
+				rgba test_irradiance, reference_irradiance;
+				test.sun_and_sky_irradiance(camera, up, sun_direction, test_irradiance);
+				reference.sun_and_sky_irradiance(camera, up, sun_direction, reference_irradiance);
+				irradiance_errors.push_back(channel_error(test_irradiance, reference_irradiance,
+					(std::max)(largest_channel(&reference_irradiance, 1) * floor, 1e-30f)));
+			}
+		}
+
+		lut_error error;
+		error.sky_radiance = summarize(radiance_errors);
+		error.transmittance = summarize(transmittance_errors);
+		error.sky_irradiance = summarize(irradiance_errors);
+		return error;
+	}
+}
+}
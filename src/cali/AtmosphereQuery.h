@@ -0,0 +1,107 @@
+#pragma once
+#include "Atmosphere.h"
+
+#include <IvVector3.h>
+
+#include <cstddef>
+#include <memory>
+
+namespace cali
+{
+namespace atmosphere
+{
+	// The sky and sun values of the renderer, from a CPU copy of the LUTs:
+	// GetSkyRadiance, GetSunAndSkyIrradiance and the transmittance to the sun,
+	// for exposure, ambient and fog decisions on the CPU side. Positions are in
+	// km relative to the planet center and directions unit length, as in the
+	// shaders. Matches the straight ports of AtmosphereFunctions.h; what
+	// depends on the altitude only is computed once per call, or once per
+	// batch of view rays.
+	class atmosphere_query
+	{
+	public:
+		atmosphere_query(const atmosphere_parameters& atmosphere, std::shared_ptr<const luts> luts);
+
+		const atmosphere_parameters& atmosphere() const { return m_atmosphere; }
+		const luts& lookup_tables() const { return *m_luts; }
+
+		// Transmittance from `point` to the sun, 0 once the sun disc is below
+		// the horizon.
+		rgba sun_transmittance(const IvVector3& point, const IvVector3& sun_direction) const;
+
+		// Radiance reaching `camera` along `view_ray` (shadow_length = 0);
+		// `transmittance` to the top of the atmosphere, 0 towards the ground.
+		rgba sky_radiance(const IvVector3& camera, const IvVector3& view_ray, const IvVector3& sun_direction,
+			rgba* transmittance = nullptr) const;
+		// The same for `count` view rays from one camera.
+		void sky_radiance(const IvVector3& camera, const IvVector3* view_rays, size_t count, const IvVector3& sun_direction,
+			rgba* radiance, rgba* transmittance = nullptr) const;
+
+		// Radiance scattered towards `camera` between it and `point`
+		// (GetSkyRadianceToPoint, shadow_length = 0), the aerial perspective
+		// of a surface at `point`; `transmittance` between the two.
+		rgba sky_radiance_to_point(const IvVector3& camera, const IvVector3& point, const IvVector3& sun_direction,
+			rgba& transmittance) const;
+		// The same for the points at `distances` along one view ray; the
+		// lookups at the camera end are shared.
+		void sky_radiance_to_points(const IvVector3& camera, const IvVector3& view_ray, const float* distances, size_t count,
+			const IvVector3& sun_direction, rgba* radiance, rgba* transmittance) const;
+
+		// Sun irradiance on a surface at `point` facing `normal`; the sky one
+		// in `sky_irradiance`.
+		rgba sun_and_sky_irradiance(const IvVector3& point, const IvVector3& normal, const IvVector3& sun_direction,
+			rgba& sky_irradiance) const;
+
+	private:
+		// everything of a lookup that depends on the radius only
+		struct altitude
+		{
+			float r;
+			float rho;
+			float transmittance_v;
+			float transmittance_d_min, transmittance_d_range;
+			float scattering_w;
+		};
+
+		altitude at_radius(float r) const;
+		float scattering_u_mu_s(float mu_s) const;
+		rgba transmittance_to_top(const altitude& a, float mu) const;
+		rgba combined_scattering(const altitude& a, float mu, float u_mu_s, float nu, bool ray_r_mu_intersects_ground,
+			rgba& single_mie_scattering) const;
+		rgba radiance_inside(const altitude& a, const IvVector3& position, const IvVector3& view_ray, float u_mu_s,
+			const IvVector3& sun_direction, rgba* transmittance) const;
+
+		atmosphere_parameters m_atmosphere;
+		std::shared_ptr<const luts> m_luts;
+
+		float m_H;
+		float m_bottom_radius_sq, m_top_radius_sq;
+		float m_mu_s_d_min, m_mu_s_d_range, m_mu_s_A;
+		float m_mie_g;
+		rgba m_mie_extrapolation;
+	};
+
+	// Relative errors |test - reference| / reference of one quantity, the
+	// largest of the three channels per sample.
+	struct error_stats
+	{
+		float mean = 0.0f;
+		float p95 = 0.0f;
+		float max = 0.0f;
+		size_t samples = 0;
+	};
+
+	struct lut_error
+	{
+		error_stats sky_radiance;    // views all around cameras from 0.2 to 30 km, sun from zenith to twilight
+		error_stats transmittance;   // to the sun, from the same cameras
+		error_stats sky_irradiance;  // on a horizontal surface
+	};
+
+	// How far the LUTs of `test` are from those of `reference` (usually
+	// larger ones of the same atmosphere), over a fixed set of cameras, sun
+	// directions and view rays. A reference value below 1e-3 of the largest
+	// of its set counts as that floor, so the night side does not dominate.
+	lut_error compare_luts(const atmosphere_query& test, const atmosphere_query& reference);
+}
+}
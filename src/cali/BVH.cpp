@@ -0,0 +1,525 @@
+#include "BVH.h"
+#include "CaliThreads.h"
+
+#include <IvLanes.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <stdexcept>
+#include <thread>
+
+namespace cali
+{
+	namespace
+	{
+		// ranges of this many objects or fewer are built as one task
+		const size_t c_task_size = 8192;
+		// from this depth on, splits are at the object median, which bounds the depth
+		const size_t c_sah_depth = 40;
+		const size_t c_stack_size = 128;
+
+		// xyz and a fourth lane that is not used, to grow in IvFloat4
+		struct box
+		{
+			float min[4] = { FLT_MAX, FLT_MAX, FLT_MAX, FLT_MAX };
+			float max[4] = { -FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+			void grow(const float* lo, const float* hi)
+			{
+				Min(IvFloat4::Load(min), IvFloat4::Load(lo)).Store(min);
+				Max(IvFloat4::Load(max), IvFloat4::Load(hi)).Store(max);
+			}
+			void grow(const box& other) { grow(other.min, other.max); }
+			float half_area() const
+			{
+				if (min[0] > max[0]) return 0.0f;
+				const float x = max[0] - min[0], y = max[1] - min[1], z = max[2] - min[2];
+				return x * y + y * z + z * x;
+			}
+		};
+
+		struct task
+		{
+			size_t id; // of the node the task builds
+			bvh::index begin, end;
+			size_t depth;
+			box bounds, centroids; // of the objects in [begin, end)
+
+			task() : task(0, 0, 0, 0) {}
+			task(size_t id, bvh::index begin, bvh::index end, size_t depth) : id(id), begin(begin), end(end), depth(depth) {}
+		};
+
+		template <typename Node, typename Pair>
+		Node& node_at(std::vector<Pair>& nodes, size_t id) { return nodes[id / 2].child[id % 2]; }
+
+		// An object of a build; the build partitions these, not indices, so that
+		// each pass over a range reads it in order
+		struct build_object
+		{
+			float min[4], max[4], centroid[4]; // as box
+			bvh::index id;
+		};
+
+		// The bin of a centroid on an axis, the same in the search and the partition
+		inline size_t bin_of(float c, float lo, float scale)
+		{
+			const int bin = (int)((c - lo) * scale);
+			return (size_t)std::min(std::max(bin, 0), (int)bvh::c_bins - 1);
+		}
+
+		void measure(const build_object* objects, bvh::index begin, bvh::index end, box& bounds, box& centroids)
+		{
+			bounds = box();
+			centroids = box();
+			for (bvh::index i = begin; i < end; ++i)
+			{
+				bounds.grow(objects[i].min, objects[i].max);
+				centroids.grow(objects[i].centroid, objects[i].centroid);
+			}
+		}
+
+		// Builds the objects of root under its node of nodes, which exists;
+		// with deferred, ranges of c_task_size or fewer are left to it
+		template <typename Node, typename Pair>
+		void build_range(build_object* objects, std::vector<Pair>& nodes, const task& root, std::vector<task>* deferred,
+			size_t& max_depth)
+		{
+			task stack[c_stack_size];
+			size_t top = 0;
+			stack[top++] = root;
+
+			while (top > 0)
+			{
+				const task t = stack[--top];
+				const size_t count = t.end - t.begin;
+				max_depth = std::max(max_depth, t.depth);
+				{
+					Node& n = node_at<Node>(nodes, t.id);
+					for (int a = 0; a < 3; ++a)
+					{
+						n.min[a] = t.bounds.min[a];
+						n.max[a] = t.bounds.max[a];
+					}
+				}
+
+				if (count <= bvh::c_max_leaf)
+				{
+					Node& n = node_at<Node>(nodes, t.id);
+					n.first = t.begin;
+					n.count = (bvh::index)count;
+					continue;
+				}
+				if (deferred && count <= c_task_size)
+				{
+					deferred->push_back(t);
+					continue;
+				}
+
+				// the lowest SAH cost of all bins on all axes
+				int best_axis = -1;
+				size_t best_bin = 0;
+				float best_cost = FLT_MAX;
+				float scales[3];
+				for (int a = 0; a < 3; ++a)
+				{
+					const float extent = t.centroids.max[a] - t.centroids.min[a];
+					scales[a] = extent > 0.0f ? (float)bvh::c_bins / extent : 0.0f;
+				}
+				if (t.depth < c_sah_depth)
+				{
+					// the bins of all three axes in one pass over the range
+					box bins[3][bvh::c_bins];
+					size_t counts[3][bvh::c_bins] = {};
+					for (bvh::index i = t.begin; i < t.end; ++i)
+					{
+						const build_object& o = objects[i];
+						for (int a = 0; a < 3; ++a)
+						{
+							const size_t bin = bin_of(o.centroid[a], t.centroids.min[a], scales[a]);
+							bins[a][bin].grow(o.min, o.max);
+							++counts[a][bin];
+						}
+					}
+
+					for (int a = 0; a < 3; ++a)
+					{
+						if (scales[a] == 0.0f) continue;
+
+						// area * count of everything right of each boundary
+						float right_cost[bvh::c_bins];
+						box right;
+						size_t right_count = 0;
+						for (size_t bin = bvh::c_bins - 1; bin > 0; --bin)
+						{
+							right.grow(bins[a][bin]);
+							right_count += counts[a][bin];
+							right_cost[bin] = right.half_area() * (float)right_count;
+						}
+						box left;
+						size_t left_count = 0;
+						for (size_t bin = 0; bin + 1 < bvh::c_bins; ++bin)
+						{
+							left.grow(bins[a][bin]);
+							left_count += counts[a][bin];
+							if (left_count == 0 || left_count == count) continue;
+							const float cost = left.half_area() * (float)left_count + right_cost[bin + 1];
+							if (cost < best_cost)
+							{
+								best_cost = cost;
+								best_axis = a;
+								best_bin = bin;
+							}
+						}
+					}
+				}
+
+				task left{ 2 * nodes.size(), t.begin, t.begin, t.depth + 1 };
+				task right{ 2 * nodes.size() + 1, t.end, t.end, t.depth + 1 };
+				if (best_axis >= 0)
+				{
+					// partitioned in place, measuring both sides on the way
+					const float lo = t.centroids.min[best_axis], scale = scales[best_axis];
+					auto goes_left = [&](const build_object& o) { return bin_of(o.centroid[best_axis], lo, scale) <= best_bin; };
+					bvh::index i = t.begin, j = t.end;
+					for (;;)
+					{
+						for (; i < j && goes_left(objects[i]); ++i)
+						{
+							left.bounds.grow(objects[i].min, objects[i].max);
+							left.centroids.grow(objects[i].centroid, objects[i].centroid);
+						}
+						for (; i < j && !goes_left(objects[j - 1]); --j)
+						{
+							right.bounds.grow(objects[j - 1].min, objects[j - 1].max);
+							right.centroids.grow(objects[j - 1].centroid, objects[j - 1].centroid);
+						}
+						if (i == j) break;
+						std::swap(objects[i], objects[j - 1]);
+					}
+					left.end = right.begin = i;
+				}
+				else
+				{
+					// no SAH split (all centroids in one place, or too deep): halves along the longest axis
+					int axis = 0;
+					for (int a = 1; a < 3; ++a)
+						if (t.centroids.max[a] - t.centroids.min[a] > t.centroids.max[axis] - t.centroids.min[axis]) axis = a;
+					left.end = right.begin = t.begin + (bvh::index)(count / 2);
+					std::nth_element(objects + t.begin, objects + left.end, objects + t.end, [&](const build_object& a, const build_object& b)
+					{
+						return a.centroid[axis] < b.centroid[axis] || (a.centroid[axis] == b.centroid[axis] && a.id < b.id);
+					});
+					measure(objects, left.begin, left.end, left.bounds, left.centroids);
+					measure(objects, right.begin, right.end, right.bounds, right.centroids);
+				}
+
+				Node& n = node_at<Node>(nodes, t.id);
+				n.first = (bvh::index)nodes.size();
+				n.count = 0;
+				nodes.emplace_back();
+				stack[top++] = right;
+				stack[top++] = left;
+			}
+		}
+
+		// The slab test of a ray against [lo, hi], within [0, max_distance]
+		inline bool ray_hits(const float* lo, const float* hi, const float* origin, const float* inverse, float max_distance)
+		{
+			float t_min = 0.0f, t_max = max_distance;
+			for (int a = 0; a < 3; ++a)
+			{
+				if (inverse[a] == FLT_MAX)
+				{
+					// parallel to the slab
+					if (origin[a] < lo[a] || origin[a] > hi[a]) return false;
+					continue;
+				}
+				float t0 = (lo[a] - origin[a]) * inverse[a], t1 = (hi[a] - origin[a]) * inverse[a];
+				if (t0 > t1) std::swap(t0, t1);
+				t_min = std::max(t_min, t0);
+				t_max = std::min(t_max, t1);
+				if (t_min > t_max) return false;
+			}
+			return true;
+		}
+
+		inline bool boxes_overlap(const float* lo, const float* hi, const IvVector3& other_lo, const IvVector3& other_hi)
+		{
+			return lo[0] <= other_hi.x && hi[0] >= other_lo.x && lo[1] <= other_hi.y && hi[1] >= other_lo.y &&
+				lo[2] <= other_hi.z && hi[2] >= other_lo.z;
+		}
+
+		inline bool sphere_overlaps(const float* lo, const float* hi, const IvVector3& center, float radius)
+		{
+			float distance_squared = 0.0f;
+			for (int a = 0; a < 3; ++a)
+			{
+				const float d = center[a] < lo[a] ? lo[a] - center[a] : center[a] > hi[a] ? center[a] - hi[a] : 0.0f;
+				distance_squared += d * d;
+			}
+			return distance_squared <= radius * radius;
+		}
+
+		inline containment classify(const frustum& view, const float* lo, const float* hi, uint8_t& mask)
+		{
+			const IvDoubleVector3 center(0.5 * ((double)lo[0] + hi[0]), 0.5 * ((double)lo[1] + hi[1]), 0.5 * ((double)lo[2] + hi[2]));
+			const IvDoubleVector3 extents(0.5 * ((double)hi[0] - lo[0]), 0.5 * ((double)hi[1] - lo[1]), 0.5 * ((double)hi[2] - lo[2]));
+			return view.classify_box(center, extents, &mask);
+		}
+
+		// Depth-first over the nodes the test accepts, each leaf's objects tested alone
+		template <typename Node, typename Pair, typename Test>
+		void traverse(const std::vector<Pair>& nodes, const std::vector<bvh::index>& indices, const std::vector<float>& bounds,
+			const Test& test, std::vector<bvh::index>& hits)
+		{
+			hits.clear();
+			if (nodes.empty()) return;
+
+			size_t stack[c_stack_size];
+			size_t top = 0;
+			stack[top++] = 0;
+			while (top > 0)
+			{
+				const size_t id = stack[--top];
+				const Node& n = nodes[id / 2].child[id % 2];
+				if (!test(n.min, n.max)) continue;
+				if (n.count == 0)
+				{
+					stack[top++] = 2 * (size_t)n.first + 1;
+					stack[top++] = 2 * (size_t)n.first;
+					continue;
+				}
+				for (bvh::index i = n.first; i < n.first + n.count; ++i)
+				{
+					const float* b = &bounds[6 * (size_t)i];
+					if (test(b, b + 3)) hits.push_back(indices[i]);
+				}
+			}
+		}
+	}
+
+	bvh::bvh(int threads) :
+		m_node_count(0),
+		m_depth(0),
+		m_threads(threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency()))
+	{
+	}
+
+	void bvh::clear()
+	{
+		m_nodes.clear();
+		m_indices.clear();
+		m_bounds.clear();
+		m_node_count = 0;
+		m_depth = 0;
+		m_root_bounds = IvAABB();
+	}
+
+	void bvh::build(const IvAABB* bounds, size_t count)
+	{
+		clear();
+		if (count == 0) return;
+		if (count > (size_t)UINT32_MAX / 2) throw std::invalid_argument("bvh::build: too many objects");
+
+		std::vector<build_object> objects(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvVector3& lo = bounds[i].GetMinima();
+			const IvVector3& hi = bounds[i].GetMaxima();
+			for (int a = 0; a < 3; ++a)
+			{
+				objects[i].min[a] = lo[a];
+				objects[i].max[a] = hi[a];
+				objects[i].centroid[a] = 0.5f * (lo[a] + hi[a]);
+			}
+			objects[i].min[3] = objects[i].max[3] = objects[i].centroid[3] = 0.0f;
+			objects[i].id = (index)i;
+		}
+
+		// the top of the tree here, down to ranges of c_task_size
+		m_nodes.reserve(2 * count / c_max_leaf + 1);
+		m_nodes.emplace_back();
+		std::vector<task> tasks;
+		task root{ 0, 0, (index)count, 0 };
+		measure(objects.data(), root.begin, root.end, root.bounds, root.centroids);
+		build_range<node>(objects.data(), m_nodes, root, &tasks, m_depth);
+
+		// the subtrees below it, each into nodes of its own
+		std::vector<std::vector<node_pair>> subtrees(tasks.size());
+		std::vector<size_t> depths(tasks.size(), 0);
+		parallel_for((int)tasks.size(), m_threads, [&](int i)
+		{
+			task subtree_root = tasks[i];
+			subtree_root.id = 0;
+			subtrees[i].emplace_back();
+			build_range<node>(objects.data(), subtrees[i], subtree_root, nullptr, depths[i]);
+		});
+
+		// spliced in task order: the root of each in place of its node, the rest appended
+		for (size_t i = 0; i < tasks.size(); ++i)
+		{
+			const std::vector<node_pair>& subtree = subtrees[i];
+			const index base = (index)m_nodes.size() - 1;
+			auto relocate = [base](node n)
+			{
+				if (n.count == 0) n.first += base;
+				return n;
+			};
+			node_at<node>(m_nodes, tasks[i].id) = relocate(subtree[0].child[0]);
+			for (size_t pair = 1; pair < subtree.size(); ++pair)
+			{
+				m_nodes.emplace_back();
+				m_nodes.back().child[0] = relocate(subtree[pair].child[0]);
+				m_nodes.back().child[1] = relocate(subtree[pair].child[1]);
+			}
+			m_depth = std::max(m_depth, depths[i]);
+		}
+		m_node_count = 2 * m_nodes.size() - 1;
+
+		m_indices.resize(count);
+		m_bounds.resize(6 * count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			m_indices[i] = objects[i].id;
+			std::copy(objects[i].min, objects[i].min + 3, &m_bounds[6 * i]);
+			std::copy(objects[i].max, objects[i].max + 3, &m_bounds[6 * i + 3]);
+		}
+		set_root_bounds();
+	}
+
+	void bvh::refit(const IvAABB* bounds, size_t count)
+	{
+		if (count != m_indices.size()) throw std::invalid_argument("bvh::refit: not the objects of the build");
+		if (count == 0) return;
+
+		m_bounds.resize(6 * count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvAABB& b = bounds[m_indices[i]];
+			for (int a = 0; a < 3; ++a)
+			{
+				m_bounds[6 * i + a] = b.GetMinima()[a];
+				m_bounds[6 * i + 3 + a] = b.GetMaxima()[a];
+			}
+		}
+
+		// children come after their parents
+		for (size_t id = 2 * m_nodes.size(); id-- > 0;)
+		{
+			if (id == 1) continue;
+			node& n = node_at<node>(m_nodes, id);
+			box fitted;
+			if (n.count == 0)
+			{
+				const node_pair& children = m_nodes[n.first];
+				fitted.grow(children.child[0].min, children.child[0].max);
+				fitted.grow(children.child[1].min, children.child[1].max);
+			}
+			else
+			{
+				for (index i = n.first; i < n.first + n.count; ++i)
+				{
+					const float* b = &m_bounds[6 * (size_t)i];
+					const float lo[4] = { b[0], b[1], b[2], 0.0f }, hi[4] = { b[3], b[4], b[5], 0.0f };
+					fitted.grow(lo, hi);
+				}
+			}
+			for (int a = 0; a < 3; ++a)
+			{
+				n.min[a] = fitted.min[a];
+				n.max[a] = fitted.max[a];
+			}
+		}
+
+		set_root_bounds();
+	}
+
+	void bvh::set_root_bounds()
+	{
+		m_root_bounds.Set(IvVector3(root().min[0], root().min[1], root().min[2]), IvVector3(root().max[0], root().max[1], root().max[2]));
+	}
+
+	size_t bvh::memory_bytes() const
+	{
+		return m_nodes.size() * sizeof(node_pair) + m_indices.size() * sizeof(index) + m_bounds.size() * sizeof(float);
+	}
+
+	void bvh::add_subtree(const node& n, std::vector<index>& hits) const
+	{
+		// a subtree's objects are contiguous: from its leftmost leaf to its rightmost
+		const node* left = &n;
+		while (left->count == 0) left = &m_nodes[left->first].child[0];
+		const node* right = &n;
+		while (right->count == 0) right = &m_nodes[right->first].child[1];
+		hits.insert(hits.end(), m_indices.begin() + left->first, m_indices.begin() + right->first + right->count);
+	}
+
+	void bvh::query(const frustum& view, std::vector<index>& hits) const
+	{
+		hits.clear();
+		if (m_nodes.empty()) return;
+
+		// with the planes each node straddles, for its children
+		struct entry { const node* n; uint8_t mask; };
+		entry stack[c_stack_size];
+		size_t top = 0;
+		stack[top++] = { &root(), frustum::all_planes };
+		while (top > 0)
+		{
+			const entry e = stack[--top];
+			uint8_t mask = e.mask;
+			const containment c = classify(view, e.n->min, e.n->max, mask);
+			if (c == containment::outside) continue;
+			if (c == containment::inside)
+			{
+				add_subtree(*e.n, hits);
+				continue;
+			}
+			if (e.n->count == 0)
+			{
+				const node_pair& children = m_nodes[e.n->first];
+				stack[top++] = { &children.child[1], mask };
+				stack[top++] = { &children.child[0], mask };
+				continue;
+			}
+			for (index i = e.n->first; i < e.n->first + e.n->count; ++i)
+			{
+				uint8_t object_mask = mask;
+				const float* b = &m_bounds[6 * (size_t)i];
+				if (classify(view, b, b + 3, object_mask) != containment::outside) hits.push_back(m_indices[i]);
+			}
+		}
+	}
+
+	void bvh::query(const IvAABB& box, std::vector<index>& hits) const
+	{
+		const IvVector3& lo = box.GetMinima();
+		const IvVector3& hi = box.GetMaxima();
+		traverse<node>(m_nodes, m_indices, m_bounds, [&](const float* node_lo, const float* node_hi)
+		{
+			return boxes_overlap(node_lo, node_hi, lo, hi);
+		}, hits);
+	}
+
+	void bvh::query(const IvBoundingSphere& sphere, std::vector<index>& hits) const
+	{
+		const IvVector3& center = sphere.GetCenter();
+		const float radius = sphere.GetRadius();
+		traverse<node>(m_nodes, m_indices, m_bounds, [&](const float* lo, const float* hi)
+		{
+			return sphere_overlaps(lo, hi, center, radius);
+		}, hits);
+	}
+
+	void bvh::query(const IvRay3& ray, float max_distance, std::vector<index>& hits) const
+	{
+		const IvVector3 origin = ray.GetOrigin(), direction = ray.GetDirection();
+		const float o[3] = { origin.x, origin.y, origin.z };
+		float inverse[3];
+		for (int a = 0; a < 3; ++a) inverse[a] = direction[a] == 0.0f ? FLT_MAX : 1.0f / direction[a];
+		traverse<node>(m_nodes, m_indices, m_bounds, [&](const float* lo, const float* hi)
+		{
+			return ray_hits(lo, hi, o, inverse, max_distance);
+		}, hits);
+	}
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <IvAABB.h>
+#include <IvBoundingSphere.h>
+#include <IvRay3.h>
+
+#include "Frustum.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cali
+{
+	// -----------------------------------------------------------------
+	// A bounding volume hierarchy over the IvAABB bounds of static or
+	// slowly moving objects, found by index. build() splits each node
+	// where the surface area heuristic (SAH) is lowest among 16 bins of
+	// the centroids on each axis; the top of the tree is split on the
+	// calling thread and the subtrees below it are built on all of them,
+	// then spliced in a fixed order, so the tree does not depend on the
+	// thread count. refit() moves the objects without a rebuild: the
+	// nodes grow or shrink to the new bounds, and the tree gets slower
+	// as they move away from where it was built.
+	//
+	// Nodes are 32 bytes in one flat array, siblings side by side in a
+	// 64-byte aligned pair, so a visit of both children reads one cache
+	// line. A leaf holds up to c_max_leaf objects.
+	// -----------------------------------------------------------------
+	class bvh
+	{
+	public:
+		using index = uint32_t;
+		static const size_t c_bins = 16;
+		static const size_t c_max_leaf = 4;
+
+		// threads = 0: hardware concurrency.
+		explicit bvh(int threads = 0);
+
+		void build(const IvAABB* bounds, size_t count);
+		void build(const std::vector<IvAABB>& bounds) { build(bounds.data(), bounds.size()); }
+		// The same objects at new bounds; throws std::invalid_argument for another count
+		void refit(const IvAABB* bounds, size_t count);
+		void refit(const std::vector<IvAABB>& bounds) { refit(bounds.data(), bounds.size()); }
+		void clear();
+
+		size_t size() const { return m_indices.size(); }
+		size_t node_count() const { return m_node_count; }
+		size_t depth() const { return m_depth; }
+		// of the nodes, the object order and the object bounds
+		size_t memory_bytes() const;
+		const IvAABB& bounds() const { return m_root_bounds; }
+
+		// The objects whose bounds are not outside the frustum, overlap the
+		// box or the sphere, or are hit by the ray within max_distance (in
+		// units of its direction); hits is cleared first, in no particular order
+		void query(const frustum& view, std::vector<index>& hits) const;
+		void query(const IvAABB& box, std::vector<index>& hits) const;
+		void query(const IvBoundingSphere& sphere, std::vector<index>& hits) const;
+		void query(const IvRay3& ray, float max_distance, std::vector<index>& hits) const;
+
+		int threads() const { return m_threads; }
+
+	private:
+		struct node
+		{
+			float min[3];
+			index first; // interior: the pair of its children; leaf: its first object in m_indices
+			float max[3];
+			index count; // 0 for interior nodes
+		};
+
+		struct alignas(64) node_pair
+		{
+			node child[2];
+		};
+
+		const node& root() const { return m_nodes[0].child[0]; }
+		void set_root_bounds();
+		void add_subtree(const node& n, std::vector<index>& hits) const;
+
+		// the tree, the root alone in the first pair
+		std::vector<node_pair> m_nodes;
+		size_t m_node_count;
+		size_t m_depth;
+		IvAABB m_root_bounds;
+
+		// the objects in leaf order, and their bounds in the same order
+		std::vector<index> m_indices;
+		std::vector<float> m_bounds; // min xyz, max xyz
+
+		int m_threads;
+	};
+}
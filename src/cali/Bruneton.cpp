@@ -7,18 +7,45 @@
 #include <D3D11\IvTextureD3D11.h>
 #include <D3D11\IvRendererD3D11.h>
 
+#include "AtmosphereCache.h"
 #include "CommonFileSystem.h"
 
+#include <chrono>
+
 #include "shaders\BrunetonCommonDefs.h"
 
 namespace cali
 {
-	constexpr int SCATTERING_TEXTURE_WIDTH =
-		SCATTERING_TEXTURE_NU_SIZE * SCATTERING_TEXTURE_MU_S_SIZE;
-	constexpr int SCATTERING_TEXTURE_HEIGHT = SCATTERING_TEXTURE_MU_SIZE;
-	constexpr int SCATTERING_TEXTURE_DEPTH = SCATTERING_TEXTURE_R_SIZE;
-
 	constexpr int NUM_SCATTERING_ORDERS = 4;
+	constexpr bool COMPACT_SCATTERING = ATMOSPHERE_COMPACT_SCATTERING != 0;
+
+	namespace
+	{
+		size_t scattering_texel_count(const atmosphere::lut_sizes& sizes)
+		{
+			return (size_t)sizes.scattering_width() * sizes.scattering_height() * sizes.scattering_depth();
+		}
+
+		size_t texture_bytes(const IvRenderTexture* texture)
+		{
+			if (!texture) return 0;
+			return (size_t)texture->GetWidth() * texture->GetHeight() * (texture->Is3D() ? texture->GetDepth() : 1) *
+				sInternalTextureFormatSize[texture->GetFormat()];
+		}
+
+		std::vector<uint16_t> to_half(const std::vector<atmosphere::rgba>& texels)
+		{
+			std::vector<uint16_t> half(texels.size() * 4);
+			for (size_t i = 0; i < texels.size(); ++i)
+			{
+				half[i * 4 + 0] = atmosphere::float_to_half(texels[i].r);
+				half[i * 4 + 1] = atmosphere::float_to_half(texels[i].g);
+				half[i * 4 + 2] = atmosphere::float_to_half(texels[i].b);
+				half[i * 4 + 3] = atmosphere::float_to_half(texels[i].a);
+			}
+			return half;
+		}
+	}
 
 	void bruneton::initialize(IvRenderer& renderer)
 	{
@@ -80,35 +107,83 @@ namespace cali
 			!m_compute_scattering_density_shader || !m_compute_indirect_irradiance_shader || !m_compute_multiple_scattering_shader)
 			throw std::exception("sky: failed to load on of the shaders!");
 
-		m_transmittance_texture = std::unique_ptr<IvRenderTexture>(
-			renderer.GetResourceManager()->CreateRenderTexture(TRANSMITTANCE_TEXTURE_WIDTH, TRANSMITTANCE_TEXTURE_HEIGHT,
-				IvTextureFormat::kRGBAFloat16TexFmt));
+		// the shaders of the precompute, the sky and the terrain read the sizes
+		m_lut_sizes_cbuffer = resman.CreateConstantBuffer(sizeof(constant_buffer::AtmosphereLutSizes));
+		if (!m_lut_sizes_cbuffer.valid())
+			throw std::exception("sky: failed to create the lut sizes constant buffer!");
+		m_lut_sizes_cbuffer->transmittance_width = m_sizes.transmittance_width;
+		m_lut_sizes_cbuffer->transmittance_height = m_sizes.transmittance_height;
+		m_lut_sizes_cbuffer->irradiance_width = m_sizes.irradiance_width;
+		m_lut_sizes_cbuffer->irradiance_height = m_sizes.irradiance_height;
+		m_lut_sizes_cbuffer->scattering_r = m_sizes.scattering_r;
+		m_lut_sizes_cbuffer->scattering_mu = m_sizes.scattering_mu;
+		m_lut_sizes_cbuffer->scattering_mu_s = m_sizes.scattering_mu_s;
+		m_lut_sizes_cbuffer->scattering_nu = m_sizes.scattering_nu;
+		renderer.UpdateConstantBuffer(m_lut_sizes_cbuffer.ivcbuffer());
+		renderer.SetConstantBuffer(m_lut_sizes_cbuffer.ivcbuffer(), 3);
+
+		// and the parameters, earth's for the GPU passes
+		m_atmosphere_cbuffer = resman.CreateConstantBuffer(sizeof(constant_buffer::Atmosphere));
+		if (!m_atmosphere_cbuffer.valid())
+			throw std::exception("sky: failed to create the atmosphere constant buffer!");
+		set_atmosphere(renderer, atmosphere::earth_atmosphere());
+		renderer.SetConstantBuffer(m_atmosphere_cbuffer.ivcbuffer(), 5);
 
-		m_delta_irradiance_texture = std::unique_ptr<IvRenderTexture>(
-			renderer.GetResourceManager()->CreateRenderTexture(IRRADIANCE_TEXTURE_WIDTH, IRRADIANCE_TEXTURE_HEIGHT,
+		m_transmittance_texture = std::unique_ptr<IvRenderTexture>(
+			renderer.GetResourceManager()->CreateRenderTexture(m_sizes.transmittance_width, m_sizes.transmittance_height,
 				IvTextureFormat::kRGBAFloat16TexFmt));
 
 		m_irradiance_texture = std::unique_ptr<IvRenderTexture>(
-			renderer.GetResourceManager()->CreateRenderTexture(IRRADIANCE_TEXTURE_WIDTH, IRRADIANCE_TEXTURE_HEIGHT,
+			renderer.GetResourceManager()->CreateRenderTexture(m_sizes.irradiance_width, m_sizes.irradiance_height,
 				IvTextureFormat::kRGBAFloat16TexFmt));
 
 		m_scattering_texture = std::unique_ptr<IvRenderTexture>(
-			renderer.GetResourceManager()->CreateRenderTexture(SCATTERING_TEXTURE_WIDTH, SCATTERING_TEXTURE_HEIGHT,
-				SCATTERING_TEXTURE_DEPTH, IvTextureFormat::kRGBAFloat16TexFmt));
-
-		m_delta_rayleigh_scattering_texture = std::unique_ptr<IvRenderTexture>(
-			renderer.GetResourceManager()->CreateRenderTexture(SCATTERING_TEXTURE_WIDTH, SCATTERING_TEXTURE_HEIGHT,
-				SCATTERING_TEXTURE_DEPTH, IvTextureFormat::kRGBAFloat16TexFmt));
+			renderer.GetResourceManager()->CreateRenderTexture(m_sizes.scattering_width(), m_sizes.scattering_height(),
+				m_sizes.scattering_depth(), COMPACT_SCATTERING ? IvTextureFormat::kRGB9E5TexFmt : IvTextureFormat::kRGBAFloat16TexFmt));
 
-		m_delta_multiple_scattering_texture_ref = m_delta_rayleigh_scattering_texture.get();
+		if (COMPACT_SCATTERING)
+		{
+			m_single_mie_scattering_texture = std::unique_ptr<IvRenderTexture>(
+				renderer.GetResourceManager()->CreateRenderTexture(m_sizes.scattering_width(), m_sizes.scattering_height(),
+					m_sizes.scattering_depth(), IvTextureFormat::kFloat16Fmt));
+		}
+	}
 
-		m_delta_mie_scattering_texture = std::unique_ptr<IvRenderTexture>(
-			renderer.GetResourceManager()->CreateRenderTexture(SCATTERING_TEXTURE_WIDTH, SCATTERING_TEXTURE_HEIGHT,
-				SCATTERING_TEXTURE_DEPTH, IvTextureFormat::kRGBAFloat16TexFmt));
+	// The delta textures are only needed by the GPU passes; with compact
+	// scattering so is an RGBA16F scattering texture to render to.
+	void bruneton::acquire_intermediates(render_texture_pool& pool)
+	{
+		m_delta_irradiance_texture = pool.acquire(m_sizes.irradiance_width, m_sizes.irradiance_height, 0,
+			IvTextureFormat::kRGBAFloat16TexFmt);
+		m_delta_rayleigh_scattering_texture = pool.acquire(m_sizes.scattering_width(), m_sizes.scattering_height(),
+			m_sizes.scattering_depth(), IvTextureFormat::kRGBAFloat16TexFmt);
+		m_delta_multiple_scattering_texture_ref = m_delta_rayleigh_scattering_texture;
+		m_delta_mie_scattering_texture = pool.acquire(m_sizes.scattering_width(), m_sizes.scattering_height(),
+			m_sizes.scattering_depth(), IvTextureFormat::kRGBAFloat16TexFmt);
+		m_delta_scattering_density_texture = pool.acquire(m_sizes.scattering_width(), m_sizes.scattering_height(),
+			m_sizes.scattering_depth(), IvTextureFormat::kRGBAFloat16TexFmt);
+		m_scattering_target = COMPACT_SCATTERING ? pool.acquire(m_sizes.scattering_width(), m_sizes.scattering_height(),
+			m_sizes.scattering_depth(), IvTextureFormat::kRGBAFloat16TexFmt) : m_scattering_texture.get();
+
+		if (!m_delta_irradiance_texture || !m_delta_rayleigh_scattering_texture || !m_delta_mie_scattering_texture ||
+			!m_delta_scattering_density_texture || !m_scattering_target)
+			throw std::exception("sky: failed to create the precompute textures!");
+	}
 
-		m_delta_scattering_density_texture = std::unique_ptr<IvRenderTexture>(
-			renderer.GetResourceManager()->CreateRenderTexture(SCATTERING_TEXTURE_WIDTH, SCATTERING_TEXTURE_HEIGHT,
-				SCATTERING_TEXTURE_DEPTH, IvTextureFormat::kRGBAFloat16TexFmt));
+	void bruneton::release_intermediates(render_texture_pool& pool)
+	{
+		pool.release(m_delta_irradiance_texture);
+		pool.release(m_delta_rayleigh_scattering_texture);
+		pool.release(m_delta_mie_scattering_texture);
+		pool.release(m_delta_scattering_density_texture);
+		if (m_scattering_target != m_scattering_texture.get()) pool.release(m_scattering_target);
+
+		m_delta_irradiance_texture = nullptr;
+		m_delta_rayleigh_scattering_texture = nullptr;
+		m_delta_multiple_scattering_texture_ref = nullptr;
+		m_delta_mie_scattering_texture = nullptr;
+		m_delta_scattering_density_texture = nullptr;
+		m_scattering_target = nullptr;
 	}
 
 	void bruneton::compute_transmittance(IvRenderer & renderer)
@@ -124,7 +199,7 @@ namespace cali
 	{
 		renderer.SetBlendFunc(kOneBlendFunc, kZeroBlendFunc, kAddBlendOp);
 		renderer.SetViewPort(m_delta_irradiance_texture->GetWidth(), m_delta_irradiance_texture->GetHeight());
-		renderer.SetRenderTarget(m_delta_irradiance_texture.get(), true);
+		renderer.SetRenderTarget(m_delta_irradiance_texture, true);
 		m_compute_direct_irradiance_shader->GetUniform("transmittance_texture")->SetValue(m_transmittance_texture.get());
 		m_quad.render(renderer, m_compute_direct_irradiance_shader);
 		renderer.ReleaseRenderTarget();
@@ -134,19 +209,19 @@ namespace cali
 	void bruneton::compute_single_scattering(IvRenderer & renderer)
 	{
 		renderer.SetBlendFunc(kOneBlendFunc, kZeroBlendFunc, kAddBlendOp);
-		renderer.SetViewPort(m_scattering_texture->GetWidth(), m_scattering_texture->GetHeight());
+		renderer.SetViewPort(m_scattering_target->GetWidth(), m_scattering_target->GetHeight());
 		m_compute_single_scattering_shader->GetUniform("transmittance_texture")->SetValue(m_transmittance_texture.get());
 
-		for (unsigned int layer = 0; layer < m_scattering_texture->GetDepth(); ++layer)
+		for (unsigned int layer = 0; layer < m_scattering_target->GetDepth(); ++layer)
 		{
 			m_delta_rayleigh_scattering_texture->Set3DSlice(layer);
 			m_delta_mie_scattering_texture->Set3DSlice(layer);
-			m_scattering_texture->Set3DSlice(layer);
+			m_scattering_target->Set3DSlice(layer);
 			// Build a vector with view. Note that the order _matters_
 			std::vector<IvRenderTexture*> render_textures;
-			render_textures.push_back(m_delta_rayleigh_scattering_texture.get());
-			render_textures.push_back(m_delta_mie_scattering_texture.get());
-			render_textures.push_back(m_scattering_texture.get());
+			render_textures.push_back(m_delta_rayleigh_scattering_texture);
+			render_textures.push_back(m_delta_mie_scattering_texture);
+			render_textures.push_back(m_scattering_target);
 
 			renderer.SetRenderTargets(render_textures, true);
 
@@ -160,7 +235,7 @@ namespace cali
 		// Reset view
 		m_delta_rayleigh_scattering_texture->Set3DSlice(0);
 		m_delta_mie_scattering_texture->Set3DSlice(0);
-		m_scattering_texture->Set3DSlice(0);
+		m_scattering_target->Set3DSlice(0);
 	}
 
 	// Compute the scattering density, and store it in
@@ -173,20 +248,20 @@ namespace cali
 		m_compute_scattering_density_shader->GetUniform("transmittance_texture")->SetValue(
 			m_transmittance_texture.get());
 		m_compute_scattering_density_shader->GetUniform("single_rayleigh_scattering_texture")->SetValue(
-			m_delta_rayleigh_scattering_texture.get());
+			m_delta_rayleigh_scattering_texture);
 		m_compute_scattering_density_shader->GetUniform("single_mie_scattering_texture")->SetValue(
-			m_delta_mie_scattering_texture.get());
+			m_delta_mie_scattering_texture);
 		m_compute_scattering_density_shader->GetUniform("multiple_scattering_texture")->SetValue(
 			m_delta_multiple_scattering_texture_ref);
 		m_compute_scattering_density_shader->GetUniform("irradiance_texture")->SetValue(
-			m_delta_irradiance_texture.get());
+			m_delta_irradiance_texture);
 
 		m_compute_scattering_density_shader->GetUniform("scattering_order")->SetValue((float)scattering_order, 0);
 
-		for (unsigned int layer = 0; layer < SCATTERING_TEXTURE_DEPTH; ++layer)
+		for (unsigned int layer = 0; layer < m_delta_scattering_density_texture->GetDepth(); ++layer)
 		{
 			m_delta_scattering_density_texture->Set3DSlice(layer);
-			renderer.SetRenderTarget(m_delta_scattering_density_texture.get(), true);
+			renderer.SetRenderTarget(m_delta_scattering_density_texture, true);
 			m_compute_scattering_density_shader->GetUniform("layer")->SetValue((float)layer, 0);
 			m_quad.render(renderer, m_compute_scattering_density_shader);
 		}
@@ -208,18 +283,18 @@ namespace cali
 		renderer.SetViewPort(m_delta_irradiance_texture->GetWidth(), m_delta_irradiance_texture->GetHeight());
 
 		m_compute_indirect_irradiance_shader->GetUniform("single_rayleigh_scattering_texture")->SetValue(
-			m_delta_rayleigh_scattering_texture.get());
+			m_delta_rayleigh_scattering_texture);
 		m_compute_indirect_irradiance_shader->GetUniform("single_mie_scattering_texture")->SetValue(
-			m_delta_mie_scattering_texture.get());
+			m_delta_mie_scattering_texture);
 		m_compute_indirect_irradiance_shader->GetUniform("multiple_scattering_texture")->SetValue(
 			m_delta_multiple_scattering_texture_ref);
 
 		m_compute_indirect_irradiance_shader->GetUniform("scattering_order")->SetValue((float)scattering_order, 0);
 
-		renderer.ClearRenderTarget(m_delta_irradiance_texture.get(), IvClearBuffer::kColorClear, { 0.0f, 0.0f, 0.0f, 0.0f });
+		renderer.ClearRenderTarget(m_delta_irradiance_texture, IvClearBuffer::kColorClear, { 0.0f, 0.0f, 0.0f, 0.0f });
 
 		std::vector<IvRenderTexture*> render_textures;
-		render_textures.push_back(m_delta_irradiance_texture.get());
+		render_textures.push_back(m_delta_irradiance_texture);
 		render_textures.push_back(m_irradiance_texture.get());
 
 		renderer.SetRenderTargets(render_textures, true);
@@ -236,25 +311,25 @@ namespace cali
 	void bruneton::compute_multiple_scattering(IvRenderer & renderer, size_t scattering_order)
 	{
 		renderer.SetBlendFunc(kOneBlendFunc, kOneBlendFunc, kAddBlendOp);
-		renderer.SetViewPort(m_scattering_texture->GetWidth(), m_scattering_texture->GetHeight());
+		renderer.SetViewPort(m_scattering_target->GetWidth(), m_scattering_target->GetHeight());
 
 		m_compute_multiple_scattering_shader->GetUniform("transmittance_texture")->SetValue(
 			m_transmittance_texture.get());
 
 		m_compute_multiple_scattering_shader->GetUniform("scattering_density_texture")->SetValue(
-			m_delta_scattering_density_texture.get());
+			m_delta_scattering_density_texture);
 
-		for (unsigned int layer = 0; layer < m_scattering_texture->GetDepth(); ++layer)
+		for (unsigned int layer = 0; layer < m_scattering_target->GetDepth(); ++layer)
 		{
 			m_delta_multiple_scattering_texture_ref->Set3DSlice(layer);
-			m_scattering_texture->Set3DSlice(layer);
+			m_scattering_target->Set3DSlice(layer);
 
 			renderer.ClearRenderTarget(m_delta_multiple_scattering_texture_ref, IvClearBuffer::kColorClear, { 0.0f, 0.0f, 0.0f, 0.0f });
 
 			// Build a vector with view. Note that the order _matters_
 			std::vector<IvRenderTexture*> render_textures;
 			render_textures.push_back(m_delta_multiple_scattering_texture_ref);
-			render_textures.push_back(m_scattering_texture.get());
+			render_textures.push_back(m_scattering_target);
 
 			renderer.SetRenderTargets(render_textures, true);
 
@@ -278,23 +353,157 @@ namespace cali
 		}
 	}
 
-	void bruneton::precompute(IvRenderer& renderer)
+	// RGBA16F texels of the combined scattering texture, converted when compact
+	bool bruneton::upload_scattering(const uint16_t* half_texels)
+	{
+		if (!COMPACT_SCATTERING) return m_scattering_texture->LoadData(half_texels);
+
+		const size_t texel_count = scattering_texel_count(m_sizes);
+		std::vector<uint32_t> rgb(texel_count);
+		std::vector<uint16_t> mie_red(texel_count);
+		atmosphere::compact_scattering(half_texels, texel_count, rgb.data(), mie_red.data());
+		return m_scattering_texture->LoadData(rgb.data()) && m_single_mie_scattering_texture->LoadData(mie_red.data());
+	}
+
+	void bruneton::set_atmosphere(IvRenderer& renderer, const atmosphere::atmosphere_parameters& atmosphere)
+	{
+		auto spectrum = [](const atmosphere::rgba& c) { return IvVector3(c.r, c.g, c.b); };
+		m_atmosphere_cbuffer->solar_irradiance = spectrum(atmosphere.solar_irradiance);
+		m_atmosphere_cbuffer->sun_angular_radius = atmosphere.sun_angular_radius;
+		m_atmosphere_cbuffer->bottom_radius = atmosphere.bottom_radius;
+		m_atmosphere_cbuffer->top_radius = atmosphere.top_radius;
+		m_atmosphere_cbuffer->rayleigh_scale_height = atmosphere.rayleigh_scale_height;
+		m_atmosphere_cbuffer->rayleigh_scattering = spectrum(atmosphere.rayleigh_scattering);
+		m_atmosphere_cbuffer->mie_scale_height = atmosphere.mie_scale_height;
+		m_atmosphere_cbuffer->mie_scattering = spectrum(atmosphere.mie_scattering);
+		m_atmosphere_cbuffer->mie_extinction = spectrum(atmosphere.mie_extinction);
+		m_atmosphere_cbuffer->mie_phase_function_g = atmosphere.mie_phase_function_g;
+		m_atmosphere_cbuffer->ground_albedo = spectrum(atmosphere.ground_albedo);
+		m_atmosphere_cbuffer->mu_s_min = atmosphere.mu_s_min;
+		renderer.UpdateConstantBuffer(m_atmosphere_cbuffer.ivcbuffer());
+	}
+
+	bool bruneton::load_cached_luts(const asset_cache& cache)
+	{
+		atmosphere::mapped_luts luts;
+		if (!atmosphere::load_luts(cache, atmosphere::earth_atmosphere(), m_sizes, NUM_SCATTERING_ORDERS, luts))
+			return false;
+
+		if (!m_transmittance_texture->LoadData(luts.transmittance()) ||
+			!upload_scattering(luts.scattering()) ||
+			!m_irradiance_texture->LoadData(luts.irradiance()))
+			return false;
+
+		auto cpu_luts = std::make_shared<atmosphere::luts>();
+		atmosphere::unpack_luts(luts, *cpu_luts);
+		adopt_luts(std::move(cpu_luts));
+		return true;
+	}
+
+	void bruneton::set_query(const atmosphere::atmosphere_parameters& atmosphere, std::shared_ptr<const atmosphere::luts> luts)
 	{
+		std::atomic_store(&m_query, std::shared_ptr<const atmosphere::atmosphere_query>(
+			std::make_shared<atmosphere::atmosphere_query>(atmosphere, std::move(luts))));
+	}
+
+	bool bruneton::read_back_luts(atmosphere::luts& out)
+	{
+		std::vector<uint16_t> transmittance((size_t)m_sizes.transmittance_width * m_sizes.transmittance_height * 4);
+		std::vector<uint16_t> scattering(scattering_texel_count(m_sizes) * 4);
+		std::vector<uint16_t> irradiance((size_t)m_sizes.irradiance_width * m_sizes.irradiance_height * 4);
+		if (!m_transmittance_texture->ReadData(transmittance.data()) ||
+			!m_scattering_target->ReadData(scattering.data()) ||
+			!m_irradiance_texture->ReadData(irradiance.data()))
+			return false;
+		if (COMPACT_SCATTERING && !upload_scattering(scattering.data()))
+			return false;
+		atmosphere::unpack_luts(m_sizes, transmittance.data(), scattering.data(), irradiance.data(), out);
+		return true;
+	}
+
+	void bruneton::write_luts_in_background(const asset_cache& cache, std::shared_ptr<const atmosphere::luts> luts)
+	{
+		if (!cache.enabled()) return;
+		m_cache_writer = std::thread([cache, luts]()
+		{
+			atmosphere::store_luts(cache, atmosphere::earth_atmosphere(), *luts, NUM_SCATTERING_ORDERS);
+		});
+	}
+
+	void bruneton::precompute(IvRenderer& renderer, render_texture_pool& transient_textures, const asset_cache& cache)
+	{
+		const auto start = std::chrono::steady_clock::now();
 		initialize(renderer);
+		m_resident_bytes = texture_bytes(m_transmittance_texture.get()) + texture_bytes(m_irradiance_texture.get()) +
+			texture_bytes(m_scattering_texture.get()) + texture_bytes(m_single_mie_scattering_texture.get());
+		m_peak_bytes = m_resident_bytes;
 
-		auto& resman = *renderer.GetResourceManager();
-		auto& d3d11renderer = static_cast<IvRendererD3D11&>(renderer);
+		m_from_cache = load_cached_luts(cache);
+		if (!m_from_cache)
+		{
+			unsigned int previous_width = renderer.GetWidth();
+			unsigned int previous_height = renderer.GetHeight();
+			const size_t pooled_bytes = transient_textures.in_use_bytes();
+			acquire_intermediates(transient_textures);
+			m_peak_bytes += transient_textures.in_use_bytes() - pooled_bytes;
+
+			// WARNING: the order of calls matters
+
+			compute_transmittance(renderer);
+			compute_direct_irradiance(renderer);
+			compute_single_scattering(renderer);
+			compute_oders(renderer);
+
+			renderer.SetViewPort(previous_width, previous_height);
+
+			// the same texels go to the cache and to the CPU queries; with
+			// compact scattering they are also converted from here
+			auto luts = std::make_shared<atmosphere::luts>();
+			if (!read_back_luts(*luts))
+				throw std::exception("sky: failed to read back the precomputed textures!");
+			release_intermediates(transient_textures);
+			adopt_luts(luts);
+			write_luts_in_background(cache, std::move(luts));
+		}
+
+		m_precompute_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// the LUTs in the textures, of earth_atmosphere() like the cbuffer
+	void bruneton::adopt_luts(std::shared_ptr<const atmosphere::luts> luts)
+	{
+		m_scheduler.adopt(atmosphere::earth_atmosphere(), luts);
+		m_uploaded = luts;
+		set_query(atmosphere::earth_atmosphere(), std::move(luts));
+	}
 
-		unsigned int previous_width = renderer.GetWidth();
-		unsigned int previous_height = renderer.GetHeight();
+	bool bruneton::upload_luts(const atmosphere::luts& luts)
+	{
+		return m_transmittance_texture->LoadData(to_half(luts.transmittance.texels).data()) &&
+			upload_scattering(to_half(luts.scattering.texels).data()) &&
+			m_irradiance_texture->LoadData(to_half(luts.irradiance.texels).data());
+	}
 
-		// WARNING: the order of calls matters
+	// the scheduler's set when it is not the one in the textures: the analytic
+	// stand-in of another planet, or a completed set
+	bool bruneton::upload_current(IvRenderer& renderer)
+	{
+		std::shared_ptr<const atmosphere::luts> current = m_scheduler.current();
+		if (current == m_uploaded || !upload_luts(*current)) return false;
+		m_uploaded = current;
+		set_atmosphere(renderer, m_scheduler.current_atmosphere());
+		set_query(m_scheduler.current_atmosphere(), std::move(current));
+		return true;
+	}
 
-		compute_transmittance(renderer);
-		compute_direct_irradiance(renderer);
-		compute_single_scattering(renderer);
-		compute_oders(renderer);
+	void bruneton::recompute(IvRenderer& renderer, const atmosphere::atmosphere_parameters& atmosphere)
+	{
+		m_scheduler.begin(atmosphere, m_sizes, NUM_SCATTERING_ORDERS);
+		upload_current(renderer);
+	}
 
-		renderer.SetViewPort(previous_width, previous_height);
+	bool bruneton::update(IvRenderer& renderer, double budget_ms)
+	{
+		return m_scheduler.update(budget_ms) && upload_current(renderer);
 	}
-}
\ No newline at end of file
+}
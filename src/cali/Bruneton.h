@@ -3,6 +3,15 @@
 #include "Renderable.h"
 #include "Model.h"
 #include "IvRenderTexture.h"
+#include "AssetCache.h"
+#include "Atmosphere.h"
+#include "AtmosphereQuery.h"
+#include "RenderTexturePool.h"
+#include "ConstantBuffer.h"
+#include "ConstantBufferWrapper.h"
+
+#include <atomic>
+#include <thread>
 
 namespace cali
 {
@@ -10,14 +19,25 @@ namespace cali
 	{
 		cali::model<kTNPFormat, IvTNPVertex> m_quad;
 
+		// of every LUT texture, for the shaders in m_lut_sizes_cbuffer (b3)
+		const atmosphere::lut_sizes m_sizes;
+		constant_buffer_wrapper<constant_buffer::AtmosphereLutSizes> m_lut_sizes_cbuffer;
+		// parameters of the LUTs in the textures, ATMOSPHERE of the shaders (b5)
+		constant_buffer_wrapper<constant_buffer::Atmosphere> m_atmosphere_cbuffer;
+		void set_atmosphere(IvRenderer& renderer, const atmosphere::atmosphere_parameters& atmosphere);
+
 		std::unique_ptr<IvRenderTexture> m_transmittance_texture;
-		std::unique_ptr<IvRenderTexture> m_delta_irradiance_texture;
 		std::unique_ptr<IvRenderTexture> m_irradiance_texture; // TODO: shold be filled with zeroes?; aka delta_irradiance_texture
-		std::unique_ptr<IvRenderTexture> m_scattering_texture;
-		std::unique_ptr<IvRenderTexture> m_delta_rayleigh_scattering_texture; // aka single_rayleigh_scattering_texture and delta_multiple_scattering_texture
-		std::unique_ptr<IvRenderTexture> m_delta_mie_scattering_texture; // aka single_mie_scattering_texture
-		std::unique_ptr<IvRenderTexture> m_delta_scattering_density_texture;
+		std::unique_ptr<IvRenderTexture> m_scattering_texture; // RGB9E5 with ATMOSPHERE_COMPACT_SCATTERING
+		std::unique_ptr<IvRenderTexture> m_single_mie_scattering_texture; // ATMOSPHERE_COMPACT_SCATTERING only
+
+		// from the transient pool, only while the GPU precomputes
+		IvRenderTexture* m_delta_irradiance_texture;
+		IvRenderTexture* m_delta_rayleigh_scattering_texture; // aka single_rayleigh_scattering_texture and delta_multiple_scattering_texture
+		IvRenderTexture* m_delta_mie_scattering_texture; // aka single_mie_scattering_texture
+		IvRenderTexture* m_delta_scattering_density_texture;
 		IvRenderTexture* m_delta_multiple_scattering_texture_ref;
+		IvRenderTexture* m_scattering_target; // m_scattering_texture, or RGBA16F read back when compact
 
 		IvShaderProgram* m_compute_transmittance_shader;
 		IvShaderProgram* m_compute_direct_irradiance_shader;
@@ -35,30 +55,99 @@ namespace cali
 		void compute_multiple_scattering(IvRenderer& renderer, size_t scattering_order);
 
 		void initialize(IvRenderer& renderer);
+		void acquire_intermediates(render_texture_pool& pool);
+		void release_intermediates(render_texture_pool& pool);
+		bool upload_scattering(const uint16_t* half_texels);
+		bool load_cached_luts(const asset_cache& cache);
+		bool read_back_luts(atmosphere::luts& out);
+		void write_luts_in_background(const asset_cache& cache, std::shared_ptr<const atmosphere::luts> luts);
+
+		// cold start: the GPU computes the LUTs, they are read back once and
+		// written to the cache for the next start, off the main thread
+		std::thread m_cache_writer;
+		double m_precompute_ms;
+		bool m_from_cache;
+		size_t m_resident_bytes;
+		size_t m_peak_bytes;
+
+		// The LUTs of precompute() are adopted by the scheduler; recompute()
+		// computes new ones on the CPU a few rows per frame, and the textures
+		// follow its current set (m_uploaded): the previous one, or the
+		// analytic one of another planet, until the new set is complete.
+		atmosphere::lut_scheduler m_scheduler;
+		std::shared_ptr<const atmosphere::luts> m_uploaded;
+		void adopt_luts(std::shared_ptr<const atmosphere::luts> luts);
+		bool upload_luts(const atmosphere::luts& luts);
+		bool upload_current(IvRenderer& renderer);
+
+		// CPU copy of the LUTs in the textures; null until precompute() has run
+		std::shared_ptr<const atmosphere::atmosphere_query> m_query;
+		void set_query(const atmosphere::atmosphere_parameters& atmosphere, std::shared_ptr<const atmosphere::luts> luts);
 
 		bruneton(const bruneton&) = delete;
 		bruneton& operator=(const bruneton&) = delete;
 
 	public:
-		bruneton() :
+		explicit bruneton(const atmosphere::lut_sizes& sizes = atmosphere::lut_sizes()) :
+			m_sizes(sizes),
 			m_compute_transmittance_shader(nullptr),
 			m_compute_direct_irradiance_shader(nullptr),
 			m_compute_single_scattering_shader(nullptr),
 			m_compute_scattering_density_shader(nullptr),
 			m_compute_indirect_irradiance_shader(nullptr),
 			m_compute_multiple_scattering_shader(nullptr),
-			m_delta_multiple_scattering_texture_ref(nullptr)
+			m_delta_irradiance_texture(nullptr),
+			m_delta_rayleigh_scattering_texture(nullptr),
+			m_delta_mie_scattering_texture(nullptr),
+			m_delta_scattering_density_texture(nullptr),
+			m_delta_multiple_scattering_texture_ref(nullptr),
+			m_scattering_target(nullptr),
+			m_precompute_ms(0.0),
+			m_from_cache(false),
+			m_resident_bytes(0),
+			m_peak_bytes(0)
 		{
 		}
 
 		~bruneton()
 		{
+			if (m_cache_writer.joinable()) m_cache_writer.join();
 		}
 
+		const atmosphere::lut_sizes& lut_sizes() const { return m_sizes; }
+
 		IvRenderTexture* get_transmittance_texture() { return m_transmittance_texture.get(); }
 		IvRenderTexture* get_scattering_texture() { return m_scattering_texture.get(); }
 		IvRenderTexture* get_irradiance_texture() { return m_irradiance_texture.get(); }
+		// null unless ATMOSPHERE_COMPACT_SCATTERING
+		IvRenderTexture* get_single_mie_scattering_texture() { return m_single_mie_scattering_texture.get(); }
+
+		// Loads the LUTs from `cache` when it has them for the current
+		// atmosphere and texture sizes, computes them otherwise. The
+		// intermediate textures of the GPU passes come from `transient_textures`
+		// and go back to it before returning.
+		void precompute(IvRenderer& renderer, render_texture_pool& transient_textures, const asset_cache& cache = asset_cache());
+
+		// Wall time of precompute() and whether it was a cache hit (warm start).
+		double precompute_ms() const { return m_precompute_ms; }
+		bool loaded_from_cache() const { return m_from_cache; }
+		// GPU memory of the LUTs kept for rendering, and of all the atmosphere
+		// textures while precompute() ran.
+		size_t resident_bytes() const { return m_resident_bytes; }
+		size_t peak_bytes() const { return m_peak_bytes; }
+
+		// Recomputes the LUTs for new atmosphere parameters without stalling a
+		// frame: update() advances the work within a time budget, and the
+		// three textures, the Atmosphere cbuffer and query() are replaced
+		// together in the frame it completes.
+		void recompute(IvRenderer& renderer, const atmosphere::atmosphere_parameters& atmosphere);
+		// True in the frame the new LUTs were uploaded.
+		bool update(IvRenderer& renderer, double budget_ms);
+		bool is_recomputing() const { return m_scheduler.is_pending(); }
+		float recompute_progress() const { return m_scheduler.progress(); }
 
-		void precompute(IvRenderer& renderer);
+		// Sky and sun values of the current LUTs on the CPU. Null until
+		// precompute() has run.
+		std::shared_ptr<const atmosphere::atmosphere_query> query() const { return std::atomic_load(&m_query); }
 	};
 }
\ No newline at end of file
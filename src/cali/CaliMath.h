@@ -1,4 +1,6 @@
 #pragma once
+#include <IvDoubleVector3.h>
+
 #include <cmath>
 
 namespace cali
@@ -6,13 +8,13 @@ namespace cali
 	namespace Math
 	{
 		template<typename T, typename CT>
-		inline T lerp(const T& a, const T& b, CT f)
+		inline constexpr T lerp(const T& a, const T& b, CT f)
 		{
 			return a + f * (b - a);
 		}
 
 		template<typename T, typename CT>
-		T quad_lerp(const T& a, const T& b, const T& c, const T& d, CT u, CT v)
+		constexpr T quad_lerp(const T& a, const T& b, const T& c, const T& d, CT u, CT v)
 		{
 			// Given a (u,v) coordinate that defines a 2D local position inside a planar quadrilateral, find the
 			// absolute 3D (x,y,z) coordinate at that location.
@@ -39,5 +41,19 @@ namespace cali
 			T dcu = lerp(d, c, u);
 			return lerp(abu, dcu, v);
 		}
+
+		// The fused IvDoubleVector3 kernels: the same bits as the templates,
+		// without the vector temporaries (which even an optimized build keeps
+		// when it does not inline the chain)
+		inline constexpr IvDoubleVector3 lerp(const IvDoubleVector3& a, const IvDoubleVector3& b, double f)
+		{
+			return Lerp(a, b, f);
+		}
+
+		inline constexpr IvDoubleVector3 quad_lerp(const IvDoubleVector3& a, const IvDoubleVector3& b,
+			const IvDoubleVector3& c, const IvDoubleVector3& d, double u, double v)
+		{
+			return QuadLerp(a, b, c, d, u, v);
+		}
 	}
 }
\ No newline at end of file
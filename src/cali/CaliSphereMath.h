@@ -1,7 +1,10 @@
 #pragma once
+#include <IvMath.h>
 #include <IvDoubleVector3.h>
 #include <IvVector3.h>
 
+#include <cmath>
+
 namespace cali
 {
 	namespace Math
@@ -160,7 +163,7 @@ namespace cali
 		// -----------------------------------------------------------------
 		enum class CubeFace : int { PosY = 0, NegY = 1, PosX = 2, NegX = 3, PosZ = 4, NegZ = 5 };
 
-		inline IvDoubleVector3 rotate_top_to_face(const IvDoubleVector3& v, CubeFace face)
+		inline constexpr IvDoubleVector3 rotate_top_to_face(const IvDoubleVector3& v, CubeFace face)
 		{
 			switch (face)
 			{
@@ -174,7 +177,7 @@ namespace cali
 			}
 		}
 
-		inline IvDoubleVector3 rotate_face_to_top(const IvDoubleVector3& v, CubeFace face)
+		inline constexpr IvDoubleVector3 rotate_face_to_top(const IvDoubleVector3& v, CubeFace face)
 		{
 			// inverse of rotate_top_to_face
 			switch (face)
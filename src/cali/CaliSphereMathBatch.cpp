@@ -0,0 +1,210 @@
+#include "CaliSphereMathBatch.h"
+
+#include <IvVector3Batch.h>
+
+namespace cali
+{
+namespace Math
+{
+	namespace
+	{
+		typedef IvDouble4 lanes;
+		typedef IvDoubleVector3x4 vector_lanes;
+		const size_t c_width = lanes::Width;
+
+		// Taylor series of sin(a) / a and cos(a) in a^2; for |a| <= pi/4 the first
+		// omitted terms, (pi/4)^17/17! and (pi/4)^18/18!, are below 1e-17
+		const double c_sin[] = { 1.0, -1.0 / 6.0, 1.0 / 120.0, -1.0 / 5040.0, 1.0 / 362880.0, -1.0 / 39916800.0,
+			1.0 / 6227020800.0, -1.0 / 1307674368000.0 };
+		const double c_cos[] = { 1.0, -1.0 / 2.0, 1.0 / 24.0, -1.0 / 720.0, 1.0 / 40320.0, -1.0 / 3628800.0,
+			1.0 / 479001600.0, -1.0 / 87178291200.0, 1.0 / 20922789888000.0 };
+		// Taylor series of atan(t) / t in t^2; after the three halvings in
+		// atan_lanes() |t| <= tan(pi/16), where the first omitted term is below 1e-16
+		const double c_atan[] = { 1.0, -1.0 / 3.0, 1.0 / 5.0, -1.0 / 7.0, 1.0 / 9.0, -1.0 / 11.0, 1.0 / 13.0,
+			-1.0 / 15.0, 1.0 / 17.0, -1.0 / 19.0 };
+
+		// c[0] + c[1] z + c[2] z^2 + ..., Horner's rule
+		template <size_t N>
+		lanes polynomial(const lanes& z, const double (&c)[N])
+		{
+			lanes result(c[N - 1]);
+			for (size_t i = N - 1; i-- > 0;) result = result * z + lanes(c[i]);
+			return result;
+		}
+
+		// |a| <= pi/4
+		lanes sin_lanes(const lanes& a) { return a * polynomial(a * a, c_sin); }
+		lanes cos_lanes(const lanes& a) { return polynomial(a * a, c_cos); }
+
+		// Any t: atan(t) = 2 atan(t / (1 + sqrt(1 + t^2))) three times brings
+		// |atan(t)| < pi/2 down to pi/16
+		lanes atan_lanes(lanes t)
+		{
+			const lanes one(1.0);
+			for (int i = 0; i < 3; ++i) t = t / (one + Sqrt(one + t * t));
+			return lanes(8.0) * t * polynomial(t * t, c_atan);
+		}
+
+		// Count < c_width values, the last one repeated into the other lanes
+		lanes load(const double* values, size_t count)
+		{
+			double padded[c_width];
+			for (size_t i = 0; i < c_width; ++i) padded[i] = values[i < count ? i : count - 1];
+			return lanes::Load(padded);
+		}
+
+		void store(const lanes& l, double* values, size_t count)
+		{
+			double padded[c_width];
+			l.Store(padded);
+			for (size_t i = 0; i < count; ++i) values[i] = padded[i];
+		}
+
+		// Unit vectors of the top face. adjusted_cube_to_sphere() puts (x, y) at
+		// longitude a = pi/4 x/R and latitude atan(tan(b) cos a), b = pi/4 y/R,
+		// which is the direction of (tan a, 1, tan b). Scaled by cos a cos b > 0
+		// that needs no division: (sin a cos b, cos a cos b, cos a sin b).
+		vector_lanes top_face_normals(const lanes& x, const lanes& y, double sphere_radius)
+		{
+			const lanes scale(kPI / 4.0 / sphere_radius);
+			const lanes a = x * scale, b = y * scale;
+			const lanes sin_a = sin_lanes(a), cos_a = cos_lanes(a);
+			const lanes sin_b = sin_lanes(b), cos_b = cos_lanes(b);
+
+			vector_lanes normal(sin_a * cos_b, cos_a * cos_b, cos_a * sin_b);
+			normal.Normalize();
+			return normal;
+		}
+
+		// rotate_top_to_face() for lanes; negation by -1 keeps the sign of zero
+		vector_lanes rotate_top_to_face(const vector_lanes& v, CubeFace face)
+		{
+			const lanes minus_one(-1.0);
+			switch (face)
+			{
+			case CubeFace::PosY: return v;
+			case CubeFace::NegY: return vector_lanes(v.x, minus_one * v.y, minus_one * v.z);
+			case CubeFace::PosX: return vector_lanes(v.y, minus_one * v.x, v.z);
+			case CubeFace::NegX: return vector_lanes(minus_one * v.y, v.x, v.z);
+			case CubeFace::PosZ: return vector_lanes(v.x, minus_one * v.z, v.y);
+			case CubeFace::NegZ: return vector_lanes(v.x, v.z, minus_one * v.y);
+			default: return v;
+			}
+		}
+
+		void map_to_sphere(CubeFace face, const lanes& x, const lanes& y, double sphere_radius,
+			const vector_lanes& center, IvDoubleVector3* positions, IvDoubleVector3* normals, unsigned int count)
+		{
+			const vector_lanes normal = rotate_top_to_face(top_face_normals(x, y, sphere_radius), face);
+			(normal * sphere_radius + center).Store(positions, count);
+			normal.Store(normals, count);
+		}
+
+		void cube_face_to_sphere(CubeFace face, const double* x, const double* y, size_t count, double sphere_radius,
+			const IvDoubleVector3& sphere_center, IvDoubleVector3* positions, IvDoubleVector3* normals)
+		{
+			const vector_lanes center(sphere_center.x, sphere_center.y, sphere_center.z);
+			size_t i = 0;
+			for (; i + c_width <= count; i += c_width)
+			{
+				map_to_sphere(face, lanes::Load(x + i), lanes::Load(y + i), sphere_radius, center,
+					positions + i, normals + i, (unsigned int)c_width);
+			}
+			if (i < count)
+			{
+				map_to_sphere(face, load(x + i, count - i), load(y + i, count - i), sphere_radius, center,
+					positions + i, normals + i, (unsigned int)(count - i));
+			}
+		}
+
+		// adjusted_sphere_to_cube(): y = atan(tan(theta) / cos(phi)), with the
+		// tangent as sin / cos of theta from its half angle
+		void sphere_to_cube(const lanes& phi, const lanes& theta, double sphere_radius, lanes& x, lanes& y)
+		{
+			const lanes scale(4.0 / kPI * sphere_radius);
+			const lanes half = theta * lanes(0.5);
+			const lanes sin_half = sin_lanes(half), cos_half = cos_lanes(half);
+			const lanes sin_theta = lanes(2.0) * sin_half * cos_half;
+			const lanes cos_theta = cos_half * cos_half - sin_half * sin_half;
+
+			x = phi * scale;
+			y = atan_lanes(sin_theta / (cos_theta * cos_lanes(phi))) * scale;
+		}
+	}
+
+	void adjusted_cube_to_sphere_batch(const double* x, const double* y, size_t count, double sphere_radius,
+		const IvDoubleVector3& sphere_center, IvDoubleVector3* positions, IvDoubleVector3* normals)
+	{
+		cube_face_to_sphere(CubeFace::PosY, x, y, count, sphere_radius, sphere_center, positions, normals);
+	}
+
+	void adjusted_cube_to_sphere_face_batch(CubeFace face, const double* x, const double* y, size_t count,
+		double sphere_radius, const IvDoubleVector3& sphere_center, IvDoubleVector3* positions, IvDoubleVector3* normals)
+	{
+		cube_face_to_sphere(face, x, y, count, sphere_radius, sphere_center, positions, normals);
+	}
+
+	void adjusted_sphere_to_cube_batch(const double* phi, const double* theta, size_t count, double sphere_radius,
+		double* x, double* y)
+	{
+		size_t i = 0;
+		lanes lx, ly;
+		for (; i + c_width <= count; i += c_width)
+		{
+			sphere_to_cube(lanes::Load(phi + i), lanes::Load(theta + i), sphere_radius, lx, ly);
+			lx.Store(x + i);
+			ly.Store(y + i);
+		}
+		if (i < count)
+		{
+			sphere_to_cube(load(phi + i, count - i), load(theta + i, count - i), sphere_radius, lx, ly);
+			store(lx, x + i, count - i);
+			store(ly, y + i, count - i);
+		}
+	}
+
+	bool world_to_cube_face_batch(const IvDoubleVector3* world_pos, size_t count, const IvDoubleVector3& sphere_center,
+		double sphere_radius, CubeFace* out_face, double* out_x, double* out_y)
+	{
+		// In the face's top space +Y is the largest component, so the scalar
+		// longitude atan2(x, y) is atan(x / y), and tan(latitude) / cos(longitude)
+		// is z / y: both face coordinates are an atan of a ratio in [-1, 1]
+		const lanes scale(4.0 / kPI * sphere_radius);
+		bool mapped = true;
+		for (size_t i = 0; i < count; i += c_width)
+		{
+			const size_t n = count - i < c_width ? count - i : c_width;
+			double lx[c_width], ly[c_width], lz[c_width];
+			for (size_t j = 0; j < c_width; ++j)
+			{
+				const size_t k = i + (j < n ? j : n - 1);
+				const IvDoubleVector3 d = world_pos[k] - sphere_center;
+				const double ax = fabs(d.x), ay = fabs(d.y), az = fabs(d.z);
+				CubeFace face;
+				if (ay >= ax && ay >= az)
+					face = d.y >= 0 ? CubeFace::PosY : CubeFace::NegY;
+				else if (ax >= ay && ax >= az)
+					face = d.x >= 0 ? CubeFace::PosX : CubeFace::NegX;
+				else
+					face = d.z >= 0 ? CubeFace::PosZ : CubeFace::NegZ;
+
+				IvDoubleVector3 d_local = rotate_face_to_top(d, face);
+				if (d_local.Length() < 1e-9)
+				{
+					d_local = IvDoubleVector3{ 0.0, 1.0, 0.0 };
+					if (j < n) mapped = false;
+				}
+				if (j < n) out_face[k] = face;
+				lx[j] = d_local.x;
+				ly[j] = d_local.y;
+				lz[j] = d_local.z;
+			}
+
+			const lanes y = lanes::Load(ly);
+			store(atan_lanes(lanes::Load(lx) / y) * scale, out_x + i, n);
+			store(atan_lanes(lanes::Load(lz) / y) * scale, out_y + i, n);
+		}
+		return mapped;
+	}
+}
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "CaliSphereMath.h"
+
+#include <cstddef>
+
+namespace cali
+{
+	namespace Math
+	{
+		// -----------------------------------------------------------------
+		// Array forms of the cube <-> sphere mappings in CaliSphereMath.h,
+		// evaluated four points at a time in IvDouble4 lanes (IvLanes.h)
+		// with polynomials in place of libm's sin / cos / tan / atan.
+		//
+		// Against the scalar functions, at sphere_radius = 6360 km:
+		//   positions and face x, y   < 1e-6 m (measured 1.2e-8 m)
+		//   normals                   < 1e-12 (measured 5e-16)
+		// The error scales with the radius. Inputs are taken in the ranges
+		// the terrain uses: |x|, |y| <= R on a face, |theta| < pi / 2.
+		// The scalar functions stay the reference (the heightmap goldens
+		// are computed with them); these are for bulk work.
+		// -----------------------------------------------------------------
+
+		// positions[i], normals[i] = adjusted_cube_to_sphere(x[i], y[i], ...)
+		void adjusted_cube_to_sphere_batch(const double* x, const double* y, size_t count, double sphere_radius,
+			const IvDoubleVector3& sphere_center, IvDoubleVector3* positions, IvDoubleVector3* normals);
+
+		// positions[i], normals[i] = adjusted_cube_to_sphere_face(face, x[i], y[i], ...)
+		void adjusted_cube_to_sphere_face_batch(CubeFace face, const double* x, const double* y, size_t count,
+			double sphere_radius, const IvDoubleVector3& sphere_center, IvDoubleVector3* positions, IvDoubleVector3* normals);
+
+		// x[i], y[i] = adjusted_sphere_to_cube(phi[i], theta[i], ...)
+		void adjusted_sphere_to_cube_batch(const double* phi, const double* theta, size_t count, double sphere_radius,
+			double* x, double* y);
+
+		// out_face[i], out_x[i], out_y[i] = world_to_cube_face(world_pos[i], ...); returns false if any
+		// point was too close to the center to map (it gets PosY and 0, 0 as in the scalar version)
+		bool world_to_cube_face_batch(const IvDoubleVector3* world_pos, size_t count, const IvDoubleVector3& sphere_center,
+			double sphere_radius, CubeFace* out_face, double* out_x, double* out_y);
+	}
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace cali
+{
+	// Calls f(i) for every i in [0, count) on up to `threads` threads, the
+	// calling one included, each taking the next index when it is done. Stops
+	// handing out indices once *cancel is set.
+	template <class F>
+	void parallel_for(int count, int threads, const F& f, const std::atomic<bool>* cancel = nullptr)
+	{
+		std::atomic<int> next{ 0 };
+		auto worker = [&]()
+		{
+			for (int i = next++; i < count && !(cancel && *cancel); i = next++) f(i);
+		};
+		const int workers_in_pass = (std::min)(threads, count);
+		std::vector<std::thread> workers;
+		for (int w = 1; w < workers_in_pass; ++w) workers.emplace_back(worker);
+		worker();
+		for (auto& w : workers) w.join();
+	}
+}
@@ -6,6 +6,7 @@
 #include "Constants.h"
 #include "World.h"
 #include "ConstantBuffer.h"
+#include "FastMath.h"
 
 #ifndef UNREFERENCED_PARAMETER
 #define UNREFERENCED_PARAMETER(x) (void)(x)
@@ -22,7 +23,7 @@ namespace cali
 
 	IvVector3 camera::get_gravity() const
 	{
-		IvVector3 g = get_position() - world::c_earth_center;
+		IvVector3 g = get_world_position() - IvDoubleVector3(world::c_earth_center);
 		g.Normalize();
 		return g;
 	}
@@ -40,7 +41,7 @@ namespace cali
 		float dot = Dot(old_gravity, new_gravity);
 		if (dot > 1.f) dot = 1.f;
 		if (dot < -1.f) dot = -1.f;
-		float angle = acosf(dot);
+		float angle = fastmath::acos<fastmath::accuracy::medium>(dot);
 		if (fabsf(angle) < 1e-6f) { m_last_gravity = new_gravity; return; }
 		IvMatrix33 rot;
 		rot.Rotation(axis, angle);
@@ -79,7 +80,8 @@ namespace cali
 			m_velocity *= movement_max_velocity / velocity;
 		}
 
-		physical::set_position(physical::get_position() + m_velocity * dt * m_addtional_acceleration);
+		// summed in double: a float position far from the origin drops small steps
+		physical::set_world_position(physical::get_world_position() + IvDoubleVector3(m_velocity * dt * m_addtional_acceleration));
 		m_is_moving = false;
 
 		m_addtional_acceleration = 1.0f;
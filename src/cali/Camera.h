@@ -65,6 +65,8 @@ namespace cali
 
 		// sends perspective settings to the renderer
 		void set_fov(float new_fov);
+		// vertical, in degrees
+		float get_fov() const { return m_fov; }
 		void send_settings_to_renderer(IvRenderer& renderer);
 
 		virtual void update(float dt) override;
@@ -22,6 +22,44 @@ namespace cali
 			ALIGN16 IvVector3 sun_intensity;
 			ALIGN16 IvVector3 sun_attenuation;
 			ALIGN16 IvVector4 sun_color;
+			// L2 SH sky irradiance (atmosphere::sky_ambient), rgb; w of the
+			// first one is 1 once it has been projected
+			ALIGN16 IvVector4 sky_sh[9];
+		};
+
+		// AtmosphereLutSizes of shaders/BrunetonCommonDefs.h, from the
+		// atmosphere::lut_sizes of bruneton
+		ALIGN16 struct AtmosphereLutSizes
+		{
+			int transmittance_width, transmittance_height, irradiance_width, irradiance_height;
+			int scattering_r, scattering_mu, scattering_mu_s, scattering_nu;
+		};
+
+		// Atmosphere of shaders/bruneton_common.fx: the parameters of
+		// bruneton's current LUTs, in the HLSL packing of AtmosphereParameters
+		ALIGN16 struct Atmosphere
+		{
+			IvVector3 solar_irradiance;
+			float sun_angular_radius;
+			float bottom_radius, top_radius, rayleigh_scale_height, pad0;
+			IvVector3 rayleigh_scattering;
+			float mie_scale_height;
+			IvVector3 mie_scattering;
+			float pad1;
+			IvVector3 mie_extinction;
+			float mie_phase_function_g;
+			IvVector3 ground_albedo;
+			float mu_s_min;
+		};
+
+		// AerialPerspective of shaders/cali_common.fx: the camera of the
+		// froxel volume (atmosphere::aerial_perspective) in world space
+		ALIGN16 struct AerialPerspective
+		{
+			ALIGN16 IvVector4 right;    // divided by tan(fov_x / 2)
+			ALIGN16 IvVector4 up;       // divided by tan(fov_y / 2)
+			ALIGN16 IvVector4 forward;  // w: 1 once the volume has been computed
+			ALIGN16 IvVector4 depth;    // x: km per world unit, y: 1 / max distance in km
 		};
 	}
 }
\ No newline at end of file
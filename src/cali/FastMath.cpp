@@ -0,0 +1,257 @@
+#include "FastMath.h"
+
+#include <IvSIMD.h>
+
+namespace cali
+{
+namespace fastmath
+{
+	namespace detail
+	{
+#if defined(IV_SIMD_SSE)
+		// Four floats and two doubles in SSE registers, with the operations of
+		// FastMath.h's scalar lanes; comparisons give all-ones / all-zeros masks
+		struct float4_mask { __m128 v; };
+		struct double2_mask { __m128d v; };
+
+		struct float4
+		{
+			__m128 v;
+			float4() {}
+			float4(__m128 _v) : v(_v) {}
+			explicit float4(double s) : v(_mm_set1_ps((float)s)) {}
+		};
+
+		struct double2
+		{
+			__m128d v;
+			double2() {}
+			double2(__m128d _v) : v(_v) {}
+			explicit double2(double s) : v(_mm_set1_pd(s)) {}
+		};
+
+		template <> struct scalar_of<float4> { typedef float type; };
+		template <> struct scalar_of<double2> { typedef double type; };
+
+		inline float4 operator+(const float4& a, const float4& b) { return _mm_add_ps(a.v, b.v); }
+		inline float4 operator-(const float4& a, const float4& b) { return _mm_sub_ps(a.v, b.v); }
+		inline float4 operator*(const float4& a, const float4& b) { return _mm_mul_ps(a.v, b.v); }
+		inline float4 operator/(const float4& a, const float4& b) { return _mm_div_ps(a.v, b.v); }
+		inline float4 operator-(const float4& a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+		inline float4_mask operator<(const float4& a, const float4& b) { return { _mm_cmplt_ps(a.v, b.v) }; }
+		inline float4_mask operator>(const float4& a, const float4& b) { return { _mm_cmpgt_ps(a.v, b.v) }; }
+		inline float4_mask operator>=(const float4& a, const float4& b) { return { _mm_cmpge_ps(a.v, b.v) }; }
+		inline float4_mask operator==(const float4& a, const float4& b) { return { _mm_cmpeq_ps(a.v, b.v) }; }
+		inline float4_mask operator|(const float4_mask& a, const float4_mask& b) { return { _mm_or_ps(a.v, b.v) }; }
+		inline float4 select(const float4_mask& mask, const float4& a, const float4& b)
+		{
+			return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+		}
+		// as the scalar forms: a < b ? a : b and a > b ? a : b
+		inline float4 minimum(const float4& a, const float4& b) { return select(a < b, a, b); }
+		inline float4 maximum(const float4& a, const float4& b) { return select(a > b, a, b); }
+		inline float4 absolute(const float4& a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+		inline float4 square_root(const float4& a) { return _mm_sqrt_ps(a.v); }
+
+		inline float4 power_of_two(const float4& n)
+		{
+			return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n.v), _mm_set1_epi32(127)), 23));
+		}
+
+		inline float4 split_exponent(const float4& x, float4& e)
+		{
+			const __m128i bits = _mm_castps_si128(x.v);
+			e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+			return _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007fffff)), _mm_set1_epi32(0x3f800000)));
+		}
+
+		inline double2 operator+(const double2& a, const double2& b) { return _mm_add_pd(a.v, b.v); }
+		inline double2 operator-(const double2& a, const double2& b) { return _mm_sub_pd(a.v, b.v); }
+		inline double2 operator*(const double2& a, const double2& b) { return _mm_mul_pd(a.v, b.v); }
+		inline double2 operator/(const double2& a, const double2& b) { return _mm_div_pd(a.v, b.v); }
+		inline double2 operator-(const double2& a) { return _mm_xor_pd(a.v, _mm_set1_pd(-0.0)); }
+		inline double2_mask operator<(const double2& a, const double2& b) { return { _mm_cmplt_pd(a.v, b.v) }; }
+		inline double2_mask operator>(const double2& a, const double2& b) { return { _mm_cmpgt_pd(a.v, b.v) }; }
+		inline double2_mask operator>=(const double2& a, const double2& b) { return { _mm_cmpge_pd(a.v, b.v) }; }
+		inline double2_mask operator==(const double2& a, const double2& b) { return { _mm_cmpeq_pd(a.v, b.v) }; }
+		inline double2_mask operator|(const double2_mask& a, const double2_mask& b) { return { _mm_or_pd(a.v, b.v) }; }
+		inline double2 select(const double2_mask& mask, const double2& a, const double2& b)
+		{
+			return _mm_or_pd(_mm_and_pd(mask.v, a.v), _mm_andnot_pd(mask.v, b.v));
+		}
+		inline double2 minimum(const double2& a, const double2& b) { return select(a < b, a, b); }
+		inline double2 maximum(const double2& a, const double2& b) { return select(a > b, a, b); }
+		inline double2 absolute(const double2& a) { return _mm_andnot_pd(_mm_set1_pd(-0.0), a.v); }
+		inline double2 square_root(const double2& a) { return _mm_sqrt_pd(a.v); }
+
+		inline double2 power_of_two(const double2& n)
+		{
+			// the biased exponents are positive: zero-extend the two int32 to int64
+			const __m128i biased = _mm_add_epi32(_mm_cvttpd_epi32(n.v), _mm_set1_epi32(1023));
+			return _mm_castsi128_pd(_mm_slli_epi64(_mm_unpacklo_epi32(biased, _mm_setzero_si128()), 52));
+		}
+
+		inline double2 split_exponent(const double2& x, double2& e)
+		{
+			const __m128i bits = _mm_castpd_si128(x.v);
+			const __m128i biased = _mm_shuffle_epi32(_mm_srli_epi64(bits, 52), _MM_SHUFFLE(3, 1, 2, 0));
+			e = _mm_cvtepi32_pd(_mm_sub_epi32(biased, _mm_set1_epi32(1023)));
+			return _mm_castsi128_pd(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi64x(0x000fffffffffffffll)),
+				_mm_set1_epi64x(0x3ff0000000000000ll)));
+		}
+
+		// Four floats at a time, in float or as two pairs of doubles
+		template <bool Double, typename Kernel>
+		inline float4 evaluate(const float4& x, Kernel kernel)
+		{
+			if constexpr (Double)
+			{
+				const __m128d lo = kernel(double2(_mm_cvtps_pd(x.v))).v;
+				const __m128d hi = kernel(double2(_mm_cvtps_pd(_mm_movehl_ps(x.v, x.v)))).v;
+				return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+			}
+			else return kernel(x);
+		}
+
+		template <bool Double, typename Kernel>
+		inline float4 evaluate(const float4& x, const float4& y, Kernel kernel)
+		{
+			if constexpr (Double)
+			{
+				const __m128d lo = kernel(double2(_mm_cvtps_pd(x.v)), double2(_mm_cvtps_pd(y.v))).v;
+				const __m128d hi = kernel(double2(_mm_cvtps_pd(_mm_movehl_ps(x.v, x.v))),
+					double2(_mm_cvtps_pd(_mm_movehl_ps(y.v, y.v)))).v;
+				return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+			}
+			else return kernel(x, y);
+		}
+
+		// Count < 4 values, the last one repeated into the other lanes
+		inline float4 load(const float* values, size_t count)
+		{
+			float padded[4];
+			for (size_t i = 0; i < 4; ++i) padded[i] = values[i < count ? i : count - 1];
+			return _mm_loadu_ps(padded);
+		}
+
+		inline void store(const float4& l, float* values, size_t count)
+		{
+			float padded[4];
+			_mm_storeu_ps(padded, l.v);
+			for (size_t i = 0; i < count; ++i) values[i] = padded[i];
+		}
+
+		template <bool Double, typename Kernel>
+		void map(const float* x, float* out, size_t count, Kernel kernel)
+		{
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4) _mm_storeu_ps(out + i, evaluate<Double>(float4(_mm_loadu_ps(x + i)), kernel).v);
+			if (i < count) store(evaluate<Double>(load(x + i, count - i), kernel), out + i, count - i);
+		}
+
+		template <bool Double, typename Kernel>
+		void map(const float* x, const float* y, float* out, size_t count, Kernel kernel)
+		{
+			size_t i = 0;
+			for (; i + 4 <= count; i += 4)
+			{
+				_mm_storeu_ps(out + i, evaluate<Double>(float4(_mm_loadu_ps(x + i)), float4(_mm_loadu_ps(y + i)), kernel).v);
+			}
+			if (i < count)
+				store(evaluate<Double>(load(x + i, count - i), load(y + i, count - i), kernel), out + i, count - i);
+		}
+#else
+		template <bool Double, typename Kernel>
+		void map(const float* x, float* out, size_t count, Kernel kernel)
+		{
+			for (size_t i = 0; i < count; ++i) out[i] = evaluate<Double>(x[i], kernel);
+		}
+
+		template <bool Double, typename Kernel>
+		void map(const float* x, const float* y, float* out, size_t count, Kernel kernel)
+		{
+			for (size_t i = 0; i < count; ++i) out[i] = evaluate<Double>(x[i], y[i], kernel);
+		}
+#endif
+	}
+
+	template <accuracy A>
+	void sin(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::sin_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void cos(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::cos_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void tan(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::tan_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void atan(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::atan_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void atan2(const float* y, const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(y, x, out, count,
+			[](auto a, auto b) { return detail::atan2_kernel<A>(a, b); });
+	}
+
+	template <accuracy A>
+	void asin(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::asin_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void acos(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::acos_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void exp(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::exp_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void log(const float* x, float* out, size_t count)
+	{
+		detail::map<detail::evaluate_in_double<A>::value>(x, out, count, [](auto v) { return detail::log_kernel<A>(v); });
+	}
+
+	template <accuracy A>
+	void pow(const float* x, const float* y, float* out, size_t count)
+	{
+		detail::map<detail::pow_in_double<A>::value>(x, y, out, count,
+			[](auto a, auto b) { return detail::pow_kernel<A>(a, b); });
+	}
+
+#define CALI_FASTMATH_INSTANTIATE(A) \
+	template void sin<A>(const float*, float*, size_t); \
+	template void cos<A>(const float*, float*, size_t); \
+	template void tan<A>(const float*, float*, size_t); \
+	template void atan<A>(const float*, float*, size_t); \
+	template void atan2<A>(const float*, const float*, float*, size_t); \
+	template void asin<A>(const float*, float*, size_t); \
+	template void acos<A>(const float*, float*, size_t); \
+	template void exp<A>(const float*, float*, size_t); \
+	template void log<A>(const float*, float*, size_t); \
+	template void pow<A>(const float*, const float*, float*, size_t);
+
+	CALI_FASTMATH_INSTANTIATE(accuracy::fast)
+	CALI_FASTMATH_INSTANTIATE(accuracy::medium)
+	CALI_FASTMATH_INSTANTIATE(accuracy::exact)
+#undef CALI_FASTMATH_INSTANTIATE
+}
+}
@@ -0,0 +1,448 @@
+#pragma once
+// Transcendental functions that do not depend on the platform's libm, for the
+// float hot paths: sin, cos, tan, atan, atan2, asin, acos, exp, log and pow.
+//
+// Every function comes in three accuracy tiers, picked per call site:
+//
+//   sin<accuracy::fast>(x)      short polynomials in float
+//   sin<accuracy::medium>(x)    float, within a few ulp of the true value
+//   sin<accuracy::exact>(x)     evaluated in double and rounded once: within
+//                               1 ulp, correctly rounded almost everywhere
+//
+// and in a scalar form (inline) and an array form (FastMath.cpp, four values
+// at a time with SSE where IvSIMD.h enables it). Only IEEE + - * / and sqrt
+// are used, with the same operations in the same order in both forms, so the
+// results are the same bits on every compiler and on both forms (cali_core is
+// built without fma contraction).
+//
+// Maximum error in float ulp of the true value over the domains below, as
+// checked by cali_test (fastmath.*, 2^16 samples per function) and reported by
+// cali_bench (2^20 samples):
+//
+//                 fast   medium   exact   domain
+//   sin, cos        80        3       1   |x| <= 4096 (exact: 2^20)
+//   tan            128        4       1   |x| <= 4096 (exact: 2^20)
+//   atan, atan2     32        3       1   any finite x, y; atan2(0, 0) = 0
+//   asin, acos     112        3       1   |x| <= 1
+//   exp            176        2       1   any x: 0 below -104, inf above 88.72
+//   log              8        2       1   x > 0: -inf at 0, NaN below
+//   pow            256        1       1   x >= 0, |y ln x| <= 78 (as noise::portable_pow)
+//
+// The exact tier was correctly rounded on every sample. pow<fast> is
+// exp(y log(x)) in float, so its error grows with |y ln x|; pow<medium>
+// evaluates in double with the medium polynomials. sqrt, floor and fabs are
+// exact in IEEE and need no replacement.
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace cali
+{
+namespace fastmath
+{
+	enum class accuracy { fast, medium, exact };
+
+	namespace detail
+	{
+		// Polynomial corrections, Chebyshev interpolants of the Taylor series of
+		// the reduced functions (see the kernels below); each tier is the lowest
+		// degree that meets its error.
+		template <accuracy A> struct coefficients;
+
+		template <> struct coefficients<accuracy::fast>
+		{
+			static constexpr double sin[] = { -0.16665731001278386, 0.008211855507308219 };
+			static constexpr double cos[] = { 0.04166549508011033, -0.001373681406173436 };
+			static constexpr double atan[] = { -0.33331896557788776, 0.1984809781108456, -0.11819444409574102 };
+			static constexpr double asin[] = { 0.16668672109548313, 0.07357109232532284, 0.0589756389023804 };
+			static constexpr double exp[] = { 0.5, 0.1674189866950506, 0.04179198611287394 };
+			static constexpr double log[] = { 0.6666349945494474, 0.4085826936143872 };
+		};
+
+		template <> struct coefficients<accuracy::medium>
+		{
+			static constexpr double sin[] = { -0.1666666466231438, 0.008332748270629749, -0.00019587890880412386 };
+			static constexpr double cos[] = { 0.04166666465950221, -0.0013888303035894866, 2.4547942085071572e-05 };
+			static constexpr double atan[] = { -0.3333333176116852, 0.19999540483648964, -0.1426395559798464,
+				0.10743731490791084, -0.06451928208121749 };
+			static constexpr double asin[] = { 0.16666666337430908, 0.07500094543497424, 0.04459940152851218,
+				0.03110066273549457, 0.017149238357677253, 0.03369084720283012 };
+			static constexpr double exp[] = { 0.5, 0.1666657702559799, 0.041666554662050534, 0.008363173074513711,
+				0.001392617611993558 };
+			static constexpr double log[] = { 0.6666668503957586, 0.3998878056602198, 0.2957994939197279 };
+		};
+
+		template <> struct coefficients<accuracy::exact>
+		{
+			static constexpr double sin[] = { -0.16666666666663885, 0.008333333331079223, -0.00019841266916985966,
+				2.755599092956532e-06, -2.4805636241834762e-08 };
+			static constexpr double cos[] = { 0.04166666666666468, -0.0013888888887277342, 2.4801585210990515e-05,
+				-2.7556369695573007e-07, 2.0700600483433117e-09 };
+			static constexpr double atan[] = { -0.33333333333266196, 0.19999999949854794, -0.142857081103604,
+				0.11110819716745676, -0.09084101895346429, 0.07604800046078292, -0.06027307460946675,
+				0.03295679541870137 };
+			static constexpr double asin[] = { 0.1666666666666218, 0.07500000003584559, 0.04464285243793872,
+				0.030382182776212484, 0.02236606593888501, 0.017441495685492855, 0.01318791613675373,
+				0.015675662527070935, -0.0029397929067241932, 0.027907031432666096 };
+			static constexpr double exp[] = { 0.4999999999995511, 0.16666666666662586, 0.04166666678626573,
+				0.00833333334420298, 0.0013888839110572009, 0.00019841224599656011, 2.4867870179687727e-05,
+				2.7617564785876086e-06 };
+			static constexpr double log[] = { 0.6666666666737509, 0.3999999879733759, 0.2857175453591449,
+				0.22191400830308503, 0.19362653714202008 };
+		};
+
+		// Constants split so that k * hi is exact for the integers k the
+		// reductions produce (Cody and Waite); float for the float tiers,
+		// double for the ones evaluated in double
+		struct float_constants
+		{
+			static constexpr float pio2_1 = 1.5703125f, pio2_2 = 0.0004838705062866211f, pio2_3 = -4.371395334601402e-08f,
+				pio2_4 = 2.5633440682570896e-12f;
+			static constexpr float ln2_hi = 0.693115234375f, ln2_lo = 3.194618329871446e-05f;
+			static constexpr float round_magic = 12582912.0f; // 1.5 * 2^23
+		};
+
+		struct double_constants
+		{
+			static constexpr double pio2_1 = 1.57079632673412561417e+00, pio2_2 = 6.07710050630396597660e-11,
+				pio2_3 = 2.02226624871116645580e-21, pio2_4 = 8.47842766036889956997e-32;
+			static constexpr double ln2_hi = 6.93147180369123816490e-01, ln2_lo = 1.90821492927058770002e-10;
+			static constexpr double round_magic = 6755399441055744.0; // 1.5 * 2^52
+		};
+
+		// The scalar type of a lane type; FastMath.cpp specializes it for its lanes
+		template <typename R> struct scalar_of { typedef R type; };
+
+		inline float_constants constants_of(float) { return float_constants(); }
+		inline double_constants constants_of(double) { return double_constants(); }
+
+		// The lane operations the kernels are written in, for one float or
+		// double; FastMath.cpp defines the same for SSE registers
+		inline float select(bool mask, float a, float b) { return mask ? a : b; }
+		inline double select(bool mask, double a, double b) { return mask ? a : b; }
+		inline float minimum(float a, float b) { return a < b ? a : b; }
+		inline double minimum(double a, double b) { return a < b ? a : b; }
+		inline float maximum(float a, float b) { return a > b ? a : b; }
+		inline double maximum(double a, double b) { return a > b ? a : b; }
+		inline float absolute(float a) { return std::fabs(a); }
+		inline double absolute(double a) { return std::fabs(a); }
+		inline float square_root(float a) { return std::sqrt(a); }
+		inline double square_root(double a) { return std::sqrt(a); }
+
+		// 2^n for an integral n in the normal exponent range
+		inline float power_of_two(float n)
+		{
+			const uint32_t bits = (uint32_t)((int32_t)n + 127) << 23;
+			float result;
+			memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		inline double power_of_two(double n)
+		{
+			const uint64_t bits = (uint64_t)((int64_t)n + 1023) << 52;
+			double result;
+			memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		// x = m * 2^e with m in [1, 2) for positive, normal x
+		inline float split_exponent(float x, float& e)
+		{
+			uint32_t bits;
+			memcpy(&bits, &x, sizeof(bits));
+			e = (float)((int32_t)(bits >> 23) - 127);
+			bits = (bits & 0x007fffffu) | 0x3f800000u;
+			float m;
+			memcpy(&m, &bits, sizeof(m));
+			return m;
+		}
+
+		inline double split_exponent(double x, double& e)
+		{
+			uint64_t bits;
+			memcpy(&bits, &x, sizeof(bits));
+			e = (double)((int64_t)(bits >> 52) - 1023);
+			bits = (bits & 0x000fffffffffffffull) | 0x3ff0000000000000ull;
+			double m;
+			memcpy(&m, &bits, sizeof(m));
+			return m;
+		}
+
+		inline float smallest_normal(float) { return FLT_MIN; }
+		inline double smallest_normal(double) { return DBL_MIN; }
+
+		// c[0] + c[1] z + c[2] z^2 + ..., Horner's rule
+		template <typename R, size_t N>
+		inline R polynomial(const R& z, const double (&c)[N])
+		{
+			R result = R(c[N - 1]);
+			for (size_t i = N - 1; i-- > 0;) result = result * z + R(c[i]);
+			return result;
+		}
+
+		// Nearest integer, ties to even, for |x| < 2^22 (float) / 2^51 (double)
+		template <typename R>
+		inline R round_integral(const R& x)
+		{
+			const R magic = R(constants_of(typename scalar_of<R>::type()).round_magic);
+			return (x + magic) - magic;
+		}
+
+		// Largest integer <= x
+		template <typename R>
+		inline R floor_integral(const R& x)
+		{
+			const R r = round_integral(x);
+			return r - select(r > x, R(1.0), R(0.0));
+		}
+
+		// Reduction by pi/2: x = k pi/2 + r, |r| <= pi/4, m = k mod 4
+		template <typename R>
+		inline R reduce_pio2(const R& x, R& m)
+		{
+			const auto c = constants_of(typename scalar_of<R>::type());
+			const R k = round_integral(x * R(0.63661977236758134308));
+			m = k - R(4.0) * floor_integral(k * R(0.25));
+			return (((x - k * R(c.pio2_1)) - k * R(c.pio2_2)) - k * R(c.pio2_3)) - k * R(c.pio2_4);
+		}
+
+		template <accuracy A, typename R>
+		inline void sin_cos_reduced(const R& r, R& s, R& c)
+		{
+			const R z = r * r;
+			s = r + r * z * polynomial(z, coefficients<A>::sin);
+			c = (R(1.0) - R(0.5) * z) + z * z * polynomial(z, coefficients<A>::cos);
+		}
+
+		template <accuracy A, typename R>
+		inline R sin_kernel(const R& x)
+		{
+			R m, s, c;
+			sin_cos_reduced<A>(reduce_pio2(x, m), s, c);
+			const R v = select((m == R(1.0)) | (m == R(3.0)), c, s);
+			return select(m >= R(2.0), -v, v);
+		}
+
+		template <accuracy A, typename R>
+		inline R cos_kernel(const R& x)
+		{
+			R m, s, c;
+			sin_cos_reduced<A>(reduce_pio2(x, m), s, c);
+			const R v = select((m == R(1.0)) | (m == R(3.0)), s, c);
+			return select((m == R(1.0)) | (m == R(2.0)), -v, v);
+		}
+
+		template <accuracy A, typename R>
+		inline R tan_kernel(const R& x)
+		{
+			R m, s, c;
+			sin_cos_reduced<A>(reduce_pio2(x, m), s, c);
+			return select((m == R(1.0)) | (m == R(3.0)), -c / s, s / c);
+		}
+
+		// atan(a) for 0 <= a <= 1: above tan(pi/8) as pi/4 + atan((a - 1) / (a + 1))
+		template <accuracy A, typename R>
+		inline R atan_unit(const R& a)
+		{
+			const auto large = a > R(0.41421356237309504880);
+			const R t = select(large, (a - R(1.0)) / (a + R(1.0)), a);
+			const R z = t * t;
+			return select(large, R(0.78539816339744830962), R(0.0)) + (t + t * z * polynomial(z, coefficients<A>::atan));
+		}
+
+		template <accuracy A, typename R>
+		inline R atan_kernel(const R& x)
+		{
+			const R a = absolute(x);
+			const auto inverse = a > R(1.0);
+			const R u = atan_unit<A>(select(inverse, R(1.0) / a, a));
+			const R r = select(inverse, R(1.57079632679489661923) - u, u);
+			return select(x < R(0.0), -r, r);
+		}
+
+		// atan2(0, 0) is 0
+		template <accuracy A, typename R>
+		inline R atan2_kernel(const R& y, const R& x)
+		{
+			const R ax = absolute(x), ay = absolute(y);
+			const R largest = maximum(ax, ay);
+			const R u = atan_unit<A>(minimum(ax, ay) / select(largest == R(0.0), R(1.0), largest));
+			R r = select(ay > ax, R(1.57079632679489661923) - u, u);
+			r = select(x < R(0.0), R(3.14159265358979323846) - r, r);
+			return select(y < R(0.0), -r, r);
+		}
+
+		// asin(a) for 0 <= a <= 1: above 1/2 as pi/2 - 2 asin(sqrt((1 - a) / 2));
+		// returns the series part p and whether it was reflected
+		template <accuracy A, typename R>
+		inline R asin_reduced(const R& a, decltype(R(0.0) > R(0.0))& large)
+		{
+			large = a > R(0.5);
+			const R z = select(large, (R(1.0) - a) * R(0.5), a * a);
+			const R t = select(large, square_root(z), a);
+			return t + t * z * polynomial(z, coefficients<A>::asin);
+		}
+
+		template <accuracy A, typename R>
+		inline R asin_kernel(const R& x)
+		{
+			decltype(R(0.0) > R(0.0)) large;
+			const R p = asin_reduced<A>(absolute(x), large);
+			const R r = select(large, R(1.57079632679489661923) - (p + p), p);
+			return select(x < R(0.0), -r, r);
+		}
+
+		template <accuracy A, typename R>
+		inline R acos_kernel(const R& x)
+		{
+			decltype(R(0.0) > R(0.0)) large;
+			const R p = asin_reduced<A>(absolute(x), large);
+			const R negative = select(x < R(0.0), -p, p);
+			const R reflected = select(x < R(0.0), R(3.14159265358979323846) - (p + p), p + p);
+			return select(large, reflected, R(1.57079632679489661923) - negative);
+		}
+
+		// x = k ln2 + r, |r| <= ln2 / 2; 2^k in two factors so that results down
+		// to the denormals are reached
+		template <accuracy A, typename R>
+		inline R exp_kernel(const R& x)
+		{
+			const auto c = constants_of(typename scalar_of<R>::type());
+			const R xc = minimum(maximum(x, R(-104.0)), R(89.0));
+			const R k = round_integral(xc * R(1.44269504088896340736));
+			const R r = (xc - k * R(c.ln2_hi)) - k * R(c.ln2_lo);
+			const R p = R(1.0) + r + r * r * polynomial(r, coefficients<A>::exp);
+			const R k1 = floor_integral(k * R(0.5));
+			return p * power_of_two(k1) * power_of_two(k - k1);
+		}
+
+		// x = m 2^e, m in [sqrt(1/2), sqrt(2)); log(m) = 2 atanh(s), s = (m - 1) / (m + 1)
+		template <accuracy A, typename R>
+		inline R log_kernel(const R& x)
+		{
+			const auto c = constants_of(typename scalar_of<R>::type());
+			const auto denormal = x < R(smallest_normal(typename scalar_of<R>::type()));
+			const R scale = R(sizeof(typename scalar_of<R>::type) == sizeof(float) ? 16777216.0 : 18014398509481984.0);
+			R e;
+			R m = split_exponent(select(denormal, x * scale, x), e);
+			e = e - select(denormal, R(sizeof(typename scalar_of<R>::type) == sizeof(float) ? 24.0 : 54.0), R(0.0));
+			const auto high = m > R(1.41421356237309504880);
+			m = select(high, m * R(0.5), m);
+			e = e + select(high, R(1.0), R(0.0));
+
+			const R f = m - R(1.0);
+			const R s = f / (R(2.0) + f);
+			const R z = s * s;
+			const R r = e * R(c.ln2_hi) + ((s + s + s * z * polynomial(z, coefficients<A>::log)) + e * R(c.ln2_lo));
+			R result = select(x == R(0.0), R(-HUGE_VAL), r);
+			result = select(x < R(0.0), R(NAN), result);
+			return select(x == R(HUGE_VAL), x, result);
+		}
+
+		// x >= 0
+		template <accuracy A, typename R>
+		inline R pow_kernel(const R& x, const R& y)
+		{
+			R result = exp_kernel<A>(y * log_kernel<A>(x));
+			result = select(x == R(0.0), select(y > R(0.0), R(0.0), R(HUGE_VAL)), result);
+			return select(y == R(0.0), R(1.0), result);
+		}
+
+		// float or double evaluation of a tier
+		template <accuracy A> struct evaluate_in_double { static const bool value = A == accuracy::exact; };
+		template <accuracy A> struct pow_in_double { static const bool value = A != accuracy::fast; };
+
+		template <bool Double, typename Kernel>
+		inline float evaluate(float x, Kernel kernel)
+		{
+			if constexpr (Double) return (float)kernel((double)x);
+			else return kernel(x);
+		}
+
+		template <bool Double, typename Kernel>
+		inline float evaluate(float x, float y, Kernel kernel)
+		{
+			if constexpr (Double) return (float)kernel((double)x, (double)y);
+			else return kernel(x, y);
+		}
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float sin(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::sin_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float cos(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::cos_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float tan(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::tan_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float atan(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::atan_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float atan2(float y, float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(y, x,
+			[](auto a, auto b) { return detail::atan2_kernel<A>(a, b); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float asin(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::asin_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float acos(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::acos_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float exp(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::exp_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float log(float x)
+	{
+		return detail::evaluate<detail::evaluate_in_double<A>::value>(x, [](auto v) { return detail::log_kernel<A>(v); });
+	}
+
+	template <accuracy A = accuracy::medium>
+	inline float pow(float x, float y)
+	{
+		return detail::evaluate<detail::pow_in_double<A>::value>(x, y,
+			[](auto a, auto b) { return detail::pow_kernel<A>(a, b); });
+	}
+
+	// Array forms: out[i] = f(x[i]) (atan2: f(y[i], x[i]), pow: f(x[i], y[i]))
+	// for `count` values, the same bits as the scalar forms. out may alias an input.
+	template <accuracy A = accuracy::medium> void sin(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void cos(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void tan(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void atan(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void atan2(const float* y, const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void asin(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void acos(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void exp(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void log(const float* x, float* out, size_t count);
+	template <accuracy A = accuracy::medium> void pow(const float* x, const float* y, float* out, size_t count);
+}
+}
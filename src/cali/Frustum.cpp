@@ -1,95 +1,356 @@
 #include "Frustum.h"
 
+#include <IvLanes.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace cali
 {
-	/*
-	void frustum::construct_frustum(float screenDepth, IvMatrix44 projectionMatrix, IvMatrix44 viewMatrix)
-	{
-		// Create the frustum matrix from the view matrix and updated projection matrix.
-		IvMatrix44 viewProjection= projectionMatrix * viewMatrix;
-
-		// Left plane
-		m_planes[0].Set(
-			viewProjection(0,3) + viewProjection(0,0), 
-			viewProjection(1,3) + viewProjection(1,0), 
-			viewProjection(2,3) + viewProjection(2,0), 
-			viewProjection(3,3) + viewProjection(3,0));
-
-		// Right plane
-		m_planes[1].Set(
-			viewProjection(0,3) - viewProjection(0,0), 
-			viewProjection(1,3) - viewProjection(1,0), 
-			viewProjection(2,3) - viewProjection(2,0), 
-			viewProjection(3,3) - viewProjection(3,0));
-
-		// Top plane
-		m_planes[2].Set(
-			viewProjection(0,3) - viewProjection(0,1), 
-			viewProjection(1,3) - viewProjection(1,1), 
-			viewProjection(2,3) - viewProjection(2,1), 
-			viewProjection(3,3) - viewProjection(3,1));
-
-		// Bottom plane
-		m_planes[3].Set(
-			viewProjection(0,3) + viewProjection(0,1), 
-			viewProjection(1,3) + viewProjection(1,1),
-			viewProjection(2,3) + viewProjection(2,1), 
-			viewProjection(3,3) + viewProjection(3,1));
-
-		// Near plane
-		m_planes[4].Set(
-			viewProjection(0,2), 
-			viewProjection(1,2), 
-			viewProjection(2,2), 
-			viewProjection(3,2));
-
-		// Far plane
-		m_planes[5].Set(
-			viewProjection(0,3) - viewProjection(0,2), 
-			viewProjection(1,3) - viewProjection(1,2), 
-			viewProjection(2,3) - viewProjection(2,2), 
-			viewProjection(3,3) - viewProjection(3,2));
-
-		return;
-	}
-	*/
+	namespace
+	{
+		template <typename T> struct lanes_of;
+		template <> struct lanes_of<double> { typedef IvDouble4 type; };
+		template <> struct lanes_of<float> { typedef IvFloat8 type; };
+
+		// Count values, the last one repeated into the other lanes of a partial batch
+		template <typename L, typename T>
+		L load(const T* values, size_t count)
+		{
+			if (count == L::Width) return L::Load(values);
+			T padded[L::Width];
+			for (size_t i = 0; i < L::Width; ++i) padded[i] = values[i < count ? i : count - 1];
+			return L::Load(padded);
+		}
+
+		// A plane in every lane, and the absolute values of its normal
+		template <typename L>
+		struct plane_lanes
+		{
+			L a, b, c, d, abs_a, abs_b, abs_c;
+		};
+
+		template <typename L, typename T>
+		void broadcast(const T (&planes)[4][frustum::plane_count], plane_lanes<L> (&lanes)[frustum::plane_count])
+		{
+			for (int p = 0; p < frustum::plane_count; ++p)
+				lanes[p] = { L(planes[0][p]), L(planes[1][p]), L(planes[2][p]), L(planes[3][p]),
+					L(std::abs(planes[0][p])), L(std::abs(planes[1][p])), L(std::abs(planes[2][p])) };
+		}
+
+		template <typename T>
+		containment classify_one(const T (&planes)[4][frustum::plane_count], T cx, T cy, T cz, T ex, T ey, T ez,
+			uint8_t* plane_mask)
+		{
+			const unsigned int tested = plane_mask ? *plane_mask : frustum::all_planes;
+			unsigned int straddled = 0;
+			for (int p = 0; p < frustum::plane_count; ++p)
+			{
+				if (!(tested & (1u << p))) continue;
+				const T d = planes[0][p] * cx + planes[1][p] * cy + planes[2][p] * cz + planes[3][p];
+				const T r = std::abs(planes[0][p]) * ex + std::abs(planes[1][p]) * ey + std::abs(planes[2][p]) * ez;
+				if (d + r < T(0)) return containment::outside;
+				if (d - r < T(0)) straddled |= 1u << p;
+			}
+			if (plane_mask) *plane_mask = (uint8_t)straddled;
+			return straddled ? containment::intersects : containment::inside;
+		}
+
+		// classify_one() per lane: the smallest d + r over the planes decides
+		// outside and the smallest d - r inside; an untested plane's values
+		// are raised to infinity so that it decides neither
+		template <typename T>
+		void classify_batch(const T (&planes)[4][frustum::plane_count], const box_array<T>& boxes, containment* results,
+			uint8_t* plane_masks)
+		{
+			typedef typename lanes_of<T>::type lanes;
+			const size_t width = lanes::Width;
+			const T infinity = std::numeric_limits<T>::infinity();
+			plane_lanes<lanes> plane[frustum::plane_count];
+			broadcast(planes, plane);
+
+			for (size_t i = 0; i < boxes.size(); i += width)
+			{
+				const size_t count = std::min(width, boxes.size() - i);
+				const lanes cx = load<lanes>(&boxes.center_x[i], count), cy = load<lanes>(&boxes.center_y[i], count),
+					cz = load<lanes>(&boxes.center_z[i], count), ex = load<lanes>(&boxes.extent_x[i], count),
+					ey = load<lanes>(&boxes.extent_y[i], count), ez = load<lanes>(&boxes.extent_z[i], count);
+
+				unsigned int tested = frustum::all_planes;
+				T skip[frustum::plane_count][lanes::Width];
+				if (plane_masks)
+				{
+					tested = 0;
+					for (size_t k = 0; k < width; ++k)
+					{
+						const uint8_t mask = plane_masks[i + (k < count ? k : count - 1)];
+						tested |= mask;
+						for (int p = 0; p < frustum::plane_count; ++p) skip[p][k] = mask & (1u << p) ? -infinity : infinity;
+					}
+				}
+
+				lanes nearest(infinity), innermost(infinity);
+				T inner_values[frustum::plane_count][lanes::Width];
+				for (int p = 0; p < frustum::plane_count; ++p)
+				{
+					if (!(tested & (1u << p))) continue;
+					const plane_lanes<lanes>& q = plane[p];
+					const lanes d = q.a * cx + q.b * cy + q.c * cz + q.d;
+					const lanes r = q.abs_a * ex + q.abs_b * ey + q.abs_c * ez;
+					lanes outer = d + r, inner = d - r;
+					if (plane_masks)
+					{
+						const lanes s = lanes::Load(skip[p]);
+						outer = Max(outer, s);
+						inner = Max(inner, s);
+						inner.Store(inner_values[p]);
+					}
+					nearest = Min(nearest, outer);
+					innermost = Min(innermost, inner);
+				}
+
+				T nearest_values[lanes::Width], innermost_values[lanes::Width];
+				nearest.Store(nearest_values);
+				innermost.Store(innermost_values);
+				// without branches: whether a box is outside is as good as random
+				for (size_t k = 0; k < count; ++k)
+					results[i + k] = nearest_values[k] < T(0) ? containment::outside
+						: innermost_values[k] < T(0) ? containment::intersects : containment::inside;
+
+				if (!plane_masks) continue;
+				for (size_t k = 0; k < count; ++k)
+				{
+					if (results[i + k] == containment::outside) continue;
+					unsigned int straddled = 0;
+					for (int p = 0; p < frustum::plane_count; ++p)
+						if (tested & (1u << p)) straddled |= (unsigned int)(inner_values[p][k] < T(0)) << p;
+					plane_masks[i + k] = (uint8_t)straddled;
+				}
+			}
+		}
+
+		// frustum::classify_oriented_box() per lane
+		template <typename T>
+		void classify_oriented_batch(const T (&planes)[4][frustum::plane_count], const oriented_box_array<T>& boxes,
+			containment* results)
+		{
+			typedef typename lanes_of<T>::type lanes;
+			const size_t width = lanes::Width;
+			plane_lanes<lanes> plane[frustum::plane_count];
+			broadcast(planes, plane);
+
+			for (size_t i = 0; i < boxes.size(); i += width)
+			{
+				const size_t count = std::min(width, boxes.size() - i);
+				const lanes cx = load<lanes>(&boxes.center_x[i], count), cy = load<lanes>(&boxes.center_y[i], count),
+					cz = load<lanes>(&boxes.center_z[i], count);
+				const lanes e[3] = { load<lanes>(&boxes.extent_x[i], count), load<lanes>(&boxes.extent_y[i], count),
+					load<lanes>(&boxes.extent_z[i], count) };
+				lanes ax[3], ay[3], az[3];
+				for (int k = 0; k < 3; ++k)
+				{
+					ax[k] = load<lanes>(&boxes.axis_x[k][i], count);
+					ay[k] = load<lanes>(&boxes.axis_y[k][i], count);
+					az[k] = load<lanes>(&boxes.axis_z[k][i], count);
+				}
+
+				lanes nearest(std::numeric_limits<T>::infinity()), inner(std::numeric_limits<T>::infinity());
+				for (int p = 0; p < frustum::plane_count; ++p)
+				{
+					const plane_lanes<lanes>& q = plane[p];
+					const lanes d = q.a * cx + q.b * cy + q.c * cz + q.d;
+					lanes r = Abs(q.a * ax[0] + q.b * ay[0] + q.c * az[0]) * e[0];
+					r = r + Abs(q.a * ax[1] + q.b * ay[1] + q.c * az[1]) * e[1];
+					r = r + Abs(q.a * ax[2] + q.b * ay[2] + q.c * az[2]) * e[2];
+					nearest = Min(nearest, d + r);
+					inner = Min(inner, d - r);
+				}
+
+				T nearest_values[lanes::Width], inner_values[lanes::Width];
+				nearest.Store(nearest_values);
+				inner.Store(inner_values);
+				for (size_t k = 0; k < count; ++k)
+					results[i + k] = nearest_values[k] < T(0) ? containment::outside
+						: inner_values[k] < T(0) ? containment::intersects : containment::inside;
+			}
+		}
+
+		template <typename T>
+		void classify_spheres_batch(const T (&planes)[4][frustum::plane_count], const sphere_array<T>& spheres,
+			containment* results)
+		{
+			typedef typename lanes_of<T>::type lanes;
+			const size_t width = lanes::Width;
+			plane_lanes<lanes> plane[frustum::plane_count];
+			broadcast(planes, plane);
+
+			for (size_t i = 0; i < spheres.size(); i += width)
+			{
+				const size_t count = std::min(width, spheres.size() - i);
+				const lanes cx = load<lanes>(&spheres.center_x[i], count), cy = load<lanes>(&spheres.center_y[i], count),
+					cz = load<lanes>(&spheres.center_z[i], count), r = load<lanes>(&spheres.radius[i], count);
+
+				lanes nearest(std::numeric_limits<T>::infinity()), inner(std::numeric_limits<T>::infinity());
+				for (int p = 0; p < frustum::plane_count; ++p)
+				{
+					const lanes d = plane[p].a * cx + plane[p].b * cy + plane[p].c * cz + plane[p].d;
+					nearest = Min(nearest, d + r);
+					inner = Min(inner, d - r);
+				}
+
+				T nearest_values[lanes::Width], inner_values[lanes::Width];
+				nearest.Store(nearest_values);
+				inner.Store(inner_values);
+				for (size_t k = 0; k < count; ++k)
+					results[i + k] = nearest_values[k] < T(0) ? containment::outside
+						: inner_values[k] < T(0) ? containment::intersects : containment::inside;
+			}
+		}
+	}
+
+	frustum::frustum()
+	{
+		double planes[plane_count][4];
+		for (auto& each : planes)
+		{
+			each[0] = each[1] = each[2] = 0.0;
+			each[3] = 1.0;
+		}
+		set_planes(planes);
+	}
 
 	void frustum::construct_frustum(const IvMatrix44& iv_projection_matrix, const IvMatrix44& iv_view_matrix)
 	{
-		using namespace DirectX;
+		// projection * view in double: clip = m * world
+		double m[4][4];
+		for (unsigned int i = 0; i < 4; ++i)
+			for (unsigned int j = 0; j < 4; ++j)
+			{
+				m[i][j] = 0.0;
+				for (unsigned int k = 0; k < 4; ++k) m[i][j] += (double)iv_projection_matrix(i, k) * (double)iv_view_matrix(k, j);
+			}
 
-		const float* proj_data = iv_projection_matrix;
-		const float* view_data = iv_view_matrix;
+		// -w <= x <= w, -w <= y <= w, 0 <= z <= w
+		double planes[plane_count][4];
+		for (unsigned int j = 0; j < 4; ++j)
+		{
+			planes[left][j] = m[3][j] + m[0][j];
+			planes[right][j] = m[3][j] - m[0][j];
+			planes[bottom][j] = m[3][j] + m[1][j];
+			planes[top][j] = m[3][j] - m[1][j];
+			planes[near_plane][j] = m[2][j];
+			planes[far_plane][j] = m[3][j] - m[2][j];
+		}
+
+		for (auto& each : planes)
+		{
+			const double length = std::sqrt(each[0] * each[0] + each[1] * each[1] + each[2] * each[2]);
+			if (length > 0.0)
+			{
+				for (double& value : each) value /= length;
+			}
+			else
+			{
+				each[0] = each[1] = each[2] = 0.0;
+				each[3] = 1.0;
+			}
+		}
+		set_planes(planes);
+	}
 
-		assert(sizeof(XMFLOAT4X4A) == sizeof(IvMatrix44));
+	void frustum::set_planes(const double (&planes)[plane_count][4])
+	{
+		for (int p = 0; p < plane_count; ++p)
+			for (int j = 0; j < 4; ++j)
+			{
+				m_planes[j][p] = planes[p][j];
+				m_planes_float[j][p] = (float)planes[p][j];
+			}
+	}
+
+	void frustum::get_plane(plane p, IvDoubleVector3& normal, double& offset) const
+	{
+		normal = IvDoubleVector3(m_planes[0][p], m_planes[1][p], m_planes[2][p]);
+		offset = m_planes[3][p];
+	}
 
-		XMFLOAT4X4A projection_matrix, view_matrix;
-		memcpy(projection_matrix.m, proj_data, sizeof(XMFLOAT4X4A));
-		memcpy(view_matrix.m, view_data, sizeof(XMFLOAT4X4A));
+	containment frustum::classify_box(const IvDoubleVector3& center, const IvDoubleVector3& extents, uint8_t* plane_mask) const
+	{
+		return classify_one(m_planes, center.x, center.y, center.z, extents.x, extents.y, extents.z, plane_mask);
+	}
 
-		BoundingFrustum::CreateFromMatrix(m_frustum, XMLoadFloat4x4A(&projection_matrix));
-		BoundingFrustum tmp(XMLoadFloat4x4A(&projection_matrix));
-		XMVECTOR det;
-		tmp.Transform(m_frustum, XMMatrixInverse(&det, XMLoadFloat4x4A(&view_matrix)));
-		m_frustum.Near = 1.0f;
+	containment frustum::classify_sphere(const IvDoubleVector3& center, double radius) const
+	{
+		bool straddles = false;
+		for (int p = 0; p < plane_count; ++p)
+		{
+			const double d = m_planes[0][p] * center.x + m_planes[1][p] * center.y + m_planes[2][p] * center.z + m_planes[3][p];
+			if (d + radius < 0.0) return containment::outside;
+			if (d - radius < 0.0) straddles = true;
+		}
+		return straddles ? containment::intersects : containment::inside;
 	}
 
-	bool frustum::visible(const IvOBB & box) const
+	containment frustum::classify_oriented_box(const IvDoubleVector3& center, const IvMatrix33& rotation,
+		const IvVector3& extents) const
 	{
-		/*for (auto&& plane : m_planes)
+		bool straddles = false;
+		for (int p = 0; p < plane_count; ++p)
 		{
-			if (box.Classify(plane) >= 0.0f) continue;
-			return false;
+			// the box's extents along the normal, through its axes (the columns of the rotation)
+			double r = 0.0;
+			for (unsigned int axis = 0; axis < 3; ++axis)
+			{
+				const double along = m_planes[0][p] * rotation(0, axis) + m_planes[1][p] * rotation(1, axis) +
+					m_planes[2][p] * rotation(2, axis);
+				r += std::abs(along) * extents[axis];
+			}
+			const double d = m_planes[0][p] * center.x + m_planes[1][p] * center.y + m_planes[2][p] * center.z + m_planes[3][p];
+			if (d + r < 0.0) return containment::outside;
+			if (d - r < 0.0) straddles = true;
 		}
-		*/
-		return true;
+		return straddles ? containment::intersects : containment::inside;
 	}
-	bool frustum::contains_aligned_bounding_box(float x, float y, float z, float extent_x, float extent_y, float extent_z) const
+
+	void frustum::classify_boxes(const box_array<double>& boxes, containment* results, uint8_t* plane_masks) const
 	{
-		using namespace DirectX;
-		BoundingBox box(XMFLOAT3{ x, y, z }, XMFLOAT3{ extent_x, extent_y, extent_z });
+		classify_batch(m_planes, boxes, results, plane_masks);
+	}
 
-		return m_frustum.Contains(box) != DISJOINT;
+	void frustum::classify_boxes(const box_array<float>& boxes, containment* results, uint8_t* plane_masks) const
+	{
+		classify_batch(m_planes_float, boxes, results, plane_masks);
+	}
+
+	void frustum::classify_spheres(const sphere_array<double>& spheres, containment* results) const
+	{
+		classify_spheres_batch(m_planes, spheres, results);
+	}
+
+	void frustum::classify_spheres(const sphere_array<float>& spheres, containment* results) const
+	{
+		classify_spheres_batch(m_planes_float, spheres, results);
+	}
+
+	void frustum::classify_oriented_boxes(const oriented_box_array<double>& boxes, containment* results) const
+	{
+		classify_oriented_batch(m_planes, boxes, results);
+	}
+
+	void frustum::classify_oriented_boxes(const oriented_box_array<float>& boxes, containment* results) const
+	{
+		classify_oriented_batch(m_planes_float, boxes, results);
+	}
+
+	bool frustum::visible(const IvOBB& box) const
+	{
+		const IvVector3& center = box.GetCenter();
+		return classify_oriented_box({ center.x, center.y, center.z }, box.GetRotation(), box.GetExtents()) != containment::outside;
+	}
+
+	bool frustum::contains_aligned_bounding_box(float x, float y, float z, float extent_x, float extent_y, float extent_z) const
+	{
+		return classify_box({ x, y, z }, { extent_x, extent_y, extent_z }) != containment::outside;
 	}
 }
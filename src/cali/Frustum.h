@@ -1,24 +1,148 @@
 #pragma once
-#include "IvPlane.h"
-#include "IvOBB.h"
-#include "IvMatrix44.h"
+#include <IvDoubleVector3.h>
+#include <IvMatrix33.h>
+#include <IvMatrix44.h>
+#include <IvOBB.h>
 
-#include <DirectXCollision.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace cali
 {
-	class frustum
+	// As DirectX::ContainmentType: DISJOINT, INTERSECTS, CONTAINS
+	enum class containment : uint8_t { outside, intersects, inside };
+
+	// Boxes as centre and half extents, one array per component
+	template <typename T>
+	struct box_array
+	{
+		std::vector<T> center_x, center_y, center_z;
+		std::vector<T> extent_x, extent_y, extent_z;
+
+		void push_back(const IvDoubleVector3& center, const IvDoubleVector3& extents)
+		{
+			center_x.push_back((T)center.x); center_y.push_back((T)center.y); center_z.push_back((T)center.z);
+			extent_x.push_back((T)extents.x); extent_y.push_back((T)extents.y); extent_z.push_back((T)extents.z);
+		}
+		void reserve(size_t count)
+		{
+			for (std::vector<T>* component : { &center_x, &center_y, &center_z, &extent_x, &extent_y, &extent_z })
+				component->reserve(count);
+		}
+		void clear()
+		{
+			for (std::vector<T>* component : { &center_x, &center_y, &center_z, &extent_x, &extent_y, &extent_z })
+				component->clear();
+		}
+		size_t size() const { return center_x.size(); }
+	};
+
+	template <typename T>
+	struct sphere_array
+	{
+		std::vector<T> center_x, center_y, center_z, radius;
+
+		void push_back(const IvDoubleVector3& center, double r)
+		{
+			center_x.push_back((T)center.x); center_y.push_back((T)center.y); center_z.push_back((T)center.z);
+			radius.push_back((T)r);
+		}
+		void clear()
+		{
+			for (std::vector<T>* component : { &center_x, &center_y, &center_z, &radius }) component->clear();
+		}
+		size_t size() const { return center_x.size(); }
+	};
+
+	// Oriented boxes as centre, the three unit axes (the columns of an
+	// IvOBB rotation) and the half extents along them, one array per component
+	template <typename T>
+	struct oriented_box_array
 	{
-		//IvPlane m_planes[6];
-		DirectX::BoundingFrustum m_frustum;
+		std::vector<T> center_x, center_y, center_z;
+		std::vector<T> axis_x[3], axis_y[3], axis_z[3];
+		std::vector<T> extent_x, extent_y, extent_z;
 
+		void push_back(const IvDoubleVector3& center, const IvMatrix33& rotation, const IvVector3& extents)
+		{
+			center_x.push_back((T)center.x); center_y.push_back((T)center.y); center_z.push_back((T)center.z);
+			for (unsigned int k = 0; k < 3; ++k)
+			{
+				axis_x[k].push_back((T)rotation(0, k)); axis_y[k].push_back((T)rotation(1, k)); axis_z[k].push_back((T)rotation(2, k));
+			}
+			extent_x.push_back((T)extents.x); extent_y.push_back((T)extents.y); extent_z.push_back((T)extents.z);
+		}
+		void clear()
+		{
+			for (std::vector<T>* component : { &center_x, &center_y, &center_z, &axis_x[0], &axis_x[1], &axis_x[2], &axis_y[0],
+				&axis_y[1], &axis_y[2], &axis_z[0], &axis_z[1], &axis_z[2], &extent_x, &extent_y, &extent_z })
+				component->clear();
+		}
+		size_t size() const { return center_x.size(); }
+	};
+
+	// -----------------------------------------------------------------
+	// The view frustum as six planes taken in double from projection *
+	// view (each plane a sum or difference of two rows), for the depth
+	// range of camera::send_settings_to_renderer(): 0 <= z <= w. Normals
+	// are unit length and point inwards. A plane whose normal vanishes,
+	// as the far plane of c_camera_far does when Q rounds to 1, holds
+	// everything.
+	//
+	// Boxes and spheres are tested against the planes only: outside when
+	// outside one plane, inside when inside all of them. A box beyond an
+	// edge of the frustum but not outside any one plane intersects, so
+	// nothing visible is ever culled. An oriented box reaches as far from
+	// a plane as its extents along its axes project onto the normal. The
+	// arrays are tested four at a time in IvDouble4 lanes (double) or
+	// eight in IvFloat8 (float), the float ones against the planes rounded
+	// to float; a double box gets what classify_box() or
+	// classify_oriented_box() gives it, wherever it is in the array.
+	//
+	// Plane masks carry the coherence of a hierarchy down to its
+	// children: bit p set means plane p is to be tested, and after the
+	// test the mask holds the planes the box straddles, which are all a
+	// child inside it needs. A box inside its parent's other planes skips
+	// them; an outside box keeps its mask.
+	// -----------------------------------------------------------------
+	class frustum
+	{
 	public:
-		frustum() {}
+		enum plane { left, right, bottom, top, near_plane, far_plane, plane_count };
+		static constexpr uint8_t all_planes = (1 << plane_count) - 1;
+
+		// Everything inside
+		frustum();
 		~frustum() {}
 
 		void construct_frustum(const IvMatrix44& iv_projection_matrix, const IvMatrix44& iv_view_matrix);
 
+		// normal . p + offset >= 0 inside
+		void get_plane(plane p, IvDoubleVector3& normal, double& offset) const;
+
+		containment classify_box(const IvDoubleVector3& center, const IvDoubleVector3& extents,
+			uint8_t* plane_mask = nullptr) const;
+		containment classify_sphere(const IvDoubleVector3& center, double radius) const;
+		// rotation as IvOBB's: its columns are the axes of the box
+		containment classify_oriented_box(const IvDoubleVector3& center, const IvMatrix33& rotation, const IvVector3& extents) const;
+
+		// results[i] for box i; plane_masks, if any, as the plane_mask of classify_box()
+		void classify_boxes(const box_array<double>& boxes, containment* results, uint8_t* plane_masks = nullptr) const;
+		void classify_boxes(const box_array<float>& boxes, containment* results, uint8_t* plane_masks = nullptr) const;
+		void classify_spheres(const sphere_array<double>& spheres, containment* results) const;
+		void classify_spheres(const sphere_array<float>& spheres, containment* results) const;
+		void classify_oriented_boxes(const oriented_box_array<double>& boxes, containment* results) const;
+		void classify_oriented_boxes(const oriented_box_array<float>& boxes, containment* results) const;
+
 		bool visible(const IvOBB& box) const;
 		bool contains_aligned_bounding_box(float x, float y, float z, float extent_x, float extent_y, float extent_z) const;
+
+	private:
+		void set_planes(const double (&planes)[plane_count][4]);
+
+		// a, b, c, d of each plane, and the same rounded to float for float boxes
+		double m_planes[4][plane_count];
+		float m_planes_float[4][plane_count];
 	};
-}
\ No newline at end of file
+}
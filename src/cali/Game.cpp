@@ -20,13 +20,16 @@
 #include <D3D11\IvRendererD3D11.h>
 #include <IvRendererHelp.h>
 #include <IvConstantBuffer.h>
+#include <IvMath.h>
 
 #include <chrono>
+#include <cmath>
 #include <thread>
 
 #include "Game.h"
 #include "Constants.h"
 #include "World.h"
+#include "CommonFileSystem.h"
 
 #if defined WORK_ON_ICOSAHEDRON
 #include "TerrainIcosahedron.h"
@@ -41,6 +44,21 @@
 //-- Static Members -------------------------------------------------------------
 //-------------------------------------------------------------------------------
 
+static const double c_atmosphere_budget_ms = 4.0;
+// resolution of the atmosphere LUTs; cali_bench --lut-tiers reports the
+// precompute time, memory and sky error of each tier
+static const cali::atmosphere::lut_tier c_atmosphere_lut_tier = cali::atmosphere::lut_tier::high;
+// tone mapping of sky_precomp.hlslf
+static const float c_sky_exposure = 10.0f;
+// world units per km, see camera_position_km_uints in the shaders
+static const float c_world_units_per_km = 10.0f;
+
+static IvVector4 to_display_color(const cali::atmosphere::rgba& radiance)
+{
+	auto channel = [](float c) { return powf(fabsf(1.0f - expf(-c * c_sky_exposure)), 1.0f / 2.2f); };
+	return { channel(radiance.r), channel(radiance.g), channel(radiance.b), 1.f };
+}
+
 //-------------------------------------------------------------------------------
 //-- Methods --------------------------------------------------------------------
 //-------------------------------------------------------------------------------
@@ -73,7 +91,11 @@ Game::Game() :
 	m_camera({ 0.0f, 50.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }),
 	m_render_wireframe(false),
 	m_render_debug_info(false),
-	m_stop_time(false)
+	m_stop_time(false),
+	m_hazy_atmosphere(false),
+	m_start_time(std::chrono::steady_clock::now()),
+	m_time_to_first_frame(-1.0),
+	m_time_to_full_quality(-1.0)
 {
 }   // End of Game::Game()
 
@@ -103,15 +125,30 @@ Game::PostRendererInitialize()
 
 	auto& renderer = *IvRenderer::mRenderer;
 
-	m_bruneton = std::make_unique<cali::bruneton>();
+	m_transient_textures = std::make_unique<cali::render_texture_pool>(*renderer.GetResourceManager());
+
+	m_bruneton = std::make_unique<cali::bruneton>(cali::atmosphere::lut_sizes_for(c_atmosphere_lut_tier));
 	if (!m_bruneton) return false;
 
-	m_bruneton->precompute(renderer);
+	// LUTs are cached next to the executable, like the eroded heightmaps
+	const std::string executable_dir = cali::get_executable_file_directory();
+	m_bruneton->precompute(renderer, *m_transient_textures,
+		executable_dir.empty() ? cali::asset_cache() : cali::asset_cache(executable_dir + "\\cache"));
+	m_debug_info.set_debug_string(m_bruneton->loaded_from_cache() ? L"atmosphere_warm_ms" : L"atmosphere_cold_ms",
+		(float)m_bruneton->precompute_ms());
+	m_debug_info.set_debug_string(L"atmosphere_peak_mb", (float)(m_bruneton->peak_bytes() / (1024.0 * 1024.0)));
+	m_debug_info.set_debug_string(L"atmosphere_resident_mb", (float)(m_bruneton->resident_bytes() / (1024.0 * 1024.0)));
+
+	// nothing else renders to the precompute intermediates
+	m_transient_textures->trim();
 
 #if defined WORK_ON_ICOSAHEDRON
 	m_terrain = std::unique_ptr<Cali::terrain_icosahedron>(new Cali::terrain_icosahedron);
 #elif defined WORK_ON_QUAD_TREE
 	m_terrain = std::unique_ptr<cali::terrain_quad>(new cali::terrain_quad(*m_bruneton));
+	m_aerial_perspective = std::make_unique<cali::aerial_perspective_volume>(renderer);
+	m_terrain->set_aerial_perspective(m_aerial_perspective->in_scattering_texture(),
+		m_aerial_perspective->transmittance_texture());
 #else
 	m_terrain = std::unique_ptr<Cali::terrain>(new Cali::terrain);
 #endif // !WORK_ON_ICOSAHEDRON
@@ -143,6 +180,8 @@ Game::PostRendererInitialize()
 
 	m_global_state_cbuffer = renderer.GetResourceManager()->CreateConstantBuffer(sizeof(constant_buffer::GlobalState));
 	if (!m_global_state_cbuffer.valid()) return false;
+	// no sky SH until the atmosphere has been projected once
+	for (IvVector4& c : m_global_state_cbuffer->sky_sh) c = { 0.f, 0.f, 0.f, 0.f };
 
 	renderer.SetConstantBuffer(m_global_state_cbuffer.ivcbuffer(), 1);
 
@@ -179,6 +218,7 @@ void Game::setup_controls()
 	m_controller.debug_info(std::bind(&Game::toggle_debug_info, &(*this), std::placeholders::_1));
 	m_controller.reset(std::bind(&Game::reset_scene, &(*this), std::placeholders::_1));
 	m_controller.stop(std::bind(&Game::stop_time, &(*this), std::placeholders::_1));
+	m_controller.atmosphere(std::bind(&Game::toggle_atmosphere, &(*this), std::placeholders::_1));
 }
 
 void Game::reset_scene(float dt)
@@ -191,6 +231,25 @@ void Game::stop_time(float dt)
 	m_stop_time = !m_stop_time;
 }
 
+// earth's sky and a hazy one; the key is ignored until the last switch is done
+void Game::toggle_atmosphere(float dt)
+{
+	if (m_bruneton->is_recomputing()) return;
+	m_hazy_atmosphere = !m_hazy_atmosphere;
+	cali::atmosphere::atmosphere_parameters atmosphere = cali::atmosphere::earth_atmosphere();
+	if (m_hazy_atmosphere)
+	{
+		atmosphere.mie_scattering = cali::atmosphere::rgba(0.02f, 0.02f, 0.02f);
+		atmosphere.mie_extinction = cali::atmosphere::rgba(0.022f, 0.022f, 0.022f);
+	}
+	m_bruneton->recompute(*IvRenderer::mRenderer, atmosphere);
+}
+
+double Game::seconds_since_start() const
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start_time).count();
+}
+
 void Game::on_window_resize(size_t width, size_t height)
 {
 	IvRenderer& renderer = *IvRenderer::mRenderer;
@@ -222,9 +281,26 @@ void Game::UpdateObjects(float dt)
 	m_global_state_cbuffer->sky_color_zenith = { 113.f / 255.f, 149.f / 255.f, 255.f / 255.f, 1.f };
 	m_global_state_cbuffer->sky_color_horizon = { 254.f / 255.f, 251.f / 255.f, 181.f / 255.f, 1.f };
 	
-	m_terrain->set_viewer(m_camera.get_position());
+	m_terrain->set_viewer(m_camera.get_world_position());
 	m_terrain->update(dt);
 
+#if defined WORK_ON_QUAD_TREE
+	// full quality = the final heightmap level is bound and rendered from this frame on
+	if (m_time_to_full_quality < 0.0 && m_terrain->height_map().generator().is_complete() &&
+		m_terrain->height_map().level() + 1 == m_terrain->height_map().generator().level_count())
+	{
+		m_time_to_full_quality = seconds_since_start();
+		m_debug_info.set_debug_string(L"time_to_full_quality", (float)m_time_to_full_quality);
+	}
+#endif
+
+	// new atmosphere parameters are precomputed a few ms per frame
+	if (m_bruneton->is_recomputing())
+	{
+		m_bruneton->update(*IvRenderer::mRenderer, c_atmosphere_budget_ms);
+		m_debug_info.set_debug_string(L"atmosphere_progress", m_bruneton->recompute_progress());
+	}
+
 	m_sun->update(dt);
 	{
 		IvVector3 gravity = m_camera.get_position() - cali::world::c_earth_center;
@@ -233,6 +309,54 @@ void Game::UpdateObjects(float dt)
 	}
 	m_sun->update_global_state(m_global_state_cbuffer);
 
+	// sun and sky colours from the LUTs once the CPU has a copy of them
+	if (auto atmosphere = m_bruneton->query())
+	{
+		const IvVector3 camera = (m_camera.get_position() - cali::world::c_earth_center) * (1.0f / c_world_units_per_km);
+		IvVector3 up = camera;
+		up.Normalize();
+		IvVector3 sun_direction = m_sun->get_position() - m_camera.get_position();
+		sun_direction.Normalize();
+		// the horizon below the sun
+		IvVector3 horizon = sun_direction - up * up.Dot(sun_direction);
+		if (horizon.IsZero()) horizon = Cross(up, IvVector3(1.f, 0.f, 0.f));
+		horizon.Normalize();
+
+		const IvVector3 view_rays[2] = { up, horizon };
+		cali::atmosphere::rgba radiance[2];
+		atmosphere->sky_radiance(camera, view_rays, 2, sun_direction, radiance);
+		m_global_state_cbuffer->sky_color_zenith = to_display_color(radiance[0]);
+		m_global_state_cbuffer->sky_color_horizon = to_display_color(radiance[1]);
+
+		const cali::atmosphere::rgba sun = atmosphere->sun_transmittance(camera, sun_direction);
+		m_global_state_cbuffer->sun_color = { sun.r, sun.g, sun.b, 1.f };
+
+		// ambient: the sky projected to SH again once the sun has moved enough
+		if (m_sky_ambient.update(atmosphere, camera, sun_direction))
+		{
+			const cali::atmosphere::sh9& sh = m_sky_ambient.irradiance();
+			for (int i = 0; i < 9; ++i)
+				m_global_state_cbuffer->sky_sh[i] = { sh.c[i].r, sh.c[i].g, sh.c[i].b, i == 0 ? 1.f : 0.f };
+			m_debug_info.set_debug_string(L"sky_ambient_projections", (float)m_sky_ambient.projections());
+		}
+
+		// aerial perspective of the terrain, a new froxel volume every frame
+		if (m_aerial_perspective)
+		{
+			IvRenderer& renderer = *IvRenderer::mRenderer;
+			cali::atmosphere::froxel_camera froxels;
+			froxels.position = camera;
+			froxels.forward = m_camera.get_direction();
+			froxels.right = m_camera.get_right();
+			froxels.up = froxels.forward.Cross(froxels.right);
+			froxels.up.Normalize();
+			froxels.tan_half_fov_y = IvTan(m_camera.get_fov() / 180.0f * kPI * 0.5f);
+			froxels.tan_half_fov_x = froxels.tan_half_fov_y * (float)renderer.GetWidth() / (float)renderer.GetHeight();
+			m_aerial_perspective->update(renderer, *atmosphere, froxels, sun_direction, c_world_units_per_km);
+			m_debug_info.set_debug_string(L"aerial_perspective_ms", (float)m_aerial_perspective->last_compute_ms());
+		}
+	}
+
     m_stars->update(dt);
 
 	m_camera.update_global_state(m_global_state_cbuffer);
@@ -282,5 +406,11 @@ void Game::Render() // Here's Where We Do All The Drawing
 	{
 		m_debug_info.render(renderer);
 	}
+
+	if (m_time_to_first_frame < 0.0)
+	{
+		m_time_to_first_frame = seconds_since_start();
+		m_debug_info.set_debug_string(L"time_to_first_frame", (float)m_time_to_first_frame);
+	}
 } // End of Game::Render()
 
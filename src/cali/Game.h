@@ -10,6 +10,7 @@
 
 #include <IvGame.h>
 #include <memory>
+#include <chrono>
 
 #include "InputController.h"
 #include "Camera.h"
@@ -20,6 +21,8 @@
 #include "ConstantBufferWrapper.h"
 #include "PostEffect.h"
 #include "Bruneton.h"
+#include "AtmosphereAmbient.h"
+#include "AerialPerspective.h"
 #include "Stars.h"
 
 #include <IvRenderTexture.h>
@@ -46,7 +49,10 @@ class Game : public IvGame
 #else
 	std::unique_ptr<Cali::terrain> m_terrain;
 #endif // !WORK_ON_ICOSAHEDRON
+	std::unique_ptr<cali::render_texture_pool> m_transient_textures;
 	std::unique_ptr<cali::bruneton> m_bruneton;
+	cali::atmosphere::sky_ambient m_sky_ambient;
+	std::unique_ptr<cali::aerial_perspective_volume> m_aerial_perspective;
 	std::unique_ptr<cali::sky> m_sky;
 	std::unique_ptr<cali::sun> m_sun;
     std::unique_ptr<cali::stars> m_stars;
@@ -60,6 +66,12 @@ class Game : public IvGame
 	bool m_render_wireframe;
 	bool m_render_debug_info;
 	bool m_stop_time;
+	bool m_hazy_atmosphere;
+
+	// startup timings in seconds since Game creation, negative until reached
+	std::chrono::steady_clock::time_point m_start_time;
+	double m_time_to_first_frame;
+	double m_time_to_full_quality;
 
 private:
 	void toggle_wireframe(float dt);
@@ -68,6 +80,8 @@ private:
 
 	void reset_scene(float dt);
 	void stop_time(float dt);
+	void toggle_atmosphere(float dt);
+	double seconds_since_start() const;
 
 	friend void on_window_resize(unsigned int width, unsigned int height);
 	virtual void on_window_resize(size_t width, size_t height);
@@ -1,103 +1,16 @@
 #include "Icosahedron.h"
 
-#include <map>
-#include <array>
+#include "Icosphere.h"
 
 namespace cali
 {
-	struct triangle
-	{
-		uint32_t vertex[3];
-	};
-
-	using TriangleList = std::vector<triangle>;
-	using VertexList = std::vector<IvVector3>;
-
-	namespace utils
-	{
-		const float X = .525731112119133606f;
-		const float Z = .850650808352039932f;
-		const float N = 0.f;
-
-		using Index = UInt32;
-
-		static const VertexList vertices =
-		{
-			{ -X,N,Z },{ X,N,Z },{ -X,N,-Z },{ X,N,-Z },
-			{ N,Z,X },{ N,Z,-X },{ N,-Z,X },{ N,-Z,-X },
-			{ Z,X,N },{ -Z,X, N },{ Z,-X,N },{ -Z,-X, N }
-		};
-
-		static const TriangleList triangles =
-		{
-			{ 0,4,1 },{ 0,9,4 },{ 9,5,4 },{ 4,5,8 },{ 4,8,1 },
-			{ 8,10,1 },{ 8,3,10 },{ 5,3,8 },{ 5,2,3 },{ 2,7,3 },
-			{ 7,10,3 },{ 7,6,10 },{ 7,11,6 },{ 11,0,6 },{ 0,1,6 },
-			{ 6,1,10 },{ 9,0,11 },{ 9,11,2 },{ 9,2,5 },{ 7,2,11 }
-		};
-
-		using Lookup = std::map<std::pair<Index, Index>, Index>;
-
-		Index vertex_for_edge(Lookup& lookup,
-			VertexList& vertices, Index first, Index second)
-		{
-			Lookup::key_type key(first, second);
-			if (key.first > key.second)	std::swap(key.first, key.second);
-
-			auto inserted = lookup.insert({ key, (Index)vertices.size() });
-			if (inserted.second)
-			{
-				auto& edge0 = vertices[first];
-				auto& edge1 = vertices[second];
-				auto point = (edge0 + edge1);
-				point.Normalize();
-				vertices.push_back(point);
-			}
-
-			return inserted.first->second;
-		}
-
-		TriangleList subdivide(VertexList& vertices, TriangleList triangles)
-		{
-			Lookup lookup;
-			TriangleList result;
-
-			for (auto&& each : triangles)
-			{
-				std::array<Index, 3> mid;
-				for (int edge = 0; edge<3; ++edge)
-				{
-					mid[edge] = vertex_for_edge(lookup, vertices,
-						each.vertex[edge], each.vertex[(edge + 1) % 3]);
-				}
-
-				result.push_back({ each.vertex[0], mid[0], mid[2] });
-				result.push_back({ each.vertex[1], mid[1], mid[0] });
-				result.push_back({ each.vertex[2], mid[2], mid[1] });
-				result.push_back({ mid[0], mid[1], mid[2] });
-			}
-
-			return result;
-		}
-
-		using IndexedMesh = std::pair<VertexList, TriangleList>;
-
-		void make_icosphere(VertexList& vertices, TriangleList& triangles, size_t subdivisions)
-		{
-			vertices = utils::vertices;
-			triangles = utils::triangles;
-
-			for (size_t i = 0; i < subdivisions; ++i)
-			{
-				triangles = subdivide(vertices, triangles);
-			}
-		}
-	}
+	// built by the compiler: no subdivision and no static initializer at startup
+	static constexpr icosphere::level<3> c_icosphere = icosphere::mesh<3>();
 
 	void icosahedron::create_icosahedron()
 	{
-		VertexList ico_vertices; TriangleList ico_triangles;
-		utils::make_icosphere(ico_vertices, ico_triangles, 3);
+		const auto& ico_vertices = c_icosphere.vertices;
+		const auto& ico_triangles = c_icosphere.triangles;
 
 		const size_t indices_total = ico_triangles.size() * 3;
 		const size_t vertex_total = ico_vertices.size();
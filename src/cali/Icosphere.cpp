@@ -0,0 +1,61 @@
+#include "Icosphere.h"
+
+#include <map>
+#include <utility>
+
+namespace cali
+{
+namespace icosphere
+{
+	namespace
+	{
+		using index = uint32_t;
+		using lookup = std::map<std::pair<index, index>, index>;
+
+		index vertex_for_edge(lookup& edges, vertex_list& vertices, index first, index second)
+		{
+			lookup::key_type key(first, second);
+			if (key.first > key.second) std::swap(key.first, key.second);
+
+			auto inserted = edges.insert({ key, (index)vertices.size() });
+			if (inserted.second)
+			{
+				IvVector3 point = vertices[first] + vertices[second];
+				point.Normalize();
+				vertices.push_back(point);
+			}
+
+			return inserted.first->second;
+		}
+
+		triangle_list subdivide(vertex_list& vertices, const triangle_list& triangles)
+		{
+			lookup edges;
+			triangle_list result;
+
+			for (const triangle& each : triangles)
+			{
+				index mid[3];
+				for (int edge = 0; edge < 3; ++edge)
+					mid[edge] = vertex_for_edge(edges, vertices, each.vertex[edge], each.vertex[(edge + 1) % 3]);
+
+				result.push_back({ { each.vertex[0], mid[0], mid[2] } });
+				result.push_back({ { each.vertex[1], mid[1], mid[0] } });
+				result.push_back({ { each.vertex[2], mid[2], mid[1] } });
+				result.push_back({ { mid[0], mid[1], mid[2] } });
+			}
+
+			return result;
+		}
+	}
+
+	void make_icosphere(vertex_list& vertices, triangle_list& triangles, size_t subdivisions)
+	{
+		vertices.assign(c_icosahedron.vertices.begin(), c_icosahedron.vertices.end());
+		triangles.assign(c_icosahedron.triangles.begin(), c_icosahedron.triangles.end());
+
+		for (size_t i = 0; i < subdivisions; ++i)
+			triangles = subdivide(vertices, triangles);
+	}
+}
+}
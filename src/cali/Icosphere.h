@@ -0,0 +1,157 @@
+#pragma once
+#include <IvMath.h>
+#include <IvVector3.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cali
+{
+	namespace icosphere
+	{
+		// -----------------------------------------------------------------
+		// The icosahedron and its subdivisions, each edge split at the
+		// normalized midpoint. mesh<S>() builds level S at compile time;
+		// make_icosphere() is the same subdivision at run time, for any
+		// level, and gives the same vertices and triangles bit for bit.
+		// -----------------------------------------------------------------
+
+		struct triangle
+		{
+			uint32_t vertex[3];
+		};
+
+		using vertex_list = std::vector<IvVector3>;
+		using triangle_list = std::vector<triangle>;
+
+		template <size_t Subdivisions>
+		struct level
+		{
+			static constexpr size_t triangle_count = (size_t)20 << (2 * Subdivisions);
+			static constexpr size_t vertex_count = triangle_count / 2 + 2;
+
+			std::array<IvVector3, vertex_count> vertices;
+			std::array<triangle, triangle_count> triangles;
+		};
+
+		namespace detail
+		{
+			constexpr float X = .525731112119133606f;
+			constexpr float Z = .850650808352039932f;
+			constexpr float N = 0.f;
+
+			// sqrtf() for a constant expression: Newton in double on the value
+			// scaled by powers of 4 into [1, 4), where the root is in [1, 2) and
+			// floats are 2^-23 apart, then rounded to the nearest float. The
+			// midpoints between floats have 25 bits, so their squares are exact
+			// in double and never equal to the value.
+			constexpr float sqrt(float value)
+			{
+				if (value <= 0.0f) return 0.0f;
+				double x = value, scale = 1.0;
+				while (x >= 4.0) { x *= 0.25; scale *= 2.0; }
+				while (x < 1.0) { x *= 4.0; scale *= 0.5; }
+
+				double r = 1.5;
+				for (int i = 0; i < 6; ++i) r = 0.5 * (r + x / r);
+
+				const double step = 1.0 / 8388608.0;
+				double f = (float)r;
+				if ((f + step / 2.0) * (f + step / 2.0) < x) f += step;
+				else if ((f - step / 2.0) * (f - step / 2.0) > x) f -= step;
+				return (float)(f * scale);
+			}
+
+			// IvVector3::Normalize() with the sqrt above
+			constexpr IvVector3 normalized(IvVector3 v)
+			{
+				const float lengthsq = v.x * v.x + v.y * v.y + v.z * v.z;
+				if (lengthsq <= kEpsilon) return IvVector3(0.0f, 0.0f, 0.0f);
+				const float factor = 1.0f / sqrt(lengthsq);
+				v.x *= factor;
+				v.y *= factor;
+				v.z *= factor;
+				return v;
+			}
+
+			struct edge
+			{
+				uint32_t first, second, middle;
+			};
+
+			// Like make_icosphere()'s map of edges, but a linear search: the new
+			// vertices are numbered in the order the triangles first reach them
+			template <size_t Subdivisions>
+			constexpr level<Subdivisions> subdivide(const level<Subdivisions - 1>& coarse)
+			{
+				level<Subdivisions> fine{};
+				std::array<edge, level<Subdivisions>::vertex_count> edges{};
+				size_t vertex_count = coarse.vertices.size(), edge_count = 0;
+				for (size_t i = 0; i < vertex_count; ++i) fine.vertices[i] = coarse.vertices[i];
+
+				for (size_t t = 0; t < coarse.triangles.size(); ++t)
+				{
+					const triangle& each = coarse.triangles[t];
+					uint32_t mid[3] = {};
+					for (int e = 0; e < 3; ++e)
+					{
+						uint32_t first = each.vertex[e], second = each.vertex[(e + 1) % 3];
+						if (first > second)
+						{
+							const uint32_t swap = first;
+							first = second;
+							second = swap;
+						}
+
+						size_t found = edge_count;
+						for (size_t i = 0; i < edge_count; ++i)
+							if (edges[i].first == first && edges[i].second == second) found = i;
+						if (found == edge_count)
+						{
+							edges[edge_count++] = { first, second, (uint32_t)vertex_count };
+							fine.vertices[vertex_count++] = normalized(coarse.vertices[first] + coarse.vertices[second]);
+						}
+						mid[e] = edges[found].middle;
+					}
+
+					fine.triangles[4 * t + 0] = { { each.vertex[0], mid[0], mid[2] } };
+					fine.triangles[4 * t + 1] = { { each.vertex[1], mid[1], mid[0] } };
+					fine.triangles[4 * t + 2] = { { each.vertex[2], mid[2], mid[1] } };
+					fine.triangles[4 * t + 3] = { { mid[0], mid[1], mid[2] } };
+				}
+				return fine;
+			}
+		}
+
+		constexpr level<0> c_icosahedron = {
+			{ {
+				{ -detail::X, detail::N, detail::Z }, { detail::X, detail::N, detail::Z },
+				{ -detail::X, detail::N, -detail::Z }, { detail::X, detail::N, -detail::Z },
+				{ detail::N, detail::Z, detail::X }, { detail::N, detail::Z, -detail::X },
+				{ detail::N, -detail::Z, detail::X }, { detail::N, -detail::Z, -detail::X },
+				{ detail::Z, detail::X, detail::N }, { -detail::Z, detail::X, detail::N },
+				{ detail::Z, -detail::X, detail::N }, { -detail::Z, -detail::X, detail::N },
+			} },
+			{ {
+				{ { 0, 4, 1 } }, { { 0, 9, 4 } }, { { 9, 5, 4 } }, { { 4, 5, 8 } }, { { 4, 8, 1 } },
+				{ { 8, 10, 1 } }, { { 8, 3, 10 } }, { { 5, 3, 8 } }, { { 5, 2, 3 } }, { { 2, 7, 3 } },
+				{ { 7, 10, 3 } }, { { 7, 6, 10 } }, { { 7, 11, 6 } }, { { 11, 0, 6 } }, { { 0, 1, 6 } },
+				{ { 6, 1, 10 } }, { { 9, 0, 11 } }, { { 9, 11, 2 } }, { { 9, 2, 5 } }, { { 7, 2, 11 } },
+			} },
+		};
+
+		template <size_t Subdivisions>
+		constexpr level<Subdivisions> mesh()
+		{
+			if constexpr (Subdivisions == 0)
+				return c_icosahedron;
+			else
+				return detail::subdivide<Subdivisions>(mesh<Subdivisions - 1>());
+		}
+
+		// Run-time subdivision of the icosahedron
+		void make_icosphere(vertex_list& vertices, triangle_list& triangles, size_t subdivisions);
+	}
+}
@@ -71,6 +71,7 @@ namespace cali
 			if (state.F10) invoke_callback(m_debug_info, dt);
 			if (state.F8) invoke_callback(m_reset, dt);
 			if (state.F7) invoke_callback(m_stop, dt);
+			if (state.F6) invoke_callback(m_atmosphere, dt);
 
 			if (state.R) invoke_callback(m_mouse_y, -5.0f, dt);
 			if (state.F) invoke_callback(m_mouse_y, 5.0f, dt);
@@ -30,6 +30,7 @@ namespace cali
 		std::function<t_simple_input> m_reset;
 		std::function<t_simple_input> m_stop;
 		std::function<t_simple_input> m_debug_info;
+		std::function<t_simple_input> m_atmosphere;
 
 		std::function<t_MouseInput> m_mouse_x;
 		std::function<t_MouseInput> m_mouse_y;
@@ -56,6 +57,7 @@ namespace cali
 		void reset(std::function<t_simple_input> callback) { m_reset = callback; }
 		void stop(std::function<t_simple_input> callback) { m_stop = callback; }
 		void debug_info(std::function<t_simple_input> callback) { m_debug_info = callback; }
+		void atmosphere(std::function<t_simple_input> callback) { m_atmosphere = callback; }
 		void mouse_x(std::function<t_MouseInput> callback) { m_mouse_x = callback; }
 		void mouse_y(std::function<t_MouseInput> callback) { m_mouse_y = callback; }
 	};
@@ -10,6 +10,7 @@
 #include <IvRenderer.h>
 #include <IvResourceManager.h>
 
+#include <iterator>
 #include <memory>
 #include <vector>
 
@@ -184,6 +185,19 @@ namespace cali
 	
     model<kTNPFormat, IvTNPVertex> create_box(const IvVector3& size, bool right_hand_order, bool invert_normals);
 
+	/*
+	-1,1     1,1
+	0    |    1
+	*    |    *
+	-----+-----
+	3    |    2
+	*    |    *
+	-1,-1    1,-1
+	*/
+	inline constexpr IvVector3 c_quad_corners[4] = { { -1.f, 1.f, 0.f }, { 1.f, 1.f, 0.f }, { 1.f, -1.f, 0.f }, { -1.f, -1.f, 0.f } };
+	inline constexpr IvVector2 c_quad_texcoords[4] = { { 0.f, 0.f }, { 1.f, 0.f }, { 1.f, 1.f }, { 0.f, 1.f } };
+	inline constexpr UInt32 c_quad_indices[6] = { 0, 1, 3, 1, 2, 3 };
+
 	template<IvVertexFormat vertex_format_code, typename t_VertexFormat>
     void create_quad(model<vertex_format_code, t_VertexFormat>& model, const IvVector3& size, bool right_hand_order, bool invert_normals)
 	{
@@ -193,27 +207,10 @@ namespace cali
 		IvVector3 tsize = size;
 		tsize /= 2.f;
 
-		/*
-		-1,1     1,1
-		0    |    1
-		*    |    *
-		-----+-----
-		3    |    2
-		*    |    *
-		-1,-1    1,-1
-		*/
-
-		vertices_mem.push_back({{ 0.f, 1.f, 0.f }, IvVector3{ -1.f, 1.f, 0.f} * tsize });
-		vertices_mem.push_back({{ 0.f, 1.f, 0.f }, IvVector3{ 1.f, 1.f, 0.f} * tsize });
-		vertices_mem.push_back({{ 0.f, 1.f, 0.f }, IvVector3{ 1.f, -1.f, 0.f} * tsize });
-		vertices_mem.push_back({{ 0.f, 1.f, 0.f }, IvVector3{ -1.f, -1.f, 0.f} * tsize });
-
-		indices_mem.push_back(0);
-		indices_mem.push_back(1);
-		indices_mem.push_back(3);
-		indices_mem.push_back(1);
-		indices_mem.push_back(2);
-		indices_mem.push_back(3);
+		for (const IvVector3& corner : c_quad_corners)
+			vertices_mem.push_back({{ 0.f, 1.f, 0.f }, corner * tsize });
+
+		indices_mem.assign(std::begin(c_quad_indices), std::end(c_quad_indices));
 
 		if (!right_hand_order) reverse_winding(indices_mem, vertices_mem);
 
@@ -228,27 +225,10 @@ namespace cali
 		IvVector3 tsize = size;
 		tsize /= 2.f;
 
-		/*
-		-1,1     1,1
-		0    |    1
-		*    |    *
-		-----+-----
-		3    |    2
-		*    |    *
-		-1,-1    1,-1
-		*/
-
-		vertices_mem.push_back({ { 0.f, 0.f }, { 0.f, 1.f, 0.f }, IvVector3{ -1.f, 1.f, 0.f} * tsize });
-		vertices_mem.push_back({ { 1.f, 0.f }, { 0.f, 1.f, 0.f }, IvVector3{ 1.f, 1.f, 0.f} * tsize });
-		vertices_mem.push_back({ { 1.f, 1.f }, { 0.f, 1.f, 0.f }, IvVector3{ 1.f, -1.f, 0.f} * tsize });
-		vertices_mem.push_back({ { 0.f, 1.f }, { 0.f, 1.f, 0.f }, IvVector3{ -1.f, -1.f, 0.f} * tsize });
-
-		indices_mem.push_back(0);
-		indices_mem.push_back(1);
-		indices_mem.push_back(3);
-		indices_mem.push_back(1);
-		indices_mem.push_back(2);
-		indices_mem.push_back(3);
+		for (int i = 0; i < 4; ++i)
+			vertices_mem.push_back({ c_quad_texcoords[i], { 0.f, 1.f, 0.f }, c_quad_corners[i] * tsize });
+
+		indices_mem.assign(std::begin(c_quad_indices), std::end(c_quad_indices));
 
 		if (!right_hand_order) reverse_winding(indices_mem, vertices_mem);
 
@@ -0,0 +1,93 @@
+#include "PatchBounds.h"
+
+#include <IvCovariance.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace cali
+{
+	patch_bounds fit_oriented_box(const IvDoubleVector3* points, size_t count)
+	{
+		IvDoubleVector3 mean(0.0, 0.0, 0.0);
+		for (size_t i = 0; i < count; ++i) mean += points[i];
+		mean /= (double)count;
+
+		std::vector<IvVector3> offsets(count);
+		for (size_t i = 0; i < count; ++i) offsets[i] = (IvVector3)(points[i] - mean);
+
+		IvMatrix33 covariance;
+		IvVector3 offset_mean;
+		IvComputeCovarianceMatrix(covariance, offset_mean, offsets.data(), (unsigned int)count);
+		IvVector3 axes[3];
+		IvGetRealSymmetricEigenvectors(axes[0], axes[1], axes[2], covariance);
+
+		// orthonormal and right-handed whatever the eigenvectors came out as
+		axes[0].Normalize();
+		axes[2] = axes[0].Cross(axes[1]);
+		axes[2].Normalize();
+		axes[1] = axes[2].Cross(axes[0]);
+
+		double lo[3] = { DBL_MAX, DBL_MAX, DBL_MAX }, hi[3] = { -DBL_MAX, -DBL_MAX, -DBL_MAX };
+		for (size_t i = 0; i < count; ++i)
+			for (int k = 0; k < 3; ++k)
+			{
+				const double along = (double)offsets[i].x * axes[k].x + (double)offsets[i].y * axes[k].y + (double)offsets[i].z * axes[k].z;
+				lo[k] = std::min(lo[k], along);
+				hi[k] = std::max(hi[k], along);
+			}
+
+		patch_bounds bounds;
+		bounds.center = mean;
+		for (int k = 0; k < 3; ++k)
+		{
+			bounds.center += IvDoubleVector3(axes[k]) * (0.5 * (lo[k] + hi[k]));
+			bounds.extents[k] = (float)(0.5 * (hi[k] - lo[k]));
+		}
+		bounds.rotation.SetColumns(axes[0], axes[1], axes[2]);
+		return bounds;
+	}
+
+	void sample_patch(Math::CubeFace face, double min_x, double min_y, double max_x, double max_y, double sphere_radius,
+		const IvDoubleVector3& sphere_center, double min_height, double max_height, std::vector<IvDoubleVector3>& samples)
+	{
+		samples.clear();
+		for (int j = 0; j < c_patch_samples; ++j)
+			for (int i = 0; i < c_patch_samples; ++i)
+			{
+				const double x = min_x + (max_x - min_x) * i / (c_patch_samples - 1);
+				const double y = min_y + (max_y - min_y) * j / (c_patch_samples - 1);
+				IvDoubleVector3 normal;
+				const IvDoubleVector3 surface = Math::adjusted_cube_to_sphere_face(face, x, y, sphere_radius, sphere_center, normal);
+				samples.push_back(surface + normal * min_height);
+				samples.push_back(surface + normal * max_height);
+			}
+	}
+
+	patch_bounds fit_patch_bounds(Math::CubeFace face, double min_x, double min_y, double max_x, double max_y,
+		double sphere_radius, const IvDoubleVector3& sphere_center, double min_height, double max_height)
+	{
+		std::vector<IvDoubleVector3> samples;
+		sample_patch(face, min_x, min_y, max_x, max_y, sphere_radius, sphere_center, min_height, max_height, samples);
+		patch_bounds bounds = fit_oriented_box(samples.data(), samples.size());
+
+		// A line of constant x on a face is a meridian and one of constant y a
+		// great circle tilted about x, so between the samples of a cell the
+		// surface at any height is within the sagitta of one arc along x plus
+		// one along y of the samples around it. An arc spans at most
+		// a = pi / 4 * step / R, and its sagitta r (1 - cos(a / 2)) is largest
+		// at the top; the rest is for the offsets rounded to float
+		const double radius = sphere_radius + max_height;
+		double bulge = 0.0;
+		for (double step : { (max_x - min_x) / (c_patch_samples - 1), (max_y - min_y) / (c_patch_samples - 1) })
+		{
+			const double half_angle = kPI / 8.0 * std::abs(step) / sphere_radius;
+			bulge += 2.0 * radius * std::sin(0.5 * half_angle) * std::sin(0.5 * half_angle);
+		}
+		const float largest = std::max(bounds.extents.x, std::max(bounds.extents.y, bounds.extents.z));
+		const float margin = (float)bulge + largest * 1e-5f + 1e-3f;
+		bounds.extents += IvVector3(margin, margin, margin);
+		return bounds;
+	}
+}
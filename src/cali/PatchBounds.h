@@ -0,0 +1,52 @@
+#pragma once
+#include <IvDoubleVector3.h>
+#include <IvMatrix33.h>
+#include <IvVector3.h>
+
+#include "CaliSphereMath.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace cali
+{
+	// The highest terrain above the sphere: terrain_quad.hlslv displaces a
+	// vertex by sqrt(h) * 1500 * 0.1 along the normal, h in [0, 1]
+	const double c_terrain_max_height = 150.0;
+
+	// Samples per side of a patch
+	const int c_patch_samples = 5;
+
+	// -----------------------------------------------------------------
+	// Oriented bounding boxes of terrain patches. A patch on a tilted part
+	// of the sphere gets an axis-aligned box many times its volume; the
+	// box of its covariance lies along it. fit_oriented_box() takes the
+	// axes from IvComputeCovarianceMatrix() and
+	// IvGetRealSymmetricEigenvectors() over the points relative to their
+	// mean (in float, which is exact enough for offsets within a patch)
+	// and the extents from the points projected on them, the centre in
+	// double.
+	//
+	// fit_patch_bounds() samples a patch on a c_patch_samples grid of its
+	// cube face, at the surface and at the top of the height range, and
+	// grows the box by the most the sphere bulges out between samples, so
+	// the terrain between them is inside it too.
+	// -----------------------------------------------------------------
+	struct patch_bounds
+	{
+		IvDoubleVector3 center;
+		IvMatrix33 rotation; // columns are the axes, as IvOBB's
+		IvVector3 extents;
+	};
+
+	patch_bounds fit_oriented_box(const IvDoubleVector3* points, size_t count);
+
+	// The patch of face over [min_x, max_x] x [min_y, max_y] on the cube, as
+	// terrain_quad::calculate_sphere_surface_quad() maps it, min_height to
+	// max_height above the sphere
+	void sample_patch(Math::CubeFace face, double min_x, double min_y, double max_x, double max_y, double sphere_radius,
+		const IvDoubleVector3& sphere_center, double min_height, double max_height, std::vector<IvDoubleVector3>& samples);
+	patch_bounds fit_patch_bounds(Math::CubeFace face, double min_x, double min_y, double max_x, double max_y,
+		double sphere_radius, const IvDoubleVector3& sphere_center, double min_height = 0.0,
+		double max_height = c_terrain_max_height);
+}
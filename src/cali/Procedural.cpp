@@ -1,13 +1,16 @@
 #include "Procedural.h"
+#include "ProceduralNoise.h"
+#include "ProceduralErosion.h"
 
-#include <IvRenderer.h>
-#include <IvResourceManager.h>
-#include <IvTexture.h>
+#include <IvMath.h>
+#include <IvDoubleVector3.h>
+#include "CaliSphereMath.h"
 
 #include <vector>
 #include <cmath>
 #include <algorithm>
 #include <cstring>
+#include <thread>
 
 namespace cali
 {
@@ -27,77 +30,16 @@ uint64_t splitmix64(uint64_t x){
     x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
     return x ^ (x >> 31);
 }
-static inline uint64_t hash_coords(int x,int y,uint64_t seed){
-    uint64_t h = seed;
-    h ^= (uint64_t)(uint32_t)x * 0x9e3779b97f4a7c15ULL;
-    h ^= (uint64_t)(uint32_t)y * 0xbf58476d1ce4e5b9ULL;
-    h ^= ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
-    return splitmix64(h);
-}
-static inline float hash_to_float(uint64_t h){ return (h >> 32) * (1.0f / 4294967295.0f); }
-static inline float lerp_f(float a,float b,float t){ return a + t*(b-a); }
-static inline float smootherstep(float t){ return t*t*t*(t*(t*6 -15)+10); }
-
-static float value_noise(float x,float y,uint64_t seed,int periodX,int periodY){
-    int xi=(int)floorf(x), yi=(int)floorf(y);
-    float xf=x-(float)xi, yf=y-(float)yi;
-    float u=smootherstep(xf), v=smootherstep(yf);
-    auto wrap=[](int v,int p)->int{ if(p<=0) return v; int r=v%p; if(r<0) r+=p; return r; };
-    int xi0=wrap(xi,periodX), yi0=wrap(yi,periodY);
-    int xi1=wrap(xi+1,periodX), yi1=wrap(yi+1,periodY);
-    float h00=hash_to_float(hash_coords(xi0,yi0,seed));
-    float h10=hash_to_float(hash_coords(xi1,yi0,seed));
-    float h01=hash_to_float(hash_coords(xi0,yi1,seed));
-    float h11=hash_to_float(hash_coords(xi1,yi1,seed));
-    float x1=lerp_f(h00,h10,u), x2=lerp_f(h01,h11,u);
-    return lerp_f(x1,x2,v);
-}
-static float fbm_internal(float x,float y,uint64_t seed,int octaves,float persistence,float lacunarity,int periodX,int periodY){
-    float total=0, amp=1, freq=1, maxAmp=0;
-    for(int i=0;i<octaves;++i){
-        int pX=periodX>0?(int)(periodX*freq):0; if(pX==0) pX=periodX;
-        int pY=periodY>0?(int)(periodY*freq):0; if(pY==0) pY=periodY;
-        float n=value_noise(x*freq,y*freq,seed+(uint64_t)i*0x9e3779b97f4a7c15ULL,pX,pY);
-        total+=n*amp; maxAmp+=amp; amp*=persistence; freq*=lacunarity;
-    }
-    return total/maxAmp;
-}
-float sample_fbm(float x,float y,uint64_t seed,int periodX,int periodY){ return fbm_internal(x,y,seed,6,0.5f,2.0f,periodX,periodY); }
+using namespace noise;
 
-static float voronoi(float x,float y,float cellSize,uint64_t seed,int periodX,int periodY, float* outBorder=nullptr, float* outCellValue=nullptr){
-    int cellsX = periodX>0 ? std::max(1, (int)(periodX / cellSize + 0.5f)) : 64;
-    int cellsY = periodY>0 ? std::max(1, (int)(periodY / cellSize + 0.5f)) : 64;
-    float fx = x / cellSize, fy = y / cellSize;
-    int cxi = (int)floorf(fx), cyi = (int)floorf(fy);
-    float fxf = fx - cxi, fyf = fy - cyi;
-    float minDist=1e6, secondDist=1e6;
-    int bestCx=0,bestCy=0;
-    for(int dy=-1;dy<=1;++dy) for(int dx=-1;dx<=1;++dx){
-        int ncx=cxi+dx, ncy=cyi+dy;
-        int wcx = ((ncx % cellsX)+cellsX)%cellsX;
-        int wcy = ((ncy % cellsY)+cellsY)%cellsY;
-        uint64_t h = hash_coords(wcx,wcy,seed);
-        float ox = hash_to_float(h);
-        uint64_t h2 = hash_coords(wcx,wcy,seed ^ 0x9e3779b97f4a7c15ULL);
-        float oy = hash_to_float(h2);
-        float px = (float)dx + ox - fxf;
-        float py = (float)dy + oy - fyf;
-        float d = sqrtf(px*px + py*py);
-        if(d < minDist){ secondDist=minDist; minDist=d; bestCx=wcx; bestCy=wcy; }
-        else if(d < secondDist){ secondDist=d; }
-    }
-    if(outBorder) *outBorder = secondDist - minDist;
-    if(outCellValue){
-        uint64_t hc = hash_coords(bestCx,bestCy,seed ^ 0x6a09e667f3bcc908ULL);
-        *outCellValue = hash_to_float(hc);
-    }
-    return std::clamp(minDist / 1.41421356f, 0.0f, 1.0f);
+float sample_fbm(float x,float y,uint64_t seed,int periodX,int periodY){ return fbm_internal(x,y,seed,6,0.5f,2.0f,periodX,periodY); }
+float sample_fbm_3d(float x,float y,float z,uint64_t seed){ return fbm_3d(x,y,z,seed,6,0.5f,2.0f); }
+float sample_voronoi(float x,float y,float cell_size,uint64_t seed,int periodX,int periodY,float* border,float* cell_value){
+    return voronoi(x,y,cell_size,seed,periodX,periodY,border,cell_value);
 }
 
-IvTexture* generate_heightmap_texture(uint64_t seed,int width,int height){
-    auto& renderer=*IvRenderer::mRenderer;
-    auto& resman=*renderer.GetResourceManager();
-    std::vector<unsigned char> data((size_t)width*height*3);
+void generate_heightmap_heights(uint64_t seed,int width,int height,std::vector<float>& heights){
+    heights.resize((size_t)width*height);
     int periodX=width, periodY=height;
     uint64_t seedBase=seed;
     uint64_t seedDetail=splitmix64(seed+0x123456789ABCDEF0ULL);
@@ -106,81 +48,166 @@ IvTexture* generate_heightmap_texture(uint64_t seed,int width,int height){
     const float cellLarge = (float)width / 7.0f;
     const float cellSmall = (float)width / 28.0f;
     for(int y=0;y<height;++y) for(int x=0;x<width;++x){
-        // soft continents: low frequency, few octaves, low persistence
+        terrain_inputs in;
         float u_cont = (float)x / width * 3.5f;
         float v_cont = (float)y / height * 3.5f;
-        float continent = fbm_internal(u_cont, v_cont, seedBase, 3, 0.42f, 2.0f, 4, 4);
-        // large voronoi soft blend – subtle, not dominant
-        float vorL = voronoi((float)x,(float)y,cellLarge,seedVorL,periodX,periodY);
-        float vorCellVal;
-        voronoi((float)x,(float)y,cellLarge,seedVorL,periodX,periodY,nullptr,&vorCellVal);
-        float continentVor = 1.0f - vorL;
-        continentVor = powf(continentVor, 2.2f); // very soft
-        float base = lerp_f(continent, continentVor, 0.20f); // only 20% voronoi influence
-        // remap to 0-1 with soft contrast
-        base = std::clamp((base - 0.38f) / 0.50f, 0.0f, 1.0f);
-        base = lerp_f(base, smootherstep(base), 0.4f); // soften
-
-        // fine detail – very low amplitude for soft hills
+        in.continent = fbm_internal(u_cont, v_cont, seedBase, 3, 0.42f, 2.0f, 4, 4);
+        in.vor_large = voronoi((float)x,(float)y,cellLarge,seedVorL,periodX,periodY,&in.vor_border,&in.vor_cell);
         float u_det = (float)x / width * 22.0f;
         float v_det = (float)y / height * 22.0f;
-        float detail = fbm_internal(u_det, v_det, seedDetail, 2, 0.40f, 2.2f, 22, 22);
-        detail = (detail - 0.5f) * 0.08f; // tiny variation
-
-        // mountain ridges – only where base is high (mountain mask)
-        float mountainMask = smootherstep(std::clamp((base - 0.45f)/0.35f, 0.0f, 1.0f)); // 0 in lowlands, 1 in highlands
-        mountainMask = powf(mountainMask, 0.9f);
-        float mountVar = 0.55f + vorCellVal * 1.1f; // 0.55-1.65, high vs mid
-
-        // small Voronoi ridges localized to mountains
-        float vorS = voronoi((float)x,(float)y,cellSmall,seedVorS,periodX,periodY);
-        float ridgeS = 1.0f - fabsf(vorS*2.0f - 1.0f);
-        ridgeS = powf(std::max(0.0f, ridgeS), 2.2f) * 0.10f * mountainMask * mountVar;
-
-        // large ridge at continent borders – subtle
-        float vorBorder; voronoi((float)x,(float)y,cellLarge,seedVorL,periodX,periodY,&vorBorder,nullptr);
-        float largeRidge = powf(std::max(0.0f, 1.0f - vorBorder*3.0f), 2.0f) * 0.06f * mountainMask * mountVar;
-
-        float h = base + detail + ridgeS + largeRidge;
-        h = std::clamp(h, 0.0f, 1.0f);
-        // final soften
-        h = lerp_f(h, smootherstep(h), 0.25f);
-
-        const float sea = 0.50f; // more ocean (50%)
-        float tex;
-        if(h < sea){
-            float t = h / sea;
-            t = powf(t, 1.2f);
-            tex = t * 0.0032f; // ocean 0..0.0032 -> height 0..8.5
-        }else{
-            float t = (h - sea) / (1.0f - sea);
-            t = powf(t, 0.88f);
-            // base land, 3x peaks with variability
-            // high cells get up to 3x, mid cells ~1.5x
-            float peakScale = 0.55f * (0.75f + 0.5f*vorCellVal); // 0.41-0.68
-            tex = 0.0042f + t * peakScale * mountVar * 0.55f;
-            // extra high peaks for very high t, variable
-            if(t > 0.62f){
-                float m = (t - 0.62f)/0.38f;
-                tex += powf(m, 1.6f) * 0.28f * mountVar;
-            }
-            if(tex > 1.0f) tex = 1.0f;
-        }
-        tex = std::clamp(tex, 0.0f, 1.0f);
-        // add tiny hash dither to avoid banding
-        float dither = (hash_to_float(hash_coords(x,y,seed ^ 0x9E3779B97F4A7C15ULL)) - 0.5f) * (0.5f/255.0f);
-        tex = std::clamp(tex + dither, 0.0f, 1.0f);
-        uint8_t v = (uint8_t)std::clamp((int)roundf(tex*255.0f),0,255);
+        in.detail = fbm_internal(u_det, v_det, seedDetail, 2, 0.40f, 2.2f, 22, 22);
+        in.vor_small = voronoi((float)x,(float)y,cellSmall,seedVorS,periodX,periodY);
+        heights[(size_t)y*width+x] = shape_terrain(in);
+    }
+}
+
+void quantize_heightmap(uint64_t seed,int width,int height,const std::vector<float>& heights,std::vector<unsigned char>& data){
+    data.resize((size_t)width*height*3);
+    for(int y=0;y<height;++y) for(int x=0;x<width;++x){
+        uint8_t v = quantize_height(heights[(size_t)y*width+x], hash_coords(x,y,seed ^ 0x9E3779B97F4A7C15ULL));
         size_t idx=((size_t)y*width+x)*3;
         data[idx+0]=v; data[idx+1]=v; data[idx+2]=v;
     }
-    IvTexture* tex = resman.CreateTexture(kRGB24TexFmt,width,height,data.data(),kDefaultUsage);
-    if(!tex) return nullptr;
-    tex->SetAddressingU(kWrapTexAddr);
-    tex->SetAddressingV(kWrapTexAddr);
-    tex->SetMagFiltering(kBilerpTexMagFilter);
-    tex->SetMinFiltering(kBilerpTexMinFilter);
-    return tex;
+}
+
+void generate_heightmap(uint64_t seed,int width,int height,std::vector<unsigned char>& data){
+    std::vector<float> heights;
+    generate_heightmap_heights(seed, width, height, heights);
+    quantize_heightmap(seed, width, height, heights, data);
+}
+
+// -----------------------------------------------------------------
+// Cube-sphere generation
+// -----------------------------------------------------------------
+
+static inline double cube_face_coord(int i, int face_size){ return -1.0 + 2.0 * i / (face_size - 1); }
+
+static void generate_cube_face(uint64_t seed, Math::CubeFace face, int n, std::vector<float>& out){
+    out.resize((size_t)n*n);
+    uint64_t seedBase=seed;
+    uint64_t seedDetail=splitmix64(seed+0x123456789ABCDEF0ULL);
+    uint64_t seedVorL=splitmix64(seed+0xA5A5A5A5A5A5A5A5ULL);
+    uint64_t seedVorS=splitmix64(seed+0x5A5A5A5A5A5A5A5AULL);
+    // a face spans 2 units on the unit sphere; frequencies match one period of the 2D map per face
+    const float contFreq = 1.75f, detailFreq = 11.0f;
+    const float cellLarge = 2.0f / 7.0f;
+    const float cellSmall = 2.0f / 28.0f;
+    const IvDoubleVector3 origin{ 0.0, 0.0, 0.0 };
+    for(int j=0;j<n;++j) for(int i=0;i<n;++i){
+        IvDoubleVector3 normal;
+        IvDoubleVector3 p = Math::adjusted_cube_to_sphere_face(face, cube_face_coord(i,n), cube_face_coord(j,n), 1.0, origin, normal);
+        float px=(float)p.x, py=(float)p.y, pz=(float)p.z;
+        terrain_inputs in;
+        in.continent = fbm_3d(px*contFreq, py*contFreq, pz*contFreq, seedBase, 3, 0.42f, 2.0f);
+        in.vor_large = voronoi_3d(px, py, pz, cellLarge, seedVorL, &in.vor_border, &in.vor_cell);
+        in.detail = fbm_3d(px*detailFreq, py*detailFreq, pz*detailFreq, seedDetail, 2, 0.40f, 2.2f);
+        in.vor_small = voronoi_3d(px, py, pz, cellSmall, seedVorS);
+        out[(size_t)j*n+i] = shape_terrain(in);
+    }
+}
+
+static void quantize_cube_face(uint64_t seed, int face, int n, const std::vector<float>& heights, std::vector<unsigned char>& out){
+    out.resize((size_t)n*n);
+    for(int j=0;j<n;++j) for(int i=0;i<n;++i)
+        out[(size_t)j*n+i] = quantize_height(heights[(size_t)j*n+i], hash_coords(i, j, face, seed ^ 0x9E3779B97F4A7C15ULL));
+}
+
+// Finds the texel of `face` that lies on the sphere direction `d`, if any.
+static bool cube_face_texel(Math::CubeFace face, const IvDoubleVector3& d, int n, int& i, int& j){
+    IvDoubleVector3 local = Math::rotate_face_to_top(d, face);
+    if (local.y <= 0.0) return false;
+    double x, y;
+    Math::adjusted_sphere_to_cube(atan2(local.x, local.y), asin(local.z / local.Length()), 1.0, x, y);
+    const double eps = 1e-6;
+    if (fabs(x) > 1.0 + eps || fabs(y) > 1.0 + eps) return false;
+    double fi = (x + 1.0) * 0.5 * (n - 1), fj = (y + 1.0) * 0.5 * (n - 1);
+    i = std::clamp((int)lround(fi), 0, n - 1);
+    j = std::clamp((int)lround(fj), 0, n - 1);
+    return fabs(fi - i) < 1e-3 && fabs(fj - j) < 1e-3;
+}
+
+// Face `face` grown by `pad` texels on every side, on the same grid. Texels
+// past the edge lie on a neighbouring face and are interpolated from it.
+static void pad_cube_face(const std::vector<float>* faces, Math::CubeFace face, int n, int pad, std::vector<float>& out){
+    const int w = n + 2 * pad;
+    const IvDoubleVector3 origin{ 0.0, 0.0, 0.0 };
+    out.resize((size_t)w*w);
+    for(int j=0;j<w;++j) for(int i=0;i<w;++i){
+        const int fi = i - pad, fj = j - pad;
+        if(fi >= 0 && fi < n && fj >= 0 && fj < n){ out[(size_t)j*w+i] = faces[(int)face][(size_t)fj*n+fi]; continue; }
+        IvDoubleVector3 normal;
+        IvDoubleVector3 d = Math::adjusted_cube_to_sphere_face(face, cube_face_coord(fi,n), cube_face_coord(fj,n), 1.0, origin, normal);
+        Math::CubeFace other;
+        double x, y;
+        Math::world_to_cube_face(d, origin, 1.0, other, x, y);
+        const double u = std::clamp((x + 1.0) * 0.5 * (n - 1), 0.0, (double)(n - 1));
+        const double v = std::clamp((y + 1.0) * 0.5 * (n - 1), 0.0, (double)(n - 1));
+        const int i0 = std::min((int)u, n - 2), j0 = std::min((int)v, n - 2);
+        const float a = (float)(u - i0), b = (float)(v - j0);
+        const float* h = &faces[(int)other][(size_t)j0*n+i0];
+        out[(size_t)j*w+i] = (h[0]*(1.0f - a) + h[1]*a)*(1.0f - b) + (h[n]*(1.0f - a) + h[n + 1]*a)*b;
+    }
+}
+
+// Erodes every face on a copy grown past its edges with its neighbours'
+// heights, so droplets run across the cube edges and the faces are eroded up
+// to them. The fade of the non-wrapping erosion and the droplets that cannot
+// reach the face both stay in the padding, which is cropped.
+static void erode_cube_faces(uint64_t seed, int n, std::vector<float>* heights, const erosion_params& erosion){
+    const int pad = std::max(0, erosion.border_fade) + erosion_margin(erosion), w = n + 2 * pad;
+    std::vector<float> padded[c_cube_face_count];
+    for(int face=0;face<c_cube_face_count;++face) pad_cube_face(heights, (Math::CubeFace)face, n, pad, padded[face]);
+    for(int face=0;face<c_cube_face_count;++face){
+        erode_heightmap(splitmix64(seed + (uint64_t)face), w, w, false, padded[face], erosion);
+        for(int j=0;j<n;++j)
+            std::copy_n(&padded[face][(size_t)(j + pad)*w + pad], n, &heights[face][(size_t)j*n]);
+    }
+}
+
+// Border texels are evaluated once per face and can differ by the last bit of
+// the sphere position; copy them from the lowest-index face sharing the point.
+static void stitch_cube_face_seams(cube_sphere_heightmap& hm){
+    const int n = hm.face_size;
+    const IvDoubleVector3 origin{ 0.0, 0.0, 0.0 };
+    for(int face=1;face<c_cube_face_count;++face){
+        for(int j=0;j<n;++j) for(int i=0;i<n;++i){
+            if(i!=0 && i!=n-1 && j!=0 && j!=n-1) continue;
+            IvDoubleVector3 normal;
+            IvDoubleVector3 d = Math::adjusted_cube_to_sphere_face((Math::CubeFace)face, cube_face_coord(i,n), cube_face_coord(j,n), 1.0, origin, normal);
+            for(int owner=0;owner<face;++owner){
+                int oi, oj;
+                if(cube_face_texel((Math::CubeFace)owner, d, n, oi, oj)){
+                    hm.faces[face][(size_t)j*n+i] = hm.faces[owner][(size_t)oj*n+oi];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void generate_cube_sphere_heightmap(uint64_t seed,int face_size,cube_sphere_heightmap& out,const erosion_params* erosion){
+    out.face_size = face_size;
+    std::vector<float> heights[c_cube_face_count];
+    std::vector<std::thread> workers;
+    for(int face=0;face<c_cube_face_count;++face)
+        workers.emplace_back(generate_cube_face, seed, (Math::CubeFace)face, face_size, std::ref(heights[face]));
+    for(auto& worker : workers) worker.join();
+    if(erosion) erode_cube_faces(seed, face_size, heights, *erosion);
+    for(int face=0;face<c_cube_face_count;++face) quantize_cube_face(seed, face, face_size, heights[face], out.faces[face]);
+    stitch_cube_face_seams(out);
+}
+
+void pack_cube_sphere_atlas(const cube_sphere_heightmap& hm,std::vector<unsigned char>& data){
+    const int n = hm.face_size, width = n * 3, height = n * 2;
+    data.resize((size_t)width*height*3);
+    for(int face=0;face<c_cube_face_count;++face){
+        int ox = (face % 3) * n, oy = (face / 3) * n;
+        for(int y=0;y<n;++y) for(int x=0;x<n;++x){
+            unsigned char v = hm.at(face, x, y);
+            size_t idx=((size_t)(oy + y)*width + ox + x)*3;
+            data[idx+0]=v; data[idx+1]=v; data[idx+2]=v;
+        }
+    }
 }
 }
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <vector>
 
 class IvTexture;
 
@@ -12,6 +13,16 @@ namespace proc
     uint64_t hash_string(const char* s);
     uint64_t splitmix64(uint64_t x);
 
+    struct erosion_params;
+
+    // CPU part of generate_heightmap_texture: fills width*height RGB24 texels (grey, r == g == b).
+    void generate_heightmap(uint64_t seed, int width, int height, std::vector<unsigned char>& rgb);
+
+    // generate_heightmap in two steps: unquantized heights in [0,1] (e.g. to be
+    // eroded), then the RGB24 quantization with the generator's dither.
+    void generate_heightmap_heights(uint64_t seed, int width, int height, std::vector<float>& heights);
+    void quantize_heightmap(uint64_t seed, int width, int height, const std::vector<float>& heights, std::vector<unsigned char>& rgb);
+
     // Generate a tileable heightmap texture. Seed determines terrain; same seed => same terrain.
     // Width/height should be power-of-two for best tiling (default 1024).
     IvTexture* generate_heightmap_texture(uint64_t seed, int width = 1024, int height = 1024);
@@ -23,5 +34,49 @@ namespace proc
 
     // Exposed for testing: single sample in [0,1] using tileable FBM
     float sample_fbm(float x, float y, uint64_t seed, int periodX, int periodY);
+
+    // Exposed for testing: single sample in [0,1] of non-periodic 3D FBM
+    float sample_fbm_3d(float x, float y, float z, uint64_t seed);
+
+    // Exposed for testing: tileable voronoi distance in [0,1], optionally the
+    // border distance (second - first nearest) and the nearest cell's value
+    float sample_voronoi(float x, float y, float cell_size, uint64_t seed, int periodX, int periodY,
+        float* border = nullptr, float* cell_value = nullptr);
+
+    // -----------------------------------------------------------------
+    // Cube-sphere heightmap: one height tile per cube face, evaluated from
+    // 3D noise on the unit sphere through Math::adjusted_cube_to_sphere_face.
+    // Texel (i, j) of a face lies at face coordinates
+    //   x = -1 + 2i / (face_size - 1), y = -1 + 2j / (face_size - 1)
+    // so the border texels of neighbouring faces cover the same sphere points;
+    // they are stitched to be bit-identical after generation.
+    // -----------------------------------------------------------------
+    static const int c_cube_face_count = 6;
+
+    struct cube_sphere_heightmap
+    {
+        int face_size = 0;
+        std::vector<unsigned char> faces[c_cube_face_count]; // indexed by Math::CubeFace, row-major
+
+        unsigned char at(int face, int x, int y) const { return faces[face][(size_t)y * face_size + x]; }
+    };
+
+    // Faces are generated in parallel, one worker per face. With `erosion` every
+    // face is eroded before quantization (ProceduralErosion.h), across its edges
+    // onto the neighbouring faces.
+    void generate_cube_sphere_heightmap(uint64_t seed, int face_size, cube_sphere_heightmap& out,
+        const erosion_params* erosion = nullptr);
+
+    // Packs the six faces into a (3 * face_size) x (2 * face_size) RGB24 atlas,
+    // face f at column f % 3, row f / 3.
+    void pack_cube_sphere_atlas(const cube_sphere_heightmap& hm, std::vector<unsigned char>& rgb);
+
+    // Uploads the six faces as a 3x2 atlas, see pack_cube_sphere_atlas.
+    IvTexture* generate_cube_sphere_heightmap_texture(uint64_t seed, int face_size);
+
+    inline IvTexture* generate_cube_sphere_heightmap_texture(const std::string& hash_str, int face_size)
+    {
+        return generate_cube_sphere_heightmap_texture(hash_string(hash_str), face_size);
+    }
 }
 }
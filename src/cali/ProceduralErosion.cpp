@@ -0,0 +1,229 @@
+#include "ProceduralErosion.h"
+#include "ProceduralNoise.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace cali
+{
+namespace proc
+{
+using namespace noise;
+
+namespace
+{
+    struct erosion_brush
+    {
+        std::vector<int> dx, dy;
+        std::vector<float> weight;
+    };
+
+    erosion_brush make_brush(int radius){
+        erosion_brush brush;
+        float total = 0.0f;
+        for(int y=-radius;y<=radius;++y) for(int x=-radius;x<=radius;++x){
+            float w = (float)radius - sqrtf((float)(x*x + y*y));
+            if(w <= 0.0f) continue;
+            brush.dx.push_back(x); brush.dy.push_back(y); brush.weight.push_back(w);
+            total += w;
+        }
+        for(float& w : brush.weight) w /= total;
+        return brush;
+    }
+
+    struct erosion_tile
+    {
+        int x0, y0, x1, y1;   // core, map coordinates
+        int lx0, ly0, lw, lh; // padded region; may start below 0 when wrapping
+        int tx, ty;
+    };
+
+    // Tile boundaries along one axis: n >= 1 tiles of at least tile_size texels.
+    std::vector<int> tile_bounds(int size, int tile_size){
+        int n = std::max(1, size / tile_size);
+        std::vector<int> bounds(n + 1);
+        for(int i=0;i<=n;++i) bounds[i] = (int)((int64_t)size * i / n);
+        return bounds;
+    }
+
+    // Colour along one axis: neighbours differ; with an odd tile count the last
+    // tile of a wrapping map neighbours tile 0 and gets a third colour.
+    int tile_colour(int t, int n, bool wrap){ return (wrap && n > 1 && (n & 1) && t == n - 1) ? 2 : (t & 1); }
+
+    inline void height_and_gradient(const float* map, int lw, float px, float py, float& h, float& gx, float& gy){
+        int nx = (int)px, ny = (int)py;
+        float u = px - nx, v = py - ny;
+        const float* p = map + (size_t)ny*lw + nx;
+        float h00 = p[0], h10 = p[1], h01 = p[lw], h11 = p[lw + 1];
+        gx = (h10 - h00)*(1.0f - v) + (h11 - h01)*v;
+        gy = (h01 - h00)*(1.0f - u) + (h11 - h10)*u;
+        h = h00*(1.0f - u)*(1.0f - v) + h10*u*(1.0f - v) + h01*(1.0f - u)*v + h11*u*v;
+    }
+
+    void simulate_tile(uint64_t seed, const erosion_tile& tile, size_t droplets, const erosion_params& p,
+        const erosion_brush& brush, float* map){
+        const int lw = tile.lw, lh = tile.lh, r = p.brush_radius;
+        const float cx0 = (float)(tile.x0 - tile.lx0), cy0 = (float)(tile.y0 - tile.ly0);
+        const float cw = (float)(tile.x1 - tile.x0), ch = (float)(tile.y1 - tile.y0);
+        // droplets stay where the brush and the bilinear footprint fit
+        const float min_pos = (float)r, max_x = (float)(lw - r - 1), max_y = (float)(lh - r - 1);
+        uint64_t rng = hash_coords(tile.tx, tile.ty, seed ^ 0xE7037ED1A0B428DBULL);
+        auto random = [&rng](){ rng += 0x9E3779B97F4A7C15ULL; return hash_to_float(splitmix64(rng)); };
+
+        for(size_t d=0;d<droplets;++d){
+            float px = cx0 + random()*cw, py = cy0 + random()*ch;
+            float dx = 0.0f, dy = 0.0f, speed = 1.0f, water = 1.0f, sediment = 0.0f;
+            if(px < min_pos || py < min_pos || px >= max_x || py >= max_y) continue;
+
+            for(int step=0;step<p.lifetime;++step){
+                int nx = (int)px, ny = (int)py;
+                float ox = px - nx, oy = py - ny;
+                float h, gx, gy;
+                height_and_gradient(map, lw, px, py, h, gx, gy);
+
+                dx = dx*p.inertia - gx*(1.0f - p.inertia);
+                dy = dy*p.inertia - gy*(1.0f - p.inertia);
+                float len = sqrtf(dx*dx + dy*dy);
+                if(len == 0.0f) break;
+                dx /= len; dy /= len;
+                px += dx; py += dy;
+                if(px < min_pos || py < min_pos || px >= max_x || py >= max_y) break;
+
+                float new_h, ngx, ngy;
+                height_and_gradient(map, lw, px, py, new_h, ngx, ngy);
+                float dh = new_h - h;
+                float capacity = std::max(-dh*speed*water*p.capacity, p.min_capacity);
+
+                float* cell = map + (size_t)ny*lw + nx;
+                if(sediment > capacity || dh > 0.0f){
+                    // uphill: fill the pit behind; otherwise drop the surplus
+                    float amount = dh > 0.0f ? std::min(dh, sediment) : (sediment - capacity)*p.deposition;
+                    sediment -= amount;
+                    cell[0]      += amount*(1.0f - ox)*(1.0f - oy);
+                    cell[1]      += amount*ox*(1.0f - oy);
+                    cell[lw]     += amount*(1.0f - ox)*oy;
+                    cell[lw + 1] += amount*ox*oy;
+                }else{
+                    float amount = std::min((capacity - sediment)*p.erosion, -dh);
+                    for(size_t b=0;b<brush.weight.size();++b){
+                        float& t = cell[(ptrdiff_t)brush.dy[b]*lw + brush.dx[b]];
+                        float taken = std::min(t, amount*brush.weight[b]);
+                        t -= taken;
+                        sediment += taken;
+                    }
+                }
+                speed = sqrtf(std::max(0.0f, speed*speed - dh*p.gravity));
+                water *= 1.0f - p.evaporation;
+            }
+        }
+    }
+}
+
+uint64_t erosion_params_hash(const erosion_params& p){
+    uint64_t h = 14695981039346656037ULL;
+    auto mix = [&h](const void* v, size_t size){
+        const unsigned char* bytes = static_cast<const unsigned char*>(v);
+        for(size_t i=0;i<size;++i){ h ^= bytes[i]; h *= 1099511628211ULL; }
+    };
+    mix(&p.droplets_per_texel, 4); mix(&p.lifetime, 4); mix(&p.brush_radius, 4); mix(&p.inertia, 4);
+    mix(&p.capacity, 4); mix(&p.min_capacity, 4); mix(&p.deposition, 4); mix(&p.erosion, 4);
+    mix(&p.evaporation, 4); mix(&p.gravity, 4); mix(&p.height_scale, 4); mix(&p.border_fade, 4);
+    mix(&p.tile_size, 4);
+    return h;
+}
+
+void erode_heightmap(uint64_t seed,int width,int height,bool wrap,std::vector<float>& heights,
+    const erosion_params& p,erosion_stats* stats){
+    const auto start = std::chrono::steady_clock::now();
+    const int margin = erosion_margin(p);
+    if(p.tile_size < 2*margin) throw std::invalid_argument("erosion: tile_size must be at least twice the margin");
+    if(heights.size() != (size_t)width*height) throw std::invalid_argument("erosion: heights do not match the map size");
+
+    const std::vector<int> bx = tile_bounds(width, p.tile_size), by = tile_bounds(height, p.tile_size);
+    const int nx = (int)bx.size() - 1, ny = (int)by.size() - 1;
+    // a wrapping padded tile must not reach around onto itself
+    if(wrap && (nx < 2 || ny < 2)) throw std::invalid_argument("erosion: wrapping map needs at least 2x2 tiles");
+
+    // phases by colour, tiles of one phase are disjoint even with their padding
+    const int colours_x = (wrap && nx > 1 && (nx & 1)) ? 3 : std::min(nx, 2);
+    const int colours_y = (wrap && ny > 1 && (ny & 1)) ? 3 : std::min(ny, 2);
+    std::vector<std::vector<erosion_tile>> phases(colours_x*colours_y);
+    size_t max_region = 0;
+    for(int ty=0;ty<ny;++ty) for(int tx=0;tx<nx;++tx){
+        erosion_tile t;
+        t.tx = tx; t.ty = ty;
+        t.x0 = bx[tx]; t.x1 = bx[tx + 1]; t.y0 = by[ty]; t.y1 = by[ty + 1];
+        t.lx0 = wrap ? t.x0 - margin : std::max(0, t.x0 - margin);
+        t.ly0 = wrap ? t.y0 - margin : std::max(0, t.y0 - margin);
+        t.lw = (wrap ? t.x1 + margin : std::min(width, t.x1 + margin)) - t.lx0;
+        t.lh = (wrap ? t.y1 + margin : std::min(height, t.y1 + margin)) - t.ly0;
+        max_region = std::max(max_region, (size_t)t.lw*t.lh);
+        phases[tile_colour(ty, ny, wrap)*colours_x + tile_colour(tx, nx, wrap)].push_back(t);
+    }
+
+    // non-wrapping maps keep their border: remember the fade strip
+    std::vector<std::pair<size_t, float>> strip;
+    const int fade = wrap ? 0 : std::max(0, p.border_fade);
+    for(int y=0;y<height && fade>0;++y) for(int x=0;x<width;++x){
+        int d = std::min(std::min(x, y), std::min(width - 1 - x, height - 1 - y));
+        if(d < fade) strip.emplace_back((size_t)y*width + x, heights[(size_t)y*width + x]);
+    }
+
+    const erosion_brush brush = make_brush(p.brush_radius);
+    const float scale = p.height_scale, inv_scale = 1.0f / p.height_scale;
+    int thread_count = p.threads > 0 ? p.threads : (int)std::thread::hardware_concurrency();
+    thread_count = std::max(1, thread_count);
+    std::vector<std::vector<float>> regions(thread_count);
+    std::atomic<size_t> droplets{ 0 };
+
+    auto wrap_index = [](int v, int n){ int r = v % n; return r < 0 ? r + n : r; };
+    for(const std::vector<erosion_tile>& phase : phases){
+        std::atomic<size_t> next{ 0 };
+        auto worker = [&](int w){
+            std::vector<float>& region = regions[w];
+            region.resize(max_region);
+            for(size_t i = next++; i < phase.size(); i = next++){
+                const erosion_tile& t = phase[i];
+                for(int y=0;y<t.lh;++y){
+                    const float* src = &heights[(size_t)wrap_index(t.ly0 + y, height)*width];
+                    for(int x=0;x<t.lw;++x) region[(size_t)y*t.lw + x] = src[wrap_index(t.lx0 + x, width)]*scale;
+                }
+                size_t count = (size_t)llround((double)p.droplets_per_texel*(t.x1 - t.x0)*(t.y1 - t.y0));
+                simulate_tile(seed, t, count, p, brush, region.data());
+                droplets += count;
+                for(int y=0;y<t.lh;++y){
+                    float* dst = &heights[(size_t)wrap_index(t.ly0 + y, height)*width];
+                    for(int x=0;x<t.lw;++x) dst[wrap_index(t.lx0 + x, width)] = region[(size_t)y*t.lw + x]*inv_scale;
+                }
+            }
+        };
+        const int workers_in_phase = std::min(thread_count, (int)phase.size());
+        std::vector<std::thread> workers;
+        for(int w=1;w<workers_in_phase;++w) workers.emplace_back(worker, w);
+        worker(0);
+        for(auto& w : workers) w.join();
+    }
+
+    for(const auto& s : strip){
+        int x = (int)(s.first % width), y = (int)(s.first / width);
+        int d = std::min(std::min(x, y), std::min(width - 1 - x, height - 1 - y));
+        float w = smootherstep((float)d / fade);
+        heights[s.first] = s.second + w*(heights[s.first] - s.second);
+    }
+
+    if(stats){
+        stats->droplets = droplets;
+        stats->tiles = (size_t)nx*ny;
+        stats->phases = (int)phases.size();
+        stats->working_set_bytes = max_region*sizeof(float);
+        stats->threads = thread_count;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+}
+}
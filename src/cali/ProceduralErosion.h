@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cali
+{
+namespace proc
+{
+	// Particle (droplet) hydraulic erosion on a float heightmap in [0,1].
+	//
+	// The map is split into core tiles of at least tile_size texels. A droplet
+	// spawns in a tile's core and lives for at most `lifetime` one-texel steps,
+	// so together with its brush it never leaves the tile padded by
+	// erosion_margin() texels. Each worker simulates a tile on a private copy of
+	// its padded region (the whole working set) and writes the region back.
+	// Tiles are processed in 2x2 colour phases: tiles of one phase are two tiles
+	// apart, their padded regions never overlap, and the result is the same for
+	// any thread count. Droplets cross tile borders freely, so there are no
+	// seams. Every tile draws from its own RNG stream seeded by (seed, tile).
+	struct erosion_params
+	{
+		float droplets_per_texel = 0.7f;
+		int lifetime = 30;           // steps, one texel each
+		int brush_radius = 3;        // erosion radius in texels
+		float inertia = 0.05f;       // 0: follow the slope, 1: keep the direction
+		float capacity = 4.0f;       // sediment capacity factor
+		float min_capacity = 0.01f;
+		float deposition = 0.3f;
+		float erosion = 0.3f;
+		float evaporation = 0.01f;
+		float gravity = 4.0f;
+		float height_scale = 64.0f;  // relief of a [0,1] height, in texels
+		int border_fade = 16;        // texels; non-wrapping maps keep their border texels unchanged
+		int tile_size = 128;         // minimum core tile size, >= 2 * erosion_margin()
+		int threads = 0;             // 0: hardware concurrency
+	};
+
+	struct erosion_stats
+	{
+		size_t droplets = 0;
+		size_t tiles = 0;
+		int phases = 0;
+		size_t working_set_bytes = 0; // per worker
+		int threads = 0;
+		double seconds = 0.0;
+
+		double droplets_per_second() const { return seconds > 0.0 ? droplets / seconds : 0.0; }
+	};
+
+	// Padding in texels around a core tile that a droplet can reach.
+	inline int erosion_margin(const erosion_params& params) { return params.lifetime + params.brush_radius + 2; }
+
+	// Hash of the parameters that change the result (not `threads`), for cache keys.
+	uint64_t erosion_params_hash(const erosion_params& params);
+
+	// Erodes width x height row-major heights in place. With `wrap` the map is
+	// treated as tileable and stays tileable; otherwise the erosion fades out
+	// over `border_fade` texels so the border texels are left unchanged.
+	void erode_heightmap(uint64_t seed, int width, int height, bool wrap, std::vector<float>& heights,
+		const erosion_params& params, erosion_stats* stats = nullptr);
+}
+}
@@ -0,0 +1,434 @@
+#include "ProceduralGraph.h"
+#include "ProceduralNoise.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace cali
+{
+namespace proc
+{
+using namespace noise;
+
+struct terrain_graph::tile_scratch
+{
+    std::vector<std::vector<float>> buffers; // one tile-sized buffer per node
+    std::vector<char> affected, need, computed, blocked; // per node; blocked is a bit per input
+};
+
+terrain_graph::terrain_graph()
+    : m_output(c_no_node), m_width(0), m_height(0), m_tile_size(32), m_tiles_x(0), m_tiles_y(0)
+{
+}
+
+terrain_graph::~terrain_graph()
+{
+}
+
+static terrain_graph::node_id check_node(terrain_graph::node_id id, size_t count){
+    if(id < 0 || (size_t)id >= count) throw std::invalid_argument("terrain_graph: invalid node id");
+    return id;
+}
+
+terrain_graph::node_id terrain_graph::add_node(const node& n){
+    m_nodes.push_back(n);
+    m_nodes.back().cached = false;
+    m_dirty.push_back(true);
+    // tile states are tile-major, so the layout changes with the node count
+    m_tile_states.assign((size_t)m_tiles_x*m_tiles_y*m_nodes.size(), tile_node_state{ 0.0f, 0.0f, false });
+    update_voronoi_groups();
+    return (node_id)m_nodes.size() - 1;
+}
+
+terrain_graph::node_id terrain_graph::fbm(const fbm_params& params){
+    node n(node_type::fbm);
+    n.fbm = params;
+    return add_node(n);
+}
+terrain_graph::node_id terrain_graph::voronoi(const voronoi_params& params){
+    node n(node_type::voronoi);
+    n.voronoi = params;
+    return add_node(n);
+}
+terrain_graph::node_id terrain_graph::remap(node_id in, const remap_params& params){
+    node n(node_type::remap, check_node(in, m_nodes.size()));
+    n.remap = params;
+    return add_node(n);
+}
+terrain_graph::node_id terrain_graph::curve(node_id in, const curve_params& params){
+    node n(node_type::curve, check_node(in, m_nodes.size()));
+    n.curve = params;
+    return add_node(n);
+}
+terrain_graph::node_id terrain_graph::mask(node_id in, node_id mask){
+    node n(node_type::mask, check_node(in, m_nodes.size()), check_node(mask, m_nodes.size()));
+    return add_node(n);
+}
+terrain_graph::node_id terrain_graph::blend(node_id a, node_id b, const blend_params& params, node_id t){
+    if(params.mode == blend_mode::select && t == c_no_node)
+        throw std::invalid_argument("terrain_graph: select blend needs a gate input");
+    node n(node_type::blend, check_node(a, m_nodes.size()), check_node(b, m_nodes.size()),
+        t == c_no_node ? c_no_node : check_node(t, m_nodes.size()));
+    n.blend = params;
+    return add_node(n);
+}
+
+terrain_graph::node& terrain_graph::typed_node(node_id id, node_type type){
+    node& n = m_nodes[check_node(id, m_nodes.size())];
+    if(n.type != type) throw std::invalid_argument("terrain_graph: parameters do not match the node type");
+    return n;
+}
+
+void terrain_graph::set_params(node_id id, const fbm_params& params){ typed_node(id, node_type::fbm).fbm = params; mark_dirty(id); }
+void terrain_graph::set_params(node_id id, const remap_params& params){ typed_node(id, node_type::remap).remap = params; mark_dirty(id); }
+void terrain_graph::set_params(node_id id, const curve_params& params){ typed_node(id, node_type::curve).curve = params; mark_dirty(id); }
+void terrain_graph::set_params(node_id id, const voronoi_params& params){
+    typed_node(id, node_type::voronoi).voronoi = params;
+    mark_dirty(id);
+    update_voronoi_groups();
+}
+void terrain_graph::set_params(node_id id, const blend_params& params){
+    node& n = typed_node(id, node_type::blend);
+    if(params.mode == blend_mode::select && n.inputs[2] == c_no_node)
+        throw std::invalid_argument("terrain_graph: select blend needs a gate input");
+    n.blend = params;
+    mark_dirty(id);
+}
+
+void terrain_graph::set_output(node_id id){
+    m_output = check_node(id, m_nodes.size());
+    mark_all_dirty();
+}
+
+void terrain_graph::set_cached(node_id id, bool cached){
+    node& n = m_nodes[check_node(id, m_nodes.size())];
+    n.cached = cached;
+    if(cached) n.cache.assign((size_t)m_width*m_height, 0.0f);
+    else std::vector<float>().swap(n.cache);
+    // the fresh cache holds nothing yet
+    for(size_t tile=0;tile<(size_t)m_tiles_x*m_tiles_y;++tile) m_tile_states[tile*m_nodes.size() + id].valid = false;
+}
+
+void terrain_graph::set_resolution(int width, int height, int tile_size){
+    if(width <= 0 || height <= 0 || tile_size <= 0) throw std::invalid_argument("terrain_graph: invalid resolution");
+    m_width = width; m_height = height; m_tile_size = tile_size;
+    m_tiles_x = (width + tile_size - 1) / tile_size;
+    m_tiles_y = (height + tile_size - 1) / tile_size;
+    m_heights.assign((size_t)width*height, 0.0f);
+    m_tile_states.assign((size_t)m_tiles_x*m_tiles_y*m_nodes.size(), tile_node_state{ 0.0f, 0.0f, false });
+    for(node& n : m_nodes) if(n.cached) n.cache.assign((size_t)width*height, 0.0f);
+    mark_all_dirty();
+}
+
+void terrain_graph::mark_dirty(node_id id){ m_dirty[id] = true; }
+void terrain_graph::mark_all_dirty(){ std::fill(m_dirty.begin(), m_dirty.end(), true); }
+
+void terrain_graph::update_voronoi_groups(){
+    for(size_t i=0;i<m_nodes.size();++i){
+        node& n = m_nodes[i];
+        n.voronoi_group = c_no_node;
+        if(n.type != node_type::voronoi) continue;
+        for(size_t j=0;j<=i;++j){
+            const node& g = m_nodes[j];
+            if(g.type == node_type::voronoi && g.voronoi.seed == n.voronoi.seed && g.voronoi.cells == n.voronoi.cells){
+                n.voronoi_group = (node_id)j;
+                break;
+            }
+        }
+    }
+}
+
+// mask: `mask` gates `in`; lerp blend: t gates b; select blend: t gates a and b
+static terrain_graph::node_id gate_input(terrain_graph::node_type type, const terrain_graph::node_id* inputs){
+    if(type == terrain_graph::node_type::mask) return inputs[1];
+    if(type == terrain_graph::node_type::blend) return inputs[2];
+    return terrain_graph::c_no_node;
+}
+
+// True when `input` of node `id` cannot change the node's output in `tile`:
+// the gate is unchanged there and was constant on its last evaluation.
+bool terrain_graph::gate_blocks(size_t tile, node_id id, int input, const std::vector<char>& affected) const {
+    const node& n = m_nodes[id];
+    const node_id gate = gate_input(n.type, n.inputs);
+    if(gate == c_no_node || affected[gate]) return false;
+    const tile_node_state& s = m_tile_states[tile*m_nodes.size() + gate];
+    if(!s.valid) return false;
+    if(n.type == node_type::mask)
+        return input == 0 && s.min == 0.0f && s.max == 0.0f;
+    if(n.blend.mode == blend_mode::lerp)
+        return input == 1 && s.min == 0.0f && s.max == 0.0f;
+    if(n.blend.mode == blend_mode::select)
+        return (input == 0 && s.min >= n.blend.amount) || (input == 1 && s.max < n.blend.amount);
+    return false;
+}
+
+void terrain_graph::run_node(node_id id, int x0, int y0, int w, int h, tile_scratch& scratch) const {
+    const node& n = m_nodes[id];
+    float* out = scratch.buffers[id].data();
+    const int ts = m_tile_size;
+    const char blocked = scratch.blocked[id];
+    const float* a = n.inputs[0] != c_no_node ? scratch.buffers[n.inputs[0]].data() : nullptr;
+    const float* b = n.inputs[1] != c_no_node ? scratch.buffers[n.inputs[1]].data() : nullptr;
+    const float* t = n.inputs[2] != c_no_node ? scratch.buffers[n.inputs[2]].data() : nullptr;
+
+    switch(n.type){
+    case node_type::fbm: {
+        const fbm_params& p = n.fbm;
+        for(int y=0;y<h;++y) for(int x=0;x<w;++x){
+            float u = (float)(x0 + x) / m_width * p.frequency;
+            float v = (float)(y0 + y) / m_height * p.frequency;
+            out[(size_t)y*ts+x] = fbm_internal(u, v, p.seed, p.octaves, p.persistence, p.lacunarity, p.period, p.period);
+        }
+        break;
+    }
+    case node_type::voronoi: {
+        // one voronoi call fills every channel of the group
+        const node_id group = n.voronoi_group;
+        const float cellSize = (float)m_width / n.voronoi.cells;
+        std::vector<node_id> members;
+        for(node_id j=group;j<(node_id)m_nodes.size();++j)
+            if(m_nodes[j].type == node_type::voronoi && m_nodes[j].voronoi_group == group && !scratch.computed[j])
+                members.push_back(j);
+        for(int y=0;y<h;++y) for(int x=0;x<w;++x){
+            float border, cell;
+            float dist = noise::voronoi((float)(x0 + x), (float)(y0 + y), cellSize, n.voronoi.seed, m_width, m_height, &border, &cell);
+            for(node_id j : members){
+                voronoi_channel channel = m_nodes[j].voronoi.channel;
+                scratch.buffers[j][(size_t)y*ts+x] = channel == voronoi_channel::border ? border : channel == voronoi_channel::cell ? cell : dist;
+            }
+        }
+        for(node_id j : members) scratch.computed[j] = 1;
+        break;
+    }
+    case node_type::remap: {
+        const remap_params& p = n.remap;
+        const float lo = std::min(p.out_min, p.out_min + p.out_range), hi = std::max(p.out_min, p.out_min + p.out_range);
+        for(int y=0;y<h;++y) for(int x=0;x<w;++x){
+            size_t i = (size_t)y*ts+x;
+            float v = p.out_min + ((a[i] - p.in_min) / p.in_range) * p.out_range;
+            out[i] = p.clamp ? std::clamp(v, lo, hi) : v;
+        }
+        break;
+    }
+    case node_type::curve: {
+        const curve_params& p = n.curve;
+        for(int y=0;y<h;++y) for(int x=0;x<w;++x){
+            size_t i = (size_t)y*ts+x;
+            float v = a[i];
+            switch(p.type){
+            case curve_type::power: v = portable_pow(std::max(0.0f, v), p.amount); break;
+            case curve_type::smootherstep: v = smootherstep(v); break;
+            case curve_type::soften: v = lerp_f(v, smootherstep(v), p.amount); break;
+            case curve_type::ridge: v = 1.0f - fabsf(v*2.0f - 1.0f); break;
+            }
+            out[i] = v;
+        }
+        break;
+    }
+    case node_type::mask:
+        for(int y=0;y<h;++y) for(int x=0;x<w;++x){
+            size_t i = (size_t)y*ts+x;
+            out[i] = (blocked & 1) ? 0.0f : a[i] * b[i];
+        }
+        break;
+    case node_type::blend: {
+        const blend_params& p = n.blend;
+        for(int y=0;y<h;++y) for(int x=0;x<w;++x){
+            size_t i = (size_t)y*ts+x;
+            switch(p.mode){
+            case blend_mode::lerp:  out[i] = (blocked & 2) ? a[i] : lerp_f(a[i], b[i], t ? t[i] : p.amount); break;
+            case blend_mode::add:   out[i] = a[i] + b[i]; break;
+            case blend_mode::select:out[i] = (blocked & 1) ? b[i] : (blocked & 2) ? a[i] : (t[i] < p.amount ? a[i] : b[i]); break;
+            }
+        }
+        break;
+    }
+    }
+    scratch.computed[id] = 1;
+}
+
+bool terrain_graph::evaluate_tile(int tx, int ty, tile_scratch& scratch, size_t& node_evaluations){
+    const size_t count = m_nodes.size();
+    const size_t tile = (size_t)ty*m_tiles_x + tx;
+    tile_node_state* states = &m_tile_states[tile*count];
+    const int x0 = tx*m_tile_size, y0 = ty*m_tile_size;
+    const int w = std::min(m_tile_size, m_width - x0), h = std::min(m_tile_size, m_height - y0);
+    std::vector<char>& affected = scratch.affected;
+    std::vector<char>& need = scratch.need;
+    std::vector<char>& computed = scratch.computed;
+    std::vector<char>& blocked = scratch.blocked;
+
+    // forward: does a parameter change reach the node in this tile?
+    for(size_t i=0;i<count;++i){
+        const node& n = m_nodes[i];
+        affected[i] = m_dirty[i];
+        for(int k=0;k<3 && !affected[i];++k){
+            node_id in = n.inputs[k];
+            if(in != c_no_node && affected[in] && !gate_blocks(tile, (node_id)i, k, affected)) affected[i] = 1;
+        }
+    }
+    auto invalidate_stale = [&](){
+        for(size_t i=0;i<count;++i) if(affected[i] && !computed[i]) states[i].valid = false;
+    };
+    std::fill(computed.begin(), computed.end(), 0);
+    if(!affected[m_output]){ invalidate_stale(); return false; }
+
+    // backward: which nodes does the output need here? Valid caches and
+    // constant gates cut the upstream nodes off.
+    std::fill(need.begin(), need.end(), 0);
+    std::fill(blocked.begin(), blocked.end(), 0);
+    need[m_output] = 1;
+    for(node_id i=m_output;i>=0;--i){
+        const node& n = m_nodes[i];
+        if(!need[i] || (n.cached && !affected[i] && states[i].valid)) continue;
+        for(int k=0;k<3;++k) if(n.inputs[k] != c_no_node && gate_blocks(tile, i, k, affected)) blocked[i] |= (char)(1 << k);
+        for(int k=0;k<3;++k){
+            node_id in = n.inputs[k];
+            if(in == c_no_node || (blocked[i] & (1 << k))) continue;
+            if(blocked[i] && in == gate_input(n.type, n.inputs)) continue; // a blocking gate is not read
+            need[in] = 1;
+        }
+    }
+
+    for(node_id i=0;i<=m_output;++i){
+        if(!need[i] || computed[i]) continue;
+        node& n = m_nodes[i];
+        if(n.cached && !affected[i] && states[i].valid){
+            for(int y=0;y<h;++y) std::copy_n(&n.cache[(size_t)(y0 + y)*m_width + x0], w, &scratch.buffers[i][(size_t)y*m_tile_size]);
+            computed[i] = 1;
+            continue;
+        }
+        run_node(i, x0, y0, w, h, scratch);
+        ++node_evaluations;
+    }
+
+    for(size_t i=0;i<count;++i){
+        if(!computed[i]) continue;
+        const std::vector<float>& buf = scratch.buffers[i];
+        float lo = buf[0], hi = buf[0];
+        for(int y=0;y<h;++y) for(int x=0;x<w;++x){ float v = buf[(size_t)y*m_tile_size+x]; lo = std::min(lo, v); hi = std::max(hi, v); }
+        states[i] = tile_node_state{ lo, hi, true };
+        node& n = m_nodes[i];
+        if(n.cached) for(int y=0;y<h;++y) std::copy_n(&buf[(size_t)y*m_tile_size], w, &n.cache[(size_t)(y0 + y)*m_width + x0]);
+    }
+    invalidate_stale();
+
+    const std::vector<float>& out = scratch.buffers[m_output];
+    for(int y=0;y<h;++y) std::copy_n(&out[(size_t)y*m_tile_size], w, &m_heights[(size_t)(y0 + y)*m_width + x0]);
+    return true;
+}
+
+terrain_graph::evaluate_stats terrain_graph::evaluate(){
+    if(m_output == c_no_node) throw std::logic_error("terrain_graph: no output node");
+    if(m_width == 0) throw std::logic_error("terrain_graph: resolution not set");
+
+    const int tiles = m_tiles_x*m_tiles_y;
+    evaluate_stats stats{ (size_t)tiles, 0, 0 };
+    if(std::find(m_dirty.begin(), m_dirty.end(), true) == m_dirty.end()) return stats;
+
+    std::atomic<int> next_tile{ 0 };
+    std::atomic<size_t> tiles_evaluated{ 0 }, node_evaluations{ 0 };
+    auto worker = [&](){
+        tile_scratch scratch;
+        const size_t count = m_nodes.size();
+        scratch.buffers.assign(count, std::vector<float>((size_t)m_tile_size*m_tile_size));
+        scratch.affected.resize(count); scratch.need.resize(count);
+        scratch.computed.resize(count); scratch.blocked.resize(count);
+        size_t evaluated = 0, runs = 0;
+        for(int tile = next_tile++; tile < tiles; tile = next_tile++)
+            if(evaluate_tile(tile % m_tiles_x, tile / m_tiles_x, scratch, runs)) ++evaluated;
+        tiles_evaluated += evaluated;
+        node_evaluations += runs;
+    };
+    const int thread_count = std::max(1, std::min((int)std::thread::hardware_concurrency(), tiles));
+    std::vector<std::thread> workers;
+    for(int i=1;i<thread_count;++i) workers.emplace_back(worker);
+    worker();
+    for(auto& w : workers) w.join();
+
+    std::fill(m_dirty.begin(), m_dirty.end(), false);
+    stats.tiles_evaluated = tiles_evaluated;
+    stats.node_evaluations = node_evaluations;
+    return stats;
+}
+
+void terrain_graph::quantize(uint64_t seed, std::vector<unsigned char>& rgb) const {
+    rgb.resize((size_t)m_width*m_height*3);
+    for(int y=0;y<m_height;++y) for(int x=0;x<m_width;++x){
+        uint8_t v = quantize_height(m_heights[(size_t)y*m_width+x], hash_coords(x,y,seed ^ 0x9E3779B97F4A7C15ULL));
+        size_t idx=((size_t)y*m_width+x)*3;
+        rgb[idx+0]=v; rgb[idx+1]=v; rgb[idx+2]=v;
+    }
+}
+
+// -----------------------------------------------------------------
+// Default graph: node for node the same float operations as shape_terrain,
+// so the result is bit-identical to generate_heightmap.
+// -----------------------------------------------------------------
+
+default_terrain_nodes build_default_terrain_graph(terrain_graph& g, uint64_t seed){
+    typedef terrain_graph tg;
+    typedef tg::node_id node_id;
+    auto scale = [&](node_id in, float out_min, float s){ return g.remap(in, { 0.0f, 1.0f, out_min, s, false }); };
+    auto curve = [&](node_id in, tg::curve_type type, float amount){ return g.curve(in, { type, amount }); };
+    auto add = [&](node_id a, node_id b){ return g.blend(a, b, { tg::blend_mode::add, 0.0f }); };
+
+    uint64_t seedDetail=splitmix64(seed+0x123456789ABCDEF0ULL);
+    uint64_t seedVorL=splitmix64(seed+0xA5A5A5A5A5A5A5A5ULL);
+    uint64_t seedVorS=splitmix64(seed+0x5A5A5A5A5A5A5A5AULL);
+
+    default_terrain_nodes nodes;
+    nodes.continent = g.fbm({ seed, 3, 0.42f, 2.0f, 3.5f, 4 });
+    node_id vorLarge = g.voronoi({ seedVorL, 7.0f, tg::voronoi_channel::distance });
+    node_id vorBorder = g.voronoi({ seedVorL, 7.0f, tg::voronoi_channel::border });
+    node_id vorCell = g.voronoi({ seedVorL, 7.0f, tg::voronoi_channel::cell });
+    node_id vorSmall = g.voronoi({ seedVorS, 28.0f, tg::voronoi_channel::distance });
+    node_id detailNoise = g.fbm({ seedDetail, 2, 0.40f, 2.2f, 22.0f, 22 });
+
+    // soft continents with 20% large voronoi influence
+    node_id continentVor = curve(scale(vorLarge, 1.0f, -1.0f), tg::curve_type::power, 2.2f);
+    node_id base = g.blend(nodes.continent, continentVor, { tg::blend_mode::lerp, 0.20f });
+    base = g.remap(base, { 0.38f, 0.50f, 0.0f, 1.0f, true });
+    base = curve(base, tg::curve_type::soften, 0.4f);
+
+    node_id detail = g.remap(detailNoise, { 0.5f, 1.0f, 0.0f, 0.08f, false });
+
+    node_id mountainMask = g.remap(base, { 0.45f, 0.35f, 0.0f, 1.0f, true });
+    mountainMask = curve(curve(mountainMask, tg::curve_type::smootherstep, 0.0f), tg::curve_type::power, 0.9f);
+    nodes.mountain_mask = mountainMask;
+    node_id mountVar = scale(vorCell, 0.55f, 1.1f);
+
+    node_id ridgeS = curve(curve(vorSmall, tg::curve_type::ridge, 0.0f), tg::curve_type::power, 2.2f);
+    nodes.small_ridges = scale(ridgeS, 0.0f, 0.10f);
+    ridgeS = g.mask(g.mask(nodes.small_ridges, mountainMask), mountVar);
+
+    node_id largeRidge = curve(scale(vorBorder, 1.0f, -3.0f), tg::curve_type::power, 2.0f);
+    nodes.large_ridges = scale(largeRidge, 0.0f, 0.06f);
+    largeRidge = g.mask(g.mask(nodes.large_ridges, mountainMask), mountVar);
+
+    node_id h = add(add(add(base, detail), ridgeS), largeRidge);
+    h = g.remap(h, { 0.0f, 1.0f, 0.0f, 1.0f, true });
+    h = curve(h, tg::curve_type::soften, 0.25f);
+
+    node_id ocean = g.remap(h, { 0.0f, 0.5f, 0.0f, 1.0f, false });
+    ocean = scale(curve(ocean, tg::curve_type::power, 1.2f), 0.0f, 0.0032f);
+
+    node_id landT = curve(g.remap(h, { 0.5f, 0.5f, 0.0f, 1.0f, false }), tg::curve_type::power, 0.88f);
+    node_id peakScale = scale(scale(vorCell, 0.75f, 0.5f), 0.0f, 0.55f);
+    node_id land = scale(g.mask(g.mask(landT, peakScale), mountVar), 0.0042f, 0.55f);
+    // extra high peaks; the power curve clamps t <= 0.62 to a zero contribution
+    node_id peaks = curve(g.remap(landT, { 0.62f, 0.38f, 0.0f, 1.0f, false }), tg::curve_type::power, 1.6f);
+    nodes.peaks = scale(peaks, 0.0f, 0.28f);
+    land = add(land, g.mask(nodes.peaks, mountVar));
+    land = g.remap(land, { 0.0f, 1.0f, 0.0f, 1.0f, true });
+
+    nodes.output = g.blend(ocean, land, { tg::blend_mode::select, 0.5f }, h);
+    g.set_output(nodes.output);
+    return nodes;
+}
+
+}
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cali
+{
+namespace proc
+{
+	// A small node graph describing terrain shaping on the tileable 2D heightmap.
+	//
+	// Nodes are added in dependency order (inputs must already exist), so the
+	// insertion order is the evaluation order. The graph is evaluated tile by
+	// tile: every needed node of a tile runs over a tile-sized scratch buffer
+	// on a worker thread, and only the output node writes a full-size buffer.
+	//
+	// Changing a node's parameters marks it and its downstream nodes dirty;
+	// the next evaluate() recomputes only tiles where a dirty node can reach
+	// the output. A mask or blend whose gate input is clean and constant over
+	// a tile (e.g. a mountain mask that is all zero) blocks dirtiness there.
+	// Nodes marked with set_cached() keep their full-size output so dirty
+	// nodes downstream of them do not recompute them.
+	class terrain_graph
+	{
+	public:
+		typedef int node_id;
+		static const node_id c_no_node = -1;
+
+		enum class node_type { fbm, voronoi, remap, curve, mask, blend };
+
+		// Tileable value-noise fbm sampled at u = x / width * frequency
+		struct fbm_params
+		{
+			uint64_t seed;
+			int octaves;
+			float persistence;
+			float lacunarity;
+			float frequency;
+			int period;
+		};
+
+		enum class voronoi_channel { distance, border, cell };
+
+		// Tileable voronoi with `cells` cells across the map width. Voronoi nodes
+		// that differ only by channel are evaluated with a single voronoi call.
+		struct voronoi_params
+		{
+			uint64_t seed;
+			float cells;
+			voronoi_channel channel;
+		};
+
+		// out = out_min + ((in - in_min) / in_range) * out_range, optionally clamped
+		// to the output range
+		struct remap_params
+		{
+			float in_min;
+			float in_range;
+			float out_min;
+			float out_range;
+			bool clamp;
+		};
+
+		enum class curve_type
+		{
+			power,        // pow(max(0, x), amount)
+			smootherstep, // 6x^5 - 15x^4 + 10x^3
+			soften,       // lerp(x, smootherstep(x), amount)
+			ridge         // 1 - |2x - 1|
+		};
+
+		struct curve_params
+		{
+			curve_type type;
+			float amount;
+		};
+
+		enum class blend_mode
+		{
+			lerp,   // a + t * (b - a), t is the gate input or `amount`
+			add,    // a + b
+			select  // t < amount ? a : b
+		};
+
+		struct blend_params
+		{
+			blend_mode mode;
+			float amount;
+		};
+
+		struct evaluate_stats
+		{
+			size_t tiles_total;
+			size_t tiles_evaluated;
+			size_t node_evaluations; // node runs over a tile, summed over tiles
+		};
+
+		terrain_graph();
+		~terrain_graph();
+
+		node_id fbm(const fbm_params& params);
+		node_id voronoi(const voronoi_params& params);
+		node_id remap(node_id in, const remap_params& params);
+		node_id curve(node_id in, const curve_params& params);
+		node_id mask(node_id in, node_id mask);
+		node_id blend(node_id a, node_id b, const blend_params& params, node_id t = c_no_node);
+
+		void set_params(node_id node, const fbm_params& params);
+		void set_params(node_id node, const voronoi_params& params);
+		void set_params(node_id node, const remap_params& params);
+		void set_params(node_id node, const curve_params& params);
+		void set_params(node_id node, const blend_params& params);
+
+		void set_output(node_id node);
+		void set_cached(node_id node, bool cached);
+		void set_resolution(int width, int height, int tile_size = 32);
+
+		// Brings heights() up to date with the current parameters.
+		evaluate_stats evaluate();
+
+		// Same RGB24 quantization and dither as proc::generate_heightmap.
+		void quantize(uint64_t seed, std::vector<unsigned char>& rgb) const;
+
+		const std::vector<float>& heights() const { return m_heights; }
+		int width() const { return m_width; }
+		int height() const { return m_height; }
+		size_t node_count() const { return m_nodes.size(); }
+
+	private:
+		struct node
+		{
+			node_type type;
+			node_id inputs[3];
+			union
+			{
+				fbm_params fbm;
+				voronoi_params voronoi;
+				remap_params remap;
+				curve_params curve;
+				blend_params blend;
+			};
+			node_id voronoi_group; // first voronoi node sharing seed and cells
+			bool cached;
+			std::vector<float> cache;
+
+			node(node_type type, node_id a = c_no_node, node_id b = c_no_node, node_id c = c_no_node)
+				: type(type), inputs{ a, b, c }, fbm(), voronoi_group(c_no_node), cached(false) {}
+		};
+
+		// per tile and node: value range of the last evaluation, used to block
+		// dirtiness behind constant gates; invalid once the node went stale
+		struct tile_node_state
+		{
+			float min, max;
+			bool valid;
+		};
+
+		struct tile_scratch;
+
+		std::vector<node> m_nodes;
+		std::vector<bool> m_dirty;
+		std::vector<tile_node_state> m_tile_states; // tile-major
+		std::vector<float> m_heights;
+		node_id m_output;
+		int m_width, m_height, m_tile_size;
+		int m_tiles_x, m_tiles_y;
+
+		node_id add_node(const node& n);
+		node& typed_node(node_id id, node_type type);
+		void mark_dirty(node_id id);
+		void mark_all_dirty();
+		void update_voronoi_groups();
+		bool gate_blocks(size_t tile, node_id id, int input, const std::vector<char>& affected) const;
+		bool evaluate_tile(int tx, int ty, tile_scratch& scratch, size_t& node_evaluations);
+		void run_node(node_id id, int x0, int y0, int w, int h, tile_scratch& scratch) const;
+	};
+
+	// Handles to the tunable nodes of the default terrain graph.
+	struct default_terrain_nodes
+	{
+		terrain_graph::node_id continent;     // fbm
+		terrain_graph::node_id mountain_mask; // 0 in lowlands, 1 in highlands
+		terrain_graph::node_id small_ridges;  // remap scaling the small voronoi ridges
+		terrain_graph::node_id large_ridges;  // remap scaling the continent border ridge
+		terrain_graph::node_id peaks;         // remap scaling the extra high peaks
+		terrain_graph::node_id output;
+	};
+
+	// Builds the graph equivalent of proc::generate_heightmap for `seed` and sets
+	// its output: evaluating it at width x height and quantizing with the same
+	// seed reproduces the generator byte for byte.
+	default_terrain_nodes build_default_terrain_graph(terrain_graph& graph, uint64_t seed);
+}
+}
@@ -0,0 +1,232 @@
+#pragma once
+// Noise primitives and terrain shaping shared by the procedural generators
+// (Procedural.cpp) and the terrain node graph (ProceduralGraph.cpp).
+// Internal to cali_core; the public API lives in Procedural.h.
+#include "Procedural.h"
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+// Generation must give the same bits on every machine: only correctly rounded
+// IEEE operations (+ - * / sqrt, floor, fabs) are used, no libm transcendentals,
+// and cali_core is built without FMA contraction (CMakeLists.txt).
+static_assert(FLT_EVAL_METHOD == 0, "procedural noise needs float math without excess precision");
+
+namespace cali
+{
+namespace proc
+{
+namespace noise
+{
+inline uint64_t hash_coords(int x,int y,uint64_t seed){
+    uint64_t h = seed;
+    h ^= (uint64_t)(uint32_t)x * 0x9e3779b97f4a7c15ULL;
+    h ^= (uint64_t)(uint32_t)y * 0xbf58476d1ce4e5b9ULL;
+    h ^= ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+    return splitmix64(h);
+}
+inline uint64_t hash_coords(int x,int y,int z,uint64_t seed){
+    return splitmix64(hash_coords(x,y,seed) ^ (uint64_t)(uint32_t)z * 0x94d049bb133111ebULL);
+}
+inline float hash_to_float(uint64_t h){ return (h >> 32) * (1.0f / 4294967295.0f); }
+inline float lerp_f(float a,float b,float t){ return a + t*(b-a); }
+inline float smootherstep(float t){ return t*t*t*(t*(t*6 -15)+10); }
+
+// powf replacement that does not depend on the platform's libm: x^y for x >= 0
+// as exp2(y * log2(x)), evaluated with series in double. Within 1 ulp of powf.
+inline float portable_pow(float x,float y){
+    if(y == 0.0f) return 1.0f;
+    if(!(x > 0.0f)) return x == 0.0f ? (y > 0.0f ? 0.0f : INFINITY) : NAN;
+    int e;
+    double m = frexp((double)x, &e); // exact, m in [0.5, 1)
+    if(m < 0.70710678118654752){ m *= 2.0; --e; }
+    // ln(m) = 2 atanh(s), s = (m - 1) / (m + 1), |s| < 0.1716
+    double s = (m - 1.0) / (m + 1.0), s2 = s*s;
+    double series = 1.0/17;
+    for(int k=15;k>=1;k-=2) series = series*s2 + 1.0/k;
+    const double ln2 = 0.69314718055994531;
+    double t = (double)y * ((double)e + 2.0*s*series / ln2);
+    // 2^t = 2^n * e^(f ln2), |f| <= 0.5
+    double n = floor(t + 0.5);
+    double r = (t - n) * ln2;
+    double p = 1.0;
+    for(int k=14;k>=1;--k) p = 1.0 + p*r/k;
+    return (float)ldexp(p, (int)n);
+}
+
+inline float value_noise(float x,float y,uint64_t seed,int periodX,int periodY){
+    int xi=(int)floorf(x), yi=(int)floorf(y);
+    float xf=x-(float)xi, yf=y-(float)yi;
+    float u=smootherstep(xf), v=smootherstep(yf);
+    auto wrap=[](int v,int p)->int{ if(p<=0) return v; int r=v%p; if(r<0) r+=p; return r; };
+    int xi0=wrap(xi,periodX), yi0=wrap(yi,periodY);
+    int xi1=wrap(xi+1,periodX), yi1=wrap(yi+1,periodY);
+    float h00=hash_to_float(hash_coords(xi0,yi0,seed));
+    float h10=hash_to_float(hash_coords(xi1,yi0,seed));
+    float h01=hash_to_float(hash_coords(xi0,yi1,seed));
+    float h11=hash_to_float(hash_coords(xi1,yi1,seed));
+    float x1=lerp_f(h00,h10,u), x2=lerp_f(h01,h11,u);
+    return lerp_f(x1,x2,v);
+}
+inline float fbm_internal(float x,float y,uint64_t seed,int octaves,float persistence,float lacunarity,int periodX,int periodY){
+    float total=0, amp=1, freq=1, maxAmp=0;
+    for(int i=0;i<octaves;++i){
+        int pX=periodX>0?(int)(periodX*freq):0; if(pX==0) pX=periodX;
+        int pY=periodY>0?(int)(periodY*freq):0; if(pY==0) pY=periodY;
+        float n=value_noise(x*freq,y*freq,seed+(uint64_t)i*0x9e3779b97f4a7c15ULL,pX,pY);
+        total+=n*amp; maxAmp+=amp; amp*=persistence; freq*=lacunarity;
+    }
+    return total/maxAmp;
+}
+
+inline float value_noise_3d(float x,float y,float z,uint64_t seed){
+    int xi=(int)floorf(x), yi=(int)floorf(y), zi=(int)floorf(z);
+    float u=smootherstep(x-(float)xi), v=smootherstep(y-(float)yi), w=smootherstep(z-(float)zi);
+    float h000=hash_to_float(hash_coords(xi,  yi,  zi,  seed));
+    float h100=hash_to_float(hash_coords(xi+1,yi,  zi,  seed));
+    float h010=hash_to_float(hash_coords(xi,  yi+1,zi,  seed));
+    float h110=hash_to_float(hash_coords(xi+1,yi+1,zi,  seed));
+    float h001=hash_to_float(hash_coords(xi,  yi,  zi+1,seed));
+    float h101=hash_to_float(hash_coords(xi+1,yi,  zi+1,seed));
+    float h011=hash_to_float(hash_coords(xi,  yi+1,zi+1,seed));
+    float h111=hash_to_float(hash_coords(xi+1,yi+1,zi+1,seed));
+    float y0=lerp_f(lerp_f(h000,h100,u), lerp_f(h010,h110,u), v);
+    float y1=lerp_f(lerp_f(h001,h101,u), lerp_f(h011,h111,u), v);
+    return lerp_f(y0,y1,w);
+}
+inline float fbm_3d(float x,float y,float z,uint64_t seed,int octaves,float persistence,float lacunarity){
+    float total=0, amp=1, freq=1, maxAmp=0;
+    for(int i=0;i<octaves;++i){
+        float n=value_noise_3d(x*freq,y*freq,z*freq,seed+(uint64_t)i*0x9e3779b97f4a7c15ULL);
+        total+=n*amp; maxAmp+=amp; amp*=persistence; freq*=lacunarity;
+    }
+    return total/maxAmp;
+}
+
+inline float voronoi(float x,float y,float cellSize,uint64_t seed,int periodX,int periodY, float* outBorder=nullptr, float* outCellValue=nullptr){
+    int cellsX = periodX>0 ? std::max(1, (int)(periodX / cellSize + 0.5f)) : 64;
+    int cellsY = periodY>0 ? std::max(1, (int)(periodY / cellSize + 0.5f)) : 64;
+    float fx = x / cellSize, fy = y / cellSize;
+    int cxi = (int)floorf(fx), cyi = (int)floorf(fy);
+    float fxf = fx - cxi, fyf = fy - cyi;
+    float minDist=1e6, secondDist=1e6;
+    int bestCx=0,bestCy=0;
+    for(int dy=-1;dy<=1;++dy) for(int dx=-1;dx<=1;++dx){
+        int ncx=cxi+dx, ncy=cyi+dy;
+        int wcx = ((ncx % cellsX)+cellsX)%cellsX;
+        int wcy = ((ncy % cellsY)+cellsY)%cellsY;
+        uint64_t h = hash_coords(wcx,wcy,seed);
+        float ox = hash_to_float(h);
+        uint64_t h2 = hash_coords(wcx,wcy,seed ^ 0x9e3779b97f4a7c15ULL);
+        float oy = hash_to_float(h2);
+        float px = (float)dx + ox - fxf;
+        float py = (float)dy + oy - fyf;
+        float d = sqrtf(px*px + py*py);
+        if(d < minDist){ secondDist=minDist; minDist=d; bestCx=wcx; bestCy=wcy; }
+        else if(d < secondDist){ secondDist=d; }
+    }
+    if(outBorder) *outBorder = secondDist - minDist;
+    if(outCellValue){
+        uint64_t hc = hash_coords(bestCx,bestCy,seed ^ 0x6a09e667f3bcc908ULL);
+        *outCellValue = hash_to_float(hc);
+    }
+    return std::clamp(minDist / 1.41421356f, 0.0f, 1.0f);
+}
+
+inline float voronoi_3d(float x,float y,float z,float cellSize,uint64_t seed, float* outBorder=nullptr, float* outCellValue=nullptr){
+    float fx = x / cellSize, fy = y / cellSize, fz = z / cellSize;
+    int cxi = (int)floorf(fx), cyi = (int)floorf(fy), czi = (int)floorf(fz);
+    float fxf = fx - cxi, fyf = fy - cyi, fzf = fz - czi;
+    float minDist=1e6, secondDist=1e6;
+    int bestCx=0,bestCy=0,bestCz=0;
+    for(int dz=-1;dz<=1;++dz) for(int dy=-1;dy<=1;++dy) for(int dx=-1;dx<=1;++dx){
+        int ncx=cxi+dx, ncy=cyi+dy, ncz=czi+dz;
+        float ox = hash_to_float(hash_coords(ncx,ncy,ncz,seed));
+        float oy = hash_to_float(hash_coords(ncx,ncy,ncz,seed ^ 0x9e3779b97f4a7c15ULL));
+        float oz = hash_to_float(hash_coords(ncx,ncy,ncz,seed ^ 0xbf58476d1ce4e5b9ULL));
+        float px = (float)dx + ox - fxf;
+        float py = (float)dy + oy - fyf;
+        float pz = (float)dz + oz - fzf;
+        float d = sqrtf(px*px + py*py + pz*pz);
+        if(d < minDist){ secondDist=minDist; minDist=d; bestCx=ncx; bestCy=ncy; bestCz=ncz; }
+        else if(d < secondDist){ secondDist=d; }
+    }
+    if(outBorder) *outBorder = secondDist - minDist;
+    if(outCellValue) *outCellValue = hash_to_float(hash_coords(bestCx,bestCy,bestCz,seed ^ 0x6a09e667f3bcc908ULL));
+    return std::clamp(minDist / 1.73205081f, 0.0f, 1.0f);
+}
+
+// Raw noise values feeding the terrain shaping; both the tileable 2D map and
+// the cube-sphere faces are shaped by the same function.
+struct terrain_inputs
+{
+    float continent;   // low frequency fbm
+    float vor_large;   // large voronoi distance
+    float vor_cell;    // large voronoi cell value
+    float vor_border;  // large voronoi border distance
+    float vor_small;   // small voronoi distance
+    float detail;      // high frequency fbm
+};
+
+inline float shape_terrain(const terrain_inputs& in){
+    // soft continents with a subtle large voronoi blend
+    float continentVor = 1.0f - in.vor_large;
+    continentVor = portable_pow(continentVor, 2.2f); // very soft
+    float base = lerp_f(in.continent, continentVor, 0.20f); // only 20% voronoi influence
+    // remap to 0-1 with soft contrast
+    base = std::clamp((base - 0.38f) / 0.50f, 0.0f, 1.0f);
+    base = lerp_f(base, smootherstep(base), 0.4f); // soften
+
+    // fine detail – very low amplitude for soft hills
+    float detail = (in.detail - 0.5f) * 0.08f; // tiny variation
+
+    // mountain ridges – only where base is high (mountain mask)
+    float mountainMask = smootherstep(std::clamp((base - 0.45f)/0.35f, 0.0f, 1.0f)); // 0 in lowlands, 1 in highlands
+    mountainMask = portable_pow(mountainMask, 0.9f);
+    float mountVar = 0.55f + in.vor_cell * 1.1f; // 0.55-1.65, high vs mid
+
+    // small Voronoi ridges localized to mountains
+    float ridgeS = 1.0f - fabsf(in.vor_small*2.0f - 1.0f);
+    ridgeS = portable_pow(std::max(0.0f, ridgeS), 2.2f) * 0.10f * mountainMask * mountVar;
+
+    // large ridge at continent borders – subtle
+    float largeRidge = portable_pow(std::max(0.0f, 1.0f - in.vor_border*3.0f), 2.0f) * 0.06f * mountainMask * mountVar;
+
+    float h = base + detail + ridgeS + largeRidge;
+    h = std::clamp(h, 0.0f, 1.0f);
+    // final soften
+    h = lerp_f(h, smootherstep(h), 0.25f);
+
+    const float sea = 0.50f; // more ocean (50%)
+    float tex;
+    if(h < sea){
+        float t = h / sea;
+        t = portable_pow(t, 1.2f);
+        tex = t * 0.0032f; // ocean 0..0.0032 -> height 0..8.5
+    }else{
+        float t = (h - sea) / (1.0f - sea);
+        t = portable_pow(t, 0.88f);
+        // base land, 3x peaks with variability
+        // high cells get up to 3x, mid cells ~1.5x
+        float peakScale = 0.55f * (0.75f + 0.5f*in.vor_cell); // 0.41-0.68
+        tex = 0.0042f + t * peakScale * mountVar * 0.55f;
+        // extra high peaks for very high t, variable
+        if(t > 0.62f){
+            float m = (t - 0.62f)/0.38f;
+            tex += portable_pow(m, 1.6f) * 0.28f * mountVar;
+        }
+        if(tex > 1.0f) tex = 1.0f;
+    }
+    return std::clamp(tex, 0.0f, 1.0f);
+}
+
+// add tiny hash dither to avoid banding
+inline unsigned char quantize_height(float tex, uint64_t dither_hash){
+    float dither = (hash_to_float(dither_hash) - 0.5f) * (0.5f/255.0f);
+    tex = std::clamp(tex + dither, 0.0f, 1.0f);
+    return (unsigned char)std::clamp((int)roundf(tex*255.0f),0,255);
+}
+}
+}
+}
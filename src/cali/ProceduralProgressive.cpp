@@ -0,0 +1,103 @@
+#include "ProceduralProgressive.h"
+#include "Procedural.h"
+
+#include <cstdio>
+#include <stdexcept>
+
+namespace cali
+{
+namespace proc
+{
+
+std::vector<int> progressive_heightmap::level_sizes(int final_size,int preview_size){
+    if(final_size <= 0 || preview_size <= 0) throw std::invalid_argument("progressive_heightmap: invalid size");
+    std::vector<int> sizes{ final_size };
+    while(sizes.front() / 2 >= preview_size) sizes.insert(sizes.begin(), sizes.front() / 2);
+    return sizes;
+}
+
+progressive_heightmap::progressive_heightmap(uint64_t seed,layout layout,int final_size,int preview_size,
+    const erosion_params* erosion,const asset_cache& cache)
+    : m_seed(seed), m_layout(layout), m_sizes(level_sizes(final_size, preview_size)),
+      m_start(std::chrono::steady_clock::now()), m_erode(erosion != nullptr),
+      m_erosion(erosion ? *erosion : erosion_params()), m_cache(cache), m_has_latest(false),
+      m_stop(false), m_complete(false), m_time_to_preview(-1.0), m_time_to_full_quality(-1.0)
+{
+    level preview;
+    generate_level(0, preview);
+    m_time_to_preview = preview.seconds;
+    publish(std::move(preview));
+    if(!m_complete) m_worker = std::thread(&progressive_heightmap::refine, this);
+}
+
+progressive_heightmap::~progressive_heightmap(){
+    m_stop = true;
+    if(m_worker.joinable()) m_worker.join();
+}
+
+std::string progressive_heightmap::cache_key(int size) const {
+    char key[128];
+    snprintf(key, sizeof(key), "heightmap_%s_%016llx_%d_eroded_%016llx", m_layout == layout::tileable ? "tileable" : "cube",
+        (unsigned long long)m_seed, size, (unsigned long long)erosion_params_hash(m_erosion));
+    return key;
+}
+
+void progressive_heightmap::generate_level(int index,level& out) const {
+    out.index = index;
+    out.size = m_sizes[index];
+    out.final = index + 1 == (int)m_sizes.size();
+    out.eroded = out.final && m_erode;
+    const bool tileable = m_layout == layout::tileable;
+    out.width = tileable ? out.size : out.size * 3;
+    out.height = tileable ? out.size : out.size * 2;
+
+    const std::string key = out.eroded ? cache_key(out.size) : std::string();
+    out.from_cache = out.eroded && m_cache.load(key, c_cache_version, out.rgb) && out.rgb.size() == (size_t)out.width*out.height*3;
+    if(!out.from_cache){
+        if(tileable){
+            std::vector<float> heights;
+            generate_heightmap_heights(m_seed, out.size, out.size, heights);
+            if(out.eroded) erode_heightmap(m_seed, out.size, out.size, true, heights, m_erosion);
+            quantize_heightmap(m_seed, out.size, out.size, heights, out.rgb);
+        }else{
+            cube_sphere_heightmap hm;
+            generate_cube_sphere_heightmap(m_seed, out.size, hm, out.eroded ? &m_erosion : nullptr);
+            pack_cube_sphere_atlas(hm, out.rgb);
+        }
+        if(out.eroded) m_cache.store(key, c_cache_version, out.rgb.data(), out.rgb.size());
+    }
+    out.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+}
+
+void progressive_heightmap::publish(level&& l){
+    const bool final = l.final;
+    const double seconds = l.seconds;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_latest = std::move(l);
+        m_has_latest = true;
+    }
+    if(final){
+        m_time_to_full_quality = seconds;
+        m_complete = true;
+    }
+}
+
+void progressive_heightmap::refine(){
+    for(int index=1;index<(int)m_sizes.size() && !m_stop;++index){
+        level l;
+        generate_level(index, l);
+        publish(std::move(l));
+    }
+}
+
+bool progressive_heightmap::take_latest(level& out){
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(!m_has_latest) return false;
+    out = std::move(m_latest);
+    m_latest = level();
+    m_has_latest = false;
+    return true;
+}
+}
+}
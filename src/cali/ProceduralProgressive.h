@@ -0,0 +1,124 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AssetCache.h"
+#include "ProceduralErosion.h"
+
+class IvTexture;
+
+namespace cali
+{
+namespace proc
+{
+	// Coarse-to-fine heightmap generation: a small preview level is generated
+	// synchronously so the first frame does not wait for the full map, then
+	// each level doubling the resolution up to the final size is generated on
+	// a background thread. Levels are independent full generations at their
+	// resolution (same seed => same terrain at every level). With erosion the
+	// final level is eroded, and kept in the asset cache so that it is eroded
+	// only once per seed, size and erosion parameters.
+	class progressive_heightmap
+	{
+	public:
+		enum class layout
+		{
+			tileable,          // generate_heightmap, size x size
+			cube_sphere_atlas  // generate_cube_sphere_heightmap, size = face size, packed 3x2
+		};
+
+		struct level
+		{
+			int index = -1;          // 0 = preview
+			int size = 0;            // map size or face size
+			int width = 0, height = 0;
+			std::vector<unsigned char> rgb;
+			double seconds = 0.0;    // since the progressive_heightmap was created
+			bool final = false;
+			bool eroded = false;
+			bool from_cache = false;
+		};
+
+		// bump when the generators or the erosion change the cached bytes
+		static const uint32_t c_cache_version = 2;
+
+		// Sizes from the preview up to final_size, doubling each level:
+		// preview_size <= sizes[0] < 2 * preview_size, sizes.back() == final_size.
+		static std::vector<int> level_sizes(int final_size, int preview_size);
+
+		// Generates the preview level before returning.
+		progressive_heightmap(uint64_t seed, layout layout, int final_size, int preview_size,
+			const erosion_params* erosion = nullptr, const asset_cache& cache = asset_cache());
+		// Waits for the level being generated; the remaining levels are dropped.
+		~progressive_heightmap();
+
+		progressive_heightmap(const progressive_heightmap&) = delete;
+		progressive_heightmap& operator=(const progressive_heightmap&) = delete;
+
+		// Hands out the newest level finished since the last call. Intermediate
+		// levels that were overtaken before being taken are skipped.
+		bool take_latest(level& out);
+
+		bool is_complete() const { return m_complete; }
+		int level_count() const { return (int)m_sizes.size(); }
+
+		// Seconds since creation; negative until reached.
+		double time_to_preview() const { return m_time_to_preview; }
+		double time_to_full_quality() const { return m_time_to_full_quality; }
+
+	private:
+		const uint64_t m_seed;
+		const layout m_layout;
+		const std::vector<int> m_sizes;
+		const std::chrono::steady_clock::time_point m_start;
+		const bool m_erode;
+		const erosion_params m_erosion;
+		const asset_cache m_cache;
+
+		std::mutex m_mutex;
+		level m_latest;                 // guarded by m_mutex
+		bool m_has_latest;              // guarded by m_mutex
+		std::atomic<bool> m_stop;
+		std::atomic<bool> m_complete;
+		std::atomic<double> m_time_to_preview;
+		std::atomic<double> m_time_to_full_quality;
+		std::thread m_worker;
+
+		std::string cache_key(int size) const;
+		void generate_level(int index, level& out) const;
+		void publish(level&& l);
+		void refine();
+	};
+
+	// Renderer side of progressive_heightmap (ProceduralTexture.cpp): owns the
+	// texture of the newest level. update() must run on the render thread.
+	class progressive_heightmap_texture
+	{
+		progressive_heightmap m_generator;
+		progressive_heightmap::layout m_layout;
+		IvTexture* m_texture;
+		int m_level;
+
+		// replaces the texture with l's; false if it could not be created
+		bool upload(const progressive_heightmap::level& l);
+
+	public:
+		progressive_heightmap_texture(uint64_t seed, progressive_heightmap::layout layout, int final_size, int preview_size,
+			const erosion_params* erosion = nullptr, const asset_cache& cache = asset_cache());
+		~progressive_heightmap_texture();
+
+		// Replaces the texture with the newest finished level, destroying the old
+		// one. Returns true if the texture changed and must be bound again.
+		bool update();
+
+		IvTexture* texture() const { return m_texture; }
+		int level() const { return m_level; }
+		const progressive_heightmap& generator() const { return m_generator; }
+	};
+}
+}
@@ -0,0 +1,71 @@
+#include "Procedural.h"
+#include "ProceduralProgressive.h"
+
+#include <IvRenderer.h>
+#include <IvResourceManager.h>
+#include <IvTexture.h>
+
+#include <vector>
+
+namespace cali
+{
+namespace proc
+{
+
+static IvTexture* create_heightmap_texture(const std::vector<unsigned char>& data,int width,int height,IvTextureAddrMode addressing){
+    auto& renderer=*IvRenderer::mRenderer;
+    auto& resman=*renderer.GetResourceManager();
+    IvTexture* tex = resman.CreateTexture(kRGB24TexFmt,width,height,(void*)data.data(),kDefaultUsage);
+    if(!tex) return nullptr;
+    tex->SetAddressingU(addressing);
+    tex->SetAddressingV(addressing);
+    tex->SetMagFiltering(kBilerpTexMagFilter);
+    tex->SetMinFiltering(kBilerpTexMinFilter);
+    return tex;
+}
+
+// faces are sampled strictly inside their atlas cell, so clamp is enough
+static IvTextureAddrMode heightmap_addressing(progressive_heightmap::layout layout){
+    return layout == progressive_heightmap::layout::tileable ? kWrapTexAddr : kClampTexAddr;
+}
+
+IvTexture* generate_heightmap_texture(uint64_t seed,int width,int height){
+    std::vector<unsigned char> data;
+    generate_heightmap(seed, width, height, data);
+    return create_heightmap_texture(data, width, height, kWrapTexAddr);
+}
+
+IvTexture* generate_cube_sphere_heightmap_texture(uint64_t seed,int face_size){
+    cube_sphere_heightmap hm;
+    generate_cube_sphere_heightmap(seed, face_size, hm);
+    std::vector<unsigned char> data;
+    pack_cube_sphere_atlas(hm, data);
+    return create_heightmap_texture(data, face_size * 3, face_size * 2, kClampTexAddr);
+}
+
+progressive_heightmap_texture::progressive_heightmap_texture(uint64_t seed,progressive_heightmap::layout layout,int final_size,int preview_size,
+    const erosion_params* erosion,const asset_cache& cache)
+    : m_generator(seed, layout, final_size, preview_size, erosion, cache), m_layout(layout), m_texture(nullptr), m_level(-1)
+{
+    update();
+}
+
+progressive_heightmap_texture::~progressive_heightmap_texture(){
+    if(m_texture) IvRenderer::mRenderer->GetResourceManager()->Destroy(m_texture);
+}
+
+bool progressive_heightmap_texture::update(){
+    progressive_heightmap::level l;
+    return m_generator.take_latest(l) && upload(l);
+}
+
+bool progressive_heightmap_texture::upload(const progressive_heightmap::level& l){
+    IvTexture* tex = create_heightmap_texture(l.rgb, l.width, l.height, heightmap_addressing(m_layout));
+    if(!tex) return false;
+    if(m_texture) IvRenderer::mRenderer->GetResourceManager()->Destroy(m_texture);
+    m_texture = tex;
+    m_level = l.index;
+    return true;
+}
+}
+}
@@ -0,0 +1,20 @@
+#include "RelativeToEye.h"
+
+namespace cali
+{
+namespace Math
+{
+	void relative_to_eye_batch(const IvDoubleVector3* positions, size_t count, const IvDoubleVector3& eye,
+		IvVector3* offsets)
+	{
+		// no aliasing and no calls: the compiler converts several components at a time
+		const double ex = eye.x, ey = eye.y, ez = eye.z;
+		for (size_t i = 0; i < count; ++i)
+		{
+			offsets[i].x = (float)(positions[i].x - ex);
+			offsets[i].y = (float)(positions[i].y - ey);
+			offsets[i].z = (float)(positions[i].z - ez);
+		}
+	}
+}
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <IvDoubleVector3.h>
+#include <IvVector3.h>
+
+#include <cstddef>
+
+namespace cali
+{
+	namespace Math
+	{
+		// -----------------------------------------------------------------
+		// Positions relative to the eye for the GPU: the difference is taken
+		// in double and rounded to float once, so an offset of d metres is
+		// off by at most half a float ulp of d, wherever the eye is. Casting
+		// to float first, as (IvVector3)p - (IvVector3)eye, rounds both
+		// positions to the ulp of the planet radius (0.5 m at 6360 km).
+		// -----------------------------------------------------------------
+
+		inline IvVector3 relative_to_eye(const IvDoubleVector3& position, const IvDoubleVector3& eye)
+		{
+			return (IvVector3)(position - eye);
+		}
+
+		// offsets[i] = relative_to_eye(positions[i], eye), the same bits
+		void relative_to_eye_batch(const IvDoubleVector3* positions, size_t count, const IvDoubleVector3& eye,
+			IvVector3* offsets);
+	}
+}
@@ -0,0 +1,76 @@
+#include "RenderTexturePool.h"
+
+#include <IvRenderTexture.h>
+#include <IvResourceManager.h>
+
+#include <D3D11\IvTextureD3D11.h>
+
+namespace cali
+{
+	namespace
+	{
+		size_t texture_bytes(unsigned int width, unsigned int height, unsigned int depth, IvTextureFormat format)
+		{
+			return (size_t)width * height * (depth > 0 ? depth : 1) * sInternalTextureFormatSize[format];
+		}
+	}
+
+	render_texture_pool::~render_texture_pool()
+	{
+		for (entry& e : m_entries) m_resman.Destroy(e.texture);
+	}
+
+	IvRenderTexture* render_texture_pool::acquire(unsigned int width, unsigned int height, unsigned int depth,
+		IvTextureFormat format)
+	{
+		for (entry& e : m_entries)
+		{
+			if (!e.in_use && e.width == width && e.height == height && e.depth == depth && e.format == format)
+			{
+				e.in_use = true;
+				return e.texture;
+			}
+		}
+
+		IvRenderTexture* texture = depth > 0 ? m_resman.CreateRenderTexture(width, height, depth, format) :
+			m_resman.CreateRenderTexture(width, height, format);
+		if (!texture) return nullptr;
+		m_entries.push_back({ texture, width, height, depth, format, true });
+		return texture;
+	}
+
+	void render_texture_pool::release(IvRenderTexture* texture)
+	{
+		for (entry& e : m_entries)
+			if (e.texture == texture) e.in_use = false;
+	}
+
+	void render_texture_pool::trim()
+	{
+		for (auto it = m_entries.begin(); it != m_entries.end();)
+		{
+			if (it->in_use)
+			{
+				++it;
+				continue;
+			}
+			m_resman.Destroy(it->texture);
+			it = m_entries.erase(it);
+		}
+	}
+
+	size_t render_texture_pool::resident_bytes() const
+	{
+		size_t bytes = 0;
+		for (const entry& e : m_entries) bytes += texture_bytes(e.width, e.height, e.depth, e.format);
+		return bytes;
+	}
+
+	size_t render_texture_pool::in_use_bytes() const
+	{
+		size_t bytes = 0;
+		for (const entry& e : m_entries)
+			if (e.in_use) bytes += texture_bytes(e.width, e.height, e.depth, e.format);
+		return bytes;
+	}
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <IvTextureFormats.h>
+
+#include <cstddef>
+#include <vector>
+
+class IvRenderTexture;
+class IvResourceManager;
+
+namespace cali
+{
+	// Render textures that are only needed for a while, like the intermediate
+	// LUTs of the atmosphere precompute. acquire() hands out a released texture
+	// of the same size and format when there is one, trim() destroys the
+	// released ones.
+	class render_texture_pool
+	{
+		struct entry
+		{
+			IvRenderTexture* texture;
+			unsigned int width, height, depth;
+			IvTextureFormat format;
+			bool in_use;
+		};
+
+		IvResourceManager& m_resman;
+		std::vector<entry> m_entries;
+
+		render_texture_pool(const render_texture_pool&) = delete;
+		render_texture_pool& operator=(const render_texture_pool&) = delete;
+
+	public:
+		explicit render_texture_pool(IvResourceManager& resman) : m_resman(resman) {}
+		~render_texture_pool();
+
+		// depth 0: a 2D texture. Null if the texture can't be created.
+		IvRenderTexture* acquire(unsigned int width, unsigned int height, unsigned int depth, IvTextureFormat format);
+		void release(IvRenderTexture* texture);
+		void trim();
+
+		// GPU memory of every texture of the pool / of those handed out.
+		size_t resident_bytes() const;
+		size_t in_use_bytes() const;
+	};
+}
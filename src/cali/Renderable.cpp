@@ -28,70 +28,74 @@ namespace cali
 		mat(2, 2) = up.z;
 	}
 
-	void physical::calculate_model_matrix()
+	// m_direction and m_right are already unit; the scale multiplies the
+	// columns, which is what the product with a scale matrix did
+	void physical::calculate_model_matrix() const
 	{
-		normalize();
-
 		auto up = m_direction.Cross(m_right);
 		up.Normalize();
 
-		m_model_matrix(0, 0) = m_right.x;
-		m_model_matrix(0, 1) = up.x;
-		m_model_matrix(0, 2) = m_direction.x;
+		m_model_matrix(0, 0) = m_right.x * m_scale.x;
+		m_model_matrix(0, 1) = up.x * m_scale.y;
+		m_model_matrix(0, 2) = m_direction.x * m_scale.z;
 
-		m_model_matrix(1, 0) = m_right.y;
-		m_model_matrix(1, 1) = up.y;
-		m_model_matrix(1, 2) = m_direction.y;
+		m_model_matrix(1, 0) = m_right.y * m_scale.x;
+		m_model_matrix(1, 1) = up.y * m_scale.y;
+		m_model_matrix(1, 2) = m_direction.y * m_scale.z;
 
-		m_model_matrix(2, 0) = m_right.z;
-		m_model_matrix(2, 1) = up.z;
-		m_model_matrix(2, 2) = m_direction.z;
+		m_model_matrix(2, 0) = m_right.z * m_scale.x;
+		m_model_matrix(2, 1) = up.z * m_scale.y;
+		m_model_matrix(2, 2) = m_direction.z * m_scale.z;
 
 		m_model_matrix(0, 3) = m_position.x;
 		m_model_matrix(1, 3) = m_position.y;
 		m_model_matrix(2, 3) = m_position.z;
 
-		IvMatrix44 scale_matrix;
-
-		scale_matrix(0, 0) = m_scale.x;
-		scale_matrix(1, 1) = m_scale.y;
-		scale_matrix(2, 2) = m_scale.z;
-
-		m_model_matrix = m_model_matrix * scale_matrix;
+		m_model_matrix_dirty = false;
 	}
 
 	void physical::normalize()
 	{
 		m_direction.Normalize();
 		m_right.Normalize();
+		m_model_matrix_dirty = true;
 	}
 
 	physical::physical()
 	{
 		m_model_matrix.Identity();
+		m_model_matrix_dirty = false;
 		m_position = { 0.f, 0.f, 0.f };
+		m_world_position = IvDoubleVector3(0.0, 0.0, 0.0);
 		m_direction = { 0.f, 0.f, 1.f };
 		m_right = { 1.0, 0.0, 0.0 };
 		m_scale = { 1.0f, 1.0f, 1.0f };
-		calculate_model_matrix();
 	}
 
 	void physical::set_scale(float scale)
 	{
 		m_scale = { scale, scale, scale };
-		calculate_model_matrix();
+		m_model_matrix_dirty = true;
 	}
 
 	void physical::set_scale(const IvVector3 & scale)
 	{
 		m_scale = scale;
-		calculate_model_matrix();
+		m_model_matrix_dirty = true;
 	}
 
 	void physical::set_position(const IvVector3 & pos)
 	{
 		m_position = pos;
-		calculate_model_matrix();
+		m_world_position = pos;
+		m_model_matrix_dirty = true;
+	}
+
+	void physical::set_world_position(const IvDoubleVector3 & pos)
+	{
+		m_position = pos;
+		m_world_position = pos;
+		m_model_matrix_dirty = true;
 	}
 
 	void physical::set_direction(const IvVector3& dir, const IvVector3& up)
@@ -110,7 +114,7 @@ namespace cali
 		m_direction = direction;
 		m_right = up.Cross(m_direction);
 
-		calculate_model_matrix();
+		normalize();
 	}
 
 	IvMatrix44 physical::get_rotation()
@@ -135,13 +139,13 @@ namespace cali
 
 	void physical::look_at(const IvVector3 & point, const IvVector3 & up)
 	{
-		auto direction = point - m_position;
+		IvVector3 direction = IvDoubleVector3(point) - m_world_position;
 		set_direction(direction, up);
 	}
 
 	void physical::set_transformation_matrix(IvRenderer & renderer) const
 	{
-		renderer.SetWorldMatrix(m_model_matrix);
+		renderer.SetWorldMatrix(get_transformation_matrix());
 	}
 
 	void physical::pitch(float angle)
@@ -153,7 +157,7 @@ namespace cali
 
 		m_direction = m_direction * rotation_matrix;
 		
-		calculate_model_matrix();
+		normalize();
 	}
 
 	void physical::yaw(float angle)
@@ -166,7 +170,7 @@ namespace cali
 		m_direction = m_direction * rotation_matrix;
 		m_right = m_right * rotation_matrix;
 
-		calculate_model_matrix();
+		normalize();
 	}
 
 	void physical::rotate(const IvVector3 & from, const IvVector3 & to)
@@ -186,7 +190,7 @@ namespace cali
 		m_direction = m_direction * rotation_matrix;
 		m_right = m_right * rotation_matrix;
 
-		calculate_model_matrix();
+		normalize();
 
 	}
 }
\ No newline at end of file
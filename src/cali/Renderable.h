@@ -4,6 +4,7 @@
 //-- Dependencies ---------------------------------------------------------------
 //-------------------------------------------------------------------------------
 
+#include <IvDoubleVector3.h>
 #include <IvMatrix33.h>
 #include <IvVector2.h>
 #include <IvVector3.h>
@@ -35,16 +36,22 @@ namespace cali
 		virtual void render(IvRenderer& renderer, const class frustum& frustum) = 0;
 	};
 
+	// The setters only mark the model matrix dirty; it is rebuilt once, when
+	// it is next read. Many transforms updated every frame belong in a
+	// transform_store (TransformStore.h) instead.
 	class physical
 	{
-		IvMatrix44 m_model_matrix;
+		mutable IvMatrix44 m_model_matrix;
+		mutable bool m_model_matrix_dirty;
+		// m_world_position rounded to float, for the model matrix
 		IvVector3 m_position;
+		IvDoubleVector3 m_world_position;
 		IvVector3 m_direction;
 		IvVector3 m_right;
 		IvVector3 m_scale;
 
 	private:
-		void calculate_model_matrix();
+		void calculate_model_matrix() const;
 		void normalize();
 
 	public:
@@ -61,17 +68,24 @@ namespace cali
 		void set_scale(float scale);
 		void set_scale(const IvVector3& scale);
 		void set_position(const IvVector3& pos);
+		// in double: what moves over planet-sized distances keeps its precision
+		void set_world_position(const IvDoubleVector3& pos);
 		void set_direction(const IvVector3& dir, const IvVector3& up);
 
 		const IvVector3& get_scale() const { return m_scale; }
 		IvMatrix44 get_rotation();
 		const IvVector3& get_position() const { return m_position; }
+		const IvDoubleVector3& get_world_position() const { return m_world_position; }
 		const IvVector3& get_direction() const { return m_direction; }
 		const IvVector3& get_right() const { return m_right; }
 
 		void look_at(const IvVector3& point, const IvVector3 & up);
 
-		const IvMatrix44& get_transformation_matrix() { return m_model_matrix; };
+		const IvMatrix44& get_transformation_matrix() const
+		{
+			if (m_model_matrix_dirty) calculate_model_matrix();
+			return m_model_matrix;
+		};
 
 		void set_transformation_matrix(IvRenderer& renderer) const;
 
@@ -44,6 +44,8 @@ namespace cali
 		m_sky_shader->GetUniform("transmittance_texture")->SetValue(m_bruneton.get_transmittance_texture());
 		m_sky_shader->GetUniform("scattering_texture")->SetValue(m_bruneton.get_scattering_texture());
 		texture::set_texture_safely(m_sky_shader, "irradiance_texture", m_bruneton.get_irradiance_texture());
+		if (m_bruneton.get_single_mie_scattering_texture())
+			texture::set_texture_safely(m_sky_shader, "single_mie_scattering_texture", m_bruneton.get_single_mie_scattering_texture());
 	}
 
 	sky::~sky()
@@ -37,12 +37,9 @@ namespace cali
         }
     }
 
-    IvVector3 rotate_around_point(const IvVector3& what, const IvVector3& point, const IvVector3& axis, const float angle)
+    IvVector3 rotate_around_point(const IvVector3& what, const IvVector3& point, const IvMatrix33& rotation)
     {
         auto moved_to_origin = what - point;
-
-        IvMatrix33 rotation;
-        rotation.Rotation(axis, angle);
         const auto rotated = moved_to_origin * rotation;
 
         return rotated + point;
@@ -52,20 +49,22 @@ namespace cali
     {
         srand(static_cast<unsigned int>(time(nullptr)));
 
+        m_stars.reserve(count);
         for (size_t i = 0; i < count; ++i)
         {
-            star new_star{ 
+            const auto star = m_stars.create();
+            m_stars.set_position(star,
                 utils::get_random_point_on_sphere(
                     world::c_earth_center,
-                    world::c_earth_radius),
+                    world::c_earth_radius));
+            m_stars.set_scale(star,
                 utils::random_float(
                     world::c_star_visible_size_min, 
-                    world::c_star_visible_size_max) };
-
-            new_star.look_at(world::c_earth_center, constants::c_world_up);
+                    world::c_star_visible_size_max));
 
-            m_stars.emplace_back(new_star);
+            m_stars.look_at(star, world::c_earth_center, constants::c_world_up);
         }
+        m_stars.update();
     }
     stars::stars()
     {
@@ -95,24 +94,28 @@ namespace cali
     }
     void stars::update(float dt)
     {
-        for (auto& star : m_stars)
+        IvMatrix33 rotation;
+        rotation.Rotation({ 1.f, 0.f, 0.f }, -0.05f * dt);
+
+        for (transform_store::handle star = 0; star < m_stars.size(); ++star)
         {
-            star.set_position(
+            m_stars.set_position(star,
                 rotate_around_point(
-                    star.get_position(),
+                    m_stars.get_position(star),
                     world::c_earth_center,
-                    { 1.f, 0.f, 0.f },
-                    -0.05f * dt));
+                    rotation));
 
-            star.look_at(world::c_earth_center, constants::c_world_up);
+            m_stars.look_at(star, world::c_earth_center, constants::c_world_up);
         }
+
+        m_stars.update();
     }
     void stars::render(IvRenderer & renderer)
     {
         renderer.SetBlendFunc(kOneBlendFunc, kZeroBlendFunc, kAddBlendOp);
-        for (const auto& star : m_stars)
+        for (transform_store::handle star = 0; star < m_stars.size(); ++star)
         {
-            star.set_transformation_matrix(renderer);
+            renderer.SetWorldMatrix(m_stars.get_world_matrix(star));
             m_quad.render(renderer, m_shader);
         }
     }
@@ -1,27 +1,17 @@
 #pragma once
 #include "Renderable.h"
 #include "Model.h"
+#include "TransformStore.h"
 #include "IvRenderTexture.h"
 
 namespace cali
 {
-    class star : public physical
-    {
-    public:
-        star(const IvVector3& position, float scale) 
-        { 
-            set_position(position); 
-            set_scale(scale);
-        }
-
-        ~star() override {}
-    };
-
     class stars : public physical
     {
         //model<kTNPFormat, IvTNPVertex> m_box;
         model<kTNPFormat, IvTNPVertex> m_quad;
-        std::vector<star> m_stars;
+        // one transform per star, updated in one pass per frame
+        transform_store m_stars;
         IvShaderProgram* m_shader{ nullptr };
 
         void generate_stars(size_t count);
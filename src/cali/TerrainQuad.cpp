@@ -9,14 +9,17 @@
 #include "Constants.h"
 #include "CommonFileSystem.h"
 #include "CommonTexture.h"
+#include "Procedural.h"
 #include "CaliMath.h"
 #include "CaliSphereMath.h"
-#include "AABB.h"
+#include "RelativeToEye.h"
 
 #include "DebugInfo.h"
 
 #include "IvDoubleVector3.h"
 
+#include <algorithm>
+
 namespace cali
 {
 	void set_quad_data_texture(void* quad_data_texture, size_t width, size_t height, size_t x, size_t y,
@@ -102,7 +105,7 @@ namespace cali
 		},
 		m_grid(c_gird_cells, c_gird_cells, 1.0f),
 		m_bruneton(bruneton),
-		m_viewer_position{ 0.0f, 0.0f, 0.0f },
+		m_viewer_position{ 0.0, 0.0, 0.0 },
 		m_overlapping_edge_cells(c_gird_cells / 16),
 		m_planet_center(cali::world::c_earth_center),
 		m_planet_radius(cali::world::c_earth_radius)
@@ -119,19 +122,39 @@ namespace cali
 
 		if (!m_shader) throw std::exception("terrain: failed to load shader program");
 
-		// Procedural planet surface: hash => stable terrain, no bitmap file needed
-		m_height_map_texture = texture::generate_procedural_heightmap(world::c_planet_hash, world::c_heightmap_size, world::c_heightmap_size);
-		if (!m_height_map_texture) throw("terrain: failed to generate procedural height map");
+		// Procedural planet surface: hash => stable terrain, one seamless tile per cube face.
+		// A coarse preview is bound right away and refined on a background thread (see update).
+		// The final level is eroded once per seed and then loaded from the asset cache.
+		const std::string executable_dir = get_executable_file_directory();
+		const asset_cache cache = executable_dir.empty() ? asset_cache() : asset_cache(executable_dir + "\\cache");
+		const proc::erosion_params erosion;
+		m_height_map = std::make_unique<proc::progressive_heightmap_texture>(proc::hash_string(world::c_planet_hash),
+			proc::progressive_heightmap::layout::cube_sphere_atlas, world::c_heightmap_face_size, world::c_heightmap_preview_face_size,
+			&erosion, cache);
+		if (!m_height_map->texture()) throw("terrain: failed to generate procedural height map");
 
-		m_shader->GetUniform("height_map")->SetValue(m_height_map_texture);
+		m_shader->GetUniform("height_map")->SetValue(m_height_map->texture());
 
 		texture::set_texture_safely(m_shader, "transmittance_texture", m_bruneton.get_transmittance_texture());
 		texture::set_texture_safely(m_shader, "scattering_texture", m_bruneton.get_scattering_texture());
 		texture::set_texture_safely(m_shader, "irradiance_texture", m_bruneton.get_irradiance_texture());
+		if (m_bruneton.get_single_mie_scattering_texture())
+			texture::set_texture_safely(m_shader, "single_mie_scattering_texture", m_bruneton.get_single_mie_scattering_texture());
+	}
+
+	void terrain_quad::set_aerial_perspective(IvTexture* in_scattering, IvTexture* transmittance)
+	{
+		texture::set_texture_safely(m_shader, "aerial_perspective_in_scattering", in_scattering);
+		texture::set_texture_safely(m_shader, "aerial_perspective_transmittance", transmittance);
 	}
 
 	void terrain_quad::update(float dt)
 	{
+		if (m_height_map->update())
+		{
+			m_shader->GetUniform("height_map")->SetValue(m_height_map->texture());
+		}
+		debug_info::get_debug_info().set_debug_string(L"heightmap_level", (float)m_height_map->level());
 	}
 
 	void terrain_quad::render(IvRenderer & renderer)
@@ -149,7 +172,7 @@ namespace cali
 		double area_size;
 	};
 
-	void get_map_lon_lat_form_viewer_position(const IvVector3& sphere_center, double sphere_radius, const IvVector3& viewer,
+	void get_map_lon_lat_form_viewer_position(const IvDoubleVector3& sphere_center, double sphere_radius, const IvDoubleVector3& viewer,
 		double& lon, double& lat, IvDoubleVector3& hit_point)
 	{
 		auto ray_direction = sphere_center - viewer;
@@ -183,14 +206,14 @@ namespace cali
 	{
 		renderer.SetBlendFunc(kOneBlendFunc, kZeroBlendFunc, kAddBlendOp);
 
-		auto planet_center_relative_to_viewer = m_planet_center - m_viewer_position;
-		auto height = abs(planet_center_relative_to_viewer.Length() - m_planet_radius);
+		const IvDoubleVector3 planet_center_relative_to_viewer = m_planet_center - m_viewer_position;
+		const double height = abs(planet_center_relative_to_viewer.Length() - m_planet_radius);
 
 		auto level_desc = get_level_from_distance((double)height, m_qtrees[0].width(), c_detail_levels);
 		auto& info = debug_info::get_debug_info();
 		info.set_debug_string(L"lod_level", (float)level_desc.level);
 
-		m_shader->GetUniform("planet_center")->SetValue(planet_center_relative_to_viewer, 0);
+		m_shader->GetUniform("planet_center")->SetValue(Math::relative_to_eye(m_planet_center, m_viewer_position), 0);
 		m_shader->GetUniform("planet_radius")->SetValue((float)m_planet_radius, 0);
 
 		// global hit point for debug box
@@ -201,8 +224,11 @@ namespace cali
 		m_box.render(renderer);
 
 		m_nodes_rendered_per_frame = 0;
+		m_patches.clear();
+		m_patch_corners.clear();
+		m_patch_boxes.clear();
 
-		// Render all 6 cube faces
+		// Collect the visible nodes of all 6 cube faces
 		for (int face = 0; face < c_face_count; ++face)
 		{
 			auto& qtree = m_qtrees[face];
@@ -243,10 +269,30 @@ namespace cali
 			double cull_radius = height < 1000.0f ? m_planet_radius / 4 : height * 32;
 			circle cull{ { map_x, map_y }, cull_radius };
 
-			RenderContext render_context{ renderer, frustum, face };
-			qtree.visit(cull, *this, &terrain_quad::render_node, &render_context);
+			RenderContext render_context{ face };
+			qtree.visit(cull, *this, &terrain_quad::collect_node, &render_context);
 		}
 
+		// the patches outside the frustum go, all tested at once
+		m_patch_containment.resize(m_patches.size());
+		frustum.classify_oriented_boxes(m_patch_boxes, m_patch_containment.data());
+		size_t visible = 0;
+		for (size_t i = 0; i < m_patches.size(); ++i)
+		{
+			if (m_patch_containment[i] == containment::outside) continue;
+			m_patches[visible] = m_patches[i];
+			std::copy_n(&m_patch_corners[4 * i], 4, &m_patch_corners[4 * visible]);
+			++visible;
+		}
+		m_patches.erase(m_patches.begin() + visible, m_patches.end());
+		m_patch_corners.resize(4 * visible);
+
+		// every corner relative to the viewer at once, subtracted in double
+		m_patch_offsets.resize(m_patch_corners.size());
+		Math::relative_to_eye_batch(m_patch_corners.data(), m_patch_corners.size(), m_viewer_position, m_patch_offsets.data());
+		for (size_t i = 0; i < m_patches.size(); ++i)
+			render_patch(renderer, m_patches[i], &m_patch_offsets[4 * i]);
+
 		info.set_debug_string(L"rendered_nodes", (float)m_nodes_rendered_per_frame);
 	}
 
@@ -284,7 +330,7 @@ namespace cali
 		quad_center_on_sphere = Math::adjusted_cube_to_sphere_face(cf, quad.center.x, quad.center.y, m_planet_radius, m_planet_center, normal);
 	}
 
-	void terrain_quad::render_node(const terrain_quad_tree::Node& node, void* render_context_ptr)
+	void terrain_quad::collect_node(const terrain_quad_tree::Node& node, void* render_context_ptr)
 	{
 		assert(render_context_ptr != nullptr);
 		const RenderContext& render_context = *reinterpret_cast<RenderContext*>(render_context_ptr);
@@ -295,34 +341,43 @@ namespace cali
 		IvDoubleVector3 A, B, C, D, quad_center_lerped, quad_center_on_sphere;
 		calculate_sphere_surface_quad(render_context.face, quad, A, B, C, D, quad_center_lerped, quad_center_on_sphere, overlapping_area);
 
-		AABB aabb;
-		aabb.set_points(&A, &B, &C, &D, &quad_center_lerped, &quad_center_on_sphere);
-		auto aabb_center = aabb.get_center();
-		auto aabb_extents = aabb.get_extents();
-
-		if (!render_context.frustum.contains_aligned_bounding_box(
-			(float)aabb_center.x, (float)aabb_center.y, (float)aabb_center.z,
-			(float)aabb_extents.x, (float)aabb_extents.y, (float)aabb_extents.z))
+		// the box of the patch as drawn, overlap included
+		const patch_key key{ render_context.face, quad.center.x, quad.center.y, quad.half_size.x, quad.half_size.y };
+		auto cached = m_patch_bounds.find(key);
+		if (cached == m_patch_bounds.end())
 		{
-			return;
+			if (m_patch_bounds.size() >= c_patch_bounds_cached) m_patch_bounds.clear();
+			const double half_x = quad.half_size.x + overlapping_area, half_y = quad.half_size.y + overlapping_area;
+			cached = m_patch_bounds.emplace(key, fit_patch_bounds(static_cast<Math::CubeFace>(render_context.face),
+				quad.center.x - half_x, quad.center.y - half_y, quad.center.x + half_x, quad.center.y + half_y,
+				m_planet_radius, m_planet_center)).first;
 		}
+		const patch_bounds& bounds = cached->second;
+
+		m_patches.push_back({ quad, quad_center_on_sphere, overlapping_area, render_context.face, (int)node.get_depth() });
+		m_patch_corners.insert(m_patch_corners.end(), { A, B, C, D });
+		m_patch_boxes.push_back(bounds.center, bounds.rotation, bounds.extents);
+	}
+
+	void terrain_quad::render_patch(IvRenderer& renderer, const patch& patch, const IvVector3* corner_offsets)
+	{
+		const quad& quad = patch.centred_quad;
 
-		m_shader->GetUniform("quad_a")->SetValue((IvVector3)A - m_viewer_position, 0);
-		m_shader->GetUniform("quad_b")->SetValue((IvVector3)B - m_viewer_position, 0);
-		m_shader->GetUniform("quad_c")->SetValue((IvVector3)C - m_viewer_position, 0);
-		m_shader->GetUniform("quad_d")->SetValue((IvVector3)D - m_viewer_position, 0);
+		m_shader->GetUniform("quad_a")->SetValue(corner_offsets[0], 0);
+		m_shader->GetUniform("quad_b")->SetValue(corner_offsets[1], 0);
+		m_shader->GetUniform("quad_c")->SetValue(corner_offsets[2], 0);
+		m_shader->GetUniform("quad_d")->SetValue(corner_offsets[3], 0);
 		m_shader->GetUniform("quad_center")->SetValue(IvVector3{ (float)quad.center.x, (float)quad.center.y, 0.0f}, 0);
-		m_shader->GetUniform("cube_face")->SetValue((float)render_context.face, 0);
+		m_shader->GetUniform("cube_face")->SetValue((float)patch.face, 0);
 
-		m_grid.set_position(quad_center_on_sphere);
+		m_grid.set_position(patch.center_on_sphere);
 		m_grid.set_direction({ 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f, 0.0f });
 		m_shader->GetUniform("rotation_matrix")->SetValue(m_grid.get_rotation(), 0);
 
 		m_shader->GetUniform("gird_cells")->SetValue((float)m_grid.cols(), 0);
-		m_shader->GetUniform("quad_size")->SetValue(IvVector3{ (float)(quad.width() + overlapping_area), (float)(quad.width() + overlapping_area), 0.0f }, 0);
-		m_shader->GetUniform("quad_scale_factor")->SetValue(20.0f, 0);
+		m_shader->GetUniform("quad_size")->SetValue(IvVector3{ (float)(quad.width() + patch.overlapping_area), (float)(quad.width() + patch.overlapping_area), 0.0f }, 0);
 
-		auto detail_level = node.get_depth() - 1;
+		auto detail_level = patch.depth - 1;
 		if (detail_level > 6)
 		{
 			m_shader->GetUniform("curvature")->SetValue((float)0.0f, 0);
@@ -332,12 +387,12 @@ namespace cali
 			m_shader->GetUniform("curvature")->SetValue((float)1.0f, 0);
 		}
 
-		m_grid.render(render_context.renderer, m_shader);
+		m_grid.render(renderer, m_shader);
 
 		++m_nodes_rendered_per_frame;
 	}
 
-	void terrain_quad::set_viewer(const IvVector3 & camera_position)
+	void terrain_quad::set_viewer(const IvDoubleVector3 & camera_position)
 	{
 		m_viewer_position = camera_position;
 	}
@@ -16,6 +16,7 @@
 #include <IvRenderer.h>
 
 #include <memory>
+#include <unordered_map>
 
 #include "Renderable.h"
 #include "Model.h"
@@ -23,7 +24,9 @@
 #include "TerrainQuadTree.h"
 #include "Box.h"
 #include "Frustum.h"
+#include "PatchBounds.h"
 #include "Bruneton.h"
+#include "ProceduralProgressive.h"
 
 //-------------------------------------------------------------------------------
 //-- Classes --------------------------------------------------------------------
@@ -38,13 +41,13 @@ namespace cali
 		Box m_box;
 		grid m_grid;
 		bruneton& m_bruneton;
-		IvVector3 m_viewer_position;
+		IvDoubleVector3 m_viewer_position;
 		const float m_overlapping_edge_cells;
 		const IvDoubleVector3 m_planet_center;
 		const double m_planet_radius;
 
 		IvShaderProgram* m_shader;
-		IvTexture* m_height_map_texture;
+		std::unique_ptr<proc::progressive_heightmap_texture> m_height_map;
 
 		size_t m_nodes_rendered_per_frame;
 
@@ -55,11 +58,52 @@ namespace cali
 
 		struct RenderContext
 		{
-			IvRenderer& renderer;
-			const frustum& frustum;
 			int face;
 		};
 
+		// A node of this frame's level of detail; its corners are in m_patch_corners
+		// and its oriented bounding box in m_patch_boxes
+		struct patch
+		{
+			quad centred_quad;
+			IvDoubleVector3 center_on_sphere;
+			double overlapping_area;
+			int face;
+			int depth;
+		};
+
+		// Collected by collect_node(), culled against the frustum in one batch,
+		// then the corners relative to the viewer in one conversion
+		// (RelativeToEye.h) and drawn by render_patch()
+		std::vector<patch> m_patches;
+		std::vector<IvDoubleVector3> m_patch_corners;
+		oriented_box_array<double> m_patch_boxes;
+		std::vector<containment> m_patch_containment;
+		std::vector<IvVector3> m_patch_offsets;
+
+		// The nodes are made again every frame, their boxes fitted once
+		// (PatchBounds.h): by face and quad, forgotten all at once when
+		// there are more than c_patch_bounds_cached
+		struct patch_key
+		{
+			int face;
+			double x, y, half_x, half_y;
+			bool operator==(const patch_key& other) const
+			{
+				return face == other.face && x == other.x && y == other.y && half_x == other.half_x && half_y == other.half_y;
+			}
+		};
+		struct patch_key_hash
+		{
+			size_t operator()(const patch_key& key) const
+			{
+				const std::hash<double> h;
+				return (((h(key.x) * 31 + h(key.y)) * 31 + h(key.half_x)) * 31 + h(key.half_y)) * 31 + (size_t)key.face;
+			}
+		};
+		static const size_t c_patch_bounds_cached = 1 << 16;
+		std::unordered_map<patch_key, patch_bounds, patch_key_hash> m_patch_bounds;
+
 		void calculate_sphere_surface_quad(
 			int face,
 			const quad & quad,
@@ -74,7 +118,8 @@ namespace cali
 		void calculate_displacement_data(const cali::quad & quad, int level, void* quad_data_texture);
 		void calculate_displacement_data_for_detail_levels();
 
-		void render_node(const struct terrain_quad_tree::Node& node, void* render_context);
+		void collect_node(const struct terrain_quad_tree::Node& node, void* render_context);
+		void render_patch(IvRenderer& renderer, const patch& patch, const IvVector3* corner_offsets);
 
 	public:
 		// renderable
@@ -83,7 +128,11 @@ namespace cali
 
 		// compound_renderable
 		virtual void render(IvRenderer & renderer, const frustum& frustum) override;
-		void set_viewer(const IvVector3 & camera_position);
+		void set_viewer(const IvDoubleVector3 & camera_position);
+		// the froxel volume of aerial_perspective_volume, per pixel lookups without it
+		void set_aerial_perspective(IvTexture* in_scattering, IvTexture* transmittance);
+
+		const proc::progressive_heightmap_texture& height_map() const { return *m_height_map; }
 
 		terrain_quad(bruneton& bruneton);
 		~terrain_quad();
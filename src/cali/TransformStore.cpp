@@ -0,0 +1,224 @@
+#include "TransformStore.h"
+#include "CaliThreads.h"
+
+#include <IvLanes.h>
+#include <IvMath.h>
+#include <IvMatrix33.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+namespace cali
+{
+	namespace
+	{
+		typedef IvFloat8 lanes;
+		const size_t c_width = lanes::Width;
+		// transforms per unit of work; stores below two of them update on the calling thread
+		const size_t c_chunk = 4096;
+
+		// The 3x3 part of T * R * S, IvMatrix33::Rotation(IvQuat) with its
+		// columns scaled, and the translation; one lane or one value per transform
+		template <typename T>
+		struct local_matrix
+		{
+			T m[12]; // column-major 3x4
+
+			local_matrix(const T& qw, const T& qx, const T& qy, const T& qz, const T& sx, const T& sy, const T& sz,
+				const T& px, const T& py, const T& pz)
+			{
+				const T one(1.0f);
+				const T xs = qx + qx, ys = qy + qy, zs = qz + qz;
+				const T wx = qw * xs, wy = qw * ys, wz = qw * zs;
+				const T xx = qx * xs, xy = qx * ys, xz = qx * zs;
+				const T yy = qy * ys, yz = qy * zs, zz = qz * zs;
+
+				m[0] = (one - (yy + zz)) * sx;
+				m[1] = (xy + wz) * sx;
+				m[2] = (xz - wy) * sx;
+				m[3] = (xy - wz) * sy;
+				m[4] = (one - (xx + zz)) * sy;
+				m[5] = (yz + wx) * sy;
+				m[6] = (xz + wy) * sz;
+				m[7] = (yz - wx) * sz;
+				m[8] = (one - (xx + yy)) * sz;
+				m[9] = px;
+				m[10] = py;
+				m[11] = pz;
+			}
+		};
+
+		void store_matrix(IvMatrix44& out, const float (&m)[12])
+		{
+			for (unsigned int column = 0; column < 4; ++column)
+			{
+				out(0, column) = m[3 * column + 0];
+				out(1, column) = m[3 * column + 1];
+				out(2, column) = m[3 * column + 2];
+				out(3, column) = column == 3 ? 1.0f : 0.0f;
+			}
+		}
+	}
+
+	transform_store::transform_store(int threads) :
+		m_any_dirty(false),
+		m_threads(threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency()))
+	{
+	}
+
+	transform_store::handle transform_store::create(handle parent)
+	{
+		const handle h = (handle)size();
+		if (parent != no_parent && parent >= h) throw std::invalid_argument("transform_store::create: no such parent");
+
+		m_position_x.push_back(0.0f); m_position_y.push_back(0.0f); m_position_z.push_back(0.0f);
+		m_rotation_w.push_back(1.0f); m_rotation_x.push_back(0.0f); m_rotation_y.push_back(0.0f); m_rotation_z.push_back(0.0f);
+		m_scale_x.push_back(1.0f); m_scale_y.push_back(1.0f); m_scale_z.push_back(1.0f);
+		m_parent.push_back(parent);
+		m_dirty.push_back(0);
+		m_world.emplace_back();
+		if (parent != no_parent) m_children.push_back(h);
+
+		mark_dirty(h);
+		return h;
+	}
+
+	void transform_store::reserve(size_t count)
+	{
+		for (std::vector<float>* component : { &m_position_x, &m_position_y, &m_position_z, &m_rotation_w, &m_rotation_x,
+			&m_rotation_y, &m_rotation_z, &m_scale_x, &m_scale_y, &m_scale_z })
+			component->reserve(count);
+		m_parent.reserve(count);
+		m_dirty.reserve(count);
+		m_world.reserve(count);
+	}
+
+	void transform_store::clear()
+	{
+		for (std::vector<float>* component : { &m_position_x, &m_position_y, &m_position_z, &m_rotation_w, &m_rotation_x,
+			&m_rotation_y, &m_rotation_z, &m_scale_x, &m_scale_y, &m_scale_z })
+			component->clear();
+		m_parent.clear();
+		m_dirty.clear();
+		m_world.clear();
+		m_children.clear();
+		m_any_dirty = false;
+	}
+
+	void transform_store::set_position(handle h, const IvVector3& position)
+	{
+		m_position_x[h] = position.x;
+		m_position_y[h] = position.y;
+		m_position_z[h] = position.z;
+		mark_dirty(h);
+	}
+
+	void transform_store::set_rotation(handle h, const IvQuat& rotation)
+	{
+		rotation.Get(m_rotation_w[h], m_rotation_x[h], m_rotation_y[h], m_rotation_z[h]);
+		mark_dirty(h);
+	}
+
+	void transform_store::set_scale(handle h, const IvVector3& scale)
+	{
+		m_scale_x[h] = scale.x;
+		m_scale_y[h] = scale.y;
+		m_scale_z[h] = scale.z;
+		mark_dirty(h);
+	}
+
+	void transform_store::set_direction(handle h, const IvVector3& dir, const IvVector3& up)
+	{
+		IvVector3 direction = dir;
+
+		// as physical::set_direction()
+		if (direction == up)
+		{
+			direction.x += kEpsilon * 1000.f;
+			direction.y += kEpsilon * 1000.f;
+			direction.z += kEpsilon * 1000.f;
+			direction.Normalize();
+		}
+
+		IvVector3 right = up.Cross(direction);
+		direction.Normalize();
+		right.Normalize();
+		IvVector3 y = direction.Cross(right);
+		y.Normalize();
+
+		IvMatrix33 basis;
+		basis.SetColumns(right, y, direction);
+		IvQuat rotation(basis);
+		rotation.Normalize();
+		set_rotation(h, rotation);
+	}
+
+	void transform_store::look_at(handle h, const IvVector3& point, const IvVector3& up)
+	{
+		set_direction(h, point - get_position(h), up);
+	}
+
+	void transform_store::compute_local(size_t begin, size_t end)
+	{
+		size_t i = begin;
+		for (; i + c_width <= end; i += c_width)
+		{
+			uint64_t any = 0;
+			for (size_t k = 0; k < c_width; ++k) any |= m_dirty[i + k];
+			if (!any) continue;
+
+			const local_matrix<lanes> batch(lanes::Load(&m_rotation_w[i]), lanes::Load(&m_rotation_x[i]),
+				lanes::Load(&m_rotation_y[i]), lanes::Load(&m_rotation_z[i]), lanes::Load(&m_scale_x[i]),
+				lanes::Load(&m_scale_y[i]), lanes::Load(&m_scale_z[i]), lanes::Load(&m_position_x[i]),
+				lanes::Load(&m_position_y[i]), lanes::Load(&m_position_z[i]));
+
+			float values[12][c_width];
+			for (int e = 0; e < 12; ++e) batch.m[e].Store(values[e]);
+			for (size_t k = 0; k < c_width; ++k)
+			{
+				if (!m_dirty[i + k]) continue;
+				float m[12];
+				for (int e = 0; e < 12; ++e) m[e] = values[e][k];
+				store_matrix(m_world[i + k], m);
+			}
+		}
+
+		for (; i < end; ++i)
+		{
+			if (!m_dirty[i]) continue;
+			const local_matrix<float> single(m_rotation_w[i], m_rotation_x[i], m_rotation_y[i], m_rotation_z[i],
+				m_scale_x[i], m_scale_y[i], m_scale_z[i], m_position_x[i], m_position_y[i], m_position_z[i]);
+			store_matrix(m_world[i], single.m);
+		}
+	}
+
+	size_t transform_store::update()
+	{
+		if (!m_any_dirty) return 0;
+
+		// a dirty parent makes its children dirty; parents come first
+		for (handle child : m_children)
+			if (m_dirty[m_parent[child]]) m_dirty[child] = 1;
+
+		// every dirty transform gets its local matrix
+		const size_t count = size();
+		const int chunks = (int)((count + c_chunk - 1) / c_chunk);
+		if (chunks < 2 || m_threads == 1)
+			compute_local(0, count);
+		else
+			parallel_for(chunks, m_threads, [&](int chunk)
+			{
+				compute_local(chunk * c_chunk, std::min(count, (chunk + 1) * c_chunk));
+			});
+
+		// then the children, in order, their parent's world matrix
+		for (handle child : m_children)
+			if (m_dirty[child]) m_world[child] = m_world[m_parent[child]] * m_world[child];
+
+		const size_t updated = (size_t)std::count(m_dirty.begin(), m_dirty.end(), (uint8_t)1);
+		std::fill(m_dirty.begin(), m_dirty.end(), (uint8_t)0);
+		m_any_dirty = false;
+		return updated;
+	}
+}
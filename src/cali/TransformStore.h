@@ -0,0 +1,81 @@
+#pragma once
+#include <IvMatrix44.h>
+#include <IvQuat.h>
+#include <IvVector3.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cali
+{
+	// -----------------------------------------------------------------
+	// Position, rotation and scale of many objects, kept as in
+	// IvHierarchy: arrays of each component (structure of arrays) and a
+	// parent index that is always lower than the child's. Setters only
+	// store the value and mark the transform dirty; update() then
+	// recomputes the world matrices of the dirty transforms and their
+	// descendants in one pass, eight at a time in IvFloat8 lanes and on
+	// several threads for large stores.
+	//
+	// The world matrix is parent's world * T * R * S, with the columns
+	// of R those of physical: right (+x), up (+y) and direction (+z).
+	// A transform's matrix does not depend on the lanes or the thread
+	// count that computed it.
+	// -----------------------------------------------------------------
+	class transform_store
+	{
+	public:
+		using handle = uint32_t;
+		static const handle no_parent = ~(handle)0;
+
+		// threads = 0: hardware concurrency.
+		explicit transform_store(int threads = 0);
+
+		// The identity transform; throws std::invalid_argument for a parent
+		// that does not exist yet.
+		handle create(handle parent = no_parent);
+		void reserve(size_t count);
+		void clear();
+		size_t size() const { return m_parent.size(); }
+
+		void set_position(handle h, const IvVector3& position);
+		void set_rotation(handle h, const IvQuat& rotation);
+		void set_scale(handle h, const IvVector3& scale);
+		void set_scale(handle h, float scale) { set_scale(h, { scale, scale, scale }); }
+		// physical::set_direction(): +z along direction, +x along up x direction
+		void set_direction(handle h, const IvVector3& direction, const IvVector3& up);
+		void look_at(handle h, const IvVector3& point, const IvVector3& up);
+
+		IvVector3 get_position(handle h) const { return { m_position_x[h], m_position_y[h], m_position_z[h] }; }
+		IvQuat get_rotation(handle h) const { return IvQuat(m_rotation_w[h], m_rotation_x[h], m_rotation_y[h], m_rotation_z[h]); }
+		IvVector3 get_scale(handle h) const { return { m_scale_x[h], m_scale_y[h], m_scale_z[h] }; }
+		handle get_parent(handle h) const { return m_parent[h]; }
+		bool is_dirty(handle h) const { return m_dirty[h] != 0; }
+
+		// Recomputes the changed world matrices, returns how many.
+		size_t update();
+
+		// As of the last update()
+		const IvMatrix44& get_world_matrix(handle h) const { return m_world[h]; }
+		const IvMatrix44* world_matrices() const { return m_world.data(); }
+
+		int threads() const { return m_threads; }
+
+	private:
+		void mark_dirty(handle h) { m_dirty[h] = 1; m_any_dirty = true; }
+		void compute_local(size_t begin, size_t end);
+
+		std::vector<float> m_position_x, m_position_y, m_position_z;
+		std::vector<float> m_rotation_w, m_rotation_x, m_rotation_y, m_rotation_z;
+		std::vector<float> m_scale_x, m_scale_y, m_scale_z;
+		std::vector<handle> m_parent;
+		std::vector<uint8_t> m_dirty;
+		std::vector<IvMatrix44> m_world;
+
+		// transforms with a parent, in increasing order
+		std::vector<handle> m_children;
+		bool m_any_dirty;
+		int m_threads;
+	};
+}
@@ -3,7 +3,6 @@
 #include <IvVector4.h>
 
 #include <limits>
-#include <string>
 
 #undef max
 
@@ -11,36 +10,40 @@ namespace cali
 {
 	namespace world
 	{
-		static const float c_camera_far = std::numeric_limits<float>::max() / 100000000000.f;
-		static const float c_earth_radius = 63600.0f;
-		static const IvVector3 c_earth_center = { 0.0, -c_earth_radius, 0.0 };
+		inline constexpr float c_camera_far = std::numeric_limits<float>::max() / 100000000000.f;
+		inline constexpr float c_earth_radius = 63600.0f;
+		inline constexpr IvVector3 c_earth_center = { 0.0, -c_earth_radius, 0.0 };
 
-		static float c_horizon_distance = 100000000000000.f;
+		inline constexpr float c_horizon_distance = 100000000000000.f;
 
-		static const IvVector3 c_sky_box_size = 
+		inline constexpr IvVector3 c_sky_box_size = 
 		{
             c_earth_radius * 4,
             c_earth_radius * 4,
             c_earth_radius * 4
 		};
 
-        static const IvVector3 c_star_box_size =
+        inline constexpr IvVector3 c_star_box_size =
         {
             c_camera_far,
             c_camera_far,
             c_camera_far
         };
 
-        static const float c_star_distance = world::c_earth_radius * 100.f;
-        static const float c_star_visible_size_min = 4000.f;
-        static const float c_star_visible_size_max = 7000.f;
+        inline constexpr float c_star_distance = world::c_earth_radius * 100.f;
+        inline constexpr float c_star_visible_size_min = 4000.f;
+        inline constexpr float c_star_visible_size_max = 7000.f;
 
 
-		static const IvVector4 sun_zenith_color = { 1.f, 1.f, 1.f, 1.f };
-		static const IvVector4 sun_sunset_color = { 252.f / 255.f, 108.f / 255.f, 45.f / 255.f, 1.f };
+		inline constexpr IvVector4 sun_zenith_color = { 1.f, 1.f, 1.f, 1.f };
+		inline constexpr IvVector4 sun_sunset_color = { 252.f / 255.f, 108.f / 255.f, 45.f / 255.f, 1.f };
 
 		// Procedural planet seed: same hash => same terrain (stable generation)
-		static const inline std::string c_planet_hash = "cali_planet_v1";
-		static const int c_heightmap_size = 1024;
+		inline constexpr char c_planet_hash[] = "cali_planet_v1";
+		inline constexpr int c_heightmap_size = 1024;
+		// cube-sphere faces: 6 * 416^2 texels ~= the 1024^2 texels of the tileable map
+		inline constexpr int c_heightmap_face_size = 416;
+		// first progressive level: 6 * 52^2 texels ~= 128^2, refined 104 -> 208 -> 416
+		inline constexpr int c_heightmap_preview_face_size = 52;
 	}
 }
@@ -2,6 +2,9 @@
 #pragma once
 #endif
 
+#ifdef __cplusplus
+// Default LUT sizes (atmosphere::lut_tier::high). bruneton creates the LUTs
+// with any atmosphere::lut_sizes at runtime.
 static const int TRANSMITTANCE_TEXTURE_WIDTH = 256;
 static const int TRANSMITTANCE_TEXTURE_HEIGHT = 64;
 static const int SCATTERING_TEXTURE_R_SIZE = 32;
@@ -9,4 +12,27 @@ static const int SCATTERING_TEXTURE_MU_SIZE = 128;
 static const int SCATTERING_TEXTURE_MU_S_SIZE = 32;
 static const int SCATTERING_TEXTURE_NU_SIZE = 8;
 static const int IRRADIANCE_TEXTURE_WIDTH = 64;
-static const int IRRADIANCE_TEXTURE_HEIGHT = 16;
\ No newline at end of file
+static const int IRRADIANCE_TEXTURE_HEIGHT = 16;
+#else
+// The sizes the LUTs were created with, set by bruneton
+// (constant_buffer::AtmosphereLutSizes).
+cbuffer AtmosphereLutSizes : register(b3)
+{
+    int4 lut_transmittance_irradiance_size; // transmittance width, height, irradiance width, height
+    int4 lut_scattering_size;               // r, mu, mu_s, nu
+}
+#define TRANSMITTANCE_TEXTURE_WIDTH lut_transmittance_irradiance_size.x
+#define TRANSMITTANCE_TEXTURE_HEIGHT lut_transmittance_irradiance_size.y
+#define IRRADIANCE_TEXTURE_WIDTH lut_transmittance_irradiance_size.z
+#define IRRADIANCE_TEXTURE_HEIGHT lut_transmittance_irradiance_size.w
+#define SCATTERING_TEXTURE_R_SIZE lut_scattering_size.x
+#define SCATTERING_TEXTURE_MU_SIZE lut_scattering_size.y
+#define SCATTERING_TEXTURE_MU_S_SIZE lut_scattering_size.z
+#define SCATTERING_TEXTURE_NU_SIZE lut_scattering_size.w
+#endif
+
+// 1: the final scattering texture is stored as RGB9E5 (rayleigh + multiple)
+// with the single mie red channel in a separate R16F texture, 6 instead of 8
+// bytes a texel. The texels come from the CPU (Atmosphere.cpp) or are read
+// back from the GPU precompute.
+#define ATMOSPHERE_COMPACT_SCATTERING 0
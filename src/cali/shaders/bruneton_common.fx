@@ -128,27 +128,18 @@ static const Luminance kcd_per_square_meter = kcd / m2;
 
 #include "BrunetonCommonDefs.h"
 
-static const float2 IRRADIANCE_TEXTURE_SIZE =
-    float2(IRRADIANCE_TEXTURE_WIDTH, IRRADIANCE_TEXTURE_HEIGHT);
+#define IRRADIANCE_TEXTURE_SIZE \
+    float2(IRRADIANCE_TEXTURE_WIDTH, IRRADIANCE_TEXTURE_HEIGHT)
 
 static const float3 SKY_SPECTRAL_RADIANCE_TO_LUMINANCE = float3(114974.916437, 71305.954816, 65310.548555);
 static const float3 SUN_SPECTRAL_RADIANCE_TO_LUMINANCE = float3(98242.786222, 69954.398112, 66475.012354);
 
-static const AtmosphereParameters ATMOSPHERE =
+// The parameters the LUTs in the textures were computed for, set by bruneton
+// (constant_buffer::Atmosphere); earth_atmosphere() until recompute().
+cbuffer Atmosphere : register(b5)
 {
-    float3(1.474000, 1.850400, 1.911980), // solar_irradiance
-    0.004675, // sun_angular_radius
-    6360.000000, // bottom_radius
-    6600.000000, // top_radius
-    8.000000, // rayleigh_scale_height
-    float3(0.005802, 0.013558, 0.033100), // rayleigh_scattering
-    1.200000, // mie_scale_height
-    float3(0.003996, 0.003996, 0.003996), // mie_scattering
-    float3(0.004440, 0.004440, 0.004440), // mie_extinction
-    0.800000, // mie_phase_function_g
-    float3(0.100000, 0.100000, 0.100000), // ground_albedo
-    -0.207912 // mu_s_min
-};
+    AtmosphereParameters ATMOSPHERE;
+}
 
 Number GetUnitRangeFromTextureCoord(Number u, int texture_size)
 {
@@ -509,9 +500,18 @@ IrradianceSpectrum GetCombinedScattering(
     float3 uvw1 = float3((tex_x + 1.0 + uvwz.y) / Number(SCATTERING_TEXTURE_NU_SIZE), uvwz.z, uvwz.w);
 
 #ifdef COMBINED_SCATTERING_TEXTURES
+#if ATMOSPHERE_COMPACT_SCATTERING
+    // RGB9E5 has no alpha: the single mie red channel is in its own texture
+    float4 combined_scattering = float4(
+        scattering_texture.Sample(scattering_textureSampler, uvw0).rgb * (1.0 - lerp) +
+        scattering_texture.Sample(scattering_textureSampler, uvw1).rgb * lerp,
+        single_mie_scattering_texture.Sample(ssingle_mie_scattering_textureSampler, uvw0).r * (1.0 - lerp) +
+        single_mie_scattering_texture.Sample(ssingle_mie_scattering_textureSampler, uvw1).r * lerp);
+#else
     float4 combined_scattering =
         scattering_texture.Sample(scattering_textureSampler, uvw0) * (1.0 - lerp) +
         scattering_texture.Sample(scattering_textureSampler, uvw1) * lerp;
+#endif
     IrradianceSpectrum scattering = IrradianceSpectrum(combined_scattering.rgb);
     single_mie_scattering = GetExtrapolatedSingleMieScattering(atmosphere, combined_scattering);
 #else
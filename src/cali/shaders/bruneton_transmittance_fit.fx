@@ -0,0 +1,73 @@
+// Generated by cali_fit_transmittance from earth_atmosphere(), do not edit.
+// Analytic transmittance to the top of the atmosphere (AtmosphereFit.h), for
+// where the transmittance texture is not bound; include after bruneton_common.fx.
+// Transmittance error: max 4.74e-03, mean 3.86e-04.
+
+#define TRANSMITTANCE_FIT_ORDER 7
+
+static const float TRANSMITTANCE_FIT[2][49] =
+{
+    {
+        -1.9825362, 2.88822913, 3.34288836, 2.29874253, 0.317038894, -0.602208376, -0.206969276,
+        2.41440582, 5.95814323, 8.22207451, 1.98779929, -4.30039644, -0.958848953, 1.46826899,
+        2.59843969, 7.14416265, 6.05798769, -6.71477222, -8.37330723, 2.95369673, 3.9090445,
+        2.44165039, 3.04880977, -7.87243795, -6.2565918, 8.32682037, 3.46915698, -3.21280861,
+        1.3763119, -2.67860842, -11.1176796, 6.09218407, 17.480587, -3.19519377, -8.38583565,
+        -0.182968497, -2.41130114, 3.49284172, 4.26912785, -4.17946959, -2.44361973, 1.7205838,
+        -0.392344207, -0.135204911, 5.98077631, -1.59187019, -9.58224773, 0.981021285, 4.70721865
+    },
+    {
+        -3.54536462, 7.96653271, 24.7102509, 29.9028835, 3.1205399, -11.3769646, -2.74226737,
+        5.30514288, 42.8367577, 102.921532, 16.799284, -102.309158, -10.067564, 45.3878174,
+        15.815547, 82.3345947, 72.9513474, -138.026718, -136.246414, 80.8300247, 73.9981689,
+        25.9952278, 32.0443878, -165.326935, -81.6722488, 273.128693, 51.149704, -137.371964,
+        14.2974062, -46.5629616, -171.031418, 158.284393, 343.863068, -111.218597, -191.737122,
+        -5.20464897, -26.3896999, 87.6012344, 66.3491287, -171.400284, -42.2630768, 92.4355621,
+        -5.41474819, 5.59470987, 99.3144913, -49.440155, -211.540207, 41.7717896, 121.372276
+    }
+};
+
+// log of the mean density along the ray relative to its start, layer 0 rayleigh, 1 mie
+Number TransmittanceFitPolynomial(int layer, Number s, Number t)
+{
+    Number result = 0.0;
+    [unroll]
+    for (int j = TRANSMITTANCE_FIT_ORDER - 1; j >= 0; --j)
+    {
+        Number p = TRANSMITTANCE_FIT[layer][j * TRANSMITTANCE_FIT_ORDER + TRANSMITTANCE_FIT_ORDER - 1];
+        [unroll]
+        for (int i = TRANSMITTANCE_FIT_ORDER - 2; i >= 0; --i)
+            p = p * s + TRANSMITTANCE_FIT[layer][j * TRANSMITTANCE_FIT_ORDER + i];
+        result = result * t + p;
+    }
+    return result;
+}
+
+DimensionlessSpectrum GetFittedTransmittanceToTopAtmosphereBoundary(
+    in AtmosphereParameters atmosphere, Length r, Number mu)
+{
+    r = ClampRadius(atmosphere, r);
+    Length H = sqrt(atmosphere.top_radius * atmosphere.top_radius -
+        atmosphere.bottom_radius * atmosphere.bottom_radius);
+    Length rho = SafeSqrt(r * r - atmosphere.bottom_radius * atmosphere.bottom_radius);
+    Length d_min = atmosphere.top_radius - r;
+    Length d_max = rho + H;
+    Length d = clamp(DistanceToTopAtmosphereBoundary(atmosphere, r, mu), d_min, d_max);
+    Number s = 2.0 * (d_max > d_min ? (d - d_min) / (d_max - d_min) : 0.0) - 1.0;
+    Number t = 2.0 * rho / H - 1.0;
+    Length h = r - atmosphere.bottom_radius;
+    Length rayleigh = d * exp(TransmittanceFitPolynomial(0, s, t) - h / atmosphere.rayleigh_scale_height);
+    Length mie = d * exp(TransmittanceFitPolynomial(1, s, t) - h / atmosphere.mie_scale_height);
+    return exp(-(atmosphere.rayleigh_scattering * rayleigh + atmosphere.mie_extinction * mie));
+}
+
+DimensionlessSpectrum GetFittedTransmittanceToSun(
+    in AtmosphereParameters atmosphere, Length r, Number mu_s)
+{
+    Number sin_theta_h = atmosphere.bottom_radius / r;
+    Number cos_theta_h = -sqrt(max(1.0 - sin_theta_h * sin_theta_h, 0.0));
+    return GetFittedTransmittanceToTopAtmosphereBoundary(atmosphere, r, mu_s) *
+        smoothstep(-sin_theta_h * atmosphere.sun_angular_radius / rad,
+            sin_theta_h * atmosphere.sun_angular_radius / rad,
+            mu_s - cos_theta_h);
+}
@@ -42,7 +42,41 @@ cbuffer SunLight : register(b1)
     float3 sun_intensity;
     float3 sun_attenuation;
     float4 sun_color;
+    float4 sky_sh[9];
 }
+// Sky irradiance on a surface facing `n`, from the L2 SH of AtmosphereAmbient.h
+// (basis order (0,0), (1,-1), (1,0), (1,1), (2,-2) ... (2,2); y, z, x for l = 1)
+bool has_sky_sh()
+{
+    return sky_sh[0].w > 0.0;
+}
+
+float3 sky_sh_irradiance(float3 n)
+{
+    return max(
+        sky_sh[0].rgb * 0.282095 +
+        sky_sh[1].rgb * (0.488603 * n.y) +
+        sky_sh[2].rgb * (0.488603 * n.z) +
+        sky_sh[3].rgb * (0.488603 * n.x) +
+        sky_sh[4].rgb * (1.092548 * n.x * n.y) +
+        sky_sh[5].rgb * (1.092548 * n.y * n.z) +
+        sky_sh[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0)) +
+        sky_sh[7].rgb * (1.092548 * n.x * n.z) +
+        sky_sh[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y)),
+        float3(0.0, 0.0, 0.0));
+}
+
+// The camera of the aerial perspective froxel volume (AerialPerspective.h):
+// right and up divided by the tangents of half the field of view, forward.w 1
+// once the volume is valid, depth.x km per world unit, depth.y 1 / its range in km
+cbuffer AerialPerspective : register(b4)
+{
+    float4 ap_right;
+    float4 ap_up;
+    float4 ap_forward;
+    float4 ap_depth;
+}
+
 // TODO: place all planet-related stuff into this cbuffer
 cbuffer CurrentPlanet : register(b2)
 {
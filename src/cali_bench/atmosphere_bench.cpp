@@ -0,0 +1,365 @@
+// The CPU atmosphere precompute per pass on one thread and on all of them, a
+// cold (precompute and store) and a warm (map from the cache) LUT load, the
+// sky radiance queries per ray (the straight port of the shader function,
+// atmosphere_query one ray at a time and in a batch from one camera), one SH
+// projection of the sky ambient, the 32^3 aerial perspective froxel volume per
+// frame, the analytic transmittance (AtmosphereFit.h) against a lookup in the
+// transmittance LUT with the error of both, and the GPU memory of the LUTs
+// with and without compact scattering.
+//
+// --lut-tiers: the precompute time, GPU memory and sky error (compare_luts)
+// of each lut_tier against LUTs twice the high tier.
+#include "bench.h"
+
+#include <Atmosphere.h>
+#include <AtmosphereAerialPerspective.h>
+#include <AtmosphereAmbient.h>
+#include <AtmosphereCache.h>
+#include <AtmosphereFitEarth.h>
+#include <AtmosphereFunctions.h>
+#include <AtmosphereQuery.h>
+
+#include <IvVector3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct atmosphere_timing
+		{
+			cali::atmosphere::lut_sizes sizes;
+			cali::atmosphere::precompute_stats stats; // of the fastest run
+		};
+
+		struct atmosphere_cache_timing
+		{
+			double cold_ms = 0.0, warm_ms = 0.0;
+			size_t bytes = 0;
+			bool hit = false;
+		};
+
+		struct lut_tier_report
+		{
+			std::string name;
+			cali::atmosphere::lut_sizes sizes;
+			double precompute_ms = 0.0;
+			cali::atmosphere::lut_memory memory;
+			cali::atmosphere::lut_error error;
+		};
+
+		struct atmosphere_query_timing
+		{
+			size_t rays = 0;
+			double reference_ns = 0.0, single_ns = 0.0, batch_ns = 0.0; // per ray
+			double sky_ambient_us = 0.0; // one SH projection of sky_ambient
+		};
+
+		struct aerial_perspective_timing
+		{
+			int threads = 0;
+			int size = 0;
+			double ms = 0.0; // one frame
+		};
+
+		struct transmittance_fit_timing
+		{
+			int lut_width = 0, lut_height = 0;
+			double lut_ns = 0.0, fit_ns = 0.0, fit_batch_ns = 0.0; // per evaluation
+			cali::atmosphere::transmittance_error lut_error, fit_error;
+		};
+
+		atmosphere_timing time_atmosphere(const cali::atmosphere::lut_sizes& sizes, int threads, int iterations)
+		{
+			atmosphere_timing t;
+			t.sizes = sizes;
+			for (int i = 0; i < iterations; ++i)
+			{
+				cali::atmosphere::luts luts;
+				cali::atmosphere::precompute_stats stats;
+				cali::atmosphere::precompute(cali::atmosphere::earth_atmosphere(), sizes, luts,
+					cali::atmosphere::c_scattering_orders, threads, &stats);
+				if (i == 0 || stats.total_ms < t.stats.total_ms) t.stats = stats;
+			}
+			return t;
+		}
+
+		atmosphere_cache_timing time_atmosphere_cache(const cali::atmosphere::lut_sizes& sizes)
+		{
+			namespace atm = cali::atmosphere;
+			const auto dir = std::filesystem::temp_directory_path() / "cali_bench_atmosphere_cache";
+			std::filesystem::remove_all(dir);
+			const cali::asset_cache cache(dir.string());
+			const atm::atmosphere_parameters atmosphere = atm::earth_atmosphere();
+
+			atmosphere_cache_timing t;
+			auto start = std::chrono::steady_clock::now();
+			atm::luts luts;
+			atm::precompute(atmosphere, sizes, luts);
+			atm::store_luts(cache, atmosphere, luts, atm::c_scattering_orders);
+			t.cold_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			start = std::chrono::steady_clock::now();
+			atm::mapped_luts mapped;
+			t.hit = atm::load_luts(cache, atmosphere, sizes, atm::c_scattering_orders, mapped);
+			t.warm_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			t.bytes = mapped.bytes();
+			mapped.close();
+			std::filesystem::remove_all(dir);
+			return t;
+		}
+
+		atmosphere_query_timing time_atmosphere_query(const cali::atmosphere::lut_sizes& sizes, int iterations)
+		{
+			namespace atm = cali::atmosphere;
+			const atm::atmosphere_parameters atmosphere = atm::earth_atmosphere();
+			auto luts = std::make_shared<atm::luts>();
+			atm::analytic_luts(atmosphere, sizes, *luts); // the cost does not depend on the texels
+			auto query = std::make_shared<const atm::atmosphere_query>(atmosphere, luts);
+
+			atmosphere_query_timing t;
+			t.rays = 4096;
+			std::vector<IvVector3> view_rays(t.rays);
+			for (size_t i = 0; i < t.rays; ++i)
+			{
+				view_rays[i] = IvVector3(cosf(0.37f * i), 2.0f * (float)i / (float)t.rays - 1.0f, sinf(0.37f * i));
+				view_rays[i].Normalize();
+			}
+			const IvVector3 camera(0.0f, atmosphere.bottom_radius + 0.5f, 0.0f);
+			IvVector3 sun_direction(0.4f, 0.3f, 0.1f);
+			sun_direction.Normalize();
+			const float camera_f[3] = { camera.x, camera.y, camera.z }, sun_f[3] = { sun_direction.x, sun_direction.y, sun_direction.z };
+
+			std::vector<atm::rgba> radiance(t.rays);
+			const double ms_to_ns_per_ray = 1e6 / (double)t.rays;
+			t.reference_ns = ms_to_ns_per_ray * time_ms(iterations, [&]() {
+				for (size_t i = 0; i < t.rays; ++i)
+				{
+					const float ray_f[3] = { view_rays[i].x, view_rays[i].y, view_rays[i].z };
+					atm::rgba transmittance;
+					radiance[i] = atm::common::get_sky_radiance(atmosphere, sizes, luts->transmittance, luts->scattering,
+						camera_f, ray_f, sun_f, transmittance);
+				}
+			});
+			t.single_ns = ms_to_ns_per_ray * time_ms(iterations, [&]() {
+				for (size_t i = 0; i < t.rays; ++i) radiance[i] = query->sky_radiance(camera, view_rays[i], sun_direction);
+			});
+			t.batch_ns = ms_to_ns_per_ray * time_ms(iterations, [&]() {
+				query->sky_radiance(camera, view_rays.data(), t.rays, sun_direction, radiance.data());
+			});
+			atm::sky_ambient ambient;
+			int projection = 0;
+			t.sky_ambient_us = 1e3 * time_ms(iterations, [&]() {
+				// the sun moves past the threshold every time
+				ambient.update(query, camera, view_rays[projection++]);
+			});
+			return t;
+		}
+
+		aerial_perspective_timing time_aerial_perspective(const cali::atmosphere::lut_sizes& sizes, int threads, int iterations)
+		{
+			namespace atm = cali::atmosphere;
+			const atm::atmosphere_parameters atmosphere = atm::earth_atmosphere();
+			auto luts = std::make_shared<atm::luts>();
+			atm::analytic_luts(atmosphere, sizes, *luts); // the cost does not depend on the texels
+			const atm::atmosphere_query query(atmosphere, luts);
+
+			aerial_perspective_timing t;
+			t.size = 32;
+			atm::aerial_perspective volume(t.size, t.size, t.size, 128.0f, threads);
+			t.threads = volume.threads();
+			atm::froxel_camera camera;
+			camera.position = IvVector3(0.0f, atmosphere.bottom_radius + 0.5f, 0.0f);
+			camera.forward = IvVector3(0.0f, -0.2f, 1.0f);
+			camera.forward.Normalize();
+			camera.right = IvVector3(1.0f, 0.0f, 0.0f);
+			camera.up = camera.forward.Cross(camera.right);
+			camera.tan_half_fov_x = 0.77f;
+			camera.tan_half_fov_y = 0.58f;
+			IvVector3 sun_direction(0.4f, 0.3f, 0.1f);
+			sun_direction.Normalize();
+			// per frame, so the best of several frames even for one iteration
+			t.ms = time_ms(std::max(iterations, 3), [&]() { volume.compute(query, camera, sun_direction); });
+			return t;
+		}
+
+		transmittance_fit_timing time_transmittance_fit(const cali::atmosphere::lut_sizes& sizes, int iterations)
+		{
+			namespace atm = cali::atmosphere;
+			const atm::atmosphere_parameters atmosphere = atm::earth_atmosphere();
+			atm::precompute_pipeline pipeline(atmosphere, sizes);
+			for (int row = 0; row < sizes.transmittance_height; ++row) pipeline.compute_transmittance(row);
+			const atm::texture_2d& lut = pipeline.transmittance();
+			const atm::transmittance_fit& fit = atm::earth_transmittance_fit();
+
+			const size_t count = 4096;
+			std::vector<float> r(count), mu(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const float x = (float)i / (float)count;
+				r[i] = atmosphere.bottom_radius + (atmosphere.top_radius - atmosphere.bottom_radius) * x * x;
+				mu[i] = cosf(0.37f * (float)i);
+			}
+			std::vector<atm::rgba> transmittance(count);
+
+			transmittance_fit_timing t;
+			t.lut_width = sizes.transmittance_width;
+			t.lut_height = sizes.transmittance_height;
+			const double ms_to_ns = 1e6 / (double)count;
+			t.lut_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (size_t i = 0; i < count; ++i)
+					transmittance[i] = atm::common::get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, lut, r[i], mu[i]);
+			});
+			t.fit_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (size_t i = 0; i < count; ++i) transmittance[i] = atm::fitted_transmittance_to_top(fit, atmosphere, r[i], mu[i]);
+			});
+			t.fit_batch_ns = ms_to_ns * time_ms(iterations, [&]() {
+				atm::fitted_transmittance_to_top(fit, atmosphere, r.data(), mu.data(), count, transmittance.data());
+			});
+			t.lut_error = atm::measure_transmittance_error(atmosphere, [&](float r, float mu) {
+				return atm::common::get_transmittance_to_top_atmosphere_boundary(atmosphere, sizes, lut, r, mu);
+			});
+			t.fit_error = atm::measure_transmittance_error(atmosphere, [&](float r, float mu) {
+				return atm::fitted_transmittance_to_top(fit, atmosphere, r, mu);
+			});
+			return t;
+		}
+
+		// the LUT sizes of the shaders, or a reduced set that a debug build gets
+		// through in about a second
+		cali::atmosphere::lut_sizes atmosphere_sizes(bool quick)
+		{
+			cali::atmosphere::lut_sizes sizes;
+			if (!quick) return sizes;
+			sizes.transmittance_width = 64;
+			sizes.transmittance_height = 16;
+			sizes.scattering_r = 4;
+			sizes.scattering_mu = 16;
+			sizes.scattering_mu_s = 8;
+			sizes.scattering_nu = 4;
+			sizes.irradiance_width = 16;
+			sizes.irradiance_height = 4;
+			return sizes;
+		}
+
+		// every dimension doubled; the scattering mu size stays even
+		cali::atmosphere::lut_sizes reference_lut_sizes(bool quick)
+		{
+			cali::atmosphere::lut_sizes sizes = cali::atmosphere::lut_sizes_for(cali::atmosphere::lut_tier::high);
+			if (quick) return sizes;
+			sizes.transmittance_width *= 2;
+			sizes.transmittance_height *= 2;
+			sizes.scattering_r *= 2;
+			sizes.scattering_mu *= 2;
+			sizes.scattering_mu_s *= 2;
+			sizes.scattering_nu *= 2;
+			sizes.irradiance_width *= 2;
+			sizes.irradiance_height *= 2;
+			return sizes;
+		}
+
+		std::vector<lut_tier_report> measure_lut_tiers(bool quick)
+		{
+			namespace atm = cali::atmosphere;
+			const atm::atmosphere_parameters atmosphere = atm::earth_atmosphere();
+			auto reference_luts = std::make_shared<atm::luts>();
+			atm::precompute(atmosphere, reference_lut_sizes(quick), *reference_luts);
+			const atm::atmosphere_query reference(atmosphere, reference_luts);
+
+			std::vector<lut_tier_report> reports;
+			for (atm::lut_tier tier : { atm::lut_tier::low, atm::lut_tier::medium, atm::lut_tier::high })
+			{
+				lut_tier_report r;
+				r.name = atm::lut_tier_name(tier);
+				r.sizes = atm::lut_sizes_for(tier);
+				auto luts = std::make_shared<atm::luts>();
+				atm::precompute_stats stats;
+				atm::precompute(atmosphere, r.sizes, *luts, atm::c_scattering_orders, 0, &stats);
+				r.precompute_ms = stats.total_ms;
+				r.memory = atm::gpu_lut_memory(r.sizes, ATMOSPHERE_COMPACT_SCATTERING != 0);
+				r.error = atm::compare_luts(atm::atmosphere_query(atmosphere, luts), reference);
+				reports.push_back(r);
+			}
+			return reports;
+		}
+	}
+
+	void bench_atmosphere(const options& opt, report& r)
+	{
+		const cali::atmosphere::lut_sizes sizes = atmosphere_sizes(opt.quick);
+
+		std::vector<std::string> precompute;
+		for (int threads : thread_counts())
+		{
+			const atmosphere_timing t = time_atmosphere(sizes, threads, opt.iterations);
+			const cali::atmosphere::precompute_stats& a = t.stats;
+			precompute.push_back(format("{ \"scattering_size\": [%d, %d, %d], \"threads\": %d, \"transmittance\": %.3f, "
+				"\"direct_irradiance\": %.3f, \"single_scattering\": %.3f, \"scattering_density\": %.3f, \"indirect_irradiance\": %.3f, "
+				"\"multiple_scattering\": %.3f, \"total\": %.3f }",
+				t.sizes.scattering_width(), t.sizes.scattering_height(), t.sizes.scattering_depth(), a.threads, a.transmittance_ms,
+				a.direct_irradiance_ms, a.single_scattering_ms, a.scattering_density_ms, a.indirect_irradiance_ms,
+				a.multiple_scattering_ms, a.total_ms));
+		}
+		r.add_array("atmosphere_ms", precompute);
+
+		const atmosphere_cache_timing cache = time_atmosphere_cache(sizes);
+		r.add("atmosphere_cache", format("{ \"cold_ms\": %.3f, \"warm_ms\": %.3f, \"bytes\": %zu, \"hit\": %s }",
+			cache.cold_ms, cache.warm_ms, cache.bytes, cache.hit ? "true" : "false"));
+
+		const atmosphere_query_timing query = time_atmosphere_query(sizes, opt.iterations);
+		r.add("atmosphere_query_ns", format("{ \"rays\": %zu, \"reference\": %.1f, \"single\": %.1f, \"batch\": %.1f }",
+			query.rays, query.reference_ns, query.single_ns, query.batch_ns));
+		r.add("sky_ambient_us", format("%.1f", query.sky_ambient_us));
+
+		std::vector<std::string> aerial_perspective;
+		for (int threads : thread_counts())
+		{
+			const aerial_perspective_timing t = time_aerial_perspective(sizes, threads, opt.iterations);
+			aerial_perspective.push_back(format("{ \"size\": %d, \"threads\": %d, \"ms\": %.3f }", t.size, t.threads, t.ms));
+		}
+		r.add_array("aerial_perspective_ms", aerial_perspective);
+
+		const transmittance_fit_timing fit = time_transmittance_fit(sizes, opt.iterations);
+		r.add("transmittance_fit", format("{ \"lut_size\": [%d, %d], \"lut_ns\": %.1f, \"fit_ns\": %.1f, \"fit_batch_ns\": %.1f, "
+			"\"lut_max_error\": %.2e, \"lut_mean_error\": %.2e, \"fit_max_error\": %.2e, \"fit_mean_error\": %.2e }",
+			fit.lut_width, fit.lut_height, fit.lut_ns, fit.fit_ns, fit.fit_batch_ns, fit.lut_error.max_abs, fit.lut_error.mean_abs,
+			fit.fit_error.max_abs, fit.fit_error.mean_abs));
+
+		// of the app's LUTs: the delta textures used to stay allocated after the precompute
+		const cali::atmosphere::lut_memory rgba16f = cali::atmosphere::gpu_lut_memory(cali::atmosphere::lut_sizes(), false);
+		const cali::atmosphere::lut_memory compact = cali::atmosphere::gpu_lut_memory(cali::atmosphere::lut_sizes(), true);
+		r.add("atmosphere_memory", format("{ \"before_bytes\": %zu, \"resident_bytes\": %zu, \"peak_bytes\": %zu, "
+			"\"compact_resident_bytes\": %zu, \"compact_peak_bytes\": %zu }",
+			rgba16f.peak(), rgba16f.resident(), rgba16f.peak(), compact.resident(), compact.peak()));
+	}
+
+	void bench_lut_tiers(const options& opt, report& r)
+	{
+		auto error = [](const char* name, const cali::atmosphere::error_stats& e) {
+			return format("\"%s\": { \"mean\": %.5f, \"p95\": %.5f, \"max\": %.5f, \"samples\": %zu }", name, e.mean, e.p95, e.max, e.samples);
+		};
+
+		const cali::atmosphere::lut_sizes reference = reference_lut_sizes(opt.quick);
+		r.add("reference_scattering_size", format("[%d, %d, %d]", reference.scattering_width(), reference.scattering_height(),
+			reference.scattering_depth()));
+		std::vector<std::string> tiers;
+		for (const lut_tier_report& t : measure_lut_tiers(opt.quick))
+			tiers.push_back(format("{ \"tier\": \"%s\", \"transmittance_size\": [%d, %d], \"scattering_size\": [%d, %d, %d], "
+				"\"irradiance_size\": [%d, %d], \"precompute_ms\": %.3f, \"resident_bytes\": %zu, \"peak_bytes\": %zu, ",
+				t.name.c_str(), t.sizes.transmittance_width, t.sizes.transmittance_height, t.sizes.scattering_width(),
+				t.sizes.scattering_height(), t.sizes.scattering_depth(), t.sizes.irradiance_width, t.sizes.irradiance_height,
+				t.precompute_ms, t.memory.resident(), t.memory.peak()) +
+				error("sky_radiance", t.error.sky_radiance) + ", " + error("transmittance", t.error.transmittance) + ", " +
+				error("sky_irradiance", t.error.sky_irradiance) + " }");
+		r.add_array("lut_tiers", tiers);
+	}
+}
+}
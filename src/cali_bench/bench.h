@@ -0,0 +1,81 @@
+#pragma once
+// The harness of cali_bench: options, timing and the JSON report that every
+// module's benchmark adds its members to. Each <module>_bench.cpp times one
+// module of cali_core; bench_main.cpp runs them in order.
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	struct options
+	{
+		bool quick = false;
+		bool lut_tiers = false;
+		int iterations = 3;
+		std::string json_path;
+	};
+
+	// best of `iterations` runs in milliseconds
+	double time_ms(int iterations, const std::function<void()>& fn);
+
+	// 1 and, with more cores, all of them
+	std::vector<int> thread_counts();
+
+	// printf into a string
+	std::string format(const char* pattern, ...)
+#if defined(__GNUC__)
+		__attribute__((format(printf, 1, 2)))
+#endif
+		;
+
+	std::string hex(uint64_t v);
+
+	// The members of the report in the order they are added, after the
+	// compiler, the options and the golden checksums
+	class report
+	{
+		struct checksum
+		{
+			std::string name;
+			uint64_t seed;
+			int size;
+			uint64_t actual, expected;
+		};
+
+		std::vector<std::pair<std::string, std::string>> m_members;
+		std::vector<checksum> m_checksums;
+
+	public:
+		// value is JSON: a number, a quoted string or an object
+		void add(const char* name, const std::string& value);
+		void add_array(const char* name, const std::vector<std::string>& items);
+
+		void check(const char* name, uint64_t seed, int size, uint64_t actual, uint64_t expected);
+		// false if a checksum differs; prints each that does to stderr
+		bool deterministic(bool print = false) const;
+
+		void write(FILE* f, const options& opt) const;
+	};
+
+	// generate_heightmap per stage, cube_sphere, erosion and the golden checksums
+	void bench_procedural(const options& opt, report& r);
+	// the atmosphere precompute, its cache, queries, aerial perspective,
+	// transmittance fit and GPU memory
+	void bench_atmosphere(const options& opt, report& r);
+	// --lut-tiers: each lut_tier against LUTs twice the high tier
+	void bench_lut_tiers(const options& opt, report& r);
+	void bench_matrix(const options& opt, report& r);
+	void bench_sphere_math(const options& opt, report& r);
+	// the patch corners, relative to the eye, and patch culling
+	void bench_terrain(const options& opt, report& r);
+	void bench_frustum(const options& opt, report& r);
+	void bench_transforms(const options& opt, report& r);
+	void bench_bvh(const options& opt, report& r);
+	void bench_fastmath(const options& opt, report& r);
+}
+}
@@ -0,0 +1,185 @@
+// Headless benchmarks and determinism check of cali_core.
+//
+//   cali_bench [--quick] [--iterations N] [--json report.json]
+//   cali_bench --lut-tiers [--quick] [--json report.json]
+//
+// Checks every golden checksum (procedural_golden.h), times each module
+// (<module>_bench.cpp) and writes a JSON report. Exits with 1 if any checksum
+// differs, so a faster generator can be checked against the terrain it has
+// to reproduce.
+//
+// --lut-tiers instead precomputes the atmosphere LUTs of each lut_tier and
+// reports their precompute time, GPU memory and sky error (compare_luts)
+// against LUTs twice the high tier in every dimension (the high tier itself
+// with --quick), to pick the cheapest tier that is good enough.
+#include "bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+namespace cali
+{
+namespace bench
+{
+	double time_ms(int iterations, const std::function<void()>& fn)
+	{
+		double best = 1e30;
+		for (int i = 0; i < iterations; ++i)
+		{
+			auto start = std::chrono::steady_clock::now();
+			fn();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+
+	std::vector<int> thread_counts()
+	{
+		const int hardware_threads = std::max(1, (int)std::thread::hardware_concurrency());
+		if (hardware_threads == 1) return { 1 };
+		return { 1, hardware_threads };
+	}
+
+	std::string format(const char* pattern, ...)
+	{
+		va_list args;
+		va_start(args, pattern);
+		char buf[1024];
+		const int length = vsnprintf(buf, sizeof(buf), pattern, args);
+		va_end(args);
+		if (length < (int)sizeof(buf)) return std::string(buf, length < 0 ? 0 : length);
+
+		std::string s((size_t)length + 1, '\0');
+		va_start(args, pattern);
+		vsnprintf(&s[0], s.size(), pattern, args);
+		va_end(args);
+		s.resize((size_t)length);
+		return s;
+	}
+
+	std::string hex(uint64_t v) { return format("0x%016llx", (unsigned long long)v); }
+
+	void report::add(const char* name, const std::string& value) { m_members.emplace_back(name, value); }
+
+	void report::add_array(const char* name, const std::vector<std::string>& items)
+	{
+		std::string value = "[\n";
+		for (size_t i = 0; i < items.size(); ++i) value += "    " + items[i] + (i + 1 < items.size() ? ",\n" : "\n");
+		add(name, value + "  ]");
+	}
+
+	void report::check(const char* name, uint64_t seed, int size, uint64_t actual, uint64_t expected)
+	{
+		m_checksums.push_back({ name, seed, size, actual, expected });
+	}
+
+	bool report::deterministic(bool print) const
+	{
+		bool deterministic = true;
+		for (const checksum& c : m_checksums)
+		{
+			if (c.actual == c.expected) continue;
+			deterministic = false;
+			if (print)
+				fprintf(stderr, "checksum mismatch: %s seed %llu size %d: %s, expected %s\n", c.name.c_str(),
+					(unsigned long long)c.seed, c.size, hex(c.actual).c_str(), hex(c.expected).c_str());
+		}
+		return deterministic;
+	}
+
+	namespace
+	{
+		std::string compiler_name()
+		{
+#if defined(_MSC_VER)
+			return "msvc " + std::to_string(_MSC_FULL_VER);
+#elif defined(__clang__)
+			return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+			return std::string("gcc ") + __VERSION__;
+#else
+			return "unknown";
+#endif
+		}
+
+		bool parse_options(int argc, char** argv, options& opt)
+		{
+			for (int i = 1; i < argc; ++i)
+			{
+				if (!strcmp(argv[i], "--quick")) { opt.quick = true; opt.iterations = 1; }
+				else if (!strcmp(argv[i], "--lut-tiers")) opt.lut_tiers = true;
+				else if (!strcmp(argv[i], "--iterations") && i + 1 < argc) opt.iterations = std::max(1, atoi(argv[++i]));
+				else if (!strcmp(argv[i], "--json") && i + 1 < argc) opt.json_path = argv[++i];
+				else
+				{
+					fprintf(stderr, "usage: %s [--quick] [--iterations N] [--json report.json]\n"
+						"       %s --lut-tiers [--quick] [--json report.json]\n", argv[0], argv[0]);
+					return false;
+				}
+			}
+			return true;
+		}
+	}
+
+	void report::write(FILE* f, const options& opt) const
+	{
+		fprintf(f, "{\n");
+		fprintf(f, "  \"compiler\": \"%s\"", compiler_name().c_str());
+		if (!opt.lut_tiers)
+		{
+			fprintf(f, ",\n  \"quick\": %s,\n", opt.quick ? "true" : "false");
+			fprintf(f, "  \"iterations\": %d,\n", opt.iterations);
+			fprintf(f, "  \"deterministic\": %s,\n", deterministic() ? "true" : "false");
+			fprintf(f, "  \"checksums\": [\n");
+			for (size_t i = 0; i < m_checksums.size(); ++i)
+			{
+				const checksum& c = m_checksums[i];
+				fprintf(f, "    { \"name\": \"%s\", \"seed\": %llu, \"size\": %d, \"actual\": \"%s\", \"expected\": \"%s\", \"match\": %s }%s\n",
+					c.name.c_str(), (unsigned long long)c.seed, c.size, hex(c.actual).c_str(), hex(c.expected).c_str(),
+					c.actual == c.expected ? "true" : "false", i + 1 < m_checksums.size() ? "," : "");
+			}
+			fprintf(f, "  ]");
+		}
+		for (const auto& member : m_members) fprintf(f, ",\n  \"%s\": %s", member.first.c_str(), member.second.c_str());
+		fprintf(f, "\n}\n");
+	}
+}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace cali::bench;
+	options opt;
+	if (!parse_options(argc, argv, opt)) return 2;
+
+	report r;
+	if (opt.lut_tiers)
+		bench_lut_tiers(opt, r);
+	else
+	{
+		bench_procedural(opt, r);
+		bench_atmosphere(opt, r);
+		bench_matrix(opt, r);
+		bench_sphere_math(opt, r);
+		bench_terrain(opt, r);
+		bench_frustum(opt, r);
+		bench_transforms(opt, r);
+		bench_bvh(opt, r);
+		bench_fastmath(opt, r);
+	}
+	const bool deterministic = r.deterministic(true);
+
+	r.write(stdout, opt);
+	if (!opt.json_path.empty())
+	{
+		FILE* f = fopen(opt.json_path.c_str(), "w");
+		if (!f) { fprintf(stderr, "cannot write %s\n", opt.json_path.c_str()); return 2; }
+		r.write(f, opt);
+		fclose(f);
+	}
+	return deterministic ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+// A bvh over 1M boxes built on one thread and on all of them and refit to
+// moved boxes, in ms, with its memory, and queried in ns per query by
+// frustum, box, sphere and ray, with the mean number of hits of each.
+#include "bench.h"
+
+#include <BVH.h>
+#include <CaliMath.h>
+#include <Frustum.h>
+
+#include <IvAABB.h>
+#include <IvBoundingSphere.h>
+#include <IvMath.h>
+#include <IvMatrix33.h>
+#include <IvMatrix44.h>
+#include <IvRay3.h>
+
+#include <cmath>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct bvh_timing
+		{
+			size_t count = 0;
+			int threads = 1;
+			double build_ms = 0.0, refit_ms = 0.0;
+			size_t nodes = 0, depth = 0, memory_bytes = 0;
+			// per query, and the mean hits of each
+			double frustum_ns = 0.0, box_ns = 0.0, sphere_ns = 0.0, ray_ns = 0.0;
+			double frustum_hits = 0.0, box_hits = 0.0, sphere_hits = 0.0, ray_hits = 0.0;
+		};
+
+		bvh_timing time_bvh(int threads, int iterations)
+		{
+			// boxes of up to 20 m spread evenly (the R3 sequence) through a 10 km cube,
+			// as rocks and trees over a patch of terrain
+			auto spread = [](size_t i, double scale) {
+				return IvVector3{ (float)(scale * (fmod(0.7548776662 * i, 1.0) - 0.5)), (float)(scale * (fmod(0.5698402910 * i, 1.0) - 0.5)),
+					(float)(scale * (fmod(0.4301597090 * i, 1.0) - 0.5)) };
+			};
+			const size_t count = 1000000;
+			std::vector<IvAABB> bounds(count), moved(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const IvVector3 lo = spread(i, 10000.0);
+				const IvVector3 size{ 1.f + 19.f * fabsf(sinf(0.7f * i)), 1.f + 19.f * fabsf(cosf(0.3f * i)), 1.f + 9.f * fabsf(sinf(0.9f * i)) };
+				const IvVector3 step{ 10.f * sinf(1.3f * i), 10.f * cosf(1.7f * i), 10.f * sinf(2.3f * i) };
+				bounds[i].Set(lo, lo + size);
+				moved[i].Set(lo + step, lo + size + step);
+			}
+
+			bvh_timing t;
+			t.count = count;
+			t.threads = threads;
+			cali::bvh tree(threads);
+			t.build_ms = time_ms(iterations, [&]() { tree.build(bounds); });
+			t.nodes = tree.node_count();
+			t.depth = tree.depth();
+			t.memory_bytes = tree.memory_bytes();
+			t.refit_ms = time_ms(iterations, [&]() { tree.refit(moved); tree.refit(bounds); }) * 0.5;
+
+			// camera::send_settings_to_renderer() with the far plane at 1 km
+			const float n = 0.1f, far_distance = 1000.0f, Q = far_distance / (far_distance - n), d = 1.0f / IvTan(kPI / 6.0f);
+			IvMatrix44 projection;
+			projection(0, 0) = d / (16.0f / 9.0f);
+			projection(1, 1) = d;
+			projection(2, 2) = Q;
+			projection(2, 3) = -n * Q;
+			projection(3, 2) = 1.0f;
+			projection(3, 3) = 0.0f;
+
+			const int queries = 1000;
+			std::vector<cali::frustum> views(queries);
+			std::vector<IvAABB> boxes(queries);
+			std::vector<IvBoundingSphere> spheres(queries);
+			std::vector<IvRay3> rays(queries);
+			for (int i = 0; i < queries; ++i)
+			{
+				const IvVector3 p = spread(i + 12345, 8000.0);
+				IvVector3 direction{ sinf(1.1f * i), cosf(0.7f * i), sinf(0.3f * i + 0.5f) };
+				direction.Normalize();
+				// a view matrix translating p to the origin, turned about y towards direction
+				IvMatrix44 view;
+				const float c = direction.z, s = direction.x;
+				const float length = sqrtf(c * c + s * s) > 0.f ? sqrtf(c * c + s * s) : 1.f;
+				view(0, 0) = c / length; view(0, 2) = -s / length;
+				view(2, 0) = s / length; view(2, 2) = c / length;
+				view(0, 3) = -(view(0, 0) * p.x + view(0, 2) * p.z);
+				view(1, 3) = -p.y;
+				view(2, 3) = -(view(2, 0) * p.x + view(2, 2) * p.z);
+				views[i].construct_frustum(projection, view);
+				boxes[i].Set(p, p + IvVector3{ 30.f, 30.f, 30.f });
+				spheres[i].SetCenter(p);
+				spheres[i].SetRadius(20.f);
+				rays[i].Set(p, direction);
+			}
+
+			std::vector<cali::bvh::index> hits;
+			auto time_queries = [&](const std::function<void(int)>& query, double& hits_mean) {
+				size_t total = 0;
+				const double ns = 1e6 / queries * time_ms(iterations, [&]() {
+					total = 0;
+					for (int i = 0; i < queries; ++i)
+					{
+						query(i);
+						total += hits.size();
+					}
+				});
+				hits_mean = (double)total / queries;
+				return ns;
+			};
+			t.frustum_ns = time_queries([&](int i) { tree.query(views[i], hits); }, t.frustum_hits);
+			t.box_ns = time_queries([&](int i) { tree.query(boxes[i], hits); }, t.box_hits);
+			t.sphere_ns = time_queries([&](int i) { tree.query(spheres[i], hits); }, t.sphere_hits);
+			t.ray_ns = time_queries([&](int i) { tree.query(rays[i], 1000.f, hits); }, t.ray_hits);
+			return t;
+		}
+	}
+
+	void bench_bvh(const options& opt, report& r)
+	{
+		std::vector<std::string> bvhs;
+		for (int threads : thread_counts())
+		{
+			const bvh_timing t = time_bvh(threads, opt.iterations);
+			bvhs.push_back(format("{ \"boxes\": %zu, \"threads\": %d, \"build_ms\": %.2f, \"refit_ms\": %.2f, \"nodes\": %zu, \"depth\": %zu, "
+				"\"memory_bytes\": %zu, \"frustum_ns\": %.1f, \"box_ns\": %.1f, \"sphere_ns\": %.1f, \"ray_ns\": %.1f, "
+				"\"frustum_hits\": %.1f, \"box_hits\": %.1f, \"sphere_hits\": %.1f, \"ray_hits\": %.1f }",
+				t.count, t.threads, t.build_ms, t.refit_ms, t.nodes, t.depth, t.memory_bytes, t.frustum_ns, t.box_ns, t.sphere_ns,
+				t.ray_ns, t.frustum_hits, t.box_hits, t.sphere_hits, t.ray_hits));
+		}
+		r.add_array("bvh", bvhs);
+	}
+}
+}
@@ -0,0 +1,147 @@
+// The FastMath.h functions in ns per value in each accuracy tier, scalar and
+// array form, against the float libm, with their largest error in ulp over
+// 2^20 samples (2^16 with --quick).
+#include "bench.h"
+
+#include <FastMath.h>
+#include <Procedural.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct fastmath_timing
+		{
+			const char* name = "";
+			double libm_ns = 0.0;
+			double scalar_ns[3] = {}, array_ns[3] = {}; // fast, medium, exact
+			double max_ulp[3] = {};
+		};
+
+		double ulp_of(double v)
+		{
+			v = fabs(v);
+			if (v < FLT_MIN) return ldexp(1.0, -149);
+			int e;
+			frexp(v, &e);
+			return ldexp(1.0, e - 24);
+		}
+
+		// One FastMath.h function: libm float, the double reference, and each tier;
+		// the one-argument functions ignore y
+		struct fastmath_function
+		{
+			const char* name;
+			double lo, hi, y_lo, y_hi;
+			float (*libm)(float, float);
+			double (*reference)(double, double);
+			float (*scalar[3])(float, float);
+			void (*array[3])(const float*, const float*, float*, size_t);
+		};
+
+		template <cali::fastmath::accuracy A, float (*F)(float)> float unary(float x, float) { return F(x); }
+		template <cali::fastmath::accuracy A, void (*F)(const float*, float*, size_t)>
+		void unary_array(const float* x, const float*, float* out, size_t count) { F(x, out, count); }
+
+#define CALI_FASTMATH_FUNCTION(NAME, LO, HI, LIBM, REFERENCE) \
+		{ #NAME, LO, HI, 0.0, 0.0, [](float x, float) { return LIBM(x); }, [](double x, double) { return REFERENCE(x); }, \
+			{ unary<cali::fastmath::accuracy::fast, cali::fastmath::NAME<cali::fastmath::accuracy::fast>>, \
+			  unary<cali::fastmath::accuracy::medium, cali::fastmath::NAME<cali::fastmath::accuracy::medium>>, \
+			  unary<cali::fastmath::accuracy::exact, cali::fastmath::NAME<cali::fastmath::accuracy::exact>> }, \
+			{ unary_array<cali::fastmath::accuracy::fast, cali::fastmath::NAME<cali::fastmath::accuracy::fast>>, \
+			  unary_array<cali::fastmath::accuracy::medium, cali::fastmath::NAME<cali::fastmath::accuracy::medium>>, \
+			  unary_array<cali::fastmath::accuracy::exact, cali::fastmath::NAME<cali::fastmath::accuracy::exact>> } }
+#define CALI_FASTMATH_FUNCTION2(NAME, LO, HI, Y_LO, Y_HI, LIBM, REFERENCE) \
+		{ #NAME, LO, HI, Y_LO, Y_HI, [](float x, float y) { return LIBM(x, y); }, [](double x, double y) { return REFERENCE(x, y); }, \
+			{ cali::fastmath::NAME<cali::fastmath::accuracy::fast>, cali::fastmath::NAME<cali::fastmath::accuracy::medium>, \
+			  cali::fastmath::NAME<cali::fastmath::accuracy::exact> }, \
+			{ cali::fastmath::NAME<cali::fastmath::accuracy::fast>, cali::fastmath::NAME<cali::fastmath::accuracy::medium>, \
+			  cali::fastmath::NAME<cali::fastmath::accuracy::exact> } }
+
+		std::vector<fastmath_timing> time_fastmath(int iterations, bool quick)
+		{
+			// the domains of FastMath.h's error table; log and pow take x log-uniform
+			// (lo, hi are exponents of 2), atan2 and pow their second argument in [y_lo, y_hi]
+			const fastmath_function functions[] = {
+				CALI_FASTMATH_FUNCTION(sin, -4096.0, 4096.0, sinf, ::sin),
+				CALI_FASTMATH_FUNCTION(cos, -4096.0, 4096.0, cosf, ::cos),
+				CALI_FASTMATH_FUNCTION(tan, -4096.0, 4096.0, tanf, ::tan),
+				CALI_FASTMATH_FUNCTION(atan, -100.0, 100.0, atanf, ::atan),
+				CALI_FASTMATH_FUNCTION2(atan2, -10.0, 10.0, -10.0, 10.0, atan2f, ::atan2),
+				CALI_FASTMATH_FUNCTION(asin, -1.0, 1.0, asinf, ::asin),
+				CALI_FASTMATH_FUNCTION(acos, -1.0, 1.0, acosf, ::acos),
+				CALI_FASTMATH_FUNCTION(exp, -104.0, 88.7, expf, ::exp),
+				CALI_FASTMATH_FUNCTION(log, -149.0, 128.0, logf, ::log),
+				CALI_FASTMATH_FUNCTION2(pow, -28.0, 28.0, -4.0, 4.0, powf, ::pow),
+			};
+
+			const size_t samples = quick ? (1u << 16) : (1u << 20);
+			const size_t timed = 4096;
+			const int passes = 20;
+			std::vector<fastmath_timing> results;
+			for (const fastmath_function& f : functions)
+			{
+				const bool log_scale = f.name == std::string("log") || f.name == std::string("pow");
+				std::vector<float> x(samples), y(samples), out(samples);
+				uint64_t state = 0x2545f4914f6cdd1dull;
+				for (size_t i = 0; i < samples; ++i)
+				{
+					const double u = f.lo + (f.hi - f.lo) * ((proc::splitmix64(state++) >> 11) * (1.0 / 9007199254740992.0));
+					const double v = (proc::splitmix64(state++) >> 11) * (1.0 / 9007199254740992.0);
+					x[i] = (float)(log_scale ? ldexp(1.0 + v, (int)floor(u)) : u);
+					y[i] = (float)(f.y_lo + (f.y_hi - f.y_lo) * v);
+				}
+
+				fastmath_timing t;
+				t.name = f.name;
+				const double per_value = 1e6 / ((double)timed * passes);
+				t.libm_ns = per_value * time_ms(iterations, [&]() {
+					for (int pass = 0; pass < passes; ++pass)
+						for (size_t i = 0; i < timed; ++i) out[i] = f.libm(x[i], y[i]);
+				});
+				for (int tier = 0; tier < 3; ++tier)
+				{
+					t.scalar_ns[tier] = per_value * time_ms(iterations, [&]() {
+						for (int pass = 0; pass < passes; ++pass)
+							for (size_t i = 0; i < timed; ++i) out[i] = f.scalar[tier](x[i], y[i]);
+					});
+					t.array_ns[tier] = per_value * time_ms(iterations, [&]() {
+						for (int pass = 0; pass < passes; ++pass) f.array[tier](x.data(), y.data(), out.data(), timed);
+					});
+					f.array[tier](x.data(), y.data(), out.data(), samples);
+					for (size_t i = 0; i < samples; ++i)
+					{
+						const double reference = f.reference(x[i], y[i]);
+						t.max_ulp[tier] = std::max(t.max_ulp[tier], fabs((double)out[i] - reference) / ulp_of(reference));
+					}
+				}
+				results.push_back(t);
+			}
+			return results;
+		}
+
+#undef CALI_FASTMATH_FUNCTION
+#undef CALI_FASTMATH_FUNCTION2
+	}
+
+	void bench_fastmath(const options& opt, report& r)
+	{
+		std::vector<std::string> functions;
+		for (const fastmath_timing& t : time_fastmath(opt.iterations, opt.quick))
+			functions.push_back(format("{ \"function\": \"%s\", \"libm_ns\": %.2f, \"fast\": { \"scalar_ns\": %.2f, \"array_ns\": %.2f, \"max_ulp\": %.2f }, "
+				"\"medium\": { \"scalar_ns\": %.2f, \"array_ns\": %.2f, \"max_ulp\": %.2f }, "
+				"\"exact\": { \"scalar_ns\": %.2f, \"array_ns\": %.2f, \"max_ulp\": %.2f } }",
+				t.name, t.libm_ns, t.scalar_ns[0], t.array_ns[0], t.max_ulp[0], t.scalar_ns[1], t.array_ns[1], t.max_ulp[1],
+				t.scalar_ns[2], t.array_ns[2], t.max_ulp[2]));
+		r.add_array("fastmath", functions);
+	}
+}
+}
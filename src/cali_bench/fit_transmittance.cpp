@@ -0,0 +1,166 @@
+// Offline fit of the analytic transmittance (AtmosphereFit.h) for the atmosphere
+// of the shaders.
+//
+//   cali_fit_transmittance [--header AtmosphereFitEarth.h] [--hlsl bruneton_transmittance_fit.fx]
+//
+// Fits earth_atmosphere(), prints the coefficients and the error bounds as
+// JSON and writes the C++ header and the HLSL include that carry them. Run it
+// again whenever the radii or scale heights of the atmosphere change.
+#include <Atmosphere.h>
+#include <AtmosphereFit.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+using namespace cali::atmosphere;
+
+namespace
+{
+	// Round trips through float; `suffix` is "f" for C++.
+	std::string literal(float value, const char* suffix)
+	{
+		char text[32];
+		snprintf(text, sizeof(text), "%.9g", value);
+		std::string result = text;
+		if (result.find_first_of(".e") == std::string::npos) result += ".0";
+		return result + suffix;
+	}
+
+	void write_coefficients(FILE* f, const float* c, const char* indent, const char* suffix)
+	{
+		const int order = transmittance_fit::degree + 1;
+		for (int j = 0; j < order; ++j)
+		{
+			fprintf(f, "%s", indent);
+			for (int i = 0; i < order; ++i)
+			{
+				const int k = j * order + i;
+				fprintf(f, "%s%s", literal(c[k], suffix).c_str(),
+					k + 1 == transmittance_fit::coefficient_count ? "" : i + 1 == order ? "," : ", ");
+			}
+			fprintf(f, "\n");
+		}
+	}
+
+	void write_header(FILE* f, const transmittance_fit& fit)
+	{
+		fprintf(f, "#pragma once\n");
+		fprintf(f, "// Generated by cali_fit_transmittance from earth_atmosphere(), do not edit.\n");
+		fprintf(f, "// Transmittance error: max %.2e, mean %.2e.\n", fit.max_error, fit.mean_error);
+		fprintf(f, "#include \"AtmosphereFit.h\"\n\n");
+		fprintf(f, "namespace cali\n{\nnamespace atmosphere\n{\n");
+		fprintf(f, "\tinline const transmittance_fit& earth_transmittance_fit()\n\t{\n");
+		fprintf(f, "\t\tstatic const transmittance_fit fit =\n\t\t{\n");
+		fprintf(f, "\t\t\t%s, %s, %s, %s,\n", literal(fit.bottom_radius, "f").c_str(), literal(fit.top_radius, "f").c_str(),
+			literal(fit.rayleigh_scale_height, "f").c_str(), literal(fit.mie_scale_height, "f").c_str());
+		fprintf(f, "\t\t\t{\n");
+		write_coefficients(f, fit.rayleigh, "\t\t\t\t", "f");
+		fprintf(f, "\t\t\t},\n\t\t\t{\n");
+		write_coefficients(f, fit.mie, "\t\t\t\t", "f");
+		fprintf(f, "\t\t\t},\n");
+		fprintf(f, "\t\t\t%s, %s\n", literal(fit.max_error, "f").c_str(), literal(fit.mean_error, "f").c_str());
+		fprintf(f, "\t\t};\n\t\treturn fit;\n\t}\n}\n}\n");
+	}
+
+	void write_hlsl(FILE* f, const transmittance_fit& fit)
+	{
+		const int order = transmittance_fit::degree + 1;
+		fprintf(f, "// Generated by cali_fit_transmittance from earth_atmosphere(), do not edit.\n");
+		fprintf(f, "// Analytic transmittance to the top of the atmosphere (AtmosphereFit.h), for\n");
+		fprintf(f, "// where the transmittance texture is not bound; include after bruneton_common.fx.\n");
+		fprintf(f, "// Transmittance error: max %.2e, mean %.2e.\n\n", fit.max_error, fit.mean_error);
+		fprintf(f, "#define TRANSMITTANCE_FIT_ORDER %d\n\n", order);
+		fprintf(f, "static const float TRANSMITTANCE_FIT[2][%d] =\n{\n", transmittance_fit::coefficient_count);
+		fprintf(f, "    {\n");
+		write_coefficients(f, fit.rayleigh, "        ", "");
+		fprintf(f, "    },\n    {\n");
+		write_coefficients(f, fit.mie, "        ", "");
+		fprintf(f, "    }\n};\n\n");
+		fprintf(f, "%s",
+			"// log of the mean density along the ray relative to its start, layer 0 rayleigh, 1 mie\n"
+			"Number TransmittanceFitPolynomial(int layer, Number s, Number t)\n"
+			"{\n"
+			"    Number result = 0.0;\n"
+			"    [unroll]\n"
+			"    for (int j = TRANSMITTANCE_FIT_ORDER - 1; j >= 0; --j)\n"
+			"    {\n"
+			"        Number p = TRANSMITTANCE_FIT[layer][j * TRANSMITTANCE_FIT_ORDER + TRANSMITTANCE_FIT_ORDER - 1];\n"
+			"        [unroll]\n"
+			"        for (int i = TRANSMITTANCE_FIT_ORDER - 2; i >= 0; --i)\n"
+			"            p = p * s + TRANSMITTANCE_FIT[layer][j * TRANSMITTANCE_FIT_ORDER + i];\n"
+			"        result = result * t + p;\n"
+			"    }\n"
+			"    return result;\n"
+			"}\n"
+			"\n"
+			"DimensionlessSpectrum GetFittedTransmittanceToTopAtmosphereBoundary(\n"
+			"    in AtmosphereParameters atmosphere, Length r, Number mu)\n"
+			"{\n"
+			"    r = ClampRadius(atmosphere, r);\n"
+			"    Length H = sqrt(atmosphere.top_radius * atmosphere.top_radius -\n"
+			"        atmosphere.bottom_radius * atmosphere.bottom_radius);\n"
+			"    Length rho = SafeSqrt(r * r - atmosphere.bottom_radius * atmosphere.bottom_radius);\n"
+			"    Length d_min = atmosphere.top_radius - r;\n"
+			"    Length d_max = rho + H;\n"
+			"    Length d = clamp(DistanceToTopAtmosphereBoundary(atmosphere, r, mu), d_min, d_max);\n"
+			"    Number s = 2.0 * (d_max > d_min ? (d - d_min) / (d_max - d_min) : 0.0) - 1.0;\n"
+			"    Number t = 2.0 * rho / H - 1.0;\n"
+			"    Length h = r - atmosphere.bottom_radius;\n"
+			"    Length rayleigh = d * exp(TransmittanceFitPolynomial(0, s, t) - h / atmosphere.rayleigh_scale_height);\n"
+			"    Length mie = d * exp(TransmittanceFitPolynomial(1, s, t) - h / atmosphere.mie_scale_height);\n"
+			"    return exp(-(atmosphere.rayleigh_scattering * rayleigh + atmosphere.mie_extinction * mie));\n"
+			"}\n"
+			"\n"
+			"DimensionlessSpectrum GetFittedTransmittanceToSun(\n"
+			"    in AtmosphereParameters atmosphere, Length r, Number mu_s)\n"
+			"{\n"
+			"    Number sin_theta_h = atmosphere.bottom_radius / r;\n"
+			"    Number cos_theta_h = -sqrt(max(1.0 - sin_theta_h * sin_theta_h, 0.0));\n"
+			"    return GetFittedTransmittanceToTopAtmosphereBoundary(atmosphere, r, mu_s) *\n"
+			"        smoothstep(-sin_theta_h * atmosphere.sun_angular_radius / rad,\n"
+			"            sin_theta_h * atmosphere.sun_angular_radius / rad,\n"
+			"            mu_s - cos_theta_h);\n"
+			"}\n");
+	}
+
+	bool write_file(const std::string& path, const transmittance_fit& fit, void (*write)(FILE*, const transmittance_fit&))
+	{
+		FILE* f = fopen(path.c_str(), "w");
+		if (!f) { fprintf(stderr, "cannot write %s\n", path.c_str()); return false; }
+		write(f, fit);
+		fclose(f);
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	std::string header_path, hlsl_path;
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "--header") && i + 1 < argc) header_path = argv[++i];
+		else if (!strcmp(argv[i], "--hlsl") && i + 1 < argc) hlsl_path = argv[++i];
+		else
+		{
+			fprintf(stderr, "usage: %s [--header AtmosphereFitEarth.h] [--hlsl bruneton_transmittance_fit.fx]\n", argv[0]);
+			return 2;
+		}
+	}
+
+	const atmosphere_parameters atmosphere = earth_atmosphere();
+	const transmittance_fit fit = fit_transmittance(atmosphere);
+	const transmittance_error error = measure_transmittance_error(atmosphere,
+		[&](float r, float mu) { return fitted_transmittance_to_top(fit, atmosphere, r, mu); });
+
+	printf("{\n");
+	printf("  \"degree\": %d,\n", transmittance_fit::degree);
+	printf("  \"max_error\": %.3e,\n", error.max_abs);
+	printf("  \"mean_error\": %.3e,\n", error.mean_abs);
+	printf("  \"max_relative_error\": %.3e\n", error.max_relative);
+	printf("}\n");
+
+	if (!header_path.empty() && !write_file(header_path, fit, write_header)) return 2;
+	if (!hlsl_path.empty() && !write_file(hlsl_path, fit, write_hlsl)) return 2;
+	return 0;
+}
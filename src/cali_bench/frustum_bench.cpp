@@ -0,0 +1,90 @@
+// 100k boxes around a camera tested against its frustum in ns per box, one at
+// a time as terrain_quad tested its nodes, and in arrays of double (IvDouble4)
+// and float (IvFloat8) boxes, with and without plane masks.
+#include "bench.h"
+
+#include <CaliMath.h>
+#include <Frustum.h>
+
+#include <IvDoubleVector3.h>
+#include <IvMath.h>
+#include <IvMatrix44.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct frustum_timing
+		{
+			size_t count = 0;
+			double single_ns = 0.0, double_ns = 0.0, float_ns = 0.0, masked_ns = 0.0;
+			// of the double boxes
+			double outside = 0.0, intersects = 0.0;
+		};
+
+		frustum_timing time_frustum(int iterations)
+		{
+			// camera::send_settings_to_renderer() and get_view_matrix() for a camera
+			// at the origin looking along +z; the far plane at 10 km
+			const float n = 0.1f, far_distance = 10000.0f, Q = far_distance / (far_distance - n), d = 1.0f / IvTan(kPI / 6.0f);
+			IvMatrix44 projection, view;
+			projection(0, 0) = d / (16.0f / 9.0f);
+			projection(1, 1) = d;
+			projection(2, 2) = Q;
+			projection(2, 3) = -n * Q;
+			projection(3, 2) = 1.0f;
+			projection(3, 3) = 0.0f;
+			cali::frustum f;
+			f.construct_frustum(projection, view);
+
+			const size_t count = 100000;
+			cali::box_array<double> boxes;
+			cali::box_array<float> float_boxes;
+			boxes.reserve(count);
+			float_boxes.reserve(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const IvDoubleVector3 center{ 8000.0 * sin(0.37 * i), 3000.0 * cos(0.11 * i), 8000.0 * sin(0.05 * i) };
+				const IvDoubleVector3 extents{ 10.0 + 200.0 * fabs(sin(0.7 * i)), 10.0 + 200.0 * fabs(cos(0.3 * i)), 50.0 };
+				boxes.push_back(center, extents);
+				float_boxes.push_back(center, extents);
+			}
+
+			frustum_timing t;
+			t.count = count;
+			const double per_box = 1e6 / (double)count;
+			std::vector<cali::containment> results(count);
+			std::vector<uint8_t> masks(count);
+			t.single_ns = per_box * time_ms(iterations, [&]() {
+				for (size_t i = 0; i < count; ++i)
+					results[i] = f.contains_aligned_bounding_box(float_boxes.center_x[i], float_boxes.center_y[i], float_boxes.center_z[i],
+						float_boxes.extent_x[i], float_boxes.extent_y[i], float_boxes.extent_z[i]) ? cali::containment::intersects : cali::containment::outside;
+			});
+			t.float_ns = per_box * time_ms(iterations, [&]() { f.classify_boxes(float_boxes, results.data()); });
+			t.masked_ns = per_box * time_ms(iterations, [&]() {
+				std::fill(masks.begin(), masks.end(), cali::frustum::all_planes);
+				f.classify_boxes(boxes, results.data(), masks.data());
+			});
+			t.double_ns = per_box * time_ms(iterations, [&]() { f.classify_boxes(boxes, results.data()); });
+
+			t.outside = (double)std::count(results.begin(), results.end(), cali::containment::outside) / count;
+			t.intersects = (double)std::count(results.begin(), results.end(), cali::containment::intersects) / count;
+			return t;
+		}
+	}
+
+	void bench_frustum(const options& opt, report& r)
+	{
+		const frustum_timing f = time_frustum(opt.iterations);
+		r.add("frustum_ns", format("{ \"boxes\": %zu, \"single\": %.2f, \"double_x4\": %.2f, \"float_x8\": %.2f, "
+			"\"double_x4_masked\": %.2f, \"outside\": %.3f, \"intersects\": %.3f }",
+			f.count, f.single_ns, f.double_ns, f.float_ns, f.masked_ns, f.outside, f.intersects));
+	}
+}
+}
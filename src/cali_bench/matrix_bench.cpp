@@ -0,0 +1,192 @@
+// The IvMatrix44 operations (multiply, affine inverse, transpose, vector and
+// point transforms) in ns each over arrays of operands, on the IvMath path of
+// the build (IvSIMD.h; configure with CALI_MATH_SIMD=SCALAR for the baseline),
+// and the batch vectors (IvVector3Batch.h) in ns per vector against IvVector3
+// and IvDoubleVector3 one at a time.
+#include "bench.h"
+
+#include <IvDoubleVector3.h>
+#include <IvMatrix44.h>
+#include <IvSIMD.h>
+#include <IvVector3Batch.h>
+#include <IvVector4.h>
+
+#include <cmath>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct matrix_timing
+		{
+			const char* path = "";
+			double multiply_ns = 0.0, affine_inverse_ns = 0.0, transpose_ns = 0.0, transform_vector_ns = 0.0;
+			double transform_point_ns = 0.0, transform_points_ns = 0.0; // one at a time and in a batch, per point
+		};
+
+		struct vector_batch_timing
+		{
+			// per vector: normalize(cross(a, lerp(a, b, t))) in float and double,
+			// normalize(transform_point(m, a)) in float
+			double float_scalar_ns = 0.0, float_x4_ns = 0.0, float_x8_ns = 0.0;
+			double double_scalar_ns = 0.0, double_x4_ns = 0.0, double_x8_ns = 0.0;
+			double transform_scalar_ns = 0.0, transform_x4_ns = 0.0, transform_x8_ns = 0.0;
+		};
+
+		matrix_timing time_matrix(int iterations)
+		{
+			const size_t count = 1024;
+			std::vector<IvMatrix44> a(count), b(count), result(count);
+			std::vector<IvVector4> vectors(count), transformed_vectors(count);
+			std::vector<IvVector3> points(count), transformed_points(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const float t = (float)i;
+				a[i].Rotation(IvVector3(sinf(t), cosf(t), 0.5f), 0.01f * t);
+				a[i](0, 3) = t;
+				b[i].Rotation(IvVector3(0.5f, sinf(t), cosf(t)), 0.02f * t);
+				b[i](1, 3) = -t;
+				vectors[i].Set(t, 1.0f - t, 0.5f * t, 1.0f);
+				points[i].Set(t, 2.0f * t, -t);
+			}
+
+			matrix_timing t;
+			t.path = IvSIMDPath();
+			// a few thousand passes over the arrays so the best run is well above the timer resolution
+			const int passes = 200;
+			const double ms_to_ns = 1e6 / ((double)count * passes);
+			t.multiply_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i) result[i] = a[i] * b[i];
+			});
+			t.affine_inverse_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i) result[i] = AffineInverse(a[i]);
+			});
+			t.transpose_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i) result[i] = Transpose(a[i]);
+			});
+			t.transform_vector_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i) transformed_vectors[i] = a[pass] * vectors[i];
+			});
+			t.transform_point_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i) transformed_points[i] = a[pass].TransformPoint(points[i]);
+			});
+			t.transform_points_ns = ms_to_ns * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					a[pass].TransformPoints(points.data(), transformed_points.data(), (unsigned int)count);
+			});
+			return t;
+		}
+
+		template <typename V, typename Scalar>
+		double time_vector_scalar(int iterations, const std::vector<V>& a, const std::vector<V>& b, std::vector<V>& out, Scalar t)
+		{
+			const int passes = 100;
+			return 1e6 / ((double)a.size() * passes) * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < a.size(); ++i)
+					{
+						V v = Cross(a[i], a[i] + (b[i] - a[i]) * t);
+						v.Normalize();
+						out[i] = v;
+					}
+			});
+		}
+
+		template <typename Batch, typename V>
+		double time_vector_batch(int iterations, const std::vector<V>& a, const std::vector<V>& b, std::vector<V>& out,
+			typename Batch::Scalar t)
+		{
+			const int passes = 100;
+			return 1e6 / ((double)a.size() * passes) * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < a.size(); i += Batch::Width)
+					{
+						Batch va, vb;
+						va.Load(&a[i]);
+						vb.Load(&b[i]);
+						Batch v = Cross(va, Lerp(va, vb, decltype(va.x)(t)));
+						v.Normalize();
+						v.Store(&out[i]);
+					}
+			});
+		}
+
+		template <typename Batch>
+		double time_transform_batch(int iterations, const IvMatrix44& m, const std::vector<IvVector3>& points, std::vector<IvVector3>& out)
+		{
+			const int passes = 100;
+			return 1e6 / ((double)points.size() * passes) * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					IvBatchTransform<Batch>(points.data(), out.data(), points.size(), [&](const Batch& p) {
+						Batch v = TransformPoint(m, p);
+						v.Normalize();
+						return v;
+					});
+			});
+		}
+
+		vector_batch_timing time_vector_batches(int iterations)
+		{
+			const size_t count = 1024; // a multiple of every batch width
+			std::vector<IvVector3> a(count), b(count), out(count);
+			std::vector<IvDoubleVector3> da(count), db(count), dout(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				const float t = (float)i;
+				a[i].Set(sinf(t), cosf(0.3f * t), t);
+				b[i].Set(1.0f - t, cosf(t), sinf(0.7f * t));
+				da[i] = a[i];
+				db[i] = b[i];
+			}
+			IvMatrix44 m;
+			m.Rotation(IvVector3(0.3f, -0.8f, 0.5f), 0.7f);
+			m(0, 3) = 10.0f;
+
+			vector_batch_timing t;
+			t.float_scalar_ns = time_vector_scalar(iterations, a, b, out, 0.25f);
+			t.float_x4_ns = time_vector_batch<IvVector3x4>(iterations, a, b, out, 0.25f);
+			t.float_x8_ns = time_vector_batch<IvVector3x8>(iterations, a, b, out, 0.25f);
+			t.double_scalar_ns = time_vector_scalar(iterations, da, db, dout, 0.25);
+			t.double_x4_ns = time_vector_batch<IvDoubleVector3x4>(iterations, da, db, dout, 0.25);
+			t.double_x8_ns = time_vector_batch<IvDoubleVector3x8>(iterations, da, db, dout, 0.25);
+			const int passes = 100;
+			t.transform_scalar_ns = 1e6 / ((double)count * passes) * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i)
+					{
+						IvVector3 v = m.TransformPoint(a[i]);
+						v.Normalize();
+						out[i] = v;
+					}
+			});
+			t.transform_x4_ns = time_transform_batch<IvVector3x4>(iterations, m, a, out);
+			t.transform_x8_ns = time_transform_batch<IvVector3x8>(iterations, m, a, out);
+			return t;
+		}
+	}
+
+	void bench_matrix(const options& opt, report& r)
+	{
+		const matrix_timing m = time_matrix(opt.iterations);
+		r.add("matrix44_ns", format("{ \"path\": \"%s\", \"multiply\": %.2f, \"affine_inverse\": %.2f, \"transpose\": %.2f, "
+			"\"transform_vector\": %.2f, \"transform_point\": %.2f, \"transform_points\": %.2f }",
+			m.path, m.multiply_ns, m.affine_inverse_ns, m.transpose_ns, m.transform_vector_ns, m.transform_point_ns,
+			m.transform_points_ns));
+
+		const vector_batch_timing v = time_vector_batches(opt.iterations);
+		r.add("vector_batch_ns", format("{ \"float\": { \"scalar\": %.2f, \"x4\": %.2f, \"x8\": %.2f }, "
+			"\"double\": { \"scalar\": %.2f, \"x4\": %.2f, \"x8\": %.2f }, "
+			"\"transform_float\": { \"scalar\": %.2f, \"x4\": %.2f, \"x8\": %.2f } }",
+			v.float_scalar_ns, v.float_x4_ns, v.float_x8_ns, v.double_scalar_ns, v.double_x4_ns, v.double_x8_ns,
+			v.transform_scalar_ns, v.transform_x4_ns, v.transform_x8_ns));
+	}
+}
+}
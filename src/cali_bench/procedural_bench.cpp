@@ -0,0 +1,154 @@
+// generate_heightmap split into its stages (noise, voronoi, shaping,
+// quantization), cube_sphere and the erosion pass in droplets per second on
+// one thread and on all of them, with the golden checksums of each.
+#include "bench.h"
+
+#include <Procedural.h>
+#include <ProceduralErosion.h>
+#include <ProceduralNoise.h>
+#include <procedural_golden.h>
+
+#include <string>
+#include <vector>
+
+using namespace cali::proc;
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct stage_timings
+		{
+			uint64_t seed = 0;
+			int size = 0;
+			double noise_ms = 0.0, voronoi_ms = 0.0, shaping_ms = 0.0, quantization_ms = 0.0;
+			double generate_heightmap_ms = 0.0; // the real, fused generator
+		};
+
+		struct erosion_timing
+		{
+			int size = 0;
+			erosion_stats stats; // of the fastest run
+		};
+
+		// generate_heightmap with one pass per stage over intermediate buffers; its
+		// output must match the fused generator byte for byte
+		stage_timings time_stages(uint64_t seed, int size, int iterations, std::vector<unsigned char>& rgb)
+		{
+			using namespace noise;
+			const int width = size, height = size;
+			const size_t count = (size_t)width * height;
+			std::vector<terrain_inputs> inputs(count);
+			std::vector<float> heights(count);
+			rgb.resize(count * 3);
+
+			const uint64_t seedDetail = splitmix64(seed + 0x123456789ABCDEF0ULL);
+			const uint64_t seedVorL = splitmix64(seed + 0xA5A5A5A5A5A5A5A5ULL);
+			const uint64_t seedVorS = splitmix64(seed + 0x5A5A5A5A5A5A5A5AULL);
+			const float cellLarge = (float)width / 7.0f;
+			const float cellSmall = (float)width / 28.0f;
+
+			stage_timings t;
+			t.seed = seed;
+			t.size = size;
+			t.noise_ms = time_ms(iterations, [&]() {
+				for (int y = 0; y < height; ++y) for (int x = 0; x < width; ++x)
+				{
+					terrain_inputs& in = inputs[(size_t)y * width + x];
+					in.continent = fbm_internal((float)x / width * 3.5f, (float)y / height * 3.5f, seed, 3, 0.42f, 2.0f, 4, 4);
+					in.detail = fbm_internal((float)x / width * 22.0f, (float)y / height * 22.0f, seedDetail, 2, 0.40f, 2.2f, 22, 22);
+				}
+			});
+			t.voronoi_ms = time_ms(iterations, [&]() {
+				for (int y = 0; y < height; ++y) for (int x = 0; x < width; ++x)
+				{
+					terrain_inputs& in = inputs[(size_t)y * width + x];
+					in.vor_large = voronoi((float)x, (float)y, cellLarge, seedVorL, width, height, &in.vor_border, &in.vor_cell);
+					in.vor_small = voronoi((float)x, (float)y, cellSmall, seedVorS, width, height);
+				}
+			});
+			t.shaping_ms = time_ms(iterations, [&]() {
+				for (size_t i = 0; i < count; ++i) heights[i] = shape_terrain(inputs[i]);
+			});
+			t.quantization_ms = time_ms(iterations, [&]() {
+				for (int y = 0; y < height; ++y) for (int x = 0; x < width; ++x)
+				{
+					size_t i = (size_t)y * width + x;
+					unsigned char v = quantize_height(heights[i], hash_coords(x, y, seed ^ 0x9E3779B97F4A7C15ULL));
+					rgb[i * 3 + 0] = v; rgb[i * 3 + 1] = v; rgb[i * 3 + 2] = v;
+				}
+			});
+			std::vector<unsigned char> fused;
+			t.generate_heightmap_ms = time_ms(iterations, [&]() { generate_heightmap(seed, width, height, fused); });
+			return t;
+		}
+
+		erosion_timing time_erosion(uint64_t seed, int size, int threads, int iterations)
+		{
+			std::vector<float> original, heights;
+			generate_heightmap_heights(seed, size, size, original);
+			erosion_params params;
+			params.threads = threads;
+
+			erosion_timing t;
+			t.size = size;
+			for (int i = 0; i < iterations; ++i)
+			{
+				heights = original;
+				erosion_stats stats;
+				erode_heightmap(seed, size, size, true, heights, params, &stats);
+				if (i == 0 || stats.seconds < t.stats.seconds) t.stats = stats;
+			}
+			return t;
+		}
+	}
+
+	void bench_procedural(const options& opt, report& r)
+	{
+		const int max_size = opt.quick ? 256 : 1024;
+
+		r.check("hash_string", 0, 0, hash_string("cali_planet_v1"), golden::c_planet_seed);
+		r.check("sample_fbm", golden::c_planet_seed, golden::c_sample_count, golden::sample_fbm_checksum(), golden::c_sample_fbm);
+		r.check("sample_voronoi", golden::c_planet_seed, golden::c_sample_count, golden::sample_voronoi_checksum(), golden::c_sample_voronoi);
+		r.check("sample_fbm_3d", golden::c_planet_seed, golden::c_sample_count, golden::sample_fbm_3d_checksum(), golden::c_sample_fbm_3d);
+
+		std::vector<std::string> timings;
+		for (const golden::heightmap_checksum& g : golden::c_heightmaps)
+		{
+			if (g.size > max_size) continue;
+			std::vector<unsigned char> fused, staged;
+			generate_heightmap(g.seed, g.size, g.size, fused);
+			r.check("generate_heightmap", g.seed, g.size, golden::fnv1a(fused.data(), fused.size()), g.fnv1a);
+
+			const stage_timings t = time_stages(g.seed, g.size, opt.iterations, staged);
+			r.check("staged_heightmap", g.seed, g.size, golden::fnv1a(staged.data(), staged.size()), g.fnv1a);
+			const double staged_total = t.noise_ms + t.voronoi_ms + t.shaping_ms + t.quantization_ms;
+			timings.push_back(format("{ \"seed\": %llu, \"size\": %d, \"noise\": %.3f, \"voronoi\": %.3f, \"shaping\": %.3f, "
+				"\"quantization\": %.3f, \"staged_total\": %.3f, \"generate_heightmap\": %.3f, \"mtexels_per_s\": %.3f }",
+				(unsigned long long)t.seed, t.size, t.noise_ms, t.voronoi_ms, t.shaping_ms, t.quantization_ms, staged_total,
+				t.generate_heightmap_ms, (double)t.size * t.size / (t.generate_heightmap_ms * 1000.0)));
+		}
+		r.add_array("heightmap_timings_ms", timings);
+
+		cube_sphere_heightmap hm;
+		const double cube_sphere_ms = time_ms(opt.iterations, [&]() { generate_cube_sphere_heightmap(golden::c_planet_seed, 65, hm); });
+		r.check("cube_sphere", golden::c_planet_seed, 65, golden::cube_sphere_checksum(hm), golden::c_cube_sphere_65);
+		r.add("cube_sphere_65_ms", format("%.3f", cube_sphere_ms));
+
+		r.check("eroded_heightmap", golden::c_planet_seed, 256, golden::eroded_heightmap_checksum(golden::c_planet_seed, 256),
+			golden::c_eroded_256);
+		std::vector<std::string> erosion;
+		for (int threads : thread_counts())
+		{
+			const erosion_timing t = time_erosion(golden::c_planet_seed, max_size, threads, opt.iterations);
+			const erosion_stats& e = t.stats;
+			erosion.push_back(format("{ \"size\": %d, \"threads\": %d, \"droplets\": %zu, \"tiles\": %zu, \"phases\": %d, "
+				"\"working_set_bytes\": %zu, \"ms\": %.3f, \"droplets_per_s\": %.0f }",
+				t.size, e.threads, e.droplets, e.tiles, e.phases, e.working_set_bytes, e.seconds * 1000.0, e.droplets_per_second()));
+		}
+		r.add_array("erosion", erosion);
+	}
+}
+}
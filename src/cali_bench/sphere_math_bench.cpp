@@ -0,0 +1,103 @@
+// The batched cube <-> sphere mappings (CaliSphereMathBatch.h) in ns per
+// point against the scalar CaliSphereMath.h functions, with their largest
+// difference in metres on an Earth-sized sphere.
+#include "bench.h"
+
+#include <CaliSphereMathBatch.h>
+
+#include <IvDoubleVector3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct sphere_batch_timing
+		{
+			// per point, scalar CaliSphereMath.h vs CaliSphereMathBatch.h, and the
+			// largest difference between the two in metres at R = 6360 km
+			double cube_to_sphere_scalar_ns = 0.0, cube_to_sphere_batch_ns = 0.0;
+			double sphere_to_cube_scalar_ns = 0.0, sphere_to_cube_batch_ns = 0.0;
+			double world_to_cube_scalar_ns = 0.0, world_to_cube_batch_ns = 0.0;
+			double max_error_m = 0.0;
+		};
+
+		sphere_batch_timing time_sphere_batches(int iterations)
+		{
+			using namespace cali::Math;
+			const size_t count = 4096;
+			const double R = 6360.0e3;
+			const IvDoubleVector3 C{ 0.0, 0.0, 0.0 };
+			std::vector<double> x(count), y(count), phi(count), theta(count), out_x(count), out_y(count);
+			std::vector<IvDoubleVector3> positions(count), normals(count), scalar_positions(count);
+			std::vector<CubeFace> faces(count);
+			for (size_t i = 0; i < count; ++i)
+			{
+				x[i] = R * sin(0.37 * (double)i);
+				y[i] = R * cos(0.11 * (double)i);
+			}
+
+			sphere_batch_timing t;
+			const int passes = 20;
+			const double per_point = 1e6 / ((double)count * passes);
+			t.cube_to_sphere_scalar_ns = per_point * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i)
+						scalar_positions[i] = adjusted_cube_to_sphere_face(CubeFace::PosX, x[i], y[i], R, C, normals[i]);
+			});
+			t.cube_to_sphere_batch_ns = per_point * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					adjusted_cube_to_sphere_face_batch(CubeFace::PosX, x.data(), y.data(), count, R, C, positions.data(), normals.data());
+			});
+			for (size_t i = 0; i < count; ++i)
+				t.max_error_m = std::max(t.max_error_m, (positions[i] - scalar_positions[i]).Length());
+
+			for (size_t i = 0; i < count; ++i)
+			{
+				const IvDoubleVector3 d = rotate_face_to_top(scalar_positions[i], CubeFace::PosX);
+				phi[i] = atan2(d.x, d.y);
+				theta[i] = asin(d.z / d.Length());
+			}
+			t.sphere_to_cube_scalar_ns = per_point * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i) adjusted_sphere_to_cube(phi[i], theta[i], R, out_x[i], out_y[i]);
+			});
+			const std::vector<double> scalar_x = out_x, scalar_y = out_y;
+			t.sphere_to_cube_batch_ns = per_point * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					adjusted_sphere_to_cube_batch(phi.data(), theta.data(), count, R, out_x.data(), out_y.data());
+			});
+			for (size_t i = 0; i < count; ++i)
+				t.max_error_m = std::max({ t.max_error_m, fabs(out_x[i] - scalar_x[i]), fabs(out_y[i] - scalar_y[i]) });
+
+			t.world_to_cube_scalar_ns = per_point * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < count; ++i) world_to_cube_face(scalar_positions[i], C, R, faces[i], out_x[i], out_y[i]);
+			});
+			const std::vector<double> world_x = out_x, world_y = out_y;
+			t.world_to_cube_batch_ns = per_point * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					world_to_cube_face_batch(scalar_positions.data(), count, C, R, faces.data(), out_x.data(), out_y.data());
+			});
+			for (size_t i = 0; i < count; ++i)
+				t.max_error_m = std::max({ t.max_error_m, fabs(out_x[i] - world_x[i]), fabs(out_y[i] - world_y[i]) });
+			return t;
+		}
+	}
+
+	void bench_sphere_math(const options& opt, report& r)
+	{
+		const sphere_batch_timing s = time_sphere_batches(opt.iterations);
+		r.add("sphere_batch_ns", format("{ \"cube_to_sphere\": { \"scalar\": %.2f, \"batch\": %.2f }, "
+			"\"sphere_to_cube\": { \"scalar\": %.2f, \"batch\": %.2f }, \"world_to_cube\": { \"scalar\": %.2f, \"batch\": %.2f }, "
+			"\"max_error_m\": %.3g }",
+			s.cube_to_sphere_scalar_ns, s.cube_to_sphere_batch_ns, s.sphere_to_cube_scalar_ns, s.sphere_to_cube_batch_ns,
+			s.world_to_cube_scalar_ns, s.world_to_cube_batch_ns, s.max_error_m));
+	}
+}
+}
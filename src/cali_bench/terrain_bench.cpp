@@ -0,0 +1,262 @@
+// The terrain patch corners (calculate_sphere_surface_quad) in ns per quad and
+// their displacement grid in ns per vertex; the corners made relative to the
+// eye in ns per corner, rounded to float before the subtraction (the old
+// uniforms) and in double by relative_to_eye_batch(), with the largest error
+// of each in metres on the small patches under the eye; and the patches of
+// all six faces culled from recorded camera positions, from near orbit to the
+// ground, with their axis-aligned boxes and with their oriented boxes
+// (PatchBounds.h), in ns per patch and the share culled by each, with the time
+// to fit an oriented box.
+#include "bench.h"
+
+#include <CaliMath.h>
+#include <CaliSphereMath.h>
+#include <Frustum.h>
+#include <PatchBounds.h>
+#include <RelativeToEye.h>
+#include <World.h>
+
+#include <IvDoubleVector3.h>
+#include <IvMath.h>
+#include <IvMatrix33.h>
+#include <IvMatrix44.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct terrain_corner_timing
+		{
+			// terrain_quad::calculate_sphere_surface_quad() per quad (five
+			// adjusted_cube_to_sphere_face and the centre quad_lerp), and the
+			// quad_lerp of its displacement grid per vertex
+			double corners_ns = 0.0, quad_lerp_ns = 0.0;
+			// the corners relative to an eye on the surface
+			double cast_first_ns = 0.0, relative_to_eye_ns = 0.0;
+			double cast_first_error_m = 0.0, relative_to_eye_error_m = 0.0;
+		};
+
+		struct patch_culling_timing
+		{
+			size_t patches = 0, cameras = 0;
+			double fit_us = 0.0; // per patch
+			double aabb_ns = 0.0, obb_ns = 0.0; // per patch and camera
+			// the share of patches culled, over all cameras
+			double aabb_culled = 0.0, obb_culled = 0.0;
+			// of the patches the axis-aligned boxes keep, the share the oriented ones cull
+			double obb_only = 0.0;
+		};
+
+		terrain_corner_timing time_terrain_corners(int iterations)
+		{
+			using namespace cali::Math;
+			const int count = 4096;
+			const double R = 6360.0e3;
+			const IvDoubleVector3 C{ 0.0, 0.0, 0.0 };
+			std::vector<IvDoubleVector3> corners(5 * count);
+
+			terrain_corner_timing t;
+			const int passes = 5;
+			t.corners_ns = 1e6 / ((double)count * passes) * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (int i = 0; i < count; ++i)
+					{
+						// quads of every level and face, as the quadtree visits them
+						const CubeFace face = (CubeFace)(i % 6);
+						const double half = R / (double)(1 << (i % 16));
+						const double cx = R * sin(0.37 * i) * 0.9, cy = R * cos(0.11 * i) * 0.9, overlap = half / 64.0;
+						IvDoubleVector3 normal, *q = &corners[5 * i];
+						q[0] = adjusted_cube_to_sphere_face(face, cx - half - overlap, cy + half + overlap, R, C, normal);
+						q[1] = adjusted_cube_to_sphere_face(face, cx + half + overlap, cy + half + overlap, R, C, normal);
+						q[2] = adjusted_cube_to_sphere_face(face, cx + half + overlap, cy - half - overlap, R, C, normal);
+						q[3] = adjusted_cube_to_sphere_face(face, cx - half - overlap, cy - half - overlap, R, C, normal);
+						q[4] = quad_lerp(q[0], q[1], q[2], q[3], 0.5, 0.5);
+					}
+			});
+
+			const int cells = 64;
+			std::vector<IvDoubleVector3> grid(cells * cells);
+			t.quad_lerp_ns = 1e6 / ((double)cells * cells * passes) * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+				{
+					const IvDoubleVector3* q = &corners[5 * pass];
+					for (int y = 0; y < cells; ++y)
+						for (int x = 0; x < cells; ++x)
+						{
+							const double u = (double)x / (cells - 1), v = (double)y / (cells - 1);
+							grid[y * cells + x] = quad_lerp(q[0], q[1], q[2], q[3], u, v);
+						}
+				}
+			});
+
+			// four corners a patch, as terrain_quad::render() sends them
+			std::vector<IvDoubleVector3> patch_corners;
+			for (int i = 0; i < count; ++i) patch_corners.insert(patch_corners.end(), &corners[5 * i], &corners[5 * i + 4]);
+			const IvDoubleVector3 eye = corners[4] + IvDoubleVector3{ 0.0, 0.0, 2.0 };
+			std::vector<IvVector3> offsets(patch_corners.size());
+			const double per_corner = 1e6 / ((double)patch_corners.size() * passes);
+			t.cast_first_ns = per_corner * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					for (size_t i = 0; i < patch_corners.size(); ++i) offsets[i] = (IvVector3)patch_corners[i] - (IvVector3)eye;
+			});
+			t.relative_to_eye_ns = per_corner * time_ms(iterations, [&]() {
+				for (int pass = 0; pass < passes; ++pass)
+					relative_to_eye_batch(patch_corners.data(), patch_corners.size(), eye, offsets.data());
+			});
+
+			// the error where it shows: the corners of the patches below 1.6 km, each seen from 2 m above its centre
+			for (int i = 0; i < count; ++i)
+			{
+				if (i % 16 < 12) continue;
+				const IvDoubleVector3* q = &corners[5 * i];
+				const IvDoubleVector3 above = q[4] + IvDoubleVector3{ 0.0, 0.0, 2.0 };
+				for (int c = 0; c < 4; ++c)
+				{
+					const IvDoubleVector3 exact = q[c] - above;
+					t.cast_first_error_m = std::max(t.cast_first_error_m, (IvDoubleVector3((IvVector3)q[c] - (IvVector3)above) - exact).Length());
+					t.relative_to_eye_error_m = std::max(t.relative_to_eye_error_m, (IvDoubleVector3(relative_to_eye(q[c], above)) - exact).Length());
+				}
+			}
+			return t;
+		}
+
+		patch_culling_timing time_patch_culling(int iterations)
+		{
+			using cali::Math::CubeFace;
+			const double radius = cali::world::c_earth_radius;
+			const IvDoubleVector3 planet(cali::world::c_earth_center);
+
+			// every face in 4 x 4 to 32 x 32 patches, as terrain_quad draws them at
+			// each distance; their axis-aligned boxes over a 17 x 17 grid of the
+			// same range of heights, so that only the orientation differs
+			cali::box_array<double> aabbs;
+			cali::oriented_box_array<double> obbs;
+			patch_culling_timing t;
+			double fit_ms = 0.0;
+			for (int per_side = 4; per_side <= 32; per_side *= 2)
+			{
+				const double size = 2.0 * radius / per_side;
+				for (int face = 0; face < 6; ++face)
+					for (int j = 0; j < per_side; ++j)
+						for (int i = 0; i < per_side; ++i)
+						{
+							const double x = -radius + size * i, y = -radius + size * j;
+							cali::patch_bounds b;
+							fit_ms += time_ms(1, [&]() { b = cali::fit_patch_bounds((CubeFace)face, x, y, x + size, y + size, radius, planet); });
+							obbs.push_back(b.center, b.rotation, b.extents);
+
+							IvDoubleVector3 lo(DBL_MAX, DBL_MAX, DBL_MAX), hi(-DBL_MAX, -DBL_MAX, -DBL_MAX);
+							for (int v = 0; v <= 16; ++v)
+								for (int u = 0; u <= 16; ++u)
+								{
+									IvDoubleVector3 normal;
+									const IvDoubleVector3 surface = cali::Math::adjusted_cube_to_sphere_face((CubeFace)face, x + size * u / 16,
+										y + size * v / 16, radius, planet, normal);
+									for (double height : { 0.0, cali::c_terrain_max_height })
+									{
+										const IvDoubleVector3 p = surface + normal * height;
+										lo = IvDoubleVector3(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+										hi = IvDoubleVector3(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+									}
+								}
+							aabbs.push_back((lo + hi) * 0.5, (hi - lo) * 0.5);
+						}
+			}
+			t.fit_us = 1e3 * fit_ms / obbs.size();
+
+			// recorded camera positions: a descent from near orbit to the ground
+			// over a tilted part of the planet, looking down, ahead and at the horizon
+			const float n = 0.1f, d = 1.0f / IvTan(kPI / 6.0f);
+			IvMatrix44 projection;
+			projection(0, 0) = d / (16.0f / 9.0f);
+			projection(1, 1) = d;
+			projection(2, 2) = 1.0f;
+			projection(2, 3) = -n;
+			projection(3, 2) = 1.0f;
+			projection(3, 3) = 0.0f;
+			std::vector<cali::frustum> cameras;
+			IvDoubleVector3 up_normal(0.6, 0.64, 0.48);
+			up_normal.Normalize();
+			for (double altitude : { 400000.0, 150000.0, 60000.0, 20000.0, 2000.0 })
+				for (double pitch : { 90.0, 45.0, 10.0 }) // below the horizon, in degrees
+				{
+					const IvDoubleVector3 position = planet + up_normal * (radius + altitude);
+					IvDoubleVector3 ahead = up_normal.Cross(IvDoubleVector3(0.0, 0.0, 1.0));
+					ahead.Normalize();
+					const double a = pitch * kPI / 180.0;
+					IvVector3 direction = (IvVector3)(ahead * cos(a) - up_normal * sin(a));
+					direction.Normalize();
+					IvVector3 right = ((IvVector3)up_normal).Cross(direction);
+					right.Normalize();
+					IvVector3 view_up = direction.Cross(right);
+					IvMatrix33 rotate;
+					rotate.SetRows(right, view_up, direction);
+					// the eye at the origin: the boxes relative to it would be as exact
+					IvMatrix44 view;
+					view.Rotation(rotate);
+					const IvDoubleVector3 eye(position);
+					const IvVector3 xlate = -(rotate * (IvVector3)eye);
+					view(0, 3) = xlate.x;
+					view(1, 3) = xlate.y;
+					view(2, 3) = xlate.z;
+					cameras.emplace_back();
+					cameras.back().construct_frustum(projection, view);
+				}
+			t.patches = obbs.size();
+			t.cameras = cameras.size();
+
+			std::vector<cali::containment> results(obbs.size()), aabb_results(obbs.size());
+			size_t aabb_culled = 0, obb_culled = 0, obb_only = 0;
+			const double per_test = 1e6 / ((double)obbs.size() * cameras.size());
+			t.aabb_ns = per_test * time_ms(iterations, [&]() {
+				aabb_culled = 0;
+				for (const cali::frustum& f : cameras)
+				{
+					f.classify_boxes(aabbs, results.data());
+					aabb_culled += std::count(results.begin(), results.end(), cali::containment::outside);
+				}
+			});
+			t.obb_ns = per_test * time_ms(iterations, [&]() {
+				obb_culled = 0;
+				for (const cali::frustum& f : cameras)
+				{
+					f.classify_oriented_boxes(obbs, results.data());
+					obb_culled += std::count(results.begin(), results.end(), cali::containment::outside);
+				}
+			});
+			for (const cali::frustum& f : cameras)
+			{
+				f.classify_boxes(aabbs, aabb_results.data());
+				f.classify_oriented_boxes(obbs, results.data());
+				for (size_t i = 0; i < obbs.size(); ++i)
+					obb_only += results[i] == cali::containment::outside && aabb_results[i] != cali::containment::outside;
+			}
+			t.aabb_culled = (double)aabb_culled / ((double)obbs.size() * cameras.size());
+			t.obb_culled = (double)obb_culled / ((double)obbs.size() * cameras.size());
+			t.obb_only = (double)obb_only / ((double)obbs.size() * cameras.size() - aabb_culled);
+			return t;
+		}
+	}
+
+	void bench_terrain(const options& opt, report& r)
+	{
+		const terrain_corner_timing c = time_terrain_corners(opt.iterations);
+		r.add("terrain_corner_ns", format("{ \"corners_per_quad\": %.2f, \"quad_lerp_per_vertex\": %.2f }", c.corners_ns, c.quad_lerp_ns));
+		r.add("relative_to_eye_ns", format("{ \"cast_first_per_corner\": %.2f, \"batch_per_corner\": %.2f, "
+			"\"cast_first_max_error_m\": %.3g, \"batch_max_error_m\": %.3g }",
+			c.cast_first_ns, c.relative_to_eye_ns, c.cast_first_error_m, c.relative_to_eye_error_m));
+
+		const patch_culling_timing p = time_patch_culling(opt.iterations);
+		r.add("patch_culling", format("{ \"patches\": %zu, \"cameras\": %zu, \"fit_us\": %.2f, \"aabb_ns\": %.2f, \"obb_ns\": %.2f, "
+			"\"aabb_culled\": %.3f, \"obb_culled\": %.3f, \"obb_only\": %.3f }",
+			p.patches, p.cameras, p.fit_us, p.aabb_ns, p.obb_ns, p.aabb_culled, p.obb_culled, p.obb_only));
+	}
+}
+}
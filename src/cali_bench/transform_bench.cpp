@@ -0,0 +1,129 @@
+// 100k transforms moved as stars::update() moves its stars, with physical's
+// eager matrix rebuild against transform_store's setters and one update(), on
+// one thread and on all of them.
+#include "bench.h"
+
+#include <TransformStore.h>
+
+#include <IvMath.h>
+#include <IvMatrix33.h>
+#include <IvMatrix44.h>
+#include <IvVector3.h>
+
+#include <cmath>
+#include <vector>
+
+namespace cali
+{
+namespace bench
+{
+	namespace
+	{
+		struct transform_timing
+		{
+			// per transform and frame: set_position and look_at, then the world
+			// matrix; physical rebuilds it in both setters, transform_store once in
+			// update(). update_ns alone with every transform dirty and with 1%
+			size_t count = 0;
+			int threads = 1;
+			double eager_ns = 0.0, store_ns = 0.0, update_ns = 0.0, sparse_update_ns = 0.0;
+		};
+
+		// physical (Renderable.cpp) before its matrix was lazy: every setter rebuilt it
+		struct eager_physical
+		{
+			IvMatrix44 model_matrix;
+			IvVector3 position{ 0.f, 0.f, 0.f }, direction{ 0.f, 0.f, 1.f }, right{ 1.f, 0.f, 0.f }, scale{ 1.f, 1.f, 1.f };
+
+			void calculate_model_matrix()
+			{
+				direction.Normalize();
+				right.Normalize();
+				IvVector3 up = direction.Cross(right);
+				up.Normalize();
+				model_matrix(0, 0) = right.x; model_matrix(0, 1) = up.x; model_matrix(0, 2) = direction.x;
+				model_matrix(1, 0) = right.y; model_matrix(1, 1) = up.y; model_matrix(1, 2) = direction.y;
+				model_matrix(2, 0) = right.z; model_matrix(2, 1) = up.z; model_matrix(2, 2) = direction.z;
+				model_matrix(0, 3) = position.x; model_matrix(1, 3) = position.y; model_matrix(2, 3) = position.z;
+				IvMatrix44 scale_matrix;
+				scale_matrix(0, 0) = scale.x;
+				scale_matrix(1, 1) = scale.y;
+				scale_matrix(2, 2) = scale.z;
+				model_matrix = model_matrix * scale_matrix;
+			}
+
+			void set_position(const IvVector3& p) { position = p; calculate_model_matrix(); }
+			void look_at(const IvVector3& point, const IvVector3& up)
+			{
+				IvVector3 d = point - position;
+				if (d == up)
+				{
+					d.x += kEpsilon * 1000.f;
+					d.y += kEpsilon * 1000.f;
+					d.z += kEpsilon * 1000.f;
+					d.Normalize();
+				}
+				direction = d;
+				right = up.Cross(direction);
+				calculate_model_matrix();
+			}
+		};
+
+		transform_timing time_transforms(int threads, int iterations)
+		{
+			const size_t count = 100000;
+			const IvVector3 center{ 0.f, -63600.f, 0.f }, up{ 0.f, 1.f, 0.f };
+			std::vector<IvVector3> positions(count);
+			for (size_t i = 0; i < count; ++i)
+				positions[i] = center + IvVector3{ 6.36e6f * sinf(0.37f * i), 6.36e6f * cosf(0.11f * i), 1e6f * sinf(0.05f * i) };
+
+			transform_timing t;
+			t.count = count;
+			t.threads = threads;
+			const double per_transform = 1e6 / (double)count;
+
+			std::vector<eager_physical> eager(count);
+			t.eager_ns = per_transform * time_ms(iterations, [&]() {
+				for (size_t i = 0; i < count; ++i)
+				{
+					eager[i].set_position(positions[i]);
+					eager[i].look_at(center, up);
+				}
+			});
+
+			cali::transform_store store(threads);
+			store.reserve(count);
+			for (size_t i = 0; i < count; ++i) store.set_scale(store.create(), 5000.0f);
+			t.store_ns = per_transform * time_ms(iterations, [&]() {
+				for (cali::transform_store::handle h = 0; h < count; ++h)
+				{
+					store.set_position(h, positions[h]);
+					store.look_at(h, center, up);
+				}
+				store.update();
+			});
+			t.update_ns = per_transform * time_ms(iterations, [&]() {
+				for (cali::transform_store::handle h = 0; h < count; ++h) store.set_scale(h, 5000.0f);
+				store.update();
+			});
+			t.sparse_update_ns = per_transform * time_ms(iterations, [&]() {
+				for (cali::transform_store::handle h = 0; h < count; h += 100) store.set_scale(h, 5000.0f);
+				store.update();
+			});
+			return t;
+		}
+	}
+
+	void bench_transforms(const options& opt, report& r)
+	{
+		std::vector<std::string> transforms;
+		for (int threads : thread_counts())
+		{
+			const transform_timing t = time_transforms(threads, opt.iterations);
+			transforms.push_back(format("{ \"transforms\": %zu, \"threads\": %d, \"eager\": %.2f, \"store\": %.2f, \"update\": %.2f, "
+				"\"sparse_update\": %.2f }", t.count, t.threads, t.eager_ns, t.store_ns, t.update_ns, t.sparse_update_ns));
+		}
+		r.add_array("transform_ns", transforms);
+	}
+}
+}
@@ -0,0 +1,898 @@
+#include <gtest.h>
+#include <Atmosphere.h>
+#include <AtmosphereAerialPerspective.h>
+#include <AtmosphereAmbient.h>
+#include <AtmosphereCache.h>
+#include <AtmosphereFitEarth.h>
+#include <AtmosphereFunctions.h>
+#include <AtmosphereQuery.h>
+
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+using namespace cali::atmosphere;
+
+namespace
+{
+	// small enough for the brute force shader functions to run in the test
+	lut_sizes small_sizes()
+	{
+		lut_sizes sizes;
+		sizes.transmittance_width = 64;
+		sizes.transmittance_height = 16;
+		sizes.scattering_r = 4;
+		sizes.scattering_mu = 16;
+		sizes.scattering_mu_s = 8;
+		sizes.scattering_nu = 4;
+		sizes.irradiance_width = 16;
+		sizes.irradiance_height = 4;
+		return sizes;
+	}
+
+	float max_component(const std::vector<rgba>& texels)
+	{
+		float m = 0.0f;
+		for (const rgba& t : texels) m = std::max(m, std::max(std::fabs(t.r), std::max(std::fabs(t.g), std::fabs(t.b))));
+		return m;
+	}
+
+	bool same_texels(const std::vector<rgba>& a, const std::vector<rgba>& b)
+	{
+		if (a.size() != b.size()) return false;
+		for (size_t i = 0; i < a.size(); ++i)
+			if (a[i].r != b[i].r || a[i].g != b[i].g || a[i].b != b[i].b || a[i].a != b[i].a) return false;
+		return true;
+	}
+
+	bool same_luts(const luts& a, const luts& b)
+	{
+		return same_texels(a.transmittance.texels, b.transmittance.texels) &&
+			same_texels(a.scattering.texels, b.scattering.texels) && same_texels(a.irradiance.texels, b.irradiance.texels);
+	}
+
+	// relative to the texel, with a floor at a fraction of the largest texel of
+	// the texture so that near-zero texels do not dominate
+	void expect_near(const rgba& actual, const rgba& expected, float scale, float tolerance, const char* what, int x, int y, int z)
+	{
+		const float a[3] = { actual.r, actual.g, actual.b }, e[3] = { expected.r, expected.g, expected.b };
+		for (int i = 0; i < 3; ++i)
+			ASSERT_NEAR(a[i], e[i], tolerance * std::max(std::fabs(e[i]), 1e-3f * scale))
+				<< what << " texel " << x << "," << y << "," << z << " channel " << i;
+	}
+
+	void frag_coord(const precompute_pipeline& p, int x, int y, int z, float& r, float& mu, float& mu_s, float& nu, bool& ground)
+	{
+		common::get_r_mu_mu_s_nu_from_scattering_texture_frag_coord(p.atmosphere(), p.sizes(),
+			(float)x + 0.5f, (float)y + 0.5f, (float)z + 0.5f, r, mu, mu_s, nu, ground);
+	}
+}
+
+TEST(atmosphere, transmittance_matches_the_closed_form_at_zenith)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	precompute_pipeline pipeline(atm, small_sizes());
+	for (int row = 0; row < pipeline.sizes().transmittance_height; ++row) pipeline.compute_transmittance(row);
+
+	// texel column 0 is mu = 1: the vertical optical depth of an exponential layer
+	for (int row = 0; row < pipeline.sizes().transmittance_height; ++row)
+	{
+		float r, mu;
+		common::get_r_mu_from_transmittance_texture_uv(atm, pipeline.sizes(), 0.5f / pipeline.sizes().transmittance_width,
+			(row + 0.5f) / pipeline.sizes().transmittance_height, r, mu);
+		ASSERT_NEAR(mu, 1.0f, 1e-5f);
+		auto depth = [&](float h) { return h * std::exp(-(r - atm.bottom_radius) / h) * (1.0f - std::exp(-(atm.top_radius - r) / h)); };
+		rgba expected = exp(rgba(0.0f) - (atm.rayleigh_scattering * depth(atm.rayleigh_scale_height) +
+			atm.mie_extinction * depth(atm.mie_scale_height)));
+		expect_near(pipeline.transmittance().at(0, row), expected, 1.0f, 1e-3f, "transmittance", 0, row, 0);
+		ASSERT_EQ(pipeline.transmittance().at(0, row).a, 1.0f);
+	}
+	// blue is attenuated most
+	const rgba horizon = pipeline.transmittance().at(pipeline.sizes().transmittance_width - 1, 0);
+	ASSERT_LT(horizon.b, horizon.r);
+}
+
+TEST(atmosphere, texture_coordinates_round_trip)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	const lut_sizes sizes;
+	for (float r : { 6360.0f, 6361.0f, 6400.0f, 6599.0f })
+		for (float mu : { -0.9f, -0.1f, 0.0f, 0.3f, 1.0f })
+		{
+			float u, v, r2, mu2;
+			common::get_transmittance_texture_uv_from_r_mu(atm, sizes, r, mu, u, v);
+			common::get_r_mu_from_transmittance_texture_uv(atm, sizes, u, v, r2, mu2);
+			ASSERT_NEAR(r2, r, 1e-2f);
+			ASSERT_NEAR(mu2, mu, 2e-3f);
+
+			for (float mu_s : { -0.1f, 0.1f, 0.8f })
+			{
+				const bool ground = common::ray_intersects_ground(atm, r, mu);
+				float uvwz[4], r3, mu3, mu_s3, nu3;
+				bool ground3;
+				common::get_scattering_texture_uvwz_from_r_mu_mu_s_nu(atm, sizes, r, mu, mu_s, 0.5f, ground, uvwz);
+				common::get_r_mu_mu_s_nu_from_scattering_texture_uvwz(atm, sizes, uvwz[0], uvwz[1], uvwz[2], uvwz[3],
+					r3, mu3, mu_s3, nu3, ground3);
+				ASSERT_NEAR(r3, r, 1e-2f);
+				ASSERT_NEAR(mu_s3, mu_s, 1e-3f);
+				ASSERT_NEAR(nu3, 0.5f, 1e-6f);
+				ASSERT_EQ(ground3, ground);
+				if (r > atm.bottom_radius) { ASSERT_NEAR(mu3, mu, 2e-3f) << r << " " << mu; }
+
+				common::get_irradiance_texture_uv_from_r_mu_s(atm, sizes, r, mu_s, u, v);
+				common::get_r_mu_s_from_irradiance_texture_uv(atm, sizes, u, v, r3, mu_s3);
+				ASSERT_NEAR(r3, r, 1e-2f);
+				ASSERT_NEAR(mu_s3, mu_s, 1e-5f);
+			}
+		}
+}
+
+// The passes hoist invariants out of the texel loops; every texel they write
+// has to match the shader function it replaces, evaluated on the same inputs.
+TEST(atmosphere, passes_match_the_shader_functions)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	const lut_sizes sizes = small_sizes();
+	precompute_pipeline p(atm, sizes);
+	const int w = sizes.scattering_width(), h = sizes.scattering_height(), d = sizes.scattering_depth();
+
+	for (int row = 0; row < sizes.transmittance_height; ++row) p.compute_transmittance(row);
+	for (int x = 0; x < sizes.transmittance_width; x += 5)
+	{
+		float r, mu;
+		common::get_r_mu_from_transmittance_texture_uv(atm, sizes, (x + 0.5f) / sizes.transmittance_width, 0.5f / sizes.transmittance_height, r, mu);
+		expect_near(p.transmittance().at(x, 0), common::compute_transmittance_to_top_atmosphere_boundary(atm, r, mu), 1.0f, 1e-5f,
+			"transmittance", x, 0, 0);
+	}
+
+	for (int row = 0; row < sizes.irradiance_height; ++row) p.compute_direct_irradiance(row);
+
+	for (int z = 0; z < d; ++z) p.compute_single_scattering(z);
+	const float rayleigh_scale = max_component(p.delta_rayleigh_scattering().texels);
+	const float mie_scale = max_component(p.delta_mie_scattering().texels);
+	for (int z = 0; z < d; ++z) for (int y = 0; y < h; ++y) for (int x = 0; x < w; ++x)
+	{
+		float r, mu, mu_s, nu;
+		bool ground;
+		frag_coord(p, x, y, z, r, mu, mu_s, nu, ground);
+		rgba rayleigh, mie;
+		common::compute_single_scattering(atm, sizes, p.transmittance(), r, mu, mu_s, nu, ground, rayleigh, mie);
+		expect_near(p.delta_rayleigh_scattering().at(x, y, z), rayleigh, rayleigh_scale, 1e-4f, "single rayleigh", x, y, z);
+		expect_near(p.delta_mie_scattering().at(x, y, z), mie, mie_scale, 1e-4f, "single mie", x, y, z);
+		ASSERT_EQ(p.scattering().at(x, y, z).a, p.delta_mie_scattering().at(x, y, z).r);
+	}
+
+	for (int order = 2; order <= 3; ++order)
+	{
+		for (int z = 0; z < d; ++z) p.compute_scattering_density(order, z);
+		const float density_scale = max_component(p.delta_scattering_density().texels);
+		for (int z = 0; z < d; ++z) for (int y = 0; y < h; y += 3) for (int x = 0; x < w; x += 5)
+		{
+			float r, mu, mu_s, nu;
+			bool ground;
+			frag_coord(p, x, y, z, r, mu, mu_s, nu, ground);
+			rgba expected = common::compute_scattering_density(atm, sizes, p.transmittance(), p.delta_rayleigh_scattering(),
+				p.delta_mie_scattering(), p.delta_rayleigh_scattering(), p.delta_irradiance(), r, mu, mu_s, nu, order);
+			expect_near(p.delta_scattering_density().at(x, y, z), expected, density_scale, 1e-4f, "density", x, y, z);
+		}
+
+		for (int row = 0; row < sizes.irradiance_height; ++row) p.compute_indirect_irradiance(order, row);
+		const float irradiance_scale = max_component(p.delta_irradiance().texels);
+		for (int row = 0; row < sizes.irradiance_height; ++row) for (int x = 0; x < sizes.irradiance_width; ++x)
+		{
+			float r, mu_s;
+			common::get_r_mu_s_from_irradiance_texture_uv(atm, sizes, (x + 0.5f) / sizes.irradiance_width,
+				(row + 0.5f) / sizes.irradiance_height, r, mu_s);
+			rgba expected = common::compute_indirect_irradiance(atm, sizes, p.delta_rayleigh_scattering(),
+				p.delta_mie_scattering(), p.delta_rayleigh_scattering(), r, mu_s, order - 1);
+			expect_near(p.delta_irradiance().at(x, row), expected, irradiance_scale, 1e-4f, "indirect irradiance", x, row, 0);
+		}
+
+		for (int z = 0; z < d; ++z) p.compute_multiple_scattering(order, z);
+		const float multiple_scale = max_component(p.delta_rayleigh_scattering().texels);
+		for (int z = 0; z < d; ++z) for (int y = 0; y < h; y += 2) for (int x = 0; x < w; x += 3)
+		{
+			float r, mu, mu_s, nu;
+			bool ground;
+			frag_coord(p, x, y, z, r, mu, mu_s, nu, ground);
+			rgba expected = common::compute_multiple_scattering(atm, sizes, p.transmittance(), p.delta_scattering_density(),
+				r, mu, mu_s, nu, ground);
+			expect_near(p.delta_rayleigh_scattering().at(x, y, z), expected, multiple_scale, 1e-4f, "multiple", x, y, z);
+		}
+	}
+}
+
+TEST(atmosphere, precompute_is_physically_plausible)
+{
+	const lut_sizes sizes = small_sizes();
+	luts single, all;
+	precompute(earth_atmosphere(), sizes, single, 1, 1);
+	precompute_stats stats;
+	precompute(earth_atmosphere(), sizes, all, c_scattering_orders, 1, &stats);
+	ASSERT_EQ(stats.threads, 1);
+	ASSERT_GT(stats.total_ms, 0.0);
+
+	for (size_t i = 0; i < all.scattering.texels.size(); ++i)
+	{
+		const rgba& s = all.scattering.texels[i];
+		ASSERT_TRUE(std::isfinite(s.r) && std::isfinite(s.g) && std::isfinite(s.b) && std::isfinite(s.a));
+		ASSERT_GE(s.r, 0.0f); ASSERT_GE(s.g, 0.0f); ASSERT_GE(s.b, 0.0f); ASSERT_GE(s.a, 0.0f);
+		// multiple scattering only adds light
+		ASSERT_GE(s.b, single.scattering.texels[i].b);
+	}
+	// the indirect irradiance only exists from the second order on
+	ASSERT_EQ(max_component(single.irradiance.texels), 0.0f);
+	ASSERT_GT(max_component(all.irradiance.texels), 0.0f);
+
+	// on the ground looking up with the sun high, rayleigh makes the sky blue
+	const atmosphere_parameters atm = earth_atmosphere();
+	const rgba zenith = common::get_scattering(atm, sizes, all.scattering, atm.bottom_radius, 1.0f, 0.9f, 0.9f, false);
+	ASSERT_GT(zenith.b, zenith.g);
+	ASSERT_GT(zenith.g, zenith.r);
+}
+
+TEST(atmosphere, precompute_is_independent_of_thread_count)
+{
+	luts one, three;
+	precompute(earth_atmosphere(), small_sizes(), one, 3, 1);
+	precompute(earth_atmosphere(), small_sizes(), three, 3, 3);
+	ASSERT_TRUE(same_luts(one, three));
+}
+
+TEST(atmosphere, precompute_can_be_cancelled)
+{
+	const std::atomic<bool> cancel{ true };
+	luts out;
+	ASSERT_FALSE(precompute(earth_atmosphere(), small_sizes(), out, c_scattering_orders, 1, nullptr, &cancel));
+	ASSERT_TRUE(out.scattering.texels.empty());
+}
+
+TEST(atmosphere, incremental_precompute_matches_precompute)
+{
+	const lut_sizes sizes = small_sizes();
+	luts expected, actual;
+	precompute(earth_atmosphere(), sizes, expected, 3, 1);
+
+	incremental_precompute incremental(earth_atmosphere(), sizes, 3);
+	const int rows_3d = sizes.scattering_depth() * sizes.scattering_height();
+	ASSERT_EQ(incremental.step_count(), sizes.transmittance_height + sizes.irradiance_height + rows_3d +
+		2 * (2 * rows_3d + sizes.irradiance_height));
+	ASSERT_THROW(incremental.take_luts(actual), std::logic_error);
+
+	// a zero budget still makes progress, one row per call
+	int calls = 0;
+	while (!incremental.advance(0.0)) ASSERT_EQ(incremental.steps_done(), ++calls);
+	ASSERT_EQ(calls + 1, incremental.step_count());
+	ASSERT_EQ(incremental.progress(), 1.0f);
+	ASSERT_FALSE(incremental.step());
+
+	incremental.take_luts(actual);
+	ASSERT_TRUE(same_luts(expected, actual));
+}
+
+TEST(atmosphere, analytic_luts_are_close_to_the_precomputed_ones)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	const lut_sizes sizes = small_sizes();
+	luts precomputed, analytic;
+	precompute(atm, sizes, precomputed, 1, 1);
+	analytic_luts(atm, sizes, analytic);
+
+	for (size_t i = 0; i < analytic.transmittance.texels.size(); ++i)
+	{
+		const rgba& a = analytic.transmittance.texels[i];
+		const rgba& e = precomputed.transmittance.texels[i];
+		ASSERT_NEAR(a.r, e.r, 0.06f);
+		ASSERT_NEAR(a.b, e.b, 0.06f);
+	}
+	for (const rgba& s : analytic.scattering.texels)
+	{
+		ASSERT_TRUE(std::isfinite(s.r) && std::isfinite(s.g) && std::isfinite(s.b) && std::isfinite(s.a));
+		ASSERT_GE(s.b, 0.0f); ASSERT_GE(s.a, 0.0f);
+	}
+	ASSERT_EQ(max_component(analytic.irradiance.texels), 0.0f);
+
+	const rgba zenith = common::get_scattering(atm, sizes, analytic.scattering, atm.bottom_radius, 1.0f, 0.9f, 0.9f, false);
+	const rgba expected = common::get_scattering(atm, sizes, precomputed.scattering, atm.bottom_radius, 1.0f, 0.9f, 0.9f, false);
+	ASSERT_GT(zenith.b, zenith.g);
+	ASSERT_GT(zenith.g, zenith.r);
+	ASSERT_NEAR(zenith.b, expected.b, 0.35f * expected.b);
+}
+
+TEST(atmosphere, lut_scheduler_swaps_in_complete_sets)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	const lut_sizes sizes = small_sizes();
+	lut_scheduler scheduler;
+	ASSERT_FALSE(scheduler.update(1.0));
+	ASSERT_EQ(scheduler.current(), nullptr);
+
+	// nothing to keep: the analytic set until the first one is complete
+	scheduler.begin(atm, sizes, 2);
+	const std::shared_ptr<const luts> fallback = scheduler.current();
+	ASSERT_NE(fallback, nullptr);
+	luts analytic;
+	analytic_luts(atm, sizes, analytic);
+	ASSERT_TRUE(same_luts(*fallback, analytic));
+
+	int frames = 0;
+	while (!scheduler.update(0.0))
+	{
+		ASSERT_EQ(scheduler.current(), fallback);
+		ASSERT_TRUE(scheduler.is_pending());
+		++frames;
+	}
+	ASSERT_GT(frames, 0);
+	ASSERT_FALSE(scheduler.is_pending());
+	const std::shared_ptr<const luts> earth = scheduler.current();
+	luts expected;
+	precompute(atm, sizes, expected, 2, 1);
+	ASSERT_TRUE(same_luts(*earth, expected));
+
+	// new parameters: the previous set stays until the new one is complete
+	atmosphere_parameters hazy = atm;
+	hazy.mie_scattering = rgba(0.01f, 0.01f, 0.01f);
+	scheduler.begin(hazy, sizes, 2);
+	ASSERT_EQ(scheduler.current(), earth);
+	ASSERT_FALSE(scheduler.update(0.0));
+	ASSERT_EQ(scheduler.current(), earth);
+	while (!scheduler.update(1000.0)) {}
+	ASSERT_NE(scheduler.current(), earth);
+	ASSERT_EQ(scheduler.progress(), 1.0f);
+}
+
+TEST(atmosphere, lut_scheduler_swaps_the_atmosphere_of_the_query)
+{
+	const atmosphere_parameters earth = earth_atmosphere();
+	const lut_sizes sizes = small_sizes();
+	auto precomputed = std::make_shared<luts>();
+	precompute(earth, sizes, *precomputed, 2);
+
+	// as bruneton does: the GPU set adopted, a query of the current set
+	lut_scheduler scheduler;
+	scheduler.adopt(earth, precomputed);
+	ASSERT_EQ(scheduler.current(), precomputed);
+	auto sky = [&scheduler]()
+	{
+		const atmosphere_query query(scheduler.current_atmosphere(), scheduler.current());
+		const IvVector3 camera(0.0f, 0.0f, query.atmosphere().bottom_radius + 0.5f);
+		return query.sky_radiance(camera, IvVector3(0.0f, 0.6f, 0.8f), IvVector3(0.0f, 0.8f, 0.6f));
+	};
+	const rgba clear = sky();
+
+	// the same planet: the earth sky until the hazy one is complete
+	atmosphere_parameters hazy = earth;
+	hazy.mie_scattering = rgba(0.02f, 0.02f, 0.02f);
+	hazy.mie_extinction = rgba(0.022f, 0.022f, 0.022f);
+	scheduler.begin(hazy, sizes, 2);
+	ASSERT_EQ(scheduler.current(), precomputed);
+	ASSERT_EQ(sky().b, clear.b);
+	while (!scheduler.update(1000.0)) {}
+	ASSERT_EQ(scheduler.current_atmosphere().mie_scattering.r, hazy.mie_scattering.r);
+	const rgba hazy_sky = sky();
+	ASSERT_GT(std::fabs(hazy_sky.r - clear.r), 0.1f * clear.r);
+
+	// another planet: its analytic sky right away, then the precomputed one
+	atmosphere_parameters small_planet = earth;
+	small_planet.bottom_radius = 3390.0f;
+	small_planet.top_radius = 3500.0f;
+	scheduler.begin(small_planet, sizes, 2);
+	ASSERT_TRUE(scheduler.is_pending());
+	ASSERT_EQ(scheduler.current_atmosphere().bottom_radius, small_planet.bottom_radius);
+	luts analytic;
+	analytic_luts(small_planet, sizes, analytic);
+	ASSERT_TRUE(same_luts(*scheduler.current(), analytic));
+	const rgba fallback_sky = sky();
+	ASSERT_NE(fallback_sky.r, hazy_sky.r);
+	while (!scheduler.update(1000.0)) {}
+	luts expected;
+	precompute(small_planet, sizes, expected, 2, 1);
+	ASSERT_TRUE(same_luts(*scheduler.current(), expected));
+	ASSERT_NE(sky().r, fallback_sky.r);
+}
+
+TEST(atmosphere, rejects_invalid_sizes)
+{
+	lut_sizes sizes = small_sizes();
+	sizes.scattering_mu = 15;
+	ASSERT_THROW(precompute_pipeline(earth_atmosphere(), sizes), std::invalid_argument);
+	luts out;
+	ASSERT_THROW(precompute(earth_atmosphere(), small_sizes(), out, 0), std::invalid_argument);
+	ASSERT_THROW(incremental_precompute(earth_atmosphere(), small_sizes(), 0), std::invalid_argument);
+}
+
+TEST(atmosphere, half_floats_round_to_nearest_even)
+{
+	ASSERT_EQ(float_to_half(0.0f), 0x0000);
+	ASSERT_EQ(float_to_half(-0.0f), 0x8000);
+	ASSERT_EQ(float_to_half(1.0f), 0x3c00);
+	ASSERT_EQ(float_to_half(-2.0f), 0xc000);
+	ASSERT_EQ(float_to_half(65504.0f), 0x7bff);
+	ASSERT_EQ(float_to_half(65520.0f), 0x7c00);
+	ASSERT_EQ(float_to_half(std::ldexp(1.0f, -24)), 0x0001);
+	ASSERT_EQ(float_to_half(std::ldexp(1.0f, -25)), 0x0000);
+	ASSERT_EQ(float_to_half(1.0f + std::ldexp(1.0f, -11)), 0x3c00); // tie, down to even
+	ASSERT_EQ(float_to_half(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3c02); // tie, up to even
+	ASSERT_TRUE(std::isnan(half_to_float(float_to_half(std::nanf("")))));
+	for (uint32_t h = 0; h < 0x10000; ++h)
+	{
+		if ((h & 0x7c00) == 0x7c00 && (h & 0x3ff)) continue; // nan
+		ASSERT_EQ(float_to_half(half_to_float((uint16_t)h)), h);
+	}
+}
+
+TEST(atmosphere, lut_cache_round_trip)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	const lut_sizes sizes = small_sizes();
+	luts luts;
+	precompute(atm, sizes, luts, 2);
+
+	auto dir = std::filesystem::temp_directory_path() / "cali_atmosphere_cache_test";
+	std::filesystem::remove_all(dir);
+	const cali::asset_cache cache(dir.string());
+	mapped_luts mapped;
+	ASSERT_FALSE(load_luts(cache, atm, sizes, 2, mapped));
+	ASSERT_TRUE(store_luts(cache, atm, luts, 2));
+	ASSERT_TRUE(load_luts(cache, atm, sizes, 2, mapped));
+	ASSERT_TRUE(mapped.is_open());
+
+	for (size_t i = 0; i < luts.scattering.texels.size(); ++i)
+	{
+		ASSERT_EQ(mapped.scattering()[i * 4 + 0], float_to_half(luts.scattering.texels[i].r));
+		ASSERT_EQ(mapped.scattering()[i * 4 + 3], float_to_half(luts.scattering.texels[i].a));
+	}
+	const size_t last = luts.irradiance.texels.size() - 1;
+	ASSERT_EQ(mapped.transmittance()[2], float_to_half(luts.transmittance.texels[0].b));
+	ASSERT_EQ(mapped.irradiance()[last * 4 + 1], float_to_half(luts.irradiance.texels[last].g));
+
+	// halves read back from the GPU go through unpack_luts: storing those
+	// again writes the same entry
+	const std::string path = cache.entry_path(lut_cache_key(atm, sizes, 2));
+	const auto file_bytes = [&]() {
+		std::ifstream file(path, std::ios::binary);
+		return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	};
+	const std::vector<char> stored = file_bytes();
+	cali::atmosphere::luts unpacked;
+	unpack_luts(sizes, mapped.transmittance(), mapped.scattering(), mapped.irradiance(), unpacked);
+	mapped.close();
+	ASSERT_TRUE(store_luts(cache, atm, unpacked, 2));
+	ASSERT_EQ(file_bytes(), stored);
+
+	// anything the LUTs depend on is part of the key
+	atmosphere_parameters hazy = atm;
+	hazy.mie_scattering = rgba(0.01f, 0.01f, 0.01f);
+	lut_sizes larger = sizes;
+	larger.scattering_nu = 8;
+	ASSERT_FALSE(load_luts(cache, hazy, sizes, 2, mapped));
+	ASSERT_FALSE(load_luts(cache, atm, larger, 2, mapped));
+	ASSERT_FALSE(load_luts(cache, atm, sizes, 4, mapped));
+
+	// a damaged entry is a miss
+	std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+	ASSERT_FALSE(load_luts(cache, atm, sizes, 2, mapped));
+	ASSERT_FALSE(mapped.is_open());
+	std::filesystem::remove_all(dir);
+}
+
+TEST(atmosphere, rgb9e5_matches_the_shared_exponent_format)
+{
+	ASSERT_EQ(float3_to_rgb9e5(0.0f, 0.0f, 0.0f), 0u);
+	ASSERT_EQ(float3_to_rgb9e5(1.0f, 0.0f, 0.0f), 256u | (16u << 27));
+	ASSERT_EQ(float3_to_rgb9e5(-1.0f, std::nanf(""), 1.0f), (256u << 18) | (16u << 27));
+	ASSERT_EQ(float3_to_rgb9e5(1e9f, 0.0f, 0.0f), 511u | (31u << 27));
+
+	float r, g, b;
+	rgb9e5_to_float3(float3_to_rgb9e5(1e9f, 0.5f, 0.0f), r, g, b);
+	ASSERT_EQ(r, 65408.0f);
+	ASSERT_EQ(g, 0.0f); // below half a step of the largest channel
+	rgb9e5_to_float3(float3_to_rgb9e5(511.6f, 0.0f, 0.0f), r, g, b);
+	ASSERT_EQ(r, 512.0f); // rounding up carries into the exponent
+
+	for (int i = 0; i < 1000; ++i)
+	{
+		const float in[3] = { std::ldexp(0.001f * (float)((i * 7919) % 1000), i % 20 - 10),
+			std::ldexp(0.001f * (float)((i * 104729) % 1000), i % 13 - 8), 0.001f * (float)i };
+		float out[3];
+		const uint32_t packed = float3_to_rgb9e5(in[0], in[1], in[2]);
+		rgb9e5_to_float3(packed, out[0], out[1], out[2]);
+		const float half_step = std::ldexp(1.0f, (int)(packed >> 27) - 25);
+		for (int c = 0; c < 3; ++c) ASSERT_LE(std::fabs(out[c] - in[c]), half_step) << i << " channel " << c;
+	}
+}
+
+TEST(atmosphere, compact_scattering_splits_the_combined_texels)
+{
+	luts luts;
+	precompute(earth_atmosphere(), small_sizes(), luts, 2);
+	const std::vector<rgba>& texels = luts.scattering.texels;
+
+	std::vector<uint32_t> rgb(texels.size()), rgb_from_half(texels.size());
+	std::vector<uint16_t> mie(texels.size()), mie_from_half(texels.size());
+	compact_scattering(texels, rgb.data(), mie.data());
+
+	std::vector<uint16_t> half(texels.size() * 4);
+	for (size_t i = 0; i < texels.size(); ++i)
+	{
+		half[i * 4 + 0] = float_to_half(texels[i].r);
+		half[i * 4 + 1] = float_to_half(texels[i].g);
+		half[i * 4 + 2] = float_to_half(texels[i].b);
+		half[i * 4 + 3] = float_to_half(texels[i].a);
+	}
+	compact_scattering(half.data(), texels.size(), rgb_from_half.data(), mie_from_half.data());
+
+	for (size_t i = 0; i < texels.size(); ++i)
+	{
+		ASSERT_EQ(mie[i], float_to_half(texels[i].a));
+		ASSERT_EQ(mie_from_half[i], mie[i]);
+		// the channels share the exponent of the largest one, 2^-24 is the
+		// smallest step
+		const rgba& t = texels[i];
+		const float step = std::max(std::ldexp(std::max(t.r, std::max(t.g, t.b)), -8), std::ldexp(1.0f, -24));
+		float a[3], b[3];
+		rgb9e5_to_float3(rgb[i], a[0], a[1], a[2]);
+		rgb9e5_to_float3(rgb_from_half[i], b[0], b[1], b[2]);
+		const float e[3] = { t.r, t.g, t.b };
+		for (int c = 0; c < 3; ++c)
+		{
+			ASSERT_NEAR(a[c], e[c], step) << "texel " << i << " channel " << c;
+			ASSERT_NEAR(b[c], e[c], step) << "texel " << i << " channel " << c;
+		}
+	}
+}
+
+TEST(atmosphere, gpu_lut_memory_of_the_default_sizes)
+{
+	const lut_sizes sizes;
+	const size_t scattering = 256 * 128 * 32;
+	const lut_memory full = gpu_lut_memory(sizes, false);
+	const lut_memory compact = gpu_lut_memory(sizes, true);
+
+	ASSERT_EQ(full.transmittance, 256u * 64 * 8);
+	ASSERT_EQ(full.irradiance, 64u * 16 * 8);
+	ASSERT_EQ(full.scattering, scattering * 8);
+	ASSERT_EQ(full.intermediates, 64 * 16 * 8 + 3 * scattering * 8);
+	ASSERT_EQ(compact.scattering, scattering * 6);
+	ASSERT_EQ(compact.intermediates, full.intermediates + scattering * 8);
+	ASSERT_LT(compact.resident(), full.resident());
+}
+
+TEST(atmosphere, query_matches_the_shader_functions)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	auto precomputed = std::make_shared<luts>();
+	precompute(atm, small_sizes(), *precomputed, 2);
+	const atmosphere_query query(atm, precomputed);
+	const lut_sizes& sizes = precomputed->sizes;
+
+	const float scattering_scale = max_component(precomputed->scattering.texels);
+	const float irradiance_scale = max_component(precomputed->irradiance.texels);
+	auto unit = [](float x, float y, float z)
+	{
+		IvVector3 v(x, y, z);
+		v.Normalize();
+		return v;
+	};
+	// on the ground, in the atmosphere, above it
+	const float altitudes[] = { 0.0f, 0.5f, 12.0f, 59.0f, 200.0f };
+	std::vector<IvVector3> view_rays;
+	for (int i = 0; i < 64; ++i)
+		view_rays.push_back(unit(cosf(0.7f * i), 1.6f * (float)i / 63.0f - 0.8f, sinf(0.7f * i)));
+
+	for (float altitude : altitudes)
+	{
+		for (int s = 0; s < 8; ++s)
+		{
+			const IvVector3 camera(0.0f, atm.bottom_radius + altitude, 0.0f);
+			const IvVector3 sun_direction = unit(0.3f, 1.1f - 0.3f * (float)s, 0.2f);
+			const float camera_f[3] = { camera.x, camera.y, camera.z }, sun_f[3] = { sun_direction.x, sun_direction.y, sun_direction.z };
+
+			std::vector<rgba> radiance(view_rays.size()), transmittance(view_rays.size());
+			query.sky_radiance(camera, view_rays.data(), view_rays.size(), sun_direction, radiance.data(), transmittance.data());
+			for (size_t i = 0; i < view_rays.size(); ++i)
+			{
+				const float ray_f[3] = { view_rays[i].x, view_rays[i].y, view_rays[i].z };
+				rgba expected_transmittance, single_transmittance;
+				const rgba expected = common::get_sky_radiance(atm, sizes, precomputed->transmittance, precomputed->scattering,
+					camera_f, ray_f, sun_f, expected_transmittance);
+				const rgba single = query.sky_radiance(camera, view_rays[i], sun_direction, &single_transmittance);
+				expect_near(radiance[i], expected, scattering_scale, 1e-4f, "sky radiance", (int)altitude, s, (int)i);
+				expect_near(single, radiance[i], scattering_scale, 1e-5f, "single ray", (int)altitude, s, (int)i);
+				expect_near(transmittance[i], expected_transmittance, 1.0f, 1e-4f, "transmittance", (int)altitude, s, (int)i);
+			}
+
+			const float r = camera.Length();
+			const float mu_s = camera.Dot(sun_direction) / r;
+			expect_near(query.sun_transmittance(camera, sun_direction),
+				common::get_transmittance_to_sun(atm, sizes, precomputed->transmittance, r, mu_s), 1.0f, 1e-5f, "sun", (int)altitude, s, 0);
+
+			const IvVector3 normal = unit(0.2f, 1.0f, -0.1f);
+			const float normal_f[3] = { normal.x, normal.y, normal.z };
+			rgba sky, expected_sky;
+			const rgba sun = query.sun_and_sky_irradiance(camera, normal, sun_direction, sky);
+			const rgba expected_sun = common::get_sun_and_sky_irradiance(atm, sizes, precomputed->transmittance,
+				precomputed->irradiance, camera_f, normal_f, sun_f, expected_sky);
+			expect_near(sun, expected_sun, 1.0f, 1e-4f, "sun irradiance", (int)altitude, s, 0);
+			expect_near(sky, expected_sky, irradiance_scale, 1e-4f, "sky irradiance", (int)altitude, s, 0);
+		}
+	}
+
+	// the sun sets: full transmittance at noon, none once below the horizon
+	const IvVector3 ground(0.0f, atm.bottom_radius, 0.0f);
+	const rgba noon = query.sun_transmittance(ground, IvVector3(0.0f, 1.0f, 0.0f));
+	const rgba night = query.sun_transmittance(ground, unit(1.0f, -0.1f, 0.0f));
+	ASSERT_GT(noon.b, 0.5f);
+	ASSERT_GT(noon.r, noon.b);
+	ASSERT_EQ(night.r, 0.0f);
+	ASSERT_THROW(atmosphere_query(atm, nullptr), std::invalid_argument);
+}
+
+TEST(atmosphere, sky_radiance_to_point_matches_the_shader_function)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	auto precomputed = std::make_shared<luts>();
+	precompute(atm, small_sizes(), *precomputed, 2);
+	const atmosphere_query query(atm, precomputed);
+	const lut_sizes& sizes = precomputed->sizes;
+	const float scattering_scale = max_component(precomputed->scattering.texels);
+
+	const float altitudes[] = { 0.5f, 12.0f, 200.0f };
+	const float distances[] = { 0.1f, 1.0f, 10.0f, 60.0f, 150.0f, 400.0f };
+	const size_t distance_count = sizeof(distances) / sizeof(distances[0]);
+	IvVector3 sun_direction(0.3f, 0.5f, 0.2f);
+	sun_direction.Normalize();
+	const float sun_f[3] = { sun_direction.x, sun_direction.y, sun_direction.z };
+	for (float altitude : altitudes)
+	{
+		const IvVector3 camera(0.0f, atm.bottom_radius + altitude, 0.0f);
+		const float camera_f[3] = { camera.x, camera.y, camera.z };
+		for (int i = 0; i < 16; ++i)
+		{
+			IvVector3 view_ray(cosf(0.9f * i), 0.5f - (float)i / 15.0f, sinf(0.9f * i));
+			view_ray.Normalize();
+			rgba radiance[distance_count], transmittance[distance_count];
+			query.sky_radiance_to_points(camera, view_ray, distances, distance_count, sun_direction, radiance, transmittance);
+			for (size_t k = 0; k < distance_count; ++k)
+			{
+				const IvVector3 point = camera + view_ray * distances[k];
+				const float point_f[3] = { point.x, point.y, point.z };
+				rgba expected_transmittance, single_transmittance;
+				const rgba expected = common::get_sky_radiance_to_point(atm, sizes, precomputed->transmittance,
+					precomputed->scattering, camera_f, point_f, sun_f, expected_transmittance);
+				const rgba single = query.sky_radiance_to_point(camera, point, sun_direction, single_transmittance);
+				// a difference of two lookups, so less precise than sky_radiance
+				expect_near(single, expected, scattering_scale, 1e-3f, "radiance to point", (int)altitude, i, (int)k);
+				expect_near(single_transmittance, expected_transmittance, 1.0f, 1e-4f, "transmittance to point", (int)altitude, i, (int)k);
+
+				// sharing the camera end changes nothing
+				rgba alone, alone_transmittance;
+				query.sky_radiance_to_points(camera, view_ray, distances + k, 1, sun_direction, &alone, &alone_transmittance);
+				expect_near(radiance[k], alone, scattering_scale, 1e-6f, "batch", (int)altitude, i, (int)k);
+				expect_near(transmittance[k], alone_transmittance, 1.0f, 1e-6f, "batch transmittance", (int)altitude, i, (int)k);
+			}
+		}
+	}
+}
+
+TEST(atmosphere, aerial_perspective_is_deterministic)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	auto analytic = std::make_shared<luts>();
+	analytic_luts(atm, small_sizes(), *analytic);
+	const atmosphere_query query(atm, analytic);
+
+	froxel_camera camera;
+	camera.position = IvVector3(0.0f, atm.bottom_radius + 0.3f, 0.0f);
+	camera.forward = IvVector3(0.0f, -0.1f, 1.0f);
+	camera.forward.Normalize();
+	camera.right = IvVector3(1.0f, 0.0f, 0.0f);
+	camera.up = camera.forward.Cross(camera.right);
+	camera.tan_half_fov_x = 0.77f;
+	camera.tan_half_fov_y = 0.58f;
+	IvVector3 sun_direction(0.2f, 0.4f, 0.8f);
+	sun_direction.Normalize();
+
+	aerial_perspective one_thread(8, 6, 5, 100.0f, 1), three_threads(8, 6, 5, 100.0f, 3);
+	ASSERT_EQ(three_threads.threads(), 3);
+	one_thread.compute(query, camera, sun_direction);
+	three_threads.compute(query, camera, sun_direction);
+	ASSERT_TRUE(same_texels(one_thread.in_scattering().texels, three_threads.in_scattering().texels));
+	ASSERT_TRUE(same_texels(one_thread.transmittance().texels, three_threads.transmittance().texels));
+	// the workers pick the next frame up
+	const std::vector<rgba> first = three_threads.in_scattering().texels;
+	three_threads.compute(query, camera, sun_direction);
+	ASSERT_TRUE(same_texels(first, three_threads.in_scattering().texels));
+
+	const float scale = max_component(first);
+	ASSERT_GT(scale, 0.0f);
+	for (int z = 0; z < 5; ++z)
+	{
+		ASSERT_NEAR(one_thread.depth_coordinate(one_thread.slice_distance(z)), (z + 0.5f) / 5.0f, 1e-6f);
+		for (int y = 0; y < 6; ++y)
+			for (int x = 0; x < 8; ++x)
+			{
+				if (z > 0) { ASSERT_LE(one_thread.transmittance().at(x, y, z).b, one_thread.transmittance().at(x, y, z - 1).b); }
+				const float distance = one_thread.slice_distance(z);
+				rgba radiance, transmittance;
+				query.sky_radiance_to_points(camera.position, one_thread.view_ray(camera, x, y), &distance, 1, sun_direction,
+					&radiance, &transmittance);
+				expect_near(one_thread.in_scattering().at(x, y, z), radiance, scale, 1e-6f, "froxel", x, y, z);
+				expect_near(one_thread.transmittance().at(x, y, z), transmittance, 1.0f, 1e-6f, "froxel transmittance", x, y, z);
+			}
+	}
+	ASSERT_THROW(aerial_perspective(0, 32, 32), std::invalid_argument);
+}
+
+TEST(atmosphere, sh9_projection_reconstructs_l2_functions)
+{
+	const std::vector<IvVector3> directions = sphere_directions(256);
+	for (const IvVector3& d : directions) ASSERT_NEAR(d.Length(), 1.0f, 1e-5f);
+
+	// a band limited function comes back, up to the error of the quadrature
+	auto radiance = [](const IvVector3& d) { return rgba(1.0f + 0.5f * d.y, 0.6f + 0.3f * d.x * d.z, 0.4f + 0.2f * (3.0f * d.z * d.z - 1.0f)); };
+	std::vector<rgba> values;
+	for (const IvVector3& d : directions) values.push_back(radiance(d));
+	const sh9 sh = project_sh9(directions.data(), values.data(), values.size());
+	for (const IvVector3& d : sphere_directions(97))
+		expect_near(sh.evaluate(d), radiance(d), 1.0f, 0.01f, "l2 function", 0, 0, 0);
+
+	// uniform radiance L: irradiance pi L whatever the normal
+	std::vector<rgba> uniform(directions.size(), rgba(2.0f, 1.0f, 0.5f));
+	const sh9 irradiance = project_sh9(directions.data(), uniform.data(), uniform.size()).irradiance();
+	const float pi = 3.14159265f;
+	for (const IvVector3& n : sphere_directions(31))
+		expect_near(irradiance.evaluate(n), rgba(2.0f * pi, pi, 0.5f * pi), 1.0f, 1e-3f, "uniform", 0, 0, 0);
+}
+
+TEST(atmosphere, sky_ambient_matches_the_integrated_sky_irradiance)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	auto precomputed = std::make_shared<luts>();
+	precompute(atm, small_sizes(), *precomputed, 2);
+	auto query = std::make_shared<const atmosphere_query>(atm, precomputed);
+
+	const IvVector3 camera(0.0f, atm.bottom_radius + 0.5f, 0.0f);
+	IvVector3 sun_direction(0.5f, 0.6f, 0.2f);
+	sun_direction.Normalize();
+	sky_ambient ambient;
+	ASSERT_FALSE(ambient.is_valid());
+	ASSERT_TRUE(ambient.update(query, camera, sun_direction));
+
+	// reference: the cosine weighted sky radiance over a dense direction set
+	const std::vector<IvVector3> dense = sphere_directions(16384);
+	std::vector<rgba> radiance(dense.size());
+	query->sky_radiance(camera, dense.data(), dense.size(), sun_direction, radiance.data());
+	const float pi = 3.14159265f;
+	float largest = 0.0f;
+	std::vector<rgba> expected;
+	const std::vector<IvVector3> normals = sphere_directions(26);
+	for (const IvVector3& n : normals)
+	{
+		rgba e;
+		for (size_t i = 0; i < dense.size(); ++i) e += radiance[i] * (std::max)(n.Dot(dense[i]), 0.0f);
+		expected.push_back(e * (4.0f * pi / (float)dense.size()));
+		largest = std::max(largest, expected.back().b);
+	}
+	// L2 keeps the cosine lobe to a few percent, the error is measured
+	// against the brightest normal
+	for (size_t i = 0; i < normals.size(); ++i)
+	{
+		const rgba actual = ambient.irradiance().evaluate(normals[i]);
+		const float e[3] = { expected[i].r, expected[i].g, expected[i].b }, a[3] = { actual.r, actual.g, actual.b };
+		for (int c = 0; c < 3; ++c) ASSERT_NEAR(a[c], e[c], 0.04f * largest) << "normal " << i << " channel " << c;
+	}
+
+	// projected again only past the thresholds
+	IvVector3 moved = sun_direction + IvVector3(0.001f, 0.0f, 0.0f);
+	moved.Normalize();
+	ASSERT_FALSE(ambient.update(query, camera, moved));
+	ASSERT_FALSE(ambient.update(query, camera + IvVector3(0.0f, 0.5f, 0.0f), sun_direction));
+	moved = sun_direction + IvVector3(0.05f, 0.0f, 0.0f);
+	moved.Normalize();
+	ASSERT_TRUE(ambient.update(query, camera, moved));
+	ASSERT_TRUE(ambient.update(query, camera + IvVector3(0.0f, 2.0f, 0.0f), moved));
+	ASSERT_TRUE(ambient.update(std::make_shared<const atmosphere_query>(atm, precomputed), camera, moved));
+	ASSERT_EQ(ambient.projections(), 4);
+}
+
+TEST(atmosphere, lut_tiers_trade_memory_for_resolution)
+{
+	const lut_sizes defaults;
+	const lut_sizes high = lut_sizes_for(lut_tier::high);
+	ASSERT_EQ(lut_cache_key(earth_atmosphere(), high, c_scattering_orders),
+		lut_cache_key(earth_atmosphere(), defaults, c_scattering_orders));
+	ASSERT_STREQ(lut_tier_name(lut_tier::medium), "medium");
+
+	size_t previous = 0;
+	for (lut_tier tier : { lut_tier::low, lut_tier::medium, lut_tier::high })
+	{
+		const lut_sizes sizes = lut_sizes_for(tier);
+		ASSERT_EQ(sizes.scattering_mu % 2, 0) << lut_tier_name(tier);
+		const size_t resident = gpu_lut_memory(sizes, false).resident();
+		ASSERT_GT(resident, previous) << lut_tier_name(tier);
+		previous = resident;
+	}
+}
+
+TEST(atmosphere, compare_luts_falls_with_the_resolution)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	auto make_query = [&](const lut_sizes& sizes)
+	{
+		auto analytic = std::make_shared<luts>();
+		analytic_luts(atm, sizes, *analytic);
+		return atmosphere_query(atm, analytic);
+	};
+	lut_sizes coarse = small_sizes(), fine = small_sizes(), finest = small_sizes();
+	fine.scattering_r *= 2; fine.scattering_mu *= 2; fine.scattering_mu_s *= 2; fine.transmittance_height *= 2;
+	finest.scattering_r *= 4; finest.scattering_mu *= 4; finest.scattering_mu_s *= 4; finest.transmittance_height *= 4;
+	const atmosphere_query reference = make_query(finest);
+
+	const lut_error none = compare_luts(reference, reference);
+	ASSERT_EQ(none.sky_radiance.max, 0.0f);
+	ASSERT_EQ(none.transmittance.max, 0.0f);
+	ASSERT_GT(none.sky_radiance.samples, 0u);
+
+	const lut_error coarse_error = compare_luts(make_query(coarse), reference);
+	const lut_error fine_error = compare_luts(make_query(fine), reference);
+	ASSERT_GT(fine_error.sky_radiance.mean, 0.0f);
+	ASSERT_LT(fine_error.sky_radiance.mean, coarse_error.sky_radiance.mean);
+	ASSERT_LT(fine_error.transmittance.mean, coarse_error.transmittance.mean);
+	ASSERT_LE(coarse_error.sky_radiance.mean, coarse_error.sky_radiance.p95);
+	ASSERT_LE(coarse_error.sky_radiance.p95, coarse_error.sky_radiance.max);
+}
+
+TEST(atmosphere, earth_transmittance_fit_is_current)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	const transmittance_fit& earth = earth_transmittance_fit();
+	ASSERT_TRUE(earth.fits(atm));
+	atmosphere_parameters taller = atm;
+	taller.top_radius += 10.0f;
+	ASSERT_FALSE(earth.fits(taller));
+
+	// AtmosphereFitEarth.h is what cali_fit_transmittance writes today
+	const transmittance_fit fit = fit_transmittance(atm);
+	for (int i = 0; i < transmittance_fit::coefficient_count; ++i)
+	{
+		ASSERT_NEAR(fit.rayleigh[i], earth.rayleigh[i], 1e-4f * std::max(1.0f, std::fabs(earth.rayleigh[i]))) << i;
+		ASSERT_NEAR(fit.mie[i], earth.mie[i], 1e-4f * std::max(1.0f, std::fabs(earth.mie[i]))) << i;
+	}
+
+	const transmittance_error error = measure_transmittance_error(atm,
+		[&](float r, float mu) { return fitted_transmittance_to_top(earth, atm, r, mu); });
+	ASSERT_LE(error.max_abs, 1.01f * earth.max_error);
+	ASSERT_LE(error.mean_abs, 1.01f * earth.mean_error);
+	ASSERT_LT(earth.max_error, 1e-2f);
+	ASSERT_LT(earth.mean_error, 1e-3f);
+}
+
+TEST(atmosphere, fitted_transmittance_batch_matches_the_scalar_path)
+{
+	const atmosphere_parameters atm = earth_atmosphere();
+	const transmittance_fit& fit = earth_transmittance_fit();
+	// not a multiple of four, and r outside the atmosphere on both ends
+	const size_t count = 103;
+	std::vector<float> r(count), mu(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		r[i] = atm.bottom_radius - 1.0f + (atm.top_radius - atm.bottom_radius + 2.0f) * (float)i / (float)(count - 1);
+		mu[i] = std::cos(0.61f * (float)i);
+	}
+	std::vector<rgba> batch(count);
+	fitted_transmittance_to_top(fit, atm, r.data(), mu.data(), count, batch.data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		const rgba scalar = fitted_transmittance_to_top(fit, atm, r[i], mu[i]);
+		expect_near(batch[i], scalar, 1.0f, 1e-4f, "batch", (int)i, 0, 0);
+		ASSERT_EQ(batch[i].a, 1.0f);
+	}
+
+	// the sun is gone below the horizon, whole above it
+	const float r_ground = atm.bottom_radius + 0.1f;
+	ASSERT_EQ(fitted_transmittance_to_sun(fit, atm, r_ground, -0.2f).r, 0.0f);
+	const rgba high_sun = fitted_transmittance_to_sun(fit, atm, r_ground, 0.5f);
+	expect_near(high_sun, fitted_transmittance_to_top(fit, atm, r_ground, 0.5f), 1.0f, 1e-6f, "sun", 0, 0, 0);
+}
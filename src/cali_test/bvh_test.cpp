@@ -0,0 +1,233 @@
+#include <gtest.h>
+#include <BVH.h>
+
+#include <IvMath.h>
+#include <IvMatrix33.h>
+#include <IvMatrix44.h>
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using cali::bvh;
+using cali::containment;
+using cali::frustum;
+
+// Every query against a test of every object; more objects than one
+// build task holds, so the tree is spliced from several
+namespace
+{
+	std::vector<IvAABB> random_boxes(size_t count, unsigned int seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> position(-1000.0f, 1000.0f), size(0.0f, 20.0f);
+		std::vector<IvAABB> boxes;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvVector3 lo(position(rng), position(rng), position(rng));
+			boxes.emplace_back(lo, lo + IvVector3(size(rng), size(rng), size(rng)));
+		}
+		return boxes;
+	}
+
+	std::vector<bvh::index> sorted(std::vector<bvh::index> hits)
+	{
+		std::sort(hits.begin(), hits.end());
+		return hits;
+	}
+
+	bool overlaps(const IvAABB& a, const IvAABB& b)
+	{
+		for (unsigned int i = 0; i < 3; ++i)
+			if (a.GetMinima()[i] > b.GetMaxima()[i] || a.GetMaxima()[i] < b.GetMinima()[i]) return false;
+		return true;
+	}
+
+	bool overlaps(const IvAABB& a, const IvBoundingSphere& s)
+	{
+		float distance_squared = 0.0f;
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			const float c = s.GetCenter()[i];
+			const float d = std::max(std::max(a.GetMinima()[i] - c, c - a.GetMaxima()[i]), 0.0f);
+			distance_squared += d * d;
+		}
+		return distance_squared <= s.GetRadius() * s.GetRadius();
+	}
+
+	bool hit(const IvAABB& a, const IvRay3& ray, float max_distance)
+	{
+		float t_min = 0.0f, t_max = max_distance;
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			const float o = ray.GetOrigin()[i], d = ray.GetDirection()[i];
+			if (d == 0.0f)
+			{
+				if (o < a.GetMinima()[i] || o > a.GetMaxima()[i]) return false;
+				continue;
+			}
+			float t0 = (a.GetMinima()[i] - o) * (1.0f / d), t1 = (a.GetMaxima()[i] - o) * (1.0f / d);
+			if (t0 > t1) std::swap(t0, t1);
+			t_min = std::max(t_min, t0);
+			t_max = std::min(t_max, t1);
+			if (t_min > t_max) return false;
+		}
+		return true;
+	}
+
+	bool visible(const frustum& f, const IvAABB& a)
+	{
+		const IvVector3& lo = a.GetMinima();
+		const IvVector3& hi = a.GetMaxima();
+		const IvDoubleVector3 center(0.5 * ((double)lo.x + hi.x), 0.5 * ((double)lo.y + hi.y), 0.5 * ((double)lo.z + hi.z));
+		const IvDoubleVector3 extents(0.5 * ((double)hi.x - lo.x), 0.5 * ((double)hi.y - lo.y), 0.5 * ((double)hi.z - lo.z));
+		return f.classify_box(center, extents) != containment::outside;
+	}
+
+	template <typename Test>
+	std::vector<bvh::index> brute_force(const std::vector<IvAABB>& boxes, const Test& test)
+	{
+		std::vector<bvh::index> hits;
+		for (size_t i = 0; i < boxes.size(); ++i)
+			if (test(boxes[i])) hits.push_back((bvh::index)i);
+		return hits;
+	}
+
+	// A camera at position looking along direction, 60 degrees, to far
+	frustum view_from(const IvVector3& position, IvVector3 direction, float far_distance)
+	{
+		const float d = 1.0f / IvTan(60.0f / 180.0f * kPI * 0.5f);
+		const float near_distance = 1.0f, Q = far_distance / (far_distance - near_distance);
+		IvMatrix44 projection;
+		projection(0, 0) = d;
+		projection(1, 1) = d;
+		projection(2, 2) = Q;
+		projection(2, 3) = -near_distance * Q;
+		projection(3, 2) = 1.0f;
+		projection(3, 3) = 0.0f;
+
+		direction.Normalize();
+		IvVector3 right = IvVector3(0.0f, 1.0f, 0.0f).Cross(direction);
+		right.Normalize();
+		IvVector3 up = direction.Cross(right);
+		IvMatrix33 rotate;
+		rotate.SetRows(right, up, direction);
+		const IvVector3 xlate = -(rotate * position);
+		IvMatrix44 view;
+		view.Rotation(rotate);
+		view(0, 3) = xlate.x;
+		view(1, 3) = xlate.y;
+		view(2, 3) = xlate.z;
+
+		frustum f;
+		f.construct_frustum(projection, view);
+		return f;
+	}
+
+	void expect_queries_match(const bvh& tree, const std::vector<IvAABB>& boxes, unsigned int seed)
+	{
+		std::mt19937 rng(seed);
+		std::uniform_real_distribution<float> position(-1100.0f, 1100.0f), size(0.0f, 200.0f), unit(-1.0f, 1.0f);
+		std::vector<bvh::index> hits;
+		for (int i = 0; i < 20; ++i)
+		{
+			const IvVector3 lo(position(rng), position(rng), position(rng));
+			const IvAABB box(lo, lo + IvVector3(size(rng), size(rng), size(rng)));
+			tree.query(box, hits);
+			EXPECT_EQ(sorted(hits), brute_force(boxes, [&](const IvAABB& a) { return overlaps(a, box); })) << i;
+
+			const IvBoundingSphere sphere(IvVector3(position(rng), position(rng), position(rng)), size(rng));
+			tree.query(sphere, hits);
+			EXPECT_EQ(sorted(hits), brute_force(boxes, [&](const IvAABB& a) { return overlaps(a, sphere); })) << i;
+
+			// one ray in four along an axis, which the slabs of the other two must hold
+			IvVector3 direction(unit(rng), unit(rng), unit(rng));
+			if (i % 4 == 0) direction = IvVector3(0.0f, 0.0f, 1.0f);
+			const IvRay3 ray(IvVector3(position(rng), position(rng), position(rng)), direction);
+			const float max_distance = 10.0f * size(rng);
+			tree.query(ray, max_distance, hits);
+			EXPECT_EQ(sorted(hits), brute_force(boxes, [&](const IvAABB& a) { return hit(a, ray, max_distance); })) << i;
+
+			const frustum f = view_from(IvVector3(position(rng), position(rng), position(rng)),
+				IvVector3(unit(rng), unit(rng), unit(rng)), 200.0f + 5.0f * size(rng));
+			tree.query(f, hits);
+			EXPECT_EQ(sorted(hits), brute_force(boxes, [&](const IvAABB& a) { return visible(f, a); })) << i;
+		}
+	}
+}
+
+TEST(bvh, queries_match_every_object_tested)
+{
+	const std::vector<IvAABB> boxes = random_boxes(50000, 1);
+	bvh tree;
+	tree.build(boxes);
+	EXPECT_EQ(tree.size(), boxes.size());
+	EXPECT_EQ(tree.node_count() % 2, 1u);
+	EXPECT_LT(tree.depth(), 64u);
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		EXPECT_LE(tree.bounds().GetMinima()[i], -990.0f);
+		EXPECT_GE(tree.bounds().GetMaxima()[i], 990.0f);
+	}
+	expect_queries_match(tree, boxes, 2);
+}
+
+TEST(bvh, the_tree_does_not_depend_on_the_thread_count)
+{
+	const std::vector<IvAABB> boxes = random_boxes(50000, 3);
+	bvh one(1), four(4);
+	one.build(boxes);
+	four.build(boxes);
+	EXPECT_EQ(one.node_count(), four.node_count());
+	EXPECT_EQ(one.depth(), four.depth());
+	EXPECT_EQ(one.memory_bytes(), four.memory_bytes());
+
+	// the same tree finds the same objects in the same order
+	std::vector<bvh::index> one_hits, four_hits;
+	const IvAABB box(IvVector3(-300.0f, -300.0f, -300.0f), IvVector3(300.0f, 300.0f, 300.0f));
+	one.query(box, one_hits);
+	four.query(box, four_hits);
+	EXPECT_FALSE(one_hits.empty());
+	EXPECT_EQ(one_hits, four_hits);
+}
+
+TEST(bvh, refit_follows_the_objects)
+{
+	std::vector<IvAABB> boxes = random_boxes(20000, 4);
+	bvh tree;
+	tree.build(boxes);
+
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> step(-50.0f, 50.0f);
+	for (IvAABB& box : boxes)
+	{
+		const IvVector3 offset(step(rng), step(rng), step(rng));
+		box.Set(box.GetMinima() + offset, box.GetMaxima() + offset);
+	}
+	tree.refit(boxes);
+	expect_queries_match(tree, boxes, 6);
+
+	boxes.pop_back();
+	EXPECT_THROW(tree.refit(boxes), std::invalid_argument);
+}
+
+TEST(bvh, few_objects_and_none)
+{
+	bvh tree;
+	std::vector<bvh::index> hits;
+	tree.build(std::vector<IvAABB>());
+	EXPECT_EQ(tree.size(), 0u);
+	tree.query(IvAABB(IvVector3(-1.0f, -1.0f, -1.0f), IvVector3(1.0f, 1.0f, 1.0f)), hits);
+	EXPECT_TRUE(hits.empty());
+
+	// identical boxes, which no SAH bin separates
+	const std::vector<IvAABB> same(100, IvAABB(IvVector3(0.0f, 0.0f, 0.0f), IvVector3(1.0f, 1.0f, 1.0f)));
+	tree.build(same);
+	EXPECT_EQ(tree.size(), 100u);
+	tree.query(IvBoundingSphere(IvVector3(0.5f, 0.5f, 0.5f), 0.1f), hits);
+	EXPECT_EQ(hits.size(), 100u);
+	tree.query(IvBoundingSphere(IvVector3(5.0f, 0.5f, 0.5f), 1.0f), hits);
+	EXPECT_TRUE(hits.empty());
+	EXPECT_GT(tree.depth(), 0u);
+}
@@ -0,0 +1,204 @@
+#include <gtest.h>
+#include <FastMath.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using cali::fastmath::accuracy;
+
+// Sampled error of every function and tier against the double precision libm,
+// in float ulp of the reference, with the bounds stated in FastMath.h; the
+// array forms must give the scalar bits.
+namespace
+{
+	const int c_samples = 1 << 16;
+
+	double ulp_of(double v)
+	{
+		v = std::fabs(v);
+		if (v < FLT_MIN) return std::ldexp(1.0, -149);
+		int e;
+		std::frexp(v, &e);
+		return std::ldexp(1.0, e - 24);
+	}
+
+	struct function_error
+	{
+		double max_ulp = 0.0;
+		int mismatches = 0; // array form vs scalar form
+		uint64_t hash = 0xcbf29ce484222325ull;
+	};
+
+	void add(function_error& error, float value, float array_value, double reference)
+	{
+		uint32_t bits, array_bits;
+		memcpy(&bits, &value, sizeof(bits));
+		memcpy(&array_bits, &array_value, sizeof(array_bits));
+		if (bits != array_bits) ++error.mismatches;
+		error.hash = (error.hash ^ bits) * 0x100000001b3ull;
+		error.max_ulp = std::max(error.max_ulp, std::fabs((double)value - reference) / ulp_of(reference));
+	}
+
+	// x uniform in [lo, hi], or 2^e (1 + f) with the integer e uniform in [lo, hi)
+	// and f in [0, 1). mt19937 is specified exactly and the rest is exact or
+	// correctly rounded, so every standard library gives the same samples.
+	std::vector<float> samples(uint32_t seed, double lo, double hi, bool exponential)
+	{
+		std::mt19937 rng(seed);
+		std::vector<float> x(c_samples);
+		for (float& v : x)
+		{
+			const double u = lo + (hi - lo) * (rng() * (1.0 / 4294967296.0));
+			v = (float)(exponential ? std::ldexp(1.0 + rng() * (1.0 / 4294967296.0), (int)std::floor(u)) : u);
+		}
+		return x;
+	}
+
+	template <accuracy A>
+	function_error measure(float (*scalar)(float), void (*array)(const float*, float*, size_t), double (*reference)(double),
+		double lo, double hi, bool exponential = false)
+	{
+		const std::vector<float> x = samples(1, lo, hi, exponential);
+		std::vector<float> out(x.size());
+		array(x.data(), out.data(), x.size() - 3); // a partial last batch
+		out[x.size() - 3] = out[x.size() - 2] = out[x.size() - 1] = 0.0f;
+		array(x.data() + x.size() - 3, out.data() + x.size() - 3, 3);
+
+		function_error error;
+		for (size_t i = 0; i < x.size(); ++i) add(error, scalar(x[i]), out[i], reference(x[i]));
+		return error;
+	}
+
+	template <accuracy A>
+	function_error measure_atan2()
+	{
+		const std::vector<float> y = samples(2, -10.0, 10.0, false), x = samples(3, -10.0, 10.0, false);
+		std::vector<float> out(x.size());
+		cali::fastmath::atan2<A>(y.data(), x.data(), out.data(), x.size());
+		function_error error;
+		for (size_t i = 0; i < x.size(); ++i)
+			add(error, cali::fastmath::atan2<A>(y[i], x[i]), out[i], std::atan2((double)y[i], (double)x[i]));
+		return error;
+	}
+
+	// |y ln x| <= 78
+	template <accuracy A>
+	function_error measure_pow()
+	{
+		const std::vector<float> x = samples(4, -28.0, 28.0, true), y = samples(5, -4.0, 4.0, false);
+		std::vector<float> out(x.size());
+		cali::fastmath::pow<A>(x.data(), y.data(), out.data(), x.size());
+		function_error error;
+		for (size_t i = 0; i < x.size(); ++i)
+			add(error, cali::fastmath::pow<A>(x[i], y[i]), out[i], std::pow((double)x[i], (double)y[i]));
+		return error;
+	}
+
+	double reference_sin(double x) { return std::sin(x); }
+	double reference_cos(double x) { return std::cos(x); }
+	double reference_tan(double x) { return std::tan(x); }
+	double reference_atan(double x) { return std::atan(x); }
+	double reference_asin(double x) { return std::asin(x); }
+	double reference_acos(double x) { return std::acos(x); }
+	double reference_exp(double x) { return std::exp(x); }
+	double reference_log(double x) { return std::log(x); }
+
+	struct tier_bounds
+	{
+		double sin_cos, tan, atan, asin_acos, exp, log, pow;
+	};
+
+	// FastMath.h's table
+	template <accuracy A> tier_bounds bounds();
+	template <> tier_bounds bounds<accuracy::fast>() { return { 80.0, 128.0, 32.0, 112.0, 176.0, 8.0, 256.0 }; }
+	template <> tier_bounds bounds<accuracy::medium>() { return { 3.0, 4.0, 3.0, 3.0, 2.0, 2.0, 1.0 }; }
+	template <> tier_bounds bounds<accuracy::exact>() { return { 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0 }; }
+
+	// Checks every function of a tier, returns the hash of all their results
+	template <accuracy A>
+	uint64_t check_tier(const char* tier)
+	{
+		using namespace cali::fastmath;
+		const tier_bounds b = bounds<A>();
+		struct named { const char* name; function_error error; double bound; };
+		const named functions[] = {
+			{ "sin", measure<A>(sin<A>, sin<A>, reference_sin, -4096.0, 4096.0), b.sin_cos },
+			{ "sin near 0", measure<A>(sin<A>, sin<A>, reference_sin, -1e-3, 1e-3), b.sin_cos },
+			{ "cos", measure<A>(cos<A>, cos<A>, reference_cos, -4096.0, 4096.0), b.sin_cos },
+			{ "tan", measure<A>(tan<A>, tan<A>, reference_tan, -4096.0, 4096.0), b.tan },
+			{ "atan", measure<A>(atan<A>, atan<A>, reference_atan, -100.0, 100.0), b.atan },
+			{ "atan2", measure_atan2<A>(), b.atan },
+			{ "asin", measure<A>(asin<A>, asin<A>, reference_asin, -1.0, 1.0), b.asin_acos },
+			{ "acos", measure<A>(acos<A>, acos<A>, reference_acos, -1.0, 1.0), b.asin_acos },
+			{ "exp", measure<A>(exp<A>, exp<A>, reference_exp, -104.0, 88.7), b.exp },
+			{ "log", measure<A>(log<A>, log<A>, reference_log, -149.0, 128.0, true), b.log },
+			{ "pow", measure_pow<A>(), b.pow },
+		};
+		uint64_t hash = 0;
+		for (const named& f : functions)
+		{
+			EXPECT_LE(f.error.max_ulp, f.bound) << tier << " " << f.name;
+			EXPECT_EQ(f.error.mismatches, 0) << tier << " " << f.name;
+			hash = (hash ^ f.error.hash) * 0x100000001b3ull;
+		}
+		if (A == accuracy::exact)
+		{
+			EXPECT_LE(measure<A>(sin<A>, sin<A>, reference_sin, -1048576.0, 1048576.0).max_ulp, b.sin_cos) << "sin to 2^20";
+			EXPECT_LE(measure<A>(tan<A>, tan<A>, reference_tan, -1048576.0, 1048576.0).max_ulp, b.tan) << "tan to 2^20";
+		}
+		return hash;
+	}
+}
+
+TEST(fastmath, errors_are_within_the_stated_bounds)
+{
+	check_tier<accuracy::fast>("fast");
+	check_tier<accuracy::medium>("medium");
+	check_tier<accuracy::exact>("exact");
+}
+
+TEST(fastmath, results_are_the_same_bits_on_every_build)
+{
+	// IEEE operations only and no fma contraction: any compiler and any
+	// CALI_MATH_SIMD path must reproduce these
+	EXPECT_EQ(check_tier<accuracy::fast>("fast"), 0x7b8968579e6d930cull);
+	EXPECT_EQ(check_tier<accuracy::medium>("medium"), 0x6dc5ba2818ffb724ull);
+	EXPECT_EQ(check_tier<accuracy::exact>("exact"), 0x3bc92bf0842455e5ull);
+}
+
+TEST(fastmath, special_values)
+{
+	using namespace cali::fastmath;
+	const float pi = 3.14159265358979323846f;
+	EXPECT_EQ(sin(0.0f), 0.0f);
+	EXPECT_EQ(cos(0.0f), 1.0f);
+	EXPECT_EQ(tan(0.0f), 0.0f);
+	EXPECT_EQ(atan(0.0f), 0.0f);
+	EXPECT_EQ(atan2(0.0f, 0.0f), 0.0f);
+	EXPECT_EQ(atan2(1.0f, 0.0f), pi / 2.0f);
+	EXPECT_EQ(atan2(0.0f, -1.0f), pi);
+	EXPECT_EQ(atan2(-1.0f, -1.0f), -3.0f * pi / 4.0f);
+	EXPECT_EQ(asin(1.0f), pi / 2.0f);
+	EXPECT_EQ(asin(-1.0f), -pi / 2.0f);
+	EXPECT_EQ(acos(1.0f), 0.0f);
+	EXPECT_EQ(acos(-1.0f), pi);
+	EXPECT_TRUE(std::isnan(asin(1.5f)));
+	EXPECT_EQ(exp(0.0f), 1.0f);
+	EXPECT_EQ(exp(-200.0f), 0.0f);
+	EXPECT_EQ(exp(100.0f), INFINITY);
+	EXPECT_EQ(exp(-INFINITY), 0.0f);
+	EXPECT_GT(exp(-100.0f), 0.0f); // a denormal
+	EXPECT_EQ(log(1.0f), 0.0f);
+	EXPECT_EQ(log(0.0f), -INFINITY);
+	EXPECT_EQ(log(INFINITY), INFINITY);
+	EXPECT_TRUE(std::isnan(log(-1.0f)));
+	EXPECT_NEAR(log(FLT_TRUE_MIN), std::log((double)FLT_TRUE_MIN), 1e-5);
+	EXPECT_EQ(pow(2.0f, 0.0f), 1.0f);
+	EXPECT_EQ(pow(0.0f, 0.0f), 1.0f);
+	EXPECT_EQ(pow(0.0f, 2.0f), 0.0f);
+	EXPECT_EQ(pow(0.0f, -1.0f), INFINITY);
+	EXPECT_EQ(pow(2.0f, 10.0f), 1024.0f);
+	EXPECT_EQ(pow<accuracy::exact>(10.0f, 3.0f), 1000.0f);
+}
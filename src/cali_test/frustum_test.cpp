@@ -0,0 +1,372 @@
+#include <gtest.h>
+#include <Frustum.h>
+#include <World.h>
+
+#include <IvMath.h>
+#include <IvMatrix33.h>
+#include <IvMatrix44.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using cali::containment;
+using cali::frustum;
+
+// frustum against the clip-space inequalities its planes come from (the
+// Windows build used DirectX::BoundingFrustum, which Linux does not have):
+// a box is outside when all its corners fail one of them and inside when
+// all its corners pass all of them. The arrays against classify_box().
+namespace
+{
+	// camera::send_settings_to_renderer()
+	IvMatrix44 projection_matrix(float fov, float aspect, float near_distance, float far_distance)
+	{
+		const float d = 1.0f / IvTan(fov / 180.0f * kPI * 0.5f);
+		const float Q = far_distance / (far_distance - near_distance);
+		IvMatrix44 perspective;
+		perspective(0, 0) = d / aspect;
+		perspective(1, 1) = d;
+		perspective(2, 2) = Q;
+		perspective(2, 3) = -near_distance * Q;
+		perspective(3, 2) = 1.0f;
+		perspective(3, 3) = 0.0f;
+		return perspective;
+	}
+
+	// camera::get_view_matrix()
+	IvMatrix44 view_matrix(const IvVector3& position, IvVector3 direction, const IvVector3& up)
+	{
+		direction.Normalize();
+		IvVector3 right = up.Cross(direction);
+		right.Normalize();
+		IvVector3 view_up = direction.Cross(right);
+		view_up.Normalize();
+
+		IvMatrix33 rotate;
+		rotate.SetRows(right, view_up, direction);
+		const IvVector3 xlate = -(rotate * position);
+
+		IvMatrix44 matrix;
+		matrix.Rotation(rotate);
+		matrix(0, 3) = xlate.x;
+		matrix(1, 3) = xlate.y;
+		matrix(2, 3) = xlate.z;
+		return matrix;
+	}
+
+	// The six inequalities of a point, as w + x >= 0 and so on, in double
+	void clip_margins(const IvMatrix44& projection, const IvMatrix44& view, const IvDoubleVector3& p, double (&margins)[6])
+	{
+		double clip[4];
+		for (unsigned int i = 0; i < 4; ++i)
+		{
+			clip[i] = 0.0;
+			for (unsigned int k = 0; k < 4; ++k)
+			{
+				double m = 0.0;
+				for (unsigned int j = 0; j < 4; ++j) m += (double)projection(i, j) * (double)view(j, k);
+				clip[i] += m * (k < 3 ? p[k] : 1.0);
+			}
+		}
+		const double x = clip[0], y = clip[1], z = clip[2], w = clip[3];
+		const double values[6] = { w + x, w - x, w + y, w - y, z, w - z };
+		for (int i = 0; i < 6; ++i) margins[i] = values[i];
+	}
+
+	// What the corners say, or false when a corner is too close to a plane to tell
+	bool classify_corners(const IvMatrix44& projection, const IvMatrix44& view, const IvDoubleVector3& center,
+		const IvDoubleVector3& extents, double tolerance, containment& result)
+	{
+		int outside[6] = {}, any_outside = 0;
+		for (int corner = 0; corner < 8; ++corner)
+		{
+			const IvDoubleVector3 p(center.x + (corner & 1 ? extents.x : -extents.x),
+				center.y + (corner & 2 ? extents.y : -extents.y), center.z + (corner & 4 ? extents.z : -extents.z));
+			double margins[6];
+			clip_margins(projection, view, p, margins);
+			for (int plane = 0; plane < 6; ++plane)
+			{
+				if (std::abs(margins[plane]) < tolerance) return false;
+				if (margins[plane] < 0.0)
+				{
+					++outside[plane];
+					any_outside = 1;
+				}
+			}
+		}
+		result = containment::inside;
+		if (any_outside) result = containment::intersects;
+		for (int plane = 0; plane < 6; ++plane)
+			if (outside[plane] == 8) result = containment::outside;
+		return true;
+	}
+
+	struct scene
+	{
+		IvMatrix44 projection, view;
+		frustum f;
+	};
+
+	scene random_scene(std::mt19937& rng, float far_distance)
+	{
+		std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+		const IvVector3 position{ 100.0f * value(rng), 100.0f * value(rng), 100.0f * value(rng) };
+		const IvVector3 direction{ value(rng), value(rng), value(rng) };
+		scene s{ projection_matrix(60.0f, 16.0f / 9.0f, 0.1f, far_distance), view_matrix(position, direction, { 0.0f, 1.0f, 0.0f }), {} };
+		s.f.construct_frustum(s.projection, s.view);
+		return s;
+	}
+
+	void random_boxes(std::mt19937& rng, size_t count, double range, double size, cali::box_array<double>& boxes)
+	{
+		std::uniform_real_distribution<double> value(-range, range), extent(0.01, size);
+		boxes.clear();
+		for (size_t i = 0; i < count; ++i)
+			boxes.push_back({ value(rng), value(rng), value(rng) }, { extent(rng), extent(rng), extent(rng) });
+	}
+}
+
+TEST(frustum, boxes_match_their_corners_in_clip_space)
+{
+	std::mt19937 rng(3);
+	int checked[3] = {};
+	for (int scenes = 0; scenes < 20; ++scenes)
+	{
+		const scene s = random_scene(rng, 500.0f);
+		cali::box_array<double> boxes;
+		random_boxes(rng, 1000, 600.0, 80.0, boxes);
+		cali::box_array<float> float_boxes;
+		for (size_t i = 0; i < boxes.size(); ++i)
+			float_boxes.push_back({ boxes.center_x[i], boxes.center_y[i], boxes.center_z[i] },
+				{ boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i] });
+
+		std::vector<containment> results(boxes.size()), float_results(boxes.size());
+		s.f.classify_boxes(boxes, results.data());
+		s.f.classify_boxes(float_boxes, float_results.data());
+		for (size_t i = 0; i < boxes.size(); ++i)
+		{
+			const IvDoubleVector3 center(boxes.center_x[i], boxes.center_y[i], boxes.center_z[i]);
+			const IvDoubleVector3 extents(boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i]);
+			containment expected;
+			if (!classify_corners(s.projection, s.view, center, extents, 1e-2, expected)) continue;
+			ASSERT_EQ(results[i], expected) << scenes << " " << i;
+			ASSERT_EQ(float_results[i], expected) << scenes << " " << i;
+			ASSERT_EQ(s.f.contains_aligned_bounding_box((float)center.x, (float)center.y, (float)center.z,
+				(float)extents.x, (float)extents.y, (float)extents.z), expected != containment::outside);
+			++checked[(int)expected];
+		}
+	}
+	// all three outcomes were seen
+	EXPECT_GT(checked[0], 100);
+	EXPECT_GT(checked[1], 100);
+	EXPECT_GT(checked[2], 100);
+}
+
+TEST(frustum, arrays_give_the_classify_box_results)
+{
+	std::mt19937 rng(9);
+	const scene s = random_scene(rng, 500.0f);
+	std::uniform_int_distribution<int> mask(0, frustum::all_planes);
+	for (size_t count = 0; count <= 21; ++count) // full batches and every remainder
+	{
+		cali::box_array<double> boxes;
+		random_boxes(rng, count, 400.0, 100.0, boxes);
+		std::vector<containment> results(count);
+		std::vector<uint8_t> masks(count), expected_masks(count);
+		for (size_t i = 0; i < count; ++i) masks[i] = expected_masks[i] = (uint8_t)mask(rng);
+
+		s.f.classify_boxes(boxes, results.data());
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvDoubleVector3 center(boxes.center_x[i], boxes.center_y[i], boxes.center_z[i]);
+			const IvDoubleVector3 extents(boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i]);
+			EXPECT_EQ(results[i], s.f.classify_box(center, extents)) << count << " " << i;
+		}
+
+		// each box tests its own planes only
+		s.f.classify_boxes(boxes, results.data(), masks.data());
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvDoubleVector3 center(boxes.center_x[i], boxes.center_y[i], boxes.center_z[i]);
+			const IvDoubleVector3 extents(boxes.extent_x[i], boxes.extent_y[i], boxes.extent_z[i]);
+			EXPECT_EQ(results[i], s.f.classify_box(center, extents, &expected_masks[i])) << count << " " << i;
+			EXPECT_EQ(masks[i], expected_masks[i]) << count << " " << i;
+		}
+	}
+}
+
+TEST(frustum, children_need_only_the_planes_their_parent_straddles)
+{
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	const scene s = random_scene(rng, 500.0f);
+	cali::box_array<double> parents;
+	random_boxes(rng, 200, 300.0, 150.0, parents);
+
+	for (size_t i = 0; i < parents.size(); ++i)
+	{
+		const IvDoubleVector3 center(parents.center_x[i], parents.center_y[i], parents.center_z[i]);
+		const IvDoubleVector3 extents(parents.extent_x[i], parents.extent_y[i], parents.extent_z[i]);
+		uint8_t parent_mask = frustum::all_planes;
+		if (s.f.classify_box(center, extents, &parent_mask) == containment::outside) continue;
+
+		// boxes inside the parent
+		cali::box_array<double> children;
+		for (int child = 0; child < 8; ++child)
+		{
+			IvDoubleVector3 half(extents.x * unit(rng), extents.y * unit(rng), extents.z * unit(rng));
+			const IvDoubleVector3 offset((2.0 * unit(rng) - 1.0) * (extents.x - half.x), (2.0 * unit(rng) - 1.0) * (extents.y - half.y),
+				(2.0 * unit(rng) - 1.0) * (extents.z - half.z));
+			children.push_back(center + offset, half);
+		}
+		std::vector<containment> all(children.size()), masked(children.size());
+		std::vector<uint8_t> masks(children.size(), parent_mask);
+		s.f.classify_boxes(children, all.data());
+		s.f.classify_boxes(children, masked.data(), masks.data());
+		for (size_t child = 0; child < children.size(); ++child)
+		{
+			EXPECT_EQ(masked[child], all[child]) << i << " " << child;
+			if (masked[child] != containment::outside) { EXPECT_EQ(masks[child] & ~parent_mask, 0) << i << " " << child; }
+		}
+	}
+}
+
+TEST(frustum, spheres_and_oriented_boxes)
+{
+	std::mt19937 rng(21);
+	std::uniform_real_distribution<double> value(-300.0, 300.0), radius(0.1, 60.0);
+	const scene s = random_scene(rng, 500.0f);
+
+	for (size_t count : { (size_t)3, (size_t)64, (size_t)101 })
+	{
+		cali::sphere_array<double> spheres;
+		cali::sphere_array<float> float_spheres;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvDoubleVector3 center(value(rng), value(rng), value(rng));
+			const double r = radius(rng);
+			spheres.push_back(center, r);
+			float_spheres.push_back(center, r);
+		}
+		std::vector<containment> results(count), float_results(count);
+		s.f.classify_spheres(spheres, results.data());
+		s.f.classify_spheres(float_spheres, float_results.data());
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvDoubleVector3 center(spheres.center_x[i], spheres.center_y[i], spheres.center_z[i]);
+			const containment expected = s.f.classify_sphere(center, spheres.radius[i]);
+			EXPECT_EQ(results[i], expected) << i;
+
+			// the sphere between its inscribed and its circumscribed box
+			const double r = spheres.radius[i];
+			const double inner = r / std::sqrt(3.0);
+			if (s.f.classify_box(center, { r, r, r }) == containment::outside) { EXPECT_EQ(expected, containment::outside); }
+			if (s.f.classify_box(center, { inner, inner, inner }) != containment::outside) { EXPECT_NE(expected, containment::outside); }
+			// float, unless rounding could change the answer
+			if (s.f.classify_sphere(center, r - 1e-2) == s.f.classify_sphere(center, r + 1e-2))
+			{
+				EXPECT_EQ(float_results[i], expected) << i;
+			}
+		}
+	}
+
+	// an oriented box with the identity rotation is its aligned box
+	for (int i = 0; i < 200; ++i)
+	{
+		const IvVector3 center{ (float)value(rng), (float)value(rng), (float)value(rng) };
+		const IvVector3 extents{ (float)radius(rng), (float)radius(rng), (float)radius(rng) };
+		IvOBB box;
+		box.SetCenter(center);
+		box.SetExtents(extents);
+		IvMatrix33 identity;
+		identity.Identity();
+		box.SetRotation(identity);
+		EXPECT_EQ(s.f.visible(box), s.f.classify_box(center, extents) != containment::outside) << i;
+	}
+}
+
+TEST(frustum, oriented_box_arrays_and_their_corners)
+{
+	std::mt19937 rng(33);
+	std::uniform_real_distribution<float> value(-400.0f, 400.0f), extent(0.1f, 80.0f), angle(-kPI, kPI);
+	const scene s = random_scene(rng, 500.0f);
+	int checked[3] = {};
+	for (size_t count = 0; count <= 700; count += count < 21 ? 1 : 679) // every remainder, then many
+	{
+		cali::oriented_box_array<double> boxes;
+		cali::oriented_box_array<float> float_boxes;
+		std::vector<IvMatrix33> rotations(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			rotations[i].Rotation(angle(rng), angle(rng), angle(rng));
+			const IvDoubleVector3 center(value(rng), value(rng), value(rng));
+			const IvVector3 extents(extent(rng), extent(rng), extent(rng));
+			boxes.push_back(center, rotations[i], extents);
+			float_boxes.push_back(center, rotations[i], extents);
+		}
+		std::vector<containment> results(count), float_results(count);
+		s.f.classify_oriented_boxes(boxes, results.data());
+		s.f.classify_oriented_boxes(float_boxes, float_results.data());
+		for (size_t i = 0; i < count; ++i)
+		{
+			const IvDoubleVector3 center(boxes.center_x[i], boxes.center_y[i], boxes.center_z[i]);
+			const IvVector3 extents((float)boxes.extent_x[i], (float)boxes.extent_y[i], (float)boxes.extent_z[i]);
+			const containment expected = s.f.classify_oriented_box(center, rotations[i], extents);
+			EXPECT_EQ(results[i], expected) << count << " " << i;
+
+			// the corners: outside when all fail one inequality, inside when all pass all
+			int outside[6] = {}, any_outside = 0;
+			bool clear = true;
+			for (int corner = 0; corner < 8; ++corner)
+			{
+				IvDoubleVector3 p = center;
+				for (unsigned int k = 0; k < 3; ++k)
+					p += IvDoubleVector3(rotations[i].GetColumn(k)) * (corner & (1 << k) ? (double)extents[k] : -(double)extents[k]);
+				double margins[6];
+				clip_margins(s.projection, s.view, p, margins);
+				for (int plane = 0; plane < 6; ++plane)
+				{
+					if (std::abs(margins[plane]) < 1e-2) clear = false;
+					if (margins[plane] < 0.0)
+					{
+						++outside[plane];
+						any_outside = 1;
+					}
+				}
+			}
+			if (!clear) continue;
+			if (std::count(outside, outside + 6, 8)) { EXPECT_EQ(expected, containment::outside) << i; }
+			if (!any_outside) { EXPECT_EQ(expected, containment::inside) << i; }
+			if (expected == containment::outside) { EXPECT_TRUE(any_outside) << i; }
+			if (s.f.classify_oriented_box(center, rotations[i], extents * 0.999f) == s.f.classify_oriented_box(center, rotations[i], extents * 1.001f))
+			{
+				EXPECT_EQ(float_results[i], expected) << i;
+			}
+			++checked[(int)expected];
+		}
+	}
+	EXPECT_GT(checked[0], 20);
+	EXPECT_GT(checked[1], 20);
+	EXPECT_GT(checked[2], 20);
+}
+
+TEST(frustum, the_far_plane_of_the_camera_holds_everything)
+{
+	std::mt19937 rng(27);
+	const scene s = random_scene(rng, cali::world::c_camera_far);
+	IvDoubleVector3 normal;
+	double offset;
+	s.f.get_plane(frustum::far_plane, normal, offset);
+	EXPECT_EQ(normal.LengthSquared(), 0.0);
+	EXPECT_GT(offset, 0.0);
+
+	// the other planes are unit length, and a default frustum holds everything
+	for (int p = frustum::left; p < frustum::far_plane; ++p)
+	{
+		s.f.get_plane((frustum::plane)p, normal, offset);
+		EXPECT_NEAR(normal.Length(), 1.0, 1e-12);
+	}
+	EXPECT_EQ(frustum().classify_box({ 1e30, -1e30, 0.0 }, { 1.0, 1.0, 1.0 }), containment::inside);
+}
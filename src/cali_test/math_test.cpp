@@ -0,0 +1,580 @@
+#include <gtest.h>
+#include <CaliMath.h>
+#include <CaliSphereMath.h>
+#include <CaliSphereMathBatch.h>
+#include <Icosphere.h>
+#include <RelativeToEye.h>
+#include <World.h>
+#include <IvDoubleVector3.h>
+#include <IvMatrix33.h>
+#include <IvMatrix44.h>
+#include <IvSIMD.h>
+#include <IvVector3.h>
+#include <IvVector3Batch.h>
+#include <IvVector4.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// The SIMD paths of IvMatrix44 (IvSIMD.h) against the scalar code they
+// replace, copied here so that every path is checked against the same
+// reference, and the batch vectors (IvVector3Batch.h) against IvVector3 and
+// IvDoubleVector3. Both add in the same order, so the results are bitwise
+// equal. The batched cube <-> sphere mappings (CaliSphereMathBatch.h) use
+// polynomials instead of libm and are held to their documented error.
+// IvDoubleVector3's fused kernels give the bits of the operator chains.
+// What the constexpr vectors, matrices and the icosphere (Icosphere.h) give
+// at compile time they give at run time. Offsets relative to the eye
+// (RelativeToEye.h) stay sub-millimetre at planet distances.
+namespace
+{
+	IvMatrix44 random_matrix(std::mt19937& rng, bool affine)
+	{
+		std::uniform_real_distribution<float> value(-4.0f, 4.0f);
+		IvMatrix44 m;
+		for (unsigned int i = 0; i < 4; ++i)
+			for (unsigned int j = 0; j < 4; ++j) m(i, j) = value(rng);
+		if (affine)
+		{
+			m(3, 0) = m(3, 1) = m(3, 2) = 0.0f;
+			m(3, 3) = 1.0f;
+		}
+		return m;
+	}
+
+	IvMatrix44 scalar_multiply(const IvMatrix44& a, const IvMatrix44& b)
+	{
+		IvMatrix44 result;
+		for (unsigned int i = 0; i < 4; ++i)
+			for (unsigned int j = 0; j < 4; ++j)
+				result(i, j) = a(i, 0) * b(0, j) + a(i, 1) * b(1, j) + a(i, 2) * b(2, j) + a(i, 3) * b(3, j);
+		return result;
+	}
+
+	IvMatrix44 scalar_affine_inverse(const IvMatrix44& m)
+	{
+		const float* v = m;
+		IvMatrix44 result;
+		float* r = result;
+		const float cofactor0 = v[5] * v[10] - v[6] * v[9];
+		const float cofactor4 = v[2] * v[9] - v[1] * v[10];
+		const float cofactor8 = v[1] * v[6] - v[2] * v[5];
+		const float det = v[0] * cofactor0 + v[4] * cofactor4 + v[8] * cofactor8;
+		const float inv_det = 1.0f / det;
+		r[0] = inv_det * cofactor0;
+		r[1] = inv_det * cofactor4;
+		r[2] = inv_det * cofactor8;
+		r[4] = inv_det * (v[6] * v[8] - v[4] * v[10]);
+		r[5] = inv_det * (v[0] * v[10] - v[2] * v[8]);
+		r[6] = inv_det * (v[2] * v[4] - v[0] * v[6]);
+		r[8] = inv_det * (v[4] * v[9] - v[5] * v[8]);
+		r[9] = inv_det * (v[1] * v[8] - v[0] * v[9]);
+		r[10] = inv_det * (v[0] * v[5] - v[1] * v[4]);
+		r[12] = -r[0] * v[12] - r[4] * v[13] - r[8] * v[14];
+		r[13] = -r[1] * v[12] - r[5] * v[13] - r[9] * v[14];
+		r[14] = -r[2] * v[12] - r[6] * v[13] - r[10] * v[14];
+		return result;
+	}
+
+	void expect_same_matrix(const IvMatrix44& a, const IvMatrix44& b)
+	{
+		for (unsigned int i = 0; i < 4; ++i)
+			for (unsigned int j = 0; j < 4; ++j) EXPECT_EQ(a(i, j), b(i, j)) << "(" << i << ", " << j << ") " << IvSIMDPath();
+	}
+
+	template <typename V>
+	void expect_same_vector(const V& a, const V& b, unsigned int lane)
+	{
+		EXPECT_EQ(a.x, b.x) << "lane " << lane << " " << IvSIMDPath();
+		EXPECT_EQ(a.y, b.y) << "lane " << lane << " " << IvSIMDPath();
+		EXPECT_EQ(a.z, b.z) << "lane " << lane << " " << IvSIMDPath();
+	}
+
+	template <typename V>
+	std::vector<V> random_vectors(std::mt19937& rng, size_t count)
+	{
+		std::uniform_real_distribution<double> value(-10.0, 10.0);
+		std::vector<V> vectors(count);
+		for (V& v : vectors) v.Set(value(rng), value(rng), value(rng));
+		return vectors;
+	}
+
+	// every batch operation against the scalar vector type, lane by lane
+	template <typename Batch, typename V>
+	void expect_batch_matches_scalar(std::mt19937& rng)
+	{
+		typedef typename Batch::Scalar Scalar;
+		const unsigned int n = Batch::Width;
+		std::vector<V> a = random_vectors<V>(rng, n), b = random_vectors<V>(rng, n), out(n);
+		a[1].Zero(); // Normalize() leaves it at 0
+		const Scalar t = (Scalar)0.3;
+
+		Batch A, B;
+		A.Load(a.data());
+		B.Load(b.data());
+		Scalar dot[n], length[n];
+		Dot(A, B).Store(dot);
+		B.Length().Store(length);
+
+		(A + B).Store(out.data());
+		for (unsigned int i = 0; i < n; ++i) expect_same_vector(out[i], a[i] + b[i], i);
+		(A - B).Store(out.data());
+		for (unsigned int i = 0; i < n; ++i) expect_same_vector(out[i], a[i] - b[i], i);
+		(A * t).Store(out.data());
+		for (unsigned int i = 0; i < n; ++i) expect_same_vector(out[i], a[i] * t, i);
+		Cross(A, B).Store(out.data());
+		for (unsigned int i = 0; i < n; ++i) expect_same_vector(out[i], Cross(a[i], b[i]), i);
+		Lerp(A, B, decltype(A.x)(t)).Store(out.data());
+		for (unsigned int i = 0; i < n; ++i) expect_same_vector(out[i], a[i] + (b[i] - a[i]) * t, i);
+		Batch normalized = A;
+		normalized.Normalize();
+		normalized.Store(out.data());
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			V expected = a[i];
+			expected.Normalize();
+			expect_same_vector(out[i], expected, i);
+			EXPECT_EQ(dot[i], Dot(a[i], b[i]));
+			EXPECT_EQ(length[i], b[i].Length());
+		}
+	}
+}
+
+TEST(math, matrix44_products_match_the_scalar_code)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> value(-4.0f, 4.0f);
+	for (int n = 0; n < 64; ++n)
+	{
+		const IvMatrix44 a = random_matrix(rng, false), b = random_matrix(rng, false);
+		expect_same_matrix(a * b, scalar_multiply(a, b));
+
+		IvMatrix44 in_place = a;
+		in_place *= b;
+		expect_same_matrix(in_place, scalar_multiply(a, b));
+		in_place = a;
+		in_place *= in_place;
+		expect_same_matrix(in_place, scalar_multiply(a, a));
+
+		IvMatrix44 transposed;
+		for (unsigned int i = 0; i < 4; ++i)
+			for (unsigned int j = 0; j < 4; ++j) transposed(j, i) = a(i, j);
+		expect_same_matrix(Transpose(a), transposed);
+		IvMatrix44 self = a;
+		expect_same_matrix(self.Transpose(), transposed);
+
+		const IvVector4 v(value(rng), value(rng), value(rng), value(rng));
+		const IvVector4 column = a * v, row = v * a;
+		for (unsigned int i = 0; i < 4; ++i)
+		{
+			EXPECT_EQ(column[i], a(i, 0) * v.x + a(i, 1) * v.y + a(i, 2) * v.z + a(i, 3) * v.w);
+			EXPECT_EQ(row[i], a(0, i) * v.x + a(1, i) * v.y + a(2, i) * v.z + a(3, i) * v.w);
+		}
+	}
+}
+
+TEST(math, matrix44_affine_inverse_matches_the_scalar_code)
+{
+	std::mt19937 rng(11);
+	for (int n = 0; n < 64; ++n)
+	{
+		const IvMatrix44 m = random_matrix(rng, true);
+		const IvMatrix44 inverse = AffineInverse(m);
+		expect_same_matrix(inverse, scalar_affine_inverse(m));
+
+		IvMatrix44 self = m;
+		expect_same_matrix(self.AffineInverse(), inverse);
+
+		const IvMatrix44 identity = m * inverse;
+		for (unsigned int i = 0; i < 4; ++i)
+			for (unsigned int j = 0; j < 4; ++j) EXPECT_NEAR(identity(i, j), i == j ? 1.0f : 0.0f, 1e-3f);
+	}
+}
+
+TEST(math, matrix44_transform_points_matches_transform_point)
+{
+	std::mt19937 rng(13);
+	std::uniform_real_distribution<float> value(-100.0f, 100.0f);
+	const IvMatrix44 m = random_matrix(rng, true);
+
+	// every remainder of the four-wide loop, out of place and in place
+	for (unsigned int count = 0; count <= 13; ++count)
+	{
+		std::vector<IvVector3> points(count), transformed(count);
+		for (IvVector3& p : points) p.Set(value(rng), value(rng), value(rng));
+
+		m.TransformPoints(points.data(), transformed.data(), count);
+		for (unsigned int i = 0; i < count; ++i)
+		{
+			const IvVector3 expected = m.TransformPoint(points[i]);
+			EXPECT_EQ(transformed[i].x, expected.x);
+			EXPECT_EQ(transformed[i].y, expected.y);
+			EXPECT_EQ(transformed[i].z, expected.z);
+		}
+
+		m.TransformPoints(points.data(), points.data(), count);
+		for (unsigned int i = 0; i < count; ++i) EXPECT_TRUE(points[i] == transformed[i]);
+	}
+}
+
+TEST(math, matrix33_axis_angle_rotation_is_orthonormal)
+{
+	const IvVector3 axis(0.3f, -0.8f, 0.5f);
+	IvMatrix33 rotation;
+	rotation.Rotation(axis, 0.7f);
+	IvMatrix44 reference;
+	reference.Rotation(axis, 0.7f);
+
+	for (unsigned int i = 0; i < 3; ++i)
+	{
+		for (unsigned int j = 0; j < 3; ++j)
+		{
+			EXPECT_NEAR(rotation(i, j), reference(i, j), 1e-6f);
+			const float dot = rotation(0, i) * rotation(0, j) + rotation(1, i) * rotation(1, j) + rotation(2, i) * rotation(2, j);
+			EXPECT_NEAR(dot, i == j ? 1.0f : 0.0f, 1e-5f);
+		}
+	}
+
+	// the axis is left in place
+	IvVector3 unit_axis = axis;
+	unit_axis.Normalize();
+	const IvVector3 rotated = rotation * unit_axis;
+	EXPECT_NEAR(rotated.x, unit_axis.x, 1e-6f);
+	EXPECT_NEAR(rotated.y, unit_axis.y, 1e-6f);
+	EXPECT_NEAR(rotated.z, unit_axis.z, 1e-6f);
+}
+
+TEST(math, vector3_batches_match_the_scalar_vectors)
+{
+	std::mt19937 rng(17);
+	for (int n = 0; n < 8; ++n)
+	{
+		expect_batch_matches_scalar<IvVector3x4, IvVector3>(rng);
+		expect_batch_matches_scalar<IvVector3x8, IvVector3>(rng);
+		expect_batch_matches_scalar<IvDoubleVector3x4, IvDoubleVector3>(rng);
+		expect_batch_matches_scalar<IvDoubleVector3x8, IvDoubleVector3>(rng);
+	}
+
+	// matrix products of the float batches
+	const IvMatrix44 m = random_matrix(rng, true);
+	IvMatrix33 rotation;
+	rotation.Rotation(IvVector3(0.3f, -0.8f, 0.5f), 0.7f);
+	const std::vector<IvVector3> points = random_vectors<IvVector3>(rng, 8);
+	std::vector<IvVector3> out(8);
+	IvVector3x8 p;
+	p.Load(points.data());
+	TransformPoint(m, p).Store(out.data());
+	for (unsigned int i = 0; i < 8; ++i) expect_same_vector(out[i], m.TransformPoint(points[i]), i);
+	Transform(m, p).Store(out.data());
+	for (unsigned int i = 0; i < 8; ++i) expect_same_vector(out[i], m.Transform(points[i]), i);
+	(rotation * p).Store(out.data());
+	for (unsigned int i = 0; i < 8; ++i) expect_same_vector(out[i], rotation * points[i], i);
+}
+
+// IvDoubleVector3 is a literal, trivially copyable type
+static_assert(std::is_trivially_copyable<IvDoubleVector3>::value, "IvDoubleVector3 copies are plain");
+static_assert(cali::Math::quad_lerp(IvDoubleVector3(0.0, 0.0, 0.0), IvDoubleVector3(4.0, 0.0, 0.0),
+	IvDoubleVector3(4.0, 4.0, 2.0), IvDoubleVector3(0.0, 4.0, 0.0), 0.5, 0.25).z == 0.25, "constexpr quad_lerp");
+static_assert(Cross(IvDoubleVector3(1.0, 0.0, 0.0), IvDoubleVector3(0.0, 1.0, 0.0)).z == 1.0, "constexpr Cross");
+
+TEST(math, double_vector3_fused_kernels_match_the_operators)
+{
+	std::mt19937 rng(23);
+	std::uniform_real_distribution<double> t(-0.5, 1.5);
+	for (int n = 0; n < 64; ++n)
+	{
+		const std::vector<IvDoubleVector3> q = random_vectors<IvDoubleVector3>(rng, 4);
+		const double u = t(rng), v = t(rng);
+		const IvDoubleVector3 ab = q[0] + u * (q[1] - q[0]), dc = q[3] + u * (q[2] - q[3]);
+		expect_same_vector(cali::Math::lerp(q[0], q[1], u), ab, (unsigned int)n);
+		expect_same_vector(cali::Math::quad_lerp(q[0], q[1], q[2], q[3], u, v), ab + v * (dc - ab), (unsigned int)n);
+	}
+}
+
+namespace
+{
+	constexpr IvMatrix33 matrix33(float a, float b, float c, float d, float e, float f, float g, float h, float i)
+	{
+		IvMatrix33 m{};
+		m(0, 0) = a; m(0, 1) = b; m(0, 2) = c;
+		m(1, 0) = d; m(1, 1) = e; m(1, 2) = f;
+		m(2, 0) = g; m(2, 1) = h; m(2, 2) = i;
+		return m;
+	}
+
+	constexpr IvMatrix33 identity33()
+	{
+		IvMatrix33 m{};
+		m.Identity();
+		return m;
+	}
+
+	constexpr IvMatrix33 c_m = matrix33(2.0f, -1.0f, 0.5f, 0.25f, 3.0f, -2.0f, 1.0f, 0.75f, 4.0f);
+	constexpr IvVector3 c_v(0.5f, -1.5f, 2.25f);
+	constexpr IvVector3 c_w(-3.0f, 0.125f, 1.0f);
+
+	constexpr IvMatrix33 c_mm = c_m * Transpose(c_m) - 2.0f * c_m;
+	constexpr IvVector3 c_mv = c_m * c_v + c_v * c_m;
+	constexpr IvVector3 c_cross = Cross(c_v, c_w) * 0.5f - c_w / 4.0f;
+	constexpr float c_det = c_m.Adjoint().Determinant();
+
+	constexpr IvMatrix44 scaled_identity()
+	{
+		IvMatrix44 m;
+		m(0, 3) = 5.0f;
+		return (m + m) * 0.5f - -m;
+	}
+	constexpr IvMatrix44 c_m44 = scaled_identity();
+
+	// Copies through memory, so that the same expressions are computed at run time
+	template <typename T>
+	T at_run_time(const T& value)
+	{
+		volatile unsigned char bytes[sizeof(T)];
+		memcpy((void*)bytes, &value, sizeof(T));
+		T result;
+		memcpy(&result, (const void*)bytes, sizeof(T));
+		return result;
+	}
+
+	template <typename T>
+	bool same_bits(const T& a, const T& b)
+	{
+		return memcmp(&a, &b, sizeof(T)) == 0;
+	}
+
+	template <size_t Subdivisions>
+	void expect_icosphere_level()
+	{
+		static constexpr cali::icosphere::level<Subdivisions> compiled = cali::icosphere::mesh<Subdivisions>();
+		cali::icosphere::vertex_list vertices;
+		cali::icosphere::triangle_list triangles;
+		cali::icosphere::make_icosphere(vertices, triangles, Subdivisions);
+
+		ASSERT_EQ(vertices.size(), compiled.vertices.size()) << Subdivisions;
+		ASSERT_EQ(triangles.size(), compiled.triangles.size()) << Subdivisions;
+		for (size_t i = 0; i < vertices.size(); ++i)
+			ASSERT_TRUE(same_bits(vertices[i], compiled.vertices[i])) << Subdivisions << " vertex " << i;
+		for (size_t i = 0; i < triangles.size(); ++i)
+			ASSERT_TRUE(same_bits(triangles[i], compiled.triangles[i])) << Subdivisions << " triangle " << i;
+	}
+}
+
+static_assert(std::is_trivially_copyable<IvVector3>::value && std::is_trivially_copyable<IvMatrix33>::value &&
+	std::is_trivially_copyable<IvMatrix44>::value, "the IvMath types are literal and copied as bytes");
+static_assert((identity33() * c_v).z == c_v.z, "constexpr identity");
+static_assert(c_cross.Dot(c_cross) == c_cross.LengthSquared(), "constexpr Dot");
+static_assert(c_m44(0, 3) == 10.0f && c_m44(1, 1) == 2.0f, "constexpr IvMatrix44");
+static_assert(cali::icosphere::mesh<1>().vertices.size() == 42, "constexpr icosphere");
+
+TEST(math, constexpr_results_match_the_run_time_results)
+{
+	const IvMatrix33 m = at_run_time(c_m);
+	const IvVector3 v = at_run_time(c_v), w = at_run_time(c_w);
+	EXPECT_TRUE(same_bits(m * Transpose(m) - 2.0f * m, c_mm));
+	EXPECT_TRUE(same_bits(m * v + v * m, c_mv));
+	EXPECT_TRUE(same_bits(Cross(v, w) * 0.5f - w / 4.0f, c_cross));
+	EXPECT_TRUE(same_bits(m.Adjoint().Determinant(), c_det));
+
+	IvMatrix44 m44 = at_run_time(IvMatrix44());
+	m44(0, 3) = 5.0f;
+	EXPECT_TRUE(same_bits((m44 + m44) * 0.5f - -m44, c_m44));
+}
+
+TEST(math, cube_face_rotations_are_constexpr_inverses)
+{
+	using cali::Math::CubeFace;
+	constexpr IvDoubleVector3 c_p(0.25, -0.5, 0.75);
+	for (int face = 0; face < 6; ++face)
+	{
+		const CubeFace f = (CubeFace)face;
+		EXPECT_TRUE(same_bits(cali::Math::rotate_face_to_top(cali::Math::rotate_top_to_face(at_run_time(c_p), f), f), c_p)) << face;
+	}
+	static_assert(cali::Math::rotate_face_to_top(cali::Math::rotate_top_to_face(c_p, CubeFace::PosZ), CubeFace::PosZ).y == c_p.y,
+		"constexpr rotation");
+}
+
+TEST(math, compile_time_icosphere_matches_make_icosphere)
+{
+	expect_icosphere_level<0>();
+	expect_icosphere_level<1>();
+	expect_icosphere_level<2>();
+	expect_icosphere_level<3>();
+
+	// every vertex is on the unit sphere
+	constexpr cali::icosphere::level<2> c_level = cali::icosphere::mesh<2>();
+	for (const IvVector3& each : c_level.vertices) EXPECT_NEAR(each.LengthSquared(), 1.0f, 1e-6f);
+}
+
+TEST(math, batch_loops_cover_the_remainder)
+{
+	std::mt19937 rng(19);
+	const IvMatrix44 m = random_matrix(rng, true);
+	for (size_t count = 0; count <= 19; ++count)
+	{
+		const std::vector<IvDoubleVector3> in = random_vectors<IvDoubleVector3>(rng, count);
+		std::vector<IvDoubleVector3> out(count, IvDoubleVector3(-1.0, -1.0, -1.0));
+		IvBatchTransform<IvDoubleVector3x4>(in.data(), out.data(), count, [](IvDoubleVector3x4 v) {
+			v.Normalize();
+			return v;
+		});
+		for (size_t i = 0; i < count; ++i)
+		{
+			IvDoubleVector3 expected = in[i];
+			expected.Normalize();
+			expect_same_vector(out[i], expected, (unsigned int)i);
+		}
+
+		// in place, and every element visited once
+		std::vector<IvVector3> points = random_vectors<IvVector3>(rng, count), expected(count);
+		for (size_t i = 0; i < count; ++i) expected[i] = m.TransformPoint(points[i]);
+		IvBatchTransform<IvVector3x8>(points.data(), points.data(), count,
+			[&](const IvVector3x8& p) { return TransformPoint(m, p); });
+		for (size_t i = 0; i < count; ++i) expect_same_vector(points[i], expected[i], (unsigned int)i);
+
+		std::vector<int> visits(count, 0);
+		IvBatchForEach<IvVector3x4>(points.data(), count, [&](const IvVector3x4&, size_t first, unsigned int lanes) {
+			EXPECT_LE(first + lanes, count);
+			for (unsigned int i = 0; i < lanes; ++i) ++visits[first + i];
+		});
+		for (size_t i = 0; i < count; ++i) EXPECT_EQ(visits[i], 1);
+	}
+}
+
+TEST(math, cube_sphere_batches_match_the_scalar_mapping)
+{
+	// Earth-sized in metres, off the origin, with a partial last batch
+	const double R = 6360.0e3;
+	const IvDoubleVector3 C{ 1500.0, -2500.0, 700.0 };
+	const size_t count = 1001;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<double> coord(-R, R);
+
+	std::vector<double> x(count), y(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		x[i] = coord(rng);
+		y[i] = coord(rng);
+	}
+	x[0] = y[0] = 0.0;
+	x[1] = y[1] = R;
+	x[2] = -R;
+	y[2] = R;
+
+	std::vector<IvDoubleVector3> positions(count), normals(count);
+	for (int face = 0; face < 6; ++face)
+	{
+		const cali::Math::CubeFace cf = static_cast<cali::Math::CubeFace>(face);
+		if (cf == cali::Math::CubeFace::PosY)
+			cali::Math::adjusted_cube_to_sphere_batch(x.data(), y.data(), count, R, C, positions.data(), normals.data());
+		else
+			cali::Math::adjusted_cube_to_sphere_face_batch(cf, x.data(), y.data(), count, R, C, positions.data(), normals.data());
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			IvDoubleVector3 normal;
+			const IvDoubleVector3 position = cali::Math::adjusted_cube_to_sphere_face(cf, x[i], y[i], R, C, normal);
+			ASSERT_LT((positions[i] - position).Length(), 1e-6) << "face " << face << " point " << i;
+			ASSERT_LT((normals[i] - normal).Length(), 1e-12) << "face " << face << " point " << i;
+		}
+	}
+}
+
+TEST(math, sphere_to_cube_batches_match_the_scalar_mapping)
+{
+	const double R = 6360.0e3;
+	const IvDoubleVector3 C{ 1500.0, -2500.0, 700.0 };
+	const size_t count = 1003;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<double> lon(-kPI / 4.0, kPI / 4.0), lat(-1.55, 1.55), unit(-1.0, 1.0), height(-10.0e3, 10.0e3);
+
+	std::vector<double> phi(count), theta(count), x(count), y(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		phi[i] = lon(rng);
+		theta[i] = lat(rng);
+	}
+	cali::Math::adjusted_sphere_to_cube_batch(phi.data(), theta.data(), count, R, x.data(), y.data());
+	for (size_t i = 0; i < count; ++i)
+	{
+		double sx, sy;
+		cali::Math::adjusted_sphere_to_cube(phi[i], theta[i], R, sx, sy);
+		ASSERT_LT(fabs(x[i] - sx), 1e-6) << i;
+		ASSERT_LT(fabs(y[i] - sy), 1e-6) << i;
+	}
+
+	// Points around the planet, on the face edges and one at the center
+	std::vector<IvDoubleVector3> world(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		IvDoubleVector3 d{ unit(rng), unit(rng), unit(rng) };
+		d.Normalize();
+		world[i] = C + d * (R + height(rng));
+	}
+	world[1] = C + IvDoubleVector3{ R, R, 0.0 };
+	world[2] = C + IvDoubleVector3{ -R, R, -R };
+
+	std::vector<cali::Math::CubeFace> faces(count);
+	EXPECT_TRUE(cali::Math::world_to_cube_face_batch(world.data(), count, C, R, faces.data(), x.data(), y.data()));
+	world[count - 1] = C;
+	EXPECT_FALSE(cali::Math::world_to_cube_face_batch(world.data(), count, C, R, faces.data(), x.data(), y.data()));
+	for (size_t i = 0; i < count; ++i)
+	{
+		cali::Math::CubeFace face;
+		double sx, sy;
+		cali::Math::world_to_cube_face(world[i], C, R, face, sx, sy);
+		ASSERT_EQ(faces[i], face) << i;
+		ASSERT_LT(fabs(x[i] - sx), 1e-6) << i;
+		ASSERT_LT(fabs(y[i] - sy), 1e-6) << i;
+	}
+}
+
+TEST(math, relative_to_eye_is_sub_millimetre_at_planet_distances)
+{
+	std::mt19937 rng(31);
+	std::uniform_real_distribution<double> unit(-1.0, 1.0), offset(-1000.0, 1000.0);
+	const size_t count = 1001;
+
+	// the world's planet, and an Earth-sized one in metres
+	struct planet { double R; IvDoubleVector3 C; };
+	for (const planet& each : { planet{ cali::world::c_earth_radius, IvDoubleVector3(cali::world::c_earth_center) },
+		planet{ 6360.0e3, IvDoubleVector3{ 1500.0, -6360.0e3, 700.0 } } })
+	{
+		const double R = each.R;
+		const IvDoubleVector3& C = each.C;
+		std::vector<IvDoubleVector3> positions(count);
+		std::vector<IvVector3> offsets(count);
+
+		double largest_error = 0.0, largest_float_error = 0.0;
+		for (int eyes = 0; eyes < 8; ++eyes)
+		{
+			IvDoubleVector3 up{ unit(rng), unit(rng), unit(rng) };
+			up.Normalize();
+			const IvDoubleVector3 eye = C + up * (R + 2.0);
+			for (IvDoubleVector3& position : positions) position = eye + IvDoubleVector3{ offset(rng), offset(rng), offset(rng) };
+
+			cali::Math::relative_to_eye_batch(positions.data(), count, eye, offsets.data());
+			for (size_t i = 0; i < count; ++i)
+			{
+				const IvVector3 single = cali::Math::relative_to_eye(positions[i], eye);
+				ASSERT_EQ(memcmp(&offsets[i], &single, sizeof(IvVector3)), 0) << i;
+
+				const IvDoubleVector3 exact = positions[i] - eye;
+				const IvVector3 cast_first = (IvVector3)positions[i] - (IvVector3)eye;
+				for (int axis = 0; axis < 3; ++axis)
+				{
+					largest_error = std::max(largest_error, fabs((double)(&offsets[i].x)[axis] - (&exact.x)[axis]));
+					largest_float_error = std::max(largest_float_error, fabs((double)(&cast_first.x)[axis] - (&exact.x)[axis]));
+				}
+			}
+		}
+
+		EXPECT_LT(largest_error, 1e-3) << R;
+		// what rounding both positions to float first gives
+		EXPECT_GT(largest_float_error, 1e-3) << R;
+	}
+}
@@ -0,0 +1,122 @@
+#include <gtest.h>
+#include <PatchBounds.h>
+#include <World.h>
+
+#include <IvMath.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using cali::patch_bounds;
+using cali::Math::CubeFace;
+
+// The boxes of terrain patches hold the terrain, finely sampled, and are
+// far smaller than the axis-aligned boxes of the same samples where the
+// sphere is tilted
+namespace
+{
+	const IvDoubleVector3 c_center(cali::world::c_earth_center);
+	const double c_radius = cali::world::c_earth_radius;
+
+	// How far p is outside the box along its axes, 0 inside
+	double outside_by(const patch_bounds& box, const IvDoubleVector3& p)
+	{
+		const IvDoubleVector3 offset = p - box.center;
+		double worst = 0.0;
+		for (unsigned int k = 0; k < 3; ++k)
+		{
+			const IvDoubleVector3 axis(box.rotation.GetColumn(k));
+			worst = std::max(worst, std::abs(offset.Dot(axis)) - box.extents[k]);
+		}
+		return worst;
+	}
+
+	double aabb_volume(const std::vector<IvDoubleVector3>& points)
+	{
+		IvDoubleVector3 lo = points[0], hi = points[0];
+		for (const IvDoubleVector3& p : points)
+		{
+			lo = IvDoubleVector3(std::min(lo.x, p.x), std::min(lo.y, p.y), std::min(lo.z, p.z));
+			hi = IvDoubleVector3(std::max(hi.x, p.x), std::max(hi.y, p.y), std::max(hi.z, p.z));
+		}
+		return (hi.x - lo.x) * (hi.y - lo.y) * (hi.z - lo.z);
+	}
+
+	double volume(const patch_bounds& box) { return 8.0 * box.extents.x * box.extents.y * box.extents.z; }
+}
+
+TEST(patch_bounds, hold_the_terrain_between_their_samples)
+{
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<double> unit(0.0, 1.0);
+	for (int i = 0; i < 60; ++i)
+	{
+		// from a whole face down to a few metres, anywhere on any face
+		const double size = 2.0 * c_radius * std::pow(0.5, (double)(i % 15));
+		const double x = -c_radius + (2.0 * c_radius - size) * unit(rng), y = -c_radius + (2.0 * c_radius - size) * unit(rng);
+		const CubeFace face = (CubeFace)(i % 6);
+		const patch_bounds box = cali::fit_patch_bounds(face, x, y, x + size, y + size, c_radius, c_center);
+
+		for (unsigned int k = 0; k < 3; ++k)
+		{
+			EXPECT_NEAR(box.rotation.GetColumn(k).Length(), 1.0f, 1e-5f);
+			EXPECT_NEAR(box.rotation.GetColumn(k).Dot(box.rotation.GetColumn((k + 1) % 3)), 0.0f, 1e-5f);
+		}
+
+		// 8 times the samples of the fit, at the surface, halfway up and at the top
+		const int n = 8 * (cali::c_patch_samples - 1) + 1;
+		for (double height : { 0.0, 0.5 * cali::c_terrain_max_height, cali::c_terrain_max_height })
+		{
+			for (int j = 0; j < n; ++j)
+				for (int k = 0; k < n; ++k)
+				{
+					IvDoubleVector3 normal(0.0, 0.0, 0.0);
+					const IvDoubleVector3 surface = cali::Math::adjusted_cube_to_sphere_face(face, x + size * k / (n - 1),
+						y + size * j / (n - 1), c_radius, c_center, normal);
+					const IvDoubleVector3 p = surface + normal * height;
+					ASSERT_EQ(outside_by(box, p), 0.0) << i << " " << j << " " << k << " " << height;
+				}
+		}
+	}
+}
+
+TEST(patch_bounds, tighter_than_axis_aligned_boxes_on_tilted_patches)
+{
+	std::vector<IvDoubleVector3> samples;
+	// 1/8 of a face, halfway to its edge and in its corner
+	const double size = c_radius / 4.0;
+	for (double x : { 0.4 * c_radius, 0.7 * c_radius })
+	{
+		cali::sample_patch(CubeFace::PosY, x, x, x + size, x + size, c_radius, c_center, 0.0, cali::c_terrain_max_height, samples);
+		const patch_bounds box = cali::fit_patch_bounds(CubeFace::PosY, x, x, x + size, x + size, c_radius, c_center);
+		EXPECT_LT(volume(box), 0.25 * aabb_volume(samples)) << x;
+	}
+
+	// at the centre of a face the sphere is not tilted, and the boxes are alike but for the margin
+	cali::sample_patch(CubeFace::PosX, -size / 2, -size / 2, size / 2, size / 2, c_radius, c_center, 0.0,
+		cali::c_terrain_max_height, samples);
+	const patch_bounds box = cali::fit_patch_bounds(CubeFace::PosX, -size / 2, -size / 2, size / 2, size / 2, c_radius, c_center);
+	EXPECT_LT(volume(box), 1.25 * aabb_volume(samples));
+}
+
+TEST(patch_bounds, the_fit_of_a_box_is_the_box)
+{
+	IvMatrix33 rotation;
+	rotation.Rotation(0.3f, -1.1f, 0.7f);
+	const IvVector3 extents(40.0f, 10.0f, 3.0f);
+	const IvDoubleVector3 center(1000.0, -63600.0, 250.0);
+
+	std::vector<IvDoubleVector3> corners;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		IvDoubleVector3 p = center;
+		for (unsigned int k = 0; k < 3; ++k)
+			p += IvDoubleVector3(rotation.GetColumn(k)) * (corner & (1 << k) ? (double)extents[k] : -(double)extents[k]);
+		corners.push_back(p);
+	}
+	const patch_bounds box = cali::fit_oriented_box(corners.data(), corners.size());
+	EXPECT_LT((box.center - center).Length(), 1e-3);
+	EXPECT_NEAR(box.extents.x * box.extents.y * box.extents.z, extents.x * extents.y * extents.z, 1e-2 * extents.x * extents.y * extents.z);
+	for (const IvDoubleVector3& p : corners) EXPECT_LT(outside_by(box, p), 1e-3);
+}
@@ -0,0 +1,274 @@
+#include <gtest.h>
+#include <AssetCache.h>
+#include <Procedural.h>
+#include <ProceduralErosion.h>
+#include <ProceduralProgressive.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	const uint64_t c_seed = cali::proc::hash_string("cali_planet_v1");
+	const int c_size = 256;
+
+	cali::proc::erosion_params test_params(int threads)
+	{
+		cali::proc::erosion_params params;
+		params.lifetime = 20;
+		params.tile_size = 64;
+		params.threads = threads;
+		return params;
+	}
+
+	std::vector<float> eroded(bool wrap, int threads, cali::proc::erosion_stats* stats = nullptr)
+	{
+		std::vector<float> heights;
+		cali::proc::generate_heightmap_heights(c_seed, c_size, c_size, heights);
+		cali::proc::erode_heightmap(c_seed, c_size, c_size, wrap, heights, test_params(threads), stats);
+		return heights;
+	}
+
+	std::string temp_cache_directory(const char* name)
+	{
+		auto dir = std::filesystem::temp_directory_path() / name;
+		std::filesystem::remove_all(dir);
+		return dir.string();
+	}
+}
+
+TEST(procedural_erosion, changes_the_terrain)
+{
+	std::vector<float> original;
+	cali::proc::generate_heightmap_heights(c_seed, c_size, c_size, original);
+	cali::proc::erosion_stats stats;
+	auto heights = eroded(true, 1, &stats);
+
+	double change = 0.0;
+	for (size_t i = 0; i < heights.size(); ++i) change += std::fabs(heights[i] - original[i]);
+	change /= heights.size();
+	ASSERT_GT(change, 1e-4);
+	ASSERT_LT(change, 0.05);
+
+	ASSERT_EQ(stats.tiles, 16u);
+	ASSERT_EQ(stats.phases, 4);
+	ASSERT_GT(stats.droplets, 0u);
+	// the working set is one padded tile, not the map
+	const int margin = cali::proc::erosion_margin(test_params(1));
+	ASSERT_EQ(stats.working_set_bytes, (64 + 2 * margin) * (64 + 2 * margin) * sizeof(float));
+}
+
+TEST(procedural_erosion, independent_of_thread_count)
+{
+	ASSERT_EQ(eroded(true, 1), eroded(true, 4));
+	ASSERT_EQ(eroded(false, 1), eroded(false, 3));
+}
+
+TEST(procedural_erosion, tiled_output_is_seam_free)
+{
+	std::vector<float> original;
+	cali::proc::generate_heightmap_heights(c_seed, c_size, c_size, original);
+
+	for (bool wrap : { true, false })
+	{
+		auto heights = eroded(wrap, 2);
+
+		// a seam shows up as a step of the erosion delta between the two texel
+		// columns (rows) on a tile border; compare it with the steps next to it
+		std::vector<double> column_step(c_size, 0.0), row_step(c_size, 0.0);
+		for (int i = 0; i < c_size; ++i)
+			for (int j = 1; j < c_size; ++j)
+			{
+				const size_t a = (size_t)i * c_size + j, b = (size_t)j * c_size + i;
+				column_step[j] += std::fabs((heights[a] - original[a]) - (heights[a - 1] - original[a - 1]));
+				row_step[j] += std::fabs((heights[b] - original[b]) - (heights[b - c_size] - original[b - c_size]));
+			}
+		double border = 0.0, nearby = 0.0;
+		for (int t = 64; t < c_size; t += 64)
+		{
+			border += column_step[t] + row_step[t];
+			for (int d = 1; d <= 4; ++d)
+				nearby += (column_step[t - d] + column_step[t + d] + row_step[t - d] + row_step[t + d]) / 8.0;
+		}
+		ASSERT_GT(nearby, 0.0);
+		ASSERT_LT(border / nearby, 1.25) << "wrap " << wrap;
+	}
+}
+
+TEST(procedural_erosion, keeps_the_border_of_non_wrapping_maps)
+{
+	std::vector<float> original;
+	cali::proc::generate_heightmap_heights(c_seed, c_size, c_size, original);
+	auto heights = eroded(false, 1);
+	for (int i = 0; i < c_size; ++i)
+	{
+		ASSERT_EQ(heights[i], original[i]);
+		ASSERT_EQ(heights[(c_size - 1) * c_size + i], original[(c_size - 1) * c_size + i]);
+		ASSERT_EQ(heights[i * c_size], original[i * c_size]);
+		ASSERT_EQ(heights[i * c_size + c_size - 1], original[i * c_size + c_size - 1]);
+	}
+}
+
+TEST(procedural_erosion, cube_sphere_erodes_up_to_the_face_edges)
+{
+	const int n = 128;
+	const auto params = test_params(0);
+	cali::proc::cube_sphere_heightmap original, eroded_faces;
+	cali::proc::generate_cube_sphere_heightmap(c_seed, n, original);
+	cali::proc::generate_cube_sphere_heightmap(c_seed, n, eroded_faces, &params);
+
+	// the strip along the cube edges changes as much as the middle of the faces
+	size_t edge = 0, edge_changed = 0, middle = 0, middle_changed = 0;
+	for (int face = 0; face < cali::proc::c_cube_face_count; ++face)
+		for (int y = 0; y < n; ++y)
+			for (int x = 0; x < n; ++x)
+			{
+				const int d = std::min(std::min(x, y), std::min(n - 1 - x, n - 1 - y));
+				const bool changed = original.at(face, x, y) != eroded_faces.at(face, x, y);
+				if (d < params.border_fade) { ++edge; edge_changed += changed; }
+				else if (d >= 2 * params.border_fade) { ++middle; middle_changed += changed; }
+			}
+	ASSERT_GT(middle_changed, 0u);
+	ASSERT_GT((double)edge_changed / edge, 0.9 * middle_changed / middle);
+}
+
+TEST(procedural_erosion, rejects_small_tiles)
+{
+	std::vector<float> heights(c_size * c_size, 0.5f);
+	cali::proc::erosion_params params;
+	params.tile_size = 32;
+	ASSERT_THROW(cali::proc::erode_heightmap(c_seed, c_size, c_size, false, heights, params), std::invalid_argument);
+	params.tile_size = 200;
+	ASSERT_THROW(cali::proc::erode_heightmap(c_seed, c_size, c_size, true, heights, params), std::invalid_argument);
+}
+
+TEST(asset_cache, round_trip)
+{
+	cali::asset_cache cache(temp_cache_directory("cali_asset_cache_test"));
+	const std::vector<unsigned char> data{ 1, 2, 3, 4, 5 };
+	std::vector<unsigned char> loaded;
+	ASSERT_FALSE(cache.load("entry", 1, loaded));
+	ASSERT_TRUE(cache.store("entry", 1, data.data(), data.size()));
+	ASSERT_TRUE(cache.load("entry", 1, loaded));
+	ASSERT_EQ(loaded, data);
+	ASSERT_FALSE(cache.load("entry", 2, loaded));
+	ASSERT_TRUE(cache.remove("entry"));
+	ASSERT_FALSE(cache.load("entry", 1, loaded));
+	std::filesystem::remove_all(cache.directory());
+}
+
+TEST(asset_cache, load_checks_the_size_against_the_file)
+{
+	cali::asset_cache cache(temp_cache_directory("cali_asset_cache_size_test"));
+	const std::vector<unsigned char> data{ 1, 2, 3, 4, 5 };
+	ASSERT_TRUE(cache.store("entry", 1, data.data(), data.size()));
+
+	// a damaged size in an otherwise valid header: the entry is missing, not
+	// a huge allocation
+	FILE* f = fopen(cache.entry_path("entry").c_str(), "r+b");
+	ASSERT_NE(f, nullptr);
+	const uint64_t size = 1ull << 62;
+	fseek(f, 16, SEEK_SET);
+	fwrite(&size, sizeof(size), 1, f);
+	fclose(f);
+	std::vector<unsigned char> loaded;
+	ASSERT_FALSE(cache.load("entry", 1, loaded));
+	ASSERT_TRUE(loaded.empty());
+
+	// and a truncated payload
+	ASSERT_TRUE(cache.store("entry", 1, data.data(), data.size()));
+	std::filesystem::resize_file(cache.entry_path("entry"), std::filesystem::file_size(cache.entry_path("entry")) - 1);
+	ASSERT_FALSE(cache.load("entry", 1, loaded));
+	std::filesystem::remove_all(cache.directory());
+}
+
+TEST(asset_cache, map_checks_the_entry)
+{
+	cali::asset_cache cache(temp_cache_directory("cali_asset_cache_map_test"));
+	const std::vector<unsigned char> data{ 9, 8, 7, 6 };
+	cali::mapped_asset mapped;
+	ASSERT_FALSE(cache.map("entry", 1, mapped));
+	ASSERT_TRUE(cache.store("entry", 1, data.data(), data.size()));
+	ASSERT_TRUE(cache.map("entry", 1, mapped));
+	ASSERT_EQ(std::vector<unsigned char>(mapped.data(), mapped.data() + mapped.size()), data);
+	ASSERT_FALSE(cache.map("entry", 2, mapped));
+	ASSERT_FALSE(mapped.is_open());
+
+	FILE* f = fopen(cache.entry_path("entry").c_str(), "r+b");
+	ASSERT_NE(f, nullptr);
+	fseek(f, -1, SEEK_END);
+	fputc(0, f);
+	fclose(f);
+	ASSERT_FALSE(cache.map("entry", 1, mapped));
+	std::filesystem::remove_all(cache.directory());
+}
+
+TEST(asset_cache, concurrent_stores_of_one_key)
+{
+	cali::asset_cache cache(temp_cache_directory("cali_asset_cache_concurrent_test"));
+	const int c_writers = 8;
+	std::vector<std::vector<unsigned char>> data(c_writers);
+	for (int i = 0; i < c_writers; ++i) data[i].assign(64 * 1024, (unsigned char)i);
+
+	std::atomic<int> stored(0);
+	std::vector<std::thread> writers;
+	for (int i = 0; i < c_writers; ++i)
+		writers.emplace_back([&, i]()
+		{
+			for (int n = 0; n < 4; ++n)
+				if (cache.store("entry", 1, data[i].data(), data[i].size())) ++stored;
+		});
+	for (auto& t : writers) t.join();
+
+	// every store lands whole, whichever is last
+	ASSERT_EQ(stored, c_writers * 4);
+	std::vector<unsigned char> loaded;
+	ASSERT_TRUE(cache.load("entry", 1, loaded));
+	ASSERT_EQ(loaded, data[loaded[0]]);
+	for (const auto& file : std::filesystem::directory_iterator(cache.directory()))
+		ASSERT_NE(file.path().extension(), ".tmp");
+	std::filesystem::remove_all(cache.directory());
+}
+
+TEST(asset_cache, disabled_cache_stores_nothing)
+{
+	cali::asset_cache cache;
+	const unsigned char byte = 7;
+	std::vector<unsigned char> loaded;
+	ASSERT_FALSE(cache.enabled());
+	ASSERT_FALSE(cache.store("entry", 1, &byte, 1));
+	ASSERT_FALSE(cache.load("entry", 1, loaded));
+}
+
+TEST(procedural_erosion, progressive_erodes_once_per_seed)
+{
+	using cali::proc::progressive_heightmap;
+	cali::asset_cache cache(temp_cache_directory("cali_erosion_cache_test"));
+	const auto params = test_params(0);
+
+	auto final_level = [&]()
+	{
+		progressive_heightmap progressive(c_seed, progressive_heightmap::layout::tileable, c_size, 64, &params, cache);
+		while (!progressive.is_complete()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		progressive_heightmap::level level;
+		progressive.take_latest(level);
+		return level;
+	};
+
+	auto first = final_level();
+	ASSERT_TRUE(first.eroded);
+	ASSERT_FALSE(first.from_cache);
+	auto second = final_level();
+	ASSERT_TRUE(second.from_cache);
+	ASSERT_EQ(first.rgb, second.rgb);
+
+	std::vector<unsigned char> uneroded;
+	cali::proc::generate_heightmap(c_seed, c_size, c_size, uneroded);
+	ASSERT_NE(first.rgb, uneroded);
+	std::filesystem::remove_all(cache.directory());
+}
@@ -0,0 +1,137 @@
+#pragma once
+// Golden checksums of the procedural generators, shared by cali_test and
+// cali_bench. Every platform and compiler must reproduce these bit for bit;
+// a change here means the terrain changed for every existing seed.
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <vector>
+
+#include "Procedural.h"
+#include "ProceduralErosion.h"
+
+namespace cali
+{
+namespace proc
+{
+namespace golden
+{
+	inline uint64_t fnv1a(const void* data, size_t size, uint64_t h = 14695981039346656037ULL)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; ++i) { h ^= bytes[i]; h *= 1099511628211ULL; }
+		return h;
+	}
+
+	inline uint64_t fnv1a(float v, uint64_t h)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &v, sizeof(bits));
+		return fnv1a(&bits, sizeof(bits), h);
+	}
+
+	// hash_string("cali_planet_v1"), the planet seed in World.h
+	static const uint64_t c_planet_seed = 12468691390399179151ULL;
+
+	struct heightmap_checksum
+	{
+		uint64_t seed;
+		int size;
+		uint64_t fnv1a; // of the generate_heightmap RGB24 bytes
+	};
+
+	static const heightmap_checksum c_heightmaps[] =
+	{
+		{ c_planet_seed, 64, 0x8173308ef7448e93ULL },
+		{ c_planet_seed, 256, 0x50337e5847188489ULL },
+		{ c_planet_seed, 1024, 0xf5a09a38073e1475ULL },
+		{ 1, 64, 0x3e5529cb86ce4261ULL },
+		{ 1, 256, 0x452829dcd37ed804ULL },
+		{ 1, 1024, 0x8d1100899b052facULL },
+		{ 42, 64, 0x154aba5762a67a14ULL },
+		{ 42, 256, 0x7c5c540d7fbdab87ULL },
+		{ 42, 1024, 0x7dc0f70f0b36d470ULL },
+	};
+
+	// generate_cube_sphere_heightmap(c_planet_seed, 65), faces in order
+	static const uint64_t c_cube_sphere_65 = 0xdf81da55d5ecdde4ULL;
+
+	// eroded_heightmap_checksum(c_planet_seed, 256): default erosion_params
+	static const uint64_t c_eroded_256 = 0x73aa6a3ed118acd9ULL;
+
+	// Float bits of sample_fbm / sample_voronoi (distance, border, cell) /
+	// sample_fbm_3d over sample_grid_point(i), i < c_sample_count
+	static const int c_sample_count = 4096;
+	static const uint64_t c_sample_fbm = 0x7feee8af795e0082ULL;
+	static const uint64_t c_sample_voronoi = 0x60f02f346fd0913fULL;
+	static const uint64_t c_sample_fbm_3d = 0xdc46ee1715460a36ULL;
+
+	inline void sample_grid_point(int i, float& x, float& y, float& z)
+	{
+		x = (float)(i % 64) * 0.37f + 0.013f;
+		y = (float)(i / 64) * 0.29f + 0.007f;
+		z = (float)(i % 17) * 0.11f - 0.9f;
+	}
+
+	inline uint64_t sample_fbm_checksum()
+	{
+		uint64_t h = fnv1a(nullptr, 0);
+		for (int i = 0; i < c_sample_count; ++i)
+		{
+			float x, y, z;
+			sample_grid_point(i, x, y, z);
+			h = fnv1a(sample_fbm(x, y, c_planet_seed, 16, 16), h);
+		}
+		return h;
+	}
+
+	inline uint64_t sample_voronoi_checksum()
+	{
+		uint64_t h = fnv1a(nullptr, 0);
+		for (int i = 0; i < c_sample_count; ++i)
+		{
+			float x, y, z, border, cell;
+			sample_grid_point(i, x, y, z);
+			h = fnv1a(sample_voronoi(x * 8.0f, y * 8.0f, 5.0f, c_planet_seed, 64, 64, &border, &cell), h);
+			h = fnv1a(border, h);
+			h = fnv1a(cell, h);
+		}
+		return h;
+	}
+
+	inline uint64_t sample_fbm_3d_checksum()
+	{
+		uint64_t h = fnv1a(nullptr, 0);
+		for (int i = 0; i < c_sample_count; ++i)
+		{
+			float x, y, z;
+			sample_grid_point(i, x, y, z);
+			h = fnv1a(sample_fbm_3d(x, y, z, c_planet_seed), h);
+		}
+		return h;
+	}
+
+	inline uint64_t cube_sphere_checksum(const cube_sphere_heightmap& hm)
+	{
+		uint64_t h = fnv1a(nullptr, 0);
+		for (int face = 0; face < c_cube_face_count; ++face) h = fnv1a(hm.faces[face].data(), hm.faces[face].size(), h);
+		return h;
+	}
+
+	// generate_heightmap with a wrapping erode_heightmap between the heights
+	// and the quantization
+	inline uint64_t eroded_heightmap_checksum(uint64_t seed, int size, int threads = 0)
+	{
+		std::vector<float> heights;
+		std::vector<unsigned char> rgb;
+		erosion_params params;
+		params.threads = threads;
+		generate_heightmap_heights(seed, size, size, heights);
+		erode_heightmap(seed, size, size, true, heights, params);
+		quantize_heightmap(seed, size, size, heights, rgb);
+		return fnv1a(rgb.data(), rgb.size());
+	}
+}
+}
+}
@@ -0,0 +1,46 @@
+#include <gtest.h>
+#include <Procedural.h>
+#include "procedural_golden.h"
+
+#include <vector>
+
+// Bit-exact regression of the generators against procedural_golden.h; the 1024
+// maps are checked by cali_bench only, they take too long for a unit test.
+
+TEST(procedural_golden, planet_seed)
+{
+	ASSERT_EQ(cali::proc::hash_string("cali_planet_v1"), cali::proc::golden::c_planet_seed);
+}
+
+TEST(procedural_golden, noise_samples)
+{
+	using namespace cali::proc::golden;
+	ASSERT_EQ(sample_fbm_checksum(), c_sample_fbm);
+	ASSERT_EQ(sample_voronoi_checksum(), c_sample_voronoi);
+	ASSERT_EQ(sample_fbm_3d_checksum(), c_sample_fbm_3d);
+}
+
+TEST(procedural_golden, heightmaps)
+{
+	using namespace cali::proc::golden;
+	for (const heightmap_checksum& g : c_heightmaps)
+	{
+		if (g.size > 256) continue;
+		std::vector<unsigned char> rgb;
+		cali::proc::generate_heightmap(g.seed, g.size, g.size, rgb);
+		ASSERT_EQ(fnv1a(rgb.data(), rgb.size()), g.fnv1a) << "seed " << g.seed << " size " << g.size;
+	}
+}
+
+TEST(procedural_golden, cube_sphere)
+{
+	cali::proc::cube_sphere_heightmap hm;
+	cali::proc::generate_cube_sphere_heightmap(cali::proc::golden::c_planet_seed, 65, hm);
+	ASSERT_EQ(cali::proc::golden::cube_sphere_checksum(hm), cali::proc::golden::c_cube_sphere_65);
+}
+
+TEST(procedural_golden, eroded_heightmap)
+{
+	using namespace cali::proc::golden;
+	ASSERT_EQ(eroded_heightmap_checksum(c_planet_seed, 256), c_eroded_256);
+}
@@ -0,0 +1,93 @@
+#include <gtest.h>
+#include <Procedural.h>
+#include <ProceduralGraph.h>
+
+#include <vector>
+
+namespace
+{
+	const uint64_t c_seed = cali::proc::hash_string("cali_planet_v1");
+	const int c_size = 256;
+
+	std::vector<unsigned char> evaluate_from_scratch(const cali::proc::terrain_graph::remap_params* small_ridges)
+	{
+		cali::proc::terrain_graph graph;
+		auto nodes = cali::proc::build_default_terrain_graph(graph, c_seed);
+		if (small_ridges) graph.set_params(nodes.small_ridges, *small_ridges);
+		graph.set_resolution(c_size, c_size);
+		graph.evaluate();
+
+		std::vector<unsigned char> rgb;
+		graph.quantize(c_seed, rgb);
+		return rgb;
+	}
+}
+
+TEST(procedural_graph, default_graph_matches_generate_heightmap)
+{
+	std::vector<unsigned char> expected;
+	cali::proc::generate_heightmap(c_seed, c_size, c_size, expected);
+	ASSERT_EQ(evaluate_from_scratch(nullptr), expected);
+}
+
+TEST(procedural_graph, clean_graph_evaluates_nothing)
+{
+	cali::proc::terrain_graph graph;
+	cali::proc::build_default_terrain_graph(graph, c_seed);
+	graph.set_resolution(c_size, c_size);
+
+	auto first = graph.evaluate();
+	ASSERT_EQ(first.tiles_evaluated, first.tiles_total);
+
+	auto second = graph.evaluate();
+	ASSERT_EQ(second.tiles_evaluated, 0u);
+	ASSERT_EQ(second.node_evaluations, 0u);
+}
+
+TEST(procedural_graph, ridge_change_regenerates_mountain_tiles_only)
+{
+	cali::proc::terrain_graph graph;
+	auto nodes = cali::proc::build_default_terrain_graph(graph, c_seed);
+	graph.set_cached(nodes.mountain_mask, true);
+	graph.set_resolution(c_size, c_size);
+	auto full = graph.evaluate();
+
+	const cali::proc::terrain_graph::remap_params steeper{ 0.0f, 1.0f, 0.0f, 0.25f, false };
+	graph.set_params(nodes.small_ridges, steeper);
+	auto partial = graph.evaluate();
+
+	// the small ridges are masked out in lowland tiles, and the cached mountain
+	// mask keeps its upstream noise from being evaluated again
+	ASSERT_GT(partial.tiles_evaluated, 0u);
+	ASSERT_LT(partial.tiles_evaluated, full.tiles_evaluated);
+	ASSERT_LT(partial.node_evaluations, partial.tiles_evaluated * graph.node_count());
+
+	std::vector<unsigned char> rgb;
+	graph.quantize(c_seed, rgb);
+	ASSERT_EQ(rgb, evaluate_from_scratch(&steeper));
+}
+
+TEST(procedural_graph, repeated_edits_match_full_recompute)
+{
+	cali::proc::terrain_graph graph;
+	auto nodes = cali::proc::build_default_terrain_graph(graph, c_seed);
+	graph.set_resolution(c_size, c_size, 16);
+	graph.evaluate();
+
+	// change and revert: tiles skipped on the first edit must be right after the second
+	const cali::proc::terrain_graph::remap_params flat{ 0.0f, 1.0f, 0.0f, 0.0f, false };
+	const cali::proc::terrain_graph::remap_params original{ 0.0f, 1.0f, 0.0f, 0.10f, false };
+	const cali::proc::terrain_graph::remap_params high_peaks{ 0.0f, 1.0f, 0.0f, 0.5f, false };
+	const cali::proc::terrain_graph::remap_params original_peaks{ 0.0f, 1.0f, 0.0f, 0.28f, false };
+	graph.set_params(nodes.small_ridges, flat);
+	graph.evaluate();
+	graph.set_params(nodes.peaks, high_peaks);
+	graph.evaluate();
+	graph.set_params(nodes.small_ridges, original);
+	graph.set_params(nodes.peaks, original_peaks);
+	graph.evaluate();
+
+	std::vector<unsigned char> rgb;
+	graph.quantize(c_seed, rgb);
+	ASSERT_EQ(rgb, evaluate_from_scratch(nullptr));
+}
@@ -0,0 +1,167 @@
+#include <gtest.h>
+#include <Procedural.h>
+#include <ProceduralProgressive.h>
+#include <CaliSphereMath.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	const uint64_t c_seed = cali::proc::hash_string("cali_planet_v1");
+	const IvDoubleVector3 c_origin{ 0.0, 0.0, 0.0 };
+
+	double face_coord(int i, int n) { return -1.0 + 2.0 * i / (n - 1); }
+
+	IvDoubleVector3 texel_position(int face, int i, int j, int n)
+	{
+		IvDoubleVector3 normal;
+		return cali::Math::adjusted_cube_to_sphere_face(
+			static_cast<cali::Math::CubeFace>(face), face_coord(i, n), face_coord(j, n), 1.0, c_origin, normal);
+	}
+
+	const cali::proc::cube_sphere_heightmap& test_heightmap()
+	{
+		static cali::proc::cube_sphere_heightmap hm;
+		if (hm.face_size == 0) cali::proc::generate_cube_sphere_heightmap(c_seed, 65, hm);
+		return hm;
+	}
+}
+
+TEST(procedural, cube_sphere_is_deterministic)
+{
+	cali::proc::cube_sphere_heightmap other;
+	cali::proc::generate_cube_sphere_heightmap(c_seed, 65, other);
+
+	const auto& hm = test_heightmap();
+	for (int face = 0; face < cali::proc::c_cube_face_count; ++face)
+	{
+		ASSERT_EQ(hm.faces[face], other.faces[face]);
+	}
+}
+
+TEST(procedural, cube_sphere_faces_are_not_repeated)
+{
+	const auto& hm = test_heightmap();
+	for (int a = 0; a < cali::proc::c_cube_face_count; ++a)
+	{
+		for (int b = a + 1; b < cali::proc::c_cube_face_count; ++b)
+		{
+			ASSERT_NE(hm.faces[a], hm.faces[b]);
+		}
+	}
+}
+
+TEST(procedural, cube_sphere_seams_match_exactly)
+{
+	// Brute force: every border texel must coincide with a border texel of at least
+	// one other face, and every coinciding pair must hold the same height.
+	const auto& hm = test_heightmap();
+	const int n = hm.face_size;
+	// kPI is a float constant, so face edges only agree to ~1e-8 on the unit sphere
+	const double position_tolerance = 1e-6;
+
+	size_t matched = 0;
+	for (int face = 0; face < cali::proc::c_cube_face_count; ++face)
+	{
+		for (int j = 0; j < n; ++j) for (int i = 0; i < n; ++i)
+		{
+			if (i != 0 && i != n - 1 && j != 0 && j != n - 1) continue;
+			IvDoubleVector3 p = texel_position(face, i, j, n);
+
+			bool found = false;
+			for (int other = 0; other < cali::proc::c_cube_face_count; ++other)
+			{
+				if (other == face) continue;
+				for (int oj = 0; oj < n; ++oj) for (int oi = 0; oi < n; ++oi)
+				{
+					if (oi != 0 && oi != n - 1 && oj != 0 && oj != n - 1) continue;
+					if (Distance(p, texel_position(other, oi, oj, n)) > position_tolerance) continue;
+					ASSERT_EQ(hm.at(face, i, j), hm.at(other, oi, oj))
+						<< "face " << face << " (" << i << "," << j << ") vs face " << other << " (" << oi << "," << oj << ")";
+					found = true;
+				}
+			}
+			ASSERT_TRUE(found) << "border texel without neighbour: face " << face << " (" << i << "," << j << ")";
+			++matched;
+		}
+	}
+	ASSERT_EQ(matched, (size_t)cali::proc::c_cube_face_count * 4 * (n - 1));
+}
+
+TEST(procedural, cube_sphere_texel_density_is_even)
+{
+	// Ratio between the largest and smallest texel area on the sphere; a plain
+	// gnomonic cube map is ~5.2, the adjusted mapping should stay well below 2.
+	const int n = 65;
+	double min_area = 1e9, max_area = 0.0;
+	for (int j = 0; j + 1 < n; ++j) for (int i = 0; i + 1 < n; ++i)
+	{
+		IvDoubleVector3 a = texel_position(0, i, j, n);
+		IvDoubleVector3 b = texel_position(0, i + 1, j, n);
+		IvDoubleVector3 c = texel_position(0, i, j + 1, n);
+		double area = (b - a).Cross(c - a).Length();
+		min_area = std::min(min_area, area);
+		max_area = std::max(max_area, area);
+	}
+	ASSERT_LT(max_area / min_area, 2.0);
+}
+
+TEST(procedural, fbm_3d_range)
+{
+	for (int i = 0; i < 1000; ++i)
+	{
+		float v = cali::proc::sample_fbm_3d(i * 0.37f, i * -0.11f, i * 0.05f, c_seed);
+		ASSERT_GE(v, 0.0f);
+		ASSERT_LE(v, 1.0f);
+	}
+}
+
+TEST(procedural, progressive_level_sizes)
+{
+	using cali::proc::progressive_heightmap;
+	ASSERT_EQ(progressive_heightmap::level_sizes(1024, 128), (std::vector<int>{ 128, 256, 512, 1024 }));
+	ASSERT_EQ(progressive_heightmap::level_sizes(416, 52), (std::vector<int>{ 52, 104, 208, 416 }));
+	ASSERT_EQ(progressive_heightmap::level_sizes(100, 128), (std::vector<int>{ 100 }));
+}
+
+TEST(procedural, progressive_refines_to_full_generation)
+{
+	using cali::proc::progressive_heightmap;
+	progressive_heightmap progressive(c_seed, progressive_heightmap::layout::tileable, 256, 64);
+
+	// the preview is ready as soon as the constructor returns
+	progressive_heightmap::level level;
+	ASSERT_TRUE(progressive.take_latest(level));
+	ASSERT_EQ(level.index, 0);
+	ASSERT_EQ(level.size, 64);
+	ASSERT_EQ(level.rgb.size(), (size_t)64 * 64 * 3);
+
+	while (!progressive.is_complete()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	ASSERT_TRUE(progressive.take_latest(level));
+	ASSERT_TRUE(level.final);
+	ASSERT_FALSE(progressive.take_latest(level));
+
+	std::vector<unsigned char> expected;
+	cali::proc::generate_heightmap(c_seed, 256, 256, expected);
+	ASSERT_EQ(level.rgb, expected);
+	ASSERT_GE(progressive.time_to_preview(), 0.0);
+	ASSERT_LE(progressive.time_to_preview(), progressive.time_to_full_quality());
+}
+
+TEST(procedural, progressive_cube_sphere_atlas)
+{
+	using cali::proc::progressive_heightmap;
+	progressive_heightmap progressive(c_seed, progressive_heightmap::layout::cube_sphere_atlas, 65, 33);
+	while (!progressive.is_complete()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+	progressive_heightmap::level level;
+	ASSERT_TRUE(progressive.take_latest(level));
+	ASSERT_EQ(level.width, 65 * 3);
+	ASSERT_EQ(level.height, 65 * 2);
+	std::vector<unsigned char> expected;
+	cali::proc::pack_cube_sphere_atlas(test_heightmap(), expected);
+	ASSERT_EQ(level.rgb, expected);
+}
@@ -0,0 +1,228 @@
+#include <gtest.h>
+#include <TransformStore.h>
+
+#include <IvMath.h>
+#include <IvMatrix33.h>
+
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using cali::transform_store;
+
+// transform_store against physical's eager matrices (the code of
+// Renderable.cpp, copied here: physical is in the renderer build) and
+// against IvMatrix33::Rotation(IvQuat), whose bits every lane must give.
+namespace
+{
+	struct physical_reference
+	{
+		IvVector3 position{ 0.f, 0.f, 0.f };
+		IvVector3 direction{ 0.f, 0.f, 1.f };
+		IvVector3 right{ 1.f, 0.f, 0.f };
+		IvVector3 scale{ 1.f, 1.f, 1.f };
+
+		void set_direction(const IvVector3& dir, const IvVector3& up)
+		{
+			IvVector3 d = dir;
+			if (d == up)
+			{
+				d.x += kEpsilon * 1000.f;
+				d.y += kEpsilon * 1000.f;
+				d.z += kEpsilon * 1000.f;
+				d.Normalize();
+			}
+			direction = d;
+			right = up.Cross(direction);
+		}
+
+		IvMatrix44 model_matrix()
+		{
+			direction.Normalize();
+			right.Normalize();
+			IvVector3 up = direction.Cross(right);
+			up.Normalize();
+
+			IvMatrix44 m;
+			m(0, 0) = right.x; m(0, 1) = up.x; m(0, 2) = direction.x;
+			m(1, 0) = right.y; m(1, 1) = up.y; m(1, 2) = direction.y;
+			m(2, 0) = right.z; m(2, 1) = up.z; m(2, 2) = direction.z;
+			m(0, 3) = position.x; m(1, 3) = position.y; m(2, 3) = position.z;
+
+			IvMatrix44 scale_matrix;
+			scale_matrix(0, 0) = scale.x;
+			scale_matrix(1, 1) = scale.y;
+			scale_matrix(2, 2) = scale.z;
+			return m * scale_matrix;
+		}
+	};
+
+	IvVector3 random_vector(std::mt19937& rng, float range)
+	{
+		std::uniform_real_distribution<float> value(-range, range);
+		return { value(rng), value(rng), value(rng) };
+	}
+
+	IvQuat random_rotation(std::mt19937& rng)
+	{
+		IvVector3 axis = random_vector(rng, 1.0f);
+		axis.Normalize();
+		return IvQuat(axis, std::uniform_real_distribution<float>(-kPI, kPI)(rng));
+	}
+
+	// What every lane must give
+	IvMatrix44 scalar_local_matrix(const IvVector3& position, const IvQuat& rotation, const IvVector3& scale)
+	{
+		IvMatrix33 r;
+		r.Rotation(rotation);
+		IvMatrix44 m;
+		for (unsigned int i = 0; i < 3; ++i)
+		{
+			m(i, 0) = r(i, 0) * scale.x;
+			m(i, 1) = r(i, 1) * scale.y;
+			m(i, 2) = r(i, 2) * scale.z;
+		}
+		m(0, 3) = position.x;
+		m(1, 3) = position.y;
+		m(2, 3) = position.z;
+		return m;
+	}
+
+	bool same_bits(const IvMatrix44& a, const IvMatrix44& b)
+	{
+		return memcmp(&a, &b, sizeof(IvMatrix44)) == 0;
+	}
+
+	void expect_near(const IvMatrix44& a, const IvMatrix44& b, float tolerance, int n)
+	{
+		for (unsigned int i = 0; i < 4; ++i)
+			for (unsigned int j = 0; j < 4; ++j) EXPECT_NEAR(a(i, j), b(i, j), tolerance) << n << " (" << i << ", " << j << ")";
+	}
+}
+
+TEST(transform, matches_physical)
+{
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> scale(0.1f, 100.0f);
+	transform_store store(1);
+	std::vector<physical_reference> references(37);
+	for (physical_reference& reference : references)
+	{
+		const transform_store::handle h = store.create();
+		reference.position = random_vector(rng, 1000.0f);
+		reference.scale = { scale(rng), scale(rng), scale(rng) };
+		const IvVector3 target = random_vector(rng, 1000.0f);
+		IvVector3 up = random_vector(rng, 1.0f);
+		up.Normalize();
+		reference.set_direction(target - reference.position, up);
+
+		store.set_position(h, reference.position);
+		store.set_scale(h, reference.scale);
+		store.look_at(h, target, up);
+	}
+	EXPECT_EQ(store.update(), references.size());
+
+	for (size_t i = 0; i < references.size(); ++i)
+	{
+		const IvVector3& s = references[i].scale;
+		const float largest = std::max(std::max(s.x, s.y), s.z);
+		expect_near(store.get_world_matrix((transform_store::handle)i), references[i].model_matrix(), 4e-6f * largest, (int)i);
+	}
+
+	// physical's default: the identity
+	transform_store identity(1);
+	identity.create();
+	identity.update();
+	expect_near(identity.get_world_matrix(0), physical_reference().model_matrix(), 0.0f, 0);
+}
+
+TEST(transform, every_lane_gives_the_scalar_bits)
+{
+	std::mt19937 rng(11);
+	transform_store store(1);
+	struct values { IvVector3 position; IvQuat rotation; IvVector3 scale; };
+	std::vector<values> expected;
+	for (int i = 0; i < 29; ++i) // three full batches of 8 and a remainder
+	{
+		values v{ random_vector(rng, 500.0f), random_rotation(rng), random_vector(rng, 10.0f) };
+		const transform_store::handle h = store.create();
+		store.set_position(h, v.position);
+		store.set_rotation(h, v.rotation);
+		store.set_scale(h, v.scale);
+		expected.push_back(v);
+	}
+	store.update();
+	for (size_t i = 0; i < expected.size(); ++i)
+		EXPECT_TRUE(same_bits(store.get_world_matrix((transform_store::handle)i),
+			scalar_local_matrix(expected[i].position, expected[i].rotation, expected[i].scale))) << i;
+}
+
+TEST(transform, only_dirty_transforms_and_their_descendants_update)
+{
+	std::mt19937 rng(17);
+	transform_store store(1);
+	const transform_store::handle root = store.create();
+	const transform_store::handle child = store.create(root);
+	const transform_store::handle grandchild = store.create(child);
+	const transform_store::handle other = store.create();
+	for (transform_store::handle h : { root, child, grandchild, other })
+	{
+		store.set_position(h, random_vector(rng, 100.0f));
+		store.set_rotation(h, random_rotation(rng));
+		store.set_scale(h, 2.0f);
+	}
+	EXPECT_EQ(store.update(), 4u);
+	EXPECT_EQ(store.update(), 0u);
+
+	auto local = [&](transform_store::handle h)
+	{
+		return scalar_local_matrix(store.get_position(h), store.get_rotation(h), store.get_scale(h));
+	};
+	EXPECT_TRUE(same_bits(store.get_world_matrix(child), local(root) * local(child)));
+	EXPECT_TRUE(same_bits(store.get_world_matrix(grandchild), (local(root) * local(child)) * local(grandchild)));
+
+	// moving the child moves the grandchild, not the root or the other one
+	const IvMatrix44 root_before = store.get_world_matrix(root), other_before = store.get_world_matrix(other);
+	store.set_position(child, { 1.0f, 2.0f, 3.0f });
+	EXPECT_TRUE(store.is_dirty(child));
+	EXPECT_FALSE(store.is_dirty(grandchild));
+	EXPECT_EQ(store.update(), 2u);
+	EXPECT_TRUE(same_bits(store.get_world_matrix(root), root_before));
+	EXPECT_TRUE(same_bits(store.get_world_matrix(other), other_before));
+	EXPECT_TRUE(same_bits(store.get_world_matrix(grandchild), (local(root) * local(child)) * local(grandchild)));
+
+	EXPECT_THROW(store.create(7), std::invalid_argument);
+}
+
+TEST(transform, results_do_not_depend_on_the_thread_count)
+{
+	std::mt19937 rng(23);
+	transform_store one(1), many(4);
+	for (int i = 0; i < 20000; ++i)
+	{
+		// every tenth one a child of an earlier transform
+		const transform_store::handle parent = i % 10 == 9 ? (transform_store::handle)(rng() % i) : transform_store::no_parent;
+		const IvVector3 position = random_vector(rng, 1000.0f), scale = random_vector(rng, 4.0f);
+		const IvQuat rotation = random_rotation(rng);
+		for (transform_store* store : { &one, &many })
+		{
+			const transform_store::handle h = store->create(parent);
+			store->set_position(h, position);
+			store->set_rotation(h, rotation);
+			store->set_scale(h, scale);
+		}
+	}
+	EXPECT_EQ(one.update(), many.update());
+	EXPECT_EQ(memcmp(one.world_matrices(), many.world_matrices(), one.size() * sizeof(IvMatrix44)), 0);
+
+	// a few dirty ones among many clean ones
+	for (transform_store::handle h = 3; h < one.size(); h += 997)
+	{
+		one.set_scale(h, 0.5f);
+		many.set_scale(h, 0.5f);
+	}
+	EXPECT_EQ(one.update(), many.update());
+	EXPECT_EQ(memcmp(one.world_matrices(), many.world_matrices(), one.size() * sizeof(IvMatrix44)), 0);
+}